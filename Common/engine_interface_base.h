@@ -73,6 +73,9 @@ public:
 	//! Get the current number of timesteps
 	virtual unsigned int GetNumberOfTimesteps() const =0;
 
+	//! Get the number of threads used by the engine
+	virtual unsigned int GetNumberOfThreads() const {return 1;}
+
 	//! Calc (roughly) the total energy
 	/*!
 	  This method only calculates a very rough estimate of the total energy in the simulation domain.
@@ -17,7 +17,7 @@
 
 #include "tools/global.h"
 #include "processcurrent.h"
-#include "FDTD/engine_interface_fdtd.h"
+#include "processintegral_batch.h"
 #include <iomanip>
 
 ProcessCurrent::ProcessCurrent(Engine_Interface_Base* eng_if) : ProcessIntegral(eng_if)
@@ -166,3 +166,70 @@ double ProcessCurrent::CalcIntegral()
 
 	return current;
 }
+
+bool ProcessCurrent::GatherCurrentLine(const Engine* Eng, int n, unsigned int x, unsigned int y, unsigned int z, float sign, vector<Engine_Interface_FDTD::FieldGather> &gather) const
+{
+	Engine_Interface_FDTD::FieldGather entry;
+	entry.weight = sign;
+	unsigned int pos[3] = {x,y,z};
+	for (pos[n]=start[n]+1; pos[n]<=stop[n]; ++pos[n])
+	{
+		entry.value = Eng->GetCurrPtr(n,pos);
+		if (entry.value==NULL)
+			return false;
+		gather.push_back(entry);
+	}
+	return true;
+}
+
+bool ProcessCurrent::CompileGather(ProcessIntegralBatch* batch)
+{
+	Engine_Interface_FDTD* EI_FDTD = dynamic_cast<Engine_Interface_FDTD*>(m_Eng_Interface);
+	if (EI_FDTD==NULL)
+		return false;
+	const Engine* Eng = EI_FDTD->GetFDTDEngine();
+
+	// same currents as CalcIntegral()
+	vector<Engine_Interface_FDTD::FieldGather> gather;
+	bool ok = true;
+	switch (m_normDir)
+	{
+	case 0:
+		if (m_stop_inside[0] && m_start_inside[2])
+			ok &= GatherCurrentLine(Eng, 1, stop[0], 0, start[2], 1, gather);
+		if (m_stop_inside[0] && m_stop_inside[1])
+			ok &= GatherCurrentLine(Eng, 2, stop[0], stop[1], 0, 1, gather);
+		if (m_start_inside[0] && m_stop_inside[2])
+			ok &= GatherCurrentLine(Eng, 1, start[0], 0, stop[2], -1, gather);
+		if (m_start_inside[0] && m_start_inside[1])
+			ok &= GatherCurrentLine(Eng, 2, start[0], start[1], 0, -1, gather);
+		break;
+	case 1:
+		if (m_start_inside[0] && m_start_inside[1])
+			ok &= GatherCurrentLine(Eng, 2, start[0], start[1], 0, 1, gather);
+		if (m_stop_inside[1] && m_stop_inside[2])
+			ok &= GatherCurrentLine(Eng, 0, 0, stop[1], stop[2], 1, gather);
+		if (m_stop_inside[0] && m_stop_inside[1])
+			ok &= GatherCurrentLine(Eng, 2, stop[0], stop[1], 0, -1, gather);
+		if (m_start_inside[1] && m_start_inside[2])
+			ok &= GatherCurrentLine(Eng, 0, 0, start[1], start[2], -1, gather);
+		break;
+	case 2:
+		if (m_start_inside[1] && m_start_inside[2])
+			ok &= GatherCurrentLine(Eng, 0, 0, start[1], start[2], 1, gather);
+		if (m_stop_inside[0] && m_start_inside[2])
+			ok &= GatherCurrentLine(Eng, 1, stop[0], 0, start[2], 1, gather);
+		if (m_stop_inside[1] && m_stop_inside[2])
+			ok &= GatherCurrentLine(Eng, 0, 0, stop[1], stop[2], -1, gather);
+		if (m_start_inside[0] && m_stop_inside[2])
+			ok &= GatherCurrentLine(Eng, 1, start[0], 0, stop[2], -1, gather);
+		break;
+	default:
+		return false;
+	}
+	if (ok==false)
+		return false;
+	batch->AddSample();
+	batch->AddToSample(gather);
+	return true;
+}
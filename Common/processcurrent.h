@@ -19,6 +19,7 @@
 #define PROCESSCURRENT_H
 
 #include "processintegral.h"
+#include "FDTD/engine_interface_fdtd.h"
 
 class ProcessCurrent : public ProcessIntegral
 {
@@ -35,7 +36,11 @@ public:
 	//! Integrate currents flowing through an area
 	virtual double CalcIntegral();
 
+	virtual bool CompileGather(ProcessIntegralBatch* batch);
+
 protected:
+	//! Add the currents in direction \a n from start[n]+1 to stop[n] at the line position \a x, \a y, \a z (the position in direction \a n is ignored)
+	bool GatherCurrentLine(const Engine* Eng, int n, unsigned int x, unsigned int y, unsigned int z, float sign, std::vector<Engine_Interface_FDTD::FieldGather> &gather) const;
 };
 
 #endif // PROCESSCURRENT_H
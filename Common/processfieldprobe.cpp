@@ -16,6 +16,7 @@
 */
 
 #include "processfieldprobe.h"
+#include "processintegral_batch.h"
 
 using namespace std;
 
@@ -90,3 +91,22 @@ double* ProcessFieldProbe::CalcMultipleIntegrals()
 	}
 	return m_Results;
 }
+
+bool ProcessFieldProbe::CompileGather(ProcessIntegralBatch* batch)
+{
+	Engine_Interface_FDTD* EI_FDTD = dynamic_cast<Engine_Interface_FDTD*>(m_Eng_Interface);
+	if (EI_FDTD==NULL)
+		return false;
+	m_Eng_Interface->SetInterpolationType(Engine_Interface_Base::NO_INTERPOLATION);
+
+	vector<Engine_Interface_FDTD::FieldGather> gather;
+	for (int n=0; n<3; ++n)
+	{
+		gather.clear();
+		if (EI_FDTD->GatherField(m_ModeFieldType==1 ? 1 : 0, n, start, gather)==false)
+			return false;
+		batch->AddSample();
+		batch->AddToSample(gather);
+	}
+	return true;
+}
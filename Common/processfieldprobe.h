@@ -36,6 +36,8 @@ public:
 	virtual int GetNumberOfIntegrals() const {return 3;}
 	virtual double* CalcMultipleIntegrals();
 
+	virtual bool CompileGather(ProcessIntegralBatch* batch);
+
 protected:
 	int m_ModeFieldType;
 };
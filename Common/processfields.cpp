@@ -17,6 +17,8 @@
 
 #include <iomanip>
 #include "tools/global.h"
+#include "tools/useful.h"
+#include "tools/thread_pool.h"
 #include "tools/vtk_file_writer.h"
 #include "tools/hdf5_file_writer.h"
 #include "processfields.h"
@@ -30,6 +32,7 @@ ProcessFields::ProcessFields(Engine_Interface_Base* eng_if) : Processing(eng_if)
 	m_SampleType = NONE;
 	m_Vtk_Dump_File = NULL;
 	m_HDF5_Dump_File = NULL;
+	m_AppendOnResume = false;
 	SetPrecision(6);
 	m_dualTime = false;
 
@@ -145,7 +148,10 @@ void ProcessFields::InitProcess()
 	if (m_fileType==HDF5_FILETYPE)
 	{
 		delete m_HDF5_Dump_File;
-		m_HDF5_Dump_File = new HDF5_File_Writer(m_filename+".h5");
+		bool append = m_Resume && m_AppendOnResume;
+		m_HDF5_Dump_File = new HDF5_File_Writer(m_filename+".h5", append);
+		if (append && m_HDF5_Dump_File->Exists("/Mesh"))
+			return;
 
 		#ifdef OUTPUT_IN_DRAWINGUNITS
 		double discScaling = 1;
@@ -279,129 +285,80 @@ void ProcessFields::CalcMeshPos()
 
 FDTD_FLOAT**** ProcessFields::CalcField()
 {
-	unsigned int pos[3];
-	double out[3];
 	//create array
 	FDTD_FLOAT**** field = Create_N_3DArray<FDTD_FLOAT>(numLines);
+	CalcField(field);
+	return field;
+}
+
+class ProcessFields::CalcFieldJob : public ThreadPool::RangeJob
+{
+public:
+	CalcFieldJob(const ProcessFields* proc, FDTD_FLOAT**** field) : m_Proc(proc), m_Field(field) {}
+	virtual void Run(unsigned int start, unsigned int stop, unsigned int) {m_Proc->CalcFieldRange(m_Field, start, stop+1);}
+protected:
+	const ProcessFields* m_Proc;
+	FDTD_FLOAT**** m_Field;
+};
+
+void ProcessFields::CalcField(FDTD_FLOAT**** field, unsigned int numThreads)
+{
+	// use at least some ten thousand cells per thread, smaller dumps are not worth waking up the workers
+	unsigned int maxThreads = (unsigned int)((double)numLines[0]*numLines[1]*numLines[2]/1e4) + 1;
+	if (min(numThreads, maxThreads)<2)
+		return CalcFieldRange(field, 0, numLines[0]);
+
+	// the persistent workers of the shared pool avoid starting new threads every sampled timestep
+	CalcFieldJob job(this, field);
+	ThreadPool::GetShared().RunRangeJob(&job, numLines[0], min(numThreads, maxThreads));
+}
+
+void ProcessFields::CalcFieldRange(FDTD_FLOAT**** field, unsigned int startX, unsigned int stopX) const
+{
+	double* (Engine_Interface_Base::*getField)(const unsigned int*, double*) const;
 	switch (m_DumpType)
 	{
 	case E_FIELD_DUMP:
-		for (unsigned int i=0; i<numLines[0]; ++i)
-		{
-			pos[0]=posLines[0][i];
-			for (unsigned int j=0; j<numLines[1]; ++j)
-			{
-				pos[1]=posLines[1][j];
-				for (unsigned int k=0; k<numLines[2]; ++k)
-				{
-					pos[2]=posLines[2][k];
-
-					m_Eng_Interface->GetEField(pos,out);
-					field[0][i][j][k] = out[0];
-					field[1][i][j][k] = out[1];
-					field[2][i][j][k] = out[2];
-				}
-			}
-		}
-		return field;
+		getField = &Engine_Interface_Base::GetEField;
+		break;
 	case H_FIELD_DUMP:
-		for (unsigned int i=0; i<numLines[0]; ++i)
-		{
-			pos[0]=posLines[0][i];
-			for (unsigned int j=0; j<numLines[1]; ++j)
-			{
-				pos[1]=posLines[1][j];
-				for (unsigned int k=0; k<numLines[2]; ++k)
-				{
-					pos[2]=posLines[2][k];
-
-					m_Eng_Interface->GetHField(pos,out);
-					field[0][i][j][k] = out[0];
-					field[1][i][j][k] = out[1];
-					field[2][i][j][k] = out[2];
-				}
-			}
-		}
-		return field;
+		getField = &Engine_Interface_Base::GetHField;
+		break;
 	case J_FIELD_DUMP:
-		for (unsigned int i=0; i<numLines[0]; ++i)
-		{
-			pos[0]=posLines[0][i];
-			for (unsigned int j=0; j<numLines[1]; ++j)
-			{
-				pos[1]=posLines[1][j];
-				for (unsigned int k=0; k<numLines[2]; ++k)
-				{
-					pos[2]=posLines[2][k];
-
-					m_Eng_Interface->GetJField(pos,out);
-					field[0][i][j][k] = out[0];
-					field[1][i][j][k] = out[1];
-					field[2][i][j][k] = out[2];
-				}
-			}
-		}
-		return field;
+		getField = &Engine_Interface_Base::GetJField;
+		break;
 	case ROTH_FIELD_DUMP:
-		for (unsigned int i=0; i<numLines[0]; ++i)
-		{
-			pos[0]=posLines[0][i];
-			for (unsigned int j=0; j<numLines[1]; ++j)
-			{
-				pos[1]=posLines[1][j];
-				for (unsigned int k=0; k<numLines[2]; ++k)
-				{
-					pos[2]=posLines[2][k];
-
-					m_Eng_Interface->GetRotHField(pos,out);
-					field[0][i][j][k] = out[0];
-					field[1][i][j][k] = out[1];
-					field[2][i][j][k] = out[2];
-				}
-			}
-		}
-		return field;
+		getField = &Engine_Interface_Base::GetRotHField;
+		break;
 	case D_FIELD_DUMP:
-		for (unsigned int i=0; i<numLines[0]; ++i)
-		{
-			pos[0]=posLines[0][i];
-			for (unsigned int j=0; j<numLines[1]; ++j)
-			{
-				pos[1]=posLines[1][j];
-				for (unsigned int k=0; k<numLines[2]; ++k)
-				{
-					pos[2]=posLines[2][k];
-
-					m_Eng_Interface->GetDField(pos,out);
-					field[0][i][j][k] = out[0];
-					field[1][i][j][k] = out[1];
-					field[2][i][j][k] = out[2];
-				}
-			}
-		}
-		return field;
+		getField = &Engine_Interface_Base::GetDField;
+		break;
 	case B_FIELD_DUMP:
-		for (unsigned int i=0; i<numLines[0]; ++i)
+		getField = &Engine_Interface_Base::GetBField;
+		break;
+	default:
+		cerr << "ProcessFields::CalcField(): Error, unknown dump type..." << endl;
+		return;
+	}
+
+	unsigned int pos[3];
+	double out[3];
+	for (unsigned int i=startX; i<stopX; ++i)
+	{
+		pos[0]=posLines[0][i];
+		for (unsigned int j=0; j<numLines[1]; ++j)
 		{
-			pos[0]=posLines[0][i];
-			for (unsigned int j=0; j<numLines[1]; ++j)
+			pos[1]=posLines[1][j];
+			for (unsigned int k=0; k<numLines[2]; ++k)
 			{
-				pos[1]=posLines[1][j];
-				for (unsigned int k=0; k<numLines[2]; ++k)
-				{
-					pos[2]=posLines[2][k];
+				pos[2]=posLines[2][k];
 
-					m_Eng_Interface->GetBField(pos,out);
-					field[0][i][j][k] = out[0];
-					field[1][i][j][k] = out[1];
-					field[2][i][j][k] = out[2];
-				}
+				(m_Eng_Interface->*getField)(pos,out);
+				field[0][i][j][k] = out[0];
+				field[1][i][j][k] = out[1];
+				field[2][i][j][k] = out[2];
 			}
 		}
-		return field;
-	default:
-		cerr << "ProcessFields::CalcField(): Error, unknown dump type..." << endl;
-		return field;
 	}
 }
 
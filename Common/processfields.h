@@ -32,8 +32,8 @@ public:
 	ProcessFields(Engine_Interface_Base* eng_if);
 	virtual ~ProcessFields();
 
-	//! File type definition.
-	enum FileType { VTK_FILETYPE, HDF5_FILETYPE};
+	//! File type definition. NO_FILETYPE: no output file, the fields are only kept in memory for another processing (e.g. ProcessNF2FF)
+	enum FileType { NO_FILETYPE=-1, VTK_FILETYPE, HDF5_FILETYPE};
 
 	//! Dump type definitions.
 	/*!
@@ -72,6 +72,11 @@ public:
 
 	void SetFileType(FileType fileType) {m_fileType=fileType;}
 
+	//! Get the number of dumped lines in direction \a n
+	unsigned int GetNumberOfLines(int n) const {return numLines[n];}
+	//! Get the dumped mesh lines in direction \a n (in drawing units)
+	const double* GetDiscLines(int n) const {return discLines[n];}
+
 	static std::string GetFieldNameByType(DumpType type);
 
 	virtual bool NeedConductivity() const;
@@ -84,6 +89,8 @@ protected:
 
 	VTK_File_Writer* m_Vtk_Dump_File;
 	HDF5_File_Writer* m_HDF5_Dump_File;
+	//! continue an existing hdf5 file when resuming from a checkpoint, instead of replacing it
+	bool m_AppendOnResume;
 
 	enum SampleType {NONE, SUBSAMPLE, OPT_RESOLUTION} m_SampleType;
 	virtual void CalcMeshPos();
@@ -101,6 +108,12 @@ protected:
 
 	//! Calculate and return the defined field. Caller has to cleanup the array.
 	FDTD_FLOAT**** CalcField();
+	//! Calculate the defined field into the existing \a field array, using up to \a numThreads threads.
+	void CalcField(FDTD_FLOAT**** field, unsigned int numThreads=1);
+	//! Calculate the defined field for the x-lines [\a startX, \a stopX) only.
+	void CalcFieldRange(FDTD_FLOAT**** field, unsigned int startX, unsigned int stopX) const;
+	//! Thread pool job running CalcFieldRange()
+	class CalcFieldJob;
 };
 
 #endif // PROCESSFIELDS_H
@@ -19,23 +19,40 @@
 #include "Common/operator_base.h"
 #include "tools/vtk_file_writer.h"
 #include "tools/hdf5_file_writer.h"
+#include "tools/useful.h"
+#include "tools/thread_pool.h"
 #include <iomanip>
 #include <sstream>
 #include <string>
 
+//! number of cells accumulated for all frequencies at once, the time domain block stays in the L1 cache
+#define FD_BLOCK_SIZE 1024
+//! number of recursive phasor updates before the phasors are recalculated
+#define FD_PHASOR_RESYNC 1024
+
 using namespace std;
 
 ProcessFieldsFD::ProcessFieldsFD(Engine_Interface_Base* eng_if) : ProcessFields(eng_if)
 {
+	m_NumCells = 0;
+	m_FD_Real = NULL;
+	m_FD_Imag = NULL;
+	m_NextPhasorTS = 0;
+	m_PhasorCount = FD_PHASOR_RESYNC;
+	m_NumThreads = 1;
+	m_TD_Field = NULL;
 }
 
 ProcessFieldsFD::~ProcessFieldsFD()
 {
-	for (size_t n = 0; n<m_FD_Fields.size(); ++n)
-	{
-		Delete_N_3DArray(m_FD_Fields.at(n),numLines);
-	}
-	m_FD_Fields.clear();
+	if (m_FD_Real)
+		FreeArrayData(m_FD_Real);
+	m_FD_Real = NULL;
+	if (m_FD_Imag)
+		FreeArrayData(m_FD_Imag);
+	m_FD_Imag = NULL;
+	Delete_N_3DArray<FDTD_FLOAT>(m_TD_Field,numLines);
+	m_TD_Field = NULL;
 }
 
 void ProcessFieldsFD::InitProcess()
@@ -62,12 +79,33 @@ void ProcessFieldsFD::InitProcess()
 	}
 
 	//create data structures...
-	for (size_t n = 0; n<m_FD_Samples.size(); ++n)
+	m_NumCells = (size_t)numLines[0]*numLines[1]*numLines[2];
+	m_FD_Real = (float*)AllocArrayData(sizeof(float)*3*m_FD_Samples.size()*m_NumCells);
+	m_FD_Imag = (float*)AllocArrayData(sizeof(float)*3*m_FD_Samples.size()*m_NumCells);
+	m_TD_Field = Create_N_3DArray<FDTD_FLOAT>(numLines);
+
+	// interpolate and accumulate with the threads of the engine, they are idle during the processing
+	m_NumThreads = max(m_Eng_Interface->GetNumberOfThreads(), 1u);
+
+	m_Phasor.resize(m_FD_Samples.size());
+	m_PhasorStep.resize(m_FD_Samples.size());
+	m_Phasor_Real.resize(m_FD_Samples.size());
+	m_Phasor_Imag.resize(m_FD_Samples.size());
+	m_PhasorCount = FD_PHASOR_RESYNC;
+}
+
+class ProcessFieldsFD::AddSampleJob : public ThreadPool::RangeJob
+{
+public:
+	AddSampleJob(ProcessFieldsFD* proc, FDTD_FLOAT**** field_td) : m_Proc(proc), m_Field(field_td) {}
+	virtual void Run(unsigned int start, unsigned int stop, unsigned int)
 	{
-		std::complex<float>**** field_fd = Create_N_3DArray<std::complex<float> >(numLines);
-		m_FD_Fields.push_back(field_fd);
+		m_Proc->AddSampleRange(m_Field, (size_t)start*FD_BLOCK_SIZE, min((size_t)(stop+1)*FD_BLOCK_SIZE, m_Proc->m_NumCells));
 	}
-}
+protected:
+	ProcessFieldsFD* m_Proc;
+	FDTD_FLOAT**** m_Field;
+};
 
 int ProcessFieldsFD::Process()
 {
@@ -77,33 +115,86 @@ int ProcessFieldsFD::Process()
 	if ((m_FD_Interval==0) || (m_Eng_Interface->GetNumberOfTimesteps()%m_FD_Interval!=0))
 		return GetNextInterval();
 
-	FDTD_FLOAT**** field_td = CalcField();
-	std::complex<float>**** field_fd = NULL;
+	CalcField(m_TD_Field, m_NumThreads);
+	UpdatePhasors();
+
+	// split the cell blocks over the workers of the shared pool, small dumps are not worth waking up the workers
+	size_t numBlocks = (m_NumCells + FD_BLOCK_SIZE - 1) / FD_BLOCK_SIZE;
+	unsigned int maxThreads = (unsigned int)((double)m_NumCells*m_FD_Samples.size()/1e5) + 1;
+	AddSampleJob job(this, m_TD_Field);
+	ThreadPool::GetShared().RunRangeJob(&job, numBlocks, min(m_NumThreads, maxThreads));
+
+	++m_FD_SampleCount;
+	return GetNextInterval();
+}
+
+void ProcessFieldsFD::UpdatePhasors()
+{
+	unsigned int numTS = m_Eng_Interface->GetNumberOfTimesteps();
+	// start the recursion on the first sample, after a skipped sample and periodically to limit the accumulated rounding errors
+	if ((numTS!=m_NextPhasorTS) || (m_PhasorCount>=FD_PHASOR_RESYNC))
+	{
+		double T = m_Eng_Interface->GetTime(m_dualTime);
+		double dT = Op->GetTimestep() * m_FD_Interval;
+		for (size_t n = 0; n<m_FD_Samples.size(); ++n)
+		{
+			// *2 for single-sided spectrum, multiply with timestep-interval
+			m_Phasor.at(n) = std::exp( std::complex<double>(0, -2.0 * M_PI * m_FD_Samples.at(n) * T) ) * (2.0 * dT);
+			m_PhasorStep.at(n) = std::exp( std::complex<double>(0, -2.0 * M_PI * m_FD_Samples.at(n) * dT) );
+		}
+		m_PhasorCount = 0;
+	}
+	else
+	{
+		for (size_t n = 0; n<m_FD_Samples.size(); ++n)
+			m_Phasor.at(n) *= m_PhasorStep.at(n);
+	}
+	m_NextPhasorTS = numTS + m_FD_Interval;
+	++m_PhasorCount;
 
-	double T = m_Eng_Interface->GetTime(m_dualTime);
-	unsigned int pos[3];
 	for (size_t n = 0; n<m_FD_Samples.size(); ++n)
 	{
-		std::complex<float> exp_jwt_2_dt = std::exp( (std::complex<float>)(-2.0 * _I * M_PI * m_FD_Samples.at(n) * T) );
-		exp_jwt_2_dt *= 2; // *2 for single-sided spectrum
-		exp_jwt_2_dt *= Op->GetTimestep() * m_FD_Interval; // multiply with timestep-interval
-		field_fd = m_FD_Fields.at(n);
-		for (pos[0]=0; pos[0]<numLines[0]; ++pos[0])
+		m_Phasor_Real.at(n) = (float)real(m_Phasor.at(n));
+		m_Phasor_Imag.at(n) = (float)imag(m_Phasor.at(n));
+	}
+}
+
+void ProcessFieldsFD::AddSampleRange(FDTD_FLOAT**** field_td, size_t start, size_t stop)
+{
+	size_t numFreq = m_FD_Samples.size();
+	for (size_t blockStart=start; blockStart<stop; blockStart+=FD_BLOCK_SIZE)
+	{
+		size_t blockStop = min(blockStart+FD_BLOCK_SIZE, stop);
+		for (int c=0; c<3; ++c)
 		{
-			for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
+			const FDTD_FLOAT* td = Get3DArrayData(field_td[c]);
+			for (size_t n=0; n<numFreq; ++n)
 			{
-				for (pos[2]=0; pos[2]<numLines[2]; ++pos[2])
+				const float p_re = m_Phasor_Real[n];
+				const float p_im = m_Phasor_Imag[n];
+				float* fd_re = m_FD_Real + (n*3+c)*m_NumCells;
+				float* fd_im = m_FD_Imag + (n*3+c)*m_NumCells;
+				// contiguous and independent, vectorized by the compiler
+				for (size_t i=blockStart; i<blockStop; ++i)
 				{
-					field_fd[0][pos[0]][pos[1]][pos[2]] += field_td[0][pos[0]][pos[1]][pos[2]] * exp_jwt_2_dt;
-					field_fd[1][pos[0]][pos[1]][pos[2]] += field_td[1][pos[0]][pos[1]][pos[2]] * exp_jwt_2_dt;
-					field_fd[2][pos[0]][pos[1]][pos[2]] += field_td[2][pos[0]][pos[1]][pos[2]] * exp_jwt_2_dt;
+					fd_re[i] += td[i] * p_re;
+					fd_im[i] += td[i] * p_im;
 				}
 			}
 		}
 	}
-	Delete_N_3DArray<FDTD_FLOAT>(field_td,numLines);
-	++m_FD_SampleCount;
-	return GetNextInterval();
+}
+
+void ProcessFieldsFD::GetFDField(size_t n, std::complex<float>**** field) const
+{
+	for (int c=0; c<3; ++c)
+	{
+		const float* fd_re = m_FD_Real + (n*3+c)*m_NumCells;
+		const float* fd_im = m_FD_Imag + (n*3+c)*m_NumCells;
+		std::complex<float>* out = Get3DArrayData(field[c]);
+		for (size_t i=0; i<m_NumCells; ++i)
+			out[i] = std::complex<float>(fd_re[i], fd_im[i]);
+	}
 }
 
 void ProcessFieldsFD::PostProcess()
@@ -111,24 +202,48 @@ void ProcessFieldsFD::PostProcess()
 	DumpFDData();
 }
 
+bool ProcessFieldsFD::WriteState(ostream &state)
+{
+	if (ProcessFields::WriteState(state)==false)
+		return false;
+	if (m_FD_Real && m_FD_Imag)
+	{
+		state.write((const char*)m_FD_Real, sizeof(float)*3*m_FD_Samples.size()*m_NumCells);
+		state.write((const char*)m_FD_Imag, sizeof(float)*3*m_FD_Samples.size()*m_NumCells);
+	}
+	return state.good();
+}
+
+bool ProcessFieldsFD::ReadState(istream &state)
+{
+	if (ProcessFields::ReadState(state)==false)
+		return false;
+	if (m_FD_Real && m_FD_Imag)
+	{
+		state.read((char*)m_FD_Real, sizeof(float)*3*m_FD_Samples.size()*m_NumCells);
+		state.read((char*)m_FD_Imag, sizeof(float)*3*m_FD_Samples.size()*m_NumCells);
+	}
+	return state.good();
+}
+
 void ProcessFieldsFD::DumpFDData()
 {
 	if (m_fileType==VTK_FILETYPE)
 	{
 		unsigned int pos[3];
 		FDTD_FLOAT**** field = Create_N_3DArray<float>(numLines);
-		std::complex<float>**** field_fd = NULL;
+		std::complex<float>**** field_fd = Create_N_3DArray<std::complex<float> >(numLines);
 		double angle=0;
 		int Nr_Ph = 21;
 
 		for (size_t n = 0; n<m_FD_Samples.size(); ++n)
 		{
+			GetFDField(n, field_fd);
 			//dump multiple phase to vtk-files
 			for (int p=0; p<Nr_Ph; ++p)
 			{
 				angle = 2.0 * M_PI * p / Nr_Ph;
 				std::complex<float> exp_jwt = std::exp( (std::complex<float>)( _I * angle) );
-				field_fd = m_FD_Fields.at(n);
 				for (pos[0]=0; pos[0]<numLines[0]; ++pos[0])
 				{
 					for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
@@ -198,17 +313,20 @@ void ProcessFieldsFD::DumpFDData()
 			}
 		}
 		Delete_N_3DArray(field,numLines);
+		Delete_N_3DArray(field_fd,numLines);
 		return;
 	}
 
 	if (m_fileType==HDF5_FILETYPE)
 	{
+		std::complex<float>**** field_fd = Create_N_3DArray<std::complex<float> >(numLines);
 		for (size_t n = 0; n<m_FD_Samples.size(); ++n)
 		{
+			GetFDField(n, field_fd);
 			stringstream ss;
 			ss << "f" << n;
 			size_t datasize[]={numLines[0],numLines[1],numLines[2]};
-			if (m_HDF5_Dump_File->WriteVectorField(ss.str(), m_FD_Fields.at(n), datasize)==false)
+			if (m_HDF5_Dump_File->WriteVectorField(ss.str(), field_fd, datasize)==false)
 				cerr << "ProcessFieldsFD::Process: can't dump to file...! " << endl;
 
 			//legacy support, use /FieldData/FD frequency-Attribute in the future
@@ -218,6 +336,7 @@ void ProcessFieldsFD::DumpFDData()
 			if (m_HDF5_Dump_File->WriteAtrribute("/FieldData/FD/"+ss.str()+"_imag","frequency",freq,1)==false)
 				cerr << "ProcessFieldsFD::Process: can't dump to file...! " << endl;
 		}
+		Delete_N_3DArray(field_fd,numLines);
 		return;
 	}
 
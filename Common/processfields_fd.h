@@ -33,11 +33,44 @@ public:
 	virtual int Process();
 	virtual void PostProcess();
 
+	virtual bool WriteState(std::ostream &state);
+	virtual bool ReadState(std::istream &state);
+
+	//! Get the number of frequencies
+	size_t GetNumberOfFrequencies() const {return m_FD_Samples.size();}
+	//! Get the accumulated frequency domain field of frequency index \a n, the \a field array has to be allocated by the caller
+	void GetFDField(size_t n, std::complex<float>**** field) const;
+
 protected:
 	virtual void DumpFDData();
 
-	//! frequency domain field storage
-	std::vector<std::complex<float>****> m_FD_Fields;
+	//! Update the phasors exp(-j*2*pi*f*T) of all frequencies for the current timestep
+	void UpdatePhasors();
+	//! Accumulate the cells [\a start, \a stop) of the time domain field \a field_td into all frequencies
+	void AddSampleRange(FDTD_FLOAT**** field_td, size_t start, size_t stop);
+	//! Thread pool job running AddSampleRange() for a range of cell blocks
+	class AddSampleJob;
+
+	//! number of cells of a single field component
+	size_t m_NumCells;
+	//! frequency domain field accumulators (structure-of-arrays), component \a c of frequency \a n starts at (n*3+c)*m_NumCells
+	float* m_FD_Real;
+	float* m_FD_Imag;
+
+	//! running phasors (including the single-sided spectrum factor and the sample interval) and their step per sample
+	std::vector<std::complex<double> > m_Phasor;
+	std::vector<std::complex<double> > m_PhasorStep;
+	//! single precision copy of the current phasors
+	std::vector<float> m_Phasor_Real;
+	std::vector<float> m_Phasor_Imag;
+	//! timestep continuing the phasor recursion, the phasors are recalculated for any other timestep
+	unsigned int m_NextPhasorTS;
+	unsigned int m_PhasorCount;
+
+	//! number of threads used for the interpolation and accumulation
+	unsigned int m_NumThreads;
+	//! reused buffer of the interpolated time domain field
+	FDTD_FLOAT**** m_TD_Field;
 };
 
 #endif // PROCESSFIELDS_FD_H
@@ -177,6 +177,28 @@ int ProcessFieldsSAR::Process()
 	return GetNextInterval();
 }
 
+bool ProcessFieldsSAR::WriteState(ostream &state)
+{
+	if (ProcessFieldsFD::WriteState(state)==false)
+		return false;
+	for (size_t n = 0; n<m_E_FD_Fields.size(); ++n)
+		Write_N_3DArray(state, m_E_FD_Fields.at(n), numLines);
+	for (size_t n = 0; n<m_J_FD_Fields.size(); ++n)
+		Write_N_3DArray(state, m_J_FD_Fields.at(n), numLines);
+	return state.good();
+}
+
+bool ProcessFieldsSAR::ReadState(istream &state)
+{
+	if (ProcessFieldsFD::ReadState(state)==false)
+		return false;
+	for (size_t n = 0; n<m_E_FD_Fields.size(); ++n)
+		Read_N_3DArray(state, m_E_FD_Fields.at(n), numLines);
+	for (size_t n = 0; n<m_J_FD_Fields.size(); ++n)
+		Read_N_3DArray(state, m_J_FD_Fields.at(n), numLines);
+	return state.good();
+}
+
 void ProcessFieldsSAR::DumpFDData()
 {
 	if (Enabled==false) return;
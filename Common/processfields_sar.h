@@ -36,6 +36,9 @@ public:
 
 	virtual int Process();
 
+	virtual bool WriteState(std::ostream &state);
+	virtual bool ReadState(std::istream &state);
+
 	virtual void SetSubSampling(unsigned int subSampleRate, int dir=-1);
 
 	virtual void SetOptResolution(double optRes, int dir=-1);
@@ -19,19 +19,36 @@
 #include "Common/operator_base.h"
 #include "tools/vtk_file_writer.h"
 #include "tools/hdf5_file_writer.h"
+#include "tools/global.h"
 #include <iomanip>
 #include <sstream>
 #include <string>
 
 using namespace std;
 
+boost::mutex ProcessFieldsTD::s_WriteMutex;
+
 ProcessFieldsTD::ProcessFieldsTD(Engine_Interface_Base* eng_if) : ProcessFields(eng_if)
 {
 	pad_length = 8;
+	// the time domain dumps written before the checkpoint are kept
+	m_AppendOnResume = true;
+
+	m_NumThreads = 1;
+	m_WriterThread = NULL;
+	m_Pending = 0;
+	m_NumBuffers = 0;
+	m_MaxBuffers = 1;
+	m_StopWriter = false;
+	m_WriteFailed = false;
 }
 
 ProcessFieldsTD::~ProcessFieldsTD()
 {
+	StopWriter();
+	for (size_t n=0; n<m_FreeBuffers.size(); ++n)
+		Delete_N_3DArray<FDTD_FLOAT>(m_FreeBuffers.at(n),numLines);
+	m_FreeBuffers.clear();
 }
 
 void ProcessFieldsTD::InitProcess()
@@ -45,6 +62,32 @@ void ProcessFieldsTD::InitProcess()
 
 	if (m_HDF5_Dump_File)
 		m_HDF5_Dump_File->SetCurrentGroup("/FieldData/TD");
+
+	if (Enabled==false) return;
+
+	// interpolate with the threads of the engine, they are idle during the processing
+	m_NumThreads = max(m_Eng_Interface->GetNumberOfThreads(), 1u);
+
+	// one buffer more than queued dumps, the next dump is interpolated while the writer is busy
+	unsigned int queue = g_settings.GetFieldDumpQueue();
+	double bufferSize = 3.0*numLines[0]*numLines[1]*numLines[2]*sizeof(FDTD_FLOAT);
+	double maxMemory = g_settings.GetFieldDumpQueueMemory()*1048576.0;
+	if ((queue>0) && ((queue+1)*bufferSize>maxMemory))
+	{
+		unsigned int maxBuffers = (unsigned int)(maxMemory/bufferSize);
+		queue = maxBuffers>1 ? maxBuffers-1 : 0;
+		cerr << "ProcessFieldsTD::InitProcess: Warning, the buffered dumps of \"" << GetName() << "\" exceed the memory limit of " << g_settings.GetFieldDumpQueueMemory() << " MiB, ";
+		if (queue>0)
+			cerr << "buffering only " << queue << " dumps" << endl;
+		else
+			cerr << "writing the dumps synchronously" << endl;
+	}
+	m_MaxBuffers = queue + 1;
+	if ((queue>0) && (m_WriterThread==NULL))
+	{
+		m_StopWriter = false;
+		m_WriterThread = new boost::thread( &ProcessFieldsTD::WriterLoop, this );
+	}
 }
 
 int ProcessFieldsTD::Process()
@@ -52,14 +95,135 @@ int ProcessFieldsTD::Process()
 	if (Enabled==false) return -1;
 	if (CheckTimestep()==false) return GetNextInterval();
 
-	string filename = m_filename;
+	FDTD_FLOAT**** field = GetBuffer();
+	CalcField(field, m_NumThreads);
+
+	DumpJob job;
+	job.field = field;
+	job.timestep = m_Eng_Interface->GetNumberOfTimesteps();
+	job.time = (float)m_Eng_Interface->GetTime(m_dualTime);
 
-	float**** field = CalcField();
 	bool success = true;
+	if (m_WriterThread==NULL)
+	{
+		success = WriteDump(job.field, job.timestep, job.time);
+		m_FreeBuffers.push_back(field);
+	}
+	else
+	{
+		boost::lock_guard<boost::mutex> lock(m_QueueMutex);
+		m_Queue.push_back(job);
+		++m_Pending;
+		// report a failure of a previous dump
+		success = !m_WriteFailed;
+	}
+	m_QueueCond.notify_all();
 
+	if (success==false)
+	{
+		SetEnable(false);
+		cerr << "ProcessFieldsTD::Process: can't dump to file... disabled! " << endl;
+	}
+
+	return GetNextInterval();
+}
+
+void ProcessFieldsTD::SyncOutput()
+{
+	boost::unique_lock<boost::mutex> lock(m_QueueMutex);
+	while (m_Pending>0)
+		m_QueueCond.wait(lock);
+}
+
+void ProcessFieldsTD::PostProcess()
+{
+	StopWriter();
+	if (Enabled && m_WriteFailed)
+	{
+		SetEnable(false);
+		cerr << "ProcessFieldsTD::PostProcess: can't dump to file... disabled! " << endl;
+	}
+	ProcessFields::PostProcess();
+}
+
+bool ProcessFieldsTD::WriteState(ostream &state)
+{
+	// all dumps up to the checkpoint have to be on disk
+	SyncOutput();
+	return ProcessFields::WriteState(state);
+}
+
+FDTD_FLOAT**** ProcessFieldsTD::GetBuffer()
+{
+	boost::unique_lock<boost::mutex> lock(m_QueueMutex);
+	// back-pressure: wait for the writer if all buffers are queued
+	while (m_FreeBuffers.empty() && (m_NumBuffers>=m_MaxBuffers))
+		m_QueueCond.wait(lock);
+	if (!m_FreeBuffers.empty())
+	{
+		FDTD_FLOAT**** field = m_FreeBuffers.back();
+		m_FreeBuffers.pop_back();
+		return field;
+	}
+	++m_NumBuffers;
+	return Create_N_3DArray<FDTD_FLOAT>(numLines);
+}
+
+void ProcessFieldsTD::WriterLoop()
+{
+	while (true)
+	{
+		DumpJob job;
+		bool writeFailed;
+		{
+			boost::unique_lock<boost::mutex> lock(m_QueueMutex);
+			while (m_Queue.empty() && !m_StopWriter)
+				m_QueueCond.wait(lock);
+			// all remaining dumps are written before the thread stops
+			if (m_Queue.empty())
+				return;
+			job = m_Queue.front();
+			m_Queue.pop_front();
+			// skip all remaining dumps after a failure
+			writeFailed = m_WriteFailed;
+		}
+
+		bool success = false;
+		if (!writeFailed)
+			success = WriteDump(job.field, job.timestep, job.time);
+
+		{
+			boost::lock_guard<boost::mutex> lock(m_QueueMutex);
+			if (!success)
+				m_WriteFailed = true;
+			m_FreeBuffers.push_back(job.field);
+			--m_Pending;
+		}
+		m_QueueCond.notify_all();
+	}
+}
+
+void ProcessFieldsTD::StopWriter()
+{
+	if (m_WriterThread==NULL)
+		return;
+	{
+		boost::lock_guard<boost::mutex> lock(m_QueueMutex);
+		m_StopWriter = true;
+	}
+	m_QueueCond.notify_all();
+	m_WriterThread->join();
+	delete m_WriterThread;
+	m_WriterThread = NULL;
+}
+
+bool ProcessFieldsTD::WriteDump(FDTD_FLOAT**** field, unsigned int timestep, float time)
+{
+	boost::lock_guard<boost::mutex> lock(s_WriteMutex);
+	bool success = true;
 	if (m_fileType==VTK_FILETYPE)
 	{
-		m_Vtk_Dump_File->SetTimestep(m_Eng_Interface->GetNumberOfTimesteps());
+		m_Vtk_Dump_File->SetTimestep(timestep);
 		m_Vtk_Dump_File->ClearAllFields();
 		m_Vtk_Dump_File->AddVectorField(GetFieldNameByType(m_DumpType),field);
 		success &= m_Vtk_Dump_File->Write();
@@ -67,25 +231,16 @@ int ProcessFieldsTD::Process()
 	else if (m_fileType==HDF5_FILETYPE)
 	{
 		stringstream ss;
-		ss << std::setw( pad_length ) << std::setfill( '0' ) << m_Eng_Interface->GetNumberOfTimesteps();
+		ss << std::setw( pad_length ) << std::setfill( '0' ) << timestep;
 		size_t datasize[]={numLines[0],numLines[1],numLines[2]};
 		success &= m_HDF5_Dump_File->WriteVectorField(ss.str(), field, datasize);
-		float time[1] = {(float)m_Eng_Interface->GetTime(m_dualTime)};
-		success &= m_HDF5_Dump_File->WriteAtrribute("/FieldData/TD/"+ss.str(),"time",time,1);
+		float t[1] = {time};
+		success &= m_HDF5_Dump_File->WriteAtrribute("/FieldData/TD/"+ss.str(),"time",t,1);
 	}
 	else
 	{
 		success = false;
-		cerr << "ProcessFieldsTD::Process: unknown File-Type" << endl;
-	}
-
-	Delete_N_3DArray<FDTD_FLOAT>(field,numLines);
-
-	if (success==false)
-	{
-		SetEnable(false);
-		cerr << "ProcessFieldsTD::Process: can't dump to file... disabled! " << endl;
+		cerr << "ProcessFieldsTD::WriteDump: unknown File-Type" << endl;
 	}
-
-	return GetNextInterval();
+	return success;
 }
@@ -18,8 +18,15 @@
 #ifndef PROCESSFIELDS_TD_H
 #define PROCESSFIELDS_TD_H
 
+#include <deque>
+#include <boost/thread.hpp>
 #include "processfields.h"
 
+/*!
+  Time domain field dump.
+  The fields are interpolated (multithreaded) into pooled buffers and written by a background writer thread.
+  The timestep loop is only stalled if the writer falls behind by more than the queue length (see Global::GetFieldDumpQueue()).
+  */
 class ProcessFieldsTD : public ProcessFields
 {
 public:
@@ -32,11 +39,50 @@ public:
 
 	virtual int Process();
 
+	virtual void SyncOutput();
+	virtual void PostProcess();
+
+	virtual bool WriteState(std::ostream &state);
+
 	//! Set the length of the filename timestep pad filled with zeros (default is 8)
 	void SetPadLength(int val) {pad_length=val;};
 
 protected:
 	int pad_length;
+
+	//! number of threads used to interpolate the fields
+	unsigned int m_NumThreads;
+
+	struct DumpJob
+	{
+		FDTD_FLOAT**** field;
+		unsigned int timestep;
+		float time;
+	};
+
+	//! Background writer thread, NULL if the dumps are written synchronously
+	boost::thread* m_WriterThread;
+	boost::mutex m_QueueMutex;
+	boost::condition_variable m_QueueCond;
+	//! interpolated fields waiting for the writer
+	std::deque<DumpJob> m_Queue;
+	//! number of dumps queued or currently written
+	unsigned int m_Pending;
+	//! pool of reusable field buffers
+	std::vector<FDTD_FLOAT****> m_FreeBuffers;
+	unsigned int m_NumBuffers;
+	unsigned int m_MaxBuffers;
+	bool m_StopWriter;
+	bool m_WriteFailed;
+
+	//! Get a free field buffer, waits for the writer if all buffers are in use
+	FDTD_FLOAT**** GetBuffer();
+	void WriterLoop();
+	void StopWriter();
+	bool WriteDump(FDTD_FLOAT**** field, unsigned int timestep, float time);
+
+	//! the hdf5 and vtk libraries are not thread-safe, all background writers have to share this lock
+	static boost::mutex s_WriteMutex;
 };
 
 #endif // PROCESSFIELDS_TD_H
@@ -20,6 +20,7 @@
 #include "Common/operator_base.h"
 #include <algorithm>
 #include "processing.h"
+#include "processintegral_batch.h"
 #include <climits>
 
 using namespace std;
@@ -32,6 +33,7 @@ Processing::Processing(Engine_Interface_Base* eng_if)
 	Enabled = true;
 	m_PS_pos = 0;
 	SetPrecision(12);
+	m_BinaryOutput = false;
 	ProcessInterval=0;
 	m_FD_SampleCount=0;
 	m_FD_Interval=0;
@@ -41,6 +43,7 @@ Processing::Processing(Engine_Interface_Base* eng_if)
 	m_dualTime = false;
 	m_SnapMethod = 0;
 	m_Mesh_Type = CARTESIAN_MESH;
+	m_Resume = false;
 
 	startTS=0;
 	stopTS =UINT_MAX;
@@ -230,7 +233,16 @@ void Processing::OpenFile( string outfile )
 	if (file.is_open())
 		file.close();
 
-	file.open( outfile.c_str() );
+	ios::openmode binary = m_BinaryOutput ? ios::binary : ios::openmode();
+	if (m_Resume)
+	{
+		// keep the existing data, all data written beyond the checkpoint is removed by ReadState()
+		file.open( outfile.c_str(), ios::in | ios::out | ios::ate | binary );
+		if (!file.is_open())
+			cerr << "Processing::OpenFile: Warning, can't resume file: " << outfile << ", creating a new file" << endl;
+	}
+	if (!file.is_open())
+		file.open( outfile.c_str(), ios::out | ios::trunc | binary );
 	if (!file.is_open())
 		cerr << "Can't open file: " << outfile << endl;
 
@@ -242,6 +254,61 @@ void Processing::PostProcess()
 	FlushData();
 }
 
+bool Processing::WriteState(ostream &state)
+{
+	uint64_t ps_pos = m_PS_pos;
+	state.write((const char*)&ps_pos, sizeof(ps_pos));
+	state.write((const char*)&m_FD_SampleCount, sizeof(m_FD_SampleCount));
+	char enabled = Enabled;
+	state.write(&enabled, 1);
+
+	// position of the time domain output file, -1 if not used
+	int64_t filePos = -1;
+	if (file.is_open())
+	{
+		file.flush();
+		filePos = file.tellp();
+	}
+	state.write((const char*)&filePos, sizeof(filePos));
+	return state.good();
+}
+
+bool Processing::ReadState(istream &state)
+{
+	uint64_t ps_pos = 0;
+	state.read((char*)&ps_pos, sizeof(ps_pos));
+	m_PS_pos = ps_pos;
+	state.read((char*)&m_FD_SampleCount, sizeof(m_FD_SampleCount));
+	char enabled = 0;
+	state.read(&enabled, 1);
+	// a processing may have been disabled during the run, e.g. due to a write error
+	if (!enabled)
+		Enabled = false;
+
+	int64_t filePos = -1;
+	state.read((char*)&filePos, sizeof(filePos));
+	if (!state.good())
+		return false;
+
+	if (file.is_open() && (filePos>=0))
+	{
+		// remove everything written after the checkpoint and continue the file
+		file.close();
+		if (TruncateFile(m_filename, filePos)==false)
+		{
+			cerr << "Processing::ReadState: Error, can't resume file: " << m_filename << endl;
+			return false;
+		}
+		file.open( m_filename.c_str(), ios::out | ios::app | (m_BinaryOutput ? ios::binary : ios::openmode()) );
+		if (!file.is_open())
+		{
+			cerr << "Processing::ReadState: Error, can't open file: " << m_filename << endl;
+			return false;
+		}
+	}
+	return true;
+}
+
 void Processing::DumpBox2File( string vtkfilenameprefix, bool dualMesh ) const
 {
 	string vtkfilename = vtkfilenameprefix + m_filename + ".vtk";
@@ -320,6 +387,29 @@ void ProcessingArray::InitAll()
 	{
 		ProcessArray.at(i)->InitProcess();
 	}
+
+	delete m_IntegralBatch;
+	m_IntegralBatch = NULL;
+	if (m_BatchIntegrals==false)
+		return;
+
+	m_IntegralBatch = new ProcessIntegralBatch();
+	size_t numIntegrals = 0;
+	for (size_t i=0; i<ProcessArray.size(); ++i)
+	{
+		ProcessIntegral* proc = dynamic_cast<ProcessIntegral*>(ProcessArray.at(i));
+		if ((proc==NULL) || (proc->GetEnable()==false))
+			continue;
+		++numIntegrals;
+		m_IntegralBatch->AddIntegral(proc);
+	}
+	if (g_settings.GetVerboseLevel()>0)
+		cout << "ProcessingArray::InitAll: Batched " << m_IntegralBatch->GetNumberOfIntegrals() << " of " << numIntegrals << " integral processings (" << m_IntegralBatch->GetNumberOfEntries() << " field values)" << endl;
+	if (m_IntegralBatch->GetNumberOfIntegrals()==0)
+	{
+		delete m_IntegralBatch;
+		m_IntegralBatch = NULL;
+	}
 }
 
 void ProcessingArray::FlushNext()
@@ -340,6 +430,8 @@ void ProcessingArray::Reset()
 
 void ProcessingArray::DeleteAll()
 {
+	delete m_IntegralBatch;
+	m_IntegralBatch = NULL;
 	for (size_t i=0; i<ProcessArray.size(); ++i)
 	{
 		delete ProcessArray.at(i);
@@ -355,7 +447,9 @@ void ProcessingArray::PreProcess()
 int ProcessingArray::Process()
 {
 	int nextProcess=maxInterval;
-	//this could be done nicely in parallel??
+	// all batched integrals are processed at once, their Process() only returns the next interval
+	if (m_IntegralBatch)
+		m_IntegralBatch->Process();
 	for (size_t i=0; i<ProcessArray.size(); ++i)
 	{
 		int step = ProcessArray.at(i)->Process();
@@ -365,8 +459,69 @@ int ProcessingArray::Process()
 	return nextProcess;
 }
 
+int ProcessingArray::GetNextInterval() const
+{
+	int nextProcess=maxInterval;
+	for (size_t i=0; i<ProcessArray.size(); ++i)
+	{
+		int step = ProcessArray.at(i)->GetNextInterval();
+		if ((step>0) && (step<nextProcess))
+			nextProcess=step;
+	}
+	return nextProcess;
+}
+
+void ProcessingArray::SetResume(bool val)
+{
+	for (size_t i=0; i<ProcessArray.size(); ++i)
+		ProcessArray.at(i)->SetResume(val);
+}
+
+bool ProcessingArray::WriteState(ostream &state)
+{
+	if (m_IntegralBatch)
+		m_IntegralBatch->StoreFDResults();
+	unsigned int numProc = ProcessArray.size();
+	state.write((const char*)&numProc, sizeof(numProc));
+	for (size_t i=0; i<ProcessArray.size(); ++i)
+	{
+		if (ProcessArray.at(i)->WriteState(state)==false)
+		{
+			cerr << "ProcessingArray::WriteState: Error, writing the state of processing \"" << ProcessArray.at(i)->GetName() << "\" failed" << endl;
+			return false;
+		}
+	}
+	return state.good();
+}
+
+bool ProcessingArray::ReadState(istream &state)
+{
+	unsigned int numProc = 0;
+	state.read((char*)&numProc, sizeof(numProc));
+	if (!state.good() || (numProc!=ProcessArray.size()))
+	{
+		cerr << "ProcessingArray::ReadState: Error, the number of processings does not match" << endl;
+		return false;
+	}
+	for (size_t i=0; i<ProcessArray.size(); ++i)
+	{
+		if (ProcessArray.at(i)->ReadState(state)==false)
+		{
+			cerr << "ProcessingArray::ReadState: Error, reading the state of processing \"" << ProcessArray.at(i)->GetName() << "\" failed" << endl;
+			return false;
+		}
+	}
+	if (m_IntegralBatch)
+		m_IntegralBatch->LoadFDResults();
+	return true;
+}
+
 void ProcessingArray::PostProcess()
 {
+	// finish all background output first, the post-processing may write to the same files or libraries
+	for (size_t i=0; i<ProcessArray.size(); ++i) ProcessArray.at(i)->SyncOutput();
+	if (m_IntegralBatch)
+		m_IntegralBatch->StoreFDResults();
 	for (size_t i=0; i<ProcessArray.size(); ++i) ProcessArray.at(i)->PostProcess();
 }
 
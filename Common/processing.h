@@ -40,6 +40,7 @@ typedef std::complex<double> double_complex;
 #include "Common/engine_interface_base.h"
 
 class Operator_Base;
+class ProcessIntegralBatch;
 
 class Processing
 {
@@ -96,11 +97,15 @@ public:
 	//! Invoke this flag to flush all stored data to disk
 	virtual void FlushNext() {m_Flush = true;}
 	virtual void FlushData() {};
+	//! Wait until all pending output, e.g. of a background writer, is written.
+	virtual void SyncOutput() {};
 
 	void SetMeshType(MeshType meshType) {m_Mesh_Type=meshType;}
 
 	//! Set the dump precision
 	void SetPrecision(unsigned int val) {m_precision = val;}
+	//! Write the output files in the binary probe format instead of ASCII, has to be set before InitProcess(). Only used by integral processings. \sa ProcessIntegral
+	void SetBinaryOutput(bool val) {m_BinaryOutput = val;}
 
 	//! Dump probe geometry to file (will obay main or dual mesh property)
 	virtual void DumpBox2File(std::string vtkfilenameprefix) const {DumpBox2File(vtkfilenameprefix,m_dualMesh);}
@@ -111,6 +116,16 @@ public:
 	virtual void SetDualMesh(bool val) {m_dualMesh=val;}
 	virtual void SetDualTime(bool val) {m_dualTime=val;}
 
+	//! Get the number of timesteps until this processing has to be processed again, -1 if disabled
+	int GetNextInterval() const;
+
+	//! Resume a simulation from a checkpoint: continue the existing output files instead of replacing them. Has to be set before InitProcess()
+	void SetResume(bool val) {m_Resume=val;}
+	//! Write the internal state (processing step, accumulated frequency domain data and output file position) to a binary stream, needed for a checkpoint of the simulation. \sa ReadState
+	virtual bool WriteState(std::ostream &state);
+	//! Restore the state written by WriteState, has to be called after InitProcess()
+	virtual bool ReadState(std::istream &state);
+
 protected:
 	Processing(Engine_Interface_Base* eng_if);
 	Engine_Interface_Base* m_Eng_Interface;
@@ -118,6 +133,8 @@ protected:
 	MeshType m_Mesh_Type;
 
 	unsigned int m_precision;
+	//! write binary instead of ASCII output files, see SetBinaryOutput()
+	bool m_BinaryOutput;
 
 	std::string m_Name;
 
@@ -127,7 +144,9 @@ protected:
 
 	bool Enabled;
 
-	int GetNextInterval() const;
+	//! resume the output files of a previous run, see SetResume()
+	bool m_Resume;
+
 	unsigned int ProcessInterval;
 
 	size_t m_PS_pos; //! current position in list of processing steps
@@ -172,7 +191,7 @@ protected:
 class ProcessingArray
 {
 public:
-	ProcessingArray(unsigned int maximalInterval) {maxInterval=maximalInterval;}
+	ProcessingArray(unsigned int maximalInterval) {maxInterval=maximalInterval; m_BatchIntegrals=false; m_IntegralBatch=NULL;}
 	~ProcessingArray() {};
 
 	void AddProcessing(Processing* proc);
@@ -200,11 +219,27 @@ public:
 
 	size_t GetNumberOfProcessings() const {return ProcessArray.size();}
 
+	//! Get the smallest next iteration interval of all processings, without processing.
+	int GetNextInterval() const;
+
+	//! Resume the output files of all processings from a checkpoint, has to be set before InitAll() \sa Processing::SetResume
+	void SetResume(bool val);
+	//! Write the state of all processings to a binary stream \sa Processing::WriteState
+	bool WriteState(std::ostream &state);
+	//! Restore the state of all processings \sa Processing::ReadState
+	bool ReadState(std::istream &state);
+
 	Processing* GetProcessing(size_t number) {return ProcessArray.at(number);}
 
+	//! Evaluate all supported integral processings (voltage, current, field probe and mode matching) in a single batched pass per timestep, has to be set before InitAll() \sa ProcessIntegralBatch
+	void SetIntegralBatching(bool val) {m_BatchIntegrals=val;}
+
 protected:
 	unsigned int maxInterval;
 	std::vector<Processing*> ProcessArray;
+
+	bool m_BatchIntegrals;
+	ProcessIntegralBatch* m_IntegralBatch;
 };
 
 #endif // PROCESSING_H
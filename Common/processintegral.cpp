@@ -19,6 +19,9 @@
 #include "Common/operator_base.h"
 #include "time.h"
 #include <iomanip>
+#include <sstream>
+#include <stdint.h>
+#include <string.h>
 
 using namespace std;
 
@@ -27,10 +30,12 @@ ProcessIntegral::ProcessIntegral(Engine_Interface_Base* eng_if)  : Processing(en
 	m_Results=NULL;
 	m_FD_Results=NULL;
 	m_normDir = -1;
+	m_Batched = false;
 }
 
 ProcessIntegral::~ProcessIntegral()
 {
+	FlushBinaryData();
 	delete[] m_Results;
 	delete[] m_FD_Results;
 	m_Results = NULL;
@@ -51,25 +56,31 @@ void ProcessIntegral::InitProcess()
 
 	m_filename = m_Name;
 	OpenFile(m_filename);
+	m_BinaryBuffer.clear();
 
 	//write header
+	ostringstream header;
 	time_t rawTime;
 	time(&rawTime);
-	file << "% time-domain " << GetProcessingName() << " by openEMS " << GIT_VERSION << " @" << ctime(&rawTime);
-	file << "% start-coordinates: ("
+	header << "% time-domain " << GetProcessingName() << " by openEMS " << GIT_VERSION << " @" << ctime(&rawTime);
+	header << "% start-coordinates: ("
 	<< Op->GetDiscLine(0,start[0])*Op->GetGridDelta() << ","
 	<< Op->GetDiscLine(1,start[1])*Op->GetGridDelta() << ","
 	<< Op->GetDiscLine(2,start[2])*Op->GetGridDelta() << ") m -> [" << start[0] << "," << start[1] << "," << start[2] << "]" << endl;
-	file << "% stop-coordinates: ("
+	header << "% stop-coordinates: ("
 	<< Op->GetDiscLine(0,stop[0])*Op->GetGridDelta() << ","
 	<< Op->GetDiscLine(1,stop[1])*Op->GetGridDelta() << ","
 	<< Op->GetDiscLine(2,stop[2])*Op->GetGridDelta() << ") m -> [" << stop[0] << "," << stop[1] << "," << stop[2] << "]" << endl;
-	file << "% t/s";
+	header << "% t/s";
 	for (int n=0;n<GetNumberOfIntegrals();++n)
 	{
-		file << "\t" << GetIntegralName(n);
+		header << "\t" << GetIntegralName(n);
 	}
-	file << endl;
+	header << endl;
+	if (m_BinaryOutput)
+		WriteBinaryHeader(file, header.str(), GetNumberOfIntegrals()+1);
+	else
+		file << header.str() << flush;
 
 	for (int i=0;i<GetNumberOfIntegrals();++i)
 	{
@@ -84,6 +95,7 @@ void ProcessIntegral::FlushData()
 {
 	if (!Enabled)
 		return;
+	FlushBinaryData();
 	if (m_FD_Samples.size())
 		Dump_FD_Data(1.0,m_filename + "_FD");
 }
@@ -94,32 +106,53 @@ void ProcessIntegral::Dump_FD_Data(double factor, string filename)
 	if (m_FD_Samples.size()==0)
 		return;
 	ofstream file;
-	file.open( filename.c_str() );
+	file.open( filename.c_str(), ios::out | ios::trunc | (m_BinaryOutput ? ios::binary : ios::openmode()) );
 	if (!file.is_open())
 		cerr << "ProcessIntegral::Dump_FD_Data: Error: Can't open file: " << filename << endl;
 
 	//write header
+	ostringstream header;
 	time_t rawTime;
 	time(&rawTime);
-	file << "% frequency-domain " << GetProcessingName() << " by openEMS " << GIT_VERSION << " @" << ctime(&rawTime);
-	file << "% start-coordinates: ("
+	header << "% frequency-domain " << GetProcessingName() << " by openEMS " << GIT_VERSION << " @" << ctime(&rawTime);
+	header << "% start-coordinates: ("
 	<< Op->GetDiscLine(0,start[0])*Op->GetGridDelta() << ","
 	<< Op->GetDiscLine(1,start[1])*Op->GetGridDelta() << ","
 	<< Op->GetDiscLine(2,start[2])*Op->GetGridDelta() << ") m -> [" << start[0] << "," << start[1] << "," << start[2] << "]" << endl;
-	file << "% stop-coordinates: ("
+	header << "% stop-coordinates: ("
 	<< Op->GetDiscLine(0,stop[0])*Op->GetGridDelta() << ","
 	<< Op->GetDiscLine(1,stop[1])*Op->GetGridDelta() << ","
 	<< Op->GetDiscLine(2,stop[2])*Op->GetGridDelta() << ") m -> [" << stop[0] << "," << stop[1] << "," << stop[2] << "]" << endl;
-	file << "% f/Hz";
+	header << "% f/Hz";
 	for (int n=0;n<GetNumberOfIntegrals();++n)
 	{
-		file << "\t" << GetIntegralName(n) << "\t";
+		header << "\t" << GetIntegralName(n) << "\t";
 	}
-	file << endl << "%";
+	header << endl << "%";
 	for (int i = 0; i < GetNumberOfIntegrals();++i)
-		file << "\treal\timag";
-	file << endl;
+		header << "\treal\timag";
+	header << endl;
+
+	if (m_BinaryOutput)
+	{
+		int numColumns = 1+2*GetNumberOfIntegrals();
+		WriteBinaryHeader(file, header.str(), numColumns);
+		vector<double> data(m_FD_Samples.size()*numColumns);
+		for (size_t n=0; n<m_FD_Samples.size(); ++n)
+		{
+			data.at(n*numColumns) = m_FD_Samples.at(n);
+			for (int i = 0; i < GetNumberOfIntegrals();++i)
+			{
+				data.at(n*numColumns+1+2*i) = std::real(m_FD_Results[i].at(n))*factor;
+				data.at(n*numColumns+2+2*i) = std::imag(m_FD_Results[i].at(n))*factor;
+			}
+		}
+		WriteBinaryData(file, &data[0], data.size());
+		file.close();
+		return;
+	}
 
+	file << header.str();
 	for (size_t n=0; n<m_FD_Samples.size(); ++n)
 	{
 		file << m_FD_Samples.at(n) ;
@@ -134,6 +167,8 @@ void ProcessIntegral::Dump_FD_Data(double factor, string filename)
 int ProcessIntegral::Process()
 {
 	if (Enabled==false) return -1;
+	// the batch has already processed this timestep
+	if (m_Batched) return GetNextInterval();
 	if (CheckTimestep()==false) return GetNextInterval();
 
 	CalcMultipleIntegrals();
@@ -143,12 +178,7 @@ int ProcessIntegral::Process()
 	if (ProcessInterval)
 	{
 		if (m_Eng_Interface->GetNumberOfTimesteps()%ProcessInterval==0)
-		{
-			file << setprecision(m_precision) << time;
-			for (int n=0; n<NrInt; ++n)
-				file << "\t" << m_Results[n] * m_weight;
-			file << endl;
-		}
+			Dump_TD_Data(time);
 	}
 
 	if (m_FD_Interval)
@@ -170,8 +200,103 @@ int ProcessIntegral::Process()
 	return GetNextInterval();
 }
 
+void ProcessIntegral::Dump_TD_Data(double time)
+{
+	if (m_BinaryOutput)
+	{
+		m_BinaryBuffer.push_back(time);
+		for (int n=0; n<GetNumberOfIntegrals(); ++n)
+			m_BinaryBuffer.push_back(m_Results[n] * m_weight);
+		if (m_BinaryBuffer.size()>=PROBE_BINARY_BUFFER_SIZE)
+			FlushBinaryData();
+		return;
+	}
+	file << setprecision(m_precision) << time;
+	for (int n=0; n<GetNumberOfIntegrals(); ++n)
+		file << "\t" << m_Results[n] * m_weight;
+	file << endl;
+}
+
+void ProcessIntegral::WriteBinaryHeader(ostream &out, string text, unsigned int numColumns)
+{
+	// magic, version, number of columns and data offset, followed by the zero terminated text padded to a multiple of 8 bytes
+	uint64_t dataOffset = 24 + ((text.size()+1+7)/8)*8;
+	char header[24] = {0};
+	memcpy(header, PROBE_BINARY_MAGIC, 8);
+	uint64_t fields[3] = {PROBE_BINARY_VERSION, numColumns, dataOffset};
+	int sizes[3] = {4, 4, 8};
+	int pos = 8;
+	for (int f=0; f<3; ++f)
+		for (int b=0; b<sizes[f]; ++b)
+			header[pos++] = (char)((fields[f] >> (8*b)) & 0xff);
+	out.write(header, 24);
+	text.resize(dataOffset-24, '\0');
+	out.write(text.c_str(), text.size());
+}
+
+void ProcessIntegral::WriteBinaryData(ostream &out, const double* data, size_t num)
+{
+	const uint16_t endianTest = 1;
+	if (*(const char*)&endianTest==1)
+	{
+		out.write((const char*)data, sizeof(double)*num);
+		return;
+	}
+	// big-endian host, swap the bytes of every value
+	vector<char> swapped(sizeof(double)*num);
+	for (size_t n=0; n<num; ++n)
+		for (size_t b=0; b<sizeof(double); ++b)
+			swapped[n*sizeof(double)+b] = ((const char*)&data[n])[sizeof(double)-1-b];
+	out.write(&swapped[0], swapped.size());
+}
+
+void ProcessIntegral::FlushBinaryData()
+{
+	if (m_BinaryBuffer.size()==0)
+		return;
+	if (file.is_open())
+	{
+		WriteBinaryData(file, &m_BinaryBuffer[0], m_BinaryBuffer.size());
+		file.flush();
+	}
+	m_BinaryBuffer.clear();
+}
+
+bool ProcessIntegral::WriteState(ostream &state)
+{
+	// the file position stored by the checkpoint has to include all buffered data
+	FlushBinaryData();
+	if (Processing::WriteState(state)==false)
+		return false;
+	if (m_FD_Results==NULL)
+		return true;
+	for (int i=0; i<GetNumberOfIntegrals(); ++i)
+		if (m_FD_Results[i].size())
+			state.write((const char*)&m_FD_Results[i][0], sizeof(double_complex)*m_FD_Results[i].size());
+	return state.good();
+}
+
+bool ProcessIntegral::ReadState(istream &state)
+{
+	if (Processing::ReadState(state)==false)
+		return false;
+	if (m_FD_Results==NULL)
+		return true;
+	for (int i=0; i<GetNumberOfIntegrals(); ++i)
+		if (m_FD_Results[i].size())
+			state.read((char*)&m_FD_Results[i][0], sizeof(double_complex)*m_FD_Results[i].size());
+	return state.good();
+}
+
 double* ProcessIntegral::CalcMultipleIntegrals()
 {
 	m_Results[0] = CalcIntegral();
 	return m_Results;
 }
+
+double* ProcessIntegral::CalcIntegralsFromSamples(const double* samples)
+{
+	for (int n=0; n<GetNumberOfIntegrals(); ++n)
+		m_Results[n] = samples[n];
+	return m_Results;
+}
@@ -20,8 +20,26 @@
 
 #include "processing.h"
 
+class ProcessIntegralBatch;
+
+//! magic of the binary probe format, 8 bytes including the terminating zero
+#define PROBE_BINARY_MAGIC "OEMSPRB"
+#define PROBE_BINARY_VERSION 1
+//! number of values buffered before the binary time domain data is appended to the file
+#define PROBE_BINARY_BUFFER_SIZE 131072
+
 //! Abstract base class for integral parameter processing
 /*!
+  The time domain results are written as ASCII (default) or in the binary probe format (see Processing::SetBinaryOutput):
+  \code
+  char     magic[8];     // PROBE_BINARY_MAGIC
+  uint32   version;      // PROBE_BINARY_VERSION
+  uint32   numColumns;   // time/frequency and all results
+  uint64   dataOffset;   // size of the header, a multiple of 8
+  char     text[];       // the zero terminated ASCII header of the text format, padded with zeros up to dataOffset
+  float64  data[][numColumns];
+  \endcode
+  All numbers are little-endian. The binary data is buffered and appended in large chunks, it is written to disk on every flush.
   \todo Weighting is applied equally to all integral parameter --> todo: weighting for each result individually
   */
 class ProcessIntegral : public Processing
@@ -57,15 +75,45 @@ public:
 	//! This method will write the TD and FD dump files using CalcIntegral() to calculate the integral parameter
 	virtual int Process();
 
+	virtual bool WriteState(std::ostream &state);
+	virtual bool ReadState(std::istream &state);
+
+	//! Compile this integral processing into linear field samples of the \a batch, returns false if not supported. \sa ProcessIntegralBatch
+	/*!
+	  A derived class has to add a sample (ProcessIntegralBatch::AddSample) for every linear quantity needed, e.g. an integral or a field component.
+	  The results are calculated from these samples by CalcIntegralsFromSamples().
+	  */
+	virtual bool CompileGather(ProcessIntegralBatch*) {return false;}
+	//! Calculate the integral results from the samples compiled by CompileGather(), the default uses one sample per integral result.
+	virtual double* CalcIntegralsFromSamples(const double* samples);
+
+	//! True if this integral is processed by a ProcessIntegralBatch
+	bool IsBatched() const {return m_Batched;}
+
 protected:
 	ProcessIntegral(Engine_Interface_Base* eng_if);
 
 	void Dump_FD_Data(double factor, std::string filename);
+	//! Write the time domain results of the current timestep
+	void Dump_TD_Data(double time);
+
+	//! Write the header of the binary probe format with the given ASCII header \a text
+	static void WriteBinaryHeader(std::ostream &out, std::string text, unsigned int numColumns);
+	//! Write \a num doubles in little-endian byte order
+	static void WriteBinaryData(std::ostream &out, const double* data, size_t num);
+	//! Append the buffered binary time domain data to the file
+	void FlushBinaryData();
+	std::vector<double> m_BinaryBuffer;
 
 	std::vector<double_complex> *m_FD_Results;
 	double *m_Results;
 
 	int m_normDir; // normal direction as required by some integral processings
+
+	//! processed by a ProcessIntegralBatch, Process() will only return the next interval
+	bool m_Batched;
+
+	friend class ProcessIntegralBatch;
 };
 
 #endif // PROCESSINTEGRAL_H
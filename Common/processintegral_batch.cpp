@@ -0,0 +1,296 @@
+/*
+*	Copyright (C) 2026 openEMS contributors
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "processintegral_batch.h"
+#include "Common/operator_base.h"
+#include "tools/useful.h"
+#include "tools/thread_pool.h"
+
+//! minimal number of gather entries per thread, smaller batches are not worth the thread overhead
+#define BATCH_MIN_ENTRIES_PER_THREAD 20000
+//! number of recursive phasor updates before the phasors are recalculated
+#define BATCH_PHASOR_RESYNC 1024
+
+using namespace std;
+
+ProcessIntegralBatch::ProcessIntegralBatch(unsigned int numThreads)
+{
+	m_NumThreads = numThreads;
+	m_SampleStart.push_back(0);
+}
+
+ProcessIntegralBatch::~ProcessIntegralBatch()
+{
+	// the integral processings are owned by the processing array
+	for (size_t i=0; i<m_Integrals.size(); ++i)
+		m_Integrals.at(i).proc->m_Batched = false;
+	m_Integrals.clear();
+}
+
+bool ProcessIntegralBatch::AddIntegral(ProcessIntegral* proc)
+{
+	if ((proc==NULL) || (proc->GetEnable()==false) || proc->m_Batched || (proc->m_Results==NULL))
+		return false;
+	if (dynamic_cast<Engine_Interface_FDTD*>(proc->m_Eng_Interface)==NULL)
+		return false;
+	// use the threads of the engine, unless set explicitly
+	if (m_NumThreads==0)
+		m_NumThreads = max(proc->m_Eng_Interface->GetNumberOfThreads(), 1u);
+
+	size_t numSamples = m_SampleStart.size()-1;
+	size_t numEntries = m_Values.size();
+	if (proc->CompileGather(this)==false)
+	{
+		// remove everything added by this integral
+		m_SampleStart.resize(numSamples+1);
+		m_Values.resize(numEntries);
+		m_Weights.resize(numEntries);
+		return false;
+	}
+
+	Integral integral;
+	integral.proc = proc;
+	integral.firstSample = numSamples;
+	integral.numSamples = m_SampleStart.size()-1-numSamples;
+	integral.numResults = proc->GetNumberOfIntegrals();
+	integral.numFreq = proc->m_FD_Samples.size();
+	integral.fdOffset = m_FD_Real.size();
+	integral.phasorOffset = m_Phasor_Real.size();
+	integral.nextPhasorTS = 0;
+	integral.phasorCount = BATCH_PHASOR_RESYNC;
+	integral.process = false;
+	integral.dumpTD = false;
+	integral.sampleFD = false;
+	m_Integrals.push_back(integral);
+
+	m_FD_Real.resize(m_FD_Real.size() + (size_t)integral.numResults*integral.numFreq, 0);
+	m_FD_Imag.resize(m_FD_Imag.size() + (size_t)integral.numResults*integral.numFreq, 0);
+	m_Phasor_Real.resize(m_Phasor_Real.size() + integral.numFreq, 0);
+	m_Phasor_Imag.resize(m_Phasor_Imag.size() + integral.numFreq, 0);
+	m_PhasorStep_Real.resize(m_PhasorStep_Real.size() + integral.numFreq, 0);
+	m_PhasorStep_Imag.resize(m_PhasorStep_Imag.size() + integral.numFreq, 0);
+	m_Samples.resize(m_SampleStart.size()-1, 0);
+
+	proc->m_Batched = true;
+	LoadFDResults(m_Integrals.back());
+	SetupThreads();
+	return true;
+}
+
+void ProcessIntegralBatch::AddSample()
+{
+	m_SampleStart.push_back(m_Values.size());
+}
+
+void ProcessIntegralBatch::AddToSample(const vector<Engine_Interface_FDTD::FieldGather> &gather)
+{
+	for (size_t n=0; n<gather.size(); ++n)
+	{
+		m_Values.push_back(gather.at(n).value);
+		m_Weights.push_back(gather.at(n).weight);
+	}
+	m_SampleStart.back() = m_Values.size();
+}
+
+void ProcessIntegralBatch::SetupThreads()
+{
+	m_ThreadStart.clear();
+	unsigned int numThreads = min(m_NumThreads, (unsigned int)(m_Values.size()/BATCH_MIN_ENTRIES_PER_THREAD) + 1);
+	size_t entriesPerThread = m_Values.size()/numThreads + 1;
+	size_t entries = 0;
+	for (size_t i=0; i<m_Integrals.size(); ++i)
+	{
+		if ((m_ThreadStart.size()==0) || (entries>=entriesPerThread))
+		{
+			m_ThreadStart.push_back(i);
+			entries = 0;
+		}
+		const Integral &integral = m_Integrals.at(i);
+		entries += m_SampleStart.at(integral.firstSample+integral.numSamples) - m_SampleStart.at(integral.firstSample);
+	}
+}
+
+void ProcessIntegralBatch::Process()
+{
+	if (m_Integrals.size()==0)
+		return;
+
+	// check all timesteps first, this updates the processing state of the integrals
+	bool any = false;
+	for (size_t i=0; i<m_Integrals.size(); ++i)
+	{
+		Integral &integral = m_Integrals.at(i);
+		ProcessIntegral* proc = integral.proc;
+		integral.process = proc->Enabled && proc->CheckTimestep();
+		if (integral.process==false)
+			continue;
+		unsigned int numTS = proc->m_Eng_Interface->GetNumberOfTimesteps();
+		integral.dumpTD = (proc->ProcessInterval) && (numTS%proc->ProcessInterval==0);
+		integral.sampleFD = (proc->m_FD_Interval) && (numTS%proc->m_FD_Interval==0);
+		any = true;
+	}
+	if (any==false)
+		return;
+
+	// every part is run by a worker of the shared pool, avoiding new threads every sampled timestep
+	ThreadPool::RangeJobMember<ProcessIntegralBatch> job(this, &ProcessIntegralBatch::ProcessParts);
+	ThreadPool::GetShared().RunRangeJob(&job, m_ThreadStart.size(), m_ThreadStart.size());
+
+	// the file output and flushing is done in order
+	for (size_t i=0; i<m_Integrals.size(); ++i)
+	{
+		Integral &integral = m_Integrals.at(i);
+		if (integral.process==false)
+			continue;
+		ProcessIntegral* proc = integral.proc;
+		if (integral.dumpTD)
+			proc->Dump_TD_Data(proc->m_Eng_Interface->GetTime(proc->m_dualTime));
+		if (integral.sampleFD)
+		{
+			++proc->m_FD_SampleCount;
+			if (proc->m_Flush)
+			{
+				StoreFDResults(integral);
+				proc->FlushData();
+			}
+			proc->m_Flush = false;
+		}
+	}
+}
+
+void ProcessIntegralBatch::ProcessParts(unsigned int start, unsigned int stop, unsigned int)
+{
+	for (unsigned int t=start; t<=stop; ++t)
+		ProcessRange(m_ThreadStart.at(t), (t+1<m_ThreadStart.size()) ? m_ThreadStart.at(t+1) : m_Integrals.size());
+}
+
+void ProcessIntegralBatch::ProcessRange(unsigned int start, unsigned int stop)
+{
+	for (unsigned int i=start; i<stop; ++i)
+	{
+		Integral &integral = m_Integrals.at(i);
+		if (integral.process==false)
+			continue;
+		ProcessIntegral* proc = integral.proc;
+
+		// gather all samples of this integral
+		for (unsigned int s=integral.firstSample; s<integral.firstSample+integral.numSamples; ++s)
+		{
+			double sum = 0;
+			for (size_t e=m_SampleStart[s]; e<m_SampleStart[s+1]; ++e)
+				sum += m_Weights[e] * *m_Values[e];
+			m_Samples[s] = sum;
+		}
+		const double* results = proc->CalcIntegralsFromSamples(&m_Samples[integral.firstSample]);
+
+		if ((integral.sampleFD==false) || (integral.numFreq==0))
+			continue;
+		UpdatePhasors(integral);
+		const double* p_re = &m_Phasor_Real[integral.phasorOffset];
+		const double* p_im = &m_Phasor_Imag[integral.phasorOffset];
+		for (unsigned int r=0; r<integral.numResults; ++r)
+		{
+			double value = results[r] * proc->m_weight;
+			double* fd_re = &m_FD_Real[integral.fdOffset + (size_t)r*integral.numFreq];
+			double* fd_im = &m_FD_Imag[integral.fdOffset + (size_t)r*integral.numFreq];
+			for (unsigned int f=0; f<integral.numFreq; ++f)
+			{
+				fd_re[f] += value * p_re[f];
+				fd_im[f] += value * p_im[f];
+			}
+		}
+	}
+}
+
+void ProcessIntegralBatch::UpdatePhasors(Integral &integral)
+{
+	ProcessIntegral* proc = integral.proc;
+	unsigned int numTS = proc->m_Eng_Interface->GetNumberOfTimesteps();
+	double* p_re = &m_Phasor_Real[integral.phasorOffset];
+	double* p_im = &m_Phasor_Imag[integral.phasorOffset];
+	double* s_re = &m_PhasorStep_Real[integral.phasorOffset];
+	double* s_im = &m_PhasorStep_Imag[integral.phasorOffset];
+	// start the recursion on the first sample, after a skipped sample and periodically to limit the accumulated rounding errors
+	if ((numTS!=integral.nextPhasorTS) || (integral.phasorCount>=BATCH_PHASOR_RESYNC))
+	{
+		double T = proc->m_Eng_Interface->GetTime(proc->m_dualTime);
+		double dT = proc->Op->GetTimestep() * proc->m_FD_Interval;
+		for (unsigned int f=0; f<integral.numFreq; ++f)
+		{
+			// *2 for single-sided spectrum, multiply with timestep-interval
+			double_complex phasor = std::exp( -2.0 * _I * M_PI * proc->m_FD_Samples.at(f) * T ) * 2.0 * dT;
+			double_complex step = std::exp( -2.0 * _I * M_PI * proc->m_FD_Samples.at(f) * dT );
+			p_re[f] = real(phasor);
+			p_im[f] = imag(phasor);
+			s_re[f] = real(step);
+			s_im[f] = imag(step);
+		}
+		integral.phasorCount = 0;
+	}
+	else
+	{
+		for (unsigned int f=0; f<integral.numFreq; ++f)
+		{
+			double re = p_re[f]*s_re[f] - p_im[f]*s_im[f];
+			p_im[f] = p_re[f]*s_im[f] + p_im[f]*s_re[f];
+			p_re[f] = re;
+		}
+	}
+	integral.nextPhasorTS = numTS + proc->m_FD_Interval;
+	++integral.phasorCount;
+}
+
+void ProcessIntegralBatch::StoreFDResults()
+{
+	for (size_t i=0; i<m_Integrals.size(); ++i)
+		StoreFDResults(m_Integrals.at(i));
+}
+
+void ProcessIntegralBatch::StoreFDResults(const Integral &integral)
+{
+	ProcessIntegral* proc = integral.proc;
+	if (proc->m_FD_Results==NULL)
+		return;
+	for (unsigned int r=0; r<integral.numResults; ++r)
+		for (unsigned int f=0; f<integral.numFreq; ++f)
+		{
+			size_t idx = integral.fdOffset + (size_t)r*integral.numFreq + f;
+			proc->m_FD_Results[r].at(f) = double_complex(m_FD_Real[idx], m_FD_Imag[idx]);
+		}
+}
+
+void ProcessIntegralBatch::LoadFDResults()
+{
+	for (size_t i=0; i<m_Integrals.size(); ++i)
+		LoadFDResults(m_Integrals.at(i));
+}
+
+void ProcessIntegralBatch::LoadFDResults(Integral &integral)
+{
+	ProcessIntegral* proc = integral.proc;
+	// restart the phasor recursion
+	integral.phasorCount = BATCH_PHASOR_RESYNC;
+	if (proc->m_FD_Results==NULL)
+		return;
+	for (unsigned int r=0; r<integral.numResults; ++r)
+		for (unsigned int f=0; f<integral.numFreq; ++f)
+		{
+			size_t idx = integral.fdOffset + (size_t)r*integral.numFreq + f;
+			m_FD_Real[idx] = real(proc->m_FD_Results[r].at(f));
+			m_FD_Imag[idx] = imag(proc->m_FD_Results[r].at(f));
+		}
+}
@@ -0,0 +1,110 @@
+/*
+*	Copyright (C) 2026 openEMS contributors
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef PROCESSINTEGRAL_BATCH_H
+#define PROCESSINTEGRAL_BATCH_H
+
+#include "processintegral.h"
+#include "FDTD/engine_interface_fdtd.h"
+
+//! Evaluate many integral processings (voltages, currents, field probes, mode matching) in a single pass per timestep.
+/*!
+  Every integral is compiled once (ProcessIntegral::CompileGather) into linear samples, each a list of (stored engine value, weight) entries.
+  All samples of the due integrals are gathered by direct reads of the engine fields, spread over several threads,
+  and the frequency domain results of all integrals are accumulated into a single structure-of-arrays with running phasors.
+  The integral processings keep writing their own time domain files, and their frequency domain results are updated by StoreFDResults().
+  */
+class ProcessIntegralBatch
+{
+public:
+	//! Create a batch using up to \a numThreads threads, 0 uses the number of threads of the engine
+	ProcessIntegralBatch(unsigned int numThreads=0);
+	~ProcessIntegralBatch();
+
+	//! Add and compile an integral processing, returns false if it can't be batched and has to be processed by itself
+	bool AddIntegral(ProcessIntegral* proc);
+
+	//! Get the number of batched integral processings
+	size_t GetNumberOfIntegrals() const {return m_Integrals.size();}
+	//! Get the total number of gathered field values per timestep (if all integrals are due)
+	size_t GetNumberOfEntries() const {return m_Values.size();}
+
+	//! Start a new sample of the integral currently compiled, has to be called by ProcessIntegral::CompileGather
+	void AddSample();
+	//! Add the weighted field values to the current sample
+	void AddToSample(const std::vector<Engine_Interface_FDTD::FieldGather> &gather);
+
+	//! Process all due integrals of the current timestep, the integrals themselves only return their next interval afterwards.
+	void Process();
+
+	//! Copy the accumulated frequency domain results into the integral processings, e.g. before their data or state is written
+	void StoreFDResults();
+	//! Load the frequency domain results from the integral processings, e.g. after their state was restored
+	void LoadFDResults();
+
+protected:
+	unsigned int m_NumThreads;
+
+	struct Integral
+	{
+		ProcessIntegral* proc;
+		unsigned int firstSample;
+		unsigned int numSamples;
+		unsigned int numResults;
+		unsigned int numFreq;
+		//! first frequency domain accumulator, result r of frequency f is found at fdOffset+r*numFreq+f
+		size_t fdOffset;
+		//! first phasor of this integral
+		size_t phasorOffset;
+		//! timestep continuing the phasor recursion and number of recursive updates
+		unsigned int nextPhasorTS;
+		unsigned int phasorCount;
+		//! state of the current timestep
+		bool process;
+		bool dumpTD;
+		bool sampleFD;
+	};
+	std::vector<Integral> m_Integrals;
+
+	//! gather list (structure-of-arrays), the entries of sample s are [m_SampleStart[s], m_SampleStart[s+1])
+	std::vector<const FDTD_FLOAT*> m_Values;
+	std::vector<float> m_Weights;
+	std::vector<size_t> m_SampleStart;
+	std::vector<double> m_Samples;
+
+	//! frequency domain accumulators of all integrals
+	std::vector<double> m_FD_Real;
+	std::vector<double> m_FD_Imag;
+	//! running phasors (including the single-sided spectrum factor and the sample interval) and their step per sample
+	std::vector<double> m_Phasor_Real;
+	std::vector<double> m_Phasor_Imag;
+	std::vector<double> m_PhasorStep_Real;
+	std::vector<double> m_PhasorStep_Imag;
+
+	//! first integral of every thread, balanced by the number of gather entries
+	std::vector<unsigned int> m_ThreadStart;
+	void SetupThreads();
+
+	//! Process the thread parts \a start to \a stop (inclusive) of m_ThreadStart
+	void ProcessParts(unsigned int start, unsigned int stop, unsigned int threadID);
+	void ProcessRange(unsigned int start, unsigned int stop);
+	void UpdatePhasors(Integral &integral);
+	void StoreFDResults(const Integral &integral);
+	void LoadFDResults(Integral &integral);
+};
+
+#endif // PROCESSINTEGRAL_BATCH_H
@@ -19,6 +19,7 @@
 #include "CSFunctionParser.h"
 #include "Common/operator_base.h"
 #include "tools/array_ops.h"
+#include "processintegral_batch.h"
 
 using namespace std;
 
@@ -265,3 +266,68 @@ double* ProcessModeMatch::CalcMultipleIntegrals()
 	m_Results[0] = value;
 	return m_Results;
 }
+
+bool ProcessModeMatch::CompileGather(ProcessIntegralBatch* batch)
+{
+	Engine_Interface_FDTD* EI_FDTD = dynamic_cast<Engine_Interface_FDTD*>(m_Eng_Interface);
+	if ((EI_FDTD==NULL) || (m_ModeDist[0]==NULL) || (m_ModeDist[1]==NULL))
+		return false;
+	bool dualMesh = m_ModeFieldType==1;
+
+	int nP = (m_ny+1)%3;
+	int nPP = (m_ny+2)%3;
+
+	unsigned int pos[3] = {0,0,0};
+	pos[m_ny] = start[m_ny];
+
+	m_NodeArea.clear();
+	vector<Engine_Interface_FDTD::FieldGather> gather;
+	for (unsigned int posP = 0; posP<m_numLines[0]; ++posP)
+	{
+		pos[nP] = start[nP] + posP;
+		for (unsigned int posPP = 0; posPP<m_numLines[1]; ++posPP)
+		{
+			pos[nPP] = start[nPP] + posPP;
+			m_NodeArea.push_back(Op->GetNodeArea(m_ny,pos,dualMesh));
+			for (int n=0; n<2; ++n)
+			{
+				gather.clear();
+				if (EI_FDTD->GatherField(m_ModeFieldType, (m_ny+n+1)%3, pos, gather)==false)
+					return false;
+				batch->AddSample();
+				batch->AddToSample(gather);
+			}
+		}
+	}
+	return true;
+}
+
+double* ProcessModeMatch::CalcIntegralsFromSamples(const double* samples)
+{
+	double value = 0;
+	double field = 0;
+	double purity = 0;
+	double area = 0;
+	size_t node = 0;
+
+	for (unsigned int posP = 0; posP<m_numLines[0]; ++posP)
+	{
+		for (unsigned int posPP = 0; posPP<m_numLines[1]; ++posPP)
+		{
+			area = m_NodeArea[node];
+			for (int n=0; n<2; ++n)
+			{
+				field = samples[2*node+n];
+				value += field * m_ModeDist[n][posP][posPP] * area;
+				purity += field*field * area;
+			}
+			++node;
+		}
+	}
+	if (purity!=0)
+		m_Results[1] = value*value/purity;
+	else
+		m_Results[1] = 0;
+	m_Results[0] = value;
+	return m_Results;
+}
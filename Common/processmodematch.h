@@ -48,6 +48,10 @@ public:
 	virtual int GetNumberOfIntegrals() const {return 2;}
 	virtual double* CalcMultipleIntegrals();
 
+	//! Compile the two tangential field components of every node
+	virtual bool CompileGather(ProcessIntegralBatch* batch);
+	virtual double* CalcIntegralsFromSamples(const double* samples);
+
 protected:
 	//normal direction of the mode plane
 	int m_ny;
@@ -63,6 +67,9 @@ protected:
 
 	unsigned int m_numLines[2];
 	double** m_ModeDist[2];
+
+	//! node areas of the batched processing, see CompileGather()
+	std::vector<double> m_NodeArea;
 };
 
 #endif // PROCESSMODEMATCH_H
@@ -0,0 +1,269 @@
+/*
+*	Copyright (C) 2026 openEMS contributors
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include "processnf2ff.h"
+#include "processfields_fd.h"
+#include "Common/operator_base.h"
+#include "tools/array_ops.h"
+#include "nf2ff/nf2ff.h"
+#include "tinyxml.h"
+
+using namespace std;
+
+ProcessNF2FF::ProcessNF2FF(Engine_Interface_Base* eng_if) : Processing(eng_if)
+{
+	m_nf2ff = NULL;
+}
+
+ProcessNF2FF::~ProcessNF2FF()
+{
+	vector<ProcessFieldsFD*> planes = GetPlanes();
+	for (size_t n=0; n<planes.size(); ++n)
+		delete planes.at(n);
+	m_Planes.clear();
+	delete m_nf2ff;
+	m_nf2ff = NULL;
+}
+
+bool ProcessNF2FF::ReadXML(TiXmlElement* ti_nf2ff)
+{
+	delete m_nf2ff;
+	m_nf2ff = nf2ff::ParseXMLNode(ti_nf2ff, m_Outfile);
+	if (m_nf2ff==NULL)
+		return false;
+	SetName(m_Outfile);
+
+	TiXmlElement* ti_Planes = ti_nf2ff->FirstChildElement("Planes");
+	while (ti_Planes!=NULL)
+	{
+		const char* E_name = ti_Planes->Attribute("E_Field");
+		const char* H_name = ti_Planes->Attribute("H_Field");
+		if ((E_name==NULL) || (H_name==NULL))
+		{
+			cerr << "ProcessNF2FF::ReadXML: Error, invalid plane entry ... " << endl;
+			return false;
+		}
+		m_E_Names.push_back(E_name);
+		m_H_Names.push_back(H_name);
+		ti_Planes = ti_Planes->NextSiblingElement("Planes");
+	}
+	m_Planes.resize(m_E_Names.size());
+
+	vector<double> freq = GetFrequencies();
+	AddFrequency(&freq);
+	return true;
+}
+
+bool ProcessNF2FF::UsesDumpBox(string name) const
+{
+	for (size_t n=0; n<m_E_Names.size(); ++n)
+		if ((m_E_Names.at(n)==name) || (m_H_Names.at(n)==name))
+			return true;
+	return false;
+}
+
+bool ProcessNF2FF::AddPlane(string name, unsigned int index, ProcessFieldsFD* plane)
+{
+	for (size_t n=0; n<m_E_Names.size(); ++n)
+	{
+		if ((m_E_Names.at(n)!=name) && (m_H_Names.at(n)!=name))
+			continue;
+		if (m_Planes.at(n).size()<=index)
+		{
+			Plane empty = {NULL, NULL};
+			m_Planes.at(n).resize(index+1, empty);
+		}
+		ProcessFieldsFD** field = (m_E_Names.at(n)==name) ? &m_Planes.at(n).at(index).E_Field : &m_Planes.at(n).at(index).H_Field;
+		if (*field!=NULL)
+		{
+			cerr << "ProcessNF2FF::AddPlane: Error, plane " << index << " of dump box \"" << name << "\" was already added... skipping" << endl;
+			return false;
+		}
+		*field = plane;
+		return true;
+	}
+	return false;
+}
+
+vector<double> ProcessNF2FF::GetFrequencies() const
+{
+	vector<double> freq;
+	if (m_nf2ff==NULL)
+		return freq;
+	vector<float> nf2ff_freq = m_nf2ff->GetFrequencies();
+	for (size_t n=0; n<nf2ff_freq.size(); ++n)
+		freq.push_back(nf2ff_freq.at(n));
+	return freq;
+}
+
+vector<ProcessFieldsFD*> ProcessNF2FF::GetPlanes() const
+{
+	vector<ProcessFieldsFD*> planes;
+	for (size_t n=0; n<m_Planes.size(); ++n)
+		for (size_t i=0; i<m_Planes.at(n).size(); ++i)
+		{
+			if (m_Planes.at(n).at(i).E_Field)
+				planes.push_back(m_Planes.at(n).at(i).E_Field);
+			if (m_Planes.at(n).at(i).H_Field)
+				planes.push_back(m_Planes.at(n).at(i).H_Field);
+		}
+	return planes;
+}
+
+void ProcessNF2FF::SetEnable(bool val)
+{
+	Processing::SetEnable(val);
+	vector<ProcessFieldsFD*> planes = GetPlanes();
+	for (size_t n=0; n<planes.size(); ++n)
+		planes.at(n)->SetEnable(val);
+}
+
+void ProcessNF2FF::InitProcess()
+{
+	if (Enabled==false) return;
+
+	if (m_nf2ff==NULL)
+	{
+		cerr << "ProcessNF2FF::InitProcess: Error, no nf2ff settings found... disabling" << endl;
+		SetEnable(false);
+		return;
+	}
+
+	for (size_t n=0; n<m_Planes.size(); ++n)
+	{
+		if (m_Planes.at(n).size()==0)
+			cerr << "ProcessNF2FF::InitProcess: Warning, no planes found for the dump boxes \"" << m_E_Names.at(n) << "\" and \"" << m_H_Names.at(n) << "\"" << endl;
+		for (size_t i=0; i<m_Planes.at(n).size(); ++i)
+		{
+			if ((m_Planes.at(n).at(i).E_Field==NULL) || (m_Planes.at(n).at(i).H_Field==NULL))
+			{
+				cerr << "ProcessNF2FF::InitProcess: Error, E- and H-field plane " << i << " of \"" << m_E_Names.at(n) << "\" and \"" << m_H_Names.at(n) << "\" do not match... disabling" << endl;
+				SetEnable(false);
+				return;
+			}
+		}
+	}
+
+	vector<ProcessFieldsFD*> planes = GetPlanes();
+	for (size_t n=0; n<planes.size(); ++n)
+		planes.at(n)->InitProcess();
+}
+
+int ProcessNF2FF::Process()
+{
+	if (Enabled==false) return -1;
+
+	vector<ProcessFieldsFD*> planes = GetPlanes();
+	for (size_t n=0; n<planes.size(); ++n)
+		planes.at(n)->Process();
+	return GetNextInterval();
+}
+
+void ProcessNF2FF::PostProcess()
+{
+	if (Enabled==false) return;
+
+	if (CalcFarField()==false)
+		cerr << "ProcessNF2FF::PostProcess: Error, the far-field transformation \"" << m_Outfile << "\" failed" << endl;
+}
+
+bool ProcessNF2FF::CalcFarField()
+{
+	size_t numFreq = m_nf2ff->GetFrequencies().size();
+	#ifdef OUTPUT_IN_DRAWINGUNITS
+	double discScaling = 1;
+	#else
+	double discScaling = Op->GetGridDelta();
+	#endif
+
+	for (size_t n=0; n<m_Planes.size(); ++n)
+	{
+		for (size_t i=0; i<m_Planes.at(n).size(); ++i)
+		{
+			ProcessFieldsFD* E_plane = m_Planes.at(n).at(i).E_Field;
+			ProcessFieldsFD* H_plane = m_Planes.at(n).at(i).H_Field;
+			if ((E_plane->GetEnable()==false) || (H_plane->GetEnable()==false))
+				continue;
+			if ((E_plane->GetNumberOfFrequencies()!=numFreq) || (H_plane->GetNumberOfFrequencies()!=numFreq))
+			{
+				cerr << "ProcessNF2FF::CalcFarField: Error, not all frequencies could be recorded" << endl;
+				return false;
+			}
+
+			unsigned int numLines[3];
+			float* lines[3];
+			for (int ny=0; ny<3; ++ny)
+			{
+				numLines[ny] = E_plane->GetNumberOfLines(ny);
+				if (numLines[ny]!=H_plane->GetNumberOfLines(ny))
+				{
+					cerr << "ProcessNF2FF::CalcFarField: Error, mesh dimensions of the E- and H-field plane don't agree" << endl;
+					for (int m=0; m<ny; ++m)
+						delete[] lines[m];
+					return false;
+				}
+				lines[ny] = new float[numLines[ny]];
+				for (unsigned int l=0; l<numLines[ny]; ++l)
+				{
+					// the angle of a cylindrical mesh is not scaled
+					if ((m_Mesh_Type==CYLINDRICAL_MESH) && (ny==1))
+						lines[ny][l] = E_plane->GetDiscLines(ny)[l];
+					else
+						lines[ny][l] = E_plane->GetDiscLines(ny)[l]*discScaling;
+				}
+			}
+
+			// all frequencies are transformed in a single pass, the nf2ff takes ownership of the fields
+			vector<complex<float>****> E_fields(numFreq);
+			vector<complex<float>****> H_fields(numFreq);
+			for (size_t fn=0; fn<numFreq; ++fn)
+			{
+				E_fields.at(fn) = Create_N_3DArray<complex<float> >(numLines);
+				H_fields.at(fn) = Create_N_3DArray<complex<float> >(numLines);
+				E_plane->GetFDField(fn, E_fields.at(fn));
+				H_plane->GetFDField(fn, H_fields.at(fn));
+			}
+			m_nf2ff->AddPlane(lines, numLines, E_fields, H_fields, (int)m_Mesh_Type);
+			for (int ny=0; ny<3; ++ny)
+				delete[] lines[ny];
+		}
+	}
+	return m_nf2ff->Write2HDF5(m_Outfile);
+}
+
+bool ProcessNF2FF::WriteState(ostream &state)
+{
+	if (Processing::WriteState(state)==false)
+		return false;
+	vector<ProcessFieldsFD*> planes = GetPlanes();
+	for (size_t n=0; n<planes.size(); ++n)
+		if (planes.at(n)->WriteState(state)==false)
+			return false;
+	return state.good();
+}
+
+bool ProcessNF2FF::ReadState(istream &state)
+{
+	if (Processing::ReadState(state)==false)
+		return false;
+	vector<ProcessFieldsFD*> planes = GetPlanes();
+	for (size_t n=0; n<planes.size(); ++n)
+		if (planes.at(n)->ReadState(state)==false)
+			return false;
+	return state.good();
+}
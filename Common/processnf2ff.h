@@ -0,0 +1,82 @@
+/*
+*	Copyright (C) 2026 openEMS contributors
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef PROCESSNF2FF_H
+#define PROCESSNF2FF_H
+
+#include "processing.h"
+
+class TiXmlElement;
+class ProcessFieldsFD;
+class nf2ff;
+
+/*!
+  In-solver near-field to far-field transformation.
+  The E- and H-fields of the nf2ff planes are accumulated in memory (see ProcessFieldsFD), only the far-field result is written.
+  The settings are read from a nf2ff xml node (see nf2ff::AnalyseXMLNode), the "E_Field" and "H_Field" of the "Planes" are the names of the E- and H-field dump boxes.
+  */
+class ProcessNF2FF : public Processing
+{
+public:
+	ProcessNF2FF(Engine_Interface_Base* eng_if);
+	virtual ~ProcessNF2FF();
+
+	virtual std::string GetProcessingName() const {return "nf2ff far-field transformation";}
+
+	//! Read the nf2ff settings from the xml node
+	bool ReadXML(TiXmlElement* ti_nf2ff);
+
+	//! Check if the dump box \a name is used by this transformation
+	bool UsesDumpBox(std::string name) const;
+	//! Add the plane \a index of the dump box \a name, this class takes ownership of the plane processing
+	bool AddPlane(std::string name, unsigned int index, ProcessFieldsFD* plane);
+
+	//! Get the frequencies of the far-field transformation
+	std::vector<double> GetFrequencies() const;
+
+	virtual void InitProcess();
+	virtual int Process();
+	virtual void PostProcess();
+
+	virtual void SetEnable(bool val);
+
+	virtual bool WriteState(std::ostream &state);
+	virtual bool ReadState(std::istream &state);
+
+protected:
+	nf2ff* m_nf2ff;
+	std::string m_Outfile;
+
+	//! names of the E- and H-field dump boxes
+	std::vector<std::string> m_E_Names;
+	std::vector<std::string> m_H_Names;
+
+	struct Plane
+	{
+		ProcessFieldsFD* E_Field;
+		ProcessFieldsFD* H_Field;
+	};
+	//! all planes by dump box pair and primitive index
+	std::vector<std::vector<Plane> > m_Planes;
+	//! Get all existing plane processings
+	std::vector<ProcessFieldsFD*> GetPlanes() const;
+
+	bool CalcFarField();
+};
+
+#endif // PROCESSNF2FF_H
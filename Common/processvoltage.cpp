@@ -16,6 +16,7 @@
 */
 
 #include "processvoltage.h"
+#include "processintegral_batch.h"
 #include <iomanip>
 
 ProcessVoltage::ProcessVoltage(Engine_Interface_Base* eng_if) : ProcessIntegral(eng_if)
@@ -38,3 +39,16 @@ double ProcessVoltage::CalcIntegral()
 	//integrate voltages from start to stop on a line
 	return m_Eng_Interface->CalcVoltageIntegral(start,stop);
 }
+
+bool ProcessVoltage::CompileGather(ProcessIntegralBatch* batch)
+{
+	Engine_Interface_FDTD* EI_FDTD = dynamic_cast<Engine_Interface_FDTD*>(m_Eng_Interface);
+	if (EI_FDTD==NULL)
+		return false;
+	std::vector<Engine_Interface_FDTD::FieldGather> gather;
+	if (EI_FDTD->GatherVoltageIntegral(start,stop,gather)==false)
+		return false;
+	batch->AddSample();
+	batch->AddToSample(gather);
+	return true;
+}
@@ -33,6 +33,8 @@ public:
 
 	virtual double CalcIntegral();
 
+	virtual bool CompileGather(ProcessIntegralBatch* batch);
+
 protected:
 };
 
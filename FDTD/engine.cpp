@@ -49,13 +49,18 @@ Engine::~Engine()
 void Engine::Init()
 {
 	numTS = 0;
-	volt = Create_N_3DArray<FDTD_FLOAT>(numLines);
-	curr = Create_N_3DArray<FDTD_FLOAT>(numLines);
+	InitFields();
 
 	InitExtensions();
 	SortExtensionByPriority();
 }
 
+void Engine::InitFields()
+{
+	volt = Create_N_3DArray<FDTD_FLOAT>(numLines);
+	curr = Create_N_3DArray<FDTD_FLOAT>(numLines);
+}
+
 void Engine::InitExtensions()
 {
 	for (size_t n=0; n<Op->GetNumberOfExtentions(); ++n)
@@ -105,6 +110,59 @@ void Engine::Reset()
 	ClearExtensions();
 }
 
+bool Engine::WriteState(ostream &file)
+{
+	file.write((const char*)&numTS, sizeof(numTS));
+	WriteFields(file);
+
+	unsigned int numExt = m_Eng_exts.size();
+	file.write((const char*)&numExt, sizeof(numExt));
+	for (size_t n=0; n<m_Eng_exts.size(); ++n)
+	{
+		if (m_Eng_exts.at(n)->WriteState(file)==false)
+		{
+			cerr << "Engine::WriteState: Error, writing the state of the extension \"" << m_Eng_exts.at(n)->GetExtensionName() << "\" failed" << endl;
+			return false;
+		}
+	}
+	return file.good();
+}
+
+bool Engine::ReadState(istream &file)
+{
+	file.read((char*)&numTS, sizeof(numTS));
+	ReadFields(file);
+
+	unsigned int numExt = 0;
+	file.read((char*)&numExt, sizeof(numExt));
+	if (!file.good() || (numExt!=m_Eng_exts.size()))
+	{
+		cerr << "Engine::ReadState: Error, the number of engine extensions does not match" << endl;
+		return false;
+	}
+	for (size_t n=0; n<m_Eng_exts.size(); ++n)
+	{
+		if (m_Eng_exts.at(n)->ReadState(file)==false)
+		{
+			cerr << "Engine::ReadState: Error, reading the state of the extension \"" << m_Eng_exts.at(n)->GetExtensionName() << "\" failed" << endl;
+			return false;
+		}
+	}
+	return file.good();
+}
+
+void Engine::WriteFields(ostream &file) const
+{
+	Write_N_3DArray(file, volt, numLines);
+	Write_N_3DArray(file, curr, numLines);
+}
+
+void Engine::ReadFields(istream &file)
+{
+	Read_N_3DArray(file, volt, numLines);
+	Read_N_3DArray(file, curr, numLines);
+}
+
 void Engine::UpdateVoltages(unsigned int startX, unsigned int numX)
 {
 	unsigned int pos[3];
@@ -47,6 +47,9 @@ public:
 
 	virtual unsigned int GetNumberOfTimesteps() {return numTS;}
 
+	//! Get the number of threads updating the fields
+	virtual unsigned int GetNumberOfThreads() const {return 1;}
+
 	//this access functions muss be overloaded by any new engine using a different storage model
 	inline virtual FDTD_FLOAT GetVolt( unsigned int n, unsigned int x, unsigned int y, unsigned int z )		const { return volt[n][x][y][z]; }
 	inline virtual FDTD_FLOAT GetVolt( unsigned int n, const unsigned int pos[3] )							const { return volt[n][pos[0]][pos[1]][pos[2]]; }
@@ -58,6 +61,11 @@ public:
 	inline virtual void SetCurr( unsigned int n, unsigned int x, unsigned int y, unsigned int z, FDTD_FLOAT value)	{ curr[n][x][y][z]=value; }
 	inline virtual void SetCurr( unsigned int n, const unsigned int pos[3], FDTD_FLOAT value )						{ curr[n][pos[0]][pos[1]][pos[2]]=value; }
 
+	//! Get a pointer to the stored voltage for a direct read access (e.g. batched probes), NULL if the engine does not store the fields as FDTD_FLOAT
+	inline virtual const FDTD_FLOAT* GetVoltPtr( unsigned int n, const unsigned int pos[3] )	const { return &volt[n][pos[0]][pos[1]][pos[2]]; }
+	//! Get a pointer to the stored current for a direct read access, NULL if the engine does not store the fields as FDTD_FLOAT
+	inline virtual const FDTD_FLOAT* GetCurrPtr( unsigned int n, const unsigned int pos[3] )	const { return &curr[n][pos[0]][pos[1]][pos[2]]; }
+
 	//! Execute Pre-Voltage extension updates
 	virtual void DoPreVoltageUpdates();
 	//! Main FDTD engine voltage updates
@@ -82,6 +90,11 @@ public:
 
 	EngineType GetType() const {return m_type;}
 
+	//! Write the complete engine state (timestep, fields and the state of all extensions) to a binary stream, needed for a checkpoint of the simulation. \sa ReadState
+	virtual bool WriteState(std::ostream &file);
+	//! Restore the engine state written by WriteState, the operator and engine have to be setup identically.
+	virtual bool ReadState(std::istream &file);
+
 protected:
 	EngineType m_type;
 
@@ -94,6 +107,13 @@ protected:
 	FDTD_FLOAT**** curr;
 	unsigned int numTS;
 
+	//! Write the raw field arrays, must be overloaded by any engine using a different storage model
+	virtual void WriteFields(std::ostream &file) const;
+	//! Read the raw field arrays written by WriteFields
+	virtual void ReadFields(std::istream &file);
+
+	//! Allocate the field storage, must be overloaded by any engine using a different storage model
+	virtual void InitFields();
 	virtual void InitExtensions();
 	virtual void ClearExtensions();
 	vector<Engine_Extension*> m_Eng_exts;
@@ -131,6 +131,20 @@ bool Engine_CylinderMultiGrid::IterateTS(unsigned int iterTS)
 	return true;
 }
 
+bool Engine_CylinderMultiGrid::WriteState(ostream &file)
+{
+	if (Engine_Cylinder::WriteState(file)==false)
+		return false;
+	return m_InnerEngine->WriteState(file);
+}
+
+bool Engine_CylinderMultiGrid::ReadState(istream &file)
+{
+	if (Engine_Cylinder::ReadState(file)==false)
+		return false;
+	return m_InnerEngine->ReadState(file);
+}
+
 void Engine_CylinderMultiGrid::InterpolVoltChild2Base(unsigned int rPos)
 {
 	//interpolate voltages from child engine to the base engine...
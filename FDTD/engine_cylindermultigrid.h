@@ -41,6 +41,10 @@ public:
 	//! Iterate \a iterTS number of timesteps
 	virtual bool IterateTS(unsigned int iterTS);
 
+	//! Write the state of this engine followed by the state of the inner engine
+	virtual bool WriteState(std::ostream &file);
+	virtual bool ReadState(std::istream &file);
+
 protected:
 	Engine_CylinderMultiGrid(const Operator_CylinderMultiGrid* op);
 	const Operator_CylinderMultiGrid* Op_CMG;
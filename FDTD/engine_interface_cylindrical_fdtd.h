@@ -29,6 +29,9 @@ public:
 
 	virtual double* GetHField(const unsigned int* pos, double* out) const;
 
+	//! The cylindrical field interpolation is not supported by a gather list
+	virtual bool GatherField(int, int, const unsigned int*, std::vector<FieldGather>&) const {return false;}
+
 protected:
 	Operator_Cylinder* m_Op_Cyl;
 
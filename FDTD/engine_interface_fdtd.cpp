@@ -303,3 +303,125 @@ double Engine_Interface_FDTD::CalcFastEnergy() const
 	}
 	return __EPS0__*E_energy + __MUE0__*H_energy;
 }
+
+bool Engine_Interface_FDTD::GatherRawField(int type, unsigned int n, const unsigned int* pos, double weight, vector<FieldGather> &gather) const
+{
+	FieldGather entry;
+	double delta = m_Op->GetEdgeLength(n,pos,type==1);
+	if (type==0)
+		entry.value = m_Eng->GetVoltPtr(n,pos);
+	else
+		entry.value = m_Eng->GetCurrPtr(n,pos);
+	if (entry.value==NULL)
+		return false;
+	if (delta==0) // the raw field is always zero
+		return true;
+	entry.weight = weight/delta;
+	gather.push_back(entry);
+	return true;
+}
+
+bool Engine_Interface_FDTD::GatherField(int type, int n, const unsigned int* pos, vector<FieldGather> &gather) const
+{
+	unsigned int iPos[] = {pos[0],pos[1],pos[2]};
+	int nP = (n+1)%3;
+	int nPP = (n+2)%3;
+	bool ok = true;
+	double delta;
+	double deltaRel;
+	if ((type<0) || (type>1))
+		return false;
+
+	switch (m_InterpolType)
+	{
+	default:
+	case NO_INTERPOLATION:
+		return GatherRawField(type, n, pos, 1.0, gather);
+	case NODE_INTERPOLATE:
+		if (type==0)
+		{
+			if (pos[n]==m_Op->GetNumberOfLines(n, true)-1)  // use only the "lower value" at the upper bound
+			{
+				--iPos[n];
+				return GatherRawField(type, n, iPos, 1.0, gather);
+			}
+			delta = m_Op->GetEdgeLength(n,iPos);
+			if (delta==0)
+				return true;
+			if (pos[n]==0) // use only the "upper value" at the lower bound
+				return GatherRawField(type, n, iPos, 1.0, gather);
+			--iPos[n];
+			deltaRel = delta / (delta+m_Op->GetEdgeLength(n,iPos));
+			ok &= GatherRawField(type, n, pos, 1.0-deltaRel, gather);
+			ok &= GatherRawField(type, n, iPos, deltaRel, gather);
+			return ok;
+		}
+		if ((pos[0]==m_Op->GetNumberOfLines(0,true)-1) || (pos[1]==m_Op->GetNumberOfLines(1,true)-1) || (pos[2]==m_Op->GetNumberOfLines(2,true)-1) || (pos[nP]==0) || (pos[nPP]==0))
+			return true;
+		ok &= GatherRawField(type, n, iPos, 0.25, gather);
+		--iPos[nP];
+		ok &= GatherRawField(type, n, iPos, 0.25, gather);
+		--iPos[nPP];
+		ok &= GatherRawField(type, n, iPos, 0.25, gather);
+		++iPos[nP];
+		ok &= GatherRawField(type, n, iPos, 0.25, gather);
+		return ok;
+	case CELL_INTERPOLATE:
+		if (type==0)
+		{
+			if ((pos[0]==m_Op->GetNumberOfLines(0,true)-1) || (pos[1]==m_Op->GetNumberOfLines(1,true)-1) || (pos[2]==m_Op->GetNumberOfLines(2,true)-1))
+				return true; //electric field outside the field domain is always zero
+			ok &= GatherRawField(type, n, iPos, 0.25, gather);
+			++iPos[nP];
+			ok &= GatherRawField(type, n, iPos, 0.25, gather);
+			++iPos[nPP];
+			ok &= GatherRawField(type, n, iPos, 0.25, gather);
+			--iPos[nP];
+			ok &= GatherRawField(type, n, iPos, 0.25, gather);
+			return ok;
+		}
+		if (pos[n]>=m_Op->GetNumberOfLines(n,true)-1)
+			return true; //magnetic field on the outer boundaries is always zero
+		delta = m_Op->GetEdgeLength(n,iPos,true);
+		++iPos[n];
+		deltaRel = delta / (delta+m_Op->GetEdgeLength(n,iPos,true));
+		ok &= GatherRawField(type, n, pos, 1.0-deltaRel, gather);
+		ok &= GatherRawField(type, n, iPos, deltaRel, gather);
+		return ok;
+	}
+	return false;
+}
+
+bool Engine_Interface_FDTD::GatherVoltageIntegral(const unsigned int* start, const unsigned int* stop, vector<FieldGather> &gather) const
+{
+	FieldGather entry;
+	unsigned int mutablestart[3] = {start[0],start[1],start[2]};
+	for (int n=0; n<3; ++n)
+	{
+		unsigned int pos[3]={mutablestart[0],mutablestart[1],mutablestart[2]};
+		if (start[n]<stop[n])
+		{
+			entry.weight = 1;
+			for (; pos[n]<stop[n]; ++pos[n])
+			{
+				entry.value = m_Eng->GetVoltPtr(n,pos);
+				if (entry.value==NULL)
+					return false;
+				gather.push_back(entry);
+			}
+		}
+		else
+		{
+			entry.weight = -1;
+			for (; pos[n]>stop[n]; --pos[n])
+			{
+				entry.value = m_Eng->GetVoltPtr(n,pos);
+				if (entry.value==NULL)
+					return false;
+				gather.push_back(entry);
+			}
+		}
+		mutablestart[n] = stop[n];
+	}
+	return true;
+}
@@ -19,6 +19,7 @@
 #define ENGINE_INTERFACE_FDTD_H
 
 #include <cmath>
+#include <vector>
 
 #include "Common/engine_interface_base.h"
 #include "operator.h"
@@ -51,9 +52,25 @@ public:
 
 	virtual double GetTime(bool dualTime=false) const {return ((double)m_Eng->GetNumberOfTimesteps() + (double)dualTime*0.5)*m_Op->GetTimestep();};
 	virtual unsigned int GetNumberOfTimesteps() const {return m_Eng->GetNumberOfTimesteps();}
+	virtual unsigned int GetNumberOfThreads() const {return m_Eng->GetNumberOfThreads();}
 
 	virtual double CalcFastEnergy() const;
 
+	//! A stored engine field value and its weight, see GatherField()
+	struct FieldGather
+	{
+		const FDTD_FLOAT* value;
+		float weight;
+	};
+	//! Append the stored engine values of component \a n of the (interpolated) electric (type 0) or magnetic (type 1) field at \p pos to \a gather.
+	/*!
+	  The weighted sum of all appended values equals the result of GetEField() or GetHField() for the current interpolation type.
+	  Returns false if the field can't be gathered, e.g. if the engine does not allow a direct access to its fields.
+	  */
+	virtual bool GatherField(int type, int n, const unsigned int* pos, std::vector<FieldGather> &gather) const;
+	//! Append the stored engine values of CalcVoltageIntegral() to \a gather, returns false if not possible \sa GatherField
+	virtual bool GatherVoltageIntegral(const unsigned int* start, const unsigned int* stop, std::vector<FieldGather> &gather) const;
+
 protected:
 	Operator* m_Op;
 	Engine* m_Eng;
@@ -67,6 +84,9 @@ protected:
 	virtual double* GetRawInterpolatedDualField(const unsigned int* pos, double* out, int type) const;
 	//! Internal method to get a raw dual field of a given type. (0: H, 1: B)
 	virtual double GetRawDualField(unsigned int n, const unsigned int* pos, int type) const;
+
+	//! Internal method to append a raw field of a given type (0: E, 1: H) with the given \a weight to a gather list. \sa GatherField
+	bool GatherRawField(int type, unsigned int n, const unsigned int* pos, double weight, std::vector<FieldGather> &gather) const;
 };
 
 #endif // ENGINE_INTERFACE_FDTD_H
@@ -16,6 +16,9 @@
 */
 
 #include "engine_mpi.h"
+#include "tools/array_ops.h"
+#include <algorithm>
+#include <vector>
 
 Engine_MPI* Engine_MPI::New(const Operator_MPI* op)
 {
@@ -28,6 +31,15 @@ Engine_MPI* Engine_MPI::New(const Operator_MPI* op)
 Engine_MPI::Engine_MPI(const Operator_MPI* op) : Engine_SSE_Compressed(op)
 {
 	m_Op_MPI = op;
+	for (int i=0;i<3;++i)
+	{
+		m_SendBuffer[i]=NULL;
+		m_RecvBuffer[i]=NULL;
+		m_BufferSize[i]=0;
+		m_RecvPending[i]=false;
+		m_SendPending[i]=false;
+		m_Sent[i]=true;
+	}
 }
 
 Engine_MPI::~Engine_MPI()
@@ -41,27 +53,29 @@ void Engine_MPI::Init()
 
 	for (int i=0;i<3;++i)
 	{
-		m_BufferUp[i]=NULL;
-		m_BufferDown[i]=NULL;
+		m_SendBuffer[i]=NULL;
+		m_RecvBuffer[i]=NULL;
 		m_BufferSize[i]=0;
+		m_RecvPending[i]=false;
+		m_SendPending[i]=false;
+		m_Sent[i]=true; // nothing to send
 	}
 
 	if (m_Op_MPI->GetMPIEnabled())
 	{
-		// init buffers, nx*ny*2 for the tangential electric or magnetic fields at the interface
+		// init buffers, two tangential electric or magnetic field components at the interface
 		for (int n=0;n<3;++n)
 		{
-			int nP  = (n+1)%3;
-			int nPP = (n+2)%3;
-			m_BufferSize[n] = m_Op_MPI->numLines[nP]*m_Op_MPI->numLines[nPP];
+			// whole z-lines for an x- or y-plane, single values for a z-plane
+			if (n<2)
+				m_BufferSize[n] = numLines[1-n]*numVectors*4;
+			else
+				m_BufferSize[n] = ((numLines[0]*numLines[1]+3)/4)*4;
 
-			if (m_Op_MPI->m_NeighborDown[n]>=0)
-			{
-				m_BufferDown[n] = new float[m_BufferSize[n]*2];
-			}
-			if (m_Op_MPI->m_NeighborUp[n]>=0)
+			if ((m_Op_MPI->m_NeighborDown[n]>=0) || (m_Op_MPI->m_NeighborUp[n]>=0))
 			{
-				m_BufferUp[n] = new float[m_BufferSize[n]*2];
+				m_SendBuffer[n] = Create1DArray_v4sf(m_BufferSize[n]/2);
+				m_RecvBuffer[n] = Create1DArray_v4sf(m_BufferSize[n]/2);
 			}
 		}
 	}
@@ -69,115 +83,239 @@ void Engine_MPI::Init()
 
 void Engine_MPI::Reset()
 {
+	WaitForSend();
 	for (int i=0;i<3;++i)
 	{
-		delete[] m_BufferUp[i];
-		delete[] m_BufferDown[i];
-		m_BufferUp[i]=NULL;
-		m_BufferDown[i]=NULL;
+		if (m_RecvPending[i])
+			MPI_Wait(&Recv_Request[i],&stat);
+		m_RecvPending[i]=false;
+		m_Sent[i]=true;
+		Delete1DArray_v4sf(m_SendBuffer[i]);
+		Delete1DArray_v4sf(m_RecvBuffer[i]);
+		m_SendBuffer[i]=NULL;
+		m_RecvBuffer[i]=NULL;
 		m_BufferSize[i]=0;
 	}
 
 	Engine_SSE_Compressed::Reset();
 }
 
-void Engine_MPI::SendReceiveVoltages()
+void Engine_MPI::PackPlane(f4vector**** field, int n, unsigned int pos, f4vector* buffer)
 {
-	unsigned int pos[3];
+	unsigned int numComp = m_BufferSize[n]/4; // f4vectors per field component
+	for (int c=1;c<3;++c)
+	{
+		f4vector*** comp = field[(n+c)%3];
+		f4vector* out = &buffer[(c-1)*numComp];
+		if (n==0)
+		{
+			for (unsigned int y=0; y<numLines[1]; ++y, out+=numVectors)
+				std::copy(comp[pos][y], comp[pos][y]+numVectors, out);
+		}
+		else if (n==1)
+		{
+			for (unsigned int x=0; x<numLines[0]; ++x, out+=numVectors)
+				std::copy(comp[x][pos], comp[x][pos]+numVectors, out);
+		}
+		else
+		{
+			// a z-plane is a single float of every z-line
+			unsigned int zVec = pos%numVectors;
+			unsigned int zOff = pos/numVectors;
+			unsigned int iPos=0;
+			for (unsigned int x=0; x<numLines[0]; ++x)
+				for (unsigned int y=0; y<numLines[1]; ++y, ++iPos)
+					out[iPos/4].f[iPos%4] = comp[x][y][zVec].f[zOff];
+		}
+	}
+}
 
-	//non-blocking prepare for receive...
+void Engine_MPI::UnpackPlane(f4vector**** field, int n, unsigned int pos, const f4vector* buffer)
+{
+	unsigned int numComp = m_BufferSize[n]/4; // f4vectors per field component
+	for (int c=1;c<3;++c)
+	{
+		f4vector*** comp = field[(n+c)%3];
+		const f4vector* in = &buffer[(c-1)*numComp];
+		if (n==0)
+		{
+			for (unsigned int y=0; y<numLines[1]; ++y, in+=numVectors)
+				std::copy(in, in+numVectors, comp[pos][y]);
+		}
+		else if (n==1)
+		{
+			for (unsigned int x=0; x<numLines[0]; ++x, in+=numVectors)
+				std::copy(in, in+numVectors, comp[x][pos]);
+		}
+		else
+		{
+			unsigned int zVec = pos%numVectors;
+			unsigned int zOff = pos/numVectors;
+			unsigned int iPos=0;
+			for (unsigned int x=0; x<numLines[0]; ++x)
+				for (unsigned int y=0; y<numLines[1]; ++y, ++iPos)
+					comp[x][y][zVec].f[zOff] = in[iPos/4].f[iPos%4];
+		}
+	}
+}
+
+void Engine_MPI::WaitForSend()
+{
 	for (int n=0;n<3;++n)
-		if (m_Op_MPI->m_NeighborDown[n]>=0)
-			MPI_Irecv( m_BufferDown[n] , m_BufferSize[n]*2, MPI_FLOAT, m_Op_MPI->m_NeighborDown[n], m_Op_MPI->m_MyTag, MPI_COMM_WORLD, &Recv_Request[n]);
+	{
+		if (m_SendPending[n])
+			MPI_Wait(&Send_Request[n],&stat);
+		m_SendPending[n]=false;
+	}
+}
 
+void Engine_MPI::StartSendReceive(f4vector**** field, bool sendUp)
+{
+	// the send buffers may still be in use by the last transfer
+	WaitForSend();
+
+	//non-blocking prepare for receive...
 	for (int n=0;n<3;++n)
 	{
-		int nP  = (n+1)%3;
-		int nPP = (n+2)%3;
+		m_Sent[n] = false;
+		int src = sendUp ? m_Op_MPI->m_NeighborDown[n] : m_Op_MPI->m_NeighborUp[n];
+		if (src>=0)
+		{
+			MPI_Irecv( m_RecvBuffer[n] , m_BufferSize[n]*2, MPI_FLOAT, src, m_Op_MPI->m_MyTag, MPI_COMM_WORLD, &Recv_Request[n]);
+			m_RecvPending[n] = true;
+		}
+	}
+
+	SendPlanes(field, sendUp);
+}
 
-		//send voltages
-		unsigned int iPos=0;
-		pos[n]=numLines[n]-2;
-		if (m_Op_MPI->m_NeighborUp[n]>=0)
+void Engine_MPI::SendPlanes(f4vector**** field, bool sendUp)
+{
+	for (int n=0;n<3;++n)
+	{
+		if ((n>0) && m_RecvPending[n-1])
+			return; // the edges of this and all following planes are received from a lower direction
+		if (m_Sent[n])
+			continue;
+		int dest = sendUp ? m_Op_MPI->m_NeighborUp[n] : m_Op_MPI->m_NeighborDown[n];
+		if (dest>=0)
 		{
-			for (pos[nP]=0; pos[nP]<numLines[nP]; ++pos[nP])
-			{
-				for (pos[nPP]=0; pos[nPP]<numLines[nPP]; ++pos[nPP])
-				{
-					m_BufferUp[n][iPos++] = Engine_SSE_Compressed::GetVolt(nP ,pos);
-					m_BufferUp[n][iPos++] = Engine_SSE_Compressed::GetVolt(nPP,pos);
-				}
-			}
-			MPI_Isend( m_BufferUp[n] , m_BufferSize[n]*2, MPI_FLOAT, m_Op_MPI->m_NeighborUp[n], m_Op_MPI->m_MyTag, MPI_COMM_WORLD, &Send_Request[n]);
+			PackPlane(field, n, sendUp ? numLines[n]-2 : 0, m_SendBuffer[n]);
+			MPI_Isend( m_SendBuffer[n] , m_BufferSize[n]*2, MPI_FLOAT, dest, m_Op_MPI->m_MyTag, MPI_COMM_WORLD, &Send_Request[n]);
+			m_SendPending[n] = true;
 		}
+		m_Sent[n] = true;
+	}
+}
 
-		//receive voltages
-		pos[n]=0;
-		iPos=0;
-		if (m_Op_MPI->m_NeighborDown[n]>=0)
+void Engine_MPI::FinishSendReceive(f4vector**** field, bool sendUp)
+{
+	for (int n=0;n<3;++n)
+	{
+		if (m_RecvPending[n])
 		{
 			//wait for receive to finish...
 			MPI_Wait(&Recv_Request[n],&stat);
-			for (pos[nP]=0; pos[nP]<numLines[nP]; ++pos[nP])
-			{
-				for (pos[nPP]=0; pos[nPP]<numLines[nPP]; ++pos[nPP])
-				{
-					Engine_SSE_Compressed::SetVolt(nP ,pos,m_BufferDown[n][iPos++]);
-					Engine_SSE_Compressed::SetVolt(nPP,pos,m_BufferDown[n][iPos++]);
-				}
-			}
+			UnpackPlane(field, n, sendUp ? 0 : numLines[n]-2, m_RecvBuffer[n]);
+			m_RecvPending[n] = false;
 		}
-
+		SendPlanes(field, sendUp);
 	}
 }
 
-void Engine_MPI::SendReceiveCurrents()
+void Engine_MPI::SendReceiveVoltages()
 {
-	unsigned int pos[3];
+	StartSendReceive(f4_volt, true);
+	FinishSendReceive(f4_volt, true);
+}
 
-	//non-blocking prepare for receive...
-	for (int n=0;n<3;++n)
-		if (m_Op_MPI->m_NeighborUp[n]>=0)
-			MPI_Irecv( m_BufferUp[n] , m_BufferSize[n]*2, MPI_FLOAT, m_Op_MPI->m_NeighborUp[n], m_Op_MPI->m_MyTag, MPI_COMM_WORLD, &Recv_Request[n]);
+void Engine_MPI::SendReceiveCurrents()
+{
+	StartSendReceive(f4_curr, false);
+	FinishSendReceive(f4_curr, false);
+}
 
+void Engine_MPI::UpdateOverlapped(bool voltages, bool interior)
+{
+	// full update range and the interior range not depending on a pending plane
+	unsigned int stop[2];
+	unsigned int inStart[2];
+	unsigned int inStop[2];
+	// the currents are received from the upper, the voltages from the lower neighbours (see SendReceiveVoltages/Currents)
+	// Note: m_RecvPending cannot be used here, it is already cleared when the remaining lines are updated
+	bool pending[3];
 	for (int n=0;n<3;++n)
+		pending[n] = voltages ? (m_Op_MPI->m_NeighborUp[n]>=0) : (m_Op_MPI->m_NeighborDown[n]>=0);
+	for (int n=0;n<2;++n)
 	{
-		int nP  = (n+1)%3;
-		int nPP = (n+2)%3;
+		stop[n] = voltages ? numLines[n] : numLines[n]-1;
+		inStart[n] = 0;
+		inStop[n] = stop[n];
+		// voltages depend on the received currents at numLines-2, currents on the received voltages at 0
+		if (pending[n] && voltages)
+			inStop[n] = numLines[n]-2;
+		if (pending[n] && !voltages)
+			inStart[n] = 1;
+		inStop[n] = max(inStop[n], inStart[n]);
+	}
 
-		//send currents
-		unsigned int iPos=0;
-		pos[n]=0;
-		if (m_Op_MPI->m_NeighborDown[n]>=0)
+	// a z-plane is part of a single f4vector of every z-line
+	vector<unsigned int> zDefer;
+	if (pending[2])
+	{
+		if (voltages)
 		{
-			for (pos[nP]=0; pos[nP]<numLines[nP]; ++pos[nP])
-			{
-				for (pos[nPP]=0; pos[nPP]<numLines[nPP]; ++pos[nPP])
-				{
-					m_BufferDown[n][iPos++] = Engine_SSE_Compressed::GetCurr(nP ,pos);
-					m_BufferDown[n][iPos++] = Engine_SSE_Compressed::GetCurr(nPP,pos);
-				}
-			}
-			MPI_Isend( m_BufferDown[n] , m_BufferSize[n]*2, MPI_FLOAT, m_Op_MPI->m_NeighborDown[n], m_Op_MPI->m_MyTag, MPI_COMM_WORLD, &Send_Request[n]);
+			zDefer.push_back((numLines[2]-2)%numVectors);
+			zDefer.push_back((numLines[2]-1)%numVectors);
 		}
+		else
+			zDefer.push_back(0);
+		sort(zDefer.begin(), zDefer.end());
+		zDefer.erase(unique(zDefer.begin(), zDefer.end()), zDefer.end());
+	}
 
-		//receive currents
-		pos[n]=numLines[n]-2;
-		iPos=0;
-		if (m_Op_MPI->m_NeighborUp[n]>=0)
+	if (interior)
+	{
+		if (zDefer.empty() && (inStart[1]==0) && (inStop[1]==stop[1]))
 		{
-			//wait for receive to finish...
-			MPI_Wait(&Recv_Request[n],&stat);
-			for (pos[nP]=0; pos[nP]<numLines[nP]; ++pos[nP])
-			{
-				for (pos[nPP]=0; pos[nPP]<numLines[nPP]; ++pos[nPP])
-				{
-					Engine_SSE_Compressed::SetCurr(nP ,pos,m_BufferUp[n][iPos++]);
-					Engine_SSE_Compressed::SetCurr(nPP,pos,m_BufferUp[n][iPos++]);
-				}
-			}
+			// x-slabs only, use the (wide vector) engine update
+			if (voltages)
+				UpdateVoltages(inStart[0], inStop[0]-inStart[0]);
+			else
+				UpdateCurrents(inStart[0], inStop[0]-inStart[0]);
+			return;
 		}
+		unsigned int zStart = 0;
+		for (size_t i=0; i<=zDefer.size(); ++i)
+		{
+			unsigned int zStop = (i<zDefer.size()) ? zDefer.at(i) : numVectors;
+			if (voltages)
+				UpdateVoltagesBlock(inStart[0], inStop[0], inStart[1], inStop[1], zStart, zStop);
+			else
+				UpdateCurrentsBlock(inStart[0], inStop[0], inStart[1], inStop[1], zStart, zStop);
+			zStart = zStop+1;
+		}
+		return;
+	}
 
+	// remaining lines: the x-slabs, the y-slabs and the deferred f4vectors of the interior
+	if (voltages)
+	{
+		UpdateVoltagesBlock(0, inStart[0], 0, stop[1], 0, numVectors);
+		UpdateVoltagesBlock(inStop[0], stop[0], 0, stop[1], 0, numVectors);
+		UpdateVoltagesBlock(inStart[0], inStop[0], 0, inStart[1], 0, numVectors);
+		UpdateVoltagesBlock(inStart[0], inStop[0], inStop[1], stop[1], 0, numVectors);
+		for (size_t i=0; i<zDefer.size(); ++i)
+			UpdateVoltagesBlock(inStart[0], inStop[0], inStart[1], inStop[1], zDefer.at(i), zDefer.at(i)+1);
+	}
+	else
+	{
+		UpdateCurrentsBlock(0, inStart[0], 0, stop[1], 0, numVectors);
+		UpdateCurrentsBlock(inStop[0], stop[0], 0, stop[1], 0, numVectors);
+		UpdateCurrentsBlock(inStart[0], inStop[0], 0, inStart[1], 0, numVectors);
+		UpdateCurrentsBlock(inStart[0], inStop[0], inStop[1], stop[1], 0, numVectors);
+		for (size_t i=0; i<zDefer.size(); ++i)
+			UpdateCurrentsBlock(inStart[0], inStop[0], inStart[1], inStop[1], zDefer.at(i), zDefer.at(i)+1);
 	}
 }
 
@@ -188,24 +326,30 @@ bool Engine_MPI::IterateTS(unsigned int iterTS)
 		return Engine_SSE_Compressed::IterateTS(iterTS);
 	}
 
+	// the transfer of each half step runs while the interior of the following half step is updated
 	for (unsigned int iter=0; iter<iterTS; ++iter)
 	{
 		//voltage updates with extensions
 		DoPreVoltageUpdates();
-		UpdateVoltages(0,numLines[0]);
+		UpdateOverlapped(true, true);
+		FinishSendReceive(f4_curr, false);
+		UpdateOverlapped(true, false);
 		DoPostVoltageUpdates();
 		Apply2Voltages();
-		SendReceiveVoltages();
+		StartSendReceive(f4_volt, true);
 
 		//current updates with extensions
 		DoPreCurrentUpdates();
-		UpdateCurrents(0,numLines[0]-1);
+		UpdateOverlapped(false, true);
+		FinishSendReceive(f4_volt, true);
+		UpdateOverlapped(false, false);
 		DoPostCurrentUpdates();
 		Apply2Current();
-		SendReceiveCurrents();
+		StartSendReceive(f4_curr, false);
 
 		++numTS;
 	}
+	// complete the last transfer, the fields may be processed now
+	FinishSendReceive(f4_curr, false);
 	return true;
 }
-
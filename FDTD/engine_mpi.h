@@ -44,9 +44,37 @@ protected:
 	MPI_Request Recv_Request[3];
 
 	//field buffer for MPI transfer...
+	//! number of floats per field component of the interface plane in the given direction (see PackPlane)
 	unsigned int m_BufferSize[3];
-	float* m_BufferUp[3];
-	float* m_BufferDown[3];
+	f4vector* m_SendBuffer[3];
+	f4vector* m_RecvBuffer[3];
+	//! a receive is posted but has not yet been copied into the field
+	bool m_RecvPending[3];
+	//! a send is posted but has not yet been completed
+	bool m_SendPending[3];
+	//! the plane in this direction has been sent during the current transfer
+	bool m_Sent[3];
+
+	//! Copy the tangential field components of the plane at line pos in direction n into the buffer, z-lines are copied as whole f4vector lines
+	void PackPlane(f4vector**** field, int n, unsigned int pos, f4vector* buffer);
+	//! Copy the tangential field components of the plane at line pos in direction n from the buffer into the field \sa PackPlane
+	void UnpackPlane(f4vector**** field, int n, unsigned int pos, const f4vector* buffer);
+
+	//! Post the receives and start sending the given field (voltages: send the upper planes up, currents: send the lower planes down)
+	void StartSendReceive(f4vector**** field, bool sendUp);
+	//! Send all planes not depending on a pending receive, the edges of a plane may hold fields received from a lower direction
+	void SendPlanes(f4vector**** field, bool sendUp);
+	//! Wait for all receives, copy the received planes into the field and send the remaining planes
+	void FinishSendReceive(f4vector**** field, bool sendUp);
+	//! Wait for all posted sends to complete
+	void WaitForSend();
+
+	/*!
+	  Update the voltages or currents while a transfer of the other field is pending.
+	  Run the update for all lines not depending on the pending planes (interior=true) or only for the remaining lines (interior=false).
+	  Note: The pre-update extensions are executed before the transfer has finished, thus they must only access the field they are updating.
+	  */
+	void UpdateOverlapped(bool voltages, bool interior);
 
 	//! Transfer all tangential voltages at the upper bounds to the lower bounds of the neighbouring MPI-processes
 	virtual void SendReceiveVoltages();
@@ -55,6 +55,13 @@ Engine_Multithread::Engine_Multithread(const Operator_Multithread* op) : ENGINE_
 	m_IterateBarrier = 0;
 	m_startBarrier = 0;
 	m_stopBarrier = 0;
+	m_TB_NumTS = 0;
+	m_TB_Progress = 0;
+	m_NeighbourSync = false;
+	m_NS_Volt = 0;
+	m_NS_Curr = 0;
+	m_Fused = false;
+	m_NUMA = false;
 
 #ifdef ENABLE_DEBUG_TIME
 	m_MPI_Barrier = 0;
@@ -72,11 +79,10 @@ Engine_Multithread::~Engine_Multithread()
 		std::vector<double>::iterator it2;
 		for (it2=it->second.begin(); it2<it->second.end();)
 		{
-			NS_Engine_Multithread::DBG().cout() << "after voltage update, before barrier1: " << fixed << setprecision(6) << *(it2++) << std::endl;
-			NS_Engine_Multithread::DBG().cout() << "after barrier1, before barrier2: "       << fixed << setprecision(6) << *(it2++) << std::endl;
-			NS_Engine_Multithread::DBG().cout() << "after barrier2, before current update: " << fixed << setprecision(6) << *(it2++) << std::endl;
-			NS_Engine_Multithread::DBG().cout() << "after current update, before barrier3: " << fixed << setprecision(6) << *(it2++) << std::endl;
-			NS_Engine_Multithread::DBG().cout() << "after barrier3: "                        << fixed << setprecision(6) << *(it2++) << std::endl;
+			NS_Engine_Multithread::DBG().cout() << "after voltage half-step: "   << fixed << setprecision(6) << *(it2++) << std::endl;
+			NS_Engine_Multithread::DBG().cout() << "after voltage sync: "        << fixed << setprecision(6) << *(it2++) << std::endl;
+			NS_Engine_Multithread::DBG().cout() << "after current half-step: "   << fixed << setprecision(6) << *(it2++) << std::endl;
+			NS_Engine_Multithread::DBG().cout() << "after current sync: "        << fixed << setprecision(6) << *(it2++) << std::endl;
 		}
 	}
 #endif
@@ -92,6 +98,7 @@ void Engine_Multithread::setNumThreads( unsigned int numThreads )
 void Engine_Multithread::Init()
 {
 	m_stopThreads = true;
+	m_NUMA = m_Op_MT->m_NUMA; // needed by InitFields
 	ENGINE_MULTITHREAD_BASE::Init();
 
 	// initialize threads
@@ -103,6 +110,26 @@ void Engine_Multithread::Init()
 	vector<unsigned int> m_Stop_Lines;
 	m_Op_MT->CalcStartStopLines( m_numThreads, m_Start_Lines, m_Stop_Lines );
 
+	InitTemporalBlocking(m_Start_Lines, m_Stop_Lines);
+	InitNeighbourSync(m_Start_Lines, m_Stop_Lines);
+	InitFusedUpdates(m_Start_Lines, m_Stop_Lines);
+	m_Schedule[0].clear();
+	m_Schedule[1].clear();
+	if ((m_TB_NumTS<2) && !m_NeighbourSync && !m_Fused)
+		InitSchedule(m_Start_Lines, m_Stop_Lines);
+
+	m_NUMA_CPU.assign(m_numThreads, -1);
+	m_NUMA_Node.assign(m_numThreads, -1);
+	m_NUMA_Moved.assign(m_numThreads, 0);
+	if (m_NUMA)
+	{
+		vector<int> cpus = GetAllowedCPUs();
+		if (cpus.size()<m_numThreads)
+			cerr << "Engine_Multithread::Init: Warning, more threads than available cpus, multiple threads will be pinned to the same cpu..." << endl;
+		for (unsigned int n=0; n<m_numThreads && cpus.size()>0; ++n)
+			m_NUMA_CPU.at(n) = cpus.at(n%cpus.size());
+	}
+
 	if (g_settings.GetVerboseLevel()>0)
 		cout << "Multithreaded engine using " << m_numThreads << " threads. Utilization: (";
 	m_IterateBarrier = new boost::barrier(m_numThreads); // numThread workers
@@ -133,6 +160,12 @@ void Engine_Multithread::Init()
 		m_thread_group.add_thread( t );
 	}
 
+	if (m_NUMA)
+	{
+		m_stopBarrier->wait(); // wait for all threads to finish their NUMA placement
+		ShowNUMAPlacement(m_Start_Lines, m_Stop_Lines);
+	}
+
 	for (size_t n=0; n<m_Eng_exts.size(); ++n)
 		m_Eng_exts.at(n)->SetNumberOfThreads(m_numThreads);
 }
@@ -156,6 +189,12 @@ void Engine_Multithread::Reset()
 		m_startBarrier = 0;
 		delete m_stopBarrier;
 		m_stopBarrier = 0;
+		delete[] m_TB_Progress;
+		m_TB_Progress = 0;
+		delete[] m_NS_Volt;
+		m_NS_Volt = 0;
+		delete[] m_NS_Curr;
+		m_NS_Curr = 0;
 	}
 
 	ENGINE_MULTITHREAD_BASE::Reset();
@@ -174,67 +213,508 @@ bool Engine_Multithread::IterateTS(unsigned int iterTS)
 	return true;
 }
 
-void Engine_Multithread::DoPreVoltageUpdates(int threadID)
+void Engine_Multithread::InitFields()
 {
-	//execute extensions in reverse order -> highest priority gets access to the voltages last
-	for (int n=m_Eng_exts.size()-1; n>=0; --n)
+	if (m_NUMA)
 	{
-		m_Eng_exts.at(n)->DoPreVoltageUpdates(threadID);
-		m_IterateBarrier->wait();
+		f4_volt = Create_N_3DArray_v4sf(numLines, false);
+		f4_curr = Create_N_3DArray_v4sf(numLines, false);
 	}
+	else
+		ENGINE_MULTITHREAD_BASE::InitFields();
+}
 
+void Engine_Multithread::PlaceThreadNUMA(unsigned int threadID, unsigned int start, unsigned int stop)
+{
+	int cpu = m_NUMA_CPU.at(threadID);
+	if (PinThreadToCPU(cpu))
+		m_NUMA_Node.at(threadID) = GetNUMANodeOfCPU(cpu);
+	else
+		m_NUMA_CPU.at(threadID) = -1;
+
+	// the untouched field pages of the x-slab are placed on the node of this thread by zeroing them here (first touch)
+	Zero_N_3DArray_v4sf(f4_volt, numLines, start, stop-start+1);
+	Zero_N_3DArray_v4sf(f4_curr, numLines, start, stop-start+1);
+
+	// the operator was calculated by the main thread, thus move the pages of the x-slab of this thread to its node
+	int node = m_NUMA_Node.at(threadID);
+	if (node<0)
+		return;
+	bool ok = Relocate3DArray<unsigned int>(Op->m_Op_index, numLines, start, stop-start+1, node);
+	ok &= Relocate3DArray<unsigned int>(Op->m_Op_index_Wide, Op->m_numLines_Wide, start, stop-start+1, node);
+	m_NUMA_Moved.at(threadID) = ok;
 }
 
-void Engine_Multithread::DoPostVoltageUpdates(int threadID)
+void Engine_Multithread::ShowNUMAPlacement(const vector<unsigned int> &start, const vector<unsigned int> &stop) const
 {
-	//execute extensions in normal order -> highest priority gets access to the voltages first
-	for (size_t n=0; n<m_Eng_exts.size(); ++n)
+	for (unsigned int n=0; n<m_numThreads; ++n)
+		if ((m_NUMA_Node.at(n)>=0) && !m_NUMA_Moved.at(n))
+		{
+			cerr << "Engine_Multithread::ShowNUMAPlacement: Warning, the data could not be moved to the NUMA node of all threads (mbind failed)" << endl;
+			break;
+		}
+	cout << "Multithreaded engine NUMA placement:" << endl;
+	if (g_settings.GetVerboseLevel()>0)
 	{
-		m_Eng_exts.at(n)->DoPostVoltageUpdates(threadID);
-		m_IterateBarrier->wait();
+		for (unsigned int n=0; n<m_numThreads; ++n)
+		{
+			cout << "\tthread " << n << ": x-lines " << start.at(n) << "-" << stop.at(n);
+			if (m_NUMA_CPU.at(n)<0)
+				cout << ", not pinned" << endl;
+			else
+				cout << ", cpu " << m_NUMA_CPU.at(n) << ", node " << m_NUMA_Node.at(n) << endl;
+		}
+		return;
+	}
+
+	// summary per NUMA node
+	map<int, vector<unsigned int> > nodes;
+	for (unsigned int n=0; n<m_numThreads; ++n)
+		nodes[m_NUMA_Node.at(n)].push_back(n);
+	for (map<int, vector<unsigned int> >::const_iterator it=nodes.begin(); it!=nodes.end(); ++it)
+	{
+		const vector<unsigned int> &threads = it->second;
+		if (it->first<0)
+			cout << "\tunknown node";
+		else
+			cout << "\tnode " << it->first;
+		cout << ": " << threads.size() << " thread(s), x-lines " << start.at(threads.front()) << "-" << stop.at(threads.back()) << endl;
 	}
 }
 
-void Engine_Multithread::Apply2Voltages(int threadID)
+bool Engine_Multithread::CheckRangeUpdateSupport(string feature, const vector<unsigned int> &start, const vector<unsigned int> &stop) const
 {
-	//execute extensions in normal order -> highest priority gets access to the voltages first
+#ifdef MPI_SUPPORT
+	if (m_Op_MPI->GetMPIEnabled())
+	{
+		cerr << "Engine_Multithread: Warning, " << feature << " is not supported in combination with MPI, falling back to the default engine..." << endl;
+		return false;
+	}
+#endif
 	for (size_t n=0; n<m_Eng_exts.size(); ++n)
 	{
-		m_Eng_exts.at(n)->Apply2Voltages(threadID);
-		m_IterateBarrier->wait();
+		if (m_Eng_exts.at(n)->IsTemporalBlockingSafe(start, stop)==false)
+		{
+			cerr << "Engine_Multithread: Warning, extension \"" << m_Eng_exts.at(n)->GetExtensionName() << "\" does not support " << feature
+				 << " (its updates are not local to the x-lines of a thread), falling back to the default engine..." << endl;
+			return false;
+		}
 	}
+	return true;
+}
+
+void Engine_Multithread::InitTemporalBlocking(const vector<unsigned int> &start, const vector<unsigned int> &stop)
+{
+	m_TB_NumTS = 0;
+	if (m_Op_MT->m_TB_NumTS<2)
+		return;
+	if (!CheckRangeUpdateSupport("temporal blocking", start, stop))
+		return;
+
+	m_TB_NumTS = m_Op_MT->m_TB_NumTS;
+	m_TB_Progress = new boost::atomic<unsigned int>[m_numThreads];
+	for (unsigned int n=0; n<m_numThreads; ++n)
+		m_TB_Progress[n] = 0;
+	cout << "Multithreaded engine using temporal blocking with " << m_TB_NumTS << " timesteps per block" << endl;
 }
 
-void Engine_Multithread::DoPreCurrentUpdates(int threadID)
+void Engine_Multithread::IterateTS_TemporalBlocking(unsigned int threadID, unsigned int start, unsigned int stop, unsigned int stop_h)
 {
-	//execute extensions in reverse order -> highest priority gets access to the currents last
-	for (int n=m_Eng_exts.size()-1; n>=0; --n)
+	/* Voltages of timestep t at x-line x need the currents at x and x-1 of timestep t-1, currents of timestep t at x need the voltages at x and x+1 of timestep t.
+	   Thus all updates can be done in a single sweep (step p) through the x-lines, with the voltages of timestep t updated at x=p-2t and the currents at x=p-2t-1.
+	   Only 2*m_TB_NumTS x-lines are active at a time and will reside in the cache.
+	   Neighbouring threads only synchronize via their wavefront progress: A thread may execute step s if its lower neighbour finished step s-2 and its upper neighbour finished step s.
+	*/
+	unsigned int step = m_TB_Progress[threadID];
+	unsigned int baseTS = numTS;
+	int numExt = m_Eng_exts.size();
+	for (unsigned int iter=0; iter<m_iterTS; )
 	{
-		m_Eng_exts.at(n)->DoPreCurrentUpdates(threadID);
-		m_IterateBarrier->wait();
+		unsigned int numBlock = min(m_TB_NumTS, m_iterTS-iter);
+		unsigned int numSteps = numLines[0] + 2*numBlock - 2;
+		for (unsigned int p=0; p<numSteps; ++p)
+		{
+			if ((threadID>0) && (step>1))
+				while (m_TB_Progress[threadID-1].load(boost::memory_order_acquire) < step-1)
+					boost::this_thread::yield();
+			if (threadID<m_numThreads-1)
+				while (m_TB_Progress[threadID+1].load(boost::memory_order_acquire) < step+1)
+					boost::this_thread::yield();
+
+			for (unsigned int t=0; t<numBlock; ++t)
+			{
+				int x = (int)p - 2*(int)t;
+				if (x<(int)start)
+					break;
+				int ts = baseTS+iter+t;
+				if (x<=(int)stop)
+				{
+					//execute pre updates in reverse order -> highest priority gets access to the voltages last
+					for (int n=numExt-1; n>=0; --n)
+						m_Eng_exts.at(n)->DoPreVoltageUpdatesRange(x, 1, ts);
+					UpdateVoltages(x,1);
+					for (int n=0; n<numExt; ++n)
+						m_Eng_exts.at(n)->DoPostVoltageUpdatesRange(x, 1, ts);
+					for (int n=0; n<numExt; ++n)
+						m_Eng_exts.at(n)->Apply2VoltagesRange(x, 1, ts);
+				}
+				--x;
+				if ((x>=(int)start) && (x<=(int)stop_h))
+				{
+					for (int n=numExt-1; n>=0; --n)
+						m_Eng_exts.at(n)->DoPreCurrentUpdatesRange(x, 1, ts);
+					UpdateCurrents(x,1);
+					for (int n=0; n<numExt; ++n)
+						m_Eng_exts.at(n)->DoPostCurrentUpdatesRange(x, 1, ts);
+					for (int n=0; n<numExt; ++n)
+						m_Eng_exts.at(n)->Apply2CurrentRange(x, 1, ts);
+				}
+			}
+			++step;
+			m_TB_Progress[threadID].store(step, boost::memory_order_release);
+		}
+		iter += numBlock;
 	}
+
+	m_IterateBarrier->wait();
+	if (threadID == 0)
+		numTS += m_iterTS; // only the first thread increments numTS
 }
 
-void Engine_Multithread::DoPostCurrentUpdates(int threadID)
+void Engine_Multithread::InitNeighbourSync(const vector<unsigned int> &start, const vector<unsigned int> &stop)
 {
-	//execute extensions in normal order -> highest priority gets access to the currents first
-	for (size_t n=0; n<m_Eng_exts.size(); ++n)
+	m_NeighbourSync = false;
+	if (!m_Op_MT->m_NeighbourSync || (m_TB_NumTS>1)) // temporal blocking is already using neighbour synchronization
+		return;
+	if (!CheckRangeUpdateSupport("neighbour synchronization", start, stop))
+		return;
+
+	m_NeighbourSync = true;
+	m_NS_Volt = new boost::atomic<unsigned int>[m_numThreads];
+	m_NS_Curr = new boost::atomic<unsigned int>[m_numThreads];
+	for (unsigned int n=0; n<m_numThreads; ++n)
 	{
-		m_Eng_exts.at(n)->DoPostCurrentUpdates(threadID);
-		m_IterateBarrier->wait();
+		m_NS_Volt[n] = 0;
+		m_NS_Curr[n] = 0;
 	}
+	cout << "Multithreaded engine using neighbour synchronization" << endl;
 }
 
-void Engine_Multithread::Apply2Current(int threadID)
+void Engine_Multithread::IterateTS_NeighbourSync(unsigned int threadID, unsigned int start, unsigned int stop, unsigned int stop_h)
 {
-	//execute extensions in normal order -> highest priority gets access to the currents first
-	for (size_t n=0; n<m_Eng_exts.size(); ++n)
+	/* The voltage updates of a thread need the currents at its first x-line from its lower neighbour, the current updates need the voltages at the
+	   last x-line from its upper neighbour. Thus every thread only waits for the number of finished half-steps of its two neighbours.
+	*/
+	unsigned int count = m_NS_Volt[threadID];
+	unsigned int baseTS = numTS;
+	int numExt = m_Eng_exts.size();
+	for (unsigned int iter=0; iter<m_iterTS; ++iter)
 	{
-		m_Eng_exts.at(n)->Apply2Current(threadID);
+		// voltage updates
+		if (threadID>0)
+			while (m_NS_Curr[threadID-1].load(boost::memory_order_acquire) < count)
+				boost::this_thread::yield();
+		//execute pre updates in reverse order -> highest priority gets access to the voltages last
+		for (int n=numExt-1; n>=0; --n)
+			m_Eng_exts.at(n)->DoPreVoltageUpdatesRange(start, stop-start+1, baseTS+iter);
+		UpdateVoltages(start,stop-start+1);
+		for (int n=0; n<numExt; ++n)
+			m_Eng_exts.at(n)->DoPostVoltageUpdatesRange(start, stop-start+1, baseTS+iter);
+		for (int n=0; n<numExt; ++n)
+			m_Eng_exts.at(n)->Apply2VoltagesRange(start, stop-start+1, baseTS+iter);
+		m_NS_Volt[threadID].store(count+1, boost::memory_order_release);
+
+		// current updates
+		if (threadID<m_numThreads-1)
+			while (m_NS_Volt[threadID+1].load(boost::memory_order_acquire) < count+1)
+				boost::this_thread::yield();
+		for (int n=numExt-1; n>=0; --n)
+			m_Eng_exts.at(n)->DoPreCurrentUpdatesRange(start, stop_h-start+1, baseTS+iter);
+		UpdateCurrents(start,stop_h-start+1);
+		for (int n=0; n<numExt; ++n)
+			m_Eng_exts.at(n)->DoPostCurrentUpdatesRange(start, stop_h-start+1, baseTS+iter);
+		for (int n=0; n<numExt; ++n)
+			m_Eng_exts.at(n)->Apply2CurrentRange(start, stop_h-start+1, baseTS+iter);
+		++count;
+		m_NS_Curr[threadID].store(count, boost::memory_order_release);
+	}
+
+	m_IterateBarrier->wait();
+	if (threadID == 0)
+		numTS += m_iterTS; // only the first thread increments numTS
+}
+
+void Engine_Multithread::InitFusedUpdates(const vector<unsigned int> &start, const vector<unsigned int> &stop)
+{
+	m_Fused = false;
+	m_Fused_Actions.clear();
+	if (!m_Op_MT->m_FusedUpdates || (m_TB_NumTS>1) || m_NeighbourSync) // temporal blocking and neighbour synchronization are already fusing the extensions
+		return;
+	// the extensions are updated plane by plane, as for temporal blocking
+	if (!CheckRangeUpdateSupport("fused updates", start, stop))
+		return;
+
+	// build the sparse list of extension work for each x-slab
+	unsigned int numActions = 0;
+	m_Fused_Actions.resize(m_numThreads);
+	for (unsigned int t=0; t<m_numThreads; ++t)
+	{
+		unsigned int stop_h = (t==m_numThreads-1) ? stop.at(t)-1 : stop.at(t);
+		for (size_t n=0; n<m_Eng_exts.size(); ++n)
+		{
+			unsigned int extStart, extStop;
+			if (m_Eng_exts.at(n)->GetFootprint(extStart, extStop)==false)
+				continue;
+			FusedAction action;
+			action.ext = m_Eng_exts.at(n);
+			action.startX = max(extStart, start.at(t));
+			if ((action.startX>extStop) || (action.startX>stop.at(t)))
+				continue;
+			action.numX = min(extStop, stop.at(t)) - action.startX + 1;
+			action.numX_h = (action.startX>stop_h) ? 0 : min(extStop, stop_h) - action.startX + 1;
+			m_Fused_Actions.at(t).push_back(action);
+			++numActions;
+		}
+	}
+
+	m_Fused = true;
+	cout << "Multithreaded engine using fused updates per x-plane with " << numActions << " extension slab(s) for " << m_Eng_exts.size() << " extension(s)" << endl;
+}
+
+void Engine_Multithread::IterateTS_Fused(unsigned int threadID, unsigned int start, unsigned int stop, unsigned int stop_h)
+{
+	/* The extension work is fused into the x-plane loop of the engine: every x-plane of the slab of this thread is updated in the order
+	   pre update, engine update, post update and apply, while the plane is still in cache (see Engine_Extension::IsTemporalBlockingSafe()).
+	   Only the two barriers between the voltage and current updates are needed, instead of one barrier per extension and stage.
+	*/
+	const vector<FusedAction> &actions = m_Fused_Actions.at(threadID);
+	int numAct = actions.size();
+	unsigned int baseTS = numTS;
+	for (unsigned int iter=0; iter<m_iterTS; ++iter)
+	{
+		int ts = baseTS+iter;
+		for (unsigned int x=start; x<=stop; ++x)
+		{
+			//execute pre updates in reverse order -> highest priority gets access to the voltages last
+			for (int n=numAct-1; n>=0; --n)
+				if (x-actions[n].startX<actions[n].numX)
+					actions[n].ext->DoPreVoltageUpdatesRange(x, 1, ts);
+			UpdateVoltages(x,1);
+			for (int n=0; n<numAct; ++n)
+				if (x-actions[n].startX<actions[n].numX)
+					actions[n].ext->DoPostVoltageUpdatesRange(x, 1, ts);
+			for (int n=0; n<numAct; ++n)
+				if (x-actions[n].startX<actions[n].numX)
+					actions[n].ext->Apply2VoltagesRange(x, 1, ts);
+		}
+
+		m_IterateBarrier->wait();
+
+		for (unsigned int x=start; x<=stop_h; ++x)
+		{
+			for (int n=numAct-1; n>=0; --n)
+				if (x-actions[n].startX<actions[n].numX_h)
+					actions[n].ext->DoPreCurrentUpdatesRange(x, 1, ts);
+			UpdateCurrents(x,1);
+			for (int n=0; n<numAct; ++n)
+				if (x-actions[n].startX<actions[n].numX_h)
+					actions[n].ext->DoPostCurrentUpdatesRange(x, 1, ts);
+			for (int n=0; n<numAct; ++n)
+				if (x-actions[n].startX<actions[n].numX_h)
+					actions[n].ext->Apply2CurrentRange(x, 1, ts);
+		}
+
+		if (threadID == 0)
+			++numTS; // only the first thread increments numTS, visible to all threads after the barrier
 		m_IterateBarrier->wait();
 	}
 }
 
+void Engine_Multithread::InitSchedule(const vector<unsigned int> &start, const vector<unsigned int> &stop)
+{
+	bool allowLocal = true;
+#ifdef MPI_SUPPORT
+	// the x-range updates are not used in combination with MPI, see InitFusedUpdates()
+	if (m_Op_MPI->GetMPIEnabled())
+		allowLocal = false;
+#endif
+
+	unsigned int numBarriers = 0;
+	for (int phase=0; phase<2; ++phase)
+	{
+		vector<ScheduleStep> &steps = m_Schedule[phase];
+		steps.clear();
+
+		//execute pre updates in reverse order -> highest priority gets access to the fields last
+		AddScheduleSteps(steps, phase==0 ? Engine_Extension::PRE_VOLTAGE : Engine_Extension::PRE_CURRENT, true, start, stop, allowLocal);
+		ScheduleStep update;
+		update.ext = NULL;
+		update.stage = 0;
+		update.local = true;
+		update.barrier = false;
+		update.footStart = 0;
+		update.footStop = numLines[0]-1;
+		steps.push_back(update);
+		//execute post updates and apply in normal order -> highest priority gets access to the fields first
+		AddScheduleSteps(steps, phase==0 ? Engine_Extension::POST_VOLTAGE : Engine_Extension::POST_CURRENT, false, start, stop, allowLocal);
+		AddScheduleSteps(steps, phase==0 ? Engine_Extension::APPLY_VOLTAGE : Engine_Extension::APPLY_CURRENT, false, start, stop, allowLocal);
+
+		/* Place the barriers: A step has to wait for the other threads only if its footprint, extended by the neighbouring x-lines needed by the curl,
+		   overlaps with the x-lines accessed by another thread since the last barrier.
+		   Local steps (including the main engine update) of all threads access their own x-slab only, thus they only have to wait for global steps.
+		   Global steps are executed by a single thread or with their own partitioning and have to wait for any overlapping step.
+		   With full barriers requested, every step waits for all threads, e.g. to verify the elided schedule.
+		*/
+		bool accLocal=false, accGlobal=false;
+		unsigned int localStart=0, localStop=0, globalStart=0, globalStop=0;
+		// numTS was incremented by the first thread at the end of the previous timestep
+		bool accNumTS = (phase==0);
+		for (size_t n=0; n<steps.size(); ++n)
+		{
+			ScheduleStep &step = steps.at(n);
+			unsigned int footStart = step.footStart>0 ? step.footStart-1 : 0;
+			unsigned int footStop = step.footStop+1;
+			bool overlapLocal = accLocal && (footStart<=localStop) && (footStop>=localStart);
+			bool overlapGlobal = accGlobal && (footStart<=globalStop) && (footStop>=globalStart);
+			if (m_Op_MT->m_FullBarriers)
+				step.barrier = true;
+			else if (step.local)
+				step.barrier = overlapGlobal;
+			else
+				step.barrier = accNumTS || overlapLocal || overlapGlobal;
+			if (step.barrier)
+			{
+				accLocal = accGlobal = accNumTS = false;
+				++numBarriers;
+			}
+			if (step.local)
+			{
+				localStart = accLocal ? min(localStart, step.footStart) : step.footStart;
+				localStop = accLocal ? max(localStop, step.footStop) : step.footStop;
+				accLocal = true;
+			}
+			else
+			{
+				globalStart = accGlobal ? min(globalStart, step.footStart) : step.footStart;
+				globalStop = accGlobal ? max(globalStop, step.footStop) : step.footStop;
+				accGlobal = true;
+			}
+		}
+		++numBarriers; // every half-step ends with a barrier
+	}
+
+	if (g_settings.GetVerboseLevel()>0)
+		cout << "Multithreaded engine using " << numBarriers << " barrier(s) per timestep for " << m_Eng_exts.size() << " extension(s)" << endl;
+}
+
+void Engine_Multithread::AddScheduleSteps(vector<ScheduleStep> &steps, int stage, bool reverse, const vector<unsigned int> &start, const vector<unsigned int> &stop, bool allowLocal)
+{
+	bool current = (stage>=Engine_Extension::PRE_CURRENT);
+	int numExt = m_Eng_exts.size();
+	for (int i=0; i<numExt; ++i)
+	{
+		Engine_Extension* ext = m_Eng_exts.at(reverse ? numExt-1-i : i);
+		if ((ext->GetUpdateStages() & stage)==0)
+			continue;
+		ScheduleStep step;
+		step.ext = ext;
+		step.stage = stage;
+		step.barrier = false;
+		if (ext->GetFootprint(step.footStart, step.footStop)==false)
+			continue;
+		step.footStop = min(step.footStop, numLines[0]-1);
+		step.local = allowLocal && ext->IsFusedUpdateSafe(start, stop);
+		if (step.local)
+		{
+			// run the x-range method only on the threads owning a part of the footprint
+			for (size_t t=0; t<start.size(); ++t)
+			{
+				unsigned int stop_t = (current && (t==start.size()-1)) ? stop.at(t)-1 : stop.at(t);
+				unsigned int startX = max(step.footStart, start.at(t));
+				step.startX.push_back(startX);
+				if ((startX>step.footStop) || (startX>stop_t))
+					step.numX.push_back(0);
+				else
+					step.numX.push_back(min(step.footStop, stop_t) - startX + 1);
+			}
+		}
+		steps.push_back(step);
+	}
+}
+
+void Engine_Multithread::RunSchedule(int phase, unsigned int threadID, unsigned int start, unsigned int numX, int timestep)
+{
+	const vector<ScheduleStep> &steps = m_Schedule[phase];
+	for (size_t n=0; n<steps.size(); ++n)
+	{
+		const ScheduleStep &step = steps[n];
+		if (step.barrier)
+			m_IterateBarrier->wait();
+
+		if (step.ext==NULL)
+		{
+			if (phase==0)
+				UpdateVoltages(start,numX);
+			else
+				UpdateCurrents(start,numX);
+			continue;
+		}
+
+		if (step.local)
+		{
+			unsigned int x = step.startX[threadID];
+			unsigned int num = step.numX[threadID];
+			if (num==0)
+				continue;
+			switch (step.stage)
+			{
+			case Engine_Extension::PRE_VOLTAGE:
+				step.ext->DoPreVoltageUpdatesRange(x, num, timestep);
+				break;
+			case Engine_Extension::POST_VOLTAGE:
+				step.ext->DoPostVoltageUpdatesRange(x, num, timestep);
+				break;
+			case Engine_Extension::APPLY_VOLTAGE:
+				step.ext->Apply2VoltagesRange(x, num, timestep);
+				break;
+			case Engine_Extension::PRE_CURRENT:
+				step.ext->DoPreCurrentUpdatesRange(x, num, timestep);
+				break;
+			case Engine_Extension::POST_CURRENT:
+				step.ext->DoPostCurrentUpdatesRange(x, num, timestep);
+				break;
+			case Engine_Extension::APPLY_CURRENT:
+				step.ext->Apply2CurrentRange(x, num, timestep);
+				break;
+			}
+			continue;
+		}
+
+		switch (step.stage)
+		{
+		case Engine_Extension::PRE_VOLTAGE:
+			step.ext->DoPreVoltageUpdates(threadID);
+			break;
+		case Engine_Extension::POST_VOLTAGE:
+			step.ext->DoPostVoltageUpdates(threadID);
+			break;
+		case Engine_Extension::APPLY_VOLTAGE:
+			step.ext->Apply2Voltages(threadID);
+			break;
+		case Engine_Extension::PRE_CURRENT:
+			step.ext->DoPreCurrentUpdates(threadID);
+			break;
+		case Engine_Extension::POST_CURRENT:
+			step.ext->DoPostCurrentUpdates(threadID);
+			break;
+		case Engine_Extension::APPLY_CURRENT:
+			step.ext->Apply2Current(threadID);
+			break;
+		}
+	}
+	m_IterateBarrier->wait();
+}
+
 //
 // *************************************************************************************************************************
 //
@@ -262,6 +742,12 @@ void thread::operator()()
 	_mm_setcsr( newMXCSR ); //write the new MXCSR setting to the MXCSR
 #endif
 
+	if (m_enginePtr->m_NUMA)
+	{
+		m_enginePtr->PlaceThreadNUMA(m_threadID, m_start, m_stop);
+		m_enginePtr->m_stopBarrier->wait(); // NUMA placement done
+	}
+
 	while (!m_enginePtr->m_stopThreads)
 	{
 		// wait for start
@@ -271,27 +757,34 @@ void thread::operator()()
 
 		DEBUG_TIME( Timer timer1 );
 
-		for (unsigned int iter=0; iter<m_enginePtr->m_iterTS; ++iter)
+		if (m_enginePtr->m_TB_NumTS>1)
 		{
-			// pre voltage stuff...
-			m_enginePtr->DoPreVoltageUpdates(m_threadID);
-
-			//voltage updates
-			m_enginePtr->UpdateVoltages(m_start,m_stop-m_start+1);
-
-			// record time
-			DEBUG_TIME( m_enginePtr->m_timer_list[boost::this_thread::get_id()].push_back( timer1.elapsed() ); )
+			m_enginePtr->IterateTS_TemporalBlocking(m_threadID, m_start, m_stop, m_stop_h);
+			m_enginePtr->m_stopBarrier->wait();
+			continue;
+		}
+		if (m_enginePtr->m_NeighbourSync)
+		{
+			m_enginePtr->IterateTS_NeighbourSync(m_threadID, m_start, m_stop, m_stop_h);
+			m_enginePtr->m_stopBarrier->wait();
+			continue;
+		}
+		if (m_enginePtr->m_Fused)
+		{
+			m_enginePtr->IterateTS_Fused(m_threadID, m_start, m_stop, m_stop_h);
+			m_enginePtr->m_stopBarrier->wait();
+			continue;
+		}
 
-			//cout << "Thread " << boost::this_thread::get_id() << " m_barrier1 waiting..." << endl;
-			m_enginePtr->m_IterateBarrier->wait();
+		unsigned int baseTS = m_enginePtr->numTS;
+		for (unsigned int iter=0; iter<m_enginePtr->m_iterTS; ++iter)
+		{
+			//voltage updates with all scheduled extensions
+			m_enginePtr->RunSchedule(0, m_threadID, m_start, m_stop-m_start+1, baseTS+iter);
 
 			// record time
 			DEBUG_TIME( m_enginePtr->m_timer_list[boost::this_thread::get_id()].push_back( timer1.elapsed() ); )
 
-			//post voltage stuff...
-			m_enginePtr->DoPostVoltageUpdates(m_threadID);
-			m_enginePtr->Apply2Voltages(m_threadID);
-
 #ifdef MPI_SUPPORT
 			if (m_threadID==0)
 			{
@@ -305,23 +798,12 @@ void thread::operator()()
 			// record time
 			DEBUG_TIME( m_enginePtr->m_timer_list[boost::this_thread::get_id()].push_back( timer1.elapsed() ); )
 
-			//pre current stuff
-			m_enginePtr->DoPreCurrentUpdates(m_threadID);
-
-			//current updates
-			m_enginePtr->UpdateCurrents(m_start,m_stop_h-m_start+1);
-
-			// record time
-			DEBUG_TIME( m_enginePtr->m_timer_list[boost::this_thread::get_id()].push_back( timer1.elapsed() ); )
-			m_enginePtr->m_IterateBarrier->wait();
+			//current updates with all scheduled extensions
+			m_enginePtr->RunSchedule(1, m_threadID, m_start, m_stop_h-m_start+1, baseTS+iter);
 
 			// record time
 			DEBUG_TIME( m_enginePtr->m_timer_list[boost::this_thread::get_id()].push_back( timer1.elapsed() ); )
 
-			//post current stuff
-			m_enginePtr->DoPostCurrentUpdates(m_threadID);
-			m_enginePtr->Apply2Current(m_threadID);
-
 #ifdef MPI_SUPPORT
 			if (m_threadID==0)
 			{
@@ -332,6 +814,9 @@ void thread::operator()()
 			m_enginePtr->m_IterateBarrier->wait();
 #endif
 
+			// record time
+			DEBUG_TIME( m_enginePtr->m_timer_list[boost::this_thread::get_id()].push_back( timer1.elapsed() ); )
+
 			if (m_threadID == 0)
 				++m_enginePtr->numTS; // only the first thread increments numTS
 		}
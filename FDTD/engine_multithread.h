@@ -22,6 +22,7 @@
 #include "engine_sse_compressed.h"
 
 #include <boost/thread.hpp>
+#include <boost/atomic.hpp>
 #include <boost/fusion/include/list.hpp>
 #include <boost/fusion/container/list/list_fwd.hpp>
 #include <boost/fusion/include/list_fwd.hpp>
@@ -88,22 +89,17 @@ public:
 	virtual ~Engine_Multithread();
 
 	virtual void setNumThreads( unsigned int numThreads );
+	virtual unsigned int GetNumberOfThreads() const {return m_numThreads;}
 	virtual void Init();
 	virtual void Reset();
 
 	//! Iterate \a iterTS number of timesteps
 	virtual bool IterateTS(unsigned int iterTS);
 
-	virtual void DoPreVoltageUpdates(int threadID);
-	virtual void DoPostVoltageUpdates(int threadID);
-	virtual void Apply2Voltages(int threadID);
-
-	virtual void DoPreCurrentUpdates(int threadID);
-	virtual void DoPostCurrentUpdates(int threadID);
-	virtual void Apply2Current(int threadID);
-
 protected:
 	Engine_Multithread(const Operator_Multithread* op);
+	//! With NUMA placement the fields are allocated without zeroing, the pinned threads zero their x-slab (first touch), see PlaceThreadNUMA()
+	virtual void InitFields();
 	const Operator_Multithread* m_Op_MT;
 	boost::thread_group m_thread_group;
 	boost::barrier *m_startBarrier, *m_stopBarrier;
@@ -112,6 +108,74 @@ protected:
 	unsigned int m_numThreads; //!< number of worker threads
 	volatile bool m_stopThreads;
 
+	//! Number of timesteps per temporal block, 0 if temporal blocking is disabled
+	unsigned int m_TB_NumTS;
+	//! Number of wavefront steps finished by each thread
+	boost::atomic<unsigned int>* m_TB_Progress;
+	//! Enable temporal blocking if requested by the operator and supported by all extensions
+	void InitTemporalBlocking(const vector<unsigned int> &start, const vector<unsigned int> &stop);
+	//! Iterate m_iterTS timesteps of the given thread using a skewed wavefront in x-direction (temporal blocking)
+	void IterateTS_TemporalBlocking(unsigned int threadID, unsigned int start, unsigned int stop, unsigned int stop_h);
+
+	//! Synchronize the threads only with their neighbouring x-slabs instead of using global barriers
+	bool m_NeighbourSync;
+	//! Number of finished voltage and current half-steps by each thread
+	boost::atomic<unsigned int> *m_NS_Volt, *m_NS_Curr;
+	//! Enable neighbour synchronization if requested by the operator and supported by all extensions
+	void InitNeighbourSync(const vector<unsigned int> &start, const vector<unsigned int> &stop);
+	//! Iterate m_iterTS timesteps of the given thread, synchronized with the neighbouring threads only
+	void IterateTS_NeighbourSync(unsigned int threadID, unsigned int start, unsigned int stop, unsigned int stop_h);
+
+	//! Apply the extensions plane by plane within the x-slab sweep of each thread, without extra passes and barriers
+	bool m_Fused;
+	//! Extension work within the x-slab of a thread
+	struct FusedAction
+	{
+		Engine_Extension* ext;
+		unsigned int startX; //!< first x-line
+		unsigned int numX;   //!< number of x-lines for the voltage updates
+		unsigned int numX_h; //!< number of x-lines for the current updates
+	};
+	//! Sparse list of the extension work in the x-slab of each thread, sorted by extension priority
+	vector< vector<FusedAction> > m_Fused_Actions;
+	//! Enable the fused updates if requested by the operator and supported by all extensions
+	void InitFusedUpdates(const vector<unsigned int> &start, const vector<unsigned int> &stop);
+	//! Iterate m_iterTS timesteps of the given thread with the extensions fused into the x-plane loop of the engine
+	void IterateTS_Fused(unsigned int threadID, unsigned int start, unsigned int stop, unsigned int stop_h);
+
+	//! Extension work of the default engine for a half-step, see InitSchedule()
+	struct ScheduleStep
+	{
+		Engine_Extension* ext; //!< NULL for the main engine update
+		int stage;             //!< update stage, see Engine_Extension::UpdateStage
+		bool local;            //!< run the x-range method on the x-slab of each thread, otherwise the threadID method
+		bool barrier;          //!< synchronize all threads before this step
+		unsigned int footStart, footStop; //!< footprint of the extension
+		vector<unsigned int> startX; //!< first x-line of each thread (local steps only)
+		vector<unsigned int> numX;   //!< number of x-lines of each thread, 0 if the thread does not own any x-line of the footprint
+	};
+	//! Steps of the voltage (0) and current (1) half-step, each half-step ends with a barrier
+	vector<ScheduleStep> m_Schedule[2];
+	//! Build the schedule of the default engine from the update stages and footprints of all extensions
+	void InitSchedule(const vector<unsigned int> &start, const vector<unsigned int> &stop);
+	//! Add the steps of the given stage for all extensions taking part in it
+	void AddScheduleSteps(vector<ScheduleStep> &steps, int stage, bool reverse, const vector<unsigned int> &start, const vector<unsigned int> &stop, bool allowLocal);
+	//! Execute the scheduled voltage (0) or current (1) half-step of the given thread
+	void RunSchedule(int phase, unsigned int threadID, unsigned int start, unsigned int numX, int timestep);
+
+	//! Pin the worker threads to a cpu and place their x-slabs on the local NUMA node
+	bool m_NUMA;
+	vector<int> m_NUMA_CPU; //!< cpu of each worker thread, -1 if not pinned
+	vector<int> m_NUMA_Node; //!< NUMA node of each worker thread, -1 if unknown
+	vector<int> m_NUMA_Moved; //!< 1 if the x-slab data of a worker thread was moved to its node
+	//! Pin the calling worker thread, zero the fields of its x-slab (first touch) and move the operator data of its x-slab to its NUMA node
+	virtual void PlaceThreadNUMA(unsigned int threadID, unsigned int start, unsigned int stop);
+	//! Print the thread placement to the startup banner
+	void ShowNUMAPlacement(const vector<unsigned int> &start, const vector<unsigned int> &stop) const;
+
+	//! Check if all extensions support the x-range updates (see Engine_Extension::IsTemporalBlockingSafe()) needed by the given feature, print the reason if not
+	bool CheckRangeUpdateSupport(string feature, const vector<unsigned int> &start, const vector<unsigned int> &stop) const;
+
 #ifdef MPI_SUPPORT
 	/*! Workaround needed for subgridding scheme... (see Engine_CylinderMultiGrid)
 	 Some engines may need an additional barrier for synchronizing MPI communication.
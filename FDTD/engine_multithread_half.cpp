@@ -0,0 +1,536 @@
+/*
+*	Copyright (C) 2026 openEMS contributors
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "engine_multithread_half.h"
+#include "tools/array_ops.h"
+#include "tools/global.h"
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+#ifdef __F16C__
+#include <immintrin.h>
+#endif
+
+unsigned short FloatToHalf(float value)
+{
+	// branch-light conversion, rounding to nearest even, see F. Giesen "half_float.cpp"
+	union {float f; uint32_t u;} f32;
+	union {uint32_t u; float f;} denorm_magic;
+	f32.f = value;
+	denorm_magic.u = ((127 - 15) + (23 - 10) + 1) << 23;
+	const uint32_t f32infty = 255u << 23;
+	const uint32_t f16max = (127 + 16) << 23;
+	uint32_t sign = f32.u & 0x80000000u;
+	f32.u ^= sign;
+	unsigned short out;
+	if (f32.u >= f16max) // Inf or NaN
+		out = (f32.u > f32infty) ? 0x7E00 : 0x7C00;
+	else if (f32.u < (113u << 23)) // subnormal half or zero, let the float addition do the rounding
+	{
+		f32.f += denorm_magic.f;
+		out = f32.u - denorm_magic.u;
+	}
+	else
+	{
+		uint32_t mant_odd = (f32.u >> 13) & 1;
+		f32.u += ((uint32_t)(15 - 127) << 23) + 0xFFF;
+		f32.u += mant_odd;
+		out = f32.u >> 13;
+	}
+	return out | (sign >> 16);
+}
+
+float HalfToFloat(unsigned short value)
+{
+	union {uint32_t u; float f;} out;
+	union {uint32_t u; float f;} magic;
+	magic.u = 113u << 23;
+	const uint32_t shifted_exp = 0x7C00u << 13;
+	out.u = (value & 0x7FFFu) << 13;
+	uint32_t exp = shifted_exp & out.u;
+	out.u += (127 - 15) << 23;
+	if (exp == shifted_exp) // Inf or NaN
+		out.u += (128 - 16) << 23;
+	else if (exp == 0) // zero or subnormal
+	{
+		out.u += 1 << 23;
+		out.f -= magic.f;
+	}
+	out.u |= (value & 0x8000u) << 16;
+	return out.f;
+}
+
+inline void Half_FP16::Decode(const h4vector &in, f4vector &out)
+{
+#ifdef __F16C__
+	out.v = (v4sf)_mm_cvtph_ps(_mm_loadl_epi64((const __m128i*)&in));
+#else
+	for (int n=0; n<4; ++n)
+		out.f[n] = HalfToFloat(in.h[n]);
+#endif
+}
+
+inline void Half_FP16::Encode(const f4vector &in, h4vector &out)
+{
+#ifdef __F16C__
+	_mm_storel_epi64((__m128i*)&out, _mm_cvtps_ph((__m128)in.v, _MM_FROUND_TO_NEAREST_INT));
+#else
+	for (int n=0; n<4; ++n)
+		out.h[n] = FloatToHalf(in.f[n]);
+#endif
+}
+
+inline void Half_BF16::Decode(const h4vector &in, f4vector &out)
+{
+#ifdef __SSE2__
+	out.v = (v4sf)_mm_unpacklo_epi16(_mm_setzero_si128(), _mm_loadl_epi64((const __m128i*)&in));
+#else
+	for (int n=0; n<4; ++n)
+		out.f[n] = BFloat16ToFloat(in.h[n]);
+#endif
+}
+
+inline void Half_BF16::Encode(const f4vector &in, h4vector &out)
+{
+#ifdef __SSE2__
+	__m128i u = (__m128i)in.v;
+	__m128i round = _mm_add_epi32(_mm_and_si128(_mm_srli_epi32(u, 16), _mm_set1_epi32(1)), _mm_set1_epi32(0x7FFF));
+	// the arithmetic shift keeps the upper 16 bits in the signed range, thus the saturating pack is exact
+	u = _mm_srai_epi32(_mm_add_epi32(u, round), 16);
+	_mm_storel_epi64((__m128i*)&out, _mm_packs_epi32(u, u));
+#else
+	for (int n=0; n<4; ++n)
+		out.h[n] = FloatToBFloat16(in.f[n]);
+#endif
+}
+
+//! shift a f4vector by one float to higher z-lines, used for the z-wrap-around of the voltage updates
+static inline void ShiftUp(const f4vector &in, f4vector &out)
+{
+#ifdef __SSE2__
+	out.v = (v4sf)_mm_slli_si128( (__m128i)in.v, 4 );
+#else
+	out.f[0] = 0;
+	out.f[1] = in.f[0];
+	out.f[2] = in.f[1];
+	out.f[3] = in.f[2];
+#endif
+}
+
+//! shift a f4vector by one float to lower z-lines, used for the z-wrap-around of the current updates
+static inline void ShiftDown(const f4vector &in, f4vector &out)
+{
+#ifdef __SSE2__
+	out.v = (v4sf)_mm_srli_si128( (__m128i)in.v, 4 );
+#else
+	out.f[0] = in.f[1];
+	out.f[1] = in.f[2];
+	out.f[2] = in.f[3];
+	out.f[3] = 0;
+#endif
+}
+
+Engine_Multithread_Half* Engine_Multithread_Half::New(const Operator_Multithread* op, unsigned int numThreads)
+{
+	cout << "Create FDTD engine (compressed SSE + multi-threading + ";
+	Engine_Multithread_Half* e = NULL;
+	if (op->GetHalfPrecision()==Operator_SSE_Compressed::HALF_BF16)
+	{
+		cout << "bfloat16";
+		e = new Engine_Multithread_Half_Format<Half_BF16>(op);
+	}
+	else
+	{
+		cout << "half float";
+		e = new Engine_Multithread_Half_Format<Half_FP16>(op);
+	}
+	cout << " field storage)" << endl;
+	e->setNumThreads( numThreads );
+	e->Init();
+	return e;
+}
+
+Engine_Multithread_Half::Engine_Multithread_Half(const Operator_Multithread* op) : Engine_Multithread(op), m_LineBuffer(Delete1DArray_v4sf)
+{
+	// extensions have to use the virtual access functions
+	m_type = UNKNOWN;
+	h4_volt = NULL;
+	h4_curr = NULL;
+	m_Reference = NULL;
+	m_ValidationInterval = 100;
+	m_MaxEnergyDeviation = 0;
+	m_MaxVoltDeviation = 0;
+	m_MaxCurrDeviation = 0;
+}
+
+Engine_Multithread_Half::~Engine_Multithread_Half()
+{
+	Reset();
+}
+
+void Engine_Multithread_Half::Init()
+{
+	// create the reference engine first, extensions storing their engine (e.g. steady state) will refer to this engine
+	if (Op->GetHalfPrecisionValidation())
+	{
+		cout << "Engine_Multithread_Half::Init: Validating the reduced field storage against a single precision engine..." << endl;
+		m_Reference = Engine_SSE_Compressed::New(Op);
+	}
+
+	Engine_Multithread::Init();
+}
+
+void Engine_Multithread_Half::InitFields()
+{
+	// only the 16 bit fields are allocated, the single precision arrays of the sse engine are not used
+	// with NUMA placement they are zeroed by the pinned threads, see PlaceThreadNUMA()
+	unsigned int lines[3] = {numLines[0], numLines[1], numVectors};
+	h4_volt = Create_N_3DArray<h4vector>(lines, !m_NUMA);
+	h4_curr = Create_N_3DArray<h4vector>(lines, !m_NUMA);
+}
+
+void Engine_Multithread_Half::Reset()
+{
+	if (m_Reference)
+	{
+		cout << "Engine_Multithread_Half: validation summary: max energy deviation: " << m_MaxEnergyDeviation;
+		cout << ", max voltage deviation: " << m_MaxVoltDeviation << ", max current deviation: " << m_MaxCurrDeviation << endl;
+		delete m_Reference;
+		m_Reference = NULL;
+	}
+
+	// stop the worker threads before the fields are deleted
+	Engine_Multithread::Reset();
+
+	unsigned int lines[3] = {numLines[0], numLines[1], numVectors};
+	Delete_N_3DArray(h4_volt,lines);
+	h4_volt = NULL;
+	Delete_N_3DArray(h4_curr,lines);
+	h4_curr = NULL;
+	m_LineBuffer.reset();
+}
+
+f4vector* Engine_Multithread_Half::GetLineBuffer()
+{
+	f4vector* buffer = m_LineBuffer.get();
+	if (buffer==NULL)
+	{
+		buffer = Create1DArray_v4sf(11*numVectors);
+		m_LineBuffer.reset(buffer);
+	}
+	return buffer;
+}
+
+bool Engine_Multithread_Half::IterateTS(unsigned int iterTS)
+{
+	if (m_Reference==NULL)
+		return Engine_Multithread::IterateTS(iterTS);
+
+	// advance both engines up to the next validation timestep
+	while (iterTS>0)
+	{
+		unsigned int steps = min(iterTS, m_ValidationInterval - numTS%m_ValidationInterval);
+		Engine_Multithread::IterateTS(steps);
+		m_Reference->IterateTS(steps);
+		if (numTS%m_ValidationInterval==0)
+			Validate();
+		iterTS -= steps;
+	}
+	return true;
+}
+
+bool Engine_Multithread_Half::WriteState(ostream &file)
+{
+	if (Engine_Multithread::WriteState(file)==false)
+		return false;
+	// the validation reference engine is part of the state, the deviations are continued after a restart
+	char hasReference = (m_Reference!=NULL);
+	file.write(&hasReference, 1);
+	if (m_Reference)
+		return m_Reference->WriteState(file);
+	return file.good();
+}
+
+bool Engine_Multithread_Half::ReadState(istream &file)
+{
+	if (Engine_Multithread::ReadState(file)==false)
+		return false;
+	char hasReference = 0;
+	file.read(&hasReference, 1);
+	if (hasReference!=(m_Reference!=NULL))
+	{
+		cerr << "Engine_Multithread_Half::ReadState: Error, the half precision validation setting does not match" << endl;
+		return false;
+	}
+	if (m_Reference)
+		return m_Reference->ReadState(file);
+	return file.good();
+}
+
+void Engine_Multithread_Half::WriteFields(ostream &file) const
+{
+	unsigned int lines[3] = {numLines[0], numLines[1], numVectors};
+	Write_N_3DArray(file, h4_volt, lines);
+	Write_N_3DArray(file, h4_curr, lines);
+}
+
+void Engine_Multithread_Half::ReadFields(istream &file)
+{
+	unsigned int lines[3] = {numLines[0], numLines[1], numVectors};
+	Read_N_3DArray(file, h4_volt, lines);
+	Read_N_3DArray(file, h4_curr, lines);
+}
+
+void Engine_Multithread_Half::PlaceThreadNUMA(unsigned int threadID, unsigned int start, unsigned int stop)
+{
+	Engine_Multithread::PlaceThreadNUMA(threadID, start, stop);
+	unsigned int lines[3] = {numLines[0], numLines[1], numVectors};
+	for (int n=0; n<3; ++n)
+	{
+		Zero3DArray<h4vector>(h4_volt[n], lines, start, stop-start+1);
+		Zero3DArray<h4vector>(h4_curr[n], lines, start, stop-start+1);
+	}
+}
+
+void Engine_Multithread_Half::Validate()
+{
+	double energy[2] = {0,0};
+	double ref_energy[2] = {0,0};
+	double max_ref[2] = {0,0};
+	double max_dev[2] = {0,0};
+	f4vector* line = GetLineBuffer();
+	unsigned int pos[3];
+	for (int n=0; n<3; ++n)
+	{
+		for (pos[0]=0; pos[0]<numLines[0]; ++pos[0])
+		{
+			for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
+			{
+				for (int type=0; type<2; ++type)
+				{
+					h4vector* field = (type==0) ? h4_volt[n][pos[0]][pos[1]] : h4_curr[n][pos[0]][pos[1]];
+					f4vector* ref = (type==0) ? m_Reference->f4_volt[n][pos[0]][pos[1]] : m_Reference->f4_curr[n][pos[0]][pos[1]];
+					DecodeLine(field, line);
+					for (pos[2]=0; pos[2]<numVectors; ++pos[2])
+						for (int k=0; k<4; ++k)
+						{
+							energy[type] += line[pos[2]].f[k]*line[pos[2]].f[k];
+							ref_energy[type] += ref[pos[2]].f[k]*ref[pos[2]].f[k];
+							max_ref[type] = max(max_ref[type], (double)fabs(ref[pos[2]].f[k]));
+							max_dev[type] = max(max_dev[type], (double)fabs(line[pos[2]].f[k]-ref[pos[2]].f[k]));
+						}
+				}
+			}
+		}
+	}
+
+	double E = __EPS0__*energy[0] + __MUE0__*energy[1];
+	double E_ref = __EPS0__*ref_energy[0] + __MUE0__*ref_energy[1];
+	double energy_dev = (E_ref>0) ? fabs(E-E_ref)/E_ref : 0;
+	double volt_dev = (max_ref[0]>0) ? max_dev[0]/max_ref[0] : 0;
+	double curr_dev = (max_ref[1]>0) ? max_dev[1]/max_ref[1] : 0;
+	m_MaxEnergyDeviation = max(m_MaxEnergyDeviation, energy_dev);
+	m_MaxVoltDeviation = max(m_MaxVoltDeviation, volt_dev);
+	m_MaxCurrDeviation = max(m_MaxCurrDeviation, curr_dev);
+
+	if (g_settings.GetVerboseLevel()>0)
+		cout << "Engine_Multithread_Half::Validate: timestep " << numTS << ": energy deviation: " << energy_dev << ", voltage deviation: " << volt_dev << ", current deviation: " << curr_dev << endl;
+}
+
+template <class FORMAT>
+void Engine_Multithread_Half_Format<FORMAT>::DecodeLine(const h4vector* in, f4vector* out) const
+{
+	for (unsigned int z=0; z<numVectors; ++z)
+		FORMAT::Decode(in[z], out[z]);
+}
+
+template <class FORMAT>
+inline void Engine_Multithread_Half_Format<FORMAT>::EncodeLine(const f4vector* in, h4vector* out) const
+{
+	for (unsigned int z=0; z<numVectors; ++z)
+		FORMAT::Encode(in[z], out[z]);
+}
+
+template <class FORMAT>
+void Engine_Multithread_Half_Format<FORMAT>::UpdateVoltages(unsigned int startX, unsigned int numX)
+{
+	f4vector* buffer = GetLineBuffer();
+	f4vector* volt_l[3];	// voltages at (x,y)
+	f4vector* curr_l[3];	// currents at (x,y)
+	f4vector* curr_y[3];	// currents at (x,y-1), the currents of the previous line
+	f4vector* curr_x[3];	// currents at (x-1,y), only y- and z-component
+	for (int n=0; n<3; ++n)
+	{
+		volt_l[n] = &buffer[n*numVectors];
+		curr_l[n] = &buffer[(3+n)*numVectors];
+		curr_y[n] = &buffer[(6+n)*numVectors];
+	}
+	curr_x[0] = NULL;
+	curr_x[1] = &buffer[9*numVectors];
+	curr_x[2] = &buffer[10*numVectors];
+
+	const f4vector* cy[3];
+	const f4vector* cx[3];
+	f4vector temp;
+	unsigned int index;
+	unsigned int pos[3];
+	pos[0] = startX;
+	for (unsigned int posX=0; posX<numX; ++posX)
+	{
+		for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
+		{
+			if (pos[1]>0)
+				for (int n=0; n<3; ++n)
+					swap(curr_l[n], curr_y[n]);
+			for (int n=0; n<3; ++n)
+			{
+				Engine_Multithread_Half_Format::DecodeLine(h4_volt[n][pos[0]][pos[1]], volt_l[n]);
+				Engine_Multithread_Half_Format::DecodeLine(h4_curr[n][pos[0]][pos[1]], curr_l[n]);
+				cy[n] = (pos[1]>0) ? curr_y[n] : curr_l[n];
+				cx[n] = curr_l[n];
+			}
+			if (pos[0]>0)
+			{
+				for (int n=1; n<3; ++n)
+				{
+					Engine_Multithread_Half_Format::DecodeLine(h4_curr[n][pos[0]-1][pos[1]], curr_x[n]);
+					cx[n] = curr_x[n];
+				}
+			}
+
+			// the operator index line at (x,y) by base pointer and stride
+			const unsigned int* op_index = Get3DArrayData(Op->m_Op_index) + ((size_t)pos[0]*numLines[1]+pos[1])*numLines[2];
+			for (pos[2]=1; pos[2]<numVectors; ++pos[2])
+			{
+				index = op_index[pos[2]];
+				// x-polarization
+				volt_l[0][pos[2]].v *= Op->f4_vv_Compressed[0][index].v;
+				volt_l[0][pos[2]].v += Op->f4_vi_Compressed[0][index].v * ( curr_l[2][pos[2]].v - cy[2][pos[2]].v - curr_l[1][pos[2]].v + curr_l[1][pos[2]-1].v );
+
+				// y-polarization
+				volt_l[1][pos[2]].v *= Op->f4_vv_Compressed[1][index].v;
+				volt_l[1][pos[2]].v += Op->f4_vi_Compressed[1][index].v * ( curr_l[0][pos[2]].v - curr_l[0][pos[2]-1].v - curr_l[2][pos[2]].v + cx[2][pos[2]].v );
+
+				// z-polarization
+				volt_l[2][pos[2]].v *= Op->f4_vv_Compressed[2][index].v;
+				volt_l[2][pos[2]].v += Op->f4_vi_Compressed[2][index].v * ( curr_l[1][pos[2]].v - cx[1][pos[2]].v - curr_l[0][pos[2]].v + cy[0][pos[2]].v );
+			}
+
+			// for pos[2] = 0
+			index = op_index[0];
+			// x-polarization
+			ShiftUp(curr_l[1][numVectors-1], temp);
+			volt_l[0][0].v *= Op->f4_vv_Compressed[0][index].v;
+			volt_l[0][0].v += Op->f4_vi_Compressed[0][index].v * ( curr_l[2][0].v - cy[2][0].v - curr_l[1][0].v + temp.v );
+
+			// y-polarization
+			ShiftUp(curr_l[0][numVectors-1], temp);
+			volt_l[1][0].v *= Op->f4_vv_Compressed[1][index].v;
+			volt_l[1][0].v += Op->f4_vi_Compressed[1][index].v * ( curr_l[0][0].v - temp.v - curr_l[2][0].v + cx[2][0].v );
+
+			// z-polarization
+			volt_l[2][0].v *= Op->f4_vv_Compressed[2][index].v;
+			volt_l[2][0].v += Op->f4_vi_Compressed[2][index].v * ( curr_l[1][0].v - cx[1][0].v - curr_l[0][0].v + cy[0][0].v );
+
+			for (int n=0; n<3; ++n)
+				EncodeLine(volt_l[n], h4_volt[n][pos[0]][pos[1]]);
+		}
+		++pos[0];
+	}
+}
+
+template <class FORMAT>
+void Engine_Multithread_Half_Format<FORMAT>::UpdateCurrents(unsigned int startX, unsigned int numX)
+{
+	f4vector* buffer = GetLineBuffer();
+	f4vector* curr_l[3];	// currents at (x,y)
+	f4vector* volt_l[3];	// voltages at (x,y)
+	f4vector* volt_y[3];	// voltages at (x,y+1), the voltages of the next line
+	f4vector* volt_x[3];	// voltages at (x+1,y), only y- and z-component
+	for (int n=0; n<3; ++n)
+	{
+		curr_l[n] = &buffer[n*numVectors];
+		volt_l[n] = &buffer[(3+n)*numVectors];
+		volt_y[n] = &buffer[(6+n)*numVectors];
+	}
+	volt_x[0] = NULL;
+	volt_x[1] = &buffer[9*numVectors];
+	volt_x[2] = &buffer[10*numVectors];
+
+	f4vector temp;
+	unsigned int index;
+	unsigned int pos[3];
+	pos[0] = startX;
+	for (unsigned int posX=0; posX<numX; ++posX)
+	{
+		for (int n=0; n<3; ++n)
+			Engine_Multithread_Half_Format::DecodeLine(h4_volt[n][pos[0]][0], volt_y[n]);
+		for (pos[1]=0; pos[1]<numLines[1]-1; ++pos[1])
+		{
+			// the voltages of the last next line are the voltages of this line
+			for (int n=0; n<3; ++n)
+			{
+				swap(volt_l[n], volt_y[n]);
+				Engine_Multithread_Half_Format::DecodeLine(h4_volt[n][pos[0]][pos[1]+1], volt_y[n]);
+				Engine_Multithread_Half_Format::DecodeLine(h4_curr[n][pos[0]][pos[1]], curr_l[n]);
+			}
+			for (int n=1; n<3; ++n)
+				Engine_Multithread_Half_Format::DecodeLine(h4_volt[n][pos[0]+1][pos[1]], volt_x[n]);
+
+			// the operator index line at (x,y) by base pointer and stride
+			const unsigned int* op_index = Get3DArrayData(Op->m_Op_index) + ((size_t)pos[0]*numLines[1]+pos[1])*numLines[2];
+			for (pos[2]=0; pos[2]<numVectors-1; ++pos[2])
+			{
+				index = op_index[pos[2]];
+				// x-pol
+				curr_l[0][pos[2]].v *= Op->f4_ii_Compressed[0][index].v;
+				curr_l[0][pos[2]].v += Op->f4_iv_Compressed[0][index].v * ( volt_l[2][pos[2]].v - volt_y[2][pos[2]].v - volt_l[1][pos[2]].v + volt_l[1][pos[2]+1].v );
+
+				// y-pol
+				curr_l[1][pos[2]].v *= Op->f4_ii_Compressed[1][index].v;
+				curr_l[1][pos[2]].v += Op->f4_iv_Compressed[1][index].v * ( volt_l[0][pos[2]].v - volt_l[0][pos[2]+1].v - volt_l[2][pos[2]].v + volt_x[2][pos[2]].v );
+
+				// z-pol
+				curr_l[2][pos[2]].v *= Op->f4_ii_Compressed[2][index].v;
+				curr_l[2][pos[2]].v += Op->f4_iv_Compressed[2][index].v * ( volt_l[1][pos[2]].v - volt_x[1][pos[2]].v - volt_l[0][pos[2]].v + volt_y[0][pos[2]].v );
+			}
+
+			// for pos[2] = numVectors-1
+			index = op_index[numVectors-1];
+			// x-pol
+			ShiftDown(volt_l[1][0], temp);
+			curr_l[0][numVectors-1].v *= Op->f4_ii_Compressed[0][index].v;
+			curr_l[0][numVectors-1].v += Op->f4_iv_Compressed[0][index].v * ( volt_l[2][numVectors-1].v - volt_y[2][numVectors-1].v - volt_l[1][numVectors-1].v + temp.v );
+
+			// y-pol
+			ShiftDown(volt_l[0][0], temp);
+			curr_l[1][numVectors-1].v *= Op->f4_ii_Compressed[1][index].v;
+			curr_l[1][numVectors-1].v += Op->f4_iv_Compressed[1][index].v * ( volt_l[0][numVectors-1].v - temp.v - volt_l[2][numVectors-1].v + volt_x[2][numVectors-1].v );
+
+			// z-pol
+			curr_l[2][numVectors-1].v *= Op->f4_ii_Compressed[2][index].v;
+			curr_l[2][numVectors-1].v += Op->f4_iv_Compressed[2][index].v * ( volt_l[1][numVectors-1].v - volt_x[1][numVectors-1].v - volt_l[0][numVectors-1].v + volt_y[0][numVectors-1].v );
+
+			for (int n=0; n<3; ++n)
+				EncodeLine(curr_l[n], h4_curr[n][pos[0]][pos[1]]);
+		}
+		++pos[0];
+	}
+}
+
+template class Engine_Multithread_Half_Format<Half_FP16>;
+template class Engine_Multithread_Half_Format<Half_BF16>;
@@ -0,0 +1,143 @@
+/*
+*	Copyright (C) 2026 openEMS contributors
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ENGINE_MULTITHREAD_HALF_H
+#define ENGINE_MULTITHREAD_HALF_H
+
+#include <stdint.h>
+#include "engine_multithread.h"
+
+//! Four 16 bit floats, stored in the same interleaved z-layout as a f4vector
+union h4vector
+{
+	unsigned short h[4];
+	uint64_t u;
+};
+
+//! Convert a single float to an IEEE half float (round to nearest even)
+unsigned short FloatToHalf(float value);
+//! Convert a single IEEE half float to a float
+float HalfToFloat(unsigned short value);
+//! Convert a single float to a bfloat16 (round to nearest even)
+inline unsigned short FloatToBFloat16(float value) {union {float f; uint32_t u;} c; c.f=value; return (c.u + 0x7FFF + ((c.u>>16)&1))>>16;}
+//! Convert a single bfloat16 to a float
+inline float BFloat16ToFloat(unsigned short value) {union {float f; uint32_t u;} c; c.u=((uint32_t)value)<<16; return c.f;}
+
+//! IEEE half float storage format
+struct Half_FP16
+{
+	static inline FDTD_FLOAT ToFloat(unsigned short value) {return HalfToFloat(value);}
+	static inline unsigned short FromFloat(FDTD_FLOAT value) {return FloatToHalf(value);}
+	//! Decode/encode four values at once, only available in engine_multithread_half.cpp
+	static inline void Decode(const h4vector &in, f4vector &out);
+	static inline void Encode(const f4vector &in, h4vector &out);
+};
+
+//! bfloat16 storage format, the upper half of a float
+struct Half_BF16
+{
+	static inline FDTD_FLOAT ToFloat(unsigned short value) {return BFloat16ToFloat(value);}
+	static inline unsigned short FromFloat(FDTD_FLOAT value) {return FloatToBFloat16(value);}
+	//! Decode/encode four values at once, only available in engine_multithread_half.cpp
+	static inline void Decode(const h4vector &in, f4vector &out);
+	static inline void Encode(const f4vector &in, h4vector &out);
+};
+
+/*!
+  Multithreaded FDTD engine storing the voltages and currents as 16 bit floats (IEEE half or bfloat16).
+  All updates are computed in single precision, only the field storage is reduced, halving the memory traffic of the multithreaded engine.
+  The operator coefficients are kept in single precision, the single precision field arrays are not allocated.
+  Optionally a single precision reference engine is run alongside to validate the result of the reduced storage.
+  The field access and update functions are implemented by Engine_Multithread_Half_Format for each storage format.
+  */
+class Engine_Multithread_Half : public Engine_Multithread
+{
+public:
+	static Engine_Multithread_Half* New(const Operator_Multithread* op, unsigned int numThreads = 0);
+	virtual ~Engine_Multithread_Half();
+
+	virtual void Init();
+	virtual void Reset();
+
+	virtual bool IterateTS(unsigned int iterTS);
+
+	virtual bool WriteState(std::ostream &file);
+	virtual bool ReadState(std::istream &file);
+
+	//! No direct access to the 16 bit fields
+	inline virtual const FDTD_FLOAT* GetVoltPtr( unsigned int, const unsigned int* )	const { return NULL; }
+	inline virtual const FDTD_FLOAT* GetCurrPtr( unsigned int, const unsigned int* )	const { return NULL; }
+
+protected:
+	Engine_Multithread_Half(const Operator_Multithread* op);
+
+	virtual void InitFields();
+
+	virtual void WriteFields(std::ostream &file) const;
+	virtual void ReadFields(std::istream &file);
+
+	//! Zero the 16 bit fields of the x-slab of the calling worker thread as well (first touch)
+	virtual void PlaceThreadNUMA(unsigned int threadID, unsigned int start, unsigned int stop);
+
+	//! Decode a single z-line of a 16 bit field into a float buffer
+	virtual void DecodeLine(const h4vector* in, f4vector* out) const = 0;
+
+	h4vector**** h4_volt;
+	h4vector**** h4_curr;
+
+	//! Scratch buffer of the calling thread holding the decoded z-lines needed for a single line update
+	f4vector* GetLineBuffer();
+	boost::thread_specific_ptr<f4vector> m_LineBuffer;
+
+	//! Single precision reference engine for validation, NULL if disabled
+	Engine_SSE_Compressed* m_Reference;
+	unsigned int m_ValidationInterval;
+	double m_MaxEnergyDeviation;
+	double m_MaxVoltDeviation;
+	double m_MaxCurrDeviation;
+	//! Compare the fields and energy with the reference engine
+	void Validate();
+};
+
+//! Half precision engine for the storage FORMAT Half_FP16 or Half_BF16, see Engine_Multithread_Half
+template <class FORMAT>
+class Engine_Multithread_Half_Format : public Engine_Multithread_Half
+{
+	friend class Engine_Multithread_Half;
+public:
+	inline virtual FDTD_FLOAT GetVolt( unsigned int n, unsigned int x, unsigned int y, unsigned int z )	const { return FORMAT::ToFloat(h4_volt[n][x][y][z%numVectors].h[z/numVectors]); }
+	inline virtual FDTD_FLOAT GetVolt( unsigned int n, const unsigned int pos[3] )						const { return FORMAT::ToFloat(h4_volt[n][pos[0]][pos[1]][pos[2]%numVectors].h[pos[2]/numVectors]); }
+	inline virtual FDTD_FLOAT GetCurr( unsigned int n, unsigned int x, unsigned int y, unsigned int z )	const { return FORMAT::ToFloat(h4_curr[n][x][y][z%numVectors].h[z/numVectors]); }
+	inline virtual FDTD_FLOAT GetCurr( unsigned int n, const unsigned int pos[3] )						const { return FORMAT::ToFloat(h4_curr[n][pos[0]][pos[1]][pos[2]%numVectors].h[pos[2]/numVectors]); }
+
+	inline virtual void SetVolt( unsigned int n, unsigned int x, unsigned int y, unsigned int z, FDTD_FLOAT value)	{ h4_volt[n][x][y][z%numVectors].h[z/numVectors]=FORMAT::FromFloat(value); }
+	inline virtual void SetVolt( unsigned int n, const unsigned int pos[3], FDTD_FLOAT value )						{ h4_volt[n][pos[0]][pos[1]][pos[2]%numVectors].h[pos[2]/numVectors]=FORMAT::FromFloat(value); }
+	inline virtual void SetCurr( unsigned int n, unsigned int x, unsigned int y, unsigned int z, FDTD_FLOAT value)	{ h4_curr[n][x][y][z%numVectors].h[z/numVectors]=FORMAT::FromFloat(value); }
+	inline virtual void SetCurr( unsigned int n, const unsigned int pos[3], FDTD_FLOAT value )						{ h4_curr[n][pos[0]][pos[1]][pos[2]%numVectors].h[pos[2]/numVectors]=FORMAT::FromFloat(value); }
+
+protected:
+	Engine_Multithread_Half_Format(const Operator_Multithread* op) : Engine_Multithread_Half(op) {}
+
+	virtual void UpdateVoltages(unsigned int startX, unsigned int numX);
+	virtual void UpdateCurrents(unsigned int startX, unsigned int numX);
+
+	virtual void DecodeLine(const h4vector* in, f4vector* out) const;
+	//! Encode a single float z-line into a 16 bit field
+	inline void EncodeLine(const f4vector* in, h4vector* out) const;
+};
+
+#endif // ENGINE_MULTITHREAD_HALF_H
@@ -38,6 +38,7 @@ Engine_sse::Engine_sse(const Operator_sse* op) : Engine(op)
 	f4_volt = 0;
 	f4_curr = 0;
 	numVectors =  ceil((double)numLines[2]/4.0);
+	m_LineStride = Get3DArrayLineStride_v4sf(numLines);
 
 	// speed up the calculation of denormal floating point values (flush-to-zero)
 #ifndef SSE_CORRECT_DENORMALS
@@ -53,15 +54,9 @@ Engine_sse::~Engine_sse()
 	Reset();
 }
 
-void Engine_sse::Init()
+void Engine_sse::InitFields()
 {
-	Engine::Init();
-
-	Delete_N_3DArray(volt,numLines);
-	volt=NULL; // not used
-	Delete_N_3DArray(curr,numLines);
-	curr=NULL; // not used
-
+	// the single float arrays of the basic engine are not used
 	f4_volt = Create_N_3DArray_v4sf(numLines);
 	f4_curr = Create_N_3DArray_v4sf(numLines);
 }
@@ -75,105 +70,141 @@ void Engine_sse::Reset()
 	f4_curr = 0;
 }
 
+void Engine_sse::WriteFields(ostream &file) const
+{
+	Write_N_3DArray_v4sf(file, f4_volt, numLines);
+	Write_N_3DArray_v4sf(file, f4_curr, numLines);
+}
+
+void Engine_sse::ReadFields(istream &file)
+{
+	Read_N_3DArray_v4sf(file, f4_volt, numLines);
+	Read_N_3DArray_v4sf(file, f4_curr, numLines);
+}
+
 void Engine_sse::UpdateVoltages(unsigned int startX, unsigned int numX)
 {
-	unsigned int pos[3];
-	bool shift[2];
+	f4vector* volt[3];
+	const f4vector* curr[3];
+	const f4vector* curr_x[3];
+	const f4vector* curr_y[3];
+	const f4vector* vv[3];
+	const f4vector* vi[3];
 	f4vector temp;
 
-	pos[0] = startX;
-	for (unsigned int posX=0; posX<numX; ++posX)
+	for (unsigned int x=startX; x<startX+numX; ++x)
 	{
-		shift[0]=pos[0];
-		for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
+		for (unsigned int y=0; y<numLines[1]; ++y)
 		{
-			shift[1]=pos[1];
-			for (pos[2]=1; pos[2]<numVectors; ++pos[2])
+			// the z-lines at (x,y), (x-1,y) and (x,y-1), at the lower bounds the line itself is used instead of the missing neighbour
+			for (int n=0; n<3; ++n)
+			{
+				volt[n] = GetLine(f4_volt, n, x, y);
+				curr[n] = GetLine(f4_curr, n, x, y);
+				curr_x[n] = GetLine(f4_curr, n, x-(x>0), y);
+				curr_y[n] = GetLine(f4_curr, n, x, y-(y>0));
+				vv[n] = GetLine(Op->f4_vv, n, x, y);
+				vi[n] = GetLine(Op->f4_vi, n, x, y);
+			}
+			for (unsigned int z=1; z<numVectors; ++z)
 			{
 				// x-polarization
-				f4_volt[0][pos[0]][pos[1]][pos[2]].v *= Op->f4_vv[0][pos[0]][pos[1]][pos[2]].v;
-				f4_volt[0][pos[0]][pos[1]][pos[2]].v += Op->f4_vi[0][pos[0]][pos[1]][pos[2]].v * ( f4_curr[2][pos[0]][pos[1]][pos[2]].v - f4_curr[2][pos[0]][pos[1]-shift[1]][pos[2]].v - f4_curr[1][pos[0]][pos[1]][pos[2]].v + f4_curr[1][pos[0]][pos[1]][pos[2]-1].v );
+				volt[0][z].v *= vv[0][z].v;
+				volt[0][z].v += vi[0][z].v * ( curr[2][z].v - curr_y[2][z].v - curr[1][z].v + curr[1][z-1].v );
 
 				// y-polarization
-				f4_volt[1][pos[0]][pos[1]][pos[2]].v *= Op->f4_vv[1][pos[0]][pos[1]][pos[2]].v;
-				f4_volt[1][pos[0]][pos[1]][pos[2]].v += Op->f4_vi[1][pos[0]][pos[1]][pos[2]].v * ( f4_curr[0][pos[0]][pos[1]][pos[2]].v - f4_curr[0][pos[0]][pos[1]][pos[2]-1].v - f4_curr[2][pos[0]][pos[1]][pos[2]].v + f4_curr[2][pos[0]-shift[0]][pos[1]][pos[2]].v);
+				volt[1][z].v *= vv[1][z].v;
+				volt[1][z].v += vi[1][z].v * ( curr[0][z].v - curr[0][z-1].v - curr[2][z].v + curr_x[2][z].v);
 
 				// z-polarization
-				f4_volt[2][pos[0]][pos[1]][pos[2]].v *= Op->f4_vv[2][pos[0]][pos[1]][pos[2]].v;
-				f4_volt[2][pos[0]][pos[1]][pos[2]].v += Op->f4_vi[2][pos[0]][pos[1]][pos[2]].v * ( f4_curr[1][pos[0]][pos[1]][pos[2]].v - f4_curr[1][pos[0]-shift[0]][pos[1]][pos[2]].v - f4_curr[0][pos[0]][pos[1]][pos[2]].v + f4_curr[0][pos[0]][pos[1]-shift[1]][pos[2]].v);
+				volt[2][z].v *= vv[2][z].v;
+				volt[2][z].v += vi[2][z].v * ( curr[1][z].v - curr_x[1][z].v - curr[0][z].v + curr_y[0][z].v);
 			}
 
-			// for pos[2] = 0
+			// for z = 0
 			// x-polarization
 			temp.f[0] = 0;
-			temp.f[1] = f4_curr[1][pos[0]][pos[1]][numVectors-1].f[0];
-			temp.f[2] = f4_curr[1][pos[0]][pos[1]][numVectors-1].f[1];
-			temp.f[3] = f4_curr[1][pos[0]][pos[1]][numVectors-1].f[2];
-			f4_volt[0][pos[0]][pos[1]][0].v *= Op->f4_vv[0][pos[0]][pos[1]][0].v;
-			f4_volt[0][pos[0]][pos[1]][0].v += Op->f4_vi[0][pos[0]][pos[1]][0].v * ( f4_curr[2][pos[0]][pos[1]][0].v - f4_curr[2][pos[0]][pos[1]-shift[1]][0].v - f4_curr[1][pos[0]][pos[1]][0].v + temp.v );
+			temp.f[1] = curr[1][numVectors-1].f[0];
+			temp.f[2] = curr[1][numVectors-1].f[1];
+			temp.f[3] = curr[1][numVectors-1].f[2];
+			volt[0][0].v *= vv[0][0].v;
+			volt[0][0].v += vi[0][0].v * ( curr[2][0].v - curr_y[2][0].v - curr[1][0].v + temp.v );
 
 			// y-polarization
 			temp.f[0] = 0;
-			temp.f[1] = f4_curr[0][pos[0]][pos[1]][numVectors-1].f[0];
-			temp.f[2] = f4_curr[0][pos[0]][pos[1]][numVectors-1].f[1];
-			temp.f[3] = f4_curr[0][pos[0]][pos[1]][numVectors-1].f[2];
-			f4_volt[1][pos[0]][pos[1]][0].v *= Op->f4_vv[1][pos[0]][pos[1]][0].v;
-			f4_volt[1][pos[0]][pos[1]][0].v += Op->f4_vi[1][pos[0]][pos[1]][0].v * ( f4_curr[0][pos[0]][pos[1]][0].v - temp.v - f4_curr[2][pos[0]][pos[1]][0].v + f4_curr[2][pos[0]-shift[0]][pos[1]][0].v);
+			temp.f[1] = curr[0][numVectors-1].f[0];
+			temp.f[2] = curr[0][numVectors-1].f[1];
+			temp.f[3] = curr[0][numVectors-1].f[2];
+			volt[1][0].v *= vv[1][0].v;
+			volt[1][0].v += vi[1][0].v * ( curr[0][0].v - temp.v - curr[2][0].v + curr_x[2][0].v);
 
 			// z-polarization
-			f4_volt[2][pos[0]][pos[1]][0].v *= Op->f4_vv[2][pos[0]][pos[1]][0].v;
-			f4_volt[2][pos[0]][pos[1]][0].v += Op->f4_vi[2][pos[0]][pos[1]][0].v * ( f4_curr[1][pos[0]][pos[1]][0].v - f4_curr[1][pos[0]-shift[0]][pos[1]][0].v - f4_curr[0][pos[0]][pos[1]][0].v + f4_curr[0][pos[0]][pos[1]-shift[1]][0].v);
+			volt[2][0].v *= vv[2][0].v;
+			volt[2][0].v += vi[2][0].v * ( curr[1][0].v - curr_x[1][0].v - curr[0][0].v + curr_y[0][0].v);
 		}
-		++pos[0];
 	}
 }
 
 void Engine_sse::UpdateCurrents(unsigned int startX, unsigned int numX)
 {
-	unsigned int pos[5];
+	f4vector* curr[3];
+	const f4vector* volt[3];
+	const f4vector* volt_x[3];
+	const f4vector* volt_y[3];
+	const f4vector* ii[3];
+	const f4vector* iv[3];
 	f4vector temp;
 
-	pos[0] = startX;
-	for (unsigned int posX=0; posX<numX; ++posX)
+	for (unsigned int x=startX; x<startX+numX; ++x)
 	{
-		for (pos[1]=0; pos[1]<numLines[1]-1; ++pos[1])
+		for (unsigned int y=0; y<numLines[1]-1; ++y)
 		{
-			for (pos[2]=0; pos[2]<numVectors-1; ++pos[2])
+			// the z-lines at (x,y), (x+1,y) and (x,y+1)
+			for (int n=0; n<3; ++n)
+			{
+				curr[n] = GetLine(f4_curr, n, x, y);
+				volt[n] = GetLine(f4_volt, n, x, y);
+				volt_x[n] = GetLine(f4_volt, n, x+1, y);
+				volt_y[n] = GetLine(f4_volt, n, x, y+1);
+				ii[n] = GetLine(Op->f4_ii, n, x, y);
+				iv[n] = GetLine(Op->f4_iv, n, x, y);
+			}
+			for (unsigned int z=0; z<numVectors-1; ++z)
 			{
 				// x-pol
-				f4_curr[0][pos[0]][pos[1]][pos[2]].v *= Op->f4_ii[0][pos[0]][pos[1]][pos[2]].v;
-				f4_curr[0][pos[0]][pos[1]][pos[2]].v += Op->f4_iv[0][pos[0]][pos[1]][pos[2]].v * ( f4_volt[2][pos[0]][pos[1]][pos[2]].v - f4_volt[2][pos[0]][pos[1]+1][pos[2]].v - f4_volt[1][pos[0]][pos[1]][pos[2]].v + f4_volt[1][pos[0]][pos[1]][pos[2]+1].v);
+				curr[0][z].v *= ii[0][z].v;
+				curr[0][z].v += iv[0][z].v * ( volt[2][z].v - volt_y[2][z].v - volt[1][z].v + volt[1][z+1].v);
 
 				// y-pol
-				f4_curr[1][pos[0]][pos[1]][pos[2]].v *= Op->f4_ii[1][pos[0]][pos[1]][pos[2]].v;
-				f4_curr[1][pos[0]][pos[1]][pos[2]].v += Op->f4_iv[1][pos[0]][pos[1]][pos[2]].v * ( f4_volt[0][pos[0]][pos[1]][pos[2]].v - f4_volt[0][pos[0]][pos[1]][pos[2]+1].v - f4_volt[2][pos[0]][pos[1]][pos[2]].v + f4_volt[2][pos[0]+1][pos[1]][pos[2]].v);
+				curr[1][z].v *= ii[1][z].v;
+				curr[1][z].v += iv[1][z].v * ( volt[0][z].v - volt[0][z+1].v - volt[2][z].v + volt_x[2][z].v);
 
 				// z-pol
-				f4_curr[2][pos[0]][pos[1]][pos[2]].v *= Op->f4_ii[2][pos[0]][pos[1]][pos[2]].v;
-				f4_curr[2][pos[0]][pos[1]][pos[2]].v += Op->f4_iv[2][pos[0]][pos[1]][pos[2]].v * ( f4_volt[1][pos[0]][pos[1]][pos[2]].v - f4_volt[1][pos[0]+1][pos[1]][pos[2]].v - f4_volt[0][pos[0]][pos[1]][pos[2]].v + f4_volt[0][pos[0]][pos[1]+1][pos[2]].v);
+				curr[2][z].v *= ii[2][z].v;
+				curr[2][z].v += iv[2][z].v * ( volt[1][z].v - volt_x[1][z].v - volt[0][z].v + volt_y[0][z].v);
 			}
 
-			// for pos[2] = numVectors-1
+			// for z = numVectors-1
+			const unsigned int z = numVectors-1;
 			// x-pol
-			temp.f[0] = f4_volt[1][pos[0]][pos[1]][0].f[1];
-			temp.f[1] = f4_volt[1][pos[0]][pos[1]][0].f[2];
-			temp.f[2] = f4_volt[1][pos[0]][pos[1]][0].f[3];
+			temp.f[0] = volt[1][0].f[1];
+			temp.f[1] = volt[1][0].f[2];
+			temp.f[2] = volt[1][0].f[3];
 			temp.f[3] = 0;
-			f4_curr[0][pos[0]][pos[1]][numVectors-1].v *= Op->f4_ii[0][pos[0]][pos[1]][numVectors-1].v;
-			f4_curr[0][pos[0]][pos[1]][numVectors-1].v += Op->f4_iv[0][pos[0]][pos[1]][numVectors-1].v * ( f4_volt[2][pos[0]][pos[1]][numVectors-1].v - f4_volt[2][pos[0]][pos[1]+1][numVectors-1].v - f4_volt[1][pos[0]][pos[1]][numVectors-1].v + temp.v);
+			curr[0][z].v *= ii[0][z].v;
+			curr[0][z].v += iv[0][z].v * ( volt[2][z].v - volt_y[2][z].v - volt[1][z].v + temp.v);
 
 			// y-pol
-			temp.f[0] = f4_volt[0][pos[0]][pos[1]][0].f[1];
-			temp.f[1] = f4_volt[0][pos[0]][pos[1]][0].f[2];
-			temp.f[2] = f4_volt[0][pos[0]][pos[1]][0].f[3];
+			temp.f[0] = volt[0][0].f[1];
+			temp.f[1] = volt[0][0].f[2];
+			temp.f[2] = volt[0][0].f[3];
 			temp.f[3] = 0;
-			f4_curr[1][pos[0]][pos[1]][numVectors-1].v *= Op->f4_ii[1][pos[0]][pos[1]][numVectors-1].v;
-			f4_curr[1][pos[0]][pos[1]][numVectors-1].v += Op->f4_iv[1][pos[0]][pos[1]][numVectors-1].v * ( f4_volt[0][pos[0]][pos[1]][numVectors-1].v - temp.v - f4_volt[2][pos[0]][pos[1]][numVectors-1].v + f4_volt[2][pos[0]+1][pos[1]][numVectors-1].v);
+			curr[1][z].v *= ii[1][z].v;
+			curr[1][z].v += iv[1][z].v * ( volt[0][z].v - temp.v - volt[2][z].v + volt_x[2][z].v);
 
 			// z-pol
-			f4_curr[2][pos[0]][pos[1]][numVectors-1].v *= Op->f4_ii[2][pos[0]][pos[1]][numVectors-1].v;
-			f4_curr[2][pos[0]][pos[1]][numVectors-1].v += Op->f4_iv[2][pos[0]][pos[1]][numVectors-1].v * ( f4_volt[1][pos[0]][pos[1]][numVectors-1].v - f4_volt[1][pos[0]+1][pos[1]][numVectors-1].v - f4_volt[0][pos[0]][pos[1]][numVectors-1].v + f4_volt[0][pos[0]][pos[1]+1][numVectors-1].v);
+			curr[2][z].v *= ii[2][z].v;
+			curr[2][z].v += iv[2][z].v * ( volt[1][z].v - volt_x[1][z].v - volt[0][z].v + volt_y[0][z].v);
 		}
-		++pos[0];
 	}
 }
@@ -27,7 +27,6 @@ public:
 	static Engine_sse* New(const Operator_sse* op);
 	virtual ~Engine_sse();
 
-	virtual void Init();
 	virtual void Reset();
 
 	virtual unsigned int GetNumberOfTimesteps() {return numTS;};
@@ -43,14 +42,27 @@ public:
 	inline virtual void SetCurr( unsigned int n, unsigned int x, unsigned int y, unsigned int z, FDTD_FLOAT value)	{ f4_curr[n][x][y][z%numVectors].f[z/numVectors]=value; }
 	inline virtual void SetCurr( unsigned int n, const unsigned int pos[3], FDTD_FLOAT value )						{ f4_curr[n][pos[0]][pos[1]][pos[2]%numVectors].f[pos[2]/numVectors]=value; }
 
+	inline virtual const FDTD_FLOAT* GetVoltPtr( unsigned int n, const unsigned int pos[3] )	const { return &f4_volt[n][pos[0]][pos[1]][pos[2]%numVectors].f[pos[2]/numVectors]; }
+	inline virtual const FDTD_FLOAT* GetCurrPtr( unsigned int n, const unsigned int pos[3] )	const { return &f4_curr[n][pos[0]][pos[1]][pos[2]%numVectors].f[pos[2]/numVectors]; }
+
 protected:
 	Engine_sse(const Operator_sse* op);
 	const Operator_sse* Op;
 
+	virtual void InitFields();
+
 	virtual void UpdateVoltages(unsigned int startX, unsigned int numX);
 	virtual void UpdateCurrents(unsigned int startX, unsigned int numX);
 
+	virtual void WriteFields(std::ostream &file) const;
+	virtual void ReadFields(std::istream &file);
+
 	unsigned int numVectors;
+	//! distance (in f4vectors) of two consecutive z-lines in the contiguous field blocks, see Get3DArrayLineStride_v4sf()
+	unsigned int m_LineStride;
+
+	//! Get the z-line (x,y) of the field component n by base pointer and stride
+	inline f4vector* GetLine(f4vector**** field, int n, unsigned int x, unsigned int y) const {return Get3DArrayData_v4sf(field[n]) + ((size_t)x*numLines[1]+y)*m_LineStride;}
 
 public: //public access to the sse arrays for efficient extensions access... use careful...
 	f4vector**** f4_volt;
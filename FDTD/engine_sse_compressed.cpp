@@ -22,7 +22,12 @@
 
 Engine_SSE_Compressed* Engine_SSE_Compressed::New(const Operator_SSE_Compressed* op)
 {
-	cout << "Create FDTD engine (compressed SSE)" << endl;
+	cout << "Create FDTD engine (compressed SSE";
+	if (op->GetVectorWidth()==8)
+		cout << " + AVX";
+	else if (op->GetVectorWidth()==16)
+		cout << " + AVX-512";
+	cout << ")" << endl;
 	Engine_SSE_Compressed* e = new Engine_SSE_Compressed(op);
 	e->Init();
 	return e;
@@ -39,125 +44,347 @@ Engine_SSE_Compressed::~Engine_SSE_Compressed()
 
 void Engine_SSE_Compressed::UpdateVoltages(unsigned int startX, unsigned int numX)
 {
-	unsigned int pos[3];
-	bool shift[2];
-	f4vector temp;
-
+#ifdef ENABLE_WIDE_VECTORS
+	if (Op->GetVectorWidth()==16)
+		return UpdateVoltages_AVX512(startX, numX);
+	if (Op->GetVectorWidth()==8)
+		return UpdateVoltages_AVX(startX, numX);
+#endif
+	unsigned int pos[2];
 	pos[0] = startX;
-	unsigned int index=0;
 	for (unsigned int posX=0; posX<numX; ++posX)
 	{
-		shift[0]=pos[0];
 		for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
-		{
-			shift[1]=pos[1];
-			for (pos[2]=1; pos[2]<numVectors; ++pos[2])
-			{
-				index = Op->m_Op_index[pos[0]][pos[1]][pos[2]];
-				// x-polarization
-				f4_volt[0][pos[0]][pos[1]][pos[2]].v *= Op->f4_vv_Compressed[0][index].v;
-				f4_volt[0][pos[0]][pos[1]][pos[2]].v += Op->f4_vi_Compressed[0][index].v * ( f4_curr[2][pos[0]][pos[1]][pos[2]].v - f4_curr[2][pos[0]][pos[1]-shift[1]][pos[2]].v - f4_curr[1][pos[0]][pos[1]][pos[2]].v + f4_curr[1][pos[0]][pos[1]][pos[2]-1].v );
+			UpdateVoltagesLine(pos[0], pos[1], 0, numVectors);
+		++pos[0];
+	}
+}
 
-				// y-polarization
-				f4_volt[1][pos[0]][pos[1]][pos[2]].v *= Op->f4_vv_Compressed[1][index].v;
-				f4_volt[1][pos[0]][pos[1]][pos[2]].v += Op->f4_vi_Compressed[1][index].v * ( f4_curr[0][pos[0]][pos[1]][pos[2]].v - f4_curr[0][pos[0]][pos[1]][pos[2]-1].v - f4_curr[2][pos[0]][pos[1]][pos[2]].v + f4_curr[2][pos[0]-shift[0]][pos[1]][pos[2]].v);
+void Engine_SSE_Compressed::UpdateVoltagesBlock(unsigned int startX, unsigned int stopX, unsigned int startY, unsigned int stopY, unsigned int startZ, unsigned int stopZ)
+{
+	if ((startZ>=stopZ) || (stopZ>numVectors))
+		return;
+	for (unsigned int x=startX; x<stopX; ++x)
+		for (unsigned int y=startY; y<stopY; ++y)
+			UpdateVoltagesLine(x, y, startZ, stopZ);
+}
 
-				// z-polarization
-				f4_volt[2][pos[0]][pos[1]][pos[2]].v *= Op->f4_vv_Compressed[2][index].v;
-				f4_volt[2][pos[0]][pos[1]][pos[2]].v += Op->f4_vi_Compressed[2][index].v * ( f4_curr[1][pos[0]][pos[1]][pos[2]].v - f4_curr[1][pos[0]-shift[0]][pos[1]][pos[2]].v - f4_curr[0][pos[0]][pos[1]][pos[2]].v + f4_curr[0][pos[0]][pos[1]-shift[1]][pos[2]].v);
-			}
+inline void Engine_SSE_Compressed::UpdateVoltagesLine(unsigned int x, unsigned int y, unsigned int startZ, unsigned int stopZ)
+{
+	// the z-lines at (x,y), (x-1,y) and (x,y-1), at the lower bounds the line itself is used instead of the missing neighbour
+	f4vector* volt[3];
+	const f4vector* curr[3];
+	const f4vector* curr_x[3];
+	const f4vector* curr_y[3];
+	const f4vector* vv[3];
+	const f4vector* vi[3];
+	for (int n=0; n<3; ++n)
+	{
+		volt[n] = GetLine(f4_volt, n, x, y);
+		curr[n] = GetLine(f4_curr, n, x, y);
+		curr_x[n] = GetLine(f4_curr, n, x-(x>0), y);
+		curr_y[n] = GetLine(f4_curr, n, x, y-(y>0));
+		vv[n] = &Op->f4_vv_Compressed[n][0];
+		vi[n] = &Op->f4_vi_Compressed[n][0];
+	}
+	const unsigned int* index = Get3DArrayData(Op->m_Op_index) + ((size_t)x*numLines[1]+y)*numLines[2];
+	f4vector temp;
+
+	unsigned int i;
+	for (unsigned int z=(startZ>0?startZ:1); z<stopZ; ++z)
+	{
+		i = index[z];
+		// x-polarization
+		volt[0][z].v *= vv[0][i].v;
+		volt[0][z].v += vi[0][i].v * ( curr[2][z].v - curr_y[2][z].v - curr[1][z].v + curr[1][z-1].v );
+
+		// y-polarization
+		volt[1][z].v *= vv[1][i].v;
+		volt[1][z].v += vi[1][i].v * ( curr[0][z].v - curr[0][z-1].v - curr[2][z].v + curr_x[2][z].v);
 
-			// for pos[2] = 0
-			// x-polarization
-			index = Op->m_Op_index[pos[0]][pos[1]][0];
+		// z-polarization
+		volt[2][z].v *= vv[2][i].v;
+		volt[2][z].v += vi[2][i].v * ( curr[1][z].v - curr_x[1][z].v - curr[0][z].v + curr_y[0][z].v);
+	}
+
+	if (startZ>0)
+		return;
+
+	// for z = 0
+	// x-polarization
+	i = index[0];
 #ifdef __SSE2__
-			temp.v = (__m128)_mm_slli_si128( (__m128i)f4_curr[1][pos[0]][pos[1]][numVectors-1].v, 4 );
+	temp.v = (__m128)_mm_slli_si128( (__m128i)curr[1][numVectors-1].v, 4 );
 #else
-			temp.f[0] = 0;
-			temp.f[1] = f4_curr[1][pos[0]][pos[1]][numVectors-1].f[0];
-			temp.f[2] = f4_curr[1][pos[0]][pos[1]][numVectors-1].f[1];
-			temp.f[3] = f4_curr[1][pos[0]][pos[1]][numVectors-1].f[2];
+	temp.f[0] = 0;
+	temp.f[1] = curr[1][numVectors-1].f[0];
+	temp.f[2] = curr[1][numVectors-1].f[1];
+	temp.f[3] = curr[1][numVectors-1].f[2];
 #endif
-			f4_volt[0][pos[0]][pos[1]][0].v *= Op->f4_vv_Compressed[0][index].v;
-			f4_volt[0][pos[0]][pos[1]][0].v += Op->f4_vi_Compressed[0][index].v * ( f4_curr[2][pos[0]][pos[1]][0].v - f4_curr[2][pos[0]][pos[1]-shift[1]][0].v - f4_curr[1][pos[0]][pos[1]][0].v + temp.v );
+	volt[0][0].v *= vv[0][i].v;
+	volt[0][0].v += vi[0][i].v * ( curr[2][0].v - curr_y[2][0].v - curr[1][0].v + temp.v );
 
-			// y-polarization
+	// y-polarization
 #ifdef __SSE2__
-			temp.v = (__m128)_mm_slli_si128( (__m128i)f4_curr[0][pos[0]][pos[1]][numVectors-1].v, 4 );
+	temp.v = (__m128)_mm_slli_si128( (__m128i)curr[0][numVectors-1].v, 4 );
 #else
-			temp.f[0] = 0;
-			temp.f[1] = f4_curr[0][pos[0]][pos[1]][numVectors-1].f[0];
-			temp.f[2] = f4_curr[0][pos[0]][pos[1]][numVectors-1].f[1];
-			temp.f[3] = f4_curr[0][pos[0]][pos[1]][numVectors-1].f[2];
+	temp.f[0] = 0;
+	temp.f[1] = curr[0][numVectors-1].f[0];
+	temp.f[2] = curr[0][numVectors-1].f[1];
+	temp.f[3] = curr[0][numVectors-1].f[2];
 #endif
-			f4_volt[1][pos[0]][pos[1]][0].v *= Op->f4_vv_Compressed[1][index].v;
-			f4_volt[1][pos[0]][pos[1]][0].v += Op->f4_vi_Compressed[1][index].v * ( f4_curr[0][pos[0]][pos[1]][0].v - temp.v - f4_curr[2][pos[0]][pos[1]][0].v + f4_curr[2][pos[0]-shift[0]][pos[1]][0].v);
+	volt[1][0].v *= vv[1][i].v;
+	volt[1][0].v += vi[1][i].v * ( curr[0][0].v - temp.v - curr[2][0].v + curr_x[2][0].v);
 
-			// z-polarization
-			f4_volt[2][pos[0]][pos[1]][0].v *= Op->f4_vv_Compressed[2][index].v;
-			f4_volt[2][pos[0]][pos[1]][0].v += Op->f4_vi_Compressed[2][index].v * ( f4_curr[1][pos[0]][pos[1]][0].v - f4_curr[1][pos[0]-shift[0]][pos[1]][0].v - f4_curr[0][pos[0]][pos[1]][0].v + f4_curr[0][pos[0]][pos[1]-shift[1]][0].v);
-		}
-		++pos[0];
-	}
+	// z-polarization
+	volt[2][0].v *= vv[2][i].v;
+	volt[2][0].v += vi[2][i].v * ( curr[1][0].v - curr_x[1][0].v - curr[0][0].v + curr_y[0][0].v);
 }
 
 void Engine_SSE_Compressed::UpdateCurrents(unsigned int startX, unsigned int numX)
 {
-	unsigned int pos[3];
-	f4vector temp;
-
+#ifdef ENABLE_WIDE_VECTORS
+	if (Op->GetVectorWidth()==16)
+		return UpdateCurrents_AVX512(startX, numX);
+	if (Op->GetVectorWidth()==8)
+		return UpdateCurrents_AVX(startX, numX);
+#endif
+	unsigned int pos[2];
 	pos[0] = startX;
-	unsigned int index;
 	for (unsigned int posX=0; posX<numX; ++posX)
 	{
 		for (pos[1]=0; pos[1]<numLines[1]-1; ++pos[1])
-		{
-			for (pos[2]=0; pos[2]<numVectors-1; ++pos[2])
-			{
-				index = Op->m_Op_index[pos[0]][pos[1]][pos[2]];
-				// x-pol
-				f4_curr[0][pos[0]][pos[1]][pos[2]].v *= Op->f4_ii_Compressed[0][index].v;
-				f4_curr[0][pos[0]][pos[1]][pos[2]].v += Op->f4_iv_Compressed[0][index].v * ( f4_volt[2][pos[0]][pos[1]][pos[2]].v - f4_volt[2][pos[0]][pos[1]+1][pos[2]].v - f4_volt[1][pos[0]][pos[1]][pos[2]].v + f4_volt[1][pos[0]][pos[1]][pos[2]+1].v);
+			UpdateCurrentsLine(pos[0], pos[1], 0, numVectors);
+		++pos[0];
+	}
+}
 
-				// y-pol
-				f4_curr[1][pos[0]][pos[1]][pos[2]].v *= Op->f4_ii_Compressed[1][index].v;
-				f4_curr[1][pos[0]][pos[1]][pos[2]].v += Op->f4_iv_Compressed[1][index].v * ( f4_volt[0][pos[0]][pos[1]][pos[2]].v - f4_volt[0][pos[0]][pos[1]][pos[2]+1].v - f4_volt[2][pos[0]][pos[1]][pos[2]].v + f4_volt[2][pos[0]+1][pos[1]][pos[2]].v);
+void Engine_SSE_Compressed::UpdateCurrentsBlock(unsigned int startX, unsigned int stopX, unsigned int startY, unsigned int stopY, unsigned int startZ, unsigned int stopZ)
+{
+	if ((startZ>=stopZ) || (stopZ>numVectors))
+		return;
+	for (unsigned int x=startX; x<stopX; ++x)
+		for (unsigned int y=startY; y<stopY; ++y)
+			UpdateCurrentsLine(x, y, startZ, stopZ);
+}
 
-				// z-pol
-				f4_curr[2][pos[0]][pos[1]][pos[2]].v *= Op->f4_ii_Compressed[2][index].v;
-				f4_curr[2][pos[0]][pos[1]][pos[2]].v += Op->f4_iv_Compressed[2][index].v * ( f4_volt[1][pos[0]][pos[1]][pos[2]].v - f4_volt[1][pos[0]+1][pos[1]][pos[2]].v - f4_volt[0][pos[0]][pos[1]][pos[2]].v + f4_volt[0][pos[0]][pos[1]+1][pos[2]].v);
-			}
+inline void Engine_SSE_Compressed::UpdateCurrentsLine(unsigned int x, unsigned int y, unsigned int startZ, unsigned int stopZ)
+{
+	// the z-lines at (x,y), (x+1,y) and (x,y+1)
+	f4vector* curr[3];
+	const f4vector* volt[3];
+	const f4vector* volt_x[3];
+	const f4vector* volt_y[3];
+	const f4vector* ii[3];
+	const f4vector* iv[3];
+	for (int n=0; n<3; ++n)
+	{
+		curr[n] = GetLine(f4_curr, n, x, y);
+		volt[n] = GetLine(f4_volt, n, x, y);
+		volt_x[n] = GetLine(f4_volt, n, x+1, y);
+		volt_y[n] = GetLine(f4_volt, n, x, y+1);
+		ii[n] = &Op->f4_ii_Compressed[n][0];
+		iv[n] = &Op->f4_iv_Compressed[n][0];
+	}
+	const unsigned int* index = Get3DArrayData(Op->m_Op_index) + ((size_t)x*numLines[1]+y)*numLines[2];
+	f4vector temp;
+
+	unsigned int i;
+	for (unsigned int z=startZ; z<stopZ && z<numVectors-1; ++z)
+	{
+		i = index[z];
+		// x-pol
+		curr[0][z].v *= ii[0][i].v;
+		curr[0][z].v += iv[0][i].v * ( volt[2][z].v - volt_y[2][z].v - volt[1][z].v + volt[1][z+1].v);
+
+		// y-pol
+		curr[1][z].v *= ii[1][i].v;
+		curr[1][z].v += iv[1][i].v * ( volt[0][z].v - volt[0][z+1].v - volt[2][z].v + volt_x[2][z].v);
 
-			index = Op->m_Op_index[pos[0]][pos[1]][numVectors-1];
-			// for pos[2] = numVectors-1
-			// x-pol
+		// z-pol
+		curr[2][z].v *= ii[2][i].v;
+		curr[2][z].v += iv[2][i].v * ( volt[1][z].v - volt_x[1][z].v - volt[0][z].v + volt_y[0][z].v);
+	}
+
+	if (stopZ<numVectors)
+		return;
+
+	const unsigned int z = numVectors-1;
+	i = index[z];
+	// for z = numVectors-1
+	// x-pol
 #ifdef __SSE2__
-			temp.v = (__m128)_mm_srli_si128( (__m128i)f4_volt[1][pos[0]][pos[1]][0].v, 4 );
+	temp.v = (__m128)_mm_srli_si128( (__m128i)volt[1][0].v, 4 );
 #else
-			temp.f[0] = f4_volt[1][pos[0]][pos[1]][0].f[1];
-			temp.f[1] = f4_volt[1][pos[0]][pos[1]][0].f[2];
-			temp.f[2] = f4_volt[1][pos[0]][pos[1]][0].f[3];
-			temp.f[3] = 0;
+	temp.f[0] = volt[1][0].f[1];
+	temp.f[1] = volt[1][0].f[2];
+	temp.f[2] = volt[1][0].f[3];
+	temp.f[3] = 0;
 #endif
-			f4_curr[0][pos[0]][pos[1]][numVectors-1].v *= Op->f4_ii_Compressed[0][index].v;
-			f4_curr[0][pos[0]][pos[1]][numVectors-1].v += Op->f4_iv_Compressed[0][index].v * ( f4_volt[2][pos[0]][pos[1]][numVectors-1].v - f4_volt[2][pos[0]][pos[1]+1][numVectors-1].v - f4_volt[1][pos[0]][pos[1]][numVectors-1].v + temp.v);
+	curr[0][z].v *= ii[0][i].v;
+	curr[0][z].v += iv[0][i].v * ( volt[2][z].v - volt_y[2][z].v - volt[1][z].v + temp.v);
 
-			// y-pol
+	// y-pol
 #ifdef __SSE2__
-			temp.v = (__m128)_mm_srli_si128( (__m128i)f4_volt[0][pos[0]][pos[1]][0].v, 4 );
+	temp.v = (__m128)_mm_srli_si128( (__m128i)volt[0][0].v, 4 );
 #else
-			temp.f[0] = f4_volt[0][pos[0]][pos[1]][0].f[1];
-			temp.f[1] = f4_volt[0][pos[0]][pos[1]][0].f[2];
-			temp.f[2] = f4_volt[0][pos[0]][pos[1]][0].f[3];
-			temp.f[3] = 0;
+	temp.f[0] = volt[0][0].f[1];
+	temp.f[1] = volt[0][0].f[2];
+	temp.f[2] = volt[0][0].f[3];
+	temp.f[3] = 0;
 #endif
-			f4_curr[1][pos[0]][pos[1]][numVectors-1].v *= Op->f4_ii_Compressed[1][index].v;
-			f4_curr[1][pos[0]][pos[1]][numVectors-1].v += Op->f4_iv_Compressed[1][index].v * ( f4_volt[0][pos[0]][pos[1]][numVectors-1].v - temp.v - f4_volt[2][pos[0]][pos[1]][numVectors-1].v + f4_volt[2][pos[0]+1][pos[1]][numVectors-1].v);
+	curr[1][z].v *= ii[1][i].v;
+	curr[1][z].v += iv[1][i].v * ( volt[0][z].v - temp.v - volt[2][z].v + volt_x[2][z].v);
+
+	// z-pol
+	curr[2][z].v *= ii[2][i].v;
+	curr[2][z].v += iv[2][i].v * ( volt[1][z].v - volt_x[1][z].v - volt[0][z].v + volt_y[0][z].v);
+}
+
+#ifdef ENABLE_WIDE_VECTORS
 
-			// z-pol
-			f4_curr[2][pos[0]][pos[1]][numVectors-1].v *= Op->f4_ii_Compressed[2][index].v;
-			f4_curr[2][pos[0]][pos[1]][numVectors-1].v += Op->f4_iv_Compressed[2][index].v * ( f4_volt[1][pos[0]][pos[1]][numVectors-1].v - f4_volt[1][pos[0]+1][pos[1]][numVectors-1].v - f4_volt[0][pos[0]][pos[1]][numVectors-1].v + f4_volt[0][pos[0]][pos[1]+1][numVectors-1].v);
+// access a group of consecutive f4vectors (or wide coefficients) as one wide vector
+#define WIDE(TYPE, var) (*(TYPE*)&(var))
+
+// The wide kernels are compiled for the target of their calling UpdateVoltages_AVX/.._AVX512 functions only.
+// Instead of forcing them inline (which fails if the targets of caller and callee differ) the callers are flattened,
+// inlining all helpers that are compatible with the calling target.
+// Contraction to fused multiply-add is disabled to get results identical to the sse kernels.
+
+template <typename VEC, typename VEC_U>
+void Engine_SSE_Compressed::UpdateVoltages_Wide(unsigned int startX, unsigned int numX)
+{
+	const unsigned int width = sizeof(VEC)/sizeof(float);
+	const unsigned int numGroup = width/4; // number of f4vectors per wide vector
+	const unsigned int numWide = Op->m_numLines_Wide[2];
+	f4vector* volt[3];
+	const f4vector* curr[3];
+	const f4vector* curr_x[3];
+	const f4vector* curr_y[3];
+	const float* vv[3];
+	const float* vi[3];
+	for (int n=0; n<3; ++n)
+	{
+		vv[n] = &Op->f_vv_Wide[n][0];
+		vi[n] = &Op->f_vi_Wide[n][0];
+	}
+	unsigned int z;
+	unsigned int i;
+
+	for (unsigned int x=startX; x<startX+numX; ++x)
+	{
+		for (unsigned int y=0; y<numLines[1]; ++y)
+		{
+			// the first wide vector includes the z=0 wrap-around, use the sse kernel
+			UpdateVoltagesLine(x, y, 0, numGroup);
+
+			for (int n=0; n<3; ++n)
+			{
+				volt[n] = GetLine(f4_volt, n, x, y);
+				curr[n] = GetLine(f4_curr, n, x, y);
+				curr_x[n] = GetLine(f4_curr, n, x-(x>0), y);
+				curr_y[n] = GetLine(f4_curr, n, x, y-(y>0));
+			}
+			const unsigned int* index = Get3DArrayData(Op->m_Op_index_Wide) + ((size_t)x*Op->m_numLines_Wide[1]+y)*numWide;
+			for (unsigned int w=1; w<numWide; ++w)
+			{
+				i = index[w]*width;
+				z = w*numGroup;
+				// x-polarization
+				WIDE(VEC,volt[0][z]) *= WIDE(const VEC,vv[0][i]);
+				WIDE(VEC,volt[0][z]) += WIDE(const VEC,vi[0][i]) * ( WIDE(const VEC,curr[2][z]) - WIDE(const VEC,curr_y[2][z]) - WIDE(const VEC,curr[1][z]) + WIDE(const VEC_U,curr[1][z-1]) );
+
+				// y-polarization
+				WIDE(VEC,volt[1][z]) *= WIDE(const VEC,vv[1][i]);
+				WIDE(VEC,volt[1][z]) += WIDE(const VEC,vi[1][i]) * ( WIDE(const VEC,curr[0][z]) - WIDE(const VEC_U,curr[0][z-1]) - WIDE(const VEC,curr[2][z]) + WIDE(const VEC,curr_x[2][z]) );
+
+				// z-polarization
+				WIDE(VEC,volt[2][z]) *= WIDE(const VEC,vv[2][i]);
+				WIDE(VEC,volt[2][z]) += WIDE(const VEC,vi[2][i]) * ( WIDE(const VEC,curr[1][z]) - WIDE(const VEC,curr_x[1][z]) - WIDE(const VEC,curr[0][z]) + WIDE(const VEC,curr_y[0][z]) );
+			}
+
+			// remaining f4vectors not filling a complete wide vector
+			UpdateVoltagesLine(x, y, numWide*numGroup, numVectors);
+		}
+	}
+}
+
+template <typename VEC, typename VEC_U>
+void Engine_SSE_Compressed::UpdateCurrents_Wide(unsigned int startX, unsigned int numX)
+{
+	const unsigned int width = sizeof(VEC)/sizeof(float);
+	const unsigned int numGroup = width/4; // number of f4vectors per wide vector
+	// the last f4vector includes the z wrap-around and is left to the sse kernel
+	const unsigned int numWide = (numVectors-1)/numGroup;
+	f4vector* curr[3];
+	const f4vector* volt[3];
+	const f4vector* volt_x[3];
+	const f4vector* volt_y[3];
+	const float* ii[3];
+	const float* iv[3];
+	for (int n=0; n<3; ++n)
+	{
+		ii[n] = &Op->f_ii_Wide[n][0];
+		iv[n] = &Op->f_iv_Wide[n][0];
+	}
+	unsigned int z;
+	unsigned int i;
+
+	for (unsigned int x=startX; x<startX+numX; ++x)
+	{
+		for (unsigned int y=0; y<numLines[1]-1; ++y)
+		{
+			for (int n=0; n<3; ++n)
+			{
+				curr[n] = GetLine(f4_curr, n, x, y);
+				volt[n] = GetLine(f4_volt, n, x, y);
+				volt_x[n] = GetLine(f4_volt, n, x+1, y);
+				volt_y[n] = GetLine(f4_volt, n, x, y+1);
+			}
+			const unsigned int* index = Get3DArrayData(Op->m_Op_index_Wide) + ((size_t)x*Op->m_numLines_Wide[1]+y)*Op->m_numLines_Wide[2];
+			for (unsigned int w=0; w<numWide; ++w)
+			{
+				i = index[w]*width;
+				z = w*numGroup;
+				// x-pol
+				WIDE(VEC,curr[0][z]) *= WIDE(const VEC,ii[0][i]);
+				WIDE(VEC,curr[0][z]) += WIDE(const VEC,iv[0][i]) * ( WIDE(const VEC,volt[2][z]) - WIDE(const VEC,volt_y[2][z]) - WIDE(const VEC,volt[1][z]) + WIDE(const VEC_U,volt[1][z+1]) );
+
+				// y-pol
+				WIDE(VEC,curr[1][z]) *= WIDE(const VEC,ii[1][i]);
+				WIDE(VEC,curr[1][z]) += WIDE(const VEC,iv[1][i]) * ( WIDE(const VEC,volt[0][z]) - WIDE(const VEC_U,volt[0][z+1]) - WIDE(const VEC,volt[2][z]) + WIDE(const VEC,volt_x[2][z]) );
+
+				// z-pol
+				WIDE(VEC,curr[2][z]) *= WIDE(const VEC,ii[2][i]);
+				WIDE(VEC,curr[2][z]) += WIDE(const VEC,iv[2][i]) * ( WIDE(const VEC,volt[1][z]) - WIDE(const VEC,volt_x[1][z]) - WIDE(const VEC,volt[0][z]) + WIDE(const VEC,volt_y[0][z]) );
+			}
+
+			// remaining f4vectors incl. the z wrap-around
+			UpdateCurrentsLine(x, y, numWide*numGroup, numVectors);
 		}
-		++pos[0];
 	}
 }
+
+__attribute__((target("avx"), optimize("fp-contract=off"), flatten)) void Engine_SSE_Compressed::UpdateVoltages_AVX(unsigned int startX, unsigned int numX)
+{
+	UpdateVoltages_Wide<v8sf,v8sf_u>(startX, numX);
+}
+
+__attribute__((target("avx"), optimize("fp-contract=off"), flatten)) void Engine_SSE_Compressed::UpdateCurrents_AVX(unsigned int startX, unsigned int numX)
+{
+	UpdateCurrents_Wide<v8sf,v8sf_u>(startX, numX);
+}
+
+__attribute__((target("avx512f"), optimize("fp-contract=off"), flatten)) void Engine_SSE_Compressed::UpdateVoltages_AVX512(unsigned int startX, unsigned int numX)
+{
+	UpdateVoltages_Wide<v16sf,v16sf_u>(startX, numX);
+}
+
+__attribute__((target("avx512f"), optimize("fp-contract=off"), flatten)) void Engine_SSE_Compressed::UpdateCurrents_AVX512(unsigned int startX, unsigned int numX)
+{
+	UpdateCurrents_Wide<v16sf,v16sf_u>(startX, numX);
+}
+
+#undef WIDE
+
+#endif // ENABLE_WIDE_VECTORS
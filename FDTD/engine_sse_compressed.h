@@ -33,6 +33,27 @@ protected:
 
 	virtual void UpdateVoltages(unsigned int startX, unsigned int numX);
 	virtual void UpdateCurrents(unsigned int startX, unsigned int numX);
+
+	//! Update the voltages of the x-range [startX, stopX) and y-range [startY, stopY) for all f4vectors in the range [startZ, stopZ)
+	void UpdateVoltagesBlock(unsigned int startX, unsigned int stopX, unsigned int startY, unsigned int stopY, unsigned int startZ, unsigned int stopZ);
+	//! Update the currents of the x-range [startX, stopX) and y-range [startY, stopY) for all f4vectors in the range [startZ, stopZ)
+	void UpdateCurrentsBlock(unsigned int startX, unsigned int stopX, unsigned int startY, unsigned int stopY, unsigned int startZ, unsigned int stopZ);
+
+	//! Update the voltages of a single z-line for all f4vectors in the range [startZ, stopZ)
+	inline void UpdateVoltagesLine(unsigned int x, unsigned int y, unsigned int startZ, unsigned int stopZ);
+	//! Update the currents of a single z-line for all f4vectors in the range [startZ, stopZ)
+	inline void UpdateCurrentsLine(unsigned int x, unsigned int y, unsigned int startZ, unsigned int stopZ);
+
+#ifdef ENABLE_WIDE_VECTORS
+	//! Wide vector kernels, operating on groups of consecutive f4vectors (see Operator_SSE_Compressed::GetVectorWidth())
+	template <typename VEC, typename VEC_U> inline void UpdateVoltages_Wide(unsigned int startX, unsigned int numX);
+	template <typename VEC, typename VEC_U> inline void UpdateCurrents_Wide(unsigned int startX, unsigned int numX);
+
+	void UpdateVoltages_AVX(unsigned int startX, unsigned int numX);
+	void UpdateCurrents_AVX(unsigned int startX, unsigned int numX);
+	void UpdateVoltages_AVX512(unsigned int startX, unsigned int numX);
+	void UpdateCurrents_AVX512(unsigned int startX, unsigned int numX);
+#endif
 };
 
 #endif // ENGINE_SSE_COMPRESSED_H
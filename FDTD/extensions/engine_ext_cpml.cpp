@@ -0,0 +1,439 @@
+/*
+*	Copyright (C) 2026 openEMS contributors
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "engine_ext_cpml.h"
+#include "operator_ext_cpml.h"
+#include "FDTD/engine.h"
+#include "FDTD/engine_sse.h"
+#include "tools/array_ops.h"
+#include "tools/useful.h"
+
+Engine_Ext_CPML::Engine_Ext_CPML(Operator_Ext_CPML* op_ext) : Engine_Extension(op_ext)
+{
+	m_Op_CPML = op_ext;
+	m_ny = m_Op_CPML->m_ny;
+	m_nyP = m_Op_CPML->m_nyP;
+	m_nyPP = m_Op_CPML->m_nyPP;
+	for (int n=0; n<3; ++n)
+	{
+		m_StartPos[n] = m_Op_CPML->m_StartPos[n];
+		m_numLines[n] = m_Op_CPML->m_numLines[n];
+		m_numLinesEng[n] = m_Op_CPML->m_Op->GetNumberOfLines(n,true);
+	}
+
+	const Operator* op = m_Op_CPML->m_Op;
+	unsigned int pos[3];
+	unsigned int loc[3];
+	for (int j=0; j<2; ++j)
+	{
+		m_volt_psi[j] = Create3DArray<FDTD_FLOAT>(m_numLines);
+		m_curr_psi[j] = Create3DArray<FDTD_FLOAT>(m_numLines);
+
+		// the engine extensions are created after all operator extensions have been applied to the coefficients
+		int n = (j==0) ? m_nyP : m_nyPP;
+		m_vi[j] = Create3DArray<FDTD_FLOAT>(m_numLines);
+		m_iv[j] = Create3DArray<FDTD_FLOAT>(m_numLines);
+		for (loc[0]=0; loc[0]<m_numLines[0]; ++loc[0])
+		{
+			pos[0] = loc[0]+m_StartPos[0];
+			for (loc[1]=0; loc[1]<m_numLines[1]; ++loc[1])
+			{
+				pos[1] = loc[1]+m_StartPos[1];
+				for (loc[2]=0; loc[2]<m_numLines[2]; ++loc[2])
+				{
+					pos[2] = loc[2]+m_StartPos[2];
+					m_vi[j][loc[0]][loc[1]][loc[2]] = op->GetVI(n,pos);
+					m_iv[j][loc[0]][loc[1]][loc[2]] = op->GetIV(n,pos);
+				}
+			}
+		}
+	}
+
+	SetNumberOfThreads(1);
+}
+
+Engine_Ext_CPML::~Engine_Ext_CPML()
+{
+	for (int j=0; j<2; ++j)
+	{
+		Delete3DArray(m_volt_psi[j],m_numLines);
+		m_volt_psi[j] = NULL;
+		Delete3DArray(m_curr_psi[j],m_numLines);
+		m_curr_psi[j] = NULL;
+		Delete3DArray(m_vi[j],m_numLines);
+		m_vi[j] = NULL;
+		Delete3DArray(m_iv[j],m_numLines);
+		m_iv[j] = NULL;
+	}
+}
+
+void Engine_Ext_CPML::SetNumberOfThreads(int nrThread)
+{
+	Engine_Extension::SetNumberOfThreads(nrThread);
+
+	m_numX = AssignJobs2Threads(m_numLines[0],m_NrThreads,false);
+	m_start.resize(m_NrThreads,0);
+	m_start.at(0)=0;
+	for (size_t n=1; n<m_numX.size(); ++n)
+		m_start.at(n) = m_start.at(n-1) + m_numX.at(n-1);
+}
+
+void Engine_Ext_CPML::SetEngine(Engine* eng)
+{
+	Engine_Extension::SetEngine(eng);
+
+	for (int s=0; s<3; ++s)
+	{
+		m_zVector[s].clear();
+		m_zLane[s].clear();
+	}
+	if ((m_Eng==NULL) || (m_Eng->GetType()!=Engine::SSE))
+		return;
+	// the z-line z of the sse engines is stored in lane z/numVectors of the f4vector z%numVectors
+	unsigned int numZ = m_numLinesEng[2];
+	unsigned int numVectors = ceil((double)numZ/4.0);
+	for (int s=0; s<3; ++s)
+		for (unsigned int z=0; z<m_numLines[2]; ++z)
+		{
+			int zs = (int)(z+m_StartPos[2]) + s - 1;
+			// shifts outside the mesh are never accessed
+			if ((zs<0) || (zs>=(int)numZ))
+				zs = 0;
+			m_zVector[s].push_back(zs%numVectors);
+			m_zLane[s].push_back(zs/numVectors);
+		}
+}
+
+bool Engine_Ext_CPML::WriteState(ostream &file) const
+{
+	for (int j=0; j<2; ++j)
+		for (unsigned int x=0; x<m_numLines[0]; ++x)
+			for (unsigned int y=0; y<m_numLines[1]; ++y)
+			{
+				file.write((const char*)m_volt_psi[j][x][y], sizeof(FDTD_FLOAT)*m_numLines[2]);
+				file.write((const char*)m_curr_psi[j][x][y], sizeof(FDTD_FLOAT)*m_numLines[2]);
+			}
+	return file.good();
+}
+
+bool Engine_Ext_CPML::ReadState(istream &file)
+{
+	for (int j=0; j<2; ++j)
+		for (unsigned int x=0; x<m_numLines[0]; ++x)
+			for (unsigned int y=0; y<m_numLines[1]; ++y)
+			{
+				file.read((char*)m_volt_psi[j][x][y], sizeof(FDTD_FLOAT)*m_numLines[2]);
+				file.read((char*)m_curr_psi[j][x][y], sizeof(FDTD_FLOAT)*m_numLines[2]);
+			}
+	return file.good();
+}
+
+bool Engine_Ext_CPML::GetFootprint(unsigned int &startX, unsigned int &stopX) const
+{
+	startX = m_StartPos[0];
+	stopX = m_StartPos[0]+m_numLines[0]-1;
+	return m_numLines[0]>0;
+}
+
+void Engine_Ext_CPML::Apply2Voltages(int threadID)
+{
+	if (threadID>=m_NrThreads)
+		return;
+	ApplyVoltages(m_start.at(threadID), m_numX.at(threadID));
+}
+
+void Engine_Ext_CPML::Apply2VoltagesRange(unsigned int startX, unsigned int numX, int timestep)
+{
+	UNUSED(timestep);
+	unsigned int stopX = min(startX+numX, m_StartPos[0]+m_numLines[0]);
+	startX = max(startX, m_StartPos[0]);
+	if (startX<stopX)
+		ApplyVoltages(startX-m_StartPos[0], stopX-startX);
+}
+
+void Engine_Ext_CPML::ApplyVoltages(unsigned int startX, unsigned int numX)
+{
+	if ((m_Eng==NULL) || (m_numLines[2]==0)) return;
+	unsigned int start[3] = {m_StartPos[0]+startX, m_StartPos[1], m_StartPos[2]};
+	unsigned int stop[3] = {start[0]+numX, m_StartPos[1]+m_numLines[1], m_StartPos[2]+m_numLines[2]};
+	//the voltages at the first line have no derivative in normal direction
+	start[m_ny] = max(start[m_ny], 1u);
+
+	unsigned int pos[3];
+	unsigned int pos_shift[3];
+	unsigned int loc[3];
+	FDTD_FLOAT deriv;
+
+	//switch for different engine types to access faster inline engine functions
+	switch (m_Eng->GetType())
+	{
+	case Engine::BASIC:
+		{
+			for (pos[0]=start[0]; pos[0]<stop[0]; ++pos[0])
+			{
+				loc[0] = pos[0]-m_StartPos[0];
+				for (pos[1]=start[1]; pos[1]<stop[1]; ++pos[1])
+				{
+					loc[1] = pos[1]-m_StartPos[1];
+					for (pos[2]=start[2]; pos[2]<stop[2]; ++pos[2])
+					{
+						loc[2] = pos[2]-m_StartPos[2];
+						pos_shift[0]=pos[0]; pos_shift[1]=pos[1]; pos_shift[2]=pos[2];
+						--pos_shift[m_ny];
+						FDTD_FLOAT b = m_Op_CPML->m_volt_b[loc[m_ny]];
+						FDTD_FLOAT c = m_Op_CPML->m_volt_c[loc[m_ny]];
+						FDTD_FLOAT kinv = m_Op_CPML->m_volt_kinv[loc[m_ny]];
+
+						deriv = m_Eng->Engine::GetCurr(m_nyPP,pos_shift) - m_Eng->Engine::GetCurr(m_nyPP,pos);
+						FDTD_FLOAT &psi_P = m_volt_psi[0][loc[0]][loc[1]][loc[2]];
+						psi_P = b*psi_P + c*deriv;
+						m_Eng->Engine::SetVolt(m_nyP,pos, m_Eng->Engine::GetVolt(m_nyP,pos) + m_vi[0][loc[0]][loc[1]][loc[2]]*(kinv*deriv + psi_P));
+
+						deriv = m_Eng->Engine::GetCurr(m_nyP,pos) - m_Eng->Engine::GetCurr(m_nyP,pos_shift);
+						FDTD_FLOAT &psi_PP = m_volt_psi[1][loc[0]][loc[1]][loc[2]];
+						psi_PP = b*psi_PP + c*deriv;
+						m_Eng->Engine::SetVolt(m_nyPP,pos, m_Eng->Engine::GetVolt(m_nyPP,pos) + m_vi[1][loc[0]][loc[1]][loc[2]]*(kinv*deriv + psi_PP));
+					}
+				}
+			}
+			break;
+		}
+	case Engine::SSE:
+		{
+			// direct access of the z-lines using the precomputed vector index and lane, see SetEngine()
+			Engine_sse* eng_sse = (Engine_sse*) m_Eng;
+			// the z-shift of the currents for a pml normal to z, otherwise the shift is in the x- or y-line
+			int zs = (m_ny==2) ? 0 : 1;
+			const unsigned int* zVec = &m_zVector[1][0];
+			const unsigned int* zLane = &m_zLane[1][0];
+			const unsigned int* zVecS = &m_zVector[zs][0];
+			const unsigned int* zLaneS = &m_zLane[zs][0];
+			for (pos[0]=start[0]; pos[0]<stop[0]; ++pos[0])
+			{
+				loc[0] = pos[0]-m_StartPos[0];
+				for (pos[1]=start[1]; pos[1]<stop[1]; ++pos[1])
+				{
+					loc[1] = pos[1]-m_StartPos[1];
+					pos_shift[0]=pos[0]; pos_shift[1]=pos[1];
+					if (m_ny<2)
+						--pos_shift[m_ny];
+					f4vector* volt_P = eng_sse->f4_volt[m_nyP][pos[0]][pos[1]];
+					f4vector* volt_PP = eng_sse->f4_volt[m_nyPP][pos[0]][pos[1]];
+					const f4vector* curr_P = eng_sse->f4_curr[m_nyP][pos[0]][pos[1]];
+					const f4vector* curr_PP = eng_sse->f4_curr[m_nyPP][pos[0]][pos[1]];
+					const f4vector* curr_P_s = eng_sse->f4_curr[m_nyP][pos_shift[0]][pos_shift[1]];
+					const f4vector* curr_PP_s = eng_sse->f4_curr[m_nyPP][pos_shift[0]][pos_shift[1]];
+					FDTD_FLOAT* psi_P = m_volt_psi[0][loc[0]][loc[1]];
+					FDTD_FLOAT* psi_PP = m_volt_psi[1][loc[0]][loc[1]];
+					const FDTD_FLOAT* vi_P = m_vi[0][loc[0]][loc[1]];
+					const FDTD_FLOAT* vi_PP = m_vi[1][loc[0]][loc[1]];
+					for (loc[2]=start[2]-m_StartPos[2]; loc[2]<stop[2]-m_StartPos[2]; ++loc[2])
+					{
+						FDTD_FLOAT b = m_Op_CPML->m_volt_b[loc[m_ny]];
+						FDTD_FLOAT c = m_Op_CPML->m_volt_c[loc[m_ny]];
+						FDTD_FLOAT kinv = m_Op_CPML->m_volt_kinv[loc[m_ny]];
+						unsigned int v = zVec[loc[2]], l = zLane[loc[2]];
+						unsigned int vs = zVecS[loc[2]], ls = zLaneS[loc[2]];
+
+						deriv = curr_PP_s[vs].f[ls] - curr_PP[v].f[l];
+						psi_P[loc[2]] = b*psi_P[loc[2]] + c*deriv;
+						volt_P[v].f[l] = volt_P[v].f[l] + vi_P[loc[2]]*(kinv*deriv + psi_P[loc[2]]);
+
+						deriv = curr_P[v].f[l] - curr_P_s[vs].f[ls];
+						psi_PP[loc[2]] = b*psi_PP[loc[2]] + c*deriv;
+						volt_PP[v].f[l] = volt_PP[v].f[l] + vi_PP[loc[2]]*(kinv*deriv + psi_PP[loc[2]]);
+					}
+				}
+			}
+			break;
+		}
+	default:
+		for (pos[0]=start[0]; pos[0]<stop[0]; ++pos[0])
+		{
+			loc[0] = pos[0]-m_StartPos[0];
+			for (pos[1]=start[1]; pos[1]<stop[1]; ++pos[1])
+			{
+				loc[1] = pos[1]-m_StartPos[1];
+				for (pos[2]=start[2]; pos[2]<stop[2]; ++pos[2])
+				{
+					loc[2] = pos[2]-m_StartPos[2];
+					pos_shift[0]=pos[0]; pos_shift[1]=pos[1]; pos_shift[2]=pos[2];
+					--pos_shift[m_ny];
+					FDTD_FLOAT b = m_Op_CPML->m_volt_b[loc[m_ny]];
+					FDTD_FLOAT c = m_Op_CPML->m_volt_c[loc[m_ny]];
+					FDTD_FLOAT kinv = m_Op_CPML->m_volt_kinv[loc[m_ny]];
+
+					deriv = m_Eng->GetCurr(m_nyPP,pos_shift) - m_Eng->GetCurr(m_nyPP,pos);
+					FDTD_FLOAT &psi_P = m_volt_psi[0][loc[0]][loc[1]][loc[2]];
+					psi_P = b*psi_P + c*deriv;
+					m_Eng->SetVolt(m_nyP,pos, m_Eng->GetVolt(m_nyP,pos) + m_vi[0][loc[0]][loc[1]][loc[2]]*(kinv*deriv + psi_P));
+
+					deriv = m_Eng->GetCurr(m_nyP,pos) - m_Eng->GetCurr(m_nyP,pos_shift);
+					FDTD_FLOAT &psi_PP = m_volt_psi[1][loc[0]][loc[1]][loc[2]];
+					psi_PP = b*psi_PP + c*deriv;
+					m_Eng->SetVolt(m_nyPP,pos, m_Eng->GetVolt(m_nyPP,pos) + m_vi[1][loc[0]][loc[1]][loc[2]]*(kinv*deriv + psi_PP));
+				}
+			}
+		}
+		break;
+	}
+}
+
+void Engine_Ext_CPML::Apply2Current(int threadID)
+{
+	if (threadID>=m_NrThreads)
+		return;
+	ApplyCurrents(m_start.at(threadID), m_numX.at(threadID));
+}
+
+void Engine_Ext_CPML::Apply2CurrentRange(unsigned int startX, unsigned int numX, int timestep)
+{
+	UNUSED(timestep);
+	unsigned int stopX = min(startX+numX, m_StartPos[0]+m_numLines[0]);
+	startX = max(startX, m_StartPos[0]);
+	if (startX<stopX)
+		ApplyCurrents(startX-m_StartPos[0], stopX-startX);
+}
+
+void Engine_Ext_CPML::ApplyCurrents(unsigned int startX, unsigned int numX)
+{
+	if ((m_Eng==NULL) || (m_numLines[2]==0)) return;
+	unsigned int start[3] = {m_StartPos[0]+startX, m_StartPos[1], m_StartPos[2]};
+	unsigned int stop[3] = {start[0]+numX, m_StartPos[1]+m_numLines[1], m_StartPos[2]+m_numLines[2]};
+	//the currents at the last line are not updated by the main engine
+	for (int n=0; n<3; ++n)
+		stop[n] = min(stop[n], m_numLinesEng[n]-1);
+
+	unsigned int pos[3];
+	unsigned int pos_shift[3];
+	unsigned int loc[3];
+	FDTD_FLOAT deriv;
+
+	//switch for different engine types to access faster inline engine functions
+	switch (m_Eng->GetType())
+	{
+	case Engine::BASIC:
+		{
+			for (pos[0]=start[0]; pos[0]<stop[0]; ++pos[0])
+			{
+				loc[0] = pos[0]-m_StartPos[0];
+				for (pos[1]=start[1]; pos[1]<stop[1]; ++pos[1])
+				{
+					loc[1] = pos[1]-m_StartPos[1];
+					for (pos[2]=start[2]; pos[2]<stop[2]; ++pos[2])
+					{
+						loc[2] = pos[2]-m_StartPos[2];
+						pos_shift[0]=pos[0]; pos_shift[1]=pos[1]; pos_shift[2]=pos[2];
+						++pos_shift[m_ny];
+						FDTD_FLOAT b = m_Op_CPML->m_curr_b[loc[m_ny]];
+						FDTD_FLOAT c = m_Op_CPML->m_curr_c[loc[m_ny]];
+						FDTD_FLOAT kinv = m_Op_CPML->m_curr_kinv[loc[m_ny]];
+
+						deriv = m_Eng->Engine::GetVolt(m_nyPP,pos_shift) - m_Eng->Engine::GetVolt(m_nyPP,pos);
+						FDTD_FLOAT &psi_P = m_curr_psi[0][loc[0]][loc[1]][loc[2]];
+						psi_P = b*psi_P + c*deriv;
+						m_Eng->Engine::SetCurr(m_nyP,pos, m_Eng->Engine::GetCurr(m_nyP,pos) + m_iv[0][loc[0]][loc[1]][loc[2]]*(kinv*deriv + psi_P));
+
+						deriv = m_Eng->Engine::GetVolt(m_nyP,pos) - m_Eng->Engine::GetVolt(m_nyP,pos_shift);
+						FDTD_FLOAT &psi_PP = m_curr_psi[1][loc[0]][loc[1]][loc[2]];
+						psi_PP = b*psi_PP + c*deriv;
+						m_Eng->Engine::SetCurr(m_nyPP,pos, m_Eng->Engine::GetCurr(m_nyPP,pos) + m_iv[1][loc[0]][loc[1]][loc[2]]*(kinv*deriv + psi_PP));
+					}
+				}
+			}
+			break;
+		}
+	case Engine::SSE:
+		{
+			// direct access of the z-lines using the precomputed vector index and lane, see SetEngine()
+			Engine_sse* eng_sse = (Engine_sse*) m_Eng;
+			// the z-shift of the voltages for a pml normal to z, otherwise the shift is in the x- or y-line
+			int zs = (m_ny==2) ? 2 : 1;
+			const unsigned int* zVec = &m_zVector[1][0];
+			const unsigned int* zLane = &m_zLane[1][0];
+			const unsigned int* zVecS = &m_zVector[zs][0];
+			const unsigned int* zLaneS = &m_zLane[zs][0];
+			for (pos[0]=start[0]; pos[0]<stop[0]; ++pos[0])
+			{
+				loc[0] = pos[0]-m_StartPos[0];
+				for (pos[1]=start[1]; pos[1]<stop[1]; ++pos[1])
+				{
+					loc[1] = pos[1]-m_StartPos[1];
+					pos_shift[0]=pos[0]; pos_shift[1]=pos[1];
+					if (m_ny<2)
+						++pos_shift[m_ny];
+					f4vector* curr_P = eng_sse->f4_curr[m_nyP][pos[0]][pos[1]];
+					f4vector* curr_PP = eng_sse->f4_curr[m_nyPP][pos[0]][pos[1]];
+					const f4vector* volt_P = eng_sse->f4_volt[m_nyP][pos[0]][pos[1]];
+					const f4vector* volt_PP = eng_sse->f4_volt[m_nyPP][pos[0]][pos[1]];
+					const f4vector* volt_P_s = eng_sse->f4_volt[m_nyP][pos_shift[0]][pos_shift[1]];
+					const f4vector* volt_PP_s = eng_sse->f4_volt[m_nyPP][pos_shift[0]][pos_shift[1]];
+					FDTD_FLOAT* psi_P = m_curr_psi[0][loc[0]][loc[1]];
+					FDTD_FLOAT* psi_PP = m_curr_psi[1][loc[0]][loc[1]];
+					const FDTD_FLOAT* iv_P = m_iv[0][loc[0]][loc[1]];
+					const FDTD_FLOAT* iv_PP = m_iv[1][loc[0]][loc[1]];
+					for (loc[2]=start[2]-m_StartPos[2]; loc[2]<stop[2]-m_StartPos[2]; ++loc[2])
+					{
+						FDTD_FLOAT b = m_Op_CPML->m_curr_b[loc[m_ny]];
+						FDTD_FLOAT c = m_Op_CPML->m_curr_c[loc[m_ny]];
+						FDTD_FLOAT kinv = m_Op_CPML->m_curr_kinv[loc[m_ny]];
+						unsigned int v = zVec[loc[2]], l = zLane[loc[2]];
+						unsigned int vs = zVecS[loc[2]], ls = zLaneS[loc[2]];
+
+						deriv = volt_PP_s[vs].f[ls] - volt_PP[v].f[l];
+						psi_P[loc[2]] = b*psi_P[loc[2]] + c*deriv;
+						curr_P[v].f[l] = curr_P[v].f[l] + iv_P[loc[2]]*(kinv*deriv + psi_P[loc[2]]);
+
+						deriv = volt_P[v].f[l] - volt_P_s[vs].f[ls];
+						psi_PP[loc[2]] = b*psi_PP[loc[2]] + c*deriv;
+						curr_PP[v].f[l] = curr_PP[v].f[l] + iv_PP[loc[2]]*(kinv*deriv + psi_PP[loc[2]]);
+					}
+				}
+			}
+			break;
+		}
+	default:
+		for (pos[0]=start[0]; pos[0]<stop[0]; ++pos[0])
+		{
+			loc[0] = pos[0]-m_StartPos[0];
+			for (pos[1]=start[1]; pos[1]<stop[1]; ++pos[1])
+			{
+				loc[1] = pos[1]-m_StartPos[1];
+				for (pos[2]=start[2]; pos[2]<stop[2]; ++pos[2])
+				{
+					loc[2] = pos[2]-m_StartPos[2];
+					pos_shift[0]=pos[0]; pos_shift[1]=pos[1]; pos_shift[2]=pos[2];
+					++pos_shift[m_ny];
+					FDTD_FLOAT b = m_Op_CPML->m_curr_b[loc[m_ny]];
+					FDTD_FLOAT c = m_Op_CPML->m_curr_c[loc[m_ny]];
+					FDTD_FLOAT kinv = m_Op_CPML->m_curr_kinv[loc[m_ny]];
+
+					deriv = m_Eng->GetVolt(m_nyPP,pos_shift) - m_Eng->GetVolt(m_nyPP,pos);
+					FDTD_FLOAT &psi_P = m_curr_psi[0][loc[0]][loc[1]][loc[2]];
+					psi_P = b*psi_P + c*deriv;
+					m_Eng->SetCurr(m_nyP,pos, m_Eng->GetCurr(m_nyP,pos) + m_iv[0][loc[0]][loc[1]][loc[2]]*(kinv*deriv + psi_P));
+
+					deriv = m_Eng->GetVolt(m_nyP,pos) - m_Eng->GetVolt(m_nyP,pos_shift);
+					FDTD_FLOAT &psi_PP = m_curr_psi[1][loc[0]][loc[1]][loc[2]];
+					psi_PP = b*psi_PP + c*deriv;
+					m_Eng->SetCurr(m_nyPP,pos, m_Eng->GetCurr(m_nyPP,pos) + m_iv[1][loc[0]][loc[1]][loc[2]]*(kinv*deriv + psi_PP));
+				}
+			}
+		}
+		break;
+	}
+}
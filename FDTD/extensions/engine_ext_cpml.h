@@ -0,0 +1,87 @@
+/*
+*	Copyright (C) 2026 openEMS contributors
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef ENGINE_EXT_CPML_H
+#define ENGINE_EXT_CPML_H
+
+#include "engine_extension.h"
+#include "FDTD/engine.h"
+#include "FDTD/operator.h"
+
+class Operator_Ext_CPML;
+
+//! Engine extension for the convolutional pml (see Operator_Ext_CPML)
+/*!
+  After the main engine updated the voltages (currents), the auxiliary fields are updated from the same derivative normal to the boundary plane
+  as used by the main engine. The tangential voltages (currents) are corrected by vi*((1/kappa-1)*derivative + psi), scaling the normal derivative
+  of the main update by 1/kappa. The operator coefficients are read from the main operator, including all other extensions.
+  These corrections only depend on the currents (voltages) the main engine update depends on, thus the cpml is safe for temporal blocking and fused updates.
+  */
+class Engine_Ext_CPML : public Engine_Extension
+{
+public:
+	Engine_Ext_CPML(Operator_Ext_CPML* op_ext);
+	virtual ~Engine_Ext_CPML();
+
+	virtual void SetNumberOfThreads(int nrThread);
+	//! Set the engine and the z-line layout used for the direct access of the sse engine fields
+	virtual void SetEngine(Engine* eng);
+
+	virtual void Apply2Voltages() {Engine_Ext_CPML::Apply2Voltages(0);}
+	virtual void Apply2Voltages(int threadID);
+	virtual void Apply2Current() {Engine_Ext_CPML::Apply2Current(0);}
+	virtual void Apply2Current(int threadID);
+
+	virtual int GetUpdateStages() const {return APPLY_VOLTAGE | APPLY_CURRENT;}
+	virtual bool IsTemporalBlockingSafe(const std::vector<unsigned int> &start, const std::vector<unsigned int> &stop) const {UNUSED(start);UNUSED(stop);return true;}
+	virtual void Apply2VoltagesRange(unsigned int startX, unsigned int numX, int timestep);
+	virtual void Apply2CurrentRange(unsigned int startX, unsigned int numX, int timestep);
+	virtual bool GetFootprint(unsigned int &startX, unsigned int &stopX) const;
+
+	virtual bool WriteState(std::ostream &file) const;
+	virtual bool ReadState(std::istream &file);
+
+protected:
+	Operator_Ext_CPML* m_Op_CPML;
+
+	//! Apply the corrections to the local x-lines [startX, startX+numX) of this pml
+	void ApplyVoltages(unsigned int startX, unsigned int numX);
+	void ApplyCurrents(unsigned int startX, unsigned int numX);
+
+	int m_ny;
+	int m_nyP,m_nyPP;
+	unsigned int m_StartPos[3];
+	unsigned int m_numLines[3];
+	//! number of lines of the main engine
+	unsigned int m_numLinesEng[3];
+
+	vector<unsigned int> m_start;
+	vector<unsigned int> m_numX;
+
+	//! auxiliary fields of the tangential components, index 0 -> n+1 direction, 1 -> n+2 direction
+	FDTD_FLOAT*** m_volt_psi[2];
+	FDTD_FLOAT*** m_curr_psi[2];
+	//! operator coefficients vi and iv of the tangential components, copied from the main operator to avoid its virtual access functions
+	FDTD_FLOAT*** m_vi[2];
+	FDTD_FLOAT*** m_iv[2];
+
+	//! f4vector index and lane of the local z-lines in the sse engine fields, for the z-shifts -1, 0 and +1
+	vector<unsigned int> m_zVector[3];
+	vector<unsigned int> m_zLane[3];
+};
+
+#endif // ENGINE_EXT_CPML_H
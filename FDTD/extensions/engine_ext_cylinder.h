@@ -34,6 +34,8 @@ public:
 
 	virtual void DoPostCurrentUpdates();
 
+	virtual int GetUpdateStages() const {return POST_VOLTAGE | POST_CURRENT;}
+
 	virtual void SetEngine(Engine* eng);
 
 protected:
@@ -73,6 +73,51 @@ Engine_Ext_Dispersive::~Engine_Ext_Dispersive()
 	volt_ADE=NULL;
 }
 
+bool Engine_Ext_Dispersive::WriteState(ostream &file) const
+{
+	for (int o=0;o<m_Op_Ext_Disp->m_Order;++o)
+	{
+		for (int n=0; n<3; ++n)
+		{
+			if (curr_ADE[o][n])
+				file.write((const char*)curr_ADE[o][n], sizeof(FDTD_FLOAT)*m_Op_Ext_Disp->m_LM_Count[o]);
+			if (volt_ADE[o][n])
+				file.write((const char*)volt_ADE[o][n], sizeof(FDTD_FLOAT)*m_Op_Ext_Disp->m_LM_Count[o]);
+		}
+	}
+	return file.good();
+}
+
+bool Engine_Ext_Dispersive::ReadState(istream &file)
+{
+	for (int o=0;o<m_Op_Ext_Disp->m_Order;++o)
+	{
+		for (int n=0; n<3; ++n)
+		{
+			if (curr_ADE[o][n])
+				file.read((char*)curr_ADE[o][n], sizeof(FDTD_FLOAT)*m_Op_Ext_Disp->m_LM_Count[o]);
+			if (volt_ADE[o][n])
+				file.read((char*)volt_ADE[o][n], sizeof(FDTD_FLOAT)*m_Op_Ext_Disp->m_LM_Count[o]);
+		}
+	}
+	return file.good();
+}
+
+bool Engine_Ext_Dispersive::GetFootprint(unsigned int &startX, unsigned int &stopX) const
+{
+	bool found = false;
+	startX = (unsigned int)-1;
+	stopX = 0;
+	for (int o=0;o<m_Op_Ext_Disp->m_Order;++o)
+		for (unsigned int i=0; i<m_Op_Ext_Disp->m_LM_Count.at(o); ++i)
+		{
+			startX = min(startX, m_Op_Ext_Disp->m_LM_pos[o][0][i]);
+			stopX = max(stopX, m_Op_Ext_Disp->m_LM_pos[o][0][i]);
+			found = true;
+		}
+	return found;
+}
+
 void Engine_Ext_Dispersive::Apply2Voltages()
 {
 	for (int o=0;o<m_Op_Ext_Disp->m_Order;++o)
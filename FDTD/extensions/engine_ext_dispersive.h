@@ -33,6 +33,12 @@ public:
 	virtual void Apply2Voltages();
 	virtual void Apply2Current();
 
+	virtual int GetUpdateStages() const {return APPLY_VOLTAGE | APPLY_CURRENT;}
+	virtual bool GetFootprint(unsigned int &startX, unsigned int &stopX) const;
+
+	virtual bool WriteState(std::ostream &file) const;
+	virtual bool ReadState(std::istream &file);
+
 protected:
 	Operator_Ext_Dispersive* m_Op_Ext_Disp;
 
@@ -23,6 +23,9 @@ Engine_Ext_Excitation::Engine_Ext_Excitation(Operator_Ext_Excitation* op_ext) :
 {
 	m_Op_Exc = op_ext;
 	m_Priority = ENG_EXT_PRIO_EXCITATION;
+
+	SortByX(m_Op_Exc->Volt_Count, m_Op_Exc->Volt_index[0], m_Volt_Sorted, m_Volt_X_Start);
+	SortByX(m_Op_Exc->Curr_Count, m_Op_Exc->Curr_index[0], m_Curr_Sorted, m_Curr_X_Start);
 }
 
 Engine_Ext_Excitation::~Engine_Ext_Excitation()
@@ -168,3 +171,120 @@ void Engine_Ext_Excitation::Apply2Current()
 		}
 	}
 }
+
+bool Engine_Ext_Excitation::GetFootprint(unsigned int &startX, unsigned int &stopX) const
+{
+	if (m_Volt_Sorted.empty() && m_Curr_Sorted.empty())
+		return false;
+	startX = (unsigned int)-1;
+	stopX = 0;
+	// the indices are sorted by x-position
+	if (!m_Volt_Sorted.empty())
+	{
+		startX = min(startX, m_Op_Exc->Volt_index[0][m_Volt_Sorted.front()]);
+		stopX = max(stopX, m_Op_Exc->Volt_index[0][m_Volt_Sorted.back()]);
+	}
+	if (!m_Curr_Sorted.empty())
+	{
+		startX = min(startX, m_Op_Exc->Curr_index[0][m_Curr_Sorted.front()]);
+		stopX = max(stopX, m_Op_Exc->Curr_index[0][m_Curr_Sorted.back()]);
+	}
+	return true;
+}
+
+void Engine_Ext_Excitation::SortByX(unsigned int count, const unsigned int* index_x, vector<unsigned int> &sorted, vector<unsigned int> &x_start)
+{
+	sorted.clear();
+	x_start.clear();
+	unsigned int maxX = 0;
+	for (unsigned int n=0; n<count; ++n)
+		maxX = max(maxX, index_x[n]);
+
+	// counting sort by x-position
+	x_start.resize(maxX+2, 0);
+	for (unsigned int n=0; n<count; ++n)
+		++x_start.at(index_x[n]+1);
+	for (unsigned int x=1; x<x_start.size(); ++x)
+		x_start.at(x) += x_start.at(x-1);
+
+	sorted.resize(count);
+	vector<unsigned int> fill(x_start.begin(), x_start.end()-1);
+	for (unsigned int n=0; n<count; ++n)
+		sorted.at(fill.at(index_x[n])++) = n;
+}
+
+void Engine_Ext_Excitation::Apply2VoltagesRange(unsigned int startX, unsigned int numX, int timestep)
+{
+	if (m_Volt_Sorted.empty() || (startX+1>=m_Volt_X_Start.size()))
+		return;
+	unsigned int stopX = min(startX+numX, (unsigned int)m_Volt_X_Start.size()-1);
+
+	int exc_pos;
+	unsigned int ny;
+	unsigned int pos[3];
+	unsigned int length = m_Op_Exc->m_Exc->GetLength();
+	FDTD_FLOAT* exc_volt =  m_Op_Exc->m_Exc->GetVoltageSignal();
+
+	int p = timestep+1;
+	if (m_Op_Exc->m_Exc->GetSignalPeriod()>0)
+		p = int(m_Op_Exc->m_Exc->GetSignalPeriod()/m_Op_Exc->m_Exc->GetTimestep());
+
+	Engine_sse* eng_sse = NULL;
+	if (m_Eng->GetType()==Engine::SSE)
+		eng_sse = (Engine_sse*) m_Eng;
+
+	for (unsigned int i=m_Volt_X_Start.at(startX); i<m_Volt_X_Start.at(stopX); ++i)
+	{
+		unsigned int n = m_Volt_Sorted[i];
+		exc_pos = timestep - (int)m_Op_Exc->Volt_delay[n];
+		exc_pos *= (exc_pos>0);
+		exc_pos %= p;
+		exc_pos *= (exc_pos<(int)length);
+		ny = m_Op_Exc->Volt_dir[n];
+		pos[0]=m_Op_Exc->Volt_index[0][n];
+		pos[1]=m_Op_Exc->Volt_index[1][n];
+		pos[2]=m_Op_Exc->Volt_index[2][n];
+		if (eng_sse)
+			eng_sse->Engine_sse::SetVolt(ny,pos, eng_sse->Engine_sse::GetVolt(ny,pos) + m_Op_Exc->Volt_amp[n]*exc_volt[exc_pos]);
+		else
+			m_Eng->SetVolt(ny,pos, m_Eng->GetVolt(ny,pos) + m_Op_Exc->Volt_amp[n]*exc_volt[exc_pos]);
+	}
+}
+
+void Engine_Ext_Excitation::Apply2CurrentRange(unsigned int startX, unsigned int numX, int timestep)
+{
+	if (m_Curr_Sorted.empty() || (startX+1>=m_Curr_X_Start.size()))
+		return;
+	unsigned int stopX = min(startX+numX, (unsigned int)m_Curr_X_Start.size()-1);
+
+	int exc_pos;
+	unsigned int ny;
+	unsigned int pos[3];
+	unsigned int length = m_Op_Exc->m_Exc->GetLength();
+	FDTD_FLOAT* exc_curr =  m_Op_Exc->m_Exc->GetCurrentSignal();
+
+	int p = timestep+1;
+	if (m_Op_Exc->m_Exc->GetSignalPeriod()>0)
+		p = int(m_Op_Exc->m_Exc->GetSignalPeriod()/m_Op_Exc->m_Exc->GetTimestep());
+
+	Engine_sse* eng_sse = NULL;
+	if (m_Eng->GetType()==Engine::SSE)
+		eng_sse = (Engine_sse*) m_Eng;
+
+	for (unsigned int i=m_Curr_X_Start.at(startX); i<m_Curr_X_Start.at(stopX); ++i)
+	{
+		unsigned int n = m_Curr_Sorted[i];
+		exc_pos = timestep - (int)m_Op_Exc->Curr_delay[n];
+		exc_pos *= (exc_pos>0);
+		exc_pos %= p;
+		exc_pos *= (exc_pos<(int)length);
+		ny = m_Op_Exc->Curr_dir[n];
+		pos[0]=m_Op_Exc->Curr_index[0][n];
+		pos[1]=m_Op_Exc->Curr_index[1][n];
+		pos[2]=m_Op_Exc->Curr_index[2][n];
+		if (eng_sse)
+			eng_sse->Engine_sse::SetCurr(ny,pos, eng_sse->Engine_sse::GetCurr(ny,pos) + m_Op_Exc->Curr_amp[n]*exc_curr[exc_pos]);
+		else
+			m_Eng->SetCurr(ny,pos, m_Eng->GetCurr(ny,pos) + m_Op_Exc->Curr_amp[n]*exc_curr[exc_pos]);
+	}
+}
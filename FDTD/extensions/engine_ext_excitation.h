@@ -33,8 +33,21 @@ public:
 	virtual void Apply2Voltages();
 	virtual void Apply2Current();
 
+	virtual int GetUpdateStages() const {return APPLY_VOLTAGE | APPLY_CURRENT;}
+	virtual bool IsTemporalBlockingSafe(const std::vector<unsigned int> &start, const std::vector<unsigned int> &stop) const {UNUSED(start);UNUSED(stop);return true;}
+	virtual void Apply2VoltagesRange(unsigned int startX, unsigned int numX, int timestep);
+	virtual void Apply2CurrentRange(unsigned int startX, unsigned int numX, int timestep);
+	virtual bool GetFootprint(unsigned int &startX, unsigned int &stopX) const;
+
 protected:
 	Operator_Ext_Excitation* m_Op_Exc;
+
+	//! Sort the excitation indices by x-position, x_start[x] is the first entry in sorted for x-line x
+	void SortByX(unsigned int count, const unsigned int* index_x, vector<unsigned int> &sorted, vector<unsigned int> &x_start);
+	vector<unsigned int> m_Volt_Sorted;
+	vector<unsigned int> m_Volt_X_Start;
+	vector<unsigned int> m_Curr_Sorted;
+	vector<unsigned int> m_Curr_X_Start;
 };
 
 #endif // ENGINE_EXT_EXCITATION_H
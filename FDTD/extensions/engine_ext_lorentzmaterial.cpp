@@ -76,6 +76,40 @@ Engine_Ext_LorentzMaterial::~Engine_Ext_LorentzMaterial()
 	volt_Lor_ADE=NULL;
 }
 
+bool Engine_Ext_LorentzMaterial::WriteState(ostream &file) const
+{
+	if (Engine_Ext_Dispersive::WriteState(file)==false)
+		return false;
+	for (int o=0;o<m_Op_Ext_Lor->m_Order;++o)
+	{
+		for (int n=0; n<3; ++n)
+		{
+			if (curr_Lor_ADE[o][n])
+				file.write((const char*)curr_Lor_ADE[o][n], sizeof(FDTD_FLOAT)*m_Op_Ext_Lor->m_LM_Count[o]);
+			if (volt_Lor_ADE[o][n])
+				file.write((const char*)volt_Lor_ADE[o][n], sizeof(FDTD_FLOAT)*m_Op_Ext_Lor->m_LM_Count[o]);
+		}
+	}
+	return file.good();
+}
+
+bool Engine_Ext_LorentzMaterial::ReadState(istream &file)
+{
+	if (Engine_Ext_Dispersive::ReadState(file)==false)
+		return false;
+	for (int o=0;o<m_Op_Ext_Lor->m_Order;++o)
+	{
+		for (int n=0; n<3; ++n)
+		{
+			if (curr_Lor_ADE[o][n])
+				file.read((char*)curr_Lor_ADE[o][n], sizeof(FDTD_FLOAT)*m_Op_Ext_Lor->m_LM_Count[o]);
+			if (volt_Lor_ADE[o][n])
+				file.read((char*)volt_Lor_ADE[o][n], sizeof(FDTD_FLOAT)*m_Op_Ext_Lor->m_LM_Count[o]);
+		}
+	}
+	return file.good();
+}
+
 void Engine_Ext_LorentzMaterial::DoPreVoltageUpdates()
 {
 	for (int o=0;o<m_Order;++o)
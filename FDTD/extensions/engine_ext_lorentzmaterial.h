@@ -32,6 +32,11 @@ public:
 
 	virtual void DoPreCurrentUpdates();
 
+	virtual int GetUpdateStages() const {return Engine_Ext_Dispersive::GetUpdateStages() | PRE_VOLTAGE | PRE_CURRENT;}
+
+	virtual bool WriteState(std::ostream &file) const;
+	virtual bool ReadState(std::istream &file);
+
 protected:
 	Operator_Ext_LorentzMaterial* m_Op_Ext_Lor;
 
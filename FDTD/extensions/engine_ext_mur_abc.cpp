@@ -69,6 +69,25 @@ Engine_Ext_Mur_ABC::~Engine_Ext_Mur_ABC()
 	m_volt_nyPP = NULL;
 }
 
+bool Engine_Ext_Mur_ABC::WriteState(ostream &file) const
+{
+	for (unsigned int i=0; i<m_numLines[0]; ++i)
+	{
+		file.write((const char*)m_volt_nyP[i], sizeof(FDTD_FLOAT)*m_numLines[1]);
+		file.write((const char*)m_volt_nyPP[i], sizeof(FDTD_FLOAT)*m_numLines[1]);
+	}
+	return file.good();
+}
+
+bool Engine_Ext_Mur_ABC::ReadState(istream &file)
+{
+	for (unsigned int i=0; i<m_numLines[0]; ++i)
+	{
+		file.read((char*)m_volt_nyP[i], sizeof(FDTD_FLOAT)*m_numLines[1]);
+		file.read((char*)m_volt_nyPP[i], sizeof(FDTD_FLOAT)*m_numLines[1]);
+	}
+	return file.good();
+}
 
 void Engine_Ext_Mur_ABC::SetNumberOfThreads(int nrThread)
 {
@@ -82,12 +101,72 @@ void Engine_Ext_Mur_ABC::SetNumberOfThreads(int nrThread)
 }
 
 
+bool Engine_Ext_Mur_ABC::IsTemporalBlockingSafe(const std::vector<unsigned int> &start, const std::vector<unsigned int> &stop) const
+{
+	// the y- and z-normal boundaries are local to every x-line
+	if (m_ny!=0)
+		return true;
+	/* The x-normal boundary needs the line m_LineNr and its shifted neighbour within the same x-slab.
+	   Updated line by line, the pre update has to be done before the first of both lines is updated, the post update after the shifted line
+	   and the apply after both lines are updated (see GetLineRange() calls below).
+	*/
+	for (size_t n=0; n<start.size(); ++n)
+		if ((m_LineNr>=start.at(n)) && (m_LineNr<=stop.at(n)))
+			return ((unsigned int)m_LineNr_Shift>=start.at(n)) && ((unsigned int)m_LineNr_Shift<=stop.at(n));
+	return false;
+}
+
+bool Engine_Ext_Mur_ABC::GetFootprint(unsigned int &startX, unsigned int &stopX) const
+{
+	if (m_ny==0)
+	{
+		startX = min(m_LineNr, (unsigned int)m_LineNr_Shift);
+		stopX = max(m_LineNr, (unsigned int)m_LineNr_Shift);
+		return true;
+	}
+	unsigned int numX = (m_nyP==0) ? m_numLines[0] : m_numLines[1];
+	startX = 0;
+	stopX = numX-1;
+	return numX>0;
+}
+
+bool Engine_Ext_Mur_ABC::GetLineRange(unsigned int startX, unsigned int numX, unsigned int lineX, unsigned int range[4]) const
+{
+	range[0] = 0;
+	range[1] = m_numLines[0];
+	range[2] = 0;
+	range[3] = m_numLines[1];
+	if (m_ny==0)
+		return (lineX>=startX) && (lineX<startX+numX);
+
+	// restrict the direction (n+1 or n+2) along x
+	int n = (m_nyP==0) ? 0 : 1;
+	unsigned int stopX = min(startX+numX, m_numLines[n]);
+	if (startX>=stopX)
+		return false;
+	range[2*n] = startX;
+	range[2*n+1] = stopX-startX;
+	return true;
+}
+
 void Engine_Ext_Mur_ABC::DoPreVoltageUpdates(int threadID)
 {
-	if (IsActive()==false) return;
-	if (m_Eng==NULL) return;
 	if (threadID>=m_NrThreads)
 		return;
+	PreVoltageUpdates(m_start.at(threadID), m_numX.at(threadID), 0, m_numLines[1], m_Eng->GetNumberOfTimesteps());
+}
+
+void Engine_Ext_Mur_ABC::DoPreVoltageUpdatesRange(unsigned int startX, unsigned int numX, int timestep)
+{
+	unsigned int range[4];
+	if (GetLineRange(startX, numX, min(m_LineNr, (unsigned int)m_LineNr_Shift), range))
+		PreVoltageUpdates(range[0], range[1], range[2], range[3], timestep);
+}
+
+void Engine_Ext_Mur_ABC::PreVoltageUpdates(unsigned int startP, unsigned int numP, unsigned int startPP, unsigned int numPP, unsigned int timestep)
+{
+	if (IsActive(timestep)==false) return;
+	if (m_Eng==NULL) return;
 	unsigned int pos[] = {0,0,0};
 	unsigned int pos_shift[] = {0,0,0};
 	pos[m_ny] = m_LineNr;
@@ -98,11 +177,11 @@ void Engine_Ext_Mur_ABC::DoPreVoltageUpdates(int threadID)
 	{
 	case Engine::BASIC:
 		{
-			for (unsigned int lineX=0; lineX<m_numX.at(threadID); ++lineX)
+			for (unsigned int lineX=0; lineX<numP; ++lineX)
 			{
-				pos[m_nyP]=lineX+m_start.at(threadID);
+				pos[m_nyP]=lineX+startP;
 				pos_shift[m_nyP] = pos[m_nyP];
-				for (pos[m_nyPP]=0; pos[m_nyPP]<m_numLines[1]; ++pos[m_nyPP])
+				for (pos[m_nyPP]=startPP; pos[m_nyPP]<startPP+numPP; ++pos[m_nyPP])
 				{
 					pos_shift[m_nyPP] = pos[m_nyPP];
 					m_volt_nyP[pos[m_nyP]][pos[m_nyPP]] = m_Eng->Engine::GetVolt(m_nyP,pos_shift) - m_Op_mur->m_Mur_Coeff_nyP[pos[m_nyP]][pos[m_nyPP]] * m_Eng->Engine::GetVolt(m_nyP,pos);
@@ -114,11 +193,11 @@ void Engine_Ext_Mur_ABC::DoPreVoltageUpdates(int threadID)
 	case Engine::SSE:
 		{
 			Engine_sse* eng_sse = (Engine_sse*) m_Eng;
-			for (unsigned int lineX=0; lineX<m_numX.at(threadID); ++lineX)
+			for (unsigned int lineX=0; lineX<numP; ++lineX)
 			{
-				pos[m_nyP]=lineX+m_start.at(threadID);
+				pos[m_nyP]=lineX+startP;
 				pos_shift[m_nyP] = pos[m_nyP];
-				for (pos[m_nyPP]=0; pos[m_nyPP]<m_numLines[1]; ++pos[m_nyPP])
+				for (pos[m_nyPP]=startPP; pos[m_nyPP]<startPP+numPP; ++pos[m_nyPP])
 				{
 					pos_shift[m_nyPP] = pos[m_nyPP];
 					m_volt_nyP[pos[m_nyP]][pos[m_nyPP]] = eng_sse->Engine_sse::GetVolt(m_nyP,pos_shift) - m_Op_mur->m_Mur_Coeff_nyP[pos[m_nyP]][pos[m_nyPP]] * eng_sse->Engine_sse::GetVolt(m_nyP,pos);
@@ -128,11 +207,11 @@ void Engine_Ext_Mur_ABC::DoPreVoltageUpdates(int threadID)
 			break;
 		}
 	default:
-		for (unsigned int lineX=0; lineX<m_numX.at(threadID); ++lineX)
+		for (unsigned int lineX=0; lineX<numP; ++lineX)
 		{
-			pos[m_nyP]=lineX+m_start.at(threadID);
+			pos[m_nyP]=lineX+startP;
 			pos_shift[m_nyP] = pos[m_nyP];
-			for (pos[m_nyPP]=0; pos[m_nyPP]<m_numLines[1]; ++pos[m_nyPP])
+			for (pos[m_nyPP]=startPP; pos[m_nyPP]<startPP+numPP; ++pos[m_nyPP])
 			{
 				pos_shift[m_nyPP] = pos[m_nyPP];
 				m_volt_nyP[pos[m_nyP]][pos[m_nyPP]] = m_Eng->GetVolt(m_nyP,pos_shift) - m_Op_mur->m_Mur_Coeff_nyP[pos[m_nyP]][pos[m_nyPP]] * m_Eng->GetVolt(m_nyP,pos);
@@ -145,10 +224,22 @@ void Engine_Ext_Mur_ABC::DoPreVoltageUpdates(int threadID)
 
 void Engine_Ext_Mur_ABC::DoPostVoltageUpdates(int threadID)
 {
-	if (IsActive()==false) return;
-	if (m_Eng==NULL) return;
 	if (threadID>=m_NrThreads)
 		return;
+	PostVoltageUpdates(m_start.at(threadID), m_numX.at(threadID), 0, m_numLines[1], m_Eng->GetNumberOfTimesteps());
+}
+
+void Engine_Ext_Mur_ABC::DoPostVoltageUpdatesRange(unsigned int startX, unsigned int numX, int timestep)
+{
+	unsigned int range[4];
+	if (GetLineRange(startX, numX, m_LineNr_Shift, range))
+		PostVoltageUpdates(range[0], range[1], range[2], range[3], timestep);
+}
+
+void Engine_Ext_Mur_ABC::PostVoltageUpdates(unsigned int startP, unsigned int numP, unsigned int startPP, unsigned int numPP, unsigned int timestep)
+{
+	if (IsActive(timestep)==false) return;
+	if (m_Eng==NULL) return;
 	unsigned int pos[] = {0,0,0};
 	unsigned int pos_shift[] = {0,0,0};
 	pos[m_ny] = m_LineNr;
@@ -159,11 +250,11 @@ void Engine_Ext_Mur_ABC::DoPostVoltageUpdates(int threadID)
 	{
 	case Engine::BASIC:
 		{
-			for (unsigned int lineX=0; lineX<m_numX.at(threadID); ++lineX)
+			for (unsigned int lineX=0; lineX<numP; ++lineX)
 			{
-				pos[m_nyP]=lineX+m_start.at(threadID);
+				pos[m_nyP]=lineX+startP;
 				pos_shift[m_nyP] = pos[m_nyP];
-				for (pos[m_nyPP]=0; pos[m_nyPP]<m_numLines[1]; ++pos[m_nyPP])
+				for (pos[m_nyPP]=startPP; pos[m_nyPP]<startPP+numPP; ++pos[m_nyPP])
 				{
 					pos_shift[m_nyPP] = pos[m_nyPP];
 					m_volt_nyP[pos[m_nyP]][pos[m_nyPP]] += m_Op_mur->m_Mur_Coeff_nyP[pos[m_nyP]][pos[m_nyPP]] * m_Eng->Engine::GetVolt(m_nyP,pos_shift);
@@ -176,11 +267,11 @@ void Engine_Ext_Mur_ABC::DoPostVoltageUpdates(int threadID)
 	case Engine::SSE:
 		{
 			Engine_sse* eng_sse = (Engine_sse*) m_Eng;
-			for (unsigned int lineX=0; lineX<m_numX.at(threadID); ++lineX)
+			for (unsigned int lineX=0; lineX<numP; ++lineX)
 			{
-				pos[m_nyP]=lineX+m_start.at(threadID);
+				pos[m_nyP]=lineX+startP;
 				pos_shift[m_nyP] = pos[m_nyP];
-				for (pos[m_nyPP]=0; pos[m_nyPP]<m_numLines[1]; ++pos[m_nyPP])
+				for (pos[m_nyPP]=startPP; pos[m_nyPP]<startPP+numPP; ++pos[m_nyPP])
 				{
 					pos_shift[m_nyPP] = pos[m_nyPP];
 					m_volt_nyP[pos[m_nyP]][pos[m_nyPP]] += m_Op_mur->m_Mur_Coeff_nyP[pos[m_nyP]][pos[m_nyPP]] * eng_sse->Engine_sse::GetVolt(m_nyP,pos_shift);
@@ -191,11 +282,11 @@ void Engine_Ext_Mur_ABC::DoPostVoltageUpdates(int threadID)
 		}
 
 	default:
-		for (unsigned int lineX=0; lineX<m_numX.at(threadID); ++lineX)
+		for (unsigned int lineX=0; lineX<numP; ++lineX)
 		{
-			pos[m_nyP]=lineX+m_start.at(threadID);
+			pos[m_nyP]=lineX+startP;
 			pos_shift[m_nyP] = pos[m_nyP];
-			for (pos[m_nyPP]=0; pos[m_nyPP]<m_numLines[1]; ++pos[m_nyPP])
+			for (pos[m_nyPP]=startPP; pos[m_nyPP]<startPP+numPP; ++pos[m_nyPP])
 			{
 				pos_shift[m_nyPP] = pos[m_nyPP];
 				m_volt_nyP[pos[m_nyP]][pos[m_nyPP]] += m_Op_mur->m_Mur_Coeff_nyP[pos[m_nyP]][pos[m_nyPP]] * m_Eng->GetVolt(m_nyP,pos_shift);
@@ -208,9 +299,21 @@ void Engine_Ext_Mur_ABC::DoPostVoltageUpdates(int threadID)
 
 void Engine_Ext_Mur_ABC::Apply2Voltages(int threadID)
 {
-	if (IsActive()==false) return;
 	if (threadID>=m_NrThreads)
 		return;
+	ApplyVoltages(m_start.at(threadID), m_numX.at(threadID), 0, m_numLines[1], m_Eng->GetNumberOfTimesteps());
+}
+
+void Engine_Ext_Mur_ABC::Apply2VoltagesRange(unsigned int startX, unsigned int numX, int timestep)
+{
+	unsigned int range[4];
+	if (GetLineRange(startX, numX, max(m_LineNr, (unsigned int)m_LineNr_Shift), range))
+		ApplyVoltages(range[0], range[1], range[2], range[3], timestep);
+}
+
+void Engine_Ext_Mur_ABC::ApplyVoltages(unsigned int startP, unsigned int numP, unsigned int startPP, unsigned int numPP, unsigned int timestep)
+{
+	if (IsActive(timestep)==false) return;
 	if (m_Eng==NULL) return;
 	unsigned int pos[] = {0,0,0};
 	pos[m_ny] = m_LineNr;
@@ -220,10 +323,10 @@ void Engine_Ext_Mur_ABC::Apply2Voltages(int threadID)
 	{
 	case Engine::BASIC:
 		{
-			for (unsigned int lineX=0; lineX<m_numX.at(threadID); ++lineX)
+			for (unsigned int lineX=0; lineX<numP; ++lineX)
 			{
-				pos[m_nyP]=lineX+m_start.at(threadID);
-				for (pos[m_nyPP]=0; pos[m_nyPP]<m_numLines[1]; ++pos[m_nyPP])
+				pos[m_nyP]=lineX+startP;
+				for (pos[m_nyPP]=startPP; pos[m_nyPP]<startPP+numPP; ++pos[m_nyPP])
 				{
 					m_Eng->Engine::SetVolt(m_nyP,pos, m_volt_nyP[pos[m_nyP]][pos[m_nyPP]]);
 					m_Eng->Engine::SetVolt(m_nyPP,pos, m_volt_nyPP[pos[m_nyP]][pos[m_nyPP]]);
@@ -235,10 +338,10 @@ void Engine_Ext_Mur_ABC::Apply2Voltages(int threadID)
 	case Engine::SSE:
 		{
 			Engine_sse* eng_sse = (Engine_sse*) m_Eng;
-			for (unsigned int lineX=0; lineX<m_numX.at(threadID); ++lineX)
+			for (unsigned int lineX=0; lineX<numP; ++lineX)
 			{
-				pos[m_nyP]=lineX+m_start.at(threadID);
-				for (pos[m_nyPP]=0; pos[m_nyPP]<m_numLines[1]; ++pos[m_nyPP])
+				pos[m_nyP]=lineX+startP;
+				for (pos[m_nyPP]=startPP; pos[m_nyPP]<startPP+numPP; ++pos[m_nyPP])
 				{
 					eng_sse->Engine_sse::SetVolt(m_nyP,pos, m_volt_nyP[pos[m_nyP]][pos[m_nyPP]]);
 					eng_sse->Engine_sse::SetVolt(m_nyPP,pos, m_volt_nyPP[pos[m_nyP]][pos[m_nyPP]]);
@@ -248,10 +351,10 @@ void Engine_Ext_Mur_ABC::Apply2Voltages(int threadID)
 		}
 
 	default:
-		for (unsigned int lineX=0; lineX<m_numX.at(threadID); ++lineX)
+		for (unsigned int lineX=0; lineX<numP; ++lineX)
 		{
-			pos[m_nyP]=lineX+m_start.at(threadID);
-			for (pos[m_nyPP]=0; pos[m_nyPP]<m_numLines[1]; ++pos[m_nyPP])
+			pos[m_nyP]=lineX+startP;
+			for (pos[m_nyPP]=startPP; pos[m_nyPP]<startPP+numPP; ++pos[m_nyPP])
 			{
 				m_Eng->SetVolt(m_nyP,pos, m_volt_nyP[pos[m_nyP]][pos[m_nyPP]]);
 				m_Eng->SetVolt(m_nyPP,pos, m_volt_nyPP[pos[m_nyP]][pos[m_nyPP]]);
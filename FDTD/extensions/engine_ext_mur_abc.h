@@ -39,10 +39,29 @@ public:
 	virtual void Apply2Voltages() {Engine_Ext_Mur_ABC::Apply2Voltages(0);}
 	virtual void Apply2Voltages(int threadID);
 
+	virtual int GetUpdateStages() const {return PRE_VOLTAGE | POST_VOLTAGE | APPLY_VOLTAGE;}
+	virtual bool IsTemporalBlockingSafe(const std::vector<unsigned int> &start, const std::vector<unsigned int> &stop) const;
+	virtual bool GetFootprint(unsigned int &startX, unsigned int &stopX) const;
+	virtual void DoPreVoltageUpdatesRange(unsigned int startX, unsigned int numX, int timestep);
+	virtual void DoPostVoltageUpdatesRange(unsigned int startX, unsigned int numX, int timestep);
+	virtual void Apply2VoltagesRange(unsigned int startX, unsigned int numX, int timestep);
+
+	virtual bool WriteState(std::ostream &file) const;
+	virtual bool ReadState(std::istream &file);
+
 protected:
 	Operator_Ext_Mur_ABC* m_Op_mur;
 
-	inline bool IsActive() {if (m_Eng->GetNumberOfTimesteps()<m_start_TS) return false; return true;}
+	/*! Get the lines of the boundary plane within the x-lines [startX, startX+numX) as start and number of lines in n+1 and n+2 direction.
+	  The x-normal boundary plane is updated as a whole if the x-line \a lineX is within the range, see IsTemporalBlockingSafe()
+	  */
+	bool GetLineRange(unsigned int startX, unsigned int numX, unsigned int lineX, unsigned int range[4]) const;
+	//! Do the updates for the given lines in n+1 and n+2 direction of the boundary plane
+	void PreVoltageUpdates(unsigned int startP, unsigned int numP, unsigned int startPP, unsigned int numPP, unsigned int timestep);
+	void PostVoltageUpdates(unsigned int startP, unsigned int numP, unsigned int startPP, unsigned int numPP, unsigned int timestep);
+	void ApplyVoltages(unsigned int startP, unsigned int numP, unsigned int startPP, unsigned int numPP, unsigned int timestep);
+
+	inline bool IsActive(unsigned int timestep) const {if (timestep<m_start_TS) return false; return true;}
 	unsigned int m_start_TS;
 
 	int m_ny;
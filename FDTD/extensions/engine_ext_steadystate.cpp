@@ -47,6 +47,24 @@ Engine_Ext_SteadyState::~Engine_Ext_SteadyState()
 	m_Eng_Interface = NULL;
 }
 
+bool Engine_Ext_SteadyState::WriteState(ostream &file) const
+{
+	file.write((const char*)&m_last_max_diff, sizeof(m_last_max_diff));
+	file.write((const char*)&last_total_energy, sizeof(last_total_energy));
+	for (size_t n=0;n<m_E_records.size();++n)
+		file.write((const char*)m_E_records.at(n), sizeof(double)*m_Op_SS->m_TS_period*2);
+	return file.good();
+}
+
+bool Engine_Ext_SteadyState::ReadState(istream &file)
+{
+	file.read((char*)&m_last_max_diff, sizeof(m_last_max_diff));
+	file.read((char*)&last_total_energy, sizeof(last_total_energy));
+	for (size_t n=0;n<m_E_records.size();++n)
+		file.read((char*)m_E_records.at(n), sizeof(double)*m_Op_SS->m_TS_period*2);
+	return file.good();
+}
+
 void Engine_Ext_SteadyState::Apply2Voltages()
 {
 	unsigned int p = m_Op_SS->m_TS_period;
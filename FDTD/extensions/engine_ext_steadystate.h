@@ -34,9 +34,15 @@ public:
 	virtual void Apply2Voltages();
 	virtual void Apply2Current();
 
+	//! The steady state check records the probes and calculates the total energy in the voltage apply stage
+	virtual int GetUpdateStages() const {return APPLY_VOLTAGE;}
+
 	void SetEngineInterface(Engine_Interface_FDTD* eng_if) {m_Eng_Interface=eng_if;}
 	double GetLastDiff() {return m_last_max_diff;}
 
+	virtual bool WriteState(std::ostream &file) const;
+	virtual bool ReadState(std::istream &file);
+
 protected:
 	Operator_Ext_SteadyState* m_Op_SS;
 	double m_last_max_diff;
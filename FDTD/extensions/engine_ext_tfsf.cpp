@@ -33,6 +33,14 @@ Engine_Ext_TFSF::~Engine_Ext_TFSF()
 	m_DelayLookup = NULL;
 }
 
+bool Engine_Ext_TFSF::GetFootprint(unsigned int &startX, unsigned int &stopX) const
+{
+	// the currents of the lower x-plane are located one line below the tfsf box
+	startX = m_Op_TFSF->m_Start[0]>0 ? m_Op_TFSF->m_Start[0]-1 : 0;
+	stopX = m_Op_TFSF->m_Stop[0];
+	return true;
+}
+
 void Engine_Ext_TFSF::DoPostVoltageUpdates()
 {
 	unsigned int numTS = m_Eng->GetNumberOfTimesteps();
@@ -31,6 +31,9 @@ public:
 	virtual void DoPostVoltageUpdates();
 	virtual void DoPostCurrentUpdates();
 
+	virtual int GetUpdateStages() const {return POST_VOLTAGE | POST_CURRENT;}
+	virtual bool GetFootprint(unsigned int &startX, unsigned int &stopX) const;
+
 protected:
 	Operator_Ext_TFSF* m_Op_TFSF;
 
@@ -32,11 +32,23 @@ Engine_Ext_UPML::Engine_Ext_UPML(Operator_Ext_UPML* op_ext) : Engine_Extension(o
 	volt_flux = Create_N_3DArray<FDTD_FLOAT>(m_Op_UPML->m_numLines);
 	curr_flux = Create_N_3DArray<FDTD_FLOAT>(m_Op_UPML->m_numLines);
 
+	m_VectorUpdate = false;
+	m_numVectors = 0;
+	f4_volt_flux = NULL;
+	f4_curr_flux = NULL;
+	f4_vv = NULL;
+	f4_vvfo = NULL;
+	f4_vvfn = NULL;
+	f4_ii = NULL;
+	f4_iifo = NULL;
+	f4_iifn = NULL;
+
 	SetNumberOfThreads(1);
 }
 
 Engine_Ext_UPML::~Engine_Ext_UPML()
 {
+	DeleteVectorArrays();
 	Delete_N_3DArray<FDTD_FLOAT>(volt_flux,m_Op_UPML->m_numLines);
 	volt_flux=NULL;
 	Delete_N_3DArray<FDTD_FLOAT>(curr_flux,m_Op_UPML->m_numLines);
@@ -54,13 +66,143 @@ void Engine_Ext_UPML::SetNumberOfThreads(int nrThread)
 		m_start.at(n) = m_start.at(n-1) + m_numX.at(n-1);
 }
 
+void Engine_Ext_UPML::SetEngine(Engine* eng)
+{
+	Engine_Extension::SetEngine(eng);
+
+	bool vectorUpdate = false;
+	m_zVector.clear();
+	m_zLane.clear();
+	if ((m_Eng!=NULL) && (m_Eng->GetType()==Engine::SSE))
+	{
+		unsigned int numZ = m_Op_UPML->m_Op->GetNumberOfLines(2,true);
+		unsigned int numVectors = ceil((double)numZ/4.0);
+		for (unsigned int z=0; z<m_Op_UPML->m_numLines[2]; ++z)
+		{
+			m_zVector.push_back((z+m_Op_UPML->m_StartPos[2])%numVectors);
+			m_zLane.push_back((z+m_Op_UPML->m_StartPos[2])/numVectors);
+		}
+		// the vector layout of this pml is identical to the engine if all z-lines are included
+		vectorUpdate = (m_Op_UPML->m_StartPos[2]==0) && (m_Op_UPML->m_numLines[2]==numZ);
+	}
+	if (!vectorUpdate)
+		m_Op_UPML->BuildScalarCoefficients();
+
+	if (vectorUpdate && !m_VectorUpdate)
+	{
+		CreateVectorArrays();
+		m_Op_UPML->CopyToVectors(volt_flux, f4_volt_flux);
+		m_Op_UPML->CopyToVectors(curr_flux, f4_curr_flux);
+		Delete_N_3DArray<FDTD_FLOAT>(volt_flux,m_Op_UPML->m_numLines);
+		volt_flux=NULL;
+		Delete_N_3DArray<FDTD_FLOAT>(curr_flux,m_Op_UPML->m_numLines);
+		curr_flux=NULL;
+	}
+	else if (!vectorUpdate && m_VectorUpdate)
+	{
+		volt_flux = Create_N_3DArray<FDTD_FLOAT>(m_Op_UPML->m_numLines);
+		curr_flux = Create_N_3DArray<FDTD_FLOAT>(m_Op_UPML->m_numLines);
+		m_Op_UPML->CopyFromVectors(f4_volt_flux, volt_flux);
+		m_Op_UPML->CopyFromVectors(f4_curr_flux, curr_flux);
+		DeleteVectorArrays();
+	}
+}
+
+void Engine_Ext_UPML::CreateVectorArrays()
+{
+	// the coefficients in the vector layout are built once by the operator and shared by all engines
+	m_Op_UPML->BuildVectorCoefficients();
+	m_numVectors = m_Op_UPML->m_numVectors;
+	f4_vv = m_Op_UPML->f4_vv;
+	f4_vvfo = m_Op_UPML->f4_vvfo;
+	f4_vvfn = m_Op_UPML->f4_vvfn;
+	f4_ii = m_Op_UPML->f4_ii;
+	f4_iifo = m_Op_UPML->f4_iifo;
+	f4_iifn = m_Op_UPML->f4_iifn;
+	f4_volt_flux = Create_N_3DArray_v4sf(m_Op_UPML->m_numLines);
+	f4_curr_flux = Create_N_3DArray_v4sf(m_Op_UPML->m_numLines);
+	m_VectorUpdate = true;
+}
+
+void Engine_Ext_UPML::DeleteVectorArrays()
+{
+	Delete_N_3DArray_v4sf(f4_volt_flux,m_Op_UPML->m_numLines);
+	f4_volt_flux = NULL;
+	Delete_N_3DArray_v4sf(f4_curr_flux,m_Op_UPML->m_numLines);
+	f4_curr_flux = NULL;
+	// the coefficients are owned by the operator
+	f4_vv = NULL;
+	f4_vvfo = NULL;
+	f4_vvfn = NULL;
+	f4_ii = NULL;
+	f4_iifo = NULL;
+	f4_iifn = NULL;
+	m_VectorUpdate = false;
+}
+
+bool Engine_Ext_UPML::WriteState(ostream &file) const
+{
+	if (m_VectorUpdate)
+	{
+		// always store the fluxes in the scalar layout
+		FDTD_FLOAT**** flux = Create_N_3DArray<FDTD_FLOAT>(m_Op_UPML->m_numLines);
+		m_Op_UPML->CopyFromVectors(f4_volt_flux, flux);
+		Write_N_3DArray(file, flux, m_Op_UPML->m_numLines);
+		m_Op_UPML->CopyFromVectors(f4_curr_flux, flux);
+		Write_N_3DArray(file, flux, m_Op_UPML->m_numLines);
+		Delete_N_3DArray<FDTD_FLOAT>(flux,m_Op_UPML->m_numLines);
+		return file.good();
+	}
+	Write_N_3DArray(file, volt_flux, m_Op_UPML->m_numLines);
+	Write_N_3DArray(file, curr_flux, m_Op_UPML->m_numLines);
+	return file.good();
+}
+
+bool Engine_Ext_UPML::ReadState(istream &file)
+{
+	if (m_VectorUpdate)
+	{
+		FDTD_FLOAT**** flux = Create_N_3DArray<FDTD_FLOAT>(m_Op_UPML->m_numLines);
+		Read_N_3DArray(file, flux, m_Op_UPML->m_numLines);
+		m_Op_UPML->CopyToVectors(flux, f4_volt_flux);
+		Read_N_3DArray(file, flux, m_Op_UPML->m_numLines);
+		m_Op_UPML->CopyToVectors(flux, f4_curr_flux);
+		Delete_N_3DArray<FDTD_FLOAT>(flux,m_Op_UPML->m_numLines);
+		return file.good();
+	}
+	Read_N_3DArray(file, volt_flux, m_Op_UPML->m_numLines);
+	Read_N_3DArray(file, curr_flux, m_Op_UPML->m_numLines);
+	return file.good();
+}
+
+bool Engine_Ext_UPML::GetFootprint(unsigned int &startX, unsigned int &stopX) const
+{
+	startX = m_Op_UPML->m_StartPos[0];
+	stopX = m_Op_UPML->m_StartPos[0] + m_Op_UPML->m_numLines[0] - 1;
+	return m_Op_UPML->m_numLines[0]>0;
+}
 
 void Engine_Ext_UPML::DoPreVoltageUpdates(int threadID)
 {
-	if (m_Eng==NULL)
+	if (threadID>=m_NrThreads)
 		return;
+	PreVoltageUpdates(m_start.at(threadID), m_numX.at(threadID));
+}
 
-	if (threadID>=m_NrThreads)
+void Engine_Ext_UPML::DoPreVoltageUpdatesRange(unsigned int startX, unsigned int numX, int timestep)
+{
+	UNUSED(timestep);
+	// convert to the local x-range of this pml
+	unsigned int stopX = min(startX+numX, m_Op_UPML->m_StartPos[0]+m_Op_UPML->m_numLines[0]);
+	startX = max(startX, m_Op_UPML->m_StartPos[0]);
+	if (startX>=stopX)
+		return;
+	PreVoltageUpdates(startX-m_Op_UPML->m_StartPos[0], stopX-startX);
+}
+
+void Engine_Ext_UPML::PreVoltageUpdates(unsigned int startX, unsigned int numX)
+{
+	if (m_Eng==NULL)
 		return;
 
 	unsigned int pos[3];
@@ -70,9 +212,9 @@ void Engine_Ext_UPML::DoPreVoltageUpdates(int threadID)
 	{
 	case Engine::BASIC:
 		{
-			for (unsigned int lineX=0; lineX<m_numX.at(threadID); ++lineX)
+			for (unsigned int lineX=0; lineX<numX; ++lineX)
 			{
-				loc_pos[0]=lineX+m_start.at(threadID);
+				loc_pos[0]=lineX+startX;
 				pos[0] = loc_pos[0] + m_Op_UPML->m_StartPos[0];
 				for (loc_pos[1]=0; loc_pos[1]<m_Op_UPML->m_numLines[1]; ++loc_pos[1])
 				{
@@ -102,32 +244,32 @@ void Engine_Ext_UPML::DoPreVoltageUpdates(int threadID)
 		}
 	case Engine::SSE:
 		{
+			if (m_VectorUpdate)
+			{
+				PreVoltageUpdatesVector(startX, numX);
+				break;
+			}
+			// direct access of the z-lines using the precomputed vector index and lane
 			Engine_sse* eng_sse = (Engine_sse*) m_Eng;
-			for (unsigned int lineX=0; lineX<m_numX.at(threadID); ++lineX)
+			f4vector* volt_line;
+			for (unsigned int lineX=0; lineX<numX; ++lineX)
 			{
-				loc_pos[0]=lineX+m_start.at(threadID);
+				loc_pos[0]=lineX+startX;
 				pos[0] = loc_pos[0] + m_Op_UPML->m_StartPos[0];
 				for (loc_pos[1]=0; loc_pos[1]<m_Op_UPML->m_numLines[1]; ++loc_pos[1])
 				{
 					pos[1] = loc_pos[1] + m_Op_UPML->m_StartPos[1];
-					for (loc_pos[2]=0; loc_pos[2]<m_Op_UPML->m_numLines[2]; ++loc_pos[2])
+					for (int n=0; n<3; ++n)
 					{
-						pos[2] = loc_pos[2] + m_Op_UPML->m_StartPos[2];
-
-						f_help = m_Op_UPML->vv[0][loc_pos[0]][loc_pos[1]][loc_pos[2]]   * eng_sse->Engine_sse::GetVolt(0,pos)
-						         - m_Op_UPML->vvfo[0][loc_pos[0]][loc_pos[1]][loc_pos[2]] * volt_flux[0][loc_pos[0]][loc_pos[1]][loc_pos[2]];
-						eng_sse->Engine_sse::SetVolt(0,pos, volt_flux[0][loc_pos[0]][loc_pos[1]][loc_pos[2]]);
-						volt_flux[0][loc_pos[0]][loc_pos[1]][loc_pos[2]] = f_help;
-
-						f_help = m_Op_UPML->vv[1][loc_pos[0]][loc_pos[1]][loc_pos[2]]   * eng_sse->Engine_sse::GetVolt(1,pos)
-						         - m_Op_UPML->vvfo[1][loc_pos[0]][loc_pos[1]][loc_pos[2]] * volt_flux[1][loc_pos[0]][loc_pos[1]][loc_pos[2]];
-						eng_sse->Engine_sse::SetVolt(1,pos, volt_flux[1][loc_pos[0]][loc_pos[1]][loc_pos[2]]);
-						volt_flux[1][loc_pos[0]][loc_pos[1]][loc_pos[2]] = f_help;
-
-						f_help = m_Op_UPML->vv[2][loc_pos[0]][loc_pos[1]][loc_pos[2]]   * eng_sse->Engine_sse::GetVolt(2,pos)
-						         - m_Op_UPML->vvfo[2][loc_pos[0]][loc_pos[1]][loc_pos[2]] * volt_flux[2][loc_pos[0]][loc_pos[1]][loc_pos[2]];
-						eng_sse->Engine_sse::SetVolt(2,pos, volt_flux[2][loc_pos[0]][loc_pos[1]][loc_pos[2]]);
-						volt_flux[2][loc_pos[0]][loc_pos[1]][loc_pos[2]] = f_help;
+						volt_line = eng_sse->f4_volt[n][pos[0]][pos[1]];
+						for (loc_pos[2]=0; loc_pos[2]<m_Op_UPML->m_numLines[2]; ++loc_pos[2])
+						{
+							FDTD_FLOAT &value = volt_line[m_zVector[loc_pos[2]]].f[m_zLane[loc_pos[2]]];
+							f_help = m_Op_UPML->vv[n][loc_pos[0]][loc_pos[1]][loc_pos[2]]   * value
+							         - m_Op_UPML->vvfo[n][loc_pos[0]][loc_pos[1]][loc_pos[2]] * volt_flux[n][loc_pos[0]][loc_pos[1]][loc_pos[2]];
+							value = volt_flux[n][loc_pos[0]][loc_pos[1]][loc_pos[2]];
+							volt_flux[n][loc_pos[0]][loc_pos[1]][loc_pos[2]] = f_help;
+						}
 					}
 				}
 			}
@@ -135,9 +277,9 @@ void Engine_Ext_UPML::DoPreVoltageUpdates(int threadID)
 		}
 	default:
 		{
-			for (unsigned int lineX=0; lineX<m_numX.at(threadID); ++lineX)
+			for (unsigned int lineX=0; lineX<numX; ++lineX)
 			{
-				loc_pos[0]=lineX+m_start.at(threadID);
+				loc_pos[0]=lineX+startX;
 				pos[0] = loc_pos[0] + m_Op_UPML->m_StartPos[0];
 				for (loc_pos[1]=0; loc_pos[1]<m_Op_UPML->m_numLines[1]; ++loc_pos[1])
 				{
@@ -171,10 +313,26 @@ void Engine_Ext_UPML::DoPreVoltageUpdates(int threadID)
 
 void Engine_Ext_UPML::DoPostVoltageUpdates(int threadID)
 {
-	if (m_Eng==NULL)
-		return;
 	if (threadID>=m_NrThreads)
 		return;
+	PostVoltageUpdates(m_start.at(threadID), m_numX.at(threadID));
+}
+
+void Engine_Ext_UPML::DoPostVoltageUpdatesRange(unsigned int startX, unsigned int numX, int timestep)
+{
+	UNUSED(timestep);
+	// convert to the local x-range of this pml
+	unsigned int stopX = min(startX+numX, m_Op_UPML->m_StartPos[0]+m_Op_UPML->m_numLines[0]);
+	startX = max(startX, m_Op_UPML->m_StartPos[0]);
+	if (startX>=stopX)
+		return;
+	PostVoltageUpdates(startX-m_Op_UPML->m_StartPos[0], stopX-startX);
+}
+
+void Engine_Ext_UPML::PostVoltageUpdates(unsigned int startX, unsigned int numX)
+{
+	if (m_Eng==NULL)
+		return;
 
 	unsigned int pos[3];
 	unsigned int loc_pos[3];
@@ -184,9 +342,9 @@ void Engine_Ext_UPML::DoPostVoltageUpdates(int threadID)
 	{
 	case Engine::BASIC:
 		{
-			for (unsigned int lineX=0; lineX<m_numX.at(threadID); ++lineX)
+			for (unsigned int lineX=0; lineX<numX; ++lineX)
 			{
-				loc_pos[0]=lineX+m_start.at(threadID);
+				loc_pos[0]=lineX+startX;
 				pos[0] = loc_pos[0] + m_Op_UPML->m_StartPos[0];
 				for (loc_pos[1]=0; loc_pos[1]<m_Op_UPML->m_numLines[1]; ++loc_pos[1])
 				{
@@ -213,29 +371,31 @@ void Engine_Ext_UPML::DoPostVoltageUpdates(int threadID)
 		}
 	case Engine::SSE:
 		{
+			if (m_VectorUpdate)
+			{
+				PostVoltageUpdatesVector(startX, numX);
+				break;
+			}
+			// direct access of the z-lines using the precomputed vector index and lane
 			Engine_sse* eng_sse = (Engine_sse*) m_Eng;
-			for (unsigned int lineX=0; lineX<m_numX.at(threadID); ++lineX)
+			f4vector* volt_line;
+			for (unsigned int lineX=0; lineX<numX; ++lineX)
 			{
-				loc_pos[0]=lineX+m_start.at(threadID);
+				loc_pos[0]=lineX+startX;
 				pos[0] = loc_pos[0] + m_Op_UPML->m_StartPos[0];
 				for (loc_pos[1]=0; loc_pos[1]<m_Op_UPML->m_numLines[1]; ++loc_pos[1])
 				{
 					pos[1] = loc_pos[1] + m_Op_UPML->m_StartPos[1];
-					for (loc_pos[2]=0; loc_pos[2]<m_Op_UPML->m_numLines[2]; ++loc_pos[2])
+					for (int n=0; n<3; ++n)
 					{
-						pos[2] = loc_pos[2] + m_Op_UPML->m_StartPos[2];
-
-						f_help = volt_flux[0][loc_pos[0]][loc_pos[1]][loc_pos[2]];
-						volt_flux[0][loc_pos[0]][loc_pos[1]][loc_pos[2]] = eng_sse->Engine_sse::GetVolt(0,pos);
-						eng_sse->Engine_sse::SetVolt(0,pos, f_help + m_Op_UPML->vvfn[0][loc_pos[0]][loc_pos[1]][loc_pos[2]] * volt_flux[0][loc_pos[0]][loc_pos[1]][loc_pos[2]]);
-
-						f_help = volt_flux[1][loc_pos[0]][loc_pos[1]][loc_pos[2]];
-						volt_flux[1][loc_pos[0]][loc_pos[1]][loc_pos[2]] = eng_sse->Engine_sse::GetVolt(1,pos);
-						eng_sse->Engine_sse::SetVolt(1,pos, f_help + m_Op_UPML->vvfn[1][loc_pos[0]][loc_pos[1]][loc_pos[2]] * volt_flux[1][loc_pos[0]][loc_pos[1]][loc_pos[2]]);
-
-						f_help = volt_flux[2][loc_pos[0]][loc_pos[1]][loc_pos[2]];
-						volt_flux[2][loc_pos[0]][loc_pos[1]][loc_pos[2]] = eng_sse->Engine_sse::GetVolt(2,pos);
-						eng_sse->Engine_sse::SetVolt(2,pos, f_help + m_Op_UPML->vvfn[2][loc_pos[0]][loc_pos[1]][loc_pos[2]] * volt_flux[2][loc_pos[0]][loc_pos[1]][loc_pos[2]]);
+						volt_line = eng_sse->f4_volt[n][pos[0]][pos[1]];
+						for (loc_pos[2]=0; loc_pos[2]<m_Op_UPML->m_numLines[2]; ++loc_pos[2])
+						{
+							FDTD_FLOAT &value = volt_line[m_zVector[loc_pos[2]]].f[m_zLane[loc_pos[2]]];
+							f_help = volt_flux[n][loc_pos[0]][loc_pos[1]][loc_pos[2]];
+							volt_flux[n][loc_pos[0]][loc_pos[1]][loc_pos[2]] = value;
+							value = f_help + m_Op_UPML->vvfn[n][loc_pos[0]][loc_pos[1]][loc_pos[2]] * volt_flux[n][loc_pos[0]][loc_pos[1]][loc_pos[2]];
+						}
 					}
 				}
 			}
@@ -243,9 +403,9 @@ void Engine_Ext_UPML::DoPostVoltageUpdates(int threadID)
 		}
 	default:
 		{
-			for (unsigned int lineX=0; lineX<m_numX.at(threadID); ++lineX)
+			for (unsigned int lineX=0; lineX<numX; ++lineX)
 			{
-				loc_pos[0]=lineX+m_start.at(threadID);
+				loc_pos[0]=lineX+startX;
 				pos[0] = loc_pos[0] + m_Op_UPML->m_StartPos[0];
 				for (loc_pos[1]=0; loc_pos[1]<m_Op_UPML->m_numLines[1]; ++loc_pos[1])
 				{
@@ -276,10 +436,26 @@ void Engine_Ext_UPML::DoPostVoltageUpdates(int threadID)
 
 void Engine_Ext_UPML::DoPreCurrentUpdates(int threadID)
 {
-	if (m_Eng==NULL)
-		return;
 	if (threadID>=m_NrThreads)
 		return;
+	PreCurrentUpdates(m_start.at(threadID), m_numX.at(threadID));
+}
+
+void Engine_Ext_UPML::DoPreCurrentUpdatesRange(unsigned int startX, unsigned int numX, int timestep)
+{
+	UNUSED(timestep);
+	// convert to the local x-range of this pml
+	unsigned int stopX = min(startX+numX, m_Op_UPML->m_StartPos[0]+m_Op_UPML->m_numLines[0]);
+	startX = max(startX, m_Op_UPML->m_StartPos[0]);
+	if (startX>=stopX)
+		return;
+	PreCurrentUpdates(startX-m_Op_UPML->m_StartPos[0], stopX-startX);
+}
+
+void Engine_Ext_UPML::PreCurrentUpdates(unsigned int startX, unsigned int numX)
+{
+	if (m_Eng==NULL)
+		return;
 
 	unsigned int pos[3];
 	unsigned int loc_pos[3];
@@ -289,9 +465,9 @@ void Engine_Ext_UPML::DoPreCurrentUpdates(int threadID)
 	{
 	case Engine::BASIC:
 		{
-			for (unsigned int lineX=0; lineX<m_numX.at(threadID); ++lineX)
+			for (unsigned int lineX=0; lineX<numX; ++lineX)
 			{
-				loc_pos[0]=lineX+m_start.at(threadID);
+				loc_pos[0]=lineX+startX;
 				pos[0] = loc_pos[0] + m_Op_UPML->m_StartPos[0];
 				for (loc_pos[1]=0; loc_pos[1]<m_Op_UPML->m_numLines[1]; ++loc_pos[1])
 				{
@@ -321,33 +497,32 @@ void Engine_Ext_UPML::DoPreCurrentUpdates(int threadID)
 		}
 	case Engine::SSE:
 		{
+			if (m_VectorUpdate)
+			{
+				PreCurrentUpdatesVector(startX, numX);
+				break;
+			}
+			// direct access of the z-lines using the precomputed vector index and lane
 			Engine_sse* eng_sse = (Engine_sse*) m_Eng;
-			for (unsigned int lineX=0; lineX<m_numX.at(threadID); ++lineX)
+			f4vector* curr_line;
+			for (unsigned int lineX=0; lineX<numX; ++lineX)
 			{
-				loc_pos[0]=lineX+m_start.at(threadID);
+				loc_pos[0]=lineX+startX;
 				pos[0] = loc_pos[0] + m_Op_UPML->m_StartPos[0];
 				for (loc_pos[1]=0; loc_pos[1]<m_Op_UPML->m_numLines[1]; ++loc_pos[1])
 				{
 					pos[1] = loc_pos[1] + m_Op_UPML->m_StartPos[1];
-					for (loc_pos[2]=0; loc_pos[2]<m_Op_UPML->m_numLines[2]; ++loc_pos[2])
+					for (int n=0; n<3; ++n)
 					{
-						pos[2] = loc_pos[2] + m_Op_UPML->m_StartPos[2];
-
-						f_help = m_Op_UPML->ii[0][loc_pos[0]][loc_pos[1]][loc_pos[2]]   * eng_sse->Engine_sse::GetCurr(0,pos)
-						         - m_Op_UPML->iifo[0][loc_pos[0]][loc_pos[1]][loc_pos[2]] * curr_flux[0][loc_pos[0]][loc_pos[1]][loc_pos[2]];
-						eng_sse->Engine_sse::SetCurr(0,pos, curr_flux[0][loc_pos[0]][loc_pos[1]][loc_pos[2]]);
-						curr_flux[0][loc_pos[0]][loc_pos[1]][loc_pos[2]] = f_help;
-
-						f_help = m_Op_UPML->ii[1][loc_pos[0]][loc_pos[1]][loc_pos[2]]   * eng_sse->Engine_sse::GetCurr(1,pos)
-						         - m_Op_UPML->iifo[1][loc_pos[0]][loc_pos[1]][loc_pos[2]] * curr_flux[1][loc_pos[0]][loc_pos[1]][loc_pos[2]];
-						eng_sse->Engine_sse::SetCurr(1,pos, curr_flux[1][loc_pos[0]][loc_pos[1]][loc_pos[2]]);
-						curr_flux[1][loc_pos[0]][loc_pos[1]][loc_pos[2]] = f_help;
-
-						f_help = m_Op_UPML->ii[2][loc_pos[0]][loc_pos[1]][loc_pos[2]]   * eng_sse->Engine_sse::GetCurr(2,pos)
-						         - m_Op_UPML->iifo[2][loc_pos[0]][loc_pos[1]][loc_pos[2]] * curr_flux[2][loc_pos[0]][loc_pos[1]][loc_pos[2]];
-						eng_sse->Engine_sse::SetCurr(2,pos, curr_flux[2][loc_pos[0]][loc_pos[1]][loc_pos[2]]);
-						curr_flux[2][loc_pos[0]][loc_pos[1]][loc_pos[2]] = f_help;
-
+						curr_line = eng_sse->f4_curr[n][pos[0]][pos[1]];
+						for (loc_pos[2]=0; loc_pos[2]<m_Op_UPML->m_numLines[2]; ++loc_pos[2])
+						{
+							FDTD_FLOAT &value = curr_line[m_zVector[loc_pos[2]]].f[m_zLane[loc_pos[2]]];
+							f_help = m_Op_UPML->ii[n][loc_pos[0]][loc_pos[1]][loc_pos[2]]   * value
+							         - m_Op_UPML->iifo[n][loc_pos[0]][loc_pos[1]][loc_pos[2]] * curr_flux[n][loc_pos[0]][loc_pos[1]][loc_pos[2]];
+							value = curr_flux[n][loc_pos[0]][loc_pos[1]][loc_pos[2]];
+							curr_flux[n][loc_pos[0]][loc_pos[1]][loc_pos[2]] = f_help;
+						}
 					}
 				}
 			}
@@ -355,9 +530,9 @@ void Engine_Ext_UPML::DoPreCurrentUpdates(int threadID)
 		}
 	default:
 		{
-			for (unsigned int lineX=0; lineX<m_numX.at(threadID); ++lineX)
+			for (unsigned int lineX=0; lineX<numX; ++lineX)
 			{
-				loc_pos[0]=lineX+m_start.at(threadID);
+				loc_pos[0]=lineX+startX;
 				pos[0] = loc_pos[0] + m_Op_UPML->m_StartPos[0];
 				for (loc_pos[1]=0; loc_pos[1]<m_Op_UPML->m_numLines[1]; ++loc_pos[1])
 				{
@@ -390,10 +565,26 @@ void Engine_Ext_UPML::DoPreCurrentUpdates(int threadID)
 
 void Engine_Ext_UPML::DoPostCurrentUpdates(int threadID)
 {
-	if (m_Eng==NULL)
-		return;
 	if (threadID>=m_NrThreads)
 		return;
+	PostCurrentUpdates(m_start.at(threadID), m_numX.at(threadID));
+}
+
+void Engine_Ext_UPML::DoPostCurrentUpdatesRange(unsigned int startX, unsigned int numX, int timestep)
+{
+	UNUSED(timestep);
+	// convert to the local x-range of this pml
+	unsigned int stopX = min(startX+numX, m_Op_UPML->m_StartPos[0]+m_Op_UPML->m_numLines[0]);
+	startX = max(startX, m_Op_UPML->m_StartPos[0]);
+	if (startX>=stopX)
+		return;
+	PostCurrentUpdates(startX-m_Op_UPML->m_StartPos[0], stopX-startX);
+}
+
+void Engine_Ext_UPML::PostCurrentUpdates(unsigned int startX, unsigned int numX)
+{
+	if (m_Eng==NULL)
+		return;
 
 	unsigned int pos[3];
 	unsigned int loc_pos[3];
@@ -403,9 +594,9 @@ void Engine_Ext_UPML::DoPostCurrentUpdates(int threadID)
 	{
 	case Engine::BASIC:
 		{
-			for (unsigned int lineX=0; lineX<m_numX.at(threadID); ++lineX)
+			for (unsigned int lineX=0; lineX<numX; ++lineX)
 			{
-				loc_pos[0]=lineX+m_start.at(threadID);
+				loc_pos[0]=lineX+startX;
 				pos[0] = loc_pos[0] + m_Op_UPML->m_StartPos[0];
 				for (loc_pos[1]=0; loc_pos[1]<m_Op_UPML->m_numLines[1]; ++loc_pos[1])
 				{
@@ -432,29 +623,31 @@ void Engine_Ext_UPML::DoPostCurrentUpdates(int threadID)
 		}
 	case Engine::SSE:
 		{
+			if (m_VectorUpdate)
+			{
+				PostCurrentUpdatesVector(startX, numX);
+				break;
+			}
+			// direct access of the z-lines using the precomputed vector index and lane
 			Engine_sse* eng_sse = (Engine_sse*) m_Eng;
-			for (unsigned int lineX=0; lineX<m_numX.at(threadID); ++lineX)
+			f4vector* curr_line;
+			for (unsigned int lineX=0; lineX<numX; ++lineX)
 			{
-				loc_pos[0]=lineX+m_start.at(threadID);
+				loc_pos[0]=lineX+startX;
 				pos[0] = loc_pos[0] + m_Op_UPML->m_StartPos[0];
 				for (loc_pos[1]=0; loc_pos[1]<m_Op_UPML->m_numLines[1]; ++loc_pos[1])
 				{
 					pos[1] = loc_pos[1] + m_Op_UPML->m_StartPos[1];
-					for (loc_pos[2]=0; loc_pos[2]<m_Op_UPML->m_numLines[2]; ++loc_pos[2])
+					for (int n=0; n<3; ++n)
 					{
-						pos[2] = loc_pos[2] + m_Op_UPML->m_StartPos[2];
-
-						f_help = curr_flux[0][loc_pos[0]][loc_pos[1]][loc_pos[2]];
-						curr_flux[0][loc_pos[0]][loc_pos[1]][loc_pos[2]] = eng_sse->Engine_sse::GetCurr(0,pos);
-						eng_sse->Engine_sse::SetCurr(0,pos, f_help + m_Op_UPML->iifn[0][loc_pos[0]][loc_pos[1]][loc_pos[2]] * curr_flux[0][loc_pos[0]][loc_pos[1]][loc_pos[2]]);
-
-						f_help = curr_flux[1][loc_pos[0]][loc_pos[1]][loc_pos[2]];
-						curr_flux[1][loc_pos[0]][loc_pos[1]][loc_pos[2]] = eng_sse->Engine_sse::GetCurr(1,pos);
-						eng_sse->Engine_sse::SetCurr(1,pos, f_help + m_Op_UPML->iifn[1][loc_pos[0]][loc_pos[1]][loc_pos[2]] * curr_flux[1][loc_pos[0]][loc_pos[1]][loc_pos[2]]);
-
-						f_help = curr_flux[2][loc_pos[0]][loc_pos[1]][loc_pos[2]];
-						curr_flux[2][loc_pos[0]][loc_pos[1]][loc_pos[2]] = eng_sse->Engine_sse::GetCurr(2,pos);
-						eng_sse->Engine_sse::SetCurr(2,pos, f_help + m_Op_UPML->iifn[2][loc_pos[0]][loc_pos[1]][loc_pos[2]] * curr_flux[2][loc_pos[0]][loc_pos[1]][loc_pos[2]]);
+						curr_line = eng_sse->f4_curr[n][pos[0]][pos[1]];
+						for (loc_pos[2]=0; loc_pos[2]<m_Op_UPML->m_numLines[2]; ++loc_pos[2])
+						{
+							FDTD_FLOAT &value = curr_line[m_zVector[loc_pos[2]]].f[m_zLane[loc_pos[2]]];
+							f_help = curr_flux[n][loc_pos[0]][loc_pos[1]][loc_pos[2]];
+							curr_flux[n][loc_pos[0]][loc_pos[1]][loc_pos[2]] = value;
+							value = f_help + m_Op_UPML->iifn[n][loc_pos[0]][loc_pos[1]][loc_pos[2]] * curr_flux[n][loc_pos[0]][loc_pos[1]][loc_pos[2]];
+						}
 					}
 				}
 			}
@@ -462,9 +655,9 @@ void Engine_Ext_UPML::DoPostCurrentUpdates(int threadID)
 		}
 	default:
 		{
-			for (unsigned int lineX=0; lineX<m_numX.at(threadID); ++lineX)
+			for (unsigned int lineX=0; lineX<numX; ++lineX)
 			{
-				loc_pos[0]=lineX+m_start.at(threadID);
+				loc_pos[0]=lineX+startX;
 				pos[0] = loc_pos[0] + m_Op_UPML->m_StartPos[0];
 				for (loc_pos[1]=0; loc_pos[1]<m_Op_UPML->m_numLines[1]; ++loc_pos[1])
 				{
@@ -491,3 +684,121 @@ void Engine_Ext_UPML::DoPostCurrentUpdates(int threadID)
 		}
 	}
 }
+
+void Engine_Ext_UPML::PreVoltageUpdatesVector(unsigned int startX, unsigned int numX)
+{
+	Engine_sse* eng_sse = (Engine_sse*) m_Eng;
+	unsigned int pos[2];
+	unsigned int loc_pos[2];
+	f4vector f_help;
+	for (unsigned int lineX=0; lineX<numX; ++lineX)
+	{
+		loc_pos[0]=lineX+startX;
+		pos[0] = loc_pos[0] + m_Op_UPML->m_StartPos[0];
+		for (loc_pos[1]=0; loc_pos[1]<m_Op_UPML->m_numLines[1]; ++loc_pos[1])
+		{
+			pos[1] = loc_pos[1] + m_Op_UPML->m_StartPos[1];
+			for (int n=0; n<3; ++n)
+			{
+				f4vector* volt = eng_sse->f4_volt[n][pos[0]][pos[1]];
+				f4vector* flux = f4_volt_flux[n][loc_pos[0]][loc_pos[1]];
+				const f4vector* vv = f4_vv[n][loc_pos[0]][loc_pos[1]];
+				const f4vector* vvfo = f4_vvfo[n][loc_pos[0]][loc_pos[1]];
+				for (unsigned int v=0; v<m_numVectors; ++v)
+				{
+					f_help.v = vv[v].v * volt[v].v - vvfo[v].v * flux[v].v;
+					volt[v].v = flux[v].v;
+					flux[v].v = f_help.v;
+				}
+			}
+		}
+	}
+}
+
+void Engine_Ext_UPML::PostVoltageUpdatesVector(unsigned int startX, unsigned int numX)
+{
+	Engine_sse* eng_sse = (Engine_sse*) m_Eng;
+	unsigned int pos[2];
+	unsigned int loc_pos[2];
+	f4vector f_help;
+	for (unsigned int lineX=0; lineX<numX; ++lineX)
+	{
+		loc_pos[0]=lineX+startX;
+		pos[0] = loc_pos[0] + m_Op_UPML->m_StartPos[0];
+		for (loc_pos[1]=0; loc_pos[1]<m_Op_UPML->m_numLines[1]; ++loc_pos[1])
+		{
+			pos[1] = loc_pos[1] + m_Op_UPML->m_StartPos[1];
+			for (int n=0; n<3; ++n)
+			{
+				f4vector* volt = eng_sse->f4_volt[n][pos[0]][pos[1]];
+				f4vector* flux = f4_volt_flux[n][loc_pos[0]][loc_pos[1]];
+				const f4vector* vvfn = f4_vvfn[n][loc_pos[0]][loc_pos[1]];
+				for (unsigned int v=0; v<m_numVectors; ++v)
+				{
+					f_help.v = flux[v].v;
+					flux[v].v = volt[v].v;
+					volt[v].v = f_help.v + vvfn[v].v * flux[v].v;
+				}
+			}
+		}
+	}
+}
+
+void Engine_Ext_UPML::PreCurrentUpdatesVector(unsigned int startX, unsigned int numX)
+{
+	Engine_sse* eng_sse = (Engine_sse*) m_Eng;
+	unsigned int pos[2];
+	unsigned int loc_pos[2];
+	f4vector f_help;
+	for (unsigned int lineX=0; lineX<numX; ++lineX)
+	{
+		loc_pos[0]=lineX+startX;
+		pos[0] = loc_pos[0] + m_Op_UPML->m_StartPos[0];
+		for (loc_pos[1]=0; loc_pos[1]<m_Op_UPML->m_numLines[1]; ++loc_pos[1])
+		{
+			pos[1] = loc_pos[1] + m_Op_UPML->m_StartPos[1];
+			for (int n=0; n<3; ++n)
+			{
+				f4vector* curr = eng_sse->f4_curr[n][pos[0]][pos[1]];
+				f4vector* flux = f4_curr_flux[n][loc_pos[0]][loc_pos[1]];
+				const f4vector* ii = f4_ii[n][loc_pos[0]][loc_pos[1]];
+				const f4vector* iifo = f4_iifo[n][loc_pos[0]][loc_pos[1]];
+				for (unsigned int v=0; v<m_numVectors; ++v)
+				{
+					f_help.v = ii[v].v * curr[v].v - iifo[v].v * flux[v].v;
+					curr[v].v = flux[v].v;
+					flux[v].v = f_help.v;
+				}
+			}
+		}
+	}
+}
+
+void Engine_Ext_UPML::PostCurrentUpdatesVector(unsigned int startX, unsigned int numX)
+{
+	Engine_sse* eng_sse = (Engine_sse*) m_Eng;
+	unsigned int pos[2];
+	unsigned int loc_pos[2];
+	f4vector f_help;
+	for (unsigned int lineX=0; lineX<numX; ++lineX)
+	{
+		loc_pos[0]=lineX+startX;
+		pos[0] = loc_pos[0] + m_Op_UPML->m_StartPos[0];
+		for (loc_pos[1]=0; loc_pos[1]<m_Op_UPML->m_numLines[1]; ++loc_pos[1])
+		{
+			pos[1] = loc_pos[1] + m_Op_UPML->m_StartPos[1];
+			for (int n=0; n<3; ++n)
+			{
+				f4vector* curr = eng_sse->f4_curr[n][pos[0]][pos[1]];
+				f4vector* flux = f4_curr_flux[n][loc_pos[0]][loc_pos[1]];
+				const f4vector* iifn = f4_iifn[n][loc_pos[0]][loc_pos[1]];
+				for (unsigned int v=0; v<m_numVectors; ++v)
+				{
+					f_help.v = flux[v].v;
+					flux[v].v = curr[v].v;
+					curr[v].v = f_help.v + iifn[v].v * flux[v].v;
+				}
+			}
+		}
+	}
+}
@@ -21,9 +21,15 @@
 #include "engine_extension.h"
 #include "FDTD/engine.h"
 #include "FDTD/operator.h"
+#include "tools/array_ops.h"
 
 class Operator_Ext_UPML;
 
+//! Engine extension for the uniaxial pml (see Operator_Ext_UPML)
+/*!
+  For the sse engines a pml covering all z-lines (e.g. the pml in x- and y-direction) keeps its fluxes and coefficients in the interleaved
+  vector layout of the engine and updates whole vectors of a z-line. For all other pml the vector index and lane of every z-line are precomputed.
+  */
 class Engine_Ext_UPML : public Engine_Extension
 {
 public:
@@ -32,6 +38,9 @@ public:
 
 	virtual void SetNumberOfThreads(int nrThread);
 
+	//! Setup the vector or scalar update of this pml for the given engine
+	virtual void SetEngine(Engine* eng);
+
 	virtual void DoPreVoltageUpdates() {Engine_Ext_UPML::DoPreVoltageUpdates(0);};
 	virtual void DoPreVoltageUpdates(int threadID);
 	virtual void DoPostVoltageUpdates() {Engine_Ext_UPML::DoPostVoltageUpdates(0);};
@@ -42,7 +51,25 @@ public:
 	virtual void DoPostCurrentUpdates() {Engine_Ext_UPML::DoPostCurrentUpdates(0);};
 	virtual void DoPostCurrentUpdates(int threadID);
 
+	//! All updates of the pml are local to each cell
+	virtual int GetUpdateStages() const {return PRE_VOLTAGE | POST_VOLTAGE | PRE_CURRENT | POST_CURRENT;}
+	virtual bool IsTemporalBlockingSafe(const std::vector<unsigned int> &start, const std::vector<unsigned int> &stop) const {UNUSED(start);UNUSED(stop);return true;}
+	virtual bool GetFootprint(unsigned int &startX, unsigned int &stopX) const;
+	virtual void DoPreVoltageUpdatesRange(unsigned int startX, unsigned int numX, int timestep);
+	virtual void DoPostVoltageUpdatesRange(unsigned int startX, unsigned int numX, int timestep);
+	virtual void DoPreCurrentUpdatesRange(unsigned int startX, unsigned int numX, int timestep);
+	virtual void DoPostCurrentUpdatesRange(unsigned int startX, unsigned int numX, int timestep);
+
+	virtual bool WriteState(std::ostream &file) const;
+	virtual bool ReadState(std::istream &file);
+
 protected:
+	//! Do the updates for the local x-lines [startX, startX+numX) of this pml
+	void PreVoltageUpdates(unsigned int startX, unsigned int numX);
+	void PostVoltageUpdates(unsigned int startX, unsigned int numX);
+	void PreCurrentUpdates(unsigned int startX, unsigned int numX);
+	void PostCurrentUpdates(unsigned int startX, unsigned int numX);
+
 	Operator_Ext_UPML* m_Op_UPML;
 
 	vector<unsigned int> m_start;
@@ -50,6 +77,32 @@ protected:
 
 	FDTD_FLOAT**** volt_flux;
 	FDTD_FLOAT**** curr_flux;
+
+	//! Update whole vectors of the sse engine, the pml covers all z-lines
+	bool m_VectorUpdate;
+	unsigned int m_numVectors;
+	//! fluxes in the vector layout of the sse engine, only used for the vector update
+	f4vector**** f4_volt_flux;
+	f4vector**** f4_curr_flux;
+	//! coefficients in the vector layout, owned by the operator (see Operator_Ext_UPML::BuildVectorCoefficients())
+	f4vector**** f4_vv;
+	f4vector**** f4_vvfo;
+	f4vector**** f4_vvfn;
+	f4vector**** f4_ii;
+	f4vector**** f4_iifo;
+	f4vector**** f4_iifn;
+
+	//! vector index and lane of every local z-line in the sse engine
+	std::vector<unsigned int> m_zVector;
+	std::vector<unsigned int> m_zLane;
+
+	void PreVoltageUpdatesVector(unsigned int startX, unsigned int numX);
+	void PostVoltageUpdatesVector(unsigned int startX, unsigned int numX);
+	void PreCurrentUpdatesVector(unsigned int startX, unsigned int numX);
+	void PostCurrentUpdatesVector(unsigned int startX, unsigned int numX);
+
+	void CreateVectorArrays();
+	void DeleteVectorArrays();
 };
 
 #endif // ENGINE_EXT_UPML_H
@@ -47,6 +47,19 @@ string Engine_Extension::GetExtensionName() const
 		return "Unknown Extension";
 }
 
+bool Engine_Extension::WriteState(ostream &file) const
+{
+	// no internal state by default
+	UNUSED(file);
+	return true;
+}
+
+bool Engine_Extension::ReadState(istream &file)
+{
+	UNUSED(file);
+	return true;
+}
+
 void Engine_Extension::DoPreVoltageUpdates(int threadID)
 {
 	//if this method gets called the derived extension obviously doesn't support multithrading, calling non-MT method...
@@ -89,6 +102,68 @@ void Engine_Extension::Apply2Current(int threadID)
 		Apply2Current();
 }
 
+void Engine_Extension::Apply2VoltagesRange(unsigned int startX, unsigned int numX, int timestep)
+{
+	UNUSED(startX);
+	UNUSED(numX);
+	UNUSED(timestep);
+}
+
+void Engine_Extension::Apply2CurrentRange(unsigned int startX, unsigned int numX, int timestep)
+{
+	UNUSED(startX);
+	UNUSED(numX);
+	UNUSED(timestep);
+}
+
+bool Engine_Extension::IsTemporalBlockingSafe(const std::vector<unsigned int> &start, const std::vector<unsigned int> &stop) const
+{
+	UNUSED(start);
+	UNUSED(stop);
+	return false;
+}
+
+bool Engine_Extension::IsFusedUpdateSafe(const std::vector<unsigned int> &start, const std::vector<unsigned int> &stop) const
+{
+	// an extension safe for the line-by-line updates of temporal blocking is safe for the x-slab updates as well
+	return IsTemporalBlockingSafe(start, stop);
+}
+
+bool Engine_Extension::GetFootprint(unsigned int &startX, unsigned int &stopX) const
+{
+	startX = 0;
+	stopX = (unsigned int)-1;
+	return true;
+}
+
+void Engine_Extension::DoPreVoltageUpdatesRange(unsigned int startX, unsigned int numX, int timestep)
+{
+	UNUSED(startX);
+	UNUSED(numX);
+	UNUSED(timestep);
+}
+
+void Engine_Extension::DoPostVoltageUpdatesRange(unsigned int startX, unsigned int numX, int timestep)
+{
+	UNUSED(startX);
+	UNUSED(numX);
+	UNUSED(timestep);
+}
+
+void Engine_Extension::DoPreCurrentUpdatesRange(unsigned int startX, unsigned int numX, int timestep)
+{
+	UNUSED(startX);
+	UNUSED(numX);
+	UNUSED(timestep);
+}
+
+void Engine_Extension::DoPostCurrentUpdatesRange(unsigned int startX, unsigned int numX, int timestep)
+{
+	UNUSED(startX);
+	UNUSED(numX);
+	UNUSED(timestep);
+}
+
 bool Engine_Extension::operator< (const Engine_Extension& other)
 {
 	return (GetPriority()<other.GetPriority());
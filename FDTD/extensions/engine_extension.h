@@ -29,6 +29,8 @@
 #define ENG_EXT_PRIO_CYLINDERMULTIGRID	-3000 //cylindrial multi-grid extension priority
 
 #include <string>
+#include <vector>
+#include <iostream>
 
 class Operator_Extension;
 class Engine;
@@ -61,6 +63,37 @@ public:
 	virtual void Apply2Current() {}
 	virtual void Apply2Current(int threadID);
 
+	//! Returns true if this extension only needs the x-range methods below, as required by the temporal blocking engine and neighbour synchronization, with \a start and \a stop being the first and last x-line of each thread.
+	//! These methods are called for single x-lines, each line is updated in the order pre update, engine update, post update and apply. An extension must only access the x-slab of the calling thread within these methods.
+	virtual bool IsTemporalBlockingSafe(const std::vector<unsigned int> &start, const std::vector<unsigned int> &stop) const;
+	//! Apply the voltage changes for timestep \a timestep to the x-lines [startX, startX+numX). Only used if IsTemporalBlockingSafe() or IsFusedUpdateSafe() is true.
+	virtual void Apply2VoltagesRange(unsigned int startX, unsigned int numX, int timestep);
+	//! Apply the current changes for timestep \a timestep to the x-lines [startX, startX+numX). Only used if IsTemporalBlockingSafe() or IsFusedUpdateSafe() is true.
+	virtual void Apply2CurrentRange(unsigned int startX, unsigned int numX, int timestep);
+
+	//! Returns true if the x-range methods of this extension can be called for the whole x-slab of each engine thread, with \a start and \a stop being the first and last x-line of each thread.
+	//! Used by the default multithreaded engine to run the extension work without extra barriers. Default: IsTemporalBlockingSafe()
+	virtual bool IsFusedUpdateSafe(const std::vector<unsigned int> &start, const std::vector<unsigned int> &stop) const;
+
+	//! Update stages of an extension, see GetUpdateStages()
+	enum UpdateStage
+	{
+		PRE_VOLTAGE=1, POST_VOLTAGE=2, APPLY_VOLTAGE=4, PRE_CURRENT=8, POST_CURRENT=16, APPLY_CURRENT=32, ALL_STAGES=63
+	};
+	//! Returns the update stages (see UpdateStage) this extension is doing any work in, the multithreaded engine skips all other stages and their thread synchronization.
+	virtual int GetUpdateStages() const {return ALL_STAGES;}
+	//! Get the footprint of this extension, the x-lines [startX, stopX] of all cells read or written by any update stage. Returns false if this extension is not accessing any cell.
+	//! The multithreaded engine only runs the x-range methods on the threads owning these x-lines and only synchronizes the threads for overlapping footprints.
+	virtual bool GetFootprint(unsigned int &startX, unsigned int &stopX) const;
+	//! Do the pre voltage update work of timestep \a timestep for the x-lines [startX, startX+numX). Only used if IsTemporalBlockingSafe() or IsFusedUpdateSafe() is true.
+	virtual void DoPreVoltageUpdatesRange(unsigned int startX, unsigned int numX, int timestep);
+	//! Do the post voltage update work of timestep \a timestep for the x-lines [startX, startX+numX). Only used if IsTemporalBlockingSafe() or IsFusedUpdateSafe() is true.
+	virtual void DoPostVoltageUpdatesRange(unsigned int startX, unsigned int numX, int timestep);
+	//! Do the pre current update work of timestep \a timestep for the x-lines [startX, startX+numX). Only used if IsTemporalBlockingSafe() or IsFusedUpdateSafe() is true.
+	virtual void DoPreCurrentUpdatesRange(unsigned int startX, unsigned int numX, int timestep);
+	//! Do the post current update work of timestep \a timestep for the x-lines [startX, startX+numX). Only used if IsTemporalBlockingSafe() or IsFusedUpdateSafe() is true.
+	virtual void DoPostCurrentUpdatesRange(unsigned int startX, unsigned int numX, int timestep);
+
 	//! Set the Engine to this extention. This will usually done automatically by Engine::AddExtension
 	virtual void SetEngine(Engine* eng) {m_Eng=eng;}
 
@@ -74,6 +107,11 @@ public:
 
 	virtual std::string GetExtensionName() const;
 
+	//! Write the internal state (e.g. fluxes or buffered fields) of this extension to a binary stream, needed for a checkpoint of the simulation. \sa ReadState
+	virtual bool WriteState(std::ostream &file) const;
+	//! Restore the internal state written by WriteState, the extension has to be setup identically.
+	virtual bool ReadState(std::istream &file);
+
 protected:
 	Engine_Extension(Operator_Extension* op_ext);
 
@@ -25,11 +25,17 @@
 Operator_Ext_ConductingSheet::Operator_Ext_ConductingSheet(Operator* op, double f_max) : Operator_Ext_LorentzMaterial(op)
 {
 	m_f_max = f_max;
+	m_TanDir = NULL;
+	m_Conductivity = NULL;
+	m_Thickness = NULL;
 }
 
 Operator_Ext_ConductingSheet::Operator_Ext_ConductingSheet(Operator* op, Operator_Ext_ConductingSheet* op_ext) : Operator_Ext_LorentzMaterial(op, op_ext)
 {
 	m_f_max = op_ext->m_f_max;
+	m_TanDir = NULL;
+	m_Conductivity = NULL;
+	m_Thickness = NULL;
 }
 
 Operator_Extension* Operator_Ext_ConductingSheet::Clone(Operator* op)
@@ -43,7 +49,6 @@ bool Operator_Ext_ConductingSheet::BuildExtension()
 {
 	double dT = m_Op->GetTimestep();
 	unsigned int pos[] = {0,0,0};
-	double coord[3];
 	unsigned int numLines[3] = {m_Op->GetNumberOfLines(0,true),m_Op->GetNumberOfLines(1,true),m_Op->GetNumberOfLines(2,true)};
 
 	m_Order = 0;
@@ -52,94 +57,30 @@ bool Operator_Ext_ConductingSheet::BuildExtension()
 	float ****Conductivity = Create_N_3DArray<float>(numLines);
 	float ****Thickness = Create_N_3DArray<float>(numLines);
 
-	CSPrimitives* cs_sheet = NULL;
-	double box[6];
-	int nP, nPP;
-	bool b_pos_on;
-	bool disable_pos;
-	for (pos[0]=0; pos[0]<numLines[0]; ++pos[0])
-	{
-		for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
-		{
-			vector<CSPrimitives*> vPrims = m_Op->GetPrimitivesBoundBox(pos[0], pos[1], -1, (CSProperties::PropertyType)(CSProperties::MATERIAL | CSProperties::METAL));
-			for (pos[2]=0; pos[2]<numLines[2]; ++pos[2])
-			{
-				b_pos_on = false;
-				disable_pos = false;
-				// disable conducting sheet model inside the boundary conditions, especially inside a pml
-				for (int m=0;m<3;++m)
-					if ((pos[m]<=(unsigned int)m_Op->GetBCSize(2*m)) || (pos[m]>=(numLines[m]-m_Op->GetBCSize(2*m+1)-1)))
-						disable_pos = true;
+	m_TanDir = tanDir;
+	m_Conductivity = Conductivity;
+	m_Thickness = Thickness;
 
-				for (int n=0; n<3; ++n)
-				{
-					nP = (n+1)%3;
-					nPP = (n+2)%3;
-
-					tanDir[n][pos[0]][pos[1]][pos[2]] = -1; //deactivate by default
-					Conductivity[n][pos[0]][pos[1]][pos[2]] = 0; //deactivate by default
-					Thickness[n][pos[0]][pos[1]][pos[2]] = 0; //deactivate by default
-
-					if (m_Op->GetYeeCoords(n,pos,coord,false)==false)
-						continue;
+	// find all sheet positions in parallel, every thread is scanning its own x-lines
+	m_Sheet_Parts.assign(m_Op->GetNumberOfSetupThreads(), Sheet_Part());
+	Operator::RangeJobMember<Operator_Ext_ConductingSheet> job(this, &Operator_Ext_ConductingSheet::FindSheets_Range);
+	m_Op->RunRangeJob(&job, numLines[0]);
 
-					// Ez at r==0 not supported --> set to PEC
-					if (m_CC_R0_included && (n==2) && (pos[0]==0))
-						disable_pos = true;
-
-//					CSProperties* prop = m_Op->GetGeometryCSX()->GetPropertyByCoordPriority(coord,(CSProperties::PropertyType)(CSProperties::METAL | CSProperties::MATERIAL), false, &cs_sheet);
-					CSProperties* prop = m_Op->GetGeometryCSX()->GetPropertyByCoordPriority(coord, vPrims, false, &cs_sheet);
-					CSPropConductingSheet* cs_prop = dynamic_cast<CSPropConductingSheet*>(prop);
-					if (cs_prop)
-					{
-						if (cs_sheet==NULL)
-							return false; //sanity check, this should never happen
-						if (cs_sheet->GetDimension()!=2)
-						{
-							cerr << "Operator_Ext_ConductingSheet::BuildExtension: A conducting sheet primitive (ID: " << cs_sheet->GetID() << ") with dimension: " << cs_sheet->GetDimension() << " found, fallback to PEC!" << endl;
-							m_Op->SetVV(n,pos[0],pos[1],pos[2], 0 );
-							m_Op->SetVI(n,pos[0],pos[1],pos[2], 0 );
-							++m_Op->m_Nr_PEC[n];
-							continue;
-						}
-						cs_sheet->SetPrimitiveUsed(true);
-
-						if (disable_pos)
-						{
-							m_Op->SetVV(n,pos[0],pos[1],pos[2], 0 );
-							m_Op->SetVI(n,pos[0],pos[1],pos[2], 0 );
-							++m_Op->m_Nr_PEC[n];
-							continue;
-						}
-
-						Conductivity[n][pos[0]][pos[1]][pos[2]] = cs_prop->GetConductivity();
-						Thickness[n][pos[0]][pos[1]][pos[2]] = cs_prop->GetThickness();
-
-						if ((Conductivity[n][pos[0]][pos[1]][pos[2]]<=0) || (Thickness[n][pos[0]][pos[1]][pos[2]]<=0))
-						{
-							cerr << "Operator_Ext_ConductingSheet::BuildExtension: Warning: Zero conductivity or thickness detected... fallback to PEC!" << endl;
-							m_Op->SetVV(n,pos[0],pos[1],pos[2], 0 );
-							m_Op->SetVI(n,pos[0],pos[1],pos[2], 0 );
-							++m_Op->m_Nr_PEC[n];
-							continue;
-						}
-
-						cs_sheet->GetBoundBox(box);
-						if (box[2*nP]!=box[2*nP+1])
-							tanDir[n][pos[0]][pos[1]][pos[2]] = nP;
-						if (box[2*nPP]!=box[2*nPP+1])
-							tanDir[n][pos[0]][pos[1]][pos[2]] = nPP;
-						b_pos_on = true;
-					}
-				}
-				if (b_pos_on)
-				{
-					for (int n=0; n<3; ++n)
-						v_pos[n].push_back(pos[n]);
-				}
-			}
+	// merge the thread results in order of the x-lines
+	bool valid = true;
+	for (size_t t=0; t<m_Sheet_Parts.size(); ++t)
+	{
+		Sheet_Part& part = m_Sheet_Parts.at(t);
+		valid &= part.valid;
+		for (int n=0; n<3; ++n)
+		{
+			v_pos[n].insert(v_pos[n].end(), part.v_pos[n].begin(), part.v_pos[n].end());
+			m_Op->m_Nr_PEC[n] += part.nr_PEC[n];
 		}
 	}
+	m_Sheet_Parts.clear();
+	if (!valid)
+		return false; //sanity check, this should never happen
 
 	size_t numCS = v_pos[0].size();
 	if (numCS==0)
@@ -259,3 +200,105 @@ bool Operator_Ext_ConductingSheet::BuildExtension()
 	}
 	return true;
 }
+
+void Operator_Ext_ConductingSheet::FindSheets_Range(unsigned int startX, unsigned int stopX, unsigned int threadID)
+{
+	Sheet_Part& part = m_Sheet_Parts.at(threadID);
+	unsigned int pos[] = {0,0,0};
+	double coord[3];
+	unsigned int numLines[3] = {m_Op->GetNumberOfLines(0,true),m_Op->GetNumberOfLines(1,true),m_Op->GetNumberOfLines(2,true)};
+
+	CSPrimitives* cs_sheet = NULL;
+	double box[6];
+	int nP, nPP;
+	bool b_pos_on;
+	bool disable_pos;
+	vector<CSPrimitives*> vPrims;
+	vector<unsigned int> primScratch;
+	for (pos[0]=startX; pos[0]<=stopX; ++pos[0])
+	{
+		for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
+		{
+			m_Op->GetPrimitivesBoundBox(pos[0], pos[1], -1, (CSProperties::PropertyType)(CSProperties::MATERIAL | CSProperties::METAL), vPrims, primScratch);
+			for (pos[2]=0; pos[2]<numLines[2]; ++pos[2])
+			{
+				b_pos_on = false;
+				disable_pos = false;
+				// disable conducting sheet model inside the boundary conditions, especially inside a pml
+				for (int m=0;m<3;++m)
+					if ((pos[m]<=(unsigned int)m_Op->GetBCSize(2*m)) || (pos[m]>=(numLines[m]-m_Op->GetBCSize(2*m+1)-1)))
+						disable_pos = true;
+
+				for (int n=0; n<3; ++n)
+				{
+					nP = (n+1)%3;
+					nPP = (n+2)%3;
+
+					m_TanDir[n][pos[0]][pos[1]][pos[2]] = -1; //deactivate by default
+					m_Conductivity[n][pos[0]][pos[1]][pos[2]] = 0; //deactivate by default
+					m_Thickness[n][pos[0]][pos[1]][pos[2]] = 0; //deactivate by default
+
+					if (m_Op->GetYeeCoords(n,pos,coord,false)==false)
+						continue;
+
+					// Ez at r==0 not supported --> set to PEC
+					if (m_CC_R0_included && (n==2) && (pos[0]==0))
+						disable_pos = true;
+
+//					CSProperties* prop = m_Op->GetGeometryCSX()->GetPropertyByCoordPriority(coord,(CSProperties::PropertyType)(CSProperties::METAL | CSProperties::MATERIAL), false, &cs_sheet);
+					CSProperties* prop = m_Op->GetGeometryCSX()->GetPropertyByCoordPriority(coord, vPrims, false, &cs_sheet);
+					CSPropConductingSheet* cs_prop = dynamic_cast<CSPropConductingSheet*>(prop);
+					if (cs_prop)
+					{
+						if (cs_sheet==NULL)
+						{
+							part.valid = false; //sanity check, this should never happen
+							return;
+						}
+						if (cs_sheet->GetDimension()!=2)
+						{
+							cerr << "Operator_Ext_ConductingSheet::BuildExtension: A conducting sheet primitive (ID: " << cs_sheet->GetID() << ") with dimension: " << cs_sheet->GetDimension() << " found, fallback to PEC!" << endl;
+							m_Op->SetVV(n,pos[0],pos[1],pos[2], 0 );
+							m_Op->SetVI(n,pos[0],pos[1],pos[2], 0 );
+							++part.nr_PEC[n];
+							continue;
+						}
+						cs_sheet->SetPrimitiveUsed(true);
+
+						if (disable_pos)
+						{
+							m_Op->SetVV(n,pos[0],pos[1],pos[2], 0 );
+							m_Op->SetVI(n,pos[0],pos[1],pos[2], 0 );
+							++part.nr_PEC[n];
+							continue;
+						}
+
+						m_Conductivity[n][pos[0]][pos[1]][pos[2]] = cs_prop->GetConductivity();
+						m_Thickness[n][pos[0]][pos[1]][pos[2]] = cs_prop->GetThickness();
+
+						if ((m_Conductivity[n][pos[0]][pos[1]][pos[2]]<=0) || (m_Thickness[n][pos[0]][pos[1]][pos[2]]<=0))
+						{
+							cerr << "Operator_Ext_ConductingSheet::BuildExtension: Warning: Zero conductivity or thickness detected... fallback to PEC!" << endl;
+							m_Op->SetVV(n,pos[0],pos[1],pos[2], 0 );
+							m_Op->SetVI(n,pos[0],pos[1],pos[2], 0 );
+							++part.nr_PEC[n];
+							continue;
+						}
+
+						cs_sheet->GetBoundBox(box);
+						if (box[2*nP]!=box[2*nP+1])
+							m_TanDir[n][pos[0]][pos[1]][pos[2]] = nP;
+						if (box[2*nPP]!=box[2*nPP+1])
+							m_TanDir[n][pos[0]][pos[1]][pos[2]] = nPP;
+						b_pos_on = true;
+					}
+				}
+				if (b_pos_on)
+				{
+					for (int n=0; n<3; ++n)
+						part.v_pos[n].push_back(pos[n]);
+				}
+			}
+		}
+	}
+}
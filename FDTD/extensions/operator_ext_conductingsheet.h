@@ -46,6 +46,22 @@ protected:
 	//! Copy constructor
 	Operator_Ext_ConductingSheet(Operator* op, Operator_Ext_ConductingSheet* op_ext);
 	double m_f_max;
+
+	//! Sheet positions and PEC fallbacks found by a single setup thread, see BuildExtension()
+	struct Sheet_Part
+	{
+		Sheet_Part() : valid(true) {nr_PEC[0]=nr_PEC[1]=nr_PEC[2]=0;}
+		vector<unsigned int> v_pos[3];
+		unsigned int nr_PEC[3];
+		bool valid;
+	};
+	vector<Sheet_Part> m_Sheet_Parts;
+	//! Tangential direction, conductivity and thickness of the sheet at each edge (internal to BuildExtension)
+	int ****m_TanDir;
+	float ****m_Conductivity;
+	float ****m_Thickness;
+	//! Find the conducting sheets at the x-lines \a startX to \a stopX (internal to BuildExtension)
+	void FindSheets_Range(unsigned int startX, unsigned int stopX, unsigned int threadID);
 };
 
 #endif // OPERATOR_EXT_CONDUCTINGSHEET_H
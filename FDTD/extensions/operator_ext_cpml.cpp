@@ -0,0 +1,261 @@
+/*
+*	Copyright (C) 2026 openEMS contributors
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "operator_ext_cpml.h"
+#include "FDTD/operator_cylinder.h"
+#include "engine_ext_cpml.h"
+#include "fparser.hh"
+
+using namespace std;
+
+Operator_Ext_CPML::Operator_Ext_CPML(Operator* op) : Operator_Extension(op)
+{
+	m_GradingFunction = new FunctionParser();
+	//default grading function, identical to the upml
+	SetGradingFunction(" -log(1e-6)*log(2.5)/(2*dl*Z*(pow(2.5,W/dl)-1)) * pow(2.5, D/dl) ");
+
+	m_ny = -1;
+	m_nyP = -1;
+	m_nyPP = -1;
+	m_top = false;
+	m_Size = 0;
+	m_KappaMax = 1;
+	m_AlphaMax = 0;
+	for (int n=0; n<3; ++n)
+	{
+		m_StartPos[n]=0;
+		m_numLines[n]=0;
+	}
+}
+
+Operator_Ext_CPML::~Operator_Ext_CPML()
+{
+	delete m_GradingFunction;
+	m_GradingFunction = NULL;
+}
+
+void Operator_Ext_CPML::SetDirection(int ny, bool top_ny, unsigned int size, const unsigned int start[3], const unsigned int stop[3])
+{
+	if ((ny<0) || (ny>2))
+		return;
+
+	m_ny = ny;
+	m_nyP = (ny+1)%3;
+	m_nyPP = (ny+2)%3;
+	m_top = top_ny;
+	m_Size = size;
+	for (int n=0; n<3; ++n)
+	{
+		m_StartPos[n]=start[n];
+		m_numLines[n]=stop[n]-start[n]+1;
+	}
+	if (!top_ny)
+		m_StartPos[ny] = 0;
+	else
+		m_StartPos[ny] = m_Op->GetNumberOfLines(ny,true)-1-size;
+	m_numLines[ny] = size+1;
+}
+
+bool Operator_Ext_CPML::Create_CPML(Operator* op, const int ui_BC[6], const unsigned int ui_size[6], string gradFunc, double kappaMax, double alphaMax)
+{
+	int BC[6]={ui_BC[0],ui_BC[1],ui_BC[2],ui_BC[3],ui_BC[4],ui_BC[5]};
+	unsigned int size[6]={ui_size[0],ui_size[1],ui_size[2],ui_size[3],ui_size[4],ui_size[5]};
+
+	//check if mesh is large enough to support the pml (including an upml at the opposite boundary)
+	for (int n=0; n<3; ++n)
+		if ( (size[2*n]*((BC[2*n]==3) || (BC[2*n]==4))+size[2*n+1]*((BC[2*n+1]==3) || (BC[2*n+1]==4))) >= op->GetNumberOfLines(n,true) )
+		{
+			for (int m=2*n; m<2*n+2; ++m)
+				if (BC[m]==4)
+				{
+					cerr << "Operator_Ext_CPML::Create_CPML: Warning: Not enough lines in direction: " << n << ", resetting to PEC" << endl;
+					BC[m]=0;
+					size[m]=0;
+				}
+		}
+
+	//check cylindrical coord compatiblility
+	if (dynamic_cast<Operator_Cylinder*>(op))
+	{
+		for (int n=0; n<6; ++n)
+			if (BC[n]==4)
+			{
+				cerr << "Operator_Ext_CPML::Create_CPML: Warning: A cpml is not possible in cylindrical coordinates, resetting to PEC..." << endl;
+				BC[n]=0;
+				size[n]=0;
+			}
+	}
+
+	unsigned int start[3]={0 ,0 ,0};
+	unsigned int stop[3] ={0 ,0 ,0};
+	for (int n=0; n<6; ++n)
+	{
+		if (BC[n]!=4)
+			continue;
+		int ny = n/2;
+		//full range in the tangential directions, an upml at a tangential boundary keeps the edge and corner regions
+		for (int m=0; m<3; ++m)
+		{
+			start[m]=(size[2*m]+1)*(BC[2*m]==3);
+			stop[m] =op->GetNumberOfLines(m,true)-1-(size[2*m+1]+1)*(BC[2*m+1]==3);
+		}
+		if (start[(ny+1)%3]>stop[(ny+1)%3] || start[(ny+2)%3]>stop[(ny+2)%3])
+			continue;
+		Operator_Ext_CPML* op_ext_cpml = new Operator_Ext_CPML(op);
+		op_ext_cpml->SetGradingFunction(gradFunc);
+		op_ext_cpml->SetKappaMax(kappaMax);
+		op_ext_cpml->SetAlphaMax(alphaMax);
+		op_ext_cpml->SetDirection(ny, n%2, size[n], start, stop);
+		op->AddExtension(op_ext_cpml);
+	}
+
+	return true;
+}
+
+bool Operator_Ext_CPML::SetGradingFunction(string func)
+{
+	if (func.empty())
+		return true;
+
+	m_GradFunc = func;
+	int res = m_GradingFunction->Parse(m_GradFunc.c_str(), "D,dl,W,Z,N");
+	if (res < 0) return true;
+
+	cerr << "Operator_Ext_CPML::SetGradingFunction: Warning, an error occured parsing the pml grading function (see below) ..." << endl;
+	cerr << func << "\n" << string(res, ' ') << "^\n" << m_GradingFunction->ErrorMsg() << "\n";
+	return false;
+}
+
+void Operator_Ext_CPML::SetKappaMax(double kappaMax)
+{
+	if (kappaMax<1)
+	{
+		cerr << "Operator_Ext_CPML::SetKappaMax: Warning, kappa_max must not be smaller than 1, resetting to 1" << endl;
+		kappaMax = 1;
+	}
+	m_KappaMax = kappaMax;
+}
+
+void Operator_Ext_CPML::SetAlphaMax(double alphaMax)
+{
+	if (alphaMax<0)
+	{
+		cerr << "Operator_Ext_CPML::SetAlphaMax: Warning, alpha_max must not be negative, resetting to 0" << endl;
+		alphaMax = 0;
+	}
+	m_AlphaMax = alphaMax;
+}
+
+double Operator_Ext_CPML::CalcGrading(double depth, double width)
+{
+	if ((depth<=0) || (m_Size==0))
+		return 0;
+	double vars[5] = {depth, width/m_Size, width, __Z0__, (double)m_Size};
+	return m_GradingFunction->Eval(vars);
+}
+
+void Operator_Ext_CPML::CalcCoefficients(double depth, double width, double dT, FDTD_FLOAT &b, FDTD_FLOAT &c, FDTD_FLOAT &kinv)
+{
+	double sigma = CalcGrading(depth, width);
+	if (sigma<=0)
+	{
+		b = 1;
+		c = 0;
+		kinv = 0;
+		return;
+	}
+	//kappa is graded like the conductivity, alpha decreases linearly towards the outer boundary
+	double kappa = 1 + (m_KappaMax-1)*sigma/CalcGrading(width, width);
+	double alpha = m_AlphaMax*max(0.0, 1-depth/width);
+	b = exp(-(sigma/kappa+alpha)*dT/__EPS0__);
+	c = sigma/(sigma*kappa+kappa*kappa*alpha)*(b-1);
+	kinv = 1/kappa-1;
+}
+
+bool Operator_Ext_CPML::BuildExtension()
+{
+	/*Calculate the cpml coefficients as defined in:
+	  J. Alan Roden and Stephen D. Gedney, "Convolution PML (CPML): An efficient FDTD implementation of the CFS-PML for arbitrary media", 2000
+	  - the conductivity is graded identically to the upml, kappa and alpha as described in the class documentation
+	  - b = exp(-(sigma/kappa+alpha)*dT/eps0) and c = sigma/(sigma*kappa+kappa^2*alpha)*(b-1)
+	  - the voltage (current) coefficients are defined at the primary (dual) lines in normal direction
+	*/
+	if (m_Op==NULL)
+		return false;
+	if (m_ny<0)
+	{
+		cerr << "Operator_Ext_CPML::BuildExtension: Warning, Extension not initialized! Use SetDirection!! Abort build!!" << endl;
+		return false;
+	}
+
+	double dT = m_Op->GetTimestep();
+	double delta = m_Op->GetGridDelta();
+	unsigned int numLines = m_Op->GetNumberOfLines(m_ny,true);
+	//line of the interface to the inner domain
+	double interface = m_Op->GetDiscLine(m_ny, m_top ? m_StartPos[m_ny] : m_Size);
+	double width = fabs(m_Op->GetDiscLine(m_ny, m_StartPos[m_ny]+m_Size) - m_Op->GetDiscLine(m_ny, m_StartPos[m_ny]))*delta;
+
+	m_volt_b.resize(m_numLines[m_ny]);
+	m_volt_c.resize(m_numLines[m_ny]);
+	m_curr_b.resize(m_numLines[m_ny]);
+	m_curr_c.resize(m_numLines[m_ny]);
+	m_volt_kinv.resize(m_numLines[m_ny]);
+	m_curr_kinv.resize(m_numLines[m_ny]);
+	for (unsigned int n=0; n<m_numLines[m_ny]; ++n)
+	{
+		unsigned int pos = m_StartPos[m_ny]+n;
+		double depth = (m_Op->GetDiscLine(m_ny,pos) - interface)*delta;
+		if (!m_top)
+			depth *= -1;
+		CalcCoefficients(depth, width, dT, m_volt_b.at(n), m_volt_c.at(n), m_volt_kinv.at(n));
+
+		if (pos+1>=numLines)
+		{
+			//no current beyond the last line
+			m_curr_b.at(n) = 1;
+			m_curr_c.at(n) = 0;
+			m_curr_kinv.at(n) = 0;
+			continue;
+		}
+		depth = (0.5*(m_Op->GetDiscLine(m_ny,pos)+m_Op->GetDiscLine(m_ny,pos+1)) - interface)*delta;
+		if (!m_top)
+			depth *= -1;
+		CalcCoefficients(depth, width, dT, m_curr_b.at(n), m_curr_c.at(n), m_curr_kinv.at(n));
+	}
+	return true;
+}
+
+Engine_Extension* Operator_Ext_CPML::CreateEngineExtention()
+{
+	Engine_Ext_CPML* eng_ext = new Engine_Ext_CPML(this);
+	return eng_ext;
+}
+
+void Operator_Ext_CPML::ShowStat(ostream &ostr)  const
+{
+	Operator_Extension::ShowStat(ostr);
+
+	string XYZ[3] = {"x","y","z"};
+	ostr << " Active direction\t: " << XYZ[m_ny] << " at line: " << (m_top ? m_Op->GetNumberOfLines(m_ny,true)-1 : 0) << endl;
+	ostr << " PML range\t\t: " << "[" << m_StartPos[0]<< "," << m_StartPos[1]<< "," << m_StartPos[2]<< "] to ["
+	<<  m_StartPos[0]+m_numLines[0]-1 << "," << m_StartPos[1]+m_numLines[1]-1 << "," << m_StartPos[2]+m_numLines[2]-1 << "]" << endl;
+	ostr << " Grading function\t: \"" << m_GradFunc << "\"" << endl;
+	ostr << " Kappa max / alpha max\t: " << m_KappaMax << " / " << m_AlphaMax << " S/m" << endl;
+	//four auxiliary fields per cell, the upml needs 24 values per cell
+	double cells = (double)m_numLines[0]*m_numLines[1]*m_numLines[2];
+	ostr << " Memory (cpml/upml)\t: " << cells*4*sizeof(FDTD_FLOAT)/1024/1024 << " MiB / " << cells*24*sizeof(FDTD_FLOAT)/1024/1024 << " MiB" << endl;
+}
@@ -0,0 +1,105 @@
+/*
+*	Copyright (C) 2026 openEMS contributors
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef OPERATOR_EXT_CPML_H
+#define OPERATOR_EXT_CPML_H
+
+#include "FDTD/operator.h"
+#include "operator_extension.h"
+
+class FunctionParser;
+
+//! Operator extension implementing a convolutional perfectly matched layer (cpml) for a single boundary plane
+/*!
+  In contrast to the upml (see Operator_Ext_UPML) the main operator is not modified. The main engine does the usual updates inside the pml as well,
+  the engine extension adds the stretched-coordinate correction of the derivative normal to the boundary plane, using an auxiliary field (psi)
+  for the two tangential voltage and current components.
+  Therefore only four auxiliary fields are stored per pml cell, the coefficients of the convolution and the coordinate stretching only depend on the depth inside the pml.
+
+  The same conductivity grading as for the upml is used. The coordinate stretching (kappa) is graded like the conductivity from 1 to kappa_max,
+  the complex frequency shift (alpha) decreases linearly from alpha_max at the interface to 0 at the outer boundary.
+  The defaults (kappa_max=1, alpha_max=0) result in the plain stretched-coordinate pml.
+  Overlapping pml planes in the edges and corners of the simulation domain are handled by adding the corrections of each plane.
+  */
+class Operator_Ext_CPML : public Operator_Extension
+{
+	friend class Engine_Ext_CPML;
+public:
+	virtual ~Operator_Ext_CPML();
+
+	//! The cpml is not implemented for cylindrical coordinates, Create_CPML will reset these boundaries to PEC
+	virtual bool IsCylinderCoordsSave(bool closedAlpha, bool R0_included) const { UNUSED(closedAlpha); UNUSED(R0_included); return false;}
+	virtual bool IsCylindricalMultiGridSave(bool child) const {UNUSED(child); return false;}
+
+	virtual bool IsMPISave() const {return true;}
+
+	//! Set the grading function for the pml conductivity, see Operator_Ext_UPML::SetGradingFunction
+	virtual bool SetGradingFunction(string func);
+
+	//! Set the maximum coordinate stretching at the outer boundary of the pml (default is 1, i.e. no stretching)
+	void SetKappaMax(double kappaMax);
+	//! Set the complex frequency shift at the interface to the inner domain in S/m (default is 0)
+	void SetAlphaMax(double alphaMax);
+
+	virtual bool BuildExtension();
+
+	virtual Engine_Extension* CreateEngineExtention();
+
+	virtual string GetExtensionName() const {return string("Convolutional PML Extension");}
+
+	virtual void ShowStat(ostream &ostr) const;
+
+	//! Create a cpml extension for every boundary of type 4, boundaries of type 3 (upml) are skipped in the edge and corner regions
+	static bool Create_CPML(Operator* op, const int ui_BC[6], const unsigned int ui_size[6], const string gradFunc, double kappaMax=1, double alphaMax=0);
+
+protected:
+	Operator_Ext_CPML(Operator* op);
+
+	//! Define the boundary plane \a ny=0,1,2 -> x,y,z at the bottom or top and the pml range in the two tangential directions
+	void SetDirection(int ny, bool top_ny, unsigned int size, const unsigned int start[3], const unsigned int stop[3]);
+
+	int m_ny;
+	int m_nyP,m_nyPP;
+	bool m_top;
+	unsigned int m_Size;
+
+	unsigned int m_StartPos[3];
+	unsigned int m_numLines[3];
+
+	string m_GradFunc;
+	FunctionParser* m_GradingFunction;
+
+	double m_KappaMax;
+	double m_AlphaMax;
+
+	//! Calculate the conductivity at the given depth into the pml
+	double CalcGrading(double depth, double width);
+
+	//! Calculate the convolution coefficients and the stretching correction (1/kappa-1) at the given depth into the pml
+	void CalcCoefficients(double depth, double width, double dT, FDTD_FLOAT &b, FDTD_FLOAT &c, FDTD_FLOAT &kinv);
+
+	//! convolution coefficients for every local line in normal direction, psi = b*psi + c*derivative
+	vector<FDTD_FLOAT> m_volt_b;
+	vector<FDTD_FLOAT> m_volt_c;
+	vector<FDTD_FLOAT> m_curr_b;
+	vector<FDTD_FLOAT> m_curr_c;
+	//! correction of the normal derivative of the main engine update for the coordinate stretching: 1/kappa-1
+	vector<FDTD_FLOAT> m_volt_kinv;
+	vector<FDTD_FLOAT> m_curr_kinv;
+};
+
+#endif // OPERATOR_EXT_CPML_H
@@ -116,31 +116,17 @@ Operator_Extension* Operator_Ext_LorentzMaterial::Clone(Operator* op)
 
 bool Operator_Ext_LorentzMaterial::BuildExtension()
 {
-	double dT = m_Op->GetTimestep();
-	unsigned int pos[] = {0,0,0};
-	double coord[3];
-	unsigned int numLines[3] = {m_Op->GetNumberOfLines(0,true),m_Op->GetNumberOfLines(1,true),m_Op->GetNumberOfLines(2,true)};
-	CSPropLorentzMaterial* mat = NULL;
-	CSPropDebyeMaterial* debye_mat = NULL;
-
 	bool warn_once = true;
 
-	bool b_pos_on;
 	vector<unsigned int> v_pos[3];
 
 	// drude material parameter
-	double w_plasma,t_relax;
-	double L_D[3], C_D[3];
-	double R_D[3], G_D[3];
 	vector<double> v_int[3];
 	vector<double> v_ext[3];
 	vector<double> i_int[3];
 	vector<double> i_ext[3];
 
 	//additional Dorentz material parameter
-	double w_Lor_Pol;
-	double C_L[3];
-	double L_L[3];
 	vector<double> v_Lor[3];
 	vector<double> i_Lor[3];
 
@@ -179,6 +165,7 @@ bool Operator_Ext_LorentzMaterial::BuildExtension()
 	v_Lor_ADE = new FDTD_FLOAT**[m_Order];
 	i_Lor_ADE = new FDTD_FLOAT**[m_Order];
 
+	m_Op->MainOp->SetPos(0,0,0);
 	for (int order=0;order<m_Order;++order)
 	{
 		m_volt_ADE_On[order]=false;
@@ -200,159 +187,40 @@ bool Operator_Ext_LorentzMaterial::BuildExtension()
 			i_Lor[n].clear();
 		}
 
-		for (pos[0]=0; pos[0]<numLines[0]; ++pos[0])
-		{
-			for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
-			{
-				vector<CSPrimitives*> vPrims = m_Op->GetPrimitivesBoundBox(pos[0], pos[1], -1, (CSProperties::PropertyType)(CSProperties::MATERIAL | CSProperties::METAL));
-				for (pos[2]=0; pos[2]<numLines[2]; ++pos[2])
-				{
-					unsigned int index = m_Op->MainOp->SetPos(pos[0],pos[1],pos[2]);
-					//calc epsilon lorentz material
-					b_pos_on = false;
-					for (int n=0; n<3; ++n)
-					{
-						L_D[n]=0;
-						R_D[n]=0;
-						C_L[n]=0;
-						if (m_Op->GetYeeCoords(n,pos,coord,false)==false)
-							continue;
-						if (m_CC_R0_included && (n==2) && (pos[0]==0))
-							coord[1] = m_Op->GetDiscLine(1,0);
-
-						if (m_Op->GetVI(n,pos[0],pos[1],pos[2])==0)
-							continue;
-
-//						CSProperties* prop = m_Op->GetGeometryCSX()->GetPropertyByCoordPriority(coord,(CSProperties::PropertyType)(CSProperties::METAL | CSProperties::MATERIAL), true);
-						CSProperties* prop = m_Op->GetGeometryCSX()->GetPropertyByCoordPriority(coord, vPrims, true);
 
-						if (prop==NULL) continue;
+		// collect the coefficients of all positions in parallel, every thread is scanning its own x-lines
+		m_BuildOrder = order;
+		m_ADE_Parts.assign(m_Op->GetNumberOfSetupThreads(), ADE_Part());
+		Operator::RangeJobMember<Operator_Ext_LorentzMaterial> job(this, &Operator_Ext_LorentzMaterial::BuildExtension_Range);
+		m_Op->RunRangeJob(&job, m_Op->GetNumberOfLines(0,true));
 
-						if ((mat = prop->ToLorentzMaterial()))
-						{
-							w_plasma = mat->GetEpsPlasmaFreqWeighted(order,n,coord) * 2 * PI;
-							if ((w_plasma>0) && (m_Op->EC_C[n][index]>0))
-							{
-								b_pos_on = true;
-								m_volt_ADE_On[order] = true;
-								L_D[n] = 1/(w_plasma*w_plasma*m_Op->EC_C[n][index]);
-							}
-							t_relax = mat->GetEpsRelaxTimeWeighted(order,n,coord);
-							if ((t_relax>0) && m_volt_ADE_On[order])
-							{
-								R_D[n] = L_D[n]/t_relax;
-							}
-							w_Lor_Pol = mat->GetEpsLorPoleFreqWeighted(order,n,coord) * 2 * PI;
-							if ((w_Lor_Pol>0) && (L_D[n]>0))
-							{
-								m_volt_Lor_ADE_On[order] = true;
-								C_L[n] = 1/(w_Lor_Pol*w_Lor_Pol*L_D[n]);
-							}
-						}
-						if ((debye_mat = prop->ToDebyeMaterial()))
-						{
-							C_L[n] = 8.85418781762e-12*debye_mat->GetEpsDeltaWeighted(order,n,coord) * m_Op->GetEdgeArea(n, pos) / m_Op->GetEdgeLength(n,pos);
-							t_relax = debye_mat->GetEpsRelaxTimeWeighted(order,n,coord);
-							if ((t_relax<2.0*dT) && warn_once)
-							{
-								warn_once = false;
-								cerr << "Operator_Ext_LorentzMaterial::BuildExtension(): Warning, debye relaxation time is to small, skipping..." << endl;
-							}
-							if ((C_L[n]>0) && (t_relax>0) && (t_relax>2.0*dT))
-							{
-								R_D[n] = t_relax/C_L[n];
-								b_pos_on = true;
-								m_volt_ADE_On[order] = true;
-								m_volt_Lor_ADE_On[order] = true;
-							}
-						}
-					}
-
-					for (int n=0; n<3; ++n)
-					{
-						C_D[n]=0;
-						G_D[n]=0;
-						L_L[n]=0;
-						if (m_Op->GetYeeCoords(n,pos,coord,true)==false)
-							continue;
-						if (m_Op->GetIV(n,pos[0],pos[1],pos[2])==0)
-							continue;
-
-//						CSProperties* prop = m_Op->GetGeometryCSX()->GetPropertyByCoordPriority(coord,(CSProperties::PropertyType)(CSProperties::METAL | CSProperties::MATERIAL), true);
-						CSProperties* prop = m_Op->GetGeometryCSX()->GetPropertyByCoordPriority(coord, vPrims, true);
+		// merge the thread results in order of the x-lines
+		for (size_t t=0; t<m_ADE_Parts.size(); ++t)
+		{
+			ADE_Part& part = m_ADE_Parts.at(t);
+			for (int n=0;n<3;++n)
+			{
+				v_pos[n].insert(v_pos[n].end(), part.v_pos[n].begin(), part.v_pos[n].end());
 
-						if (prop==NULL) continue;
+				v_int[n].insert(v_int[n].end(), part.v_int[n].begin(), part.v_int[n].end());
+				v_ext[n].insert(v_ext[n].end(), part.v_ext[n].begin(), part.v_ext[n].end());
+				i_int[n].insert(i_int[n].end(), part.i_int[n].begin(), part.i_int[n].end());
+				i_ext[n].insert(i_ext[n].end(), part.i_ext[n].begin(), part.i_ext[n].end());
 
-						if ((mat = prop->ToLorentzMaterial()))
-						{
-							w_plasma = mat->GetMuePlasmaFreqWeighted(order,n,coord) * 2 * PI;
-							if ((w_plasma>0) && (m_Op->EC_L[n][index]>0))
-							{
-								b_pos_on = true;
-								m_curr_ADE_On[order] = true;
-								C_D[n] = 1/(w_plasma*w_plasma*m_Op->EC_L[n][index]);
-							}
-							t_relax = mat->GetMueRelaxTimeWeighted(order,n,coord);
-							if ((t_relax>0) && m_curr_ADE_On[order])
-							{
-								G_D[n] = C_D[n]/t_relax;
-							}
-							w_Lor_Pol = mat->GetMueLorPoleFreqWeighted(order,n,coord) * 2 * PI;
-							if ((w_Lor_Pol>0) && (C_D[n]>0))
-							{
-								m_curr_Lor_ADE_On[order] = true;
-								L_L[n] = 1/(w_Lor_Pol*w_Lor_Pol*C_D[n]);
-							}
-						}
-					}
-
-					if (b_pos_on) //this position has active drude material
-					{
-						for (unsigned int n=0; n<3; ++n)
-						{
-							v_pos[n].push_back(pos[n]);
-							if (L_D[n]>0)
-							{
-								v_int[n].push_back((2.0*L_D[n]-dT*R_D[n])/(2.0*L_D[n]+dT*R_D[n]));
-								// check for r==0 in clyindrical coords and get special VI cooefficient
-								if (m_CC_R0_included && n==2 && pos[0]==0)
-									v_ext[n].push_back(dT/(L_D[n]+dT*R_D[n]/2.0)*m_Op_Cyl->m_Cyl_Ext->vi_R0[pos[2]]);
-								else
-									v_ext[n].push_back(dT/(L_D[n]+dT*R_D[n]/2.0)*m_Op->GetVI(n,pos[0],pos[1],pos[2]));
-							}
-							else if ((R_D[n]>0) && (C_L[n]>0))
-							{
-								v_int[n].push_back((2.0*dT-R_D[n]*C_L[n])/(C_L[n]*R_D[n]));
-								v_ext[n].push_back(2.0/R_D[n]*m_Op->GetVI(n,pos[0],pos[1],pos[2]));
-							}
-							else
-							{
-								v_int[n].push_back(1);
-								v_ext[n].push_back(0);
-							}
-							if (C_D[n]>0)
-							{
-								i_int[n].push_back((2.0*C_D[n]-dT*G_D[n])/(2.0*C_D[n]+dT*G_D[n]));
-								i_ext[n].push_back(dT/(C_D[n]+dT*G_D[n]/2.0)*m_Op->GetIV(n,pos[0],pos[1],pos[2]));
-							}
-							else
-							{
-								i_int[n].push_back(1);
-								i_ext[n].push_back(0);
-							}
-							if (C_L[n]>0)
-								v_Lor[n].push_back(dT/C_L[n]/m_Op->GetVI(n,pos[0],pos[1],pos[2]));
-							else
-								v_Lor[n].push_back(0);
-							if (L_L[n]>0)
-								i_Lor[n].push_back(dT/L_L[n]/m_Op->GetIV(n,pos[0],pos[1],pos[2]));
-							else
-								i_Lor[n].push_back(0);
-						}
-					}
-				}
+				v_Lor[n].insert(v_Lor[n].end(), part.v_Lor[n].begin(), part.v_Lor[n].end());
+				i_Lor[n].insert(i_Lor[n].end(), part.i_Lor[n].begin(), part.i_Lor[n].end());
+			}
+			m_volt_ADE_On[order] = m_volt_ADE_On[order] || part.volt_ADE_On;
+			m_curr_ADE_On[order] = m_curr_ADE_On[order] || part.curr_ADE_On;
+			m_volt_Lor_ADE_On[order] = m_volt_Lor_ADE_On[order] || part.volt_Lor_ADE_On;
+			m_curr_Lor_ADE_On[order] = m_curr_Lor_ADE_On[order] || part.curr_Lor_ADE_On;
+			if (part.debye_warning && warn_once)
+			{
+				warn_once = false;
+				cerr << "Operator_Ext_LorentzMaterial::BuildExtension(): Warning, debye relaxation time is to small, skipping..." << endl;
 			}
 		}
+		m_ADE_Parts.clear();
 
 		//copy all vectors into the array's
 		m_LM_Count.push_back(v_pos[0].size());
@@ -437,6 +305,183 @@ bool Operator_Ext_LorentzMaterial::BuildExtension()
 	return true;
 }
 
+void Operator_Ext_LorentzMaterial::BuildExtension_Range(unsigned int startX, unsigned int stopX, unsigned int threadID)
+{
+	ADE_Part& part = m_ADE_Parts.at(threadID);
+	int order = m_BuildOrder;
+	double dT = m_Op->GetTimestep();
+	unsigned int pos[] = {0,0,0};
+	double coord[3];
+	unsigned int numLines[3] = {m_Op->GetNumberOfLines(0,true),m_Op->GetNumberOfLines(1,true),m_Op->GetNumberOfLines(2,true)};
+	CSPropLorentzMaterial* mat = NULL;
+	CSPropDebyeMaterial* debye_mat = NULL;
+
+	bool b_pos_on;
+	vector<CSPrimitives*> vPrims;
+	vector<unsigned int> primScratch;
+
+	// drude material parameter
+	double w_plasma,t_relax;
+	double L_D[3], C_D[3];
+	double R_D[3], G_D[3];
+
+	//additional Dorentz material parameter
+	double w_Lor_Pol;
+	double C_L[3];
+	double L_L[3];
+
+	for (pos[0]=startX; pos[0]<=stopX; ++pos[0])
+	{
+		for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
+		{
+			m_Op->GetPrimitivesBoundBox(pos[0], pos[1], -1, (CSProperties::PropertyType)(CSProperties::MATERIAL | CSProperties::METAL), vPrims, primScratch);
+			for (pos[2]=0; pos[2]<numLines[2]; ++pos[2])
+			{
+				unsigned int index = m_Op->MainOp->GetPos(pos[0],pos[1],pos[2]);
+				//calc epsilon lorentz material
+				b_pos_on = false;
+				for (int n=0; n<3; ++n)
+				{
+					L_D[n]=0;
+					R_D[n]=0;
+					C_L[n]=0;
+					if (m_Op->GetYeeCoords(n,pos,coord,false)==false)
+						continue;
+					if (m_CC_R0_included && (n==2) && (pos[0]==0))
+						coord[1] = m_Op->GetDiscLine(1,0);
+
+					if (m_Op->GetVI(n,pos[0],pos[1],pos[2])==0)
+						continue;
+
+//					CSProperties* prop = m_Op->GetGeometryCSX()->GetPropertyByCoordPriority(coord,(CSProperties::PropertyType)(CSProperties::METAL | CSProperties::MATERIAL), true);
+					CSProperties* prop = m_Op->GetGeometryCSX()->GetPropertyByCoordPriority(coord, vPrims, true);
+
+					if (prop==NULL) continue;
+
+					if ((mat = prop->ToLorentzMaterial()))
+					{
+						w_plasma = mat->GetEpsPlasmaFreqWeighted(order,n,coord) * 2 * PI;
+						if ((w_plasma>0) && (m_Op->EC_C[n][index]>0))
+						{
+							b_pos_on = true;
+							part.volt_ADE_On = true;
+							L_D[n] = 1/(w_plasma*w_plasma*m_Op->EC_C[n][index]);
+						}
+						t_relax = mat->GetEpsRelaxTimeWeighted(order,n,coord);
+						if ((t_relax>0) && part.volt_ADE_On)
+						{
+							R_D[n] = L_D[n]/t_relax;
+						}
+						w_Lor_Pol = mat->GetEpsLorPoleFreqWeighted(order,n,coord) * 2 * PI;
+						if ((w_Lor_Pol>0) && (L_D[n]>0))
+						{
+							part.volt_Lor_ADE_On = true;
+							C_L[n] = 1/(w_Lor_Pol*w_Lor_Pol*L_D[n]);
+						}
+					}
+					if ((debye_mat = prop->ToDebyeMaterial()))
+					{
+						C_L[n] = 8.85418781762e-12*debye_mat->GetEpsDeltaWeighted(order,n,coord) * m_Op->GetEdgeArea(n, pos) / m_Op->GetEdgeLength(n,pos);
+						t_relax = debye_mat->GetEpsRelaxTimeWeighted(order,n,coord);
+						if (t_relax<2.0*dT)
+							part.debye_warning = true;
+						if ((C_L[n]>0) && (t_relax>0) && (t_relax>2.0*dT))
+						{
+							R_D[n] = t_relax/C_L[n];
+							b_pos_on = true;
+							part.volt_ADE_On = true;
+							part.volt_Lor_ADE_On = true;
+						}
+					}
+				}
+
+				for (int n=0; n<3; ++n)
+				{
+					C_D[n]=0;
+					G_D[n]=0;
+					L_L[n]=0;
+					if (m_Op->GetYeeCoords(n,pos,coord,true)==false)
+						continue;
+					if (m_Op->GetIV(n,pos[0],pos[1],pos[2])==0)
+						continue;
+
+//					CSProperties* prop = m_Op->GetGeometryCSX()->GetPropertyByCoordPriority(coord,(CSProperties::PropertyType)(CSProperties::METAL | CSProperties::MATERIAL), true);
+					CSProperties* prop = m_Op->GetGeometryCSX()->GetPropertyByCoordPriority(coord, vPrims, true);
+
+					if (prop==NULL) continue;
+
+					if ((mat = prop->ToLorentzMaterial()))
+					{
+						w_plasma = mat->GetMuePlasmaFreqWeighted(order,n,coord) * 2 * PI;
+						if ((w_plasma>0) && (m_Op->EC_L[n][index]>0))
+						{
+							b_pos_on = true;
+							part.curr_ADE_On = true;
+							C_D[n] = 1/(w_plasma*w_plasma*m_Op->EC_L[n][index]);
+						}
+						t_relax = mat->GetMueRelaxTimeWeighted(order,n,coord);
+						if ((t_relax>0) && part.curr_ADE_On)
+						{
+							G_D[n] = C_D[n]/t_relax;
+						}
+						w_Lor_Pol = mat->GetMueLorPoleFreqWeighted(order,n,coord) * 2 * PI;
+						if ((w_Lor_Pol>0) && (C_D[n]>0))
+						{
+							part.curr_Lor_ADE_On = true;
+							L_L[n] = 1/(w_Lor_Pol*w_Lor_Pol*C_D[n]);
+						}
+					}
+				}
+
+				if (b_pos_on) //this position has active drude material
+				{
+					for (unsigned int n=0; n<3; ++n)
+					{
+						part.v_pos[n].push_back(pos[n]);
+						if (L_D[n]>0)
+						{
+							part.v_int[n].push_back((2.0*L_D[n]-dT*R_D[n])/(2.0*L_D[n]+dT*R_D[n]));
+							// check for r==0 in clyindrical coords and get special VI cooefficient
+							if (m_CC_R0_included && n==2 && pos[0]==0)
+								part.v_ext[n].push_back(dT/(L_D[n]+dT*R_D[n]/2.0)*m_Op_Cyl->m_Cyl_Ext->vi_R0[pos[2]]);
+							else
+								part.v_ext[n].push_back(dT/(L_D[n]+dT*R_D[n]/2.0)*m_Op->GetVI(n,pos[0],pos[1],pos[2]));
+						}
+						else if ((R_D[n]>0) && (C_L[n]>0))
+						{
+							part.v_int[n].push_back((2.0*dT-R_D[n]*C_L[n])/(C_L[n]*R_D[n]));
+							part.v_ext[n].push_back(2.0/R_D[n]*m_Op->GetVI(n,pos[0],pos[1],pos[2]));
+						}
+						else
+						{
+							part.v_int[n].push_back(1);
+							part.v_ext[n].push_back(0);
+						}
+						if (C_D[n]>0)
+						{
+							part.i_int[n].push_back((2.0*C_D[n]-dT*G_D[n])/(2.0*C_D[n]+dT*G_D[n]));
+							part.i_ext[n].push_back(dT/(C_D[n]+dT*G_D[n]/2.0)*m_Op->GetIV(n,pos[0],pos[1],pos[2]));
+						}
+						else
+						{
+							part.i_int[n].push_back(1);
+							part.i_ext[n].push_back(0);
+						}
+						if (C_L[n]>0)
+							part.v_Lor[n].push_back(dT/C_L[n]/m_Op->GetVI(n,pos[0],pos[1],pos[2]));
+						else
+							part.v_Lor[n].push_back(0);
+						if (L_L[n]>0)
+							part.i_Lor[n].push_back(dT/L_L[n]/m_Op->GetIV(n,pos[0],pos[1],pos[2]));
+						else
+							part.i_Lor[n].push_back(0);
+					}
+				}
+			}
+		}
+	}
+}
+
 Engine_Extension* Operator_Ext_LorentzMaterial::CreateEngineExtention()
 {
 	Engine_Ext_LorentzMaterial* eng_ext_lor = new Engine_Ext_LorentzMaterial(this);
@@ -57,6 +57,28 @@ protected:
 
 	FDTD_FLOAT ***v_Lor_ADE;
 	FDTD_FLOAT ***i_Lor_ADE;
+
+	//! Positions and coefficients of the current order found by a single setup thread, see BuildExtension()
+	struct ADE_Part
+	{
+		ADE_Part() : volt_ADE_On(false), curr_ADE_On(false), volt_Lor_ADE_On(false), curr_Lor_ADE_On(false), debye_warning(false) {}
+		vector<unsigned int> v_pos[3];
+		vector<double> v_int[3];
+		vector<double> v_ext[3];
+		vector<double> i_int[3];
+		vector<double> i_ext[3];
+		vector<double> v_Lor[3];
+		vector<double> i_Lor[3];
+		bool volt_ADE_On;
+		bool curr_ADE_On;
+		bool volt_Lor_ADE_On;
+		bool curr_Lor_ADE_On;
+		bool debye_warning;
+	};
+	vector<ADE_Part> m_ADE_Parts;
+	int m_BuildOrder;
+	//! Calculate the coefficients of the order m_BuildOrder for the x-lines \a startX to \a stopX (internal to BuildExtension)
+	void BuildExtension_Range(unsigned int startX, unsigned int stopX, unsigned int threadID);
 };
 
 #endif // OPERATOR_EXT_LORENTZMATERIAL_H
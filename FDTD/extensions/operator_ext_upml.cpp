@@ -46,6 +46,14 @@ Operator_Ext_UPML::Operator_Ext_UPML(Operator* op) : Operator_Extension(op)
 	ii = NULL;
 	iifo = NULL;
 	iifn = NULL;
+
+	m_numVectors = 0;
+	f4_vv = NULL;
+	f4_vvfo = NULL;
+	f4_vvfn = NULL;
+	f4_ii = NULL;
+	f4_iifo = NULL;
+	f4_iifn = NULL;
 }
 
 Operator_Ext_UPML::~Operator_Ext_UPML()
@@ -268,6 +276,90 @@ void Operator_Ext_UPML::DeleteOp()
 	iifo = NULL;
 	Delete_N_3DArray<FDTD_FLOAT>(iifn,m_numLines);
 	iifn = NULL;
+
+	Delete_N_3DArray_v4sf(f4_vv,m_numLines);
+	f4_vv = NULL;
+	Delete_N_3DArray_v4sf(f4_vvfo,m_numLines);
+	f4_vvfo = NULL;
+	Delete_N_3DArray_v4sf(f4_vvfn,m_numLines);
+	f4_vvfn = NULL;
+	Delete_N_3DArray_v4sf(f4_ii,m_numLines);
+	f4_ii = NULL;
+	Delete_N_3DArray_v4sf(f4_iifo,m_numLines);
+	f4_iifo = NULL;
+	Delete_N_3DArray_v4sf(f4_iifn,m_numLines);
+	f4_iifn = NULL;
+}
+
+void Operator_Ext_UPML::BuildVectorCoefficients()
+{
+	if (f4_vv!=NULL)
+		return;
+	m_numVectors = ceil((double)m_numLines[2]/4.0);
+	f4_vv = Create_N_3DArray_v4sf(m_numLines);
+	f4_vvfo = Create_N_3DArray_v4sf(m_numLines);
+	f4_vvfn = Create_N_3DArray_v4sf(m_numLines);
+	f4_ii = Create_N_3DArray_v4sf(m_numLines);
+	f4_iifo = Create_N_3DArray_v4sf(m_numLines);
+	f4_iifn = Create_N_3DArray_v4sf(m_numLines);
+	CopyToVectors(vv, f4_vv);
+	CopyToVectors(vvfo, f4_vvfo);
+	CopyToVectors(vvfn, f4_vvfn);
+	CopyToVectors(ii, f4_ii);
+	CopyToVectors(iifo, f4_iifo);
+	CopyToVectors(iifn, f4_iifn);
+
+	// the vector update does not need the scalar coefficients
+	Delete_N_3DArray<FDTD_FLOAT>(vv,m_numLines);
+	vv = NULL;
+	Delete_N_3DArray<FDTD_FLOAT>(vvfo,m_numLines);
+	vvfo = NULL;
+	Delete_N_3DArray<FDTD_FLOAT>(vvfn,m_numLines);
+	vvfn = NULL;
+	Delete_N_3DArray<FDTD_FLOAT>(ii,m_numLines);
+	ii = NULL;
+	Delete_N_3DArray<FDTD_FLOAT>(iifo,m_numLines);
+	iifo = NULL;
+	Delete_N_3DArray<FDTD_FLOAT>(iifn,m_numLines);
+	iifn = NULL;
+}
+
+void Operator_Ext_UPML::BuildScalarCoefficients()
+{
+	if ((vv!=NULL) || (f4_vv==NULL))
+		return;
+	vv = Create_N_3DArray<FDTD_FLOAT>(m_numLines);
+	vvfo = Create_N_3DArray<FDTD_FLOAT>(m_numLines);
+	vvfn = Create_N_3DArray<FDTD_FLOAT>(m_numLines);
+	ii = Create_N_3DArray<FDTD_FLOAT>(m_numLines);
+	iifo = Create_N_3DArray<FDTD_FLOAT>(m_numLines);
+	iifn = Create_N_3DArray<FDTD_FLOAT>(m_numLines);
+	CopyFromVectors(f4_vv, vv);
+	CopyFromVectors(f4_vvfo, vvfo);
+	CopyFromVectors(f4_vvfn, vvfn);
+	CopyFromVectors(f4_ii, ii);
+	CopyFromVectors(f4_iifo, iifo);
+	CopyFromVectors(f4_iifn, iifn);
+}
+
+void Operator_Ext_UPML::CopyToVectors(FDTD_FLOAT**** src, f4vector**** dst) const
+{
+	unsigned int pos[3];
+	for (int n=0; n<3; ++n)
+		for (pos[0]=0; pos[0]<m_numLines[0]; ++pos[0])
+			for (pos[1]=0; pos[1]<m_numLines[1]; ++pos[1])
+				for (pos[2]=0; pos[2]<m_numLines[2]; ++pos[2])
+					dst[n][pos[0]][pos[1]][pos[2]%m_numVectors].f[pos[2]/m_numVectors] = src[n][pos[0]][pos[1]][pos[2]];
+}
+
+void Operator_Ext_UPML::CopyFromVectors(f4vector**** src, FDTD_FLOAT**** dst) const
+{
+	unsigned int pos[3];
+	for (int n=0; n<3; ++n)
+		for (pos[0]=0; pos[0]<m_numLines[0]; ++pos[0])
+			for (pos[1]=0; pos[1]<m_numLines[1]; ++pos[1])
+				for (pos[2]=0; pos[2]<m_numLines[2]; ++pos[2])
+					dst[n][pos[0]][pos[1]][pos[2]] = src[n][pos[0]][pos[1]][pos[2]%m_numVectors].f[pos[2]/m_numVectors];
 }
 
 
@@ -386,6 +478,8 @@ bool Operator_Ext_UPML::BuildExtension()
 	double kappa_i[3]={0,0,0};
 	double eff_Mat[4];
 	double dT = m_Op->GetTimestep();
+	vector<CSPrimitives*> vPrims;
+	vector<unsigned int> primScratch;
 
 	for (loc_pos[0]=0; loc_pos[0]<m_numLines[0]; ++loc_pos[0])
 	{
@@ -393,7 +487,7 @@ bool Operator_Ext_UPML::BuildExtension()
 		for (loc_pos[1]=0; loc_pos[1]<m_numLines[1]; ++loc_pos[1])
 		{
 			pos[1] = loc_pos[1] + m_StartPos[1];
-			vector<CSPrimitives*> vPrims = m_Op->GetPrimitivesBoundBox(pos[0], pos[1], -1, CSProperties::MATERIAL);
+			m_Op->GetPrimitivesBoundBox(pos[0], pos[1], -1, CSProperties::MATERIAL, vPrims, primScratch);
 			for (loc_pos[2]=0; loc_pos[2]<m_numLines[2]; ++loc_pos[2])
 			{
 				pos[2] = loc_pos[2] + m_StartPos[2];
@@ -20,6 +20,7 @@
 
 #include "FDTD/operator.h"
 #include "operator_extension.h"
+#include "tools/array_ops.h"
 
 class FunctionParser;
 
@@ -101,6 +102,23 @@ protected:
 	FDTD_FLOAT**** ii;   //calc new current from old current
 	FDTD_FLOAT**** iifo; //calc new current from old current flux
 	FDTD_FLOAT**** iifn; //calc new current from new current flux
+
+	//! Convert the coefficients once into the interleaved vector layout of the sse engines and free the scalar coefficients, the pml has to cover all z-lines
+	void BuildVectorCoefficients();
+	//! Restore the scalar coefficients from the vector layout, if they were freed by BuildVectorCoefficients()
+	void BuildScalarCoefficients();
+	//! Copy a pml array into the vector layout and vice versa
+	void CopyToVectors(FDTD_FLOAT**** src, f4vector**** dst) const;
+	void CopyFromVectors(f4vector**** src, FDTD_FLOAT**** dst) const;
+
+	//! coefficients in the vector layout of the sse engines, NULL unless built by BuildVectorCoefficients()
+	unsigned int m_numVectors;
+	f4vector**** f4_vv;
+	f4vector**** f4_vvfo;
+	f4vector**** f4_vvfn;
+	f4vector**** f4_ii;
+	f4vector**** f4_iifo;
+	f4vector**** f4_iifn;
 };
 
 #endif // OPERATOR_EXT_UPML_H
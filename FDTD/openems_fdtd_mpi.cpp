@@ -28,6 +28,8 @@
 #include <sstream>
 #include <vector>
 #include <iomanip>
+#include <algorithm>
+#include <limits>
 #include <string.h>
 #include <sys/time.h>
 #include <time.h>
@@ -62,6 +64,8 @@ openEMS_FDTD_MPI::openEMS_FDTD_MPI(bool m_MPI_Debug) : openEMS()
 
 	m_MPI_Elem = NULL;
 	m_Original_Grid = NULL;
+	m_AutoSplit = false;
+	m_NextCheckpointPoll = 0;
 
 	//redirect output to file for all ranks > 0
 	if ((m_MyID>0) && (m_MPI_Debug==false))
@@ -148,6 +152,15 @@ bool openEMS_FDTD_MPI::Parse_XML_FDTDSetup(TiXmlElement* FDTD_Opts)
 		exit(-1);
 	}
 
+	// the far-field of the partial nf2ff planes of each process is not combined
+	if (FDTD_Opts->FirstChildElement("NF2FF")!=NULL)
+	{
+		MPI_Barrier(MPI_COMM_WORLD);
+		if (m_MyID==0)
+			cerr << "openEMS_FDTD_MPI::SetupMPI: Error: the in-solver nf2ff transformation is not supported by the MPI engine, use the nf2ff dump boxes and the nf2ff tool instead, exiting MPI engine... " << endl;
+		exit(-1);
+	}
+
 	CSRectGrid* grid = m_CSX->GetGrid();
 	delete m_Original_Grid;
 	m_Original_Grid = CSRectGrid::Clone(grid);
@@ -155,6 +168,20 @@ bool openEMS_FDTD_MPI::Parse_XML_FDTDSetup(TiXmlElement* FDTD_Opts)
 	string arg_Pos_Names[] = {"SplitPos_X", "SplitPos_Y", "SplitPos_Z"};
 	string arg_N_Names[] = {"SplitN_X", "SplitN_Y", "SplitN_Z"};
 	const char* tmp = NULL;
+
+	// use the automatic partitioning if requested or if no split is defined at all
+	int ihelp = 0;
+	m_AutoSplit = false;
+	if (m_MPI_Elem->QueryIntAttribute("AutoSplit", &ihelp) == TIXML_SUCCESS)
+		m_AutoSplit = (ihelp!=0);
+	else
+	{
+		m_AutoSplit = true;
+		for (int n=0;n<3;++n)
+			if (m_MPI_Elem->Attribute(arg_Pos_Names[n].c_str()) || m_MPI_Elem->Attribute(arg_N_Names[n].c_str()))
+				m_AutoSplit = false;
+	}
+
 	for (int n=0;n<3;++n)
 	{
 		m_SplitNumber[n].clear();
@@ -205,6 +232,13 @@ bool openEMS_FDTD_MPI::SetupMPI()
 
 	MPI_Barrier(MPI_COMM_WORLD);
 
+	if (m_AutoSplit && !AutoSplit())
+	{
+		if (m_MyID==0)
+			cerr << "openEMS_FDTD_MPI::SetupMPI: Error: Automatic partitioning for " << m_NumProc << " processes failed! Exit! " << endl;
+		exit(10);
+	}
+
 	//validate number of processes
 	unsigned int numProcs = (m_SplitNumber[0].size()-1)*(m_SplitNumber[1].size()-1)*(m_SplitNumber[2].size()-1);
 	if (numProcs!=m_NumProc)
@@ -299,6 +333,383 @@ bool openEMS_FDTD_MPI::SetupMPI()
 }
 
 
+// estimated additional cost per cell relative to the basic (compressed sse) cell update
+#define MPI_COST_PML           2.0   // upml pre and post updates with flux arrays
+#define MPI_COST_CPML          1.0   // cpml corrections with auxiliary fields
+#define MPI_COST_MUR           1.0   // mur abc boundary plane
+#define MPI_COST_DISPERSIVE    1.5   // lorentz/drude/debye ADE updates
+#define MPI_COST_SHEET         1.0   // conducting sheet ADE updates
+#define MPI_COST_EXCITATION    0.5   // soft excitation
+#define MPI_COST_DUMP          0.25  // field dumps and probes
+#define MPI_COST_HALO          1.0   // interface cell (four floats send and received per timestep)
+#define MPI_SPLIT_MIN_CELLS    4     // minimal number of cells of each part
+
+void openEMS_FDTD_MPI::InitCostBoxes()
+{
+	m_CostBoxes.clear();
+	unsigned int numCells[3];
+	for (int n=0;n<3;++n)
+	{
+		numCells[n] = m_Original_Grid->GetQtyLines(n)-1;
+		m_NoSplitRanges[n].clear();
+	}
+
+	CostBox box;
+	// basic update of all cells
+	for (int n=0;n<3;++n)
+	{
+		box.start[n] = 0;
+		box.stop[n] = numCells[n];
+	}
+	box.cost = 1.0;
+	m_CostBoxes.push_back(box);
+
+	// boundary conditions
+	for (int n=0;n<3;++n)
+	{
+		for (int s=0;s<2;++s)
+		{
+			unsigned int size = 0;
+			if (m_BC_type[2*n+s]==3)
+			{
+				size = min(m_PML_size[2*n+s], numCells[n]);
+				box.cost = MPI_COST_PML;
+			}
+			else if (m_BC_type[2*n+s]==4)
+			{
+				size = min(m_PML_size[2*n+s], numCells[n]);
+				box.cost = MPI_COST_CPML;
+			}
+			else if (m_BC_type[2*n+s]==2)
+			{
+				size = 1;
+				box.cost = MPI_COST_MUR;
+			}
+			if (size==0)
+				continue;
+			for (int m=0;m<3;++m)
+			{
+				box.start[m] = 0;
+				box.stop[m] = numCells[m];
+			}
+			if (s==0)
+				box.stop[n] = size;
+			else
+				box.start[n] = numCells[n]-size;
+			m_CostBoxes.push_back(box);
+		}
+	}
+
+	// primitives are given in their native (cartesian) coordinates
+	if (CylinderCoords)
+		return;
+
+	int types[] = {CSProperties::LORENTZMATERIAL, CSProperties::DEBYEMATERIAL, CSProperties::CONDUCTINGSHEET, CSProperties::EXCITATION, CSProperties::PROBEBOX, CSProperties::DUMPBOX};
+	double costs[] = {MPI_COST_DISPERSIVE, MPI_COST_DISPERSIVE, MPI_COST_SHEET, MPI_COST_EXCITATION, MPI_COST_DUMP, MPI_COST_DUMP};
+	for (int t=0;t<6;++t)
+	{
+		vector<CSProperties*> props = m_CSX->GetPropertyByType((CSProperties::PropertyType)types[t]);
+		for (size_t i=0;i<props.size();++i)
+		{
+			for (size_t p=0;p<props.at(i)->GetQtyPrimitives();++p)
+			{
+				CSPrimitives* prim = props.at(i)->GetPrimitive(p);
+				if (prim==NULL)
+					continue;
+				double bnd[6] = {0,0,0,0,0,0};
+				prim->GetBoundBox(bnd,true);
+				unsigned int lines[2];
+				for (int n=0;n<3;++n)
+				{
+					bool inside;
+					for (int s=0;s<2;++s)
+						lines[s] = m_Original_Grid->Snap2LineNumber(n, bnd[2*n+s], inside);
+					box.start[n] = min(lines[0],lines[1]);
+					box.stop[n] = max(lines[0],lines[1]);
+					// probes and excitations should not be split (see SetupProcessing)
+					if ((types[t]==CSProperties::EXCITATION) || (types[t]==CSProperties::PROBEBOX))
+						m_NoSplitRanges[n].push_back(make_pair(box.start[n],box.stop[n]));
+					// a box with no extent covers at least one cell
+					box.stop[n] = min(max(box.stop[n], box.start[n]+1), numCells[n]);
+					box.start[n] = min(box.start[n], box.stop[n]-1);
+				}
+				box.cost = costs[t];
+				m_CostBoxes.push_back(box);
+			}
+		}
+	}
+}
+
+double openEMS_FDTD_MPI::CalcCost(const unsigned int start[3], const unsigned int stop[3]) const
+{
+	double cost = 0;
+	for (size_t i=0;i<m_CostBoxes.size();++i)
+	{
+		const CostBox& box = m_CostBoxes.at(i);
+		double vol = box.cost;
+		for (int n=0;n<3;++n)
+		{
+			unsigned int b_start = max(start[n], box.start[n]);
+			unsigned int b_stop = min(stop[n], box.stop[n]);
+			if (b_stop<=b_start)
+			{
+				vol = 0;
+				break;
+			}
+			vol *= b_stop-b_start;
+		}
+		cost += vol;
+	}
+	return cost;
+}
+
+double openEMS_FDTD_MPI::CalcPartitionCost(const vector<unsigned int> splits[3], double &sumSqr) const
+{
+	double maxCost = 0;
+	sumSqr = 0;
+	unsigned int start[3];
+	unsigned int stop[3];
+	for (size_t i=0;i<splits[0].size()-1;++i)
+		for (size_t j=0;j<splits[1].size()-1;++j)
+			for (size_t k=0;k<splits[2].size()-1;++k)
+			{
+				size_t pos[3] = {i,j,k};
+				for (int n=0;n<3;++n)
+				{
+					start[n] = splits[n].at(pos[n]);
+					stop[n] = splits[n].at(pos[n]+1);
+				}
+				double cost = CalcCost(start, stop);
+				// halo, one interface plane for each neighbour
+				for (int n=0;n<3;++n)
+				{
+					int nP  = (n+1)%3;
+					int nPP = (n+2)%3;
+					unsigned int numNeighbors = (pos[n]>0) + (pos[n]<splits[n].size()-2);
+					cost += MPI_COST_HALO*numNeighbors*(stop[nP]-start[nP])*(stop[nPP]-start[nPP]);
+				}
+				maxCost = max(maxCost, cost);
+				sumSqr += cost*cost;
+			}
+
+	// penalty for all splits inside a probe or excitation
+	double penalty = 0;
+	for (int n=0;n<3;++n)
+		for (size_t s=1;s<splits[n].size()-1;++s)
+			for (size_t r=0;r<m_NoSplitRanges[n].size();++r)
+				if ((splits[n].at(s)>m_NoSplitRanges[n].at(r).first) && (splits[n].at(s)<m_NoSplitRanges[n].at(r).second))
+					penalty += maxCost;
+	return maxCost + penalty;
+}
+
+bool openEMS_FDTD_MPI::GetSplitRange(int ny, unsigned int &minSplit, unsigned int &maxSplit) const
+{
+	unsigned int numCells = m_Original_Grid->GetQtyLines(ny)-1;
+	// keep the pml in a single part
+	unsigned int pml_lo = ((m_BC_type[2*ny]==3) || (m_BC_type[2*ny]==4)) ? m_PML_size[2*ny] : 0;
+	unsigned int pml_hi = ((m_BC_type[2*ny+1]==3) || (m_BC_type[2*ny+1]==4)) ? m_PML_size[2*ny+1] : 0;
+	// check before subtracting, the unsigned split range would wrap around otherwise
+	if (numCells < 2*MPI_SPLIT_MIN_CELLS + pml_lo + pml_hi)
+		return false;
+	minSplit = MPI_SPLIT_MIN_CELLS + pml_lo;
+	maxSplit = numCells - MPI_SPLIT_MIN_CELLS - pml_hi;
+	return true;
+}
+
+bool openEMS_FDTD_MPI::InitSplit(int ny, unsigned int numParts, vector<unsigned int> &splits) const
+{
+	unsigned int numCells = m_Original_Grid->GetQtyLines(ny)-1;
+	splits.clear();
+	splits.push_back(0);
+	if (numParts<=1)
+	{
+		splits.push_back(numCells);
+		return true;
+	}
+
+	// allowed split range, this process grid is rejected if the direction cannot be split into numParts parts
+	unsigned int minSplit, maxSplit;
+	if (!GetSplitRange(ny, minSplit, maxSplit))
+		return false;
+	if ((numCells<MPI_SPLIT_MIN_CELLS*numParts) || (maxSplit-minSplit<MPI_SPLIT_MIN_CELLS*(numParts-2)))
+		return false;
+
+	// cost of every cell slab in this direction
+	unsigned int start[3] = {0,0,0};
+	unsigned int stop[3];
+	for (int n=0;n<3;++n)
+		stop[n] = m_Original_Grid->GetQtyLines(n)-1;
+	vector<double> sum(numCells+1,0);
+	for (unsigned int i=0;i<numCells;++i)
+	{
+		start[ny] = i;
+		stop[ny] = i+1;
+		sum.at(i+1) = sum.at(i) + CalcCost(start, stop);
+	}
+
+	unsigned int line = 0;
+	for (unsigned int p=1;p<numParts;++p)
+	{
+		double target = sum.back()*p/numParts;
+		while ((line<numCells) && (sum.at(line)<target))
+			++line;
+		line = max(line, max(minSplit, splits.back()+MPI_SPLIT_MIN_CELLS));
+		line = min(line, maxSplit - MPI_SPLIT_MIN_CELLS*(numParts-1-p));
+		// move the split out of a probe or excitation if possible
+		for (size_t r=0;r<m_NoSplitRanges[ny].size();++r)
+		{
+			unsigned int r_start = m_NoSplitRanges[ny].at(r).first;
+			unsigned int r_stop = m_NoSplitRanges[ny].at(r).second;
+			if ((line<=r_start) || (line>=r_stop))
+				continue;
+			if ((line-r_start<=r_stop-line) && (r_start>=max(minSplit, splits.back()+MPI_SPLIT_MIN_CELLS)))
+				line = r_start;
+			else if (r_stop<=maxSplit - MPI_SPLIT_MIN_CELLS*(numParts-1-p))
+				line = r_stop;
+		}
+		splits.push_back(line);
+	}
+	splits.push_back(numCells);
+	return true;
+}
+
+void openEMS_FDTD_MPI::OptimizeSplits(vector<unsigned int> splits[3]) const
+{
+	double sumSqr;
+	double cost = CalcPartitionCost(splits, sumSqr);
+	for (int iter=0;iter<20;++iter)
+	{
+		bool improved = false;
+		for (int n=0;n<3;++n)
+		{
+			unsigned int minSplit, maxSplit;
+			if (!GetSplitRange(n, minSplit, maxSplit))
+				continue;
+			for (size_t s=1;s<splits[n].size()-1;++s)
+			{
+				unsigned int lower = max(minSplit, splits[n].at(s-1)+MPI_SPLIT_MIN_CELLS);
+				unsigned int upper = min(maxSplit, splits[n].at(s+1)-MPI_SPLIT_MIN_CELLS);
+				if (upper<=lower)
+					continue;
+				// try to move the split by decreasing steps into both directions
+				for (unsigned int step=max(1u,(upper-lower)/4); step>0; step/=2)
+				{
+					for (int dir=-1;dir<=1;dir+=2)
+					{
+						unsigned int old = splits[n].at(s);
+						if ((dir<0) && (old<lower+step))
+							continue;
+						if ((dir>0) && (old+step>upper))
+							continue;
+						splits[n].at(s) = old + dir*(int)step;
+						double newSumSqr;
+						double newCost = CalcPartitionCost(splits, newSumSqr);
+						if ((newCost<cost) || ((newCost==cost) && (newSumSqr<sumSqr)))
+						{
+							cost = newCost;
+							sumSqr = newSumSqr;
+							improved = true;
+						}
+						else
+							splits[n].at(s) = old;
+					}
+				}
+			}
+		}
+		if (!improved)
+			break;
+	}
+}
+
+bool openEMS_FDTD_MPI::AutoSplit()
+{
+	InitCostBoxes();
+
+	// initial (cost balanced) splits for all process grids
+	vector<vector<unsigned int> > gridSplits;
+	vector<pair<double,size_t> > gridCosts;
+	for (unsigned int px=1;px<=m_NumProc;++px)
+	{
+		if (m_NumProc%px)
+			continue;
+		for (unsigned int py=1;py<=m_NumProc/px;++py)
+		{
+			if ((m_NumProc/px)%py)
+				continue;
+			unsigned int numParts[3] = {px, py, m_NumProc/px/py};
+			vector<unsigned int> splits[3];
+			bool ok = true;
+			for (int n=0;n<3;++n)
+				ok &= InitSplit(n, numParts[n], splits[n]);
+			if (!ok)
+				continue;
+			double sumSqr;
+			gridCosts.push_back(make_pair(CalcPartitionCost(splits, sumSqr), gridSplits.size()/3));
+			for (int n=0;n<3;++n)
+				gridSplits.push_back(splits[n]);
+		}
+	}
+	if (gridCosts.empty())
+	{
+		if (m_MyID==0)
+			cerr << "openEMS_FDTD_MPI::AutoSplit: Error: the mesh is too small for " << m_NumProc << " processes, each part needs at least " << MPI_SPLIT_MIN_CELLS << " cells outside the pml, reduce the number of processes" << endl;
+		return false;
+	}
+
+	// optimize the most promising process grids
+	sort(gridCosts.begin(), gridCosts.end());
+	double bestCost = numeric_limits<double>::max();
+	double bestSumSqr = 0;
+	vector<unsigned int> bestSplits[3];
+	for (size_t g=0;g<min(gridCosts.size(),(size_t)3);++g)
+	{
+		vector<unsigned int> splits[3];
+		for (int n=0;n<3;++n)
+			splits[n] = gridSplits.at(3*gridCosts.at(g).second+n);
+		OptimizeSplits(splits);
+		double sumSqr;
+		double cost = CalcPartitionCost(splits, sumSqr);
+		if ((cost<bestCost) || ((cost==bestCost) && (sumSqr<bestSumSqr)))
+		{
+			bestCost = cost;
+			bestSumSqr = sumSqr;
+			for (int n=0;n<3;++n)
+				bestSplits[n] = splits[n];
+		}
+	}
+
+	unsigned int numCells[3] = {0,0,0};
+	for (int n=0;n<3;++n)
+	{
+		m_SplitNumber[n] = bestSplits[n];
+		numCells[n] = m_Original_Grid->GetQtyLines(n)-1;
+	}
+
+	double sumSqr;
+	double cost = CalcPartitionCost(m_SplitNumber, sumSqr);
+	unsigned int start[3] = {0,0,0};
+	double avgCost = CalcCost(start, numCells)/m_NumProc;
+	if (m_MyID==0)
+	{
+		cout << "openEMS_FDTD_MPI::AutoSplit: Using a process grid of " << m_SplitNumber[0].size()-1 << "x" << m_SplitNumber[1].size()-1 << "x" << m_SplitNumber[2].size()-1;
+		cout << ", estimated cost of the slowest process (incl. halo) relative to the average: " << cost/avgCost << endl;
+		string names[] = {"x", "y", "z"};
+		for (int n=0;n<3;++n)
+		{
+			cout << "openEMS_FDTD_MPI::AutoSplit: Split lines in " << names[n] << "-direction:";
+			for (size_t s=1;s<m_SplitNumber[n].size()-1;++s)
+				cout << " " << m_SplitNumber[n].at(s);
+			cout << endl;
+		}
+	}
+	for (int n=0;n<3;++n)
+		for (size_t s=1;s<m_SplitNumber[n].size()-1;++s)
+			for (size_t r=0;r<m_NoSplitRanges[n].size();++r)
+				if ((m_SplitNumber[n].at(s)>m_NoSplitRanges[n].at(r).first) && (m_SplitNumber[n].at(s)<m_NoSplitRanges[n].at(r).second) && (m_MyID==0))
+					cerr << "openEMS_FDTD_MPI::AutoSplit: Warning: unable to avoid a split inside a probe or excitation at line " << m_SplitNumber[n].at(s) << endl;
+	return true;
+}
+
 bool openEMS_FDTD_MPI::SetupOperator()
 {
 	bool ret = true;
@@ -325,12 +736,17 @@ bool openEMS_FDTD_MPI::SetupOperator()
 	return ret;
 }
 
-unsigned int openEMS_FDTD_MPI::GetNextStep()
+unsigned int openEMS_FDTD_MPI::GetNextStep(bool process)
 {
 	//start processing and get local next step
-	int step=PA->Process();
+	int step;
+	if (process)
+		step=PA->Process();
+	else
+		step=PA->GetNextInterval();
 	double currTS = FDTD_Eng->GetNumberOfTimesteps();
 	if ((step<0) || (step>(int)(NrTS - currTS))) step=NrTS - currTS;
+	step=LimitStepToCheckpoint(step);
 
 	int local_step=step;
 
@@ -342,6 +758,33 @@ unsigned int openEMS_FDTD_MPI::GetNextStep()
 	return step;
 }
 
+string openEMS_FDTD_MPI::GetCheckpointFile() const
+{
+	string filename = openEMS::GetCheckpointFile();
+	if (!m_MPI_Enabled)
+		return filename;
+	stringstream ss;
+	ss << filename << "_ID" << m_MyID;
+	return ss.str();
+}
+
+#define MPI_CHECKPOINT_POLL_INTERVAL 100 // timesteps between two checks for a termination signal received by any process
+
+bool openEMS_FDTD_MPI::CheckpointRequested()
+{
+	if (!m_MPI_Enabled)
+		return openEMS::CheckpointRequested();
+	// all processes are at the same timestep, skipping the collective check is consistent on all processes
+	unsigned int numTS = FDTD_Eng->GetNumberOfTimesteps();
+	if (numTS<m_NextCheckpointPoll)
+		return false;
+	m_NextCheckpointPoll = numTS + MPI_CHECKPOINT_POLL_INTERVAL;
+	int local_Req = (int)openEMS::CheckpointRequested();
+	int result;
+	MPI_Allreduce(&local_Req, &result, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+	return result>0;
+}
+
 bool openEMS_FDTD_MPI::CheckEnergyCalc()
 {
 	int local_Check = (int)m_ProcField->CheckTimestep();
@@ -451,7 +894,8 @@ void openEMS_FDTD_MPI::RunFDTD()
 	m_ProcField = new ProcessFields(NewEngineInterface());
 	PA->AddProcessing(m_ProcField);
 
-	//init processings
+	//init processings, resume the existing dump files on restart
+	PA->SetResume(m_Restart);
 	PA->InitAll();
 
 	double currE=0;
@@ -477,13 +921,34 @@ void openEMS_FDTD_MPI::RunFDTD()
 		InitRunStatistics(__OPENEMS_RUN_STAT_FILE__);
 	//*************** simulate ************//
 	PA->PreProcess();
-	int step = GetNextStep();
+	if (m_Restart)
+	{
+		int local_ok = (int)ReadCheckpoint(m_MaxEnergy);
+		int ok;
+		//all processes have to resume from their checkpoint
+		MPI_Allreduce(&local_ok, &ok, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+		if (ok==0)
+			exit(-1);
+		prevTS=FDTD_Eng->GetNumberOfTimesteps();
+	}
+	unsigned int startTS=prevTS;
+	// the current timestep was already processed before the checkpoint was written
+	int step = GetNextStep(!m_Restart);
+	if (!m_CheckpointFile.empty())
+		SetCheckpointSignals(true);
+	bool stopped=false;
 
 	while ((step>0) && !CheckAbortCond())
 	{
 		FDTD_Eng->IterateTS(step);
 		step = GetNextStep();
 
+		if (HandleCheckpoint(m_MaxEnergy))
+		{
+			stopped=true;
+			break;
+		}
+
 		currTS = FDTD_Eng->GetNumberOfTimesteps();
 
 		currE = 0;
@@ -524,6 +989,13 @@ void openEMS_FDTD_MPI::RunFDTD()
 			PA->FlushNext();
 		}
 	}
+	if (!m_CheckpointFile.empty())
+		SetCheckpointSignals(false);
+	if (stopped)
+	{
+		// the run is incomplete, skip the post-processing, it is done by the restarted run
+		return;
+	}
 	if ((m_MyID==0) && (m_EnergyDecrement>endCrit) && (FDTD_Op->GetExcitationSignal()->GetExciteType()==0))
 		cerr << "RunFDTD: max. number of timesteps was reached before the end-criteria of -" << fabs(10.0*log10(endCrit)) << "dB was reached... " << endl << \
 				"\tYou may want to choose a higher number of max. timesteps... " << endl;
@@ -535,7 +1007,7 @@ void openEMS_FDTD_MPI::RunFDTD()
 	if (m_MyID==0)
 	{
 		cout << "Time for " << FDTD_Eng->GetNumberOfTimesteps() << " iterations with " << FDTD_Op->GetNumberCells() << " cells : " << t_diff << " sec" << endl;
-		cout << "Speed: " << numCells*(double)FDTD_Eng->GetNumberOfTimesteps()/t_diff*1e-6 << " MCells/s " << endl;
+		cout << "Speed: " << numCells*(double)(FDTD_Eng->GetNumberOfTimesteps()-startTS)/t_diff*1e-6 << " MCells/s " << endl;
 
 		if (m_DumpStats)
 			DumpStatistics(__OPENEMS_STAT_FILE__, t_diff);
@@ -49,10 +49,45 @@ protected:
 	std::vector<unsigned int> m_SplitNumber[3];
 	TiXmlElement* m_MPI_Elem;
 	virtual bool SetupMPI();
+
+	//! Choose the process grid and split positions automatically from an estimated cost of all cells
+	bool m_AutoSplit;
+	//! A box of cells [start, stop) of the original mesh with an additional (estimated) update cost per cell
+	struct CostBox
+	{
+		unsigned int start[3];
+		unsigned int stop[3];
+		double cost;
+	};
+	std::vector<CostBox> m_CostBoxes;
+	//! Line ranges (start, stop) that should not be split, e.g. integral probes and excitations
+	std::vector<std::pair<unsigned int, unsigned int> > m_NoSplitRanges[3];
+	//! Setup the cost boxes from the mesh, boundary conditions, dispersive materials, excitations and probes
+	void InitCostBoxes();
+	//! Estimated cost of all cells in the box [start, stop)
+	double CalcCost(const unsigned int start[3], const unsigned int stop[3]) const;
+	//! Estimated cost of a partition: cost of the slowest rank including its halo, penalty for splits inside no-split ranges (sumSqr: sum of squared rank costs)
+	double CalcPartitionCost(const std::vector<unsigned int> splits[3], double &sumSqr) const;
+	//! Get the allowed range [minSplit, maxSplit] of the split lines in the given direction, returns false if the direction is too small to be split
+	bool GetSplitRange(int ny, unsigned int &minSplit, unsigned int &maxSplit) const;
+	//! Split a direction into numParts parts of (about) equal cost, returns false if not possible
+	bool InitSplit(int ny, unsigned int numParts, std::vector<unsigned int> &splits) const;
+	//! Improve the split positions of all directions by a local search
+	void OptimizeSplits(std::vector<unsigned int> splits[3]) const;
+	//! Find the best process grid and split positions for all processes
+	bool AutoSplit();
 	virtual bool SetupOperator();
 
 	int* m_Gather_Buffer;
-	unsigned int GetNextStep();
+	//! Get the next step agreed by all processes, \a process: run the processings of the current timestep first
+	unsigned int GetNextStep(bool process=true);
+
+	//! Separate checkpoint file for every process
+	virtual std::string GetCheckpointFile() const;
+	//! A checkpoint is requested if any process received a termination signal, checked every MPI_CHECKPOINT_POLL_INTERVAL timesteps
+	virtual bool CheckpointRequested();
+	//! Timestep of the next check for a termination signal of any process
+	unsigned int m_NextCheckpointPoll;
 
 	ProcessFields* m_ProcField;
 	double m_MaxEnergy;
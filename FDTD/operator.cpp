@@ -16,6 +16,10 @@
 */
 
 #include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <typeinfo>
+#include <cstring>
 #include <algorithm>
 #include "operator.h"
 #include "engine.h"
@@ -24,6 +28,8 @@
 #include "Common/processfields.h"
 #include "tools/array_ops.h"
 #include "tools/vtk_file_writer.h"
+#include "tools/useful.h"
+#include "tinyxml.h"
 #include "fparser.hh"
 #include "extensions/operator_ext_excitation.h"
 
@@ -37,6 +43,34 @@
 #include "CSPropMaterial.h"
 #include "CSPropLumpedElement.h"
 
+//! minimum number of mesh lines per bin of the primitive index
+#define PRIM_INDEX_MIN_BIN_LINES 4
+//! maximum number of bins per direction of the primitive index
+#define PRIM_INDEX_MAX_BINS 256
+
+//! version of the operator cache file layout, increase on every change of the layout or the operator calculation
+#define OPERATOR_CACHE_VERSION 1
+
+//! Header of an operator cache file
+/*!
+  The header is followed by the usage flags of all cached primitives (one char each), the EC arrays (C,G,L,R for all 3 directions),
+  the operator arrays (vv,vi,ii,iv for all 3 directions, z-line by z-line) and all stored material arrays (epsR,kappa,mueR,sigma).
+  */
+struct OperatorCacheHeader
+{
+	char magic[16];
+	unsigned int version;
+	unsigned int floatSize;
+	uint64_t hash;
+	unsigned int numLines[3];
+	unsigned int numPrims;
+	unsigned int numPEC[3];
+	int invalidTimestep;
+	double dT;
+	double opt_dT;
+	char timestepName[64];
+};
+
 Operator* Operator::New()
 {
 	cout << "Create FDTD operator" << endl;
@@ -71,6 +105,7 @@ void Operator::Init()
 {
 	CSX = NULL;
 	m_Engine = NULL;
+	m_OperatorHash = 0;
 
 	Operator_Base::Init();
 
@@ -97,6 +132,8 @@ void Operator::Init()
 	m_Exc = 0;
 	m_TimeStepFactor = 1;
 	SetMaterialAvgMethod(QuarterCell);
+
+	ClearPrimitiveIndex();
 }
 
 void Operator::Delete()
@@ -533,6 +570,12 @@ void Operator::ShowStat() const
 	cout << "Nyquist criteria (TS)\t: " << m_Exc->GetNyquistNum() << endl;
 	cout << "Nyquist criteria (s)\t: " << m_Exc->GetNyquistNum()*dT << endl;
 	cout << "-----------------------------------" << endl;
+	if (m_SetupTimes.size()==0)
+		return;
+	cout << "Setup time per stage (" << GetNumberOfSetupThreads() << " threads):" << endl;
+	for (size_t n=0; n<m_SetupTimes.size(); ++n)
+		cout << "  " << m_SetupTimes.at(n).first << "\t: " << m_SetupTimes.at(n).second << " s" << endl;
+	cout << "-----------------------------------" << endl;
 }
 
 void Operator::ShowExtStat() const
@@ -749,11 +792,13 @@ void Operator::DumpMaterial2File(string filename)
 	FDTD_FLOAT**** sigma   = Create_N_3DArray<FDTD_FLOAT>(numLines);
 
 	unsigned int pos[3];
+	vector<CSPrimitives*> vPrims;
+	vector<unsigned int> primScratch;
 	for (pos[0]=0; pos[0]<numLines[0]; ++pos[0])
 	{
 		for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
 		{
-			vector<CSPrimitives*> vPrims = this->GetPrimitivesBoundBox(pos[0], pos[1], -1, CSProperties::MATERIAL);
+			this->GetPrimitivesBoundBox(pos[0], pos[1], -1, CSProperties::MATERIAL, vPrims, primScratch);
 			for (pos[2]=0; pos[2]<numLines[2]; ++pos[2])
 			{
 				for (int n=0; n<3; ++n)
@@ -833,7 +878,76 @@ bool Operator::SetGeometryCSX(ContinuousStructure* geo)
 	SetBackgroundDensity(0);
 
 	CSRectGrid* grid=CSX->GetGrid();
-	return SetupCSXGrid(CSRectGrid::Clone(grid));
+	if (SetupCSXGrid(CSRectGrid::Clone(grid))==false)
+		return false;
+
+	BuildPrimitiveIndex();
+	return true;
+}
+
+void Operator::ClearPrimitiveIndex()
+{
+	m_IndexPrims.clear();
+	m_IndexBins.clear();
+	for (int n=0; n<2; ++n)
+	{
+		m_IndexBinLines[n]=0;
+		m_IndexNumBins[n]=0;
+	}
+}
+
+void Operator::BuildPrimitiveIndex()
+{
+	ClearPrimitiveIndex();
+	if (CSX==NULL)
+		return;
+
+	m_IndexPrims = CSX->GetAllPrimitives(true, CSProperties::ANY);
+	if (m_IndexPrims.size()==0)
+		return;
+
+	for (int n=0; n<2; ++n)
+	{
+		unsigned int numCells = max(1u, numLines[n]-1);
+		m_IndexBinLines[n] = max((unsigned int)PRIM_INDEX_MIN_BIN_LINES, (numCells+PRIM_INDEX_MAX_BINS-1)/PRIM_INDEX_MAX_BINS);
+		m_IndexNumBins[n]  = (numCells+m_IndexBinLines[n]-1)/m_IndexBinLines[n];
+	}
+	m_IndexBins.resize(m_IndexNumBins[0]*m_IndexNumBins[1]);
+
+	// the bins span the full z-range, a primitive is stored in every bin it may touch
+	// (the primitive itself decides, thus primitives with an unknown extent are stored in every bin)
+	double binBox[6];
+	binBox[4] = GetDiscLine(2,0);
+	binBox[5] = GetDiscLine(2,numLines[2]-1);
+	vector<unsigned int> slab;
+	size_t numEntries = 0;
+	for (unsigned int bx=0; bx<m_IndexNumBins[0]; ++bx)
+	{
+		binBox[0] = GetDiscLine(0, bx*m_IndexBinLines[0]);
+		binBox[1] = GetDiscLine(0, min(numLines[0]-1, (bx+1)*m_IndexBinLines[0]));
+		binBox[2] = GetDiscLine(1, 0);
+		binBox[3] = GetDiscLine(1, numLines[1]-1);
+
+		// pre-select all primitives inside the current x-slab
+		slab.clear();
+		for (unsigned int i=0; i<m_IndexPrims.size(); ++i)
+			if (m_IndexPrims.at(i)->IsInsideBox(binBox)!=-1)
+				slab.push_back(i);
+
+		for (unsigned int by=0; by<m_IndexNumBins[1]; ++by)
+		{
+			binBox[2] = GetDiscLine(1, by*m_IndexBinLines[1]);
+			binBox[3] = GetDiscLine(1, min(numLines[1]-1, (by+1)*m_IndexBinLines[1]));
+			vector<unsigned int>& bin = m_IndexBins.at(bx*m_IndexNumBins[1]+by);
+			for (size_t i=0; i<slab.size(); ++i)
+				if (m_IndexPrims.at(slab.at(i))->IsInsideBox(binBox)!=-1)
+					bin.push_back(slab.at(i));
+			numEntries += bin.size();
+		}
+	}
+
+	if (g_settings.GetVerboseLevel()>0)
+		cerr << "Operator::BuildPrimitiveIndex: Indexed " << m_IndexPrims.size() << " primitives into " << m_IndexNumBins[0] << "x" << m_IndexNumBins[1] << " bins with " << numEntries << " entries" << endl;
 }
 
 void Operator::InitOperator()
@@ -943,7 +1057,11 @@ void Operator::SetExcitationSignal(Excitation* exc)
 
 void Operator::Calc_ECOperatorPos(int n, unsigned int* pos)
 {
-	unsigned int i = MainOp->SetPos(pos[0],pos[1],pos[2]);
+	Calc_ECOperatorPos(n, pos, MainOp->SetPos(pos[0],pos[1],pos[2]));
+}
+
+void Operator::Calc_ECOperatorPos(int n, const unsigned int* pos, unsigned int i)
+{
 	double C = EC_C[n][i];
 	double G = EC_G[n][i];
 	if (C>0)
@@ -971,13 +1089,112 @@ void Operator::Calc_ECOperatorPos(int n, unsigned int* pos)
 	}
 }
 
+void Operator::Calc_ECOperator_Range(unsigned int startX, unsigned int stopX, unsigned int threadID)
+{
+	UNUSED(threadID);
+	unsigned int pos[3];
+	for (int n=0; n<3; ++n)
+	{
+		for (pos[0]=startX; pos[0]<=stopX; ++pos[0])
+		{
+			for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
+			{
+				for (pos[2]=0; pos[2]<numLines[2]; ++pos[2])
+				{
+					Calc_ECOperatorPos(n,pos,MainOp->GetPos(pos[0],pos[1],pos[2]));
+				}
+			}
+		}
+	}
+}
+
+void Operator::RunRangeJob(RangeJob* job, unsigned int size)
+{
+	if (size>0)
+		job->Run(0,size-1,0);
+}
+
+void Operator::AddSetupTime(string stage, double& start)
+{
+	double now = GetWallTime();
+	m_SetupTimes.push_back(pair<string,double>(stage, now-start));
+	start = now;
+}
+
 int Operator::CalcECOperator( DebugFlags debugFlags )
 {
+	m_SetupTimes.clear();
+	double stageTime = GetWallTime();
+
 	Init_EC();
 	InitDataStorage();
 
+	// hash the timestep settings before the calculation, dT is the forced timestep (or zero) at this point
+	m_OperatorHash = CalcOperatorHash();
+	string cacheFile = GetOperatorCacheFile();
+	if (cacheFile.empty() || (ReadOperatorCache(cacheFile)==false))
+	{
+		if (Calc_Operator()==false)
+			return -1;
+		stageTime = GetWallTime();
+		if (!cacheFile.empty())
+		{
+			WriteOperatorCache(cacheFile);
+			AddSetupTime("Operator cache write", stageTime);
+		}
+	}
+	else
+		AddSetupTime("Operator cache read", stageTime);
+
+	//all information available for extension... create now...
+	for (size_t n=0; n<m_Op_exts.size(); ++n)
+	{
+		m_Op_exts.at(n)->BuildExtension();
+		AddSetupTime(m_Op_exts.at(n)->GetExtensionName(), stageTime);
+	}
+
+	//remove inactive extensions
+	vector<Operator_Extension*>::iterator it = m_Op_exts.begin();
+	while (it!=m_Op_exts.end())
+	{
+		if ( (*it)->IsActive() == false)
+		{
+			DeleteExtension((*it));
+			it = m_Op_exts.begin(); //restart search for inactive extension
+		}
+		else
+			++it;
+	}
+
+	if (debugFlags & debugMaterial)
+		DumpMaterial2File( "material_dump" );
+	if (debugFlags & debugOperator)
+		DumpOperator2File( "operator_dump" );
+	if (debugFlags & debugPEC)
+		DumpPEC2File( "PEC_dump" );
+
+	//cleanup
+	for (int n=0; n<3; ++n)
+	{
+		delete[] EC_C[n];
+		EC_C[n]=NULL;
+		delete[] EC_G[n];
+		EC_G[n]=NULL;
+		delete[] EC_L[n];
+		EC_L[n]=NULL;
+		delete[] EC_R[n];
+		EC_R[n]=NULL;
+	}
+
+	return 0;
+}
+
+bool Operator::Calc_Operator()
+{
+	double stageTime = GetWallTime();
 	if (Calc_EC()==0)
-		return -1;
+		return false;
+	AddSetupTime("Equivalent circuit", stageTime);
 
 	m_InvaildTimestep = false;
 	opt_dT = 0;
@@ -1008,24 +1225,14 @@ int Operator::CalcECOperator( DebugFlags debugFlags )
 	}
 
 	m_Exc->Reset(dT);
+	AddSetupTime("Timestep", stageTime);
 
 	InitOperator();
 
-	unsigned int pos[3];
-
-	for (int n=0; n<3; ++n)
-	{
-		for (pos[0]=0; pos[0]<numLines[0]; ++pos[0])
-		{
-			for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
-			{
-				for (pos[2]=0; pos[2]<numLines[2]; ++pos[2])
-				{
-					Calc_ECOperatorPos(n,pos);
-				}
-			}
-		}
-	}
+	MainOp->SetPos(0,0,0);
+	RangeJobMember<Operator> opJob(this, &Operator::Calc_ECOperator_Range);
+	RunRangeJob(&opJob, numLines[0]);
+	AddSetupTime("Operator coefficients", stageTime);
 
 	//Apply PEC to all boundary's
 	bool PEC[6]={1,1,1,1,1,1};
@@ -1036,52 +1243,283 @@ int Operator::CalcECOperator( DebugFlags debugFlags )
 	ApplyElectricBC(PEC);
 
 	CalcPEC();
+	AddSetupTime("PEC", stageTime);
 
 	Calc_LumpedElements();
+	AddSetupTime("Lumped elements", stageTime);
 
 	bool PMC[6];
 	for (int n=0; n<6; ++n)
 		PMC[n] = m_BC[n]==1;
 	ApplyMagneticBC(PMC);
 
-	//all information available for extension... create now...
-	for (size_t n=0; n<m_Op_exts.size(); ++n)
-		m_Op_exts.at(n)->BuildExtension();
+	return true;
+}
 
-	//remove inactive extensions
-	vector<Operator_Extension*>::iterator it = m_Op_exts.begin();
-	while (it!=m_Op_exts.end())
+bool Operator::IsCachedProperty(CSProperties* prop)
+{
+	// excitations, probes and dumps are not part of the operator, changing them is allowed for a cached operator
+	return (prop->GetType() & (CSProperties::EXCITATION | CSProperties::PROBEBOX | CSProperties::DUMPBOX))==0;
+}
+
+uint64_t Operator::CalcOperatorHash() const
+{
+	uint64_t hash = HashValue(OPERATOR_CACHE_VERSION);
+	string opType = typeid(*this).name();
+	hash = HashData(opType.c_str(), opType.size(), hash);
+	hash = HashValue(sizeof(FDTD_FLOAT), hash);
+
+	// mesh
+	for (int n=0; n<3; ++n)
 	{
-		if ( (*it)->IsActive() == false)
-		{
-			DeleteExtension((*it));
-			it = m_Op_exts.begin(); //restart search for inactive extension
-		}
-		else
-			++it;
+		hash = HashValue(numLines[n], hash);
+		hash = HashData(discLines[n], numLines[n]*sizeof(double), hash);
 	}
+	hash = HashValue(GetGridDelta(), hash);
 
-	if (debugFlags & debugMaterial)
-		DumpMaterial2File( "material_dump" );
-	if (debugFlags & debugOperator)
-		DumpOperator2File( "operator_dump" );
-	if (debugFlags & debugPEC)
-		DumpPEC2File( "PEC_dump" );
+	// operator settings
+	hash = HashData(m_BC, sizeof(m_BC), hash);
+	hash = HashData(m_BC_Size, sizeof(m_BC_Size), hash);
+	hash = HashValue((int)m_MatAverageMethod, hash);
+	hash = HashValue(m_TimeStepVar, hash);
+	hash = HashValue(m_TimeStepFactor, hash);
+	hash = HashValue(dT, hash); // the forced timestep, see CalcECOperator
+	hash = HashValue(m_Exc->GetSignalPeriod(), hash);
+	for (int n=0; n<4; ++n)
+		hash = HashValue((int)m_StoreMaterial[n], hash);
+	hash = HashValue(GetBackgroundEpsR(), hash);
+	hash = HashValue(GetBackgroundMueR(), hash);
+	hash = HashValue(GetBackgroundKappa(), hash);
+	hash = HashValue(GetBackgroundSigma(), hash);
+
+	// geometry
+	for (size_t i=0; i<CSX->GetQtyProperties(); ++i)
+	{
+		CSProperties* prop = CSX->GetProperty(i);
+		if (IsCachedProperty(prop)==false)
+			continue;
+		TiXmlElement elem(prop->GetTypeXMLString().c_str());
+		prop->Write2XML(elem, false, false);
+		TiXmlPrinter printer;
+		elem.Accept(&printer);
+		hash = HashData(printer.CStr(), printer.Size(), hash);
+	}
+	return hash;
+}
 
-	//cleanup
+string Operator::GetOperatorCacheFile() const
+{
+	if (m_CacheDir.empty() || (CSX==NULL))
+		return string();
+	stringstream ss;
+	ss << m_CacheDir << "/openEMS_op_" << hex << setw(16) << setfill('0') << m_OperatorHash << ".cache";
+	return ss.str();
+}
+
+vector<CSPrimitives*> Operator::GetCachedPrimitives() const
+{
+	vector<CSPrimitives*> vPrims;
+	for (size_t i=0; i<CSX->GetQtyProperties(); ++i)
+	{
+		CSProperties* prop = CSX->GetProperty(i);
+		if (IsCachedProperty(prop)==false)
+			continue;
+		vector<CSPrimitives*> prims = prop->GetAllPrimitives();
+		vPrims.insert(vPrims.end(), prims.begin(), prims.end());
+	}
+	return vPrims;
+}
+
+bool Operator::WriteOperatorCache(string filename) const
+{
+	// write to a temporary file first, parallel runs must never read a partially written cache
+	string tmpFile = filename + ".tmp";
+	ofstream file(tmpFile.c_str(), ios::out | ios::binary);
+	if (!file.is_open())
+	{
+		cerr << "Operator::WriteOperatorCache: Warning, can't open file: " << tmpFile << endl;
+		return false;
+	}
+
+	vector<CSPrimitives*> vPrims = GetCachedPrimitives();
+
+	OperatorCacheHeader header;
+	memset(&header, 0, sizeof(header));
+	strncpy(header.magic, "openEMS_OpCache", sizeof(header.magic)-1);
+	header.version = OPERATOR_CACHE_VERSION;
+	header.floatSize = sizeof(FDTD_FLOAT);
+	header.hash = m_OperatorHash;
 	for (int n=0; n<3; ++n)
 	{
-		delete[] EC_C[n];
-		EC_C[n]=NULL;
-		delete[] EC_G[n];
-		EC_G[n]=NULL;
-		delete[] EC_L[n];
-		EC_L[n]=NULL;
-		delete[] EC_R[n];
-		EC_R[n]=NULL;
+		header.numLines[n] = numLines[n];
+		header.numPEC[n] = m_Nr_PEC[n];
 	}
+	header.numPrims = vPrims.size();
+	header.invalidTimestep = m_InvaildTimestep;
+	header.dT = dT;
+	header.opt_dT = opt_dT;
+	strncpy(header.timestepName, m_Used_TS_Name.c_str(), sizeof(header.timestepName)-1);
+	file.write((char*)&header, sizeof(header));
 
-	return 0;
+	vector<char> used(vPrims.size()+1);
+	for (size_t i=0; i<vPrims.size(); ++i)
+		used.at(i) = vPrims.at(i)->GetPrimitiveUsed();
+	file.write(&used[0], vPrims.size());
+
+	unsigned int size = MainOp->GetSize();
+	for (int n=0; n<3; ++n)
+	{
+		file.write((char*)EC_C[n], size*sizeof(FDTD_FLOAT));
+		file.write((char*)EC_G[n], size*sizeof(FDTD_FLOAT));
+		file.write((char*)EC_L[n], size*sizeof(FDTD_FLOAT));
+		file.write((char*)EC_R[n], size*sizeof(FDTD_FLOAT));
+	}
+
+	vector<FDTD_FLOAT> line(numLines[2]);
+	unsigned int pos[3];
+	for (int type=0; type<4; ++type)
+		for (int n=0; n<3; ++n)
+			for (pos[0]=0; pos[0]<numLines[0]; ++pos[0])
+				for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
+				{
+					for (pos[2]=0; pos[2]<numLines[2]; ++pos[2])
+					{
+						switch (type)
+						{
+						case 0:
+							line[pos[2]] = GetVV(n,pos[0],pos[1],pos[2]);
+							break;
+						case 1:
+							line[pos[2]] = GetVI(n,pos[0],pos[1],pos[2]);
+							break;
+						case 2:
+							line[pos[2]] = GetII(n,pos[0],pos[1],pos[2]);
+							break;
+						default:
+							line[pos[2]] = GetIV(n,pos[0],pos[1],pos[2]);
+							break;
+						}
+					}
+					file.write((char*)&line[0], numLines[2]*sizeof(FDTD_FLOAT));
+				}
+
+	float**** matStorage[4] = {m_epsR, m_kappa, m_mueR, m_sigma};
+	for (int m=0; m<4; ++m)
+	{
+		if (matStorage[m]==NULL)
+			continue;
+		for (int n=0; n<3; ++n)
+			for (pos[0]=0; pos[0]<numLines[0]; ++pos[0])
+				for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
+					file.write((char*)matStorage[m][n][pos[0]][pos[1]], numLines[2]*sizeof(float));
+	}
+
+	file.close();
+	if (file.fail() || (rename(tmpFile.c_str(), filename.c_str())!=0))
+	{
+		cerr << "Operator::WriteOperatorCache: Warning, writing the operator cache failed: " << filename << endl;
+		remove(tmpFile.c_str());
+		return false;
+	}
+	cout << "Operator::WriteOperatorCache: Operator written to cache: " << filename << endl;
+	return true;
+}
+
+bool Operator::ReadOperatorCache(string filename)
+{
+	ifstream file(filename.c_str(), ios::in | ios::binary);
+	if (!file.is_open())
+		return false;
+
+	vector<CSPrimitives*> vPrims = GetCachedPrimitives();
+
+	OperatorCacheHeader header;
+	file.read((char*)&header, sizeof(header));
+	header.magic[sizeof(header.magic)-1] = 0;
+	header.timestepName[sizeof(header.timestepName)-1] = 0;
+	bool valid = file.good() && (strcmp(header.magic, "openEMS_OpCache")==0);
+	valid &= (header.version==OPERATOR_CACHE_VERSION) && (header.floatSize==sizeof(FDTD_FLOAT));
+	valid &= (header.hash==m_OperatorHash) && (header.numPrims==vPrims.size());
+	for (int n=0; n<3; ++n)
+		valid &= (header.numLines[n]==numLines[n]);
+	if (!valid)
+	{
+		cerr << "Operator::ReadOperatorCache: Warning, invalid or outdated operator cache: " << filename << ", ignoring..." << endl;
+		return false;
+	}
+
+	vector<char> used(vPrims.size()+1);
+	file.read(&used[0], vPrims.size());
+
+	unsigned int size = MainOp->GetSize();
+	for (int n=0; n<3; ++n)
+	{
+		file.read((char*)EC_C[n], size*sizeof(FDTD_FLOAT));
+		file.read((char*)EC_G[n], size*sizeof(FDTD_FLOAT));
+		file.read((char*)EC_L[n], size*sizeof(FDTD_FLOAT));
+		file.read((char*)EC_R[n], size*sizeof(FDTD_FLOAT));
+	}
+
+	dT = header.dT;
+	InitOperator();
+
+	vector<FDTD_FLOAT> line(numLines[2]);
+	unsigned int pos[3];
+	for (int type=0; type<4; ++type)
+		for (int n=0; n<3; ++n)
+			for (pos[0]=0; pos[0]<numLines[0]; ++pos[0])
+				for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
+				{
+					file.read((char*)&line[0], numLines[2]*sizeof(FDTD_FLOAT));
+					for (pos[2]=0; pos[2]<numLines[2]; ++pos[2])
+					{
+						switch (type)
+						{
+						case 0:
+							SetVV(n,pos[0],pos[1],pos[2],line[pos[2]]);
+							break;
+						case 1:
+							SetVI(n,pos[0],pos[1],pos[2],line[pos[2]]);
+							break;
+						case 2:
+							SetII(n,pos[0],pos[1],pos[2],line[pos[2]]);
+							break;
+						default:
+							SetIV(n,pos[0],pos[1],pos[2],line[pos[2]]);
+							break;
+						}
+					}
+				}
+
+	float**** matStorage[4] = {m_epsR, m_kappa, m_mueR, m_sigma};
+	for (int m=0; m<4; ++m)
+	{
+		if (matStorage[m]==NULL)
+			continue;
+		for (int n=0; n<3; ++n)
+			for (pos[0]=0; pos[0]<numLines[0]; ++pos[0])
+				for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
+					file.read((char*)matStorage[m][n][pos[0]][pos[1]], numLines[2]*sizeof(float));
+	}
+
+	if (file.fail())
+	{
+		cerr << "Operator::ReadOperatorCache: Warning, operator cache is truncated: " << filename << ", ignoring..." << endl;
+		return false;
+	}
+
+	for (size_t i=0; i<vPrims.size(); ++i)
+		vPrims.at(i)->SetPrimitiveUsed(used.at(i)!=0);
+	for (int n=0; n<3; ++n)
+		m_Nr_PEC[n] = header.numPEC[n];
+	m_InvaildTimestep = header.invalidTimestep;
+	opt_dT = header.opt_dT;
+	m_Used_TS_Name = header.timestepName;
+
+	m_Exc->Reset(dT);
+
+	cout << "Operator::ReadOperatorCache: Using cached operator: " << filename << endl;
+	return true;
 }
 
 void Operator::ApplyElectricBC(bool* dirs)
@@ -1174,7 +1612,7 @@ void Operator::ApplyMagneticBC(bool* dirs)
 	}
 }
 
-bool Operator::Calc_ECPos(int ny, const unsigned int* pos, double* EC, vector<CSPrimitives*> vPrims) const
+bool Operator::Calc_ECPos(int ny, const unsigned int* pos, double* EC, const vector<CSPrimitives*>& vPrims) const
 {
 	double EffMat[4];
 	Calc_EffMatPos(ny,pos,EffMat, vPrims);
@@ -1249,7 +1687,7 @@ bool Operator::GetCellCenterMaterialAvgCoord(const int pos[], double coord[3]) c
 	return true;
 }
 
-double Operator::GetMaterial(int ny, const double* coords, int MatType, vector<CSPrimitives*> vPrims, bool markAsUsed) const
+double Operator::GetMaterial(int ny, const double* coords, int MatType, const vector<CSPrimitives*>& vPrims, bool markAsUsed) const
 {
 	CSProperties* prop = CSX->GetPropertyByCoordPriority(coords,vPrims,markAsUsed);
 //	CSProperties* old_prop = CSX->GetPropertyByCoordPriority(coords,CSProperties::MATERIAL,markAsUsed);
@@ -1298,7 +1736,7 @@ double Operator::GetMaterial(int ny, const double* coords, int MatType, vector<C
 	}
 }
 
-bool Operator::AverageMatCellCenter(int ny, const unsigned int* pos, double* EffMat, vector<CSPrimitives *> vPrims) const
+bool Operator::AverageMatCellCenter(int ny, const unsigned int* pos, double* EffMat, const vector<CSPrimitives*>& vPrims) const
 {
 	int n=ny;
 	double coord[3];
@@ -1404,7 +1842,7 @@ bool Operator::AverageMatCellCenter(int ny, const unsigned int* pos, double* Eff
 	return true;
 }
 
-bool Operator::AverageMatQuarterCell(int ny, const unsigned int* pos, double* EffMat, vector<CSPrimitives*> vPrims) const
+bool Operator::AverageMatQuarterCell(int ny, const unsigned int* pos, double* EffMat, const vector<CSPrimitives*>& vPrims) const
 {
 	int n=ny;
 	double coord[3];
@@ -1518,7 +1956,7 @@ bool Operator::AverageMatQuarterCell(int ny, const unsigned int* pos, double* Ef
 	return true;
 }
 
-bool Operator::Calc_EffMatPos(int ny, const unsigned int* pos, double* EffMat, vector<CSPrimitives *> vPrims) const
+bool Operator::Calc_EffMatPos(int ny, const unsigned int* pos, double* EffMat, const vector<CSPrimitives*>& vPrims) const
 {
 	switch (m_MatAverageMethod)
 	{
@@ -1740,29 +2178,76 @@ bool Operator::Calc_EC()
 }
 
 vector<CSPrimitives*> Operator::GetPrimitivesBoundBox(int posX, int posY, int posZ, CSProperties::PropertyType type) const
+{
+	vector<CSPrimitives*> vPrim;
+	vector<unsigned int> scratch;
+	GetPrimitivesBoundBox(posX, posY, posZ, type, vPrim, scratch);
+	return vPrim;
+}
+
+void Operator::GetPrimitivesBoundBox(int posX, int posY, int posZ, CSProperties::PropertyType type, vector<CSPrimitives*>& vPrims, vector<unsigned int>& scratch) const
 {
 	double boundBox[6];
+	unsigned int lineRange[6];
 	int BBpos[3] = {posX, posY, posZ};
 	for (int n=0;n<3;++n)
 	{
 		if (BBpos[n]<0)
 		{
-			boundBox[2*n]   = this->GetDiscLine(n,0);
-			boundBox[2*n+1] = this->GetDiscLine(n,numLines[n]-1);
+			lineRange[2*n]   = 0;
+			lineRange[2*n+1] = numLines[n]-1;
 		}
 		else
 		{
-			boundBox[2*n]   = this->GetDiscLine(n, max(0, BBpos[n]-1));
-			boundBox[2*n+1] = this->GetDiscLine(n, min(int(numLines[n])-1, BBpos[n]+1));
+			lineRange[2*n]   = max(0, BBpos[n]-1);
+			lineRange[2*n+1] = min(int(numLines[n])-1, BBpos[n]+1);
 		}
+		boundBox[2*n]   = this->GetDiscLine(n, lineRange[2*n]);
+		boundBox[2*n+1] = this->GetDiscLine(n, lineRange[2*n+1]);
 	}
 
-	vector<CSPrimitives*> vPrim = this->CSX->GetPrimitivesByBoundBox(boundBox, true, type);
-	return vPrim;
+	if (m_IndexBins.empty())
+	{
+		vPrims = this->CSX->GetPrimitivesByBoundBox(boundBox, true, type);
+		return;
+	}
+
+	// collect the candidates of all bins overlapping the bounding box
+	unsigned int binStart[2], binStop[2];
+	for (int n=0;n<2;++n)
+	{
+		binStart[n] = min(lineRange[2*n]/m_IndexBinLines[n], m_IndexNumBins[n]-1);
+		binStop[n]  = min(lineRange[2*n+1]/m_IndexBinLines[n], m_IndexNumBins[n]-1);
+	}
+	scratch.clear();
+	for (unsigned int bx=binStart[0]; bx<=binStop[0]; ++bx)
+		for (unsigned int by=binStart[1]; by<=binStop[1]; ++by)
+		{
+			const vector<unsigned int>& bin = m_IndexBins.at(bx*m_IndexNumBins[1]+by);
+			scratch.insert(scratch.end(), bin.begin(), bin.end());
+		}
+	if ((binStart[0]!=binStop[0]) || (binStart[1]!=binStop[1]))
+	{
+		sort(scratch.begin(), scratch.end());
+		scratch.erase(unique(scratch.begin(), scratch.end()), scratch.end());
+	}
+
+	// the index list is sorted, thus the primitives keep their priority order
+	vPrims.clear();
+	for (size_t i=0; i<scratch.size(); ++i)
+	{
+		CSPrimitives* prim = m_IndexPrims.at(scratch.at(i));
+		if ((type!=CSProperties::ANY) && ((prim->GetProperty()->GetType() & type)==0))
+			continue;
+		if (prim->IsInsideBox(boundBox)!=-1)
+			vPrims.push_back(prim);
+	}
 }
 
 void Operator::Calc_EC_Range(unsigned int xStart, unsigned int xStop)
 {
+	vector<CSPrimitives*> vPrims;
+	vector<unsigned int> primScratch;
 //	vector<CSPrimitives*> vPrims = this->CSX->GetAllPrimitives(true, CSProperties::MATERIAL);
 	unsigned int ipos;
 	unsigned int pos[3];
@@ -1771,7 +2256,7 @@ void Operator::Calc_EC_Range(unsigned int xStart, unsigned int xStop)
 	{
 		for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
 		{
-			vector<CSPrimitives*> vPrims = this->GetPrimitivesBoundBox(pos[0], pos[1], -1, CSProperties::MATERIAL);
+			this->GetPrimitivesBoundBox(pos[0], pos[1], -1, CSProperties::MATERIAL, vPrims, primScratch);
 			for (pos[2]=0; pos[2]<numLines[2]; ++pos[2])
 			{
 				ipos = MainOp->GetPos(pos[0],pos[1],pos[2]);
@@ -1814,15 +2299,21 @@ double Operator::CalcTimestep_Var1()
 {
 	m_Used_TS_Name = string("Rennings_1");
 //	cout << "Operator::CalcTimestep(): Using timestep algorithm by Andreas Rennings, Dissertation @ University Duisburg-Essen, 2008, pp. 66, eq. 4.52" << endl;
-	dT=1e200;
+	MainOp->SetReflection2Cell();
+	RangeJobMember<Operator> job(this, &Operator::CalcTimestep_Var1_Range);
+	CalcTimestep_Reduce(&job, "Operator::CalcTimestep_Var1");
+	return 0;
+}
+
+void Operator::CalcTimestep_Var1_Range(unsigned int startX, unsigned int stopX, unsigned int threadID)
+{
+	TimestepResult& result = m_TS_Results.at(threadID);
+	AdrOp adr(MainOp); //every thread needs its own address operator
 	double newT;
 	unsigned int pos[3];
-	unsigned int smallest_pos[3] = {0, 0, 0};
-	unsigned int smallest_n = 0;
 	unsigned int ipos;
 	unsigned int ipos_PM;
 	unsigned int ipos_PPM;
-	MainOp->SetReflection2Cell();
 	for (int n=0; n<3; ++n)
 	{
 		int nP = (n+1)%3;
@@ -1832,24 +2323,39 @@ double Operator::CalcTimestep_Var1()
 		{
 			for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
 			{
-				for (pos[0]=0; pos[0]<numLines[0]; ++pos[0])
+				for (pos[0]=startX; pos[0]<=stopX; ++pos[0])
 				{
-					ipos = MainOp->SetPos(pos[0],pos[1],pos[2]);
-					ipos_PM = MainOp->Shift(nP,-1);
-					MainOp->ResetShift();
-					ipos_PPM= MainOp->Shift(nPP,-1);
-					MainOp->ResetShift();
+					ipos = adr.SetPos(pos[0],pos[1],pos[2]);
+					ipos_PM = adr.Shift(nP,-1);
+					adr.ResetShift();
+					ipos_PPM= adr.Shift(nPP,-1);
+					adr.ResetShift();
 					newT = 2/sqrt( ( 4/EC_L[nP][ipos] + 4/EC_L[nP][ipos_PPM] + 4/EC_L[nPP][ipos] + 4/EC_L[nPP][ipos_PM]) / EC_C[n][ipos] );
-					if ((newT<dT) && (newT>0.0))
+					if ((newT<result.dT) && (newT>0.0))
 					{
-						dT=newT;
-						smallest_pos[0]=pos[0];smallest_pos[1]=pos[1];smallest_pos[2]=pos[2];
-						smallest_n = n;
+						result.dT=newT;
+						result.pos[0]=pos[0];result.pos[1]=pos[1];result.pos[2]=pos[2];
+						result.n = n;
 					}
 				}
 			}
 		}
 	}
+}
+
+void Operator::CalcTimestep_Reduce(RangeJob* job, string name)
+{
+	TimestepResult init = {1e200, 0, {0, 0, 0}};
+	m_TS_Results.assign(GetNumberOfSetupThreads(), init);
+	RunRangeJob(job, numLines[0]);
+
+	TimestepResult smallest = init;
+	for (size_t t=0; t<m_TS_Results.size(); ++t)
+		if (m_TS_Results.at(t).dT<smallest.dT)
+			smallest = m_TS_Results.at(t);
+	m_TS_Results.clear();
+
+	dT = smallest.dT;
 	if (dT==0)
 	{
 		cerr << "Operator::CalcTimestep: Timestep is zero... this is not supposed to happen!!! exit!" << endl;
@@ -1857,9 +2363,8 @@ double Operator::CalcTimestep_Var1()
 	}
 	if (g_settings.GetVerboseLevel()>1)
 	{
-		cout << "Operator::CalcTimestep_Var1: Smallest timestep (" << dT << "s) found at position: " <<  smallest_n << " : " << smallest_pos[0] << ";" <<  smallest_pos[1] << ";" <<  smallest_pos[2] << endl;
+		cout << name << ": Smallest timestep (" << dT << "s) found at position: " <<  smallest.n << " : " << smallest.pos[0] << ";" <<  smallest.pos[1] << ";" <<  smallest.pos[2] << endl;
 	}
-	return 0;
 }
 
 double min(double* val, unsigned int count)
@@ -1876,18 +2381,24 @@ double min(double* val, unsigned int count)
 //Berechnung nach Andreas Rennings Dissertation 2008, Seite 76 ff, Formel 4.77 ff
 double Operator::CalcTimestep_Var3()
 {
-	dT=1e200;
 	m_Used_TS_Name = string("Rennings_2");
 //	cout << "Operator::CalcTimestep(): Using timestep algorithm by Andreas Rennings, Dissertation @ University Duisburg-Essen, 2008, pp. 76, eq. 4.77 ff." << endl;
+	MainOp->SetReflection2Cell();
+	RangeJobMember<Operator> job(this, &Operator::CalcTimestep_Var3_Range);
+	CalcTimestep_Reduce(&job, "Operator::CalcTimestep_Var3");
+	return 0;
+}
+
+void Operator::CalcTimestep_Var3_Range(unsigned int startX, unsigned int stopX, unsigned int threadID)
+{
+	TimestepResult& result = m_TS_Results.at(threadID);
+	AdrOp adr(MainOp); //every thread needs its own address operator
 	double newT;
 	unsigned int pos[3];
-	unsigned int smallest_pos[3] = {0, 0, 0};
-	unsigned int smallest_n = 0;
 	unsigned int ipos;
 	double w_total=0;
 	double wqp=0,wt1=0,wt2=0;
 	double wt_4[4]={0,0,0,0};
-	MainOp->SetReflection2Cell();
 	for (int n=0; n<3; ++n)
 	{
 		int nP = (n+1)%3;
@@ -1897,57 +2408,47 @@ double Operator::CalcTimestep_Var3()
 		{
 			for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
 			{
-				for (pos[0]=0; pos[0]<numLines[0]; ++pos[0])
+				for (pos[0]=startX; pos[0]<=stopX; ++pos[0])
 				{
-					MainOp->ResetShift();
-					ipos = MainOp->SetPos(pos[0],pos[1],pos[2]);
-					wqp  = 1/(EC_L[nPP][ipos]*EC_C[n][MainOp->GetShiftedPos(nP ,1)]) + 1/(EC_L[nPP][ipos]*EC_C[n][ipos]);
-					wqp += 1/(EC_L[nP ][ipos]*EC_C[n][MainOp->GetShiftedPos(nPP,1)]) + 1/(EC_L[nP ][ipos]*EC_C[n][ipos]);
-					ipos = MainOp->Shift(nP,-1);
-					wqp += 1/(EC_L[nPP][ipos]*EC_C[n][MainOp->GetShiftedPos(nP ,1)]) + 1/(EC_L[nPP][ipos]*EC_C[n][ipos]);
-					ipos = MainOp->Shift(nPP,-1);
-					wqp += 1/(EC_L[nP ][ipos]*EC_C[n][MainOp->GetShiftedPos(nPP,1)]) + 1/(EC_L[nP ][ipos]*EC_C[n][ipos]);
-
-					MainOp->ResetShift();
-					ipos = MainOp->SetPos(pos[0],pos[1],pos[2]);
+					adr.ResetShift();
+					ipos = adr.SetPos(pos[0],pos[1],pos[2]);
+					wqp  = 1/(EC_L[nPP][ipos]*EC_C[n][adr.GetShiftedPos(nP ,1)]) + 1/(EC_L[nPP][ipos]*EC_C[n][ipos]);
+					wqp += 1/(EC_L[nP ][ipos]*EC_C[n][adr.GetShiftedPos(nPP,1)]) + 1/(EC_L[nP ][ipos]*EC_C[n][ipos]);
+					ipos = adr.Shift(nP,-1);
+					wqp += 1/(EC_L[nPP][ipos]*EC_C[n][adr.GetShiftedPos(nP ,1)]) + 1/(EC_L[nPP][ipos]*EC_C[n][ipos]);
+					ipos = adr.Shift(nPP,-1);
+					wqp += 1/(EC_L[nP ][ipos]*EC_C[n][adr.GetShiftedPos(nPP,1)]) + 1/(EC_L[nP ][ipos]*EC_C[n][ipos]);
+
+					adr.ResetShift();
+					ipos = adr.SetPos(pos[0],pos[1],pos[2]);
 					wt_4[0] = 1/(EC_L[nPP][ipos]						  *EC_C[nP ][ipos]);
-					wt_4[1] = 1/(EC_L[nPP][MainOp->GetShiftedPos(nP ,-1)] *EC_C[nP ][ipos]);
+					wt_4[1] = 1/(EC_L[nPP][adr.GetShiftedPos(nP ,-1)] *EC_C[nP ][ipos]);
 					wt_4[2] = 1/(EC_L[nP ][ipos]						  *EC_C[nPP][ipos]);
-					wt_4[3] = 1/(EC_L[nP ][MainOp->GetShiftedPos(nPP,-1)] *EC_C[nPP][ipos]);
+					wt_4[3] = 1/(EC_L[nP ][adr.GetShiftedPos(nPP,-1)] *EC_C[nPP][ipos]);
 
 					wt1 = wt_4[0]+wt_4[1]+wt_4[2]+wt_4[3] - 2*min(wt_4,4);
 
-					MainOp->ResetShift();
-					ipos = MainOp->SetPos(pos[0],pos[1],pos[2]);
-					wt_4[0] = 1/(EC_L[nPP][ipos]						  *EC_C[nP ][MainOp->GetShiftedPos(n,1)]);
-					wt_4[1] = 1/(EC_L[nPP][MainOp->GetShiftedPos(nP ,-1)] *EC_C[nP ][MainOp->GetShiftedPos(n,1)]);
-					wt_4[2] = 1/(EC_L[nP ][ipos]						  *EC_C[nPP][MainOp->GetShiftedPos(n,1)]);
-					wt_4[3] = 1/(EC_L[nP ][MainOp->GetShiftedPos(nPP,-1)] *EC_C[nPP][MainOp->GetShiftedPos(n,1)]);
+					adr.ResetShift();
+					ipos = adr.SetPos(pos[0],pos[1],pos[2]);
+					wt_4[0] = 1/(EC_L[nPP][ipos]						  *EC_C[nP ][adr.GetShiftedPos(n,1)]);
+					wt_4[1] = 1/(EC_L[nPP][adr.GetShiftedPos(nP ,-1)] *EC_C[nP ][adr.GetShiftedPos(n,1)]);
+					wt_4[2] = 1/(EC_L[nP ][ipos]						  *EC_C[nPP][adr.GetShiftedPos(n,1)]);
+					wt_4[3] = 1/(EC_L[nP ][adr.GetShiftedPos(nPP,-1)] *EC_C[nPP][adr.GetShiftedPos(n,1)]);
 
 					wt2 = wt_4[0]+wt_4[1]+wt_4[2]+wt_4[3] - 2*min(wt_4,4);
 
 					w_total = wqp + wt1 + wt2;
 					newT = 2/sqrt( w_total );
-					if ((newT<dT) && (newT>0.0))
+					if ((newT<result.dT) && (newT>0.0))
 					{
-						dT=newT;
-						smallest_pos[0]=pos[0];smallest_pos[1]=pos[1];smallest_pos[2]=pos[2];
-						smallest_n = n;
+						result.dT=newT;
+						result.pos[0]=pos[0];result.pos[1]=pos[1];result.pos[2]=pos[2];
+						result.n = n;
 					}
 				}
 			}
 		}
 	}
-	if (dT==0)
-	{
-		cerr << "Operator::CalcTimestep: Timestep is zero... this is not supposed to happen!!! exit!" << endl;
-		exit(3);
-	}
-	if (g_settings.GetVerboseLevel()>1)
-	{
-		cout << "Operator::CalcTimestep_Var3: Smallest timestep (" << dT << "s) found at position: " <<  smallest_n << " : " << smallest_pos[0] << ";" <<  smallest_pos[1] << ";" <<  smallest_pos[2] << endl;
-	}
-	return 0;
 }
 
 bool Operator::CalcPEC()
@@ -1965,13 +2466,15 @@ bool Operator::CalcPEC()
 
 void Operator::CalcPEC_Range(unsigned int startX, unsigned int stopX, unsigned int* counter)
 {
+	vector<CSPrimitives*> vPrims;
+	vector<unsigned int> primScratch;
 	double coord[3];
 	unsigned int pos[3];
 	for (pos[0]=startX; pos[0]<=stopX; ++pos[0])
 	{
 		for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
 		{
-			vector<CSPrimitives*> vPrims = this->GetPrimitivesBoundBox(pos[0], pos[1], -1, (CSProperties::PropertyType)(CSProperties::MATERIAL | CSProperties::METAL));
+			this->GetPrimitivesBoundBox(pos[0], pos[1], -1, (CSProperties::PropertyType)(CSProperties::MATERIAL | CSProperties::METAL), vPrims, primScratch);
 			for (pos[2]=0; pos[2]<numLines[2]; ++pos[2])
 			{
 				for (int n=0; n<3; ++n)
@@ -2002,13 +2505,13 @@ void Operator::CalcPEC_Range(unsigned int startX, unsigned int stopX, unsigned i
 void Operator::CalcPEC_Curves()
 {
 	//special treatment for primitives of type curve (treated as wires)
-	double p1[3];
-	double p2[3];
-	Grid_Path path;
+	double p[6];
+	m_PEC_CurvePrims.clear();
+	m_PEC_CurvePoints.clear();
 	vector<CSProperties*> vec_prop = CSX->GetPropertyByType(CSProperties::METAL);
-	for (size_t p=0; p<vec_prop.size(); ++p)
+	for (size_t p_idx=0; p_idx<vec_prop.size(); ++p_idx)
 	{
-		CSProperties* prop = vec_prop.at(p);
+		CSProperties* prop = vec_prop.at(p_idx);
 		for (size_t n=0; n<prop->GetQtyPrimitives(); ++n)
 		{
 			CSPrimitives* prim = prop->GetPrimitive(n);
@@ -2017,21 +2520,43 @@ void Operator::CalcPEC_Curves()
 			{
 				for (size_t i=1; i<curv->GetNumberOfPoints(); ++i)
 				{
-					curv->GetPoint(i-1,p1,m_MeshType);
-					curv->GetPoint(i,p2,m_MeshType);
-					path = FindPath(p1,p2);
-					if (path.dir.size()>0)
-						prim->SetPrimitiveUsed(true);
-					for (size_t t=0; t<path.dir.size(); ++t)
-					{
-						SetVV(path.dir.at(t),path.posPath[0].at(t),path.posPath[1].at(t),path.posPath[2].at(t), 0 );
-						SetVI(path.dir.at(t),path.posPath[0].at(t),path.posPath[1].at(t),path.posPath[2].at(t), 0 );
-						++m_Nr_PEC[path.dir.at(t)];
-					}
+					curv->GetPoint(i-1,p,m_MeshType);
+					curv->GetPoint(i,p+3,m_MeshType);
+					m_PEC_CurvePrims.push_back(prim);
+					m_PEC_CurvePoints.insert(m_PEC_CurvePoints.end(), p, p+6);
 				}
 			}
 		}
 	}
+
+	// find the mesh paths of all segments in parallel, apply them in order
+	m_PEC_CurvePaths.clear();
+	m_PEC_CurvePaths.resize(m_PEC_CurvePrims.size());
+	RangeJobMember<Operator> job(this, &Operator::CalcPEC_CurvePaths);
+	RunRangeJob(&job, m_PEC_CurvePrims.size());
+
+	for (size_t i=0; i<m_PEC_CurvePaths.size(); ++i)
+	{
+		Grid_Path& path = m_PEC_CurvePaths.at(i);
+		if (path.dir.size()>0)
+			m_PEC_CurvePrims.at(i)->SetPrimitiveUsed(true);
+		for (size_t t=0; t<path.dir.size(); ++t)
+		{
+			SetVV(path.dir.at(t),path.posPath[0].at(t),path.posPath[1].at(t),path.posPath[2].at(t), 0 );
+			SetVI(path.dir.at(t),path.posPath[0].at(t),path.posPath[1].at(t),path.posPath[2].at(t), 0 );
+			++m_Nr_PEC[path.dir.at(t)];
+		}
+	}
+	m_PEC_CurvePrims.clear();
+	m_PEC_CurvePoints.clear();
+	m_PEC_CurvePaths.clear();
+}
+
+void Operator::CalcPEC_CurvePaths(unsigned int start, unsigned int stop, unsigned int threadID)
+{
+	UNUSED(threadID);
+	for (unsigned int i=start; i<=stop; ++i)
+		m_PEC_CurvePaths.at(i) = FindPath(&m_PEC_CurvePoints.at(6*i), &m_PEC_CurvePoints.at(6*i+3));
 }
 
 Operator_Ext_Excitation* Operator::GetExcitationExtension() const
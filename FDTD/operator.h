@@ -18,6 +18,7 @@
 #ifndef OPERATOR_H
 #define OPERATOR_H
 
+#include <stdint.h>
 #include "tools/AdrOp.h"
 #include "tools/constants.h"
 #include "excitation.h"
@@ -53,6 +54,11 @@ public:
 
 	virtual bool SetGeometryCSX(ContinuousStructure* geo);
 
+	//! Cache the calculated operator in the given directory and reuse it for an identical geometry, mesh and settings (empty to disable)
+	virtual void SetOperatorCache(string dir) {m_CacheDir=dir;}
+	//! Get the hash of the geometry, mesh and all settings defining the operator, calculated by CalcECOperator
+	uint64_t GetOperatorHash() const {return m_OperatorHash;}
+
 	virtual int CalcECOperator( DebugFlags debugFlags = None );
 
 	// the next four functions need to be reimplemented in a derived class
@@ -180,6 +186,37 @@ public:
 	virtual double CalcNumericPhaseVelocity(unsigned int start[3], unsigned int stop[3], double propDir[3], float freq) const;
 
 	virtual vector<CSPrimitives*> GetPrimitivesBoundBox(int posX, int posY, int posZ, CSProperties::PropertyType type=CSProperties::ANY) const;
+	//! Same as GetPrimitivesBoundBox() above, but reusing the given (per thread) primitive list and scratch buffer
+	void GetPrimitivesBoundBox(int posX, int posY, int posZ, CSProperties::PropertyType type, vector<CSPrimitives*>& vPrims, vector<unsigned int>& scratch) const;
+
+	//! Interface for an operator setup stage working on a range of independent jobs (usually x-lines), see RunRangeJob()
+	class RangeJob
+	{
+	public:
+		virtual ~RangeJob() {}
+		//! Process the jobs \a start to \a stop (inclusive), \a threadID is unique for each part and smaller than GetNumberOfSetupThreads()
+		virtual void Run(unsigned int start, unsigned int stop, unsigned int threadID) = 0;
+	};
+
+	//! Range job calling a member function of the given object
+	template <class T> class RangeJobMember : public RangeJob
+	{
+	public:
+		typedef void (T::*RangeFunc)(unsigned int start, unsigned int stop, unsigned int threadID);
+		RangeJobMember(T* obj, RangeFunc func) : m_Obj(obj), m_Func(func) {}
+		virtual void Run(unsigned int start, unsigned int stop, unsigned int threadID) {(m_Obj->*m_Func)(start,stop,threadID);}
+	protected:
+		T* m_Obj;
+		RangeFunc m_Func;
+	};
+
+	//! Get the (maximal) number of threads used by RunRangeJob()
+	virtual unsigned int GetNumberOfSetupThreads() const {return 1;}
+	//! Run the jobs 0 to \a size-1, split into consecutive ranges for all setup threads. Returns after all parts are done.
+	virtual void RunRangeJob(RangeJob* job, unsigned int size);
+
+	//! Add the wall clock time elapsed since \a start to the setup timings (shown by ShowStat()) and restart \a start
+	void AddSetupTime(string stage, double& start);
 
 protected:
 	//! use New() for creating a new Operator
@@ -195,6 +232,21 @@ protected:
 
 	virtual Grid_Path FindPath(double start[], double stop[]);
 
+	//! Build the spatial index of all CSX primitives, used by GetPrimitivesBoundBox()
+	/*!
+	  The x-y mesh is divided into uniform bins of a few mesh lines, each bin stores all primitives touching it.
+	  A bounding box query thus only has to test the primitives of the (usually one to four) bins it overlaps, instead of all primitives.
+	  */
+	virtual void BuildPrimitiveIndex();
+	virtual void ClearPrimitiveIndex();
+	//! All primitives sorted by priority, the bins store indices into this list
+	vector<CSPrimitives*> m_IndexPrims;
+	//! Number of mesh lines per bin and number of bins in x- and y-direction
+	unsigned int m_IndexBinLines[2];
+	unsigned int m_IndexNumBins[2];
+	//! Ascending primitive indices for each bin, stored as m_IndexBins[binX*m_IndexNumBins[1]+binY]
+	vector< vector<unsigned int> > m_IndexBins;
+
 	// debug
 	virtual void DumpOperator2File(string filename);
 	virtual void DumpMaterial2File(string filename);
@@ -204,6 +256,34 @@ protected:
 	virtual bool CalcPEC();
 	virtual void CalcPEC_Range(unsigned int startX, unsigned int stopX, unsigned int* counter);	//internal to CalcPEC
 	virtual void CalcPEC_Curves();	//internal to CalcPEC
+	//! Curve segments and their mesh paths, internal to CalcPEC_Curves
+	vector<CSPrimitives*> m_PEC_CurvePrims;
+	vector<double> m_PEC_CurvePoints; //start and stop coordinates, 6 per segment
+	vector<Grid_Path> m_PEC_CurvePaths;
+	void CalcPEC_CurvePaths(unsigned int start, unsigned int stop, unsigned int threadID);
+
+	//! Calculate the EC, the timestep and the operator including PEC, lumped elements and boundary conditions (internal to CalcECOperator)
+	virtual bool Calc_Operator();
+
+	//! Wall clock time of the operator setup stages in seconds
+	vector< pair<string,double> > m_SetupTimes;
+
+	//! Directory of the operator cache, empty if disabled
+	string m_CacheDir;
+	//! Check if the property is part of the cached operator
+	static bool IsCachedProperty(CSProperties* prop);
+	//! Get all primitives of the cached properties, in a fixed order
+	vector<CSPrimitives*> GetCachedPrimitives() const;
+	//! Hash of the geometry, mesh and all settings defining the operator, set by CalcECOperator before the operator is calculated
+	uint64_t m_OperatorHash;
+	//! Calculate the hash of the geometry, mesh and all settings defining the operator (must be called before the timestep is calculated)
+	virtual uint64_t CalcOperatorHash() const;
+	//! Get the operator cache file for the current geometry, mesh and settings, empty if caching is disabled
+	string GetOperatorCacheFile() const;
+	//! Read the operator from the cache file, returns false if the cache is not available or invalid
+	virtual bool ReadOperatorCache(string filename);
+	//! Write the current operator to the cache file
+	virtual bool WriteOperatorCache(string filename) const;
 
 	//Calc timestep only internal use
 	int m_TimeStepVar;
@@ -215,9 +295,21 @@ protected:
 
 	double CalcTimestep_Var1();
 	double CalcTimestep_Var3();
+	//! Smallest timestep found by a single setup thread
+	struct TimestepResult
+	{
+		double dT;
+		unsigned int n;
+		unsigned int pos[3];
+	};
+	vector<TimestepResult> m_TS_Results;
+	void CalcTimestep_Var1_Range(unsigned int startX, unsigned int stopX, unsigned int threadID);
+	void CalcTimestep_Var3_Range(unsigned int startX, unsigned int stopX, unsigned int threadID);
+	//! Run the given timestep job and set dT to the smallest timestep found by all threads
+	void CalcTimestep_Reduce(RangeJob* job, string name);
 
 	//! Calculate the FDTD equivalent circuit parameter for the given position and direction ny. \sa Calc_EffMat_Pos
-	virtual bool Calc_ECPos(int ny, const unsigned int* pos, double* EC, vector<CSPrimitives *> vPrims) const;
+	virtual bool Calc_ECPos(int ny, const unsigned int* pos, double* EC, const vector<CSPrimitives*>& vPrims) const;
 
 	//! Get the FDTD raw disc delta, needed by Calc_EffMatPos() \sa Calc_EffMatPos
 	/*!
@@ -228,18 +320,22 @@ protected:
 	virtual double GetRawDiscDelta(int ny, const int pos) const;
 
 	//! Get the material at a given coordinate, direction and type from CSX (internal use only)
-	virtual double GetMaterial(int ny, const double coords[3], int MatType, vector<CSPrimitives*> vPrims, bool markAsUsed=true) const;
+	virtual double GetMaterial(int ny, const double coords[3], int MatType, const vector<CSPrimitives*>& vPrims, bool markAsUsed=true) const;
 
 	MatAverageMethods m_MatAverageMethod;
 
 	//! Calculate the effective/averaged material properties at the given position and direction ny.
-	virtual bool Calc_EffMatPos(int ny, const unsigned int* pos, double* EffMat, vector<CSPrimitives*> vPrims) const;
+	virtual bool Calc_EffMatPos(int ny, const unsigned int* pos, double* EffMat, const vector<CSPrimitives*>& vPrims) const;
 
-	virtual bool AverageMatCellCenter(int ny, const unsigned int* pos, double* EffMat, vector<CSPrimitives*> vPrims) const;
-	virtual bool AverageMatQuarterCell(int ny, const unsigned int* pos, double* EffMat, vector<CSPrimitives*> vPrims) const;
+	virtual bool AverageMatCellCenter(int ny, const unsigned int* pos, double* EffMat, const vector<CSPrimitives*>& vPrims) const;
+	virtual bool AverageMatQuarterCell(int ny, const unsigned int* pos, double* EffMat, const vector<CSPrimitives*>& vPrims) const;
 
 	//! Calc operator at certain \a pos
 	virtual void Calc_ECOperatorPos(int n, unsigned int* pos);
+	//! Calc operator at certain \a pos with the given EC index, does not move the MainOp and can thus be used by multiple threads
+	void Calc_ECOperatorPos(int n, const unsigned int* pos, unsigned int ipos);
+	//! Calc the operator for all positions of the x-lines \a startX to \a stopX
+	void Calc_ECOperator_Range(unsigned int startX, unsigned int stopX, unsigned int threadID);
 
 	//! Calculate and setup lumped elements
 	virtual bool Calc_LumpedElements();
@@ -213,13 +213,15 @@ void Operator_CylinderMultiGrid::FillMissingDataStorage()
 {
 	unsigned int pos[3];
 	double EffMat[4];
+	vector<CSPrimitives*> vPrims;
+	vector<unsigned int> primScratch;
 	for (int ny=0; ny<3; ++ny)
 	{
 		for (pos[0]=0; pos[0]<m_Split_Pos-1; ++pos[0])
 		{
 			for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
 			{
-				vector<CSPrimitives*> vPrims = this->GetPrimitivesBoundBox(pos[0], pos[1], -1, CSProperties::MATERIAL);
+				this->GetPrimitivesBoundBox(pos[0], pos[1], -1, CSProperties::MATERIAL, vPrims, primScratch);
 				for (pos[2]=0; pos[2]<numLines[2]; ++pos[2])
 				{
 					Calc_EffMatPos(ny,pos,EffMat,vPrims);
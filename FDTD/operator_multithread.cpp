@@ -17,6 +17,7 @@
 
 #include "operator_multithread.h"
 #include "engine_multithread.h"
+#include "engine_multithread_half.h"
 #include "tools/useful.h"
 
 Operator_Multithread* Operator_Multithread::New(unsigned int numThreads)
@@ -40,12 +41,21 @@ void Operator_Multithread::setNumThreads( unsigned int numThreads )
 
 Engine* Operator_Multithread::CreateEngine()
 {
-	m_Engine = Engine_Multithread::New(this,m_numThreads);
+	if (GetHalfPrecision()!=HALF_NONE)
+		m_Engine = Engine_Multithread_Half::New(this,m_numThreads);
+	else
+		m_Engine = Engine_Multithread::New(this,m_numThreads);
 	return m_Engine;
 }
 
 Operator_Multithread::Operator_Multithread() : OPERATOR_MULTITHREAD_BASE()
 {
+	m_TB_NumTS = 0;
+	m_NeighbourSync = false;
+	m_NUMA = false;
+	m_FusedUpdates = false;
+	m_FullBarriers = false;
+
 	m_CalcEC_Start=NULL;
 	m_CalcEC_Stop=NULL;
 
@@ -104,18 +114,42 @@ void Operator_Multithread::CalcStartStopLines(unsigned int &numThreads, vector<u
 	}
 }
 
+void Operator_Multithread::RunRangeJob(RangeJob* job, unsigned int size)
+{
+	if (size==0)
+		return;
+	vector<unsigned int> jpt = AssignJobs2Threads(size, GetNumberOfSetupThreads(), true);
+	if (jpt.size()<2)
+		return OPERATOR_MULTITHREAD_BASE::RunRangeJob(job, size);
+
+	boost::thread_group threads;
+	unsigned int start = jpt.at(0);
+	for (unsigned int n=1; n<jpt.size(); ++n)
+	{
+		threads.add_thread( new boost::thread( &RangeJob::Run, job, start, start+jpt.at(n)-1, n ) );
+		start += jpt.at(n);
+	}
+	job->Run(0, jpt.at(0)-1, 0);
+	threads.join_all();
+}
+
 int Operator_Multithread::CalcECOperator( DebugFlags debugFlags )
 {
 	if (m_numThreads == 0)
 		m_numThreads = boost::thread::hardware_concurrency();
 
+	if (g_settings.GetVerboseLevel()>0)
+		cout << "Multithreaded operator using " << m_numThreads << " threads." << std::endl;
+
+	return OPERATOR_MULTITHREAD_BASE::CalcECOperator( debugFlags );
+}
+
+bool Operator_Multithread::Calc_Operator()
+{
 	vector<unsigned int> m_Start_Lines;
 	vector<unsigned int> m_Stop_Lines;
 	CalcStartStopLines( m_numThreads, m_Start_Lines, m_Stop_Lines );
 
-	if (g_settings.GetVerboseLevel()>0)
-		cout << "Multithreaded operator using " << m_numThreads << " threads." << std::endl;
-
 	m_thread_group.join_all();
 	delete m_CalcEC_Start;
 	m_CalcEC_Start = new boost::barrier(m_numThreads+1); // numThread workers + 1 controller
@@ -133,7 +167,7 @@ int Operator_Multithread::CalcECOperator( DebugFlags debugFlags )
 		m_thread_group.add_thread( t );
 	}
 
-	return OPERATOR_MULTITHREAD_BASE::CalcECOperator( debugFlags );
+	return OPERATOR_MULTITHREAD_BASE::Calc_Operator();
 }
 
 bool Operator_Multithread::Calc_EC()
@@ -40,8 +40,27 @@ public:
 
 	virtual void setNumThreads( unsigned int numThreads );
 
+	//! Set the number of timesteps the engine advances per wavefront sweep (temporal blocking), a value <2 disables temporal blocking
+	virtual void setTemporalBlocking( unsigned int numTS ) {m_TB_NumTS=numTS;}
+
+	//! Enable synchronization of the engine threads with their neighbours only, instead of global barriers
+	virtual void setNeighbourSync( bool val ) {m_NeighbourSync=val;}
+
+	//! Enable the fused updates of the engine extensions within the x-slab sweep of the engine threads
+	virtual void setFusedUpdates( bool val ) {m_FusedUpdates=val;}
+
+	//! Place a barrier before every step of the extension schedule of the engine, instead of only where the footprints overlap
+	virtual void setFullBarriers( bool val ) {m_FullBarriers=val;}
+
+	//! Enable pinning of the engine threads and NUMA first-touch placement of their x-slabs
+	virtual void setNUMA( bool val ) {m_NUMA=val;}
+
 	virtual Engine* CreateEngine();
 
+	virtual unsigned int GetNumberOfSetupThreads() const {return m_numThreads>0 ? m_numThreads : 1;}
+	//! Run the range job using all operator threads, the calling thread is processing the first part
+	virtual void RunRangeJob(RangeJob* job, unsigned int size);
+
 protected:
 	Operator_Multithread();
 	virtual void Init();
@@ -54,6 +73,8 @@ protected:
 	virtual bool CalcPEC(); //this method is using multi-threading
 
 	virtual int CalcECOperator( DebugFlags debugFlags = None );
+	//! Start the worker threads for Calc_EC and CalcPEC, not needed if the operator is read from the cache
+	virtual bool Calc_Operator();
 
 	//Calc_EC barrier
 	boost::barrier* m_CalcEC_Start;
@@ -64,6 +85,11 @@ protected:
 
 	boost::thread_group m_thread_group;
 	unsigned int m_numThreads; // number of worker threads
+	unsigned int m_TB_NumTS; // number of timesteps per temporal block
+	bool m_NeighbourSync; // use neighbour synchronization in the engine
+	bool m_NUMA; // use NUMA placement in the engine
+	bool m_FusedUpdates; // use fused extension updates in the engine
+	bool m_FullBarriers; // do not elide any barrier of the extension schedule in the engine
 
 	//! Calculate the start/stop lines for the multithreading operator and engine.
 	/*!
@@ -19,9 +19,11 @@
 #include "engine_sse_compressed.h"
 #include "engine_sse.h"
 #include "tools/array_ops.h"
+#include "tools/useful.h"
+#include "tools/global.h"
 
-#include <map>
 #include <cstring>
+#include <cmath>
 
 Operator_SSE_Compressed* Operator_SSE_Compressed::New()
 {
@@ -34,7 +36,16 @@ Operator_SSE_Compressed* Operator_SSE_Compressed::New()
 Operator_SSE_Compressed::Operator_SSE_Compressed() : Operator_sse()
 {
 	m_Op_index = NULL;
+	m_Op_index_Wide = NULL;
 	m_Use_Compression = false;	
+	m_VectorWidth = 4;
+	m_HalfPrecision = HALF_NONE;
+	m_HalfValidation = false;
+	m_CompressTolerance = 0;
+	m_CompressMaxError = 0;
+	m_CompressNumExact = 0;
+	m_StabilityPass = 0;
+	m_MaxCourant[0] = m_MaxCourant[1] = 0;
 }
 
 Operator_SSE_Compressed::~Operator_SSE_Compressed()
@@ -44,11 +55,15 @@ Operator_SSE_Compressed::~Operator_SSE_Compressed()
 
 Engine* Operator_SSE_Compressed::CreateEngine()
 {
+	if (m_HalfPrecision!=HALF_NONE)
+		cerr << "Operator_SSE_Compressed::CreateEngine: Warning, half precision field storage requires the multithreaded engine, using single precision..." << endl;
 	if (!m_Use_Compression)
+	{
 		//! create a default sse-engine
 		m_Engine = Engine_sse::New(this);
-  else
-	  m_Engine = Engine_SSE_Compressed::New(this);
+	}
+	else
+		m_Engine = Engine_SSE_Compressed::New(this);
 	return m_Engine;
 }
 
@@ -56,7 +71,9 @@ int Operator_SSE_Compressed::CalcECOperator( DebugFlags debugFlags )
 {
 	int ErrCode = Operator_sse::CalcECOperator( debugFlags );
 	m_Use_Compression = false;
+	double stageTime = GetWallTime();
 	m_Use_Compression = CompressOperator();
+	AddSetupTime("Compression", stageTime);
 
 	return ErrCode;
 }
@@ -66,6 +83,8 @@ void Operator_SSE_Compressed::Init()
 	Operator_sse::Init();
 	m_Use_Compression = false;
 	m_Op_index = NULL;
+	m_Op_index_Wide = NULL;
+	m_VectorWidth = GetCPUVectorWidth(g_settings.GetMaxVectorWidth());
 }
 
 void Operator_SSE_Compressed::Delete()
@@ -84,6 +103,23 @@ void Operator_SSE_Compressed::Delete()
 		f4_iv_Compressed[n].clear();
 		f4_ii_Compressed[n].clear();
 	}
+	DeleteWide();
+}
+
+void Operator_SSE_Compressed::DeleteWide()
+{
+	if (m_Op_index_Wide)
+	{
+		Delete3DArray<unsigned int>( m_Op_index_Wide, m_numLines_Wide );
+		m_Op_index_Wide = 0;
+	}
+	for (int n=0; n<3; n++)
+	{
+		f_vv_Wide[n].clear();
+		f_vi_Wide[n].clear();
+		f_iv_Wide[n].clear();
+		f_ii_Wide[n].clear();
+	}
 }
 
 void Operator_SSE_Compressed::Reset()
@@ -103,6 +139,7 @@ void Operator_SSE_Compressed::InitOperator()
 		f4_iv_Compressed[n].clear();
 		f4_ii_Compressed[n].clear();
 	}
+	DeleteWide();
 
 	Operator_sse::InitOperator();
 	m_Op_index = Create3DArray<unsigned int>( numLines );
@@ -114,6 +151,27 @@ void Operator_SSE_Compressed::ShowStat() const
 
 	cout << "SSE compression enabled\t: " << (m_Use_Compression?"yes":"no") << endl;
 	cout << "Unique SSE operators\t: " << f4_vv_Compressed->size() << endl;
+	if (m_Use_Compression && f4_vv_Compressed->size())
+	{
+		double MBdiff = 1024*1024;
+		unsigned int numPos = numLines[0]*numLines[1]*numVectors;
+		size_t tableSize = f4_vv_Compressed->size()*12*sizeof(f4vector);
+		size_t indexSize = numPos*sizeof(unsigned int);
+		cout << "Compression ratio\t: " << (double)numPos/f4_vv_Compressed->size() << " (" << numPos << " SSE operators)" << endl;
+		if (m_CompressTolerance>0)
+		{
+			cout << "Compression tolerance\t: " << m_CompressTolerance << " (max. relative deviation: " << m_CompressMaxError << ")" << endl;
+			cout << "Kept exact for stability\t: " << m_CompressNumExact << " SSE operators" << endl;
+		}
+		else
+			cout << "Compression tolerance\t: exact" << endl;
+		cout << "Coefficient table size\t: " << tableSize << " Byte (" << (double)tableSize/MBdiff << " MiB)" << endl;
+		cout << "Operator index size\t: " << indexSize << " Byte (" << (double)indexSize/MBdiff << " MiB)" << endl;
+	}
+	cout << "Engine vector width\t: " << m_VectorWidth << " floats";
+	if (m_VectorWidth>4)
+		cout << " (" << f_vv_Wide->size()/m_VectorWidth << " unique operators)";
+	cout << endl;
 	cout << "-----------------------------------" << endl;
 }
 
@@ -122,47 +180,49 @@ bool Operator_SSE_Compressed::CompressOperator()
 	if (g_settings.GetVerboseLevel()>0)
 		cout << "Compressing the FDTD operator... this may take a while..." << endl;
 
-	map<SSE_coeff,unsigned int> lookUpMap;
+	// every thread collects the unique coefficients of its x-lines using its own lookup table
+	m_CompressParts.assign(GetNumberOfSetupThreads(), CompressionPart());
+	RangeJobMember<Operator_SSE_Compressed> findJob(this, &Operator_SSE_Compressed::CompressOperator_Range);
+	RunRangeJob(&findJob, numLines[0]);
 
-	unsigned int pos[3];
-	for (pos[0]=0; pos[0]<numLines[0]; ++pos[0])
+	// merge the thread tables in order of the x-lines, this results in the same coefficient order as a serial compression
+	SSE_coeff_table table(GetCompressionMantissaBits());
+	float values[SSE_coeff_table::KEY_SIZE];
+	bool inserted;
+	for (size_t t=0; t<m_CompressParts.size(); ++t)
 	{
-		for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
+		CompressionPart& part = m_CompressParts.at(t);
+		part.globalIndex.resize(part.firstPos.size()/3);
+		for (size_t i=0; i<part.globalIndex.size(); ++i)
 		{
-			for (pos[2]=0; pos[2]<numVectors; ++pos[2])
+			const unsigned int* pos = &part.firstPos.at(3*i);
+			GetCoefficients(pos, values);
+			unsigned int index = table.FindOrInsert(values, inserted);
+			part.globalIndex.at(i) = index;
+			if (!inserted)
+				continue; // this operator is already in the list
+
+			for (int n=0; n<3; n++)
 			{
-				f4vector vv[3] = { f4_vv[0][pos[0]][pos[1]][pos[2]], f4_vv[1][pos[0]][pos[1]][pos[2]], f4_vv[2][pos[0]][pos[1]][pos[2]] };
-				f4vector vi[3] = { f4_vi[0][pos[0]][pos[1]][pos[2]], f4_vi[1][pos[0]][pos[1]][pos[2]], f4_vi[2][pos[0]][pos[1]][pos[2]] };
-				f4vector iv[3] = { f4_iv[0][pos[0]][pos[1]][pos[2]], f4_iv[1][pos[0]][pos[1]][pos[2]], f4_iv[2][pos[0]][pos[1]][pos[2]] };
-				f4vector ii[3] = { f4_ii[0][pos[0]][pos[1]][pos[2]], f4_ii[1][pos[0]][pos[1]][pos[2]], f4_ii[2][pos[0]][pos[1]][pos[2]] };
-				SSE_coeff c( vv, vi, iv, ii );
-
-				map<SSE_coeff,unsigned int>::iterator it;
-				it = lookUpMap.find(c);
-				if (it == lookUpMap.end())
-				{
-					// not found -> insert
-					unsigned int index = f4_vv_Compressed[0].size();
-					for (int n=0; n<3; n++)
-					{
-						f4_vv_Compressed[n].push_back( vv[n] );
-						f4_vi_Compressed[n].push_back( vi[n] );
-						f4_iv_Compressed[n].push_back( iv[n] );
-						f4_ii_Compressed[n].push_back( ii[n] );
-					}
-					lookUpMap[c] = index;
-					m_Op_index[pos[0]][pos[1]][pos[2]] = index;
-				}
-				else
-				{
-					// this operator is already in the list
-					unsigned int index = (*it).second;
-					m_Op_index[pos[0]][pos[1]][pos[2]] = index;
-				}
+				f4_vv_Compressed[n].push_back( f4_vv[n][pos[0]][pos[1]][pos[2]] );
+				f4_vi_Compressed[n].push_back( f4_vi[n][pos[0]][pos[1]][pos[2]] );
+				f4_iv_Compressed[n].push_back( f4_iv[n][pos[0]][pos[1]][pos[2]] );
+				f4_ii_Compressed[n].push_back( f4_ii[n][pos[0]][pos[1]][pos[2]] );
 			}
 		}
 	}
 
+	// replace the thread local indices by the merged indices
+	RangeJobMember<Operator_SSE_Compressed> remapJob(this, &Operator_SSE_Compressed::CompressOperator_Remap);
+	RunRangeJob(&remapJob, numLines[0]);
+	m_CompressMaxError = 0;
+	for (size_t t=0; t<m_CompressParts.size(); ++t)
+		m_CompressMaxError = max(m_CompressMaxError, m_CompressParts.at(t).maxError);
+	m_CompressNumExact = 0;
+	if (m_CompressTolerance>0)
+		StabilizeCompression();
+	m_CompressParts.clear();
+
 	Delete_N_3DArray_v4sf(f4_vv,numLines);
 	Delete_N_3DArray_v4sf(f4_vi,numLines);
 	Delete_N_3DArray_v4sf(f4_iv,numLines);
@@ -172,78 +232,417 @@ bool Operator_SSE_Compressed::CompressOperator()
 	f4_iv = 0;
 	f4_ii = 0;
 
+	CompressOperator_Wide();
+
 	return true;
 }
 
+void Operator_SSE_Compressed::CompressOperator_Range(unsigned int startX, unsigned int stopX, unsigned int threadID)
+{
+	CompressionPart& part = m_CompressParts.at(threadID);
+	SSE_coeff_table table(GetCompressionMantissaBits());
+	float values[SSE_coeff_table::KEY_SIZE];
+	bool inserted;
 
+	unsigned int pos[3];
+	for (pos[0]=startX; pos[0]<=stopX; ++pos[0])
+	{
+		for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
+		{
+			for (pos[2]=0; pos[2]<numVectors; ++pos[2])
+			{
+				GetCoefficients(pos, values);
+				m_Op_index[pos[0]][pos[1]][pos[2]] = table.FindOrInsert(values, inserted);
+				// remember the position of the first occurrence of a new coefficient
+				if (inserted)
+					part.firstPos.insert(part.firstPos.end(), pos, pos+3);
+			}
+		}
+	}
+}
 
+void Operator_SSE_Compressed::CompressOperator_Remap(unsigned int startX, unsigned int stopX, unsigned int threadID)
+{
+	CompressionPart& part = m_CompressParts.at(threadID);
+	const vector<unsigned int>& globalIndex = part.globalIndex;
+	float values[SSE_coeff_table::KEY_SIZE];
+	unsigned int pos[3];
+	for (pos[0]=startX; pos[0]<=stopX; ++pos[0])
+	{
+		for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
+		{
+			for (pos[2]=0; pos[2]<numVectors; ++pos[2])
+			{
+				unsigned int index = globalIndex.at(m_Op_index[pos[0]][pos[1]][pos[2]]);
+				m_Op_index[pos[0]][pos[1]][pos[2]] = index;
+				if (m_CompressTolerance<=0)
+					continue;
 
-// ----------------------------------------------------------------------------
+				// measure the deviation of the merged coefficients
+				GetCoefficients(pos, values);
+				for (int n=0; n<3; ++n)
+				{
+					for (int c=0; c<4; ++c)
+					{
+						const float exact[4] = {values[16*n+c], values[16*n+4+c], values[16*n+8+c], values[16*n+12+c]};
+						const float merged[4] = {f4_vv_Compressed[n][index].f[c], f4_vi_Compressed[n][index].f[c], f4_iv_Compressed[n][index].f[c], f4_ii_Compressed[n][index].f[c]};
+						for (int k=0; k<4; ++k)
+						{
+							double norm = max(fabs(exact[k]), fabs(merged[k]));
+							if (norm>0)
+								part.maxError = max(part.maxError, fabs(exact[k]-merged[k])/norm);
+						}
+					}
+				}
+			}
+		}
+	}
+}
 
-SSE_coeff::SSE_coeff( f4vector vv[3], f4vector vi[3], f4vector iv[3], f4vector ii[3] )
+void Operator_SSE_Compressed::StabilizeCompression()
 {
-	for (int n=0; n<3; n++)
+	RangeJobMember<Operator_SSE_Compressed> stabilityJob(this, &Operator_SSE_Compressed::CompressOperator_Stability);
+	m_StabilityPass = 0;
+	RunRangeJob(&stabilityJob, numLines[0]);
+	m_MaxCourant[0] = m_MaxCourant[1] = 0;
+	for (size_t t=0; t<m_CompressParts.size(); ++t)
+		for (int i=0; i<2; ++i)
+			m_MaxCourant[i] = max(m_MaxCourant[i], m_CompressParts.at(t).maxCourant[i]);
+
+	// Every round makes at least one more position exact, all positions exact is the exact (stable) operator.
+	// The positions kept exact share their classes only with identical coefficients.
+	SSE_coeff_table exactTable;
+	vector<unsigned int> exactIndex;
+	vector<bool> isExact((size_t)numLines[0]*numLines[1]*numVectors, false);
+	float values[SSE_coeff_table::KEY_SIZE];
+	bool inserted;
+	m_StabilityPass = 1;
+	while (true)
 	{
-		m_vv[n] = vv[n];
-		m_vi[n] = vi[n];
-		m_iv[n] = iv[n];
-		m_ii[n] = ii[n];
+		for (size_t t=0; t<m_CompressParts.size(); ++t)
+			m_CompressParts.at(t).unstablePos.clear();
+		RunRangeJob(&stabilityJob, numLines[0]);
+
+		bool changed = false;
+		for (size_t t=0; t<m_CompressParts.size(); ++t)
+		{
+			const vector<unsigned int>& unstable = m_CompressParts.at(t).unstablePos;
+			for (size_t i=0; i<unstable.size(); i+=3)
+			{
+				const unsigned int* pos = &unstable.at(i);
+				size_t linear = ((size_t)pos[0]*numLines[1] + pos[1])*numVectors + pos[2];
+				if (isExact.at(linear))
+					continue;
+				isExact.at(linear) = true;
+				changed = true;
+				++m_CompressNumExact;
+
+				GetCoefficients(pos, values);
+				unsigned int index = exactTable.FindOrInsert(values, inserted);
+				if (inserted)
+				{
+					exactIndex.push_back(f4_vv_Compressed[0].size());
+					for (int n=0; n<3; n++)
+					{
+						f4_vv_Compressed[n].push_back( f4_vv[n][pos[0]][pos[1]][pos[2]] );
+						f4_vi_Compressed[n].push_back( f4_vi[n][pos[0]][pos[1]][pos[2]] );
+						f4_iv_Compressed[n].push_back( f4_iv[n][pos[0]][pos[1]][pos[2]] );
+						f4_ii_Compressed[n].push_back( f4_ii[n][pos[0]][pos[1]][pos[2]] );
+					}
+				}
+				m_Op_index[pos[0]][pos[1]][pos[2]] = exactIndex.at(index);
+			}
+		}
+		if (!changed)
+			break;
 	}
+	if ((m_CompressNumExact>0) && (g_settings.GetVerboseLevel()>0))
+		cout << "Operator_SSE_Compressed::StabilizeCompression: " << m_CompressNumExact << " positions kept exact to keep the merged operator stable" << endl;
 }
 
-bool SSE_coeff::operator==( const SSE_coeff& other ) const
+inline float Operator_SSE_Compressed::GetCompressionCoeff(int type, bool merged, int n, const unsigned int pos[3]) const
 {
-	for (int n=0; n<3; n++)
+	unsigned int z = pos[2]%numVectors;
+	unsigned int c = pos[2]/numVectors;
+	if (merged)
+	{
+		unsigned int index = m_Op_index[pos[0]][pos[1]][z];
+		switch (type)
+		{
+		case 0:
+			return f4_vv_Compressed[n][index].f[c];
+		case 1:
+			return f4_vi_Compressed[n][index].f[c];
+		case 2:
+			return f4_iv_Compressed[n][index].f[c];
+		default:
+			return f4_ii_Compressed[n][index].f[c];
+		}
+	}
+	switch (type)
 	{
-		if (memcmp( &(m_vv[n]), &(other.m_vv[n]), sizeof(f4vector) ) != 0) return false;
-		if (memcmp( &(m_vi[n]), &(other.m_vi[n]), sizeof(f4vector) ) != 0) return false;
-		if (memcmp( &(m_iv[n]), &(other.m_iv[n]), sizeof(f4vector) ) != 0) return false;
-		if (memcmp( &(m_ii[n]), &(other.m_ii[n]), sizeof(f4vector) ) != 0) return false;
+	case 0:
+		return f4_vv[n][pos[0]][pos[1]][z].f[c];
+	case 1:
+		return f4_vi[n][pos[0]][pos[1]][z].f[c];
+	case 2:
+		return f4_iv[n][pos[0]][pos[1]][z].f[c];
+	default:
+		return f4_ii[n][pos[0]][pos[1]][z].f[c];
 	}
-	return true;
 }
-bool SSE_coeff::operator!=( const SSE_coeff& other ) const
+
+double Operator_SSE_Compressed::CalcLocalCourant(bool voltage, bool merged, int n, const unsigned int pos[3], vector<unsigned int>* involved) const
 {
-	return !(*this == other);
+	int nP = (n+1)%3;
+	int nPP = (n+2)%3;
+	// a voltage is updated from the currents at pos and pos-1, a current from the voltages at pos and pos+1
+	int coeff = voltage ? 1 : 2;
+	int neighbour = voltage ? 2 : 1;
+	unsigned int shifted[2][3];
+	bool valid[2];
+	for (int i=0; i<2; ++i)
+	{
+		int dir = (i==0) ? nP : nPP;
+		for (int m=0; m<3; ++m)
+			shifted[i][m] = pos[m];
+		if (voltage)
+		{
+			valid[i] = pos[dir]>0;
+			shifted[i][dir] -= valid[i];
+		}
+		else
+		{
+			valid[i] = pos[dir]<numLines[dir]-1;
+			shifted[i][dir] += valid[i];
+		}
+	}
+
+	double sum = fabs(GetCompressionCoeff(neighbour, merged, nPP, pos)) + fabs(GetCompressionCoeff(neighbour, merged, nP, pos));
+	if (valid[0])
+		sum += fabs(GetCompressionCoeff(neighbour, merged, nPP, shifted[0]));
+	if (valid[1])
+		sum += fabs(GetCompressionCoeff(neighbour, merged, nP, shifted[1]));
+
+	if (involved)
+	{
+		involved->push_back(pos[0]);
+		involved->push_back(pos[1]);
+		involved->push_back(pos[2]%numVectors);
+		for (int i=0; i<2; ++i)
+		{
+			if (!valid[i])
+				continue;
+			involved->push_back(shifted[i][0]);
+			involved->push_back(shifted[i][1]);
+			involved->push_back(shifted[i][2]%numVectors);
+		}
+	}
+	return fabs(GetCompressionCoeff(coeff, merged, n, pos))*sum;
 }
-bool SSE_coeff::operator<( const SSE_coeff& other ) const
+
+void Operator_SSE_Compressed::CompressOperator_Stability(unsigned int startX, unsigned int stopX, unsigned int threadID)
 {
-	for (int n=0; n<3; n++)
+	CompressionPart& part = m_CompressParts.at(threadID);
+	unsigned int pos[3];
+	for (pos[0]=startX; pos[0]<=stopX; ++pos[0])
 	{
-		for (int c=0; c<4; c++)
+		for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
 		{
-			if (m_vv[n].f[c] > other.m_vv[n].f[c]) return false;
-			if (m_vv[n].f[c] < other.m_vv[n].f[c]) return true;
-			if (m_vi[n].f[c] > other.m_vi[n].f[c]) return false;
-			if (m_vi[n].f[c] < other.m_vi[n].f[c]) return true;
-			if (m_iv[n].f[c] > other.m_iv[n].f[c]) return false;
-			if (m_iv[n].f[c] < other.m_iv[n].f[c]) return true;
-			if (m_ii[n].f[c] > other.m_ii[n].f[c]) return false;
-			if (m_ii[n].f[c] < other.m_ii[n].f[c]) return true;
+			for (pos[2]=0; pos[2]<numLines[2]; ++pos[2])
+			{
+				for (int n=0; n<3; ++n)
+				{
+					if (m_StabilityPass==0)
+					{
+						part.maxCourant[0] = max(part.maxCourant[0], CalcLocalCourant(true, false, n, pos, NULL));
+						part.maxCourant[1] = max(part.maxCourant[1], CalcLocalCourant(false, false, n, pos, NULL));
+						continue;
+					}
+					// the merged coefficients must not amplify the fields and must not exceed the largest local courant number of the exact operator
+					if ((fabs(GetCompressionCoeff(0, true, n, pos))>1) || (fabs(GetCompressionCoeff(3, true, n, pos))>1))
+					{
+						part.unstablePos.push_back(pos[0]);
+						part.unstablePos.push_back(pos[1]);
+						part.unstablePos.push_back(pos[2]%numVectors);
+					}
+					if (CalcLocalCourant(true, true, n, pos, NULL)>m_MaxCourant[0])
+						CalcLocalCourant(true, true, n, pos, &part.unstablePos);
+					if (CalcLocalCourant(false, true, n, pos, NULL)>m_MaxCourant[1])
+						CalcLocalCourant(false, true, n, pos, &part.unstablePos);
+				}
+			}
 		}
 	}
-	return false;
 }
 
-void SSE_coeff::print( ostream& stream ) const
+unsigned int Operator_SSE_Compressed::GetCompressionMantissaBits() const
 {
-	stream << "SSE_coeff: (" << endl;
-	for (int n=0; n<3; n++)
+	if (m_CompressTolerance<=0)
+		return 23;
+	// two floats rounded to the same mantissa of n bits differ by less than 2^-n (relative)
+	double bits = ceil(-log(m_CompressTolerance)/log(2.0));
+	if (bits<0)
+		return 0;
+	if (bits>23)
+		return 23;
+	return (unsigned int)bits;
+}
+
+void Operator_SSE_Compressed::GetCoefficients(const unsigned int* pos, float* values) const
+{
+	for (int n=0; n<3; ++n)
+	{
+		for (int c=0; c<4; ++c)
+		{
+			values[16*n+c]    = f4_vv[n][pos[0]][pos[1]][pos[2]].f[c];
+			values[16*n+4+c]  = f4_vi[n][pos[0]][pos[1]][pos[2]].f[c];
+			values[16*n+8+c]  = f4_iv[n][pos[0]][pos[1]][pos[2]].f[c];
+			values[16*n+12+c] = f4_ii[n][pos[0]][pos[1]][pos[2]].f[c];
+		}
+	}
+}
+
+void Operator_SSE_Compressed::CompressOperator_Wide()
+{
+	DeleteWide();
+	m_VectorWidth = GetCPUVectorWidth(g_settings.GetMaxVectorWidth());
+	if (m_VectorWidth<=4)
+		return;
+
+	// number of consecutive f4vectors combined into one wide vector
+	unsigned int numGroup = m_VectorWidth/4;
+	m_numLines_Wide[0] = numLines[0];
+	m_numLines_Wide[1] = numLines[1];
+	m_numLines_Wide[2] = numVectors/numGroup;
+	if (m_numLines_Wide[2]<2)
 	{
-		stream << "n=" << n << ":" << endl;
-		stream << "vv=";
-		for (int c=0; c<4; c++)
-			stream << m_vv[n].f[c] << " ";
-		stream << endl << "vi=";
-		for (int c=0; c<4; c++)
-			stream << m_vi[n].f[c] << " ";
-		stream << endl << "iv=";
-		for (int c=0; c<4; c++)
-			stream << m_iv[n].f[c] << " ";
-		stream << endl << "ii=";
-		for (int c=0; c<4; c++)
-			stream << m_ii[n].f[c] << " ";
-		stream << endl;
-	}
-	stream << ")" << endl;
+		// z-lines are too short to benefit from the wide vector kernels
+		m_VectorWidth = 4;
+		return;
+	}
+	m_Op_index_Wide = Create3DArray<unsigned int>( m_numLines_Wide );
+
+	// a wide coefficient class is defined by the indices of the compressed sse coefficients it is combined from
+	SSE_coeff_table table(23, numGroup);
+	uint32_t key[4];
+	bool inserted;
+
+	unsigned int pos[3];
+	for (pos[0]=0; pos[0]<m_numLines_Wide[0]; ++pos[0])
+	{
+		for (pos[1]=0; pos[1]<m_numLines_Wide[1]; ++pos[1])
+		{
+			for (pos[2]=0; pos[2]<m_numLines_Wide[2]; ++pos[2])
+			{
+				for (unsigned int k=0; k<numGroup; ++k)
+					key[k] = m_Op_index[pos[0]][pos[1]][pos[2]*numGroup+k];
+				unsigned int index = table.FindOrInsertKey(key, inserted);
+				m_Op_index_Wide[pos[0]][pos[1]][pos[2]] = index;
+				if (!inserted)
+					continue;
+
+				for (int n=0; n<3; n++)
+				{
+					for (unsigned int k=0; k<numGroup; ++k)
+					{
+						for (int c=0; c<4; ++c)
+						{
+							f_vv_Wide[n].push_back( f4_vv_Compressed[n][key[k]].f[c] );
+							f_vi_Wide[n].push_back( f4_vi_Compressed[n][key[k]].f[c] );
+							f_iv_Wide[n].push_back( f4_iv_Compressed[n][key[k]].f[c] );
+							f_ii_Wide[n].push_back( f4_ii_Compressed[n][key[k]].f[c] );
+						}
+					}
+				}
+			}
+		}
+	}
+}
+
+
+
+
+// ----------------------------------------------------------------------------
+
+SSE_coeff_table::SSE_coeff_table(unsigned int mantissaBits, unsigned int keySize)
+{
+	m_KeySize = min(keySize, (unsigned int)KEY_SIZE);
+	if (mantissaBits>23)
+		mantissaBits = 23;
+	m_Mask = ~((1u<<(23-mantissaBits))-1);
+	m_Round = (mantissaBits<23) ? (1u<<(22-mantissaBits)) : 0;
+	m_Slots.assign(1024,0);
+}
+
+void SSE_coeff_table::Quantize(const float* values, uint32_t* key) const
+{
+	union {float f; uint32_t u;} c;
+	for (unsigned int n=0; n<m_KeySize; ++n)
+	{
+		c.f = values[n];
+		// round the mantissa to nearest, a carry will correctly increase the exponent
+		key[n] = (c.u + m_Round) & m_Mask;
+	}
+}
+
+uint64_t SSE_coeff_table::Hash(const uint32_t* key) const
+{
+	uint64_t hash = 14695981039346656037ULL;
+	for (unsigned int n=0; n<m_KeySize; ++n)
+		hash = (hash ^ key[n]) * 1099511628211ULL;
+	// final avalanche, the low bits are used as slot index
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+	return hash;
+}
+
+unsigned int SSE_coeff_table::FindOrInsert(const float* values, bool& inserted)
+{
+	uint32_t key[KEY_SIZE];
+	Quantize(values, key);
+	return FindOrInsertKey(key, inserted);
+}
+
+unsigned int SSE_coeff_table::FindOrInsertKey(const uint32_t* key, bool& inserted)
+{
+	uint64_t hash = Hash(key);
+
+	size_t mask = m_Slots.size()-1;
+	size_t slot = hash & mask;
+	while (m_Slots[slot])
+	{
+		unsigned int index = m_Slots[slot]-1;
+		if ((m_Hashes[index]==hash) && (memcmp(&m_Keys[index*m_KeySize], key, m_KeySize*sizeof(uint32_t))==0))
+		{
+			inserted = false;
+			return index;
+		}
+		slot = (slot+1) & mask;
+	}
+
+	unsigned int index = m_Hashes.size();
+	m_Hashes.push_back(hash);
+	m_Keys.insert(m_Keys.end(), key, key+m_KeySize);
+	m_Slots[slot] = index+1;
+	inserted = true;
+
+	// keep the load factor below 0.5
+	if (2*m_Hashes.size()>m_Slots.size())
+		Grow();
+	return index;
+}
+
+void SSE_coeff_table::Grow()
+{
+	m_Slots.assign(2*m_Slots.size(),0);
+	size_t mask = m_Slots.size()-1;
+	for (size_t index=0; index<m_Hashes.size(); ++index)
+	{
+		size_t slot = m_Hashes[index] & mask;
+		while (m_Slots[slot])
+			slot = (slot+1) & mask;
+		m_Slots[slot] = index+1;
+	}
 }
@@ -21,19 +21,41 @@
 #include "operator_sse.h"
 #include "tools/aligned_allocator.h"
 
-class SSE_coeff
+//! Open addressing hash table of operator coefficient classes, used by Operator_SSE_Compressed::CompressOperator()
+/*!
+  A coefficient class is defined by the vv, vi, iv and ii vectors of all three directions.
+  Keys are compared after rounding the float mantissas to the given number of bits, nearly identical coefficients are thus merged into the same class.
+  The compressed operator keeps the exact values of the first coefficient of a class.
+  The table can also be used with exact integer keys of a smaller size, e.g. for the wide coefficient classes (see Operator_SSE_Compressed::CompressOperator_Wide()).
+  */
+class SSE_coeff_table
 {
 public:
-	SSE_coeff( f4vector vv[3], f4vector vi[3], f4vector iv[3], f4vector ii[3] );
-	bool operator==( const SSE_coeff& ) const;
-	bool operator!=( const SSE_coeff& ) const;
-	bool operator<( const SSE_coeff& ) const;
-	void print( ostream& stream ) const;
+	//! Number of floats defining a coefficient class, this is also the maximum key size
+	enum {KEY_SIZE=48};
+
+	//! Create an empty table comparing \a mantissaBits bits of the float mantissas (23 for exact comparison), using keys of \a keySize values
+	SSE_coeff_table(unsigned int mantissaBits=23, unsigned int keySize=KEY_SIZE);
+
+	//! Find the class of the given coefficient or insert it as a new class, returns the class index
+	unsigned int FindOrInsert(const float* values, bool& inserted);
+	//! Find the class of the given exact integer key or insert it as a new class, returns the class index
+	unsigned int FindOrInsertKey(const uint32_t* key, bool& inserted);
+
+	unsigned int GetNumberOfClasses() const {return m_Hashes.size();}
+
 protected:
-	f4vector m_vv[3];
-	f4vector m_vi[3];
-	f4vector m_iv[3];
-	f4vector m_ii[3];
+	unsigned int m_KeySize;
+	uint32_t m_Mask;
+	uint32_t m_Round;
+	vector<uint32_t> m_Keys;
+	vector<uint64_t> m_Hashes;
+	//! class index+1 or 0 if empty, the size is always a power of two
+	vector<unsigned int> m_Slots;
+
+	void Quantize(const float* values, uint32_t* key) const;
+	uint64_t Hash(const uint32_t* key) const;
+	void Grow();
 };
 
 class Operator_SSE_Compressed : public Operator_sse
@@ -43,6 +65,9 @@ public:
 	static Operator_SSE_Compressed* New();
 	virtual ~Operator_SSE_Compressed();
 
+	//! Storage format of the engine fields
+	enum HalfPrecisionType {HALF_NONE, HALF_FP16, HALF_BF16};
+
 	virtual Engine* CreateEngine();
 
 	inline virtual FDTD_FLOAT GetVV( unsigned int n, unsigned int x, unsigned int y, unsigned int z ) const { if (m_Use_Compression) return f4_vv_Compressed[n][m_Op_index[x][y][z%numVectors]].f[z/numVectors]; else return Operator_sse::GetVV(n,x,y,z);}
@@ -59,11 +84,75 @@ public:
 
 	bool CompressOperator();
 
+	//! Get the vector width (number of floats) used by the engine kernels, detected at runtime (4, 8 or 16)
+	unsigned int GetVectorWidth() const {return m_VectorWidth;}
+
+	//! Merge coefficients differing by less than the given relative tolerance into one class (0 for an exact compression)
+	void SetCompressionTolerance(double tol) {m_CompressTolerance=tol;}
+	double GetCompressionTolerance() const {return m_CompressTolerance;}
+
+	//! Store the engine fields as 16 bit floats (computation is done in single precision), optionally validate against a single precision engine
+	void SetHalfPrecision(HalfPrecisionType type, bool validate=false) {m_HalfPrecision=type; m_HalfValidation=validate;}
+	HalfPrecisionType GetHalfPrecision() const {return m_HalfPrecision;}
+	bool GetHalfPrecisionValidation() const {return m_HalfValidation;}
+
 protected:
 	Operator_SSE_Compressed();
 
 	bool m_Use_Compression;
 
+	unsigned int m_VectorWidth;
+
+	HalfPrecisionType m_HalfPrecision;
+	bool m_HalfValidation;
+
+	double m_CompressTolerance;
+	//! Largest relative deviation of a coefficient from its compressed value
+	double m_CompressMaxError;
+	//! Number of positions (x, y, z-vector) kept exact, as their merged coefficients would exceed the stability bound
+	unsigned int m_CompressNumExact;
+	//! Number of mantissa bits compared by the compression for the current tolerance
+	unsigned int GetCompressionMantissaBits() const;
+	//! Gather the coefficients of a position (x, y, z-vector) in the layout used by SSE_coeff_table
+	void GetCoefficients(const unsigned int* pos, float* values) const;
+	//! Unique coefficients found by a single compression thread, see CompressOperator()
+	struct CompressionPart
+	{
+		CompressionPart() : maxError(0) {maxCourant[0]=maxCourant[1]=0;}
+		//! position (x, y, z-vector) of the first occurrence of each coefficient
+		vector<unsigned int> firstPos;
+		//! index of each coefficient in the merged coefficient tables
+		vector<unsigned int> globalIndex;
+		//! largest relative deviation from the compressed coefficients
+		double maxError;
+		//! largest local courant number of the exact voltage (0) and current (1) updates
+		double maxCourant[2];
+		//! positions (x, y, z-vector) whose merged coefficients exceed the stability bound
+		vector<unsigned int> unstablePos;
+	};
+	vector<CompressionPart> m_CompressParts;
+	void CompressOperator_Range(unsigned int startX, unsigned int stopX, unsigned int threadID);
+	void CompressOperator_Remap(unsigned int startX, unsigned int stopX, unsigned int threadID);
+
+	//! Keep the positions exact whose merged coefficients could make the update unstable, see CompressOperator_Stability()
+	void StabilizeCompression();
+	//! Find the largest exact local courant number (m_StabilityPass 0) or the unstable merged positions (m_StabilityPass 1)
+	void CompressOperator_Stability(unsigned int startX, unsigned int stopX, unsigned int threadID);
+	int m_StabilityPass;
+	double m_MaxCourant[2];
+	//! Get an exact or merged coefficient (0: vv, 1: vi, 2: iv, 3: ii) of the single z-line \a pos[2]
+	inline float GetCompressionCoeff(int type, bool merged, int n, const unsigned int pos[3]) const;
+	/*!
+	  Local courant number of the voltage or current edge \a n at \a pos, the coefficient times the sum of the neighbouring coefficients of its curl.
+	  This is a (Gershgorin) row sum of the update operator, the exact operator is stable for its largest value with the used timestep.
+	  Add the positions (x, y, z-vector) of all used coefficients to \a involved if not NULL.
+	  */
+	double CalcLocalCourant(bool voltage, bool merged, int n, const unsigned int pos[3], vector<unsigned int>* involved) const;
+
+	//! Create the compressed coefficient tables for the wide (AVX/AVX-512) engine kernels
+	void CompressOperator_Wide();
+	void DeleteWide();
+
 	virtual void Init();
 	void Delete();
 	virtual void Reset();
@@ -79,6 +168,14 @@ public:
 	vector<f4vector,aligned_allocator<f4vector> > f4_iv_Compressed[3]; //!< coefficient: calc new current from old voltage
 	vector<f4vector,aligned_allocator<f4vector> > f4_ii_Compressed[3]; //!< coefficient: calc new current from old current
 
+	//! index into the wide coefficient tables, for each group of m_VectorWidth/4 consecutive f4vectors in z-direction
+	unsigned int*** m_Op_index_Wide;
+	unsigned int m_numLines_Wide[3];
+	vector<float,aligned_allocator<float> > f_vv_Wide[3]; //!< wide coefficients: m_VectorWidth floats per entry
+	vector<float,aligned_allocator<float> > f_vi_Wide[3]; //!< wide coefficients: m_VectorWidth floats per entry
+	vector<float,aligned_allocator<float> > f_iv_Wide[3]; //!< wide coefficients: m_VectorWidth floats per entry
+	vector<float,aligned_allocator<float> > f_ii_Wide[3]; //!< wide coefficients: m_VectorWidth floats per entry
+
 };
 
 #endif // OPERATOR_SSE_Compressed_H
@@ -0,0 +1,262 @@
+/*
+*	Copyright (C) 2026 openEMS contributors
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+// Checks on the C++ level that engine variants, which have to produce bitwise identical fields, actually do:
+//  - the AVX and AVX-512 kernels of the compressed engine against its sse kernels
+//  - the temporal blocking of the multithreaded engine against the default multithreaded engine
+// Each variant runs a small dielectric filled box with Mur, UPML, PMC and PEC boundaries,
+// all field values are compared after a fixed number of timesteps.
+
+#include <iostream>
+#include <sstream>
+#include <cstring>
+#include <vector>
+#include <string>
+
+#include "openems.h"
+#include "FDTD/operator_sse_compressed.h"
+#include "FDTD/engine.h"
+#include "tools/global.h"
+#include "tools/array_ops.h"
+
+#include "ContinuousStructure.h"
+#include "CSPropMaterial.h"
+#include "CSPropExcitation.h"
+#include "CSPrimBox.h"
+
+using namespace std;
+
+#define NUM_TIMESTEPS 60
+
+//! openEMS with access to its operator and engine
+class openEMS_EngineTest : public openEMS
+{
+public:
+	Operator* GetOperator() const {return FDTD_Op;}
+	Engine* GetEngine() const {return FDTD_Eng;}
+};
+
+//! Collected field values of an engine, in the order of the engine components and mesh positions
+struct Fields
+{
+	vector<FDTD_FLOAT> volt;
+	vector<FDTD_FLOAT> curr;
+	//! vector width of the compressed engine kernels (0 for other engines)
+	unsigned int vectorWidth;
+	//! standard output of the setup
+	string log;
+};
+
+static ContinuousStructure* CreateGeometry()
+{
+	ContinuousStructure* csx = new ContinuousStructure();
+	CSRectGrid* grid = csx->GetGrid();
+	grid->SetDeltaUnit(1e-3);
+	// long z-lines to use the wide kernels (not a multiple of 16 to include the remainder)
+	const unsigned int numLines[3] = {17, 9, 71};
+	const double length[3] = {50, 20, 60};
+	for (int n=0; n<3; ++n)
+		for (unsigned int i=0; i<numLines[n]; ++i)
+			grid->AddDiscLine(n, length[n]*i/(numLines[n]-1));
+
+	// a lossy dielectric block to get several coefficient classes
+	CSPropMaterial* mat = new CSPropMaterial(csx->GetParameterSet());
+	mat->SetName("dielectric");
+	mat->SetEpsilon(3.5);
+	mat->SetKappa(0.02);
+	csx->AddProperty(mat);
+	CSPrimBox* box = new CSPrimBox(csx->GetParameterSet(), mat);
+	const double mat_box[6] = {10, 35, 5, 15, 12, 41};
+	for (int n=0; n<6; ++n)
+		box->SetCoord(n, mat_box[n]);
+
+	// soft z-directed E-field excitation
+	CSPropExcitation* exc = new CSPropExcitation(csx->GetParameterSet(), 0);
+	exc->SetName("excite");
+	exc->SetExcitType(0);
+	exc->SetExcitation(1.0, 2);
+	csx->AddProperty(exc);
+	box = new CSPrimBox(csx->GetParameterSet(), exc);
+	const double exc_box[6] = {21.875, 21.875, 10, 10, 25, 35};
+	for (int n=0; n<6; ++n)
+		box->SetCoord(n, exc_box[n]);
+
+	return csx;
+}
+
+//! Run the test setup with the given engine arguments and collect all fields, returns false on error
+static bool RunEngine(const vector<string>& args, Fields& fields)
+{
+	openEMS_EngineTest FDTD;
+	for (size_t n=0; n<args.size(); ++n)
+	{
+		if ( (!FDTD.parseCommandLineArgument(args.at(n).c_str())) && (!g_settings.parseCommandLineArgument(args.at(n).c_str())))
+		{
+			cerr << "engine_consistency: unknown argument: " << args.at(n) << endl;
+			return false;
+		}
+	}
+	FDTD.SetVerboseLevel(0);
+	FDTD.SetEnableDumps(false);
+	FDTD.SetNumberOfTimeSteps(NUM_TIMESTEPS);
+	FDTD.SetGaussExcite(1e9, 2e9);
+	const int BC[6] = {2, 3, 1, 0, 2, 0}; // MUR PML_8 PMC PEC MUR PEC
+	for (int n=0; n<6; ++n)
+		FDTD.Set_BC_Type(n, BC[n]);
+	FDTD.Set_BC_PML(1, 8);
+	FDTD.SetCSX(CreateGeometry());
+
+	// capture the setup output to check the engine configuration
+	ostringstream log;
+	streambuf* cout_buf = cout.rdbuf(log.rdbuf());
+	int EC = FDTD.SetupFDTD();
+	cout.rdbuf(cout_buf);
+	fields.log = log.str();
+	if (EC!=0 || FDTD.GetEngine()==NULL)
+	{
+		cerr << "engine_consistency: setup failed" << endl;
+		return false;
+	}
+
+	Operator_SSE_Compressed* op_ssec = dynamic_cast<Operator_SSE_Compressed*>(FDTD.GetOperator());
+	fields.vectorWidth = op_ssec ? op_ssec->GetVectorWidth() : 0;
+
+	Engine* eng = FDTD.GetEngine();
+	eng->IterateTS(NUM_TIMESTEPS);
+
+	unsigned int numLines[3];
+	for (int n=0; n<3; ++n)
+		numLines[n] = FDTD.GetOperator()->GetNumberOfLines(n);
+	fields.volt.clear();
+	fields.curr.clear();
+	unsigned int pos[3];
+	for (int n=0; n<3; ++n)
+		for (pos[0]=0; pos[0]<numLines[0]; ++pos[0])
+			for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
+				for (pos[2]=0; pos[2]<numLines[2]; ++pos[2])
+				{
+					fields.volt.push_back(eng->GetVolt(n, pos));
+					fields.curr.push_back(eng->GetCurr(n, pos));
+				}
+	return true;
+}
+
+//! Compare two field sets bitwise, returns the number of differing values
+static size_t CompareFields(const Fields& ref, const Fields& fields)
+{
+	if ((ref.volt.size()!=fields.volt.size()) || (ref.curr.size()!=fields.curr.size()))
+		return max(ref.volt.size(), fields.volt.size()) + max(ref.curr.size(), fields.curr.size());
+	size_t numDiff = 0;
+	for (size_t i=0; i<ref.volt.size(); ++i)
+		numDiff += (memcmp(&ref.volt[i], &fields.volt[i], sizeof(FDTD_FLOAT))!=0);
+	for (size_t i=0; i<ref.curr.size(); ++i)
+		numDiff += (memcmp(&ref.curr[i], &fields.curr[i], sizeof(FDTD_FLOAT))!=0);
+	return numDiff;
+}
+
+static vector<string> Args(const char* a, const char* b=NULL, const char* c=NULL, const char* d=NULL)
+{
+	vector<string> args;
+	const char* list[4] = {a, b, c, d};
+	for (int n=0; n<4; ++n)
+		if (list[n])
+			args.push_back(list[n]);
+	return args;
+}
+
+//! Compare the fields of a test variant to the reference, returns true if they are identical
+static bool CheckFields(const Fields& ref, const Fields& fields, const string& name)
+{
+	if (fields.volt.size()==0)
+	{
+		cerr << name << ": * FAILED * (no fields)" << endl;
+		return false;
+	}
+	size_t numDiff = CompareFields(ref, fields);
+	if (numDiff)
+	{
+		cerr << name << ": * FAILED * (" << numDiff << " of " << ref.volt.size()+ref.curr.size() << " values differ)" << endl;
+		return false;
+	}
+	cout << name << ": pass" << endl;
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	bool pass = true;
+	string test = (argc>1) ? argv[1] : "all";
+
+	if ((test=="all") || (test=="vector_width"))
+	{
+		Fields ref;
+		if (!RunEngine(Args("--engine=sse-compressed", "--maxVectorWidth=4"), ref))
+			return 1;
+		const unsigned int widths[2] = {8, 16};
+		for (int n=0; n<2; ++n)
+		{
+			if (widths[n]>GetCPUVectorWidth())
+			{
+				cout << "vector width " << widths[n] << ": skipped, not supported by this cpu/build" << endl;
+				continue;
+			}
+			ostringstream arg;
+			arg << "--maxVectorWidth=" << widths[n];
+			ostringstream name;
+			name << "vector width " << widths[n];
+			Fields fields;
+			if (!RunEngine(Args("--engine=sse-compressed", arg.str().c_str()), fields))
+				return 1;
+			// make sure the wide kernels were used
+			if (fields.vectorWidth!=widths[n])
+			{
+				cerr << name.str() << ": * FAILED * (engine uses vector width " << fields.vectorWidth << ")" << endl;
+				pass = false;
+				continue;
+			}
+			pass &= CheckFields(ref, fields, name.str());
+		}
+	}
+
+	if ((test=="all") || (test=="temporal_blocking"))
+	{
+		Fields ref;
+		if (!RunEngine(Args("--engine=multithreaded", "--numThreads=3"), ref))
+			return 1;
+		const unsigned int blocks[2] = {2, 5};
+		for (int n=0; n<2; ++n)
+		{
+			ostringstream arg;
+			arg << "--temporalBlocking=" << blocks[n];
+			ostringstream name;
+			name << "temporal blocking " << blocks[n];
+			Fields fields;
+			if (!RunEngine(Args("--engine=multithreaded", "--numThreads=3", arg.str().c_str()), fields))
+				return 1;
+			// make sure the engine did not fall back to the default update
+			if (fields.log.find("using temporal blocking")==string::npos)
+			{
+				cerr << name.str() << ": * FAILED * (temporal blocking not enabled)" << endl;
+				pass = false;
+				continue;
+			}
+			pass &= CheckFields(ref, fields, name.str());
+		}
+	}
+
+	return pass ? 0 : 1;
+}
@@ -0,0 +1,51 @@
+function pass = array_layout( openEMS_options, options )
+%pass = array_layout( openEMS_options, options )
+%
+% Checks, if the contiguous field arrays (with padded z-lines for the sse engines) produce results identical to the basic engine,
+% for numbers of z-lines not fitting into whole vectors
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+% clean openEMS_options
+openEMS_options = regexprep( openEMS_options, '--engine=\w+', '' );
+
+Sim_Path = 'tmp_array_layout';
+
+engines = {'--engine=sse' '--engine=sse-compressed' '--engine=multithreaded'};
+numZ = [19 30 37];
+pass = 1;
+for m=1:numel(numZ)
+    setup.mesh.x = linspace(0,5e-2,21);
+    setup.mesh.y = linspace(0,2e-2,9);
+    setup.mesh.z = linspace(0,6e-2,numZ(m));
+    ref = featuretest_sim( Sim_Path, ['--engine=basic ' openEMS_options], setup, SILENT );
+    for n=1:numel(engines)
+        result = featuretest_sim( Sim_Path, [engines{n} ' ' openEMS_options], setup, SILENT );
+        pass = pass && featuretest_compare( ref, result, 0, [engines{n} ' with ' num2str(numZ(m)) ' z-lines'], SILENT );
+    end
+end
+
+if pass
+    disp( 'featuretests/array_layout.m (padded z-lines):  pass' );
+else
+    disp( 'featuretests/array_layout.m (padded z-lines):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
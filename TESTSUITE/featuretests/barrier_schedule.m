@@ -0,0 +1,55 @@
+function pass = barrier_schedule( openEMS_options, options )
+%pass = barrier_schedule( openEMS_options, options )
+%
+% Checks, if the extension schedule of the multithreaded engine with elided barriers matches
+% the schedule with a barrier before every extension update (option --fullBarriers)
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+% clean openEMS_options
+openEMS_options = regexprep( openEMS_options, '--engine=\w+', '' );
+
+Sim_Path = 'tmp_barrier_schedule';
+
+% excitation, mur, upml, cpml, tfsf and lorentz extensions, split over 4 threads
+setup.BC = {'MUR' 'PML_8' 'PMC' 'PEC' 'PEC' 'CPML_8'};
+setup.lorentz = 1;
+setup.tfsf = 1;
+engine_options = ['--engine=multithreaded --numThreads=4 -v ' openEMS_options];
+ref = featuretest_sim( Sim_Path, [engine_options ' --fullBarriers'], setup, SILENT );
+result = featuretest_sim( Sim_Path, engine_options, setup, SILENT );
+
+pass = 1;
+% verbose output of the number of barriers per timestep
+full = regexp( ref.log, 'using (\d+) barrier', 'tokens', 'once' );
+elided = regexp( result.log, 'using (\d+) barrier', 'tokens', 'once' );
+if isempty( full ) || isempty( elided ) || (str2double( elided{1} ) >= str2double( full{1} ))
+    disp( 'the schedule did not elide any barrier' );
+    pass = 0;
+end
+pass = pass && featuretest_compare( ref, result, 0, 'elided barriers', SILENT );
+
+if pass
+    disp( 'featuretests/barrier_schedule.m (elided engine barriers):  pass' );
+else
+    disp( 'featuretests/barrier_schedule.m (elided engine barriers):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
@@ -0,0 +1,80 @@
+function pass = binary_probes( openEMS_options, options )
+%pass = binary_probes( openEMS_options, options )
+%
+% Checks, if the binary probe files (option --binaryProbes) match the ASCII probe files
+% and if the buffered binary probes are continued correctly after a checkpoint restart
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+
+Sim_Path = 'tmp_binary_probes';
+Ref_Path = 'tmp_binary_probes_ref';
+% the simulation folder is cleared by featuretest_sim, keep the checkpoint outside of it
+checkpoint_file = [pwd '/tmp_binary_probes.bin'];
+
+setup.dumps = 0;
+ref = featuretest_sim( Ref_Path, openEMS_options, setup, SILENT );
+binary = featuretest_sim( Sim_Path, [openEMS_options ' --binaryProbes'], setup, SILENT );
+
+pass = 1;
+probes = {'E_probe','H_probe','ut','it'};
+for n=1:numel(probes)
+    fid = fopen( [Sim_Path '/' probes{n}], 'r' );
+    magic = fread( fid, [1 8], '*uint8' );
+    fclose( fid );
+    if ~strcmp( char(magic), ['OEMSPRB' char(0)] )
+        disp( ['the probe ' probes{n} ' was not written in the binary format'] );
+        pass = 0;
+    end
+end
+% the ASCII probes are written with a limited precision (12 digits), including their time base
+ascii = binary;
+for n=1:numel(ref.probes.TD)
+    t = binary.probes.TD{n}.t;
+    if ~isequal( size(t), size(ref.probes.TD{n}.t) ) || any( abs(t - ref.probes.TD{n}.t) > 1e-10*max(abs(t)) )
+        disp( ['the time base of the binary probe ' num2str(n) ' differs'] );
+        pass = 0;
+        break
+    end
+    ascii.probes.TD{n}.t = ref.probes.TD{n}.t;
+end
+pass = pass && featuretest_compare( ref, ascii, 1e-6, 'binary probes', SILENT );
+
+% stop after 200 of 400 timesteps and resume from the checkpoint
+setup.NrTS = 200;
+featuretest_sim( Sim_Path, [openEMS_options ' --binaryProbes --checkpoint=200 --checkpointFile=' checkpoint_file], setup, SILENT );
+setup.NrTS = 400;
+setup.keep_files = 1;
+result = featuretest_sim( Sim_Path, [openEMS_options ' --binaryProbes --checkpointFile=' checkpoint_file ' --restart'], setup, SILENT );
+if isempty( strfind( result.log, 'Resuming the simulation at timestep 200' ) )
+    disp( 'the simulation was not resumed from the checkpoint' );
+    pass = 0;
+end
+pass = pass && featuretest_compare( binary, result, 0, 'binary probes after a checkpoint restart', SILENT );
+
+if pass
+    disp( 'featuretests/binary_probes.m (binary probe files):  pass' );
+else
+    disp( 'featuretests/binary_probes.m (binary probe files):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+    rmdir( Ref_Path, 's' );
+    delete( checkpoint_file );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
@@ -0,0 +1,72 @@
+function pass = checkpoint( openEMS_options, options )
+%pass = checkpoint( openEMS_options, options )
+%
+% Checks, if a simulation resumed from a checkpoint reproduces the fields and probes of an uninterrupted simulation
+% and if a checkpoint of a different excitation and probe setup is rejected
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+
+Sim_Path = 'tmp_checkpoint';
+Ref_Path = 'tmp_checkpoint_ref';
+% the simulation folder is cleared by featuretest_sim, keep the checkpoint outside of it
+checkpoint_file = [pwd '/tmp_checkpoint.bin'];
+
+ref = featuretest_sim( Ref_Path, openEMS_options, struct(), SILENT );
+
+pass = 1;
+
+% stop after 200 of 400 timesteps and resume from the checkpoint
+setup.NrTS = 200;
+result = featuretest_sim( Sim_Path, [openEMS_options ' --checkpoint=200 --checkpointFile=' checkpoint_file], setup, SILENT );
+if isempty( strfind( result.log, 'Checkpoint at timestep 200' ) )
+    disp( 'no checkpoint was written at timestep 200' );
+    pass = 0;
+end
+setup.NrTS = 400;
+setup.keep_files = 1;
+result = featuretest_sim( Sim_Path, [openEMS_options ' --checkpointFile=' checkpoint_file ' --restart'], setup, SILENT );
+if isempty( strfind( result.log, 'Resuming the simulation at timestep 200' ) )
+    disp( 'the simulation was not resumed from the checkpoint' );
+    pass = 0;
+end
+pass = pass && featuretest_compare( ref, result, 0, 'checkpoint restart', SILENT );
+
+% an additional excitation does not change the operator, but the checkpoint must not be used
+setup.tfsf = 1;
+% openEMS exits with an error, the exit code is lost if the output is not silent
+try
+    featuretest_sim( Sim_Path, [openEMS_options ' --checkpointFile=' checkpoint_file ' --restart'], setup, SILENT );
+end
+log_text = fileread( [Sim_Path '/openEMS.log'] );
+if isempty( strfind( log_text, 'does not match the current simulation setup' ) ) || ~isempty( strfind( log_text, 'Resuming the simulation' ) )
+    disp( 'the checkpoint of a different excitation setup was not rejected' );
+    pass = 0;
+end
+
+if pass
+    disp( 'featuretests/checkpoint.m (checkpoint and restart):  pass' );
+else
+    disp( 'featuretests/checkpoint.m (checkpoint and restart):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+    rmdir( Ref_Path, 's' );
+    delete( checkpoint_file );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
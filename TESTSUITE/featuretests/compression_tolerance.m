@@ -0,0 +1,64 @@
+function pass = compression_tolerance( openEMS_options, options )
+%pass = compression_tolerance( openEMS_options, options )
+%
+% Checks, if the operator compression with a tolerance stays close to the exact compression on a graded mesh
+% and if a very coarse tolerance still results in a stable simulation
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+% clean openEMS_options
+openEMS_options = regexprep( openEMS_options, '--engine=\w+', '' );
+
+Sim_Path = 'tmp_compression_tolerance';
+
+% graded mesh, nearly identical coefficients in x- and z-direction
+setup.mesh.x = cumsum( [0 2e-3*1.02.^(0:25)] );
+setup.mesh.y = linspace(0,2e-2,11);
+setup.mesh.z = cumsum( [0 2e-3*1.01.^(0:31)] );
+setup.NrTS = 2000;
+setup.lorentz = 1;
+ref = featuretest_sim( Sim_Path, ['--engine=multithreaded -v ' openEMS_options], setup, SILENT );
+
+pass = 1;
+result = featuretest_sim( Sim_Path, ['--engine=multithreaded -v --compressionTolerance=1e-3 ' openEMS_options], setup, SILENT );
+if isempty( strfind( result.log, 'max. relative deviation' ) )
+    disp( 'the compression tolerance was not used' );
+    pass = 0;
+end
+pass = pass && featuretest_compare( ref, result, 2e-2, 'compression tolerance 1e-3', SILENT );
+
+% a coarse tolerance merges many coefficients with a larger coupling, the stability check has to keep these exact
+result = featuretest_sim( Sim_Path, ['--engine=multithreaded -v --compressionTolerance=0.2 ' openEMS_options], setup, SILENT );
+for n=1:numel(ref.probes.TD)
+    ref_max = max(abs(ref.probes.TD{n}.val));
+    val = result.probes.TD{n}.val;
+    if any(~isfinite(val)) || (max(abs(val)) > 2*ref_max)
+        disp( ['compression tolerance 0.2: probe ' num2str(n) ' is unstable'] );
+        pass = 0;
+    end
+end
+
+if pass
+    disp( 'featuretests/compression_tolerance.m (graded mesh):  pass' );
+else
+    disp( 'featuretests/compression_tolerance.m (graded mesh):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
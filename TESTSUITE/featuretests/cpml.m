@@ -0,0 +1,70 @@
+function pass = cpml( openEMS_options, options )
+%pass = cpml( openEMS_options, options )
+%
+% Checks, if the convolutional pml absorbs like the upml (with and without coordinate stretching and
+% complex frequency shift) and if its update matches for all engines
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+% clean openEMS_options
+openEMS_options = regexprep( openEMS_options, '--engine=\w+', '' );
+
+Sim_Path = 'tmp_cpml';
+
+% the pml at zmax does not contain any material, excitation or probe,
+% the probes inside the domain only see the (small) reflections of both pml
+setup.dumps = 0;
+setup.lorentz = 1;
+setup.BC = {'PEC' 'PEC' 'PEC' 'PEC' 'PEC' 'PML_8'};
+ref = featuretest_sim( Sim_Path, ['--engine=basic ' openEMS_options], setup, SILENT );
+
+setup.BC = {'PEC' 'PEC' 'PEC' 'PEC' 'PEC' 'CPML_8'};
+result = featuretest_sim( Sim_Path, ['--engine=basic ' openEMS_options], setup, SILENT );
+pass = featuretest_compare( ref, result, 1e-2, 'cpml vs. upml', SILENT );
+
+setup.BC_options = {'CPML_KappaMax', 5, 'CPML_AlphaMax', 0.05};
+% verbose output to show the extension statistics
+result = featuretest_sim( Sim_Path, ['--engine=basic -v ' openEMS_options], setup, SILENT );
+if isempty( strfind( result.log, ': 5 / 0.05 S/m' ) )
+    disp( 'the cpml coordinate stretching and frequency shift were not set' );
+    pass = 0;
+end
+pass = pass && featuretest_compare( ref, result, 2e-2, 'cpml with kappa and alpha vs. upml', SILENT );
+
+% overlapping cpml planes in the edges and corners, the sse engines update the main fields in the vector layout
+setup.BC = {'CPML_8' 'CPML_8' 'CPML_8' 'CPML_8' 'CPML_8' 'CPML_8'};
+setup.mesh.x = linspace(0,5e-2,27);
+setup.mesh.y = linspace(0,4e-2,23);
+setup.mesh.z = linspace(0,6e-2,35);
+setup.dumps = 1;
+ref = featuretest_sim( Sim_Path, ['--engine=basic ' openEMS_options], setup, SILENT );
+engines = {'sse', 'sse-compressed', 'multithreaded'};
+for n=1:numel(engines)
+    result = featuretest_sim( Sim_Path, ['--engine=' engines{n} ' ' openEMS_options], setup, SILENT );
+    pass = pass && featuretest_compare( ref, result, 1e-6, ['cpml with engine ' engines{n}], SILENT );
+end
+
+if pass
+    disp( 'featuretests/cpml.m (convolutional pml):  pass' );
+else
+    disp( 'featuretests/cpml.m (convolutional pml):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
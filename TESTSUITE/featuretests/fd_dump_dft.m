@@ -0,0 +1,75 @@
+function pass = fd_dump_dft( openEMS_options, options )
+%pass = fd_dump_dft( openEMS_options, options )
+%
+% Checks, if the blocked running DFT of the frequency domain field dumps matches a DFT of the time domain dumps
+% for many frequencies, and if the multithreaded accumulation is identical to a single thread
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+% clean openEMS_options
+openEMS_options = regexprep( openEMS_options, '--engine=\w+', '' );
+
+Sim_Path = 'tmp_fd_dump_dft';
+
+% the time domain dumps are sampled at the nyquist rate of the frequency domain dumps,
+% more samples than the phasor recursion runs before it is recalculated,
+% enough frequencies to split the accumulation of the small mesh over 4 threads
+setup.mesh.x = linspace(0,5e-2,13);
+setup.mesh.y = linspace(0,2e-2,9);
+setup.mesh.z = linspace(0,6e-2,13);
+setup.fd_freq = linspace( 1e9, 10e9, 200 );
+setup.oversampling = 1;
+setup.NrTS = 8000;
+ref = featuretest_sim( Sim_Path, ['--engine=multithreaded --numThreads=1 ' openEMS_options], setup, SILENT );
+
+pass = 1;
+fields = {'E','H'};
+for m=1:numel(fields)
+    TD = ref.(fields{m}).TD;
+    FD = ref.([fields{m} '_FD']).FD;
+    dt = TD.time(2) - TD.time(1);
+    max_val = 0;
+    max_dev = 0;
+    for n=1:numel(setup.fd_freq)
+        % single-sided spectrum
+        dft = zeros( size(TD.values{1}) );
+        for t=1:numel(TD.values)
+            dft = dft + TD.values{t} * exp( -2i*pi*setup.fd_freq(n)*TD.time(t) ) * 2 * dt;
+        end
+        max_val = max( max_val, max(abs(dft(:))) );
+        max_dev = max( max_dev, max(abs(dft(:) - FD.values{n}(:))) );
+    end
+    if max_dev > 1e-3*max_val
+        disp( ['the running DFT of the ' fields{m} ' field deviates by ' num2str(max_dev/max_val) ' (relative)'] );
+        pass = 0;
+    end
+end
+
+% the accumulation of each cell is independent of the thread splitting
+result = featuretest_sim( Sim_Path, ['--engine=multithreaded --numThreads=4 ' openEMS_options], setup, SILENT );
+pass = pass && featuretest_compare( ref, result, 0, 'running DFT with 4 threads', SILENT );
+
+if pass
+    disp( 'featuretests/fd_dump_dft.m (running DFT of the FD dumps):  pass' );
+else
+    disp( 'featuretests/fd_dump_dft.m (running DFT of the FD dumps):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
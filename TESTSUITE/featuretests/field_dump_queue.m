@@ -0,0 +1,56 @@
+function pass = field_dump_queue( openEMS_options, options )
+%pass = field_dump_queue( openEMS_options, options )
+%
+% Checks, if the time domain field dumps written by the background writer (with multithreaded interpolation)
+% are identical to the synchronously written dumps, also if the queue is limited by its memory
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+% clean openEMS_options
+openEMS_options = regexprep( openEMS_options, '--engine=\w+', '' );
+
+Sim_Path = 'tmp_field_dump_queue';
+
+setup.fd_freq = [2e9 5e9];
+ref = featuretest_sim( Sim_Path, ['--engine=multithreaded --numThreads=1 --fieldDumpQueue=0 ' openEMS_options], setup, SILENT );
+
+pass = 1;
+queue = [1 2 8];
+for n=1:numel(queue)
+    opts = ['--engine=multithreaded --numThreads=4 --fieldDumpQueue=' num2str(queue(n)) ' ' openEMS_options];
+    result = featuretest_sim( Sim_Path, opts, setup, SILENT );
+    pass = pass && featuretest_compare( ref, result, 0, ['field dump queue of ' num2str(queue(n))], SILENT );
+end
+
+% the dumps exceed a memory limit of 0 MiB and are written synchronously
+result = featuretest_sim( Sim_Path, ['--engine=multithreaded --numThreads=4 --fieldDumpQueueMemory=0 ' openEMS_options], setup, SILENT );
+if isempty( strfind( result.log, 'writing the dumps synchronously' ) )
+    disp( 'the memory limit of the field dump queue was not applied' );
+    pass = 0;
+end
+pass = pass && featuretest_compare( ref, result, 0, 'field dump queue memory limit', SILENT );
+
+if pass
+    disp( 'featuretests/field_dump_queue.m (background field dump writer):  pass' );
+else
+    disp( 'featuretests/field_dump_queue.m (background field dump writer):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
@@ -0,0 +1,54 @@
+function pass = fused_updates( openEMS_options, options )
+%pass = fused_updates( openEMS_options, options )
+%
+% Checks, if the fused (per x-plane) extension updates of the multithreaded engine produce results identical to the default multithreaded engine,
+% including the Mur-ABC and UPML boundaries at either side of the x-direction
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+% clean openEMS_options
+openEMS_options = regexprep( openEMS_options, '--engine=\w+', '' );
+
+Sim_Path = 'tmp_fused_updates';
+
+BCs = { {'MUR' 'PML_8' 'PMC' 'PEC' 'MUR' 'PEC'}, {'PML_8' 'MUR' 'MUR' 'PEC' 'PEC' 'PML_8'} };
+pass = 1;
+for m=1:numel(BCs)
+    setup.BC = BCs{m};
+    threads = {'2','4'};
+    for n=1:numel(threads)
+        ref = featuretest_sim( Sim_Path, ['--engine=multithreaded --numThreads=' threads{n} ' ' openEMS_options], setup, SILENT );
+        result = featuretest_sim( Sim_Path, ['--engine=multithreaded --numThreads=' threads{n} ' --fusedUpdates ' openEMS_options], setup, SILENT );
+        % make sure the engine did not fall back to the default update
+        if isempty( strfind( result.log, 'using fused updates' ) )
+            disp( ['fused updates with ' threads{n} ' threads were not enabled for boundary setup ' num2str(m)] );
+            pass = 0;
+        end
+        pass = pass && featuretest_compare( ref, result, 0, ['fused updates, ' threads{n} ' threads, boundary setup ' num2str(m)], SILENT );
+    end
+end
+
+if pass
+    disp( 'featuretests/fused_updates.m (mur and upml):  pass' );
+else
+    disp( 'featuretests/fused_updates.m (mur and upml):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
@@ -0,0 +1,53 @@
+function pass = half_precision( openEMS_options, options )
+%pass = half_precision( openEMS_options, options )
+%
+% Checks, if the 16 bit field storage of the multithreaded engine (IEEE half float and bfloat16)
+% stays within the expected rounding error of the single precision multithreaded engine
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+% clean openEMS_options
+openEMS_options = regexprep( openEMS_options, '--engine=\w+', '' );
+
+Sim_Path = 'tmp_half_precision';
+
+setup.BC = {'MUR' 'PML_8' 'PMC' 'PEC' 'MUR' 'PEC'};
+ref = featuretest_sim( Sim_Path, ['--engine=multithreaded --numThreads=3 ' openEMS_options], setup, SILENT );
+
+% storage format, engine banner and maximum relative deviation (10 and 7 bit mantissa)
+formats = { {'fp16', 'half float', 2e-2}, {'bf16', 'bfloat16', 5e-2} };
+pass = 1;
+for n=1:numel(formats)
+    result = featuretest_sim( Sim_Path, ['--engine=multithreaded --numThreads=3 --halfPrecision=' formats{n}{1} ' ' openEMS_options], setup, SILENT );
+    % make sure the multithreaded half precision engine was used
+    if isempty( strfind( result.log, ['multi-threading + ' formats{n}{2} ' field storage'] ) )
+        disp( ['the multithreaded ' formats{n}{2} ' engine was not created'] );
+        pass = 0;
+    end
+    pass = pass && featuretest_compare( ref, result, formats{n}{3}, ['half precision (' formats{n}{1} ')'], SILENT );
+end
+
+if pass
+    disp( 'featuretests/half_precision.m (fp16 and bf16):  pass' );
+else
+    disp( 'featuretests/half_precision.m (fp16 and bf16):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
@@ -0,0 +1,56 @@
+function pass = huge_pages( openEMS_options, options )
+%pass = huge_pages( openEMS_options, options )
+%
+% Checks, if the field and operator arrays backed by transparent or hugetlbfs huge pages produce identical results
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+% clean openEMS_options
+openEMS_options = regexprep( openEMS_options, '--hugePages(=\w+)?', '' );
+
+Sim_Path = 'tmp_huge_pages';
+
+% every field component has to exceed the minimal huge page block size of 2 MB
+setup.mesh.x = linspace(0,5e-2,81);
+setup.mesh.y = linspace(0,2e-2,65);
+setup.mesh.z = linspace(0,6e-2,101);
+setup.NrTS = 100;
+setup.dumps = 0;
+
+ref = featuretest_sim( Sim_Path, openEMS_options, setup, SILENT );
+pass = 1;
+modes = {'thp','hugetlb'};
+for n=1:numel(modes)
+    result = featuretest_sim( Sim_Path, ['--hugePages=' modes{n} ' ' openEMS_options], setup, SILENT );
+    % the obtained page size (or the fallback) is reported once
+    if isempty( strfind( result.log, 'Huge pages:' ) )
+        disp( ['huge pages (' modes{n} ') were not requested'] );
+        pass = 0;
+    end
+    pass = pass && featuretest_compare( ref, result, 0, ['huge pages ' modes{n}], SILENT );
+end
+
+if pass
+    disp( 'featuretests/huge_pages.m (thp and hugetlb):  pass' );
+else
+    disp( 'featuretests/huge_pages.m (thp and hugetlb):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
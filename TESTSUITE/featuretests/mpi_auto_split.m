@@ -0,0 +1,80 @@
+function pass = mpi_auto_split( openEMS_options, options )
+%pass = mpi_auto_split( openEMS_options, options )
+%
+% Checks, if the automatic MPI domain decomposition reproduces the probes of the single process compressed engine
+% and if a mesh too small for the requested number of processes is rejected with an error
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+% clean openEMS_options
+openEMS_options = regexprep( openEMS_options, '--engine=\w+', '' );
+
+mpi_binary = getenv( 'OPENEMS_MPI_BINARY' );
+if isempty( mpi_binary )
+    disp( 'featuretests/mpi_auto_split.m (automatic decomposition):  skipped (OPENEMS_MPI_BINARY not set)' );
+    pass = 1;
+    return
+end
+
+Sim_Path = 'tmp_mpi_auto_split';
+
+% field dumps are split into one file per process, compare the probes only
+setup.dumps = 0;
+setup.lorentz = 1;
+ref = featuretest_sim( Sim_Path, ['--engine=sse-compressed ' openEMS_options], setup, SILENT );
+
+pass = 1;
+nrProc = [2 3 4];
+for n=1:numel(nrProc)
+    setup.mpi.NrProc = nrProc(n);
+    setup.mpi.Binary = mpi_binary;
+    setup.mpi.split = {'AutoSplit',1};
+    result = featuretest_sim( Sim_Path, ['--engine=MPI ' openEMS_options], setup, SILENT );
+    if isempty( strfind( result.log, 'AutoSplit: Using a process grid' ) )
+        disp( ['the automatic decomposition was not used for ' num2str(nrProc(n)) ' processes'] );
+        pass = 0;
+    end
+    pass = pass && featuretest_compare( ref, result, 1e-6, ['mpi auto split, ' num2str(nrProc(n)) ' processes'], SILENT );
+end
+
+% 10 cells per direction and a pml in x-direction cannot be split into 3 parts of at least 4 cells
+setup.mesh.x = linspace(0,5e-2,11);
+setup.mesh.y = linspace(0,2e-2,11);
+setup.mesh.z = linspace(0,6e-2,11);
+setup.mpi.NrProc = 3;
+failed = 0;
+try
+    featuretest_sim( Sim_Path, ['--engine=MPI ' openEMS_options], setup, SILENT );
+catch
+    failed = 1;
+end
+log_text = fileread( [Sim_Path '/openEMS.log'] );
+if ~failed || isempty( strfind( log_text, 'the mesh is too small for 3 processes' ) )
+    disp( 'the automatic decomposition of a too small mesh was not rejected' );
+    pass = 0;
+end
+
+if pass
+    disp( 'featuretests/mpi_auto_split.m (automatic decomposition):  pass' );
+else
+    disp( 'featuretests/mpi_auto_split.m (automatic decomposition):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
@@ -0,0 +1,65 @@
+function pass = mpi_halo_exchange( openEMS_options, options )
+%pass = mpi_halo_exchange( openEMS_options, options )
+%
+% Checks, if the MPI engine with the overlapped halo exchange reproduces the probes of the single process compressed engine,
+% for splits in x-direction (slabs) and z-direction (f4vectors holding the split plane)
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+% clean openEMS_options
+openEMS_options = regexprep( openEMS_options, '--engine=\w+', '' );
+
+mpi_binary = getenv( 'OPENEMS_MPI_BINARY' );
+if isempty( mpi_binary )
+    disp( 'featuretests/mpi_halo_exchange.m (x- and z-splits):  skipped (OPENEMS_MPI_BINARY not set)' );
+    pass = 1;
+    return
+end
+
+Sim_Path = 'tmp_mpi_halo_exchange';
+
+% field dumps are split into one file per process, compare the probes only
+setup.dumps = 0;
+setup.lorentz = 1;
+ref = featuretest_sim( Sim_Path, ['--engine=sse-compressed ' openEMS_options], setup, SILENT );
+
+splits = { {'SplitN_X',2}, {'SplitN_Z',2}, {'SplitN_X',2,'SplitN_Z',2} };
+nrProc = [2 2 4];
+pass = 1;
+for n=1:numel(splits)
+    setup.mpi.NrProc = nrProc(n);
+    setup.mpi.Binary = mpi_binary;
+    setup.mpi.split = splits{n};
+    result = featuretest_sim( Sim_Path, ['--engine=MPI ' openEMS_options], setup, SILENT );
+    if isempty( strfind( result.log, 'Running MPI-FDTD engine' ) )
+        disp( ['the MPI engine was not used for split setup ' num2str(n)] );
+        pass = 0;
+    end
+    % the same operator is computed by all processes, only the order of the additions may differ
+    pass = pass && featuretest_compare( ref, result, 1e-6, ['mpi halo exchange, split setup ' num2str(n)], SILENT );
+end
+
+if pass
+    disp( 'featuretests/mpi_halo_exchange.m (x- and z-splits):  pass' );
+else
+    disp( 'featuretests/mpi_halo_exchange.m (x- and z-splits):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
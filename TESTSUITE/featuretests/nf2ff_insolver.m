@@ -0,0 +1,104 @@
+function pass = nf2ff_insolver( openEMS_options, options )
+%pass = nf2ff_insolver( openEMS_options, options )
+%
+% Checks, if the in-solver nf2ff transformation (with a mirror and multiple frequencies) matches the nf2ff tool
+% applied to the frequency domain dumps of the same nf2ff box, and that the nf2ff planes are not written to files
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+
+Sim_Path = 'tmp_nf2ff_insolver';
+Ref_Path = 'tmp_nf2ff_insolver_ref';
+
+freq = [1.5e9 2e9 2.5e9];
+theta = (0:10:180)/180*pi;
+phi = (0:15:360)/180*pi;
+% the ground plane at z=0 is mirrored
+nf2ff_args = {'Mirror', {2, 'PEC', 0}};
+
+[ref, ref_files] = simulate( Ref_Path, openEMS_options, freq, theta, phi, nf2ff_args, 0, SILENT );
+[result, files] = simulate( Sim_Path, openEMS_options, freq, theta, phi, nf2ff_args, 1, SILENT );
+
+pass = 1;
+if isempty( ref_files ) || ~isempty( files )
+    disp( 'the nf2ff planes of the in-solver transformation were written to files' );
+    pass = 0;
+end
+for n=1:numel(freq)
+    max_val = max( abs([ref.E_theta{n}(:); ref.E_phi{n}(:)]) );
+    deviation = max( abs([ref.E_theta{n}(:) - result.E_theta{n}(:); ref.E_phi{n}(:) - result.E_phi{n}(:)]) );
+    if deviation > 1e-5*max_val
+        disp( ['the in-solver far-field at ' num2str(freq(n)/1e9) ' GHz deviates by ' num2str(deviation/max_val) ' (relative)'] );
+        pass = 0;
+    end
+    if abs(ref.Prad(n) - result.Prad(n)) > 1e-5*abs(ref.Prad(n))
+        disp( ['the in-solver radiated power at ' num2str(freq(n)/1e9) ' GHz deviates'] );
+        pass = 0;
+    end
+end
+
+if pass
+    disp( 'featuretests/nf2ff_insolver.m (in-solver nf2ff):  pass' );
+else
+    disp( 'featuretests/nf2ff_insolver.m (in-solver nf2ff):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+    rmdir( Ref_Path, 's' );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
+
+
+
+function [nf2ff, files] = simulate( Sim_Path, openEMS_options, freq, theta, phi, nf2ff_args, insolver, SILENT )
+% short dipole above a ground plane, returns the far-field and the recorded nf2ff plane files
+[status,message,messageid] = rmdir(Sim_Path,'s');
+[status,message,messageid] = mkdir(Sim_Path);
+
+FDTD = InitFDTD( 2000, 1e-4 );
+FDTD = SetGaussExcite( FDTD, 2e9, 1e9 );
+FDTD = SetBoundaryCond( FDTD, {'PML_8' 'PML_8' 'PML_8' 'PML_8' 'PEC' 'PML_8'} );
+
+CSX = InitCSX();
+mesh.x = linspace(-80e-3, 80e-3, 33);
+mesh.y = linspace(-80e-3, 80e-3, 33);
+mesh.z = linspace(0, 100e-3, 21);
+CSX = DefineRectGrid( CSX, 1, mesh );
+
+CSX = AddExcitation( CSX, 'dipole', 0, [0 0 1] );
+CSX = AddBox( CSX, 'dipole', 0, [0 0 10e-3], [0 0 20e-3] );
+
+start = [mesh.x(11) mesh.y(11) mesh.z(1)];
+stop  = [mesh.x(end-10) mesh.y(end-10) mesh.z(end-10)];
+[CSX, nf2ff] = CreateNF2FFBox( CSX, 'nf2ff', start, stop, 'Directions', [1 1 1 1 0 1], 'Frequency', freq );
+if insolver
+    FDTD = SetupNF2FF( FDTD, nf2ff, freq, theta, phi, nf2ff_args{:} );
+end
+
+WriteOpenEMS( [Sim_Path '/nf2ff_insolver.xml'], FDTD, CSX );
+Settings.LogFile = [pwd '/' Sim_Path '/openEMS.log'];
+Settings.Silent = SILENT;
+RunOpenEMS( Sim_Path, 'nf2ff_insolver.xml', openEMS_options, Settings );
+
+files = dir( [Sim_Path '/nf2ff_E_*.h5'] );
+if insolver
+    % read the far-field written by openEMS
+    nf2ff = CalcNF2FF( nf2ff, Sim_Path, freq, theta, phi, 'Mode', 2 );
+else
+    nf2ff = CalcNF2FF( nf2ff, Sim_Path, freq, theta, phi, 'Mode', 1, nf2ff_args{:} );
+end
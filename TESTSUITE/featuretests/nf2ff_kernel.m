@@ -0,0 +1,85 @@
+function pass = nf2ff_kernel( openEMS_options, options )
+%pass = nf2ff_kernel( openEMS_options, options )
+%
+% Checks, if the nf2ff tool analysing many frequencies of a frequency domain dump in chunks (all frequencies
+% sharing a pass of the radiation integral kernel) matches the analysis of every single frequency
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+
+Sim_Path = 'tmp_nf2ff_kernel';
+
+% more frequencies than analysed in a single chunk (NF2FF_FREQ_CHUNK)
+freq = linspace(1e9, 3e9, 40);
+theta = (0:5:180)/180*pi;
+phi = (0:5:360)/180*pi;
+
+[status,message,messageid] = rmdir(Sim_Path,'s');
+[status,message,messageid] = mkdir(Sim_Path);
+
+% short dipole in free space
+FDTD = InitFDTD( 2000, 1e-4 );
+FDTD = SetGaussExcite( FDTD, 2e9, 1e9 );
+FDTD = SetBoundaryCond( FDTD, {'PML_8' 'PML_8' 'PML_8' 'PML_8' 'PML_8' 'PML_8'} );
+
+CSX = InitCSX();
+mesh.x = linspace(-80e-3, 80e-3, 33);
+mesh.y = linspace(-80e-3, 80e-3, 33);
+mesh.z = linspace(-60e-3, 60e-3, 25);
+CSX = DefineRectGrid( CSX, 1, mesh );
+
+CSX = AddExcitation( CSX, 'dipole', 0, [0 0 1] );
+CSX = AddBox( CSX, 'dipole', 0, [0 0 -5e-3], [0 0 5e-3] );
+
+start = [mesh.x(11) mesh.y(11) mesh.z(11)];
+stop  = [mesh.x(end-10) mesh.y(end-10) mesh.z(end-10)];
+[CSX, nf2ff] = CreateNF2FFBox( CSX, 'nf2ff', start, stop, 'Frequency', freq );
+
+WriteOpenEMS( [Sim_Path '/nf2ff_kernel.xml'], FDTD, CSX );
+Settings.LogFile = [pwd '/' Sim_Path '/openEMS.log'];
+Settings.Silent = SILENT;
+RunOpenEMS( Sim_Path, 'nf2ff_kernel.xml', openEMS_options, Settings );
+
+% all frequencies at once
+result = CalcNF2FF( nf2ff, Sim_Path, freq, theta, phi, 'Mode', 1 );
+
+pass = 1;
+for n=1:numel(freq)
+    % a single frequency, analysed in its own pass
+    ref = CalcNF2FF( nf2ff, Sim_Path, freq(n), theta, phi, 'Mode', 1, 'Outfile', ['nf2ff_f' num2str(n) '.h5'] );
+    max_val = max( abs([ref.E_theta{1}(:); ref.E_phi{1}(:)]) );
+    deviation = max( abs([ref.E_theta{1}(:) - result.E_theta{n}(:); ref.E_phi{1}(:) - result.E_phi{n}(:)]) );
+    if deviation > 1e-5*max_val
+        disp( ['the far-field at ' num2str(freq(n)/1e9) ' GHz deviates by ' num2str(deviation/max_val) ' (relative)'] );
+        pass = 0;
+    end
+    if abs(ref.Prad(1) - result.Prad(n)) > 1e-5*abs(ref.Prad(1))
+        disp( ['the radiated power at ' num2str(freq(n)/1e9) ' GHz deviates'] );
+        pass = 0;
+    end
+end
+
+if pass
+    disp( 'featuretests/nf2ff_kernel.m (chunked nf2ff of many frequencies):  pass' );
+else
+    disp( 'featuretests/nf2ff_kernel.m (chunked nf2ff of many frequencies):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
@@ -0,0 +1,46 @@
+function pass = numa( openEMS_options, options )
+%pass = numa( openEMS_options, options )
+%
+% Checks, if the NUMA placement (thread pinning and moving the x-slab data) of the multithreaded engine preserves the results
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+% clean openEMS_options
+openEMS_options = regexprep( openEMS_options, '--engine=\w+', '' );
+
+Sim_Path = 'tmp_numa';
+
+setup = struct();
+ref = featuretest_sim( Sim_Path, ['--engine=multithreaded --numThreads=3 ' openEMS_options], setup, SILENT );
+result = featuretest_sim( Sim_Path, ['--engine=multithreaded --numThreads=3 --numa ' openEMS_options], setup, SILENT );
+pass = 1;
+if isempty( strfind( result.log, 'NUMA placement' ) )
+    disp( 'the NUMA placement was not enabled' );
+    pass = 0;
+end
+pass = pass && featuretest_compare( ref, result, 0, 'numa', SILENT );
+
+if pass
+    disp( 'featuretests/numa.m (thread placement):  pass' );
+else
+    disp( 'featuretests/numa.m (thread placement):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
@@ -0,0 +1,73 @@
+function pass = operator_cache( openEMS_options, options )
+%pass = operator_cache( openEMS_options, options )
+%
+% Checks, if an operator read from the operator cache gives results identical to a freshly calculated operator,
+% if a cached operator is reused after changing the excitations only and if a changed material invalidates the cache
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+
+Sim_Path = 'tmp_operator_cache';
+% the simulation folder is recreated for every run, keep the cache outside
+Cache_Path = [pwd '/tmp_operator_cache_store'];
+[status,message,messageid] = rmdir(Cache_Path,'s');
+[status,message,messageid] = mkdir(Cache_Path);
+cache_option = ['--operatorCache=' Cache_Path ' ' openEMS_options];
+
+pass = 1;
+ref = featuretest_sim( Sim_Path, openEMS_options, struct(), SILENT );
+result = featuretest_sim( Sim_Path, cache_option, struct(), SILENT );
+if isempty( strfind( result.log, 'Operator written to cache' ) )
+    disp( 'the operator was not written to the cache' );
+    pass = 0;
+end
+result = featuretest_sim( Sim_Path, cache_option, struct(), SILENT );
+if isempty( strfind( result.log, 'Using cached operator' ) )
+    disp( 'the cached operator was not used' );
+    pass = 0;
+end
+pass = pass && featuretest_compare( ref, result, 0, 'operator cache', SILENT );
+
+% an additional (plane wave) excitation does not change the cached operator
+setup.tfsf = 1;
+ref = featuretest_sim( Sim_Path, openEMS_options, setup, SILENT );
+result = featuretest_sim( Sim_Path, cache_option, setup, SILENT );
+if isempty( strfind( result.log, 'Using cached operator' ) )
+    disp( 'the cached operator was not used after adding an excitation' );
+    pass = 0;
+end
+pass = pass && featuretest_compare( ref, result, 0, 'operator cache, changed excitation', SILENT );
+
+% an additional material needs a new operator
+setup.lorentz = 1;
+result = featuretest_sim( Sim_Path, cache_option, setup, SILENT );
+if ~isempty( strfind( result.log, 'Using cached operator' ) )
+    disp( 'the cached operator was used after changing the materials' );
+    pass = 0;
+end
+
+if pass
+    disp( 'featuretests/operator_cache.m (operator cache):  pass' );
+else
+    disp( 'featuretests/operator_cache.m (operator cache):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+    rmdir( Cache_Path, 's' );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
@@ -0,0 +1,54 @@
+function pass = parallel_setup( openEMS_options, options )
+%pass = parallel_setup( openEMS_options, options )
+%
+% Checks, if the operator setup with several threads (operator coefficients, timestep, PEC, compression and
+% lorentz material extension) gives results identical to the setup with a single thread
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+% clean openEMS_options
+openEMS_options = regexprep( openEMS_options, '--engine=\w+', '' );
+
+Sim_Path = 'tmp_parallel_setup';
+
+setup.lorentz = 1;
+setup.tfsf = 1;
+setup.tiles = 3;
+ref = featuretest_sim( Sim_Path, ['--engine=multithreaded --numThreads=1 ' openEMS_options], setup, SILENT );
+
+threads = {'3','4'};
+pass = 1;
+for n=1:numel(threads)
+    result = featuretest_sim( Sim_Path, ['--engine=multithreaded --numThreads=' threads{n} ' -v ' openEMS_options], setup, SILENT );
+    % make sure the setup stages did run with all threads
+    if isempty( strfind( result.log, ['Setup time per stage (' threads{n} ' threads)'] ) )
+        disp( ['the operator setup did not use ' threads{n} ' threads'] );
+        pass = 0;
+    end
+    pass = pass && featuretest_compare( ref, result, 0, ['parallel setup, ' threads{n} ' threads'], SILENT );
+end
+
+if pass
+    disp( 'featuretests/parallel_setup.m (operator setup):  pass' );
+else
+    disp( 'featuretests/parallel_setup.m (operator setup):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
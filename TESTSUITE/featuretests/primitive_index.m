@@ -0,0 +1,48 @@
+function pass = primitive_index( openEMS_options, options )
+%pass = primitive_index( openEMS_options, options )
+%
+% Checks, if the primitive index of the operator setup finds all primitives in priority order,
+% a dielectric block and a PEC plate built from many small primitives have to give results identical to single primitives
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+
+Sim_Path = 'tmp_primitive_index';
+
+% the higher priority dielectric and drude blocks overlap the tiled block
+setup.lorentz = 1;
+setup.tiles = 1;
+ref = featuretest_sim( Sim_Path, openEMS_options, setup, SILENT );
+
+tiles = [3 7];
+pass = 1;
+for n=1:numel(tiles)
+    setup.tiles = tiles(n);
+    result = featuretest_sim( Sim_Path, openEMS_options, setup, SILENT );
+    pass = pass && featuretest_compare( ref, result, 0, ['primitive index, ' num2str(tiles(n)^3) ' tiles'], SILENT );
+end
+
+if pass
+    disp( 'featuretests/primitive_index.m (tiled primitives):  pass' );
+else
+    disp( 'featuretests/primitive_index.m (tiled primitives):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
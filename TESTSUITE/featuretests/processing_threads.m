@@ -0,0 +1,52 @@
+function pass = processing_threads( openEMS_options, options )
+%pass = processing_threads( openEMS_options, options )
+%
+% Checks, if the field dumps and batched probes processed by the persistent worker threads
+% match the processing of a single thread
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+% clean openEMS_options
+openEMS_options = regexprep( openEMS_options, '--engine=\w+', '' );
+
+Sim_Path = 'tmp_processing_threads';
+
+% enough cells to split the field dumps over 4 threads
+setup.mesh.x = linspace(0,5e-2,41);
+setup.mesh.y = linspace(0,2e-2,21);
+setup.mesh.z = linspace(0,6e-2,41);
+setup.fd_freq = linspace( 1e9, 10e9, 10 );
+ref = featuretest_sim( Sim_Path, ['--engine=multithreaded --numThreads=1 ' openEMS_options], setup, SILENT );
+
+% the field values of each cell are independent of the thread splitting
+result = featuretest_sim( Sim_Path, ['--engine=multithreaded --numThreads=4 ' openEMS_options], setup, SILENT );
+pass = featuretest_compare( ref, result, 0, 'field dumps with 4 threads', SILENT );
+
+% the batched probes sum up the field values in a different order
+result = featuretest_sim( Sim_Path, ['--engine=multithreaded --numThreads=4 --batchProbes ' openEMS_options], setup, SILENT );
+pass = pass && featuretest_compare( ref, result, 1e-6, 'batched probes with 4 threads', SILENT );
+
+if pass
+    disp( 'featuretests/processing_threads.m (persistent processing threads):  pass' );
+else
+    disp( 'featuretests/processing_threads.m (persistent processing threads):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
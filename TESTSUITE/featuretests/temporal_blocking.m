@@ -0,0 +1,54 @@
+function pass = temporal_blocking( openEMS_options, options )
+%pass = temporal_blocking( openEMS_options, options )
+%
+% Checks, if the temporal blocking of the multithreaded engine produces results identical to the default multithreaded engine,
+% including the Mur-ABC and UPML boundaries at either side of the x-direction
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+% clean openEMS_options
+openEMS_options = regexprep( openEMS_options, '--engine=\w+', '' );
+
+Sim_Path = 'tmp_temporal_blocking';
+
+BCs = { {'MUR' 'PML_8' 'PMC' 'PEC' 'MUR' 'PEC'}, {'PML_8' 'MUR' 'MUR' 'PEC' 'PEC' 'PML_8'} };
+pass = 1;
+for m=1:numel(BCs)
+    setup.BC = BCs{m};
+    ref = featuretest_sim( Sim_Path, ['--engine=multithreaded --numThreads=3 ' openEMS_options], setup, SILENT );
+    blocks = {'2','5'};
+    for n=1:numel(blocks)
+        result = featuretest_sim( Sim_Path, ['--engine=multithreaded --numThreads=3 --temporalBlocking=' blocks{n} ' ' openEMS_options], setup, SILENT );
+        % make sure the engine did not fall back to the default update
+        if isempty( strfind( result.log, 'using temporal blocking' ) )
+            disp( ['temporal blocking with ' blocks{n} ' timesteps was not enabled for boundary setup ' num2str(m)] );
+            pass = 0;
+        end
+        pass = pass && featuretest_compare( ref, result, 0, ['temporal blocking ' blocks{n} ', boundary setup ' num2str(m)], SILENT );
+    end
+end
+
+if pass
+    disp( 'featuretests/temporal_blocking.m (mur and upml):  pass' );
+else
+    disp( 'featuretests/temporal_blocking.m (mur and upml):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
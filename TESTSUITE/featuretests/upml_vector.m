@@ -0,0 +1,51 @@
+function pass = upml_vector( openEMS_options, options )
+%pass = upml_vector( openEMS_options, options )
+%
+% Checks, if the upml updated by the sse engines (in the vector layout and per z-line) matches the basic engine
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+% clean openEMS_options
+openEMS_options = regexprep( openEMS_options, '--engine=\w+', '' );
+
+Sim_Path = 'tmp_upml_vector';
+
+% the pml in x- and y-direction covers all z-lines and is updated in the vector layout of the sse engines,
+% the pml in z-direction is updated per z-line
+setup.BC = {'PML_8' 'PML_8' 'PML_8' 'PML_8' 'PML_8' 'PML_8'};
+setup.mesh.x = linspace(0,5e-2,27);
+setup.mesh.y = linspace(0,4e-2,23);
+setup.mesh.z = linspace(0,6e-2,35);
+
+ref = featuretest_sim( Sim_Path, ['--engine=basic ' openEMS_options], setup, SILENT );
+pass = 1;
+engines = {'sse', 'sse-compressed', 'multithreaded'};
+for n=1:numel(engines)
+    result = featuretest_sim( Sim_Path, ['--engine=' engines{n} ' ' openEMS_options], setup, SILENT );
+    pass = pass && featuretest_compare( ref, result, 1e-6, ['upml with engine ' engines{n}], SILENT );
+end
+
+if pass
+    disp( 'featuretests/upml_vector.m (vectorised upml):  pass' );
+else
+    disp( 'featuretests/upml_vector.m (vectorised upml):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
@@ -0,0 +1,49 @@
+function pass = vector_width( openEMS_options, options )
+%pass = vector_width( openEMS_options, options )
+%
+% Checks, if the AVX and AVX-512 kernels of the compressed engine produce results identical to the sse kernels
+
+CLEANUP = 1;        % if enabled and result is PASS, remove simulation folder
+STOP_IF_FAILED = 1; % if enabled and result is FAILED, stop with error
+SILENT = 0;         % 0=show openEMS output
+
+if nargin < 1
+    openEMS_options = '';
+end
+if nargin < 2
+    options = '';
+end
+if any(strcmp( options, 'run_testsuite' ))
+    STOP_IF_FAILED = 0;
+    SILENT = 1;
+end
+% clean openEMS_options
+openEMS_options = regexprep( openEMS_options, '--engine=\w+', '' );
+
+Sim_Path = 'tmp_vector_width';
+
+% long z-lines to use the wide kernels
+setup.mesh.x = linspace(0,5e-2,17);
+setup.mesh.y = linspace(0,2e-2,9);
+setup.mesh.z = linspace(0,6e-2,71);
+
+ref = featuretest_sim( Sim_Path, ['--engine=sse-compressed --maxVectorWidth=4 ' openEMS_options], setup, SILENT );
+pass = 1;
+widths = {'8','16'};
+for n=1:numel(widths)
+    result = featuretest_sim( Sim_Path, ['--engine=sse-compressed --maxVectorWidth=' widths{n} ' ' openEMS_options], setup, SILENT );
+    pass = pass && featuretest_compare( ref, result, 0, ['vector width ' widths{n}], SILENT );
+end
+
+if pass
+    disp( 'featuretests/vector_width.m (avx kernels):  pass' );
+else
+    disp( 'featuretests/vector_width.m (avx kernels):  * FAILED *' );
+end
+
+if pass && CLEANUP
+    rmdir( Sim_Path, 's' );
+end
+if ~pass && STOP_IF_FAILED
+    error 'test failed'
+end
@@ -0,0 +1,69 @@
+function pass = featuretest_compare( ref, result, rel_tol, name, SILENT )
+%pass = featuretest_compare( ref, result, rel_tol, name, SILENT )
+%
+% Compare the results of two featuretest_sim() runs.
+%
+% rel_tol: maximum deviation relative to the maximum absolute value of each field or probe,
+%          0 requires bitwise identical results
+% name:    name of the compared simulation, used for the error messages
+
+if nargin < 5
+    SILENT = 1;
+end
+
+pass = 0;
+
+% time and frequency domain field dumps
+fields = {'E','H','E_FD','H_FD'};
+for m=1:numel(fields)
+    if isempty(ref.(fields{m}))
+        continue
+    end
+    if isfield( ref.(fields{m}), 'TD' )
+        ref_values = ref.(fields{m}).TD.values;
+        values = result.(fields{m}).TD.values;
+    else
+        ref_values = ref.(fields{m}).FD.values;
+        values = result.(fields{m}).FD.values;
+    end
+    if numel(ref_values) ~= numel(values)
+        disp( ['compare error (' name '): number of dumps of ' fields{m} ' field: ' num2str(numel(values)) ' instead of ' num2str(numel(ref_values))] );
+        return
+    end
+    max_val = 0;
+    for o=1:numel(ref_values)
+        max_val = max( max_val, max(abs(ref_values{o}(:))) );
+    end
+    for o=1:numel(ref_values)
+        if ~isequal( size(ref_values{o}), size(values{o}) )
+            disp( ['compare error (' name '): size of ' fields{m} ' field dump ' num2str(o) ' differs'] );
+            return
+        end
+        deviation = max(abs(ref_values{o}(:) - values{o}(:)));
+        if deviation > rel_tol*max_val
+            disp( ['compare error (' name '): ' fields{m} ' field dump ' num2str(o) ' deviates by ' num2str(deviation/max_val) ' (relative)'] );
+            return
+        end
+    end
+end
+
+% probes
+for n=1:numel(ref.probes.TD)
+    ref_val = ref.probes.TD{n}.val;
+    val = result.probes.TD{n}.val;
+    if ~isequal( size(ref_val), size(val) ) || any( ref.probes.TD{n}.t ~= result.probes.TD{n}.t )
+        disp( ['compare error (' name '): time base of probe ' num2str(n) ' differs'] );
+        return
+    end
+    max_val = max(abs(ref_val(:)));
+    deviation = max(abs(ref_val(:) - val(:)));
+    if deviation > rel_tol*max_val
+        disp( ['compare error (' name '): probe ' num2str(n) ' deviates by ' num2str(deviation/max_val) ' (relative)'] );
+        return
+    end
+end
+
+if ~SILENT
+    disp( ['simulation "' name '" matches the reference'] );
+end
+pass = 1;
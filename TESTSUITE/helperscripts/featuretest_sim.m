@@ -0,0 +1,177 @@
+function result = featuretest_sim( Sim_Path, openEMS_options, setup, SILENT )
+%result = featuretest_sim( Sim_Path, openEMS_options, setup, SILENT )
+%
+% Simulate the partially filled box used by the feature regression tests and collect the results.
+%
+% setup: struct with the optional fields
+%   BC        boundary conditions (default: {'MUR' 'PML_8' 'PMC' 'PEC' 'PEC' 'PEC'})
+%   BC_options  cell array of additional SetBoundaryCond arguments, e.g. {'CPML_KappaMax', 5} (default: {})
+%   NrTS      number of timesteps (default: 400)
+%   mesh      mesh with the fields x, y and z (default: mesh of enginetests/cavity.m)
+%   lorentz   add a block of lorentz material (default: 0)
+%   tfsf      add a plane wave (total-field/scattered-field) excitation (default: 0)
+%   dumps     record the time domain E- and H-field of the full domain (default: 1)
+%   fd_freq   frequencies of the frequency domain E- and H-field dumps (default: [])
+%   oversampling  nyquist oversampling of the time domain dumps (default: [], openEMS default)
+%   tiles     add a low priority dielectric block and a PEC plate over most of the domain, each built from
+%             tiles^3 (tiles^2) primitives, e.g. to compare many small primitives to a single one (default: 0, none)
+%   mpi       run with MPI, struct with the fields NrProc, Binary (openEMS MPI binary) and
+%             split (cell array of SetupMPI arguments), field dumps are not supported (default: [])
+%   keep_files do not clear the simulation folder, e.g. to resume a simulation from a checkpoint (default: 0)
+%
+% result: E, H (time domain dumps), E_FD, H_FD (frequency domain dumps), probes (voltage, current, E- and H-field probe),
+%         log (openEMS output, e.g. to check if a feature was enabled)
+
+if nargin < 4
+    SILENT = 1;
+end
+physical_constants;
+
+defaults.BC = {'MUR' 'PML_8' 'PMC' 'PEC' 'PEC' 'PEC'};
+defaults.BC_options = {};
+defaults.NrTS = 400;
+defaults.mesh.x = linspace(0,5e-2,27);
+defaults.mesh.y = linspace(0,2e-2,11);
+defaults.mesh.z = linspace(0,6e-2,33);
+defaults.lorentz = 0;
+defaults.tfsf = 0;
+defaults.dumps = 1;
+defaults.fd_freq = [];
+defaults.oversampling = [];
+defaults.tiles = 0;
+defaults.mpi = [];
+defaults.keep_files = 0;
+names = fieldnames( defaults );
+for n=1:numel(names)
+    if ~isfield( setup, names{n} )
+        setup.(names{n}) = defaults.(names{n});
+    end
+end
+mesh = setup.mesh;
+
+f_start = 1e9;
+f_stop = 10e9;
+
+% prepare simulation dir
+if ~setup.keep_files
+    [status,message,messageid] = rmdir(Sim_Path,'s');
+end
+[status,message,messageid] = mkdir(Sim_Path);
+
+% setup FDTD parameter
+if isempty(setup.oversampling)
+    FDTD = InitFDTD( setup.NrTS, 0 );
+else
+    FDTD = InitFDTD( setup.NrTS, 0, 'OverSampling', setup.oversampling );
+end
+FDTD = SetGaussExcite(FDTD,(f_stop-f_start)/2,(f_stop-f_start)/2);
+FDTD = SetBoundaryCond(FDTD,setup.BC,setup.BC_options{:});
+if ~isempty(setup.mpi)
+    FDTD = SetupMPI(FDTD, setup.mpi.split{:});
+end
+
+% setup CSXCAD geometry
+CSX = InitCSX();
+CSX = DefineRectGrid(CSX, 1, mesh);
+
+% excitation
+CSX = AddExcitation(CSX,'excite1',0,[1 1 1]);
+p(1,1) = mesh.x(floor(end*2/3));
+p(2,1) = mesh.y(floor(end*2/3));
+p(3,1) = mesh.z(floor(end*2/3));
+p(1,2) = mesh.x(floor(end*2/3)+1);
+p(2,2) = mesh.y(floor(end*2/3)+1);
+p(3,2) = mesh.z(floor(end*2/3)+1);
+CSX = AddCurve( CSX, 'excite1', 0, p );
+if setup.tfsf
+    CSX = AddPlaneWaveExcite(CSX, 'plane_wave', [0 0 1], [1 0 0], (f_stop+f_start)/2);
+    start = [mesh.x(5) mesh.y(3) mesh.z(5)];
+    stop  = [mesh.x(end-4) mesh.y(end-2) mesh.z(end-4)];
+    CSX = AddBox(CSX, 'plane_wave', 0, start, stop);
+end
+
+% probes
+p(1,1) = mesh.x(floor(end*1/3));
+p(2,1) = mesh.y(floor(end*1/3));
+p(3,1) = mesh.z(floor(end*1/3));
+CSX = AddProbe( CSX, 'E_probe', 2 );
+CSX = AddPoint( CSX, 'E_probe', 0, p(:,1) );
+CSX = AddProbe( CSX, 'H_probe', 3 );
+CSX = AddPoint( CSX, 'H_probe', 0, p(:,1) );
+CSX = AddProbe( CSX, 'ut', 0 );
+CSX = AddBox( CSX, 'ut', 0, [mesh.x(4) mesh.y(4) mesh.z(4)], [mesh.x(4) mesh.y(8) mesh.z(4)] );
+CSX = AddProbe( CSX, 'it', 1 );
+CSX = AddBox( CSX, 'it', 0, [mesh.x(3) mesh.y(3) mesh.z(10)], [mesh.x(8) mesh.y(8) mesh.z(10)] );
+
+% material
+CSX = AddMaterial( CSX, 'RO4350B', 'Epsilon', 3.66 );
+start = [mesh.x(3) mesh.y(3) mesh.z(3)];
+stop  = [mesh.x(5) mesh.y(4) mesh.z(6)];
+CSX = AddBox( CSX, 'RO4350B', 100, start, stop );
+if setup.lorentz
+    CSX = AddLorentzMaterial( CSX, 'drude' );
+    CSX = SetMaterialProperty( CSX, 'drude', 'Epsilon', 2, 'EpsilonPlasmaFrequency', 5e9, 'EpsilonRelaxTime', 1e-9 );
+    start = [mesh.x(10) mesh.y(2) mesh.z(15)];
+    stop  = [mesh.x(14) mesh.y(6) mesh.z(20)];
+    CSX = AddBox( CSX, 'drude', 100, start, stop );
+end
+if setup.tiles>0
+    % the tile borders are not aligned with the mesh, neighbouring tiles share the same border coordinates
+    CSX = AddMaterial( CSX, 'tiled_block', 'Epsilon', 1.5, 'Kappa', 0.01 );
+    CSX = AddMetal( CSX, 'tiled_plate' );
+    x = linspace( (mesh.x(2)+mesh.x(3))/2, (mesh.x(end-2)+mesh.x(end-1))/2, setup.tiles+1 );
+    y = linspace( (mesh.y(1)+mesh.y(2))/2, (mesh.y(end-1)+mesh.y(end))/2, setup.tiles+1 );
+    z = linspace( (mesh.z(2)+mesh.z(3))/2, mesh.z(end-6), setup.tiles+1 );
+    for i=1:setup.tiles
+        for j=1:setup.tiles
+            for k=1:setup.tiles
+                CSX = AddBox( CSX, 'tiled_block', 10, [x(i) y(j) z(k)], [x(i+1) y(j+1) z(k+1)] );
+            end
+            CSX = AddBox( CSX, 'tiled_plate', 10, [x(i) y(j) mesh.z(end-4)], [x(i+1) y(j+1) mesh.z(end-4)] );
+        end
+    end
+end
+
+% dumps
+pos1 = [mesh.x(1) mesh.y(1) mesh.z(1)];
+pos2 = [mesh.x(end) mesh.y(end) mesh.z(end)];
+if setup.dumps
+    CSX = AddDump( CSX, 'Et', 'DumpType', 0, 'DumpMode', 0, 'FileType', 1 ); % hdf5 E-field dump without interpolation
+    CSX = AddBox( CSX, 'Et', 0, pos1, pos2 );
+    CSX = AddDump( CSX, 'Ht', 'DumpType', 1, 'DumpMode', 0, 'FileType', 1 ); % hdf5 H-field dump without interpolation
+    CSX = AddBox( CSX, 'Ht', 0, pos1, pos2 );
+end
+if ~isempty(setup.fd_freq)
+    CSX = AddDump( CSX, 'Ef', 'DumpType', 10, 'DumpMode', 0, 'FileType', 1, 'Frequency', setup.fd_freq );
+    CSX = AddBox( CSX, 'Ef', 0, pos1, pos2 );
+    CSX = AddDump( CSX, 'Hf', 'DumpType', 11, 'DumpMode', 0, 'FileType', 1, 'Frequency', setup.fd_freq );
+    CSX = AddBox( CSX, 'Hf', 0, pos1, pos2 );
+end
+
+% Write openEMS compatible xml-file
+WriteOpenEMS( [Sim_Path '/featuretest.xml'], FDTD, CSX );
+
+% run openEMS
+Settings.LogFile = [pwd '/' Sim_Path '/openEMS.log'];
+Settings.Silent = SILENT;
+if ~isempty(setup.mpi)
+    Settings.MPI.NrProc = setup.mpi.NrProc;
+    Settings.MPI.Binary = setup.mpi.Binary;
+end
+RunOpenEMS( Sim_Path, 'featuretest.xml', openEMS_options, Settings );
+
+% collect result
+result.log = fileread( Settings.LogFile );
+result.E = [];
+result.H = [];
+if setup.dumps
+    result.E = ReadHDF5FieldData( [Sim_Path '/Et.h5'] );
+    result.H = ReadHDF5FieldData( [Sim_Path '/Ht.h5'] );
+end
+result.E_FD = [];
+result.H_FD = [];
+if ~isempty(setup.fd_freq)
+    result.E_FD = ReadHDF5FieldData( [Sim_Path '/Ef.h5'] );
+    result.H_FD = ReadHDF5FieldData( [Sim_Path '/Hf.h5'] );
+end
+result.probes = ReadUI( {'E_probe','H_probe','ut','it'}, Sim_Path );
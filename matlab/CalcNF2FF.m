@@ -28,6 +28,8 @@ function nf2ff = CalcNF2FF(nf2ff, Sim_Path, freq, theta, phi, varargin)
 % 'Radius':  specify the radius for the nf2ff
 % 'Eps_r':   specify the relative electric permittivity for the nf2ff
 % 'Mue_r':   specify the relative magnetic permeability for the nf2ff
+% 'Accuracy': enable the fast far-field aggregation with the given relative
+%            accuracy, e.g. 1e-3 (default: 0, direct calculation)
 %
 % 'Mirror':  Add mirroring in a given direction (dir), with a given 
 %            mirror type (PEC or PMC) and a mirror position in the given
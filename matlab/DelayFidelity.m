@@ -52,8 +52,8 @@ for n=1:2:numel(varargin)
 end
 
 
-port_ut = load(fullfile(path, port.U_filename));
-port_it = load(fullfile(path, port.I_filename));
+port_ut = ReadProbeData(fullfile(path, port.U_filename));
+port_it = ReadProbeData(fullfile(path, port.I_filename));
 dt = port_ut(2,1) - port_ut(1,1);
 fftsize = 2^(nextpow2(size(port_ut)(1)) + 1);
 df = 1 / (dt * fftsize);
@@ -0,0 +1,43 @@
+function data = ReadProbeData(file)
+% function data = ReadProbeData(file)
+%
+% read a probe file (e.g. voltage or current) written by openEMS
+%
+% The binary probe format (see openEMS option --binaryProbes) is read
+% directly, ASCII probe files are loaded as text.
+%
+% returns one row per sample, time or frequency in the first column
+%
+% example:
+% tmp = ReadProbeData( 'tmp/port_ut1' );
+% plot( tmp(:,1), tmp(:,2) );
+%
+% openEMS matlab interface
+% -----------------------
+%
+% See also ReadUI
+
+fid = fopen( file, 'r', 'ieee-le' );
+if (fid<0)
+    error('openEMS:ReadProbeData',['cannot open file "' file '"']);
+end
+magic = fread( fid, [1 8], '*uint8' );
+if (numel(magic)<8) || ~strcmp( char(magic), ['OEMSPRB' char(0)] )
+    fclose( fid );
+    data = load( file );
+    return
+end
+
+version = fread( fid, 1, 'uint32' );
+numColumns = fread( fid, 1, 'uint32' );
+dataOffset = fread( fid, 1, 'uint64' );
+if (version~=1)
+    fclose( fid );
+    error('openEMS:ReadProbeData',['unsupported binary probe version of file "' file '"']);
+end
+fseek( fid, dataOffset, 'bof' );
+data = fread( fid, [numColumns inf], 'double' );
+fclose( fid );
+
+% ignore an incomplete last sample of a running simulation
+data = data(:,1:floor(numel(data)/numColumns))';
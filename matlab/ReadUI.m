@@ -29,7 +29,7 @@ function UI = ReadUI(files, path, freq, varargin)
 % -----------------------
 % author: Thorsten Liebig
 %
-% See also DFT_time2freq, AR_estimate
+% See also DFT_time2freq, AR_estimate, ReadProbeData
 
 if (nargin<2)
     path ='';
@@ -61,7 +61,7 @@ end
 UI.TD = {};
 UI.FD = {};
 for n=1:numel(filenames)
-    tmp = load( fullfile(path,filenames{n}) );
+    tmp = ReadProbeData( fullfile(path,filenames{n}) );
     t = tmp(:,1)';
     val = tmp(:,2)';
     
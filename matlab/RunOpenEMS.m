@@ -25,12 +25,28 @@ function RunOpenEMS(Sim_Path, Sim_File, opts, Settings)
 %             --engine=MPI             engine using compressed operator + sse vector extensions + MPI parallel processing
 %             --engine=multithreaded   engine using compressed operator + sse vector extensions + MPI + multithreading
 %         --numThreads=<n>     Force use n threads for multithreaded engine
+%         --temporalBlocking=<n> Advance n timesteps per sweep through the mesh for better cache usage
+%         --neighbourSync      Synchronize the engine threads with their neighbours only
+%         --fusedUpdates       Apply boundary conditions and excitations plane by plane within the engine sweep
+%         --fullBarriers       Synchronize the engine threads before every extension update, without eliding barriers
+%         --hugePages[=thp|hugetlb] Back the large field and operator arrays with huge pages
+%         --halfPrecision=<fp16|bf16> Store the fields as 16 bit floats, computing in single precision (multithreaded engine)
+%         --validateHalfPrecision Compare the half precision engine with a single precision engine
+%         --operatorCache=<dir> Store the operator in <dir> and reuse it for identical geometry, mesh and settings
+%         --compressionTolerance=<tol> Merge operator coefficients differing by less than the relative tolerance <tol>
+%         --checkpoint[=<n>]   Write a checkpoint on SIGTERM/SIGINT and every n timesteps
+%         --checkpointFile=<file> Write the checkpoints to <file>
+%         --restart            Resume the simulation from the last checkpoint
+%         --numa               Pin the engine threads and place their data on the local NUMA node
 %         --no-simulation      only run preprocessing; do not simulate
 %         --dump-statistics    dump simulation statistics to 'openEMS_run_stats.txt' and 'openEMS_stats.txt'
 %
 %          Additional global arguments
 %         --showProbeDiscretization    Show probe discretization information
 %         --nativeFieldDumps           Dump all fields using the native field components
+%         --fieldDumpQueue=<n>         Buffer n time domain field dumps for the background writer (0: synchronous)
+%         --fieldDumpQueueMemory=<n>   Limit the buffered field dumps of each dump box to n MiB (default 1024)
+%         --maxVectorWidth=<4|8|16>    Limit the vector width of the engine kernels
 %         -v,-vv,-vvv                  Set debug level: 1 to 3
 %
 %
@@ -8,6 +8,8 @@ function FDTD = SetBoundaryCond(FDTD, BC, varargin)
 %   1 = PMC      or  'PMC'
 %   2 = MUR-ABC  or  'MUR'
 %   3 = PML-ABC  or  'PML_x' with pml size x => 4..50
+%   4 = CPML-ABC or  'CPML_x' with pml size x => 4..50
+%       (convolutional pml, same grading as the PML-ABC but less memory)
 % 
 % example:
 % BC = [ 1     1     0     0     2     3     ]  %using numbers or
@@ -28,11 +30,21 @@ function FDTD = SetBoundaryCond(FDTD, BC, varargin)
 % 			W  = width (length) of the pml in meter
 % 			N  = number of cells for the pml
 % 			Z  = wave impedance at the current depth and position
+%
+% cpml definitions (in addition to the pml grading)
+% 	arguments:  'CPML_KappaMax',kappa_max
+% 		Maximum coordinate stretching at the outer boundary (default 1),
+% 		graded like the conductivity.
+% 	arguments:  'CPML_AlphaMax',alpha_max
+% 		Complex frequency shift in S/m at the interface to the inner domain
+% 		(default 0), decreasing linearly to 0 at the outer boundary.
 % 
 % example: 
 % FDTD = SetBoundaryCond(FDTD,BC); 
 % or
 % FDTD = SetBoundaryCond(FDTD,BC,'PML_Grading','-log(1e-6)*log(2.5)/(2*dl*pow(2.5,W/dl)-1) * pow(2.5, D/dl) / Z');
+% or
+% FDTD = SetBoundaryCond(FDTD,{'CPML_8' 'CPML_8' 'CPML_8' 'CPML_8' 'CPML_8' 'CPML_8'},'CPML_KappaMax',5,'CPML_AlphaMax',0.05);
 %
 % 
 % openEMS matlab interface
@@ -5,6 +5,11 @@ function FDTD = SetupMPI(FDTD, varargin)
 % % and split the FDTD mesh in 3 parts in z-direction, split at z=-500 and z=500
 % % this will need a Settings.MPI.NrProc of 2*3=6
 % FDTD = SetupMPI(FDTD,'SplitN_X',2 ,'SplitPos_Z', '-500,500');
+%
+% % example, let openEMS choose the process grid and split positions for
+% % any number of processes, balancing the estimated cost of pml,
+% % dispersive materials, excitations and probes (default if no split is given)
+% FDTD = SetupMPI(FDTD,'AutoSplit',1);
 % 
 % See also RunOpenEMS_MPI
 % 
@@ -0,0 +1,73 @@
+function FDTD = SetupNF2FF(FDTD, nf2ff, freq, theta, phi, varargin)
+% function FDTD = SetupNF2FF(FDTD, nf2ff, freq, theta, phi, varargin)
+%
+% Run the near-field to far-field transformation of a nf2ff box inside
+% openEMS at the end of the simulation. The fields of the nf2ff box are
+% recorded in memory at the given frequencies, only the far-field result is
+% written to the simulation path. Not supported by the MPI engine.
+%
+% parameter:
+% nf2ff:    data structure created by CreateNF2FFBox
+% freq:     array of frequencies to analyse
+% theta,phi: spherical coordinates to evaluate the far-field on (in radians)
+%
+% optional paramater:
+% 'Center', 'Outfile', 'Verbose', 'Radius', 'Eps_r', 'Mue_r', 'Accuracy'
+% and 'Mirror', see CalcNF2FF
+%
+% example:
+% [CSX nf2ff] = CreateNF2FFBox(CSX, 'nf2ff', start, stop);
+% FDTD = SetupNF2FF(FDTD, nf2ff, f0, theta, phi, 'Center', [0 0 0]);
+% WriteOpenEMS([Sim_Path '/' Sim_CSX], FDTD, CSX);
+% RunOpenEMS(Sim_Path, Sim_CSX);
+% % read the result of the simulation
+% nf2ff = CalcNF2FF(nf2ff, Sim_Path, f0, theta, phi, 'Mode', 2);
+%
+% See also: CreateNF2FFBox, CalcNF2FF
+%
+% openEMS matlab interface
+% -----------------------
+% author: openEMS contributors, 2026
+
+nf2ff_xml.ATTRIBUTE.Outfile = [nf2ff.name '.h5'];
+
+if (isfield(nf2ff,'Eps_r'))
+    nf2ff_xml.ATTRIBUTE.Eps_r = nf2ff.Eps_r;
+end
+if (isfield(nf2ff,'Mue_r'))
+    nf2ff_xml.ATTRIBUTE.Mue_r = nf2ff.Mue_r;
+end
+
+for n=1:2:numel(varargin)-1
+    if (strcmp(varargin{n},'Mirror'))
+        if isfield(nf2ff_xml,'Mirror')
+            pos = length(nf2ff_xml.Mirror)+1;
+        else
+            pos = 1;
+        end
+        nf2ff_xml.Mirror{pos}.ATTRIBUTE.Dir=varargin{n+1}{1};
+        nf2ff_xml.Mirror{pos}.ATTRIBUTE.Type=varargin{n+1}{2};
+        nf2ff_xml.Mirror{pos}.ATTRIBUTE.Pos=varargin{n+1}{3};
+    else
+        nf2ff_xml.ATTRIBUTE.(varargin{n})=varargin{n+1};
+    end
+end
+
+% the planes refer to the names of the E- and H-field dump boxes
+nf2ff_xml.Planes = {};
+for n=1:numel(nf2ff.filenames_E)
+    if (nf2ff.directions(n)~=0)
+        nf2ff_xml.Planes{end+1}.ATTRIBUTE.E_Field = nf2ff.filenames_E{n};
+        nf2ff_xml.Planes{end}.ATTRIBUTE.H_Field = nf2ff.filenames_H{n};
+    end
+end
+
+nf2ff_xml.ATTRIBUTE.freq = freq;
+nf2ff_xml.theta = theta;
+nf2ff_xml.phi = phi;
+
+if isfield(FDTD,'NF2FF')
+    FDTD.NF2FF{end+1} = nf2ff_xml;
+else
+    FDTD.NF2FF = {nf2ff_xml};
+end
@@ -34,6 +34,11 @@
 //external libs
 #include "tinyxml.h"
 
+//! maximum number of frequencies read from a FD dump and analysed in a single pass
+#define NF2FF_FREQ_CHUNK 32
+//! maximum memory (in bytes) of the FD data of all frequencies of a single pass
+#define NF2FF_FREQ_CHUNK_MEMORY (512*1024*1024)
+
 using namespace std;
 
 nf2ff::nf2ff(vector<float> freq, vector<float> theta, vector<float> phi, vector<float> center, unsigned int numThreads)
@@ -133,6 +138,14 @@ void nf2ff::SetMirror(int type, int dir, float pos)
 		m_nf2ff.at(fn)->SetMirror(type, dir, pos);
 }
 
+void nf2ff::SetAccuracy(float accuracy)
+{
+	if (m_Verbose>0)
+		cerr << "Enable fast far-field aggregation with an accuracy of: " << accuracy << endl;
+	for (size_t fn=0;fn<m_nf2ff.size();++fn)
+		m_nf2ff.at(fn)->SetAccuracy(accuracy);
+}
+
 
 double nf2ff::GetTotalRadPower(size_t f_idx) const
 {
@@ -159,10 +172,59 @@ double** nf2ff::GetRadPower(size_t f_idx) const
 	return m_nf2ff.at(f_idx)->GetRadPower();
 }
 
-bool nf2ff::AnalyseXMLNode(TiXmlElement* ti_nf2ff)
+bool nf2ff::AddPlane(size_t f_idx, float **lines, unsigned int* numLines, complex<float>**** E_field, complex<float>**** H_field, int MeshType)
 {
-	if (ti_nf2ff==NULL)
+	if (f_idx>=m_nf2ff.size())
+	{
+		cerr << "nf2ff::AddPlane: Error, invalid frequency index " << f_idx << endl;
 		return false;
+	}
+	return m_nf2ff.at(f_idx)->AddPlane(lines, numLines, E_field, H_field, MeshType);
+}
+
+bool nf2ff::AddPlane(float **lines, unsigned int* numLines, vector<complex<float>****> E_fields, vector<complex<float>****> H_fields, int MeshType)
+{
+	if ((E_fields.size()!=m_nf2ff.size()) || (H_fields.size()!=m_nf2ff.size()))
+	{
+		cerr << "nf2ff::AddPlane: Error, number of fields and frequencies don't agree" << endl;
+		for (size_t fn=0;fn<E_fields.size();++fn)
+			Delete_N_3DArray<complex<float> >(E_fields.at(fn),numLines);
+		for (size_t fn=0;fn<H_fields.size();++fn)
+			Delete_N_3DArray<complex<float> >(H_fields.at(fn),numLines);
+		return false;
+	}
+	return AddPlaneChunk(0, lines, numLines, E_fields, H_fields, MeshType);
+}
+
+bool nf2ff::AddPlaneChunk(size_t f_start, float **lines, unsigned int* numLines, vector<complex<float>****> E_fields, vector<complex<float>****> H_fields, int MeshType)
+{
+	size_t f_stop = f_start + E_fields.size();
+	if ((f_stop>m_nf2ff.size()) || (H_fields.size()!=E_fields.size()))
+	{
+		cerr << "nf2ff::AddPlaneChunk: Error, number of fields and frequencies don't agree" << endl;
+		for (size_t fn=0;fn<E_fields.size();++fn)
+			Delete_N_3DArray<complex<float> >(E_fields.at(fn),numLines);
+		for (size_t fn=0;fn<H_fields.size();++fn)
+			Delete_N_3DArray<complex<float> >(H_fields.at(fn),numLines);
+		return false;
+	}
+	if (m_Verbose>1)
+		cerr << "nf2ff: Adding plane for " << E_fields.size() << " frequencies in a single pass ...";
+	vector<nf2ff_calc*> nf_calc(m_nf2ff.begin()+f_start, m_nf2ff.begin()+f_stop);
+	bool ok = nf2ff_calc::AddPlane(nf_calc, lines, numLines, E_fields, H_fields, MeshType);
+	if (m_Verbose>1)
+		cerr << " done." << endl;
+	if (m_Verbose>0)
+		for (size_t fn=f_start;fn<f_stop;++fn)
+			if (m_nf2ff.at(fn)->GetAccuracy()>0)
+				cerr << "nf2ff: Max. deviation of the fast far-field at f=" << m_freq.at(fn) << "Hz: " << m_nf2ff.at(fn)->GetMaxDeviation() << endl;
+	return ok;
+}
+
+nf2ff* nf2ff::ParseXMLNode(TiXmlElement* ti_nf2ff, string &outfile)
+{
+	if (ti_nf2ff==NULL)
+		return NULL;
 
 	unsigned int numThreads=0;
 	int ihelp=0;
@@ -181,8 +243,8 @@ bool nf2ff::AnalyseXMLNode(TiXmlElement* ti_nf2ff)
 	attr = ti_nf2ff->Attribute("freq");
 	if (attr==NULL)
 	{
-		cerr << "nf2ff::AnalyseXMLNode: Can't read frequency inforamtions ... " << endl;
-		return false;
+		cerr << "nf2ff::ParseXMLNode: Can't read frequency inforamtions ... " << endl;
+		return NULL;
 	}
 	vector<float> freq = SplitString2Float(attr);
 
@@ -194,53 +256,53 @@ bool nf2ff::AnalyseXMLNode(TiXmlElement* ti_nf2ff)
 	attr = ti_nf2ff->Attribute("Outfile");
 	if (attr==NULL)
 	{
-		cerr << "nf2ff::AnalyseXMLNode: Can't read frequency inforamtions ... " << endl;
-		return false;
+		cerr << "nf2ff::ParseXMLNode: Can't read frequency inforamtions ... " << endl;
+		return NULL;
 	}
-	string outfile = string(attr);
+	outfile = string(attr);
 	if (outfile.empty())
 	{
-		cerr << "nf2ff::AnalyseXMLNode: outfile is empty, skipping nf2ff... " << endl;
-		return false;
+		cerr << "nf2ff::ParseXMLNode: outfile is empty, skipping nf2ff... " << endl;
+		return NULL;
 	}
 
 	TiXmlElement* ti_theta = ti_nf2ff->FirstChildElement("theta");
 	if (ti_theta==NULL)
 	{
-		cerr << "nf2ff::AnalyseXMLNode: Can't read theta values ... " << endl;
-		return false;
+		cerr << "nf2ff::ParseXMLNode: Can't read theta values ... " << endl;
+		return NULL;
 	}
 	TiXmlNode* ti_theta_node = ti_theta->FirstChild();
 	if (ti_theta_node==NULL)
 	{
-		cerr << "nf2ff::AnalyseXMLNode: Can't read theta text child ... " << endl;
-		return false;
+		cerr << "nf2ff::ParseXMLNode: Can't read theta text child ... " << endl;
+		return NULL;
 	}
 	TiXmlText* ti_theta_text = ti_theta_node->ToText();
 	if (ti_theta_text==NULL)
 	{
-		cerr << "nf2ff::AnalyseXMLNode: Can't read theta text values ... " << endl;
-		return false;
+		cerr << "nf2ff::ParseXMLNode: Can't read theta text values ... " << endl;
+		return NULL;
 	}
 	vector<float> theta = SplitString2Float(ti_theta_text->Value());
 
 	TiXmlElement* ti_phi = ti_nf2ff->FirstChildElement("phi");
 	if (ti_phi==NULL)
 	{
-		cerr << "nf2ff::AnalyseXMLNode: Can't read phi values ... " << endl;
-		return false;
+		cerr << "nf2ff::ParseXMLNode: Can't read phi values ... " << endl;
+		return NULL;
 	}
 	TiXmlNode* ti_phi_node = ti_phi->FirstChild();
 	if (ti_phi_node==NULL)
 	{
-		cerr << "nf2ff::AnalyseXMLNode: Can't read phi text child ... " << endl;
-		return false;
+		cerr << "nf2ff::ParseXMLNode: Can't read phi text child ... " << endl;
+		return NULL;
 	}
 	TiXmlText* ti_phi_text = ti_phi_node->ToText();
 	if (ti_phi_text==NULL)
 	{
-		cerr << "nf2ff::AnalyseXMLNode: Can't read phi text values ... " << endl;
-		return false;
+		cerr << "nf2ff::ParseXMLNode: Can't read phi text values ... " << endl;
+		return NULL;
 	}
 	vector<float> phi = SplitString2Float(ti_phi_text->Value());
 
@@ -259,6 +321,10 @@ bool nf2ff::AnalyseXMLNode(TiXmlElement* ti_nf2ff)
 	if (ti_nf2ff->QueryFloatAttribute("Radius",&radius) ==  TIXML_SUCCESS)
 		l_nf2ff->SetRadius(radius);
 
+	float accuracy = 0;
+	if (ti_nf2ff->QueryFloatAttribute("Accuracy",&accuracy) ==  TIXML_SUCCESS)
+		l_nf2ff->SetAccuracy(accuracy);
+
 	// read mirrors
 	TiXmlElement* ti_Mirros = ti_nf2ff->FirstChildElement("Mirror");
 	int dir=-1;
@@ -278,6 +344,16 @@ bool nf2ff::AnalyseXMLNode(TiXmlElement* ti_nf2ff)
 		ti_Mirros = ti_Mirros->NextSiblingElement("Mirror");
 	}
 	
+	return l_nf2ff;
+}
+
+bool nf2ff::AnalyseXMLNode(TiXmlElement* ti_nf2ff)
+{
+	string outfile;
+	nf2ff* l_nf2ff = ParseXMLNode(ti_nf2ff, outfile);
+	if (l_nf2ff==NULL)
+		return false;
+
 	TiXmlElement* ti_Planes = ti_nf2ff->FirstChildElement("Planes");
 	string E_name;
 	string H_name;
@@ -496,60 +572,78 @@ bool nf2ff::AnalyseFile(string E_Field_file, string H_Field_file)
 		if (m_Verbose>0)
 			cerr << "nf2ff: Analysing far-field for " <<  m_nf2ff.size() << " frequencies.  " << endl;
 
-		for (size_t fn=0;fn<m_nf2ff.size();++fn)
-		{
-			if (m_Verbose>1)
-				cerr << "nf2ff: f = " << m_freq.at(fn) << "Hz (" << fn+1 << "/" << m_freq.size() << ") ...";
-			m_nf2ff.at(fn)->AddPlane(E_lines, E_numLines, E_fd_data.at(fn), H_fd_data.at(fn),E_meshType);
-			if (m_Verbose>1)
-				cerr << " done." << endl;
-		}
-
+		this->AddPlane(E_lines, E_numLines, E_fd_data, H_fd_data, E_meshType);
 	}
 	else
 	{
-		complex<float>**** E_fd_data;
-		complex<float>**** H_fd_data;
+		// read and analyse the frequencies in chunks to bound the memory used by the FD data
+		size_t freqSize = 2*3*sizeof(complex<float>)*(size_t)E_numLines[0]*E_numLines[1]*E_numLines[2];
+		size_t chunkSize = max((size_t)1, min((size_t)NF2FF_FREQ_CHUNK, (size_t)NF2FF_FREQ_CHUNK_MEMORY/freqSize));
+		if (m_Verbose>0)
+			cerr << "nf2ff: Analysing far-field for " <<  m_nf2ff.size() << " frequencies in chunks of " << chunkSize << " frequencies.  " << endl;
+
+		complex<float>**** E_data;
+		complex<float>**** H_data;
 		unsigned int data_size[4];
-		for (size_t n=0;n<m_freq.size();++n)
+		for (size_t f_start=0;f_start<m_freq.size();f_start+=chunkSize)
 		{
-			E_fd_data = E_file.GetFDVectorData(FD_index.at(n),data_size);
-			if ((data_size[0]!=E_numLines[0]) || (data_size[1]!=E_numLines[1]) || (data_size[2]!=E_numLines[2]) )
+			size_t f_stop = min(f_start+chunkSize,m_freq.size());
+			vector<complex<float>****> E_fd_data;
+			vector<complex<float>****> H_fd_data;
+			for (size_t n=f_start;n<f_stop;++n)
 			{
-				cerr << data_size[0] << "," << data_size[1] << "," <<  data_size[2] << endl;
-				cerr << "nf2ff::AnalyseFile: FD data size mismatch... " << endl;
-				Delete_N_3DArray<complex<float> >(E_fd_data,data_size);
-				for (int n=0;n<3;++n)
-					delete[] E_lines[n];
-				return false;
-			}
+				E_data = E_file.GetFDVectorData(FD_index.at(n),data_size);
+				if ((data_size[0]!=E_numLines[0]) || (data_size[1]!=E_numLines[1]) || (data_size[2]!=E_numLines[2]) )
+				{
+					cerr << data_size[0] << "," << data_size[1] << "," <<  data_size[2] << endl;
+					cerr << "nf2ff::AnalyseFile: FD data size mismatch... " << endl;
+					Delete_N_3DArray<complex<float> >(E_data,data_size);
+					for (size_t fn=0;fn<E_fd_data.size();++fn)
+					{
+						Delete_N_3DArray<complex<float> >(E_fd_data.at(fn),E_numLines);
+						Delete_N_3DArray<complex<float> >(H_fd_data.at(fn),E_numLines);
+					}
+					for (int n=0;n<3;++n)
+						delete[] E_lines[n];
+					return false;
+				}
 
-			H_fd_data = H_file.GetFDVectorData(FD_index.at(n),data_size);
-			if ((data_size[0]!=E_numLines[0]) || (data_size[1]!=E_numLines[1]) || (data_size[2]!=E_numLines[2]) )
-			{
-				cerr << data_size[0] << "," << data_size[1] << "," <<  data_size[2] << endl;
-				cerr << "nf2ff::AnalyseFile: FD data size mismatch... " << endl;
-				Delete_N_3DArray<complex<float> >(H_fd_data,data_size);
-				Delete_N_3DArray<complex<float> >(E_fd_data,data_size);
-				for (int n=0;n<3;++n)
-					delete[] E_lines[n];
-				return false;
-			}
+				H_data = H_file.GetFDVectorData(FD_index.at(n),data_size);
+				if ((data_size[0]!=E_numLines[0]) || (data_size[1]!=E_numLines[1]) || (data_size[2]!=E_numLines[2]) )
+				{
+					cerr << data_size[0] << "," << data_size[1] << "," <<  data_size[2] << endl;
+					cerr << "nf2ff::AnalyseFile: FD data size mismatch... " << endl;
+					Delete_N_3DArray<complex<float> >(H_data,data_size);
+					Delete_N_3DArray<complex<float> >(E_data,data_size);
+					for (size_t fn=0;fn<E_fd_data.size();++fn)
+					{
+						Delete_N_3DArray<complex<float> >(E_fd_data.at(fn),E_numLines);
+						Delete_N_3DArray<complex<float> >(H_fd_data.at(fn),E_numLines);
+					}
+					for (int n=0;n<3;++n)
+						delete[] E_lines[n];
+					return false;
+				}
 
-			if ((E_fd_data==NULL) || (H_fd_data==NULL))
-			{
-				cerr << "nf2ff::AnalyseFile: Reaing FD data failed... " << endl;
-				Delete_N_3DArray<complex<float> >(E_fd_data,data_size);
-				Delete_N_3DArray<complex<float> >(H_fd_data,data_size);
-				for (int n=0;n<3;++n)
-					delete[] E_lines[n];
-				return false;
+				if ((E_data==NULL) || (H_data==NULL))
+				{
+					cerr << "nf2ff::AnalyseFile: Reaing FD data failed... " << endl;
+					Delete_N_3DArray<complex<float> >(E_data,data_size);
+					Delete_N_3DArray<complex<float> >(H_data,data_size);
+					for (size_t fn=0;fn<E_fd_data.size();++fn)
+					{
+						Delete_N_3DArray<complex<float> >(E_fd_data.at(fn),E_numLines);
+						Delete_N_3DArray<complex<float> >(H_fd_data.at(fn),E_numLines);
+					}
+					for (int n=0;n<3;++n)
+						delete[] E_lines[n];
+					return false;
+				}
+				E_fd_data.push_back(E_data);
+				H_fd_data.push_back(H_data);
 			}
-			if (m_Verbose>1)
-				cerr << "nf2ff: f = " << m_freq.at(n) << "Hz (" << n+1 << "/" << m_freq.size() << ") ...";
-			m_nf2ff.at(n)->AddPlane(E_lines, E_numLines, E_fd_data, H_fd_data,E_meshType);
-			if (m_Verbose>1)
-				cerr << " done." << endl;
+
+			AddPlaneChunk(f_start, E_lines, E_numLines, E_fd_data, H_fd_data, E_meshType);
 		}
 	}
 
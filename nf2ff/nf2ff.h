@@ -47,6 +47,10 @@ public:
 	~nf2ff();
 
 	bool AnalyseFile(string E_Field_file, string H_Field_file);
+	//! Add a plane of frequency domain E- and H-fields of the frequency index \a f_idx, takes ownership of the fields
+	bool AddPlane(size_t f_idx, float **lines, unsigned int* numLines, complex<float>**** E_field, complex<float>**** H_field, int MeshType=0);
+	//! Add a plane of frequency domain E- and H-fields for all frequencies in a single pass, e.g. accumulated in memory by the FDTD solver. Takes ownership of the fields.
+	bool AddPlane(float **lines, unsigned int* numLines, vector<complex<float>****> E_fields, vector<complex<float>****> H_fields, int MeshType=0);
 
 	void SetRadius(float radius);
 	void SetPermittivity(vector<float> permittivity);
@@ -66,10 +70,20 @@ public:
 
 	void SetVerboseLevel(int level) {m_Verbose=level;}
 
+	//! Set the accuracy of the fast far-field aggregation (relative to the pattern maximum), 0 (default) uses the direct calculation
+	void SetAccuracy(float accuracy);
+
+	vector<float> GetFrequencies() const {return m_freq;}
+
+	//! Create a nf2ff from all settings of the xml node except the planes, returns NULL on error. Caller has to cleanup.
+	static nf2ff* ParseXMLNode(TiXmlElement* ti_nf2ff, string &outfile);
 	static bool AnalyseXMLNode(TiXmlElement* ti_nf2ff);
 	static bool AnalyseXMLFile(string filename);
 
 protected:
+	//! Add a plane of frequency domain E- and H-fields for the frequencies f_start..f_start+E_fields.size()-1 in a single pass. Takes ownership of the fields.
+	bool AddPlaneChunk(size_t f_start, float **lines, unsigned int* numLines, vector<complex<float>****> E_fields, vector<complex<float>****> H_fields, int MeshType);
+
 	vector<float> m_freq;
 	vector<float> m_permittivity;
 	vector<float> m_permeability;
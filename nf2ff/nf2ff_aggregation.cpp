@@ -0,0 +1,572 @@
+/*
+*	Copyright (C) 2026 openEMS contributors
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "nf2ff_aggregation.h"
+#include "../tools/array_ops.h"
+#include "../tools/useful.h"
+
+#include <iostream>
+#include <cstring>
+
+using namespace std;
+
+// p-point Lagrange interpolation weights at \a x (in grid units) on a uniform grid, returns the first grid index
+static int LagrangeWeights(double x, unsigned int p, float* w)
+{
+	int start = (int)floor(x) - (int)p/2 + 1;
+	for (unsigned int b=0;b<p;++b)
+	{
+		double weight = 1;
+		for (unsigned int m=0;m<p;++m)
+			if (m!=b)
+				weight *= (x - (start+(int)m)) / ((double)b - (double)m);
+		w[b] = weight;
+	}
+	return start;
+}
+
+nf2ff_aggregation::nf2ff_aggregation(const nf2ff_data &data, const unsigned int* numLines, float accuracy, unsigned int numThreads)
+{
+	m_data = data;
+	m_numLines[0] = numLines[0];
+	m_numLines[1] = numLines[1];
+	m_numThreads = max(numThreads,(unsigned int)1);
+
+	accuracy = min(max(accuracy,1e-6f),0.1f);
+	m_Digits = -log10(accuracy);
+	m_Oversampling = 1.5;
+	m_Order = 2*(unsigned int)ceil(m_Digits)+4;
+
+	BuildTree();
+}
+
+nf2ff_aggregation::~nf2ff_aggregation()
+{
+	for (size_t l=0;l<m_Levels.size();++l)
+		FreeLevel(m_Levels.at(l));
+}
+
+void nf2ff_aggregation::BuildTree()
+{
+	Level level;
+	level.boxSize = NF2FF_AGGR_LEAF_SIZE;
+	level.numTheta = level.numPhi = 0;
+	level.patterns = NULL;
+	for (int n=0;n<3;++n)
+		level.dir[n] = NULL;
+
+	// leaf boxes, the center is the center of the bounding box of all its points
+	for (int d=0;d<2;++d)
+		level.numBoxes[d] = (m_numLines[d]+level.boxSize-1)/level.boxSize;
+	level.boxes.resize(level.numBoxes[0]*level.numBoxes[1]);
+	level.maxRadius = 0;
+	for (unsigned int bi=0;bi<level.numBoxes[0];++bi)
+		for (unsigned int bj=0;bj<level.numBoxes[1];++bj)
+		{
+			Box &box = level.boxes.at(bi*level.numBoxes[1]+bj);
+			for (int n=0;n<3;++n)
+			{
+				box.bbox[2*n] = m_data.coords[n][bi*level.boxSize*m_numLines[1]+bj*level.boxSize];
+				box.bbox[2*n+1] = box.bbox[2*n];
+			}
+			unsigned int stop_i = min((bi+1)*level.boxSize,m_numLines[0]);
+			unsigned int stop_j = min((bj+1)*level.boxSize,m_numLines[1]);
+			for (unsigned int i=bi*level.boxSize;i<stop_i;++i)
+				for (unsigned int j=bj*level.boxSize;j<stop_j;++j)
+					for (int n=0;n<3;++n)
+					{
+						box.bbox[2*n] = min(box.bbox[2*n], m_data.coords[n][i*m_numLines[1]+j]);
+						box.bbox[2*n+1] = max(box.bbox[2*n+1], m_data.coords[n][i*m_numLines[1]+j]);
+					}
+			for (int n=0;n<3;++n)
+				box.center[n] = 0.5*(box.bbox[2*n]+box.bbox[2*n+1]);
+			box.radius = 0;
+			for (unsigned int i=bi*level.boxSize;i<stop_i;++i)
+				for (unsigned int j=bj*level.boxSize;j<stop_j;++j)
+				{
+					float dist = 0;
+					for (int n=0;n<3;++n)
+						dist += pow(m_data.coords[n][i*m_numLines[1]+j]-box.center[n],2);
+					box.radius = max(box.radius, sqrt(dist));
+				}
+			level.maxRadius = max(level.maxRadius, box.radius);
+		}
+	m_Levels.push_back(level);
+
+	// parent boxes of up to 2x2 child boxes, up to a single top level box
+	while (m_Levels.back().boxes.size()>1)
+	{
+		const Level &child = m_Levels.back();
+		Level parent = child;
+		parent.boxSize = 2*child.boxSize;
+		for (int d=0;d<2;++d)
+			parent.numBoxes[d] = (child.numBoxes[d]+1)/2;
+		parent.boxes.resize(parent.numBoxes[0]*parent.numBoxes[1]);
+		parent.maxRadius = 0;
+		for (unsigned int bi=0;bi<parent.numBoxes[0];++bi)
+			for (unsigned int bj=0;bj<parent.numBoxes[1];++bj)
+			{
+				Box &box = parent.boxes.at(bi*parent.numBoxes[1]+bj);
+				box = child.boxes.at(2*bi*child.numBoxes[1]+2*bj);
+				for (unsigned int ci=2*bi;ci<min(2*bi+2,child.numBoxes[0]);++ci)
+					for (unsigned int cj=2*bj;cj<min(2*bj+2,child.numBoxes[1]);++cj)
+						for (int n=0;n<3;++n)
+						{
+							box.bbox[2*n] = min(box.bbox[2*n], child.boxes.at(ci*child.numBoxes[1]+cj).bbox[2*n]);
+							box.bbox[2*n+1] = max(box.bbox[2*n+1], child.boxes.at(ci*child.numBoxes[1]+cj).bbox[2*n+1]);
+						}
+				for (int n=0;n<3;++n)
+					box.center[n] = 0.5*(box.bbox[2*n]+box.bbox[2*n+1]);
+				box.radius = 0;
+				for (unsigned int ci=2*bi;ci<min(2*bi+2,child.numBoxes[0]);++ci)
+					for (unsigned int cj=2*bj;cj<min(2*bj+2,child.numBoxes[1]);++cj)
+					{
+						const Box &c_box = child.boxes.at(ci*child.numBoxes[1]+cj);
+						float dist = 0;
+						for (int n=0;n<3;++n)
+							dist += pow(c_box.center[n]-box.center[n],2);
+						box.radius = max(box.radius, sqrt(dist)+c_box.radius);
+					}
+				parent.maxRadius = max(parent.maxRadius, box.radius);
+			}
+		m_Levels.push_back(parent);
+	}
+}
+
+unsigned int nf2ff_aggregation::SetupGrid(Level &level, float k) const
+{
+	FreeLevel(level);
+
+	// band limit of the pattern of a box of radius a, incl. the excess bandwidth for the requested accuracy
+	double ka = k*level.maxRadius;
+	double L = ka + 1.8*pow(m_Digits,2.0/3.0)*pow(ka,1.0/3.0) + m_Digits;
+	level.numTheta = max((unsigned int)ceil(m_Oversampling*(L+1)), m_Order);
+	level.numPhi = 2*level.numTheta;
+
+	unsigned int numDir = level.numTheta*level.numPhi;
+	for (int n=0;n<3;++n)
+		level.dir[n] = new float[numDir];
+	for (unsigned int t=0;t<level.numTheta;++t)
+		for (unsigned int q=0;q<level.numPhi;++q)
+		{
+			double theta = (t+0.5)*M_PI/level.numTheta;
+			double phi = 2.0*M_PI*q/level.numPhi;
+			level.dir[0][t*level.numPhi+q] = sin(theta)*cos(phi);
+			level.dir[1][t*level.numPhi+q] = sin(theta)*sin(phi);
+			level.dir[2][t*level.numPhi+q] = cos(theta);
+		}
+	return numDir;
+}
+
+void nf2ff_aggregation::FreeLevel(Level &level) const
+{
+	for (int n=0;n<3;++n)
+	{
+		delete[] level.dir[n];
+		level.dir[n] = NULL;
+	}
+	FreeArrayData(level.patterns);
+	level.patterns = NULL;
+}
+
+void nf2ff_aggregation::SetupInterpolation(Interpolation &ip, unsigned int srcTheta, unsigned int srcPhi, const float* theta, unsigned int numTheta, const float* phi, unsigned int numPhi) const
+{
+	unsigned int p = m_Order;
+	float* w = new float[p];
+	ip.srcTheta = srcTheta;
+	ip.srcPhi = srcPhi;
+	ip.numTheta = numTheta;
+	ip.numPhi = numPhi;
+
+	// periodic in phi
+	ip.phiIndex.resize(2*numPhi*p);
+	ip.phiWeight.resize(2*numPhi*p);
+	for (unsigned int q=0;q<2*numPhi;++q)
+	{
+		double x = (phi[q%numPhi] + (q>=numPhi ? M_PI : 0.0))*srcPhi/(2.0*M_PI);
+		int start = LagrangeWeights(x, p, w);
+		for (unsigned int b=0;b<p;++b)
+		{
+			int index = (start+(int)b) % (int)srcPhi;
+			ip.phiIndex.at(q*p+b) = index<0 ? index+srcPhi : index;
+			ip.phiWeight.at(q*p+b) = w[b];
+		}
+	}
+
+	// theta beyond the poles: (-theta,phi) and (2*pi-theta,phi) equal (theta,phi+pi)
+	ip.thetaIndex.resize(numTheta*p);
+	ip.thetaOpposite.resize(numTheta*p);
+	ip.thetaWeight.resize(numTheta*p);
+	for (unsigned int t=0;t<numTheta;++t)
+	{
+		double th = fmod((double)theta[t], 2.0*M_PI);
+		if (th<0)
+			th += 2.0*M_PI;
+		bool flip = (th>M_PI);
+		if (flip)
+			th = 2.0*M_PI - th;
+		int start = LagrangeWeights(th*srcTheta/M_PI - 0.5, p, w);
+		for (unsigned int a=0;a<p;++a)
+		{
+			int index = start+(int)a;
+			bool opposite = flip;
+			if (index<0)
+			{
+				index = -1-index;
+				opposite = !opposite;
+			}
+			else if (index>=(int)srcTheta)
+			{
+				index = 2*srcTheta-1-index;
+				opposite = !opposite;
+			}
+			ip.thetaIndex.at(t*p+a) = index;
+			ip.thetaOpposite.at(t*p+a) = opposite ? numPhi : 0;
+			ip.thetaWeight.at(t*p+a) = w[a];
+		}
+	}
+	delete[] w;
+}
+
+void nf2ff_aggregation::Interpolate(const Interpolation &ip, const float* src, float* tmp, float* dst) const
+{
+	unsigned int p = m_Order;
+	unsigned int numCols = 2*ip.numPhi;
+	unsigned int numDst = ip.numTheta*ip.numPhi;
+
+	// interpolate all source rows onto the target phi and the opposite phi+pi
+	for (int c=0;c<NF2FF_NUM_CURRENTS;++c)
+		for (unsigned int r=0;r<ip.srcTheta;++r)
+		{
+			const float* row = src + (c*ip.srcTheta+r)*ip.srcPhi;
+			float* tmp_row = tmp + (c*ip.srcTheta+r)*numCols;
+			for (unsigned int q=0;q<numCols;++q)
+			{
+				const unsigned int* index = &ip.phiIndex[q*p];
+				const float* weight = &ip.phiWeight[q*p];
+				float value = 0;
+				for (unsigned int b=0;b<p;++b)
+					value += weight[b]*row[index[b]];
+				tmp_row[q] = value;
+			}
+		}
+
+	// interpolate along theta
+	for (unsigned int t=0;t<ip.numTheta;++t)
+	{
+		const unsigned int* index = &ip.thetaIndex[t*p];
+		const unsigned int* opposite = &ip.thetaOpposite[t*p];
+		const float* weight = &ip.thetaWeight[t*p];
+		for (int c=0;c<NF2FF_NUM_CURRENTS;++c)
+		{
+			const float* tmp_c = tmp + c*ip.srcTheta*numCols;
+			float* dst_row = dst + c*numDst + t*ip.numPhi;
+			for (unsigned int q=0;q<ip.numPhi;++q)
+			{
+				float value = 0;
+				for (unsigned int a=0;a<p;++a)
+					value += weight[a]*tmp_c[index[a]*numCols + q+opposite[a]];
+				dst_row[q] = value;
+			}
+		}
+	}
+}
+
+//! Add the pattern \a src (relative to a box center) to \a dst, shifted by \a shift (the box center relative to the destination center)
+template <class T> static void AddShiftedPattern(const float* src, unsigned int numDir, float* const* dir, const float* shift, float k, T* dst)
+{
+	for (unsigned int d=0;d<numDir;++d)
+	{
+		float phase = k*(shift[0]*dir[0][d] + shift[1]*dir[1][d] + shift[2]*dir[2][d]);
+		float c = cos(phase);
+		float s = sin(phase);
+		for (int n=0;n<NF2FF_NUM_CURRENTS;n+=2)
+		{
+			float re = src[n*numDir+d];
+			float im = src[(n+1)*numDir+d];
+			dst[n*numDir+d] += c*re - s*im;
+			dst[(n+1)*numDir+d] += c*im + s*re;
+		}
+	}
+}
+
+void nf2ff_aggregation::CalcSums(const float* theta, unsigned int numTheta, const float* phi, unsigned int numPhi)
+{
+	unsigned int numAngles = numTheta*numPhi;
+	for (unsigned int fn=0;fn<m_data.numFreq;++fn)
+	{
+		float k = m_data.k[fn];
+		double* sums = m_data.sums + fn*NF2FF_NUM_CURRENTS*numAngles;
+
+		// the leaf patterns need more directions than requested, no speed-up possible
+		if (SetupGrid(m_Levels.at(0), k)>=numAngles)
+		{
+			FreeLevel(m_Levels.at(0));
+			CalcDirect(fn, m_data.dir, numAngles, sums);
+			continue;
+		}
+
+		// calculate the patterns of all leaf boxes
+		Level* level = &m_Levels.at(0);
+		level->patterns = (float*)AllocArrayData(sizeof(float)*NF2FF_NUM_CURRENTS*level->numTheta*level->numPhi*level->boxes.size());
+		vector<unsigned int> jpt = AssignJobs2Threads(level->boxes.size(), m_numThreads, true);
+		unsigned int start=0;
+		{
+			boost::thread_group threads;
+			for (size_t n=0;n<jpt.size();++n)
+			{
+				threads.add_thread( new boost::thread( &nf2ff_aggregation::CalcLeafPatterns, this, fn, start, start+jpt.at(n) ) );
+				start += jpt.at(n);
+			}
+			threads.join_all();
+		}
+
+		// aggregate the patterns up to the level with about as many directions as requested
+		unsigned int l=0;
+		Interpolation ip;
+		vector<float> gridTheta, gridPhi;
+		while (l+1<m_Levels.size())
+		{
+			Level &parent = m_Levels.at(l+1);
+			if (SetupGrid(parent, k)>numAngles)
+			{
+				FreeLevel(parent);
+				break;
+			}
+			gridTheta.resize(parent.numTheta);
+			for (unsigned int t=0;t<parent.numTheta;++t)
+				gridTheta.at(t) = (t+0.5)*M_PI/parent.numTheta;
+			gridPhi.resize(parent.numPhi);
+			for (unsigned int q=0;q<parent.numPhi;++q)
+				gridPhi.at(q) = 2.0*M_PI*q/parent.numPhi;
+			SetupInterpolation(ip, m_Levels.at(l).numTheta, m_Levels.at(l).numPhi, &gridTheta[0], parent.numTheta, &gridPhi[0], parent.numPhi);
+			parent.patterns = (float*)AllocArrayData(sizeof(float)*NF2FF_NUM_CURRENTS*parent.numTheta*parent.numPhi*parent.boxes.size());
+
+			jpt = AssignJobs2Threads(parent.boxes.size(), m_numThreads, true);
+			start = 0;
+			boost::thread_group threads;
+			for (size_t n=0;n<jpt.size();++n)
+			{
+				threads.add_thread( new boost::thread( &nf2ff_aggregation::AggregateRange, this, l, fn, &ip, start, start+jpt.at(n) ) );
+				start += jpt.at(n);
+			}
+			threads.join_all();
+
+			FreeLevel(m_Levels.at(l));
+			++l;
+		}
+
+		// interpolate the patterns of the top level boxes onto the requested angles
+		level = &m_Levels.at(l);
+		SetupInterpolation(ip, level->numTheta, level->numPhi, theta, numTheta, phi, numPhi);
+		jpt = AssignJobs2Threads(level->boxes.size(), m_numThreads, true);
+		vector<double*> thread_sums(jpt.size(),NULL);
+		start = 0;
+		{
+			boost::thread_group threads;
+			for (size_t n=0;n<jpt.size();++n)
+			{
+				thread_sums.at(n) = (double*)AllocArrayData(sizeof(double)*NF2FF_NUM_CURRENTS*numAngles);
+				threads.add_thread( new boost::thread( &nf2ff_aggregation::DisaggregateRange, this, l, fn, &ip, start, start+jpt.at(n), thread_sums.at(n) ) );
+				start += jpt.at(n);
+			}
+			threads.join_all();
+		}
+		FreeLevel(*level);
+
+		for (size_t n=0;n<thread_sums.size();++n)
+		{
+			for (unsigned int a=0;a<numAngles;++a)
+				for (int c=0;c<NF2FF_NUM_CURRENTS;++c)
+					sums[a*NF2FF_NUM_CURRENTS+c] += thread_sums.at(n)[c*numAngles+a];
+			FreeArrayData(thread_sums.at(n));
+		}
+	}
+}
+
+void nf2ff_aggregation::CalcLeafPatterns(unsigned int fn, unsigned int start, unsigned int stop)
+{
+	const Level &level = m_Levels.at(0);
+	unsigned int numDir = level.numTheta*level.numPhi;
+
+	// the points of a single leaf box, relative to its center
+	nf2ff_data leaf = m_data;
+	leaf.numPoints = (level.boxSize*level.boxSize+NF2FF_POINT_BLOCK-1)/NF2FF_POINT_BLOCK*NF2FF_POINT_BLOCK;
+	leaf.numFreq = 1;
+	leaf.k = m_data.k + fn;
+	leaf.numAngles = numDir;
+	for (int n=0;n<3;++n)
+	{
+		leaf.coords[n] = (float*)AllocArrayData(sizeof(float)*leaf.numPoints);
+		leaf.dir[n] = level.dir[n];
+	}
+	leaf.currents = (float*)AllocArrayData(sizeof(float)*NF2FF_NUM_CURRENTS*leaf.numPoints);
+	leaf.sums = (double*)AllocArrayData(sizeof(double)*NF2FF_NUM_CURRENTS*numDir);
+	const float* currents = m_data.currents + fn*NF2FF_NUM_CURRENTS*m_data.numPoints;
+
+	for (unsigned int b=start;b<stop;++b)
+	{
+		unsigned int bi = b/level.numBoxes[1];
+		unsigned int bj = b%level.numBoxes[1];
+		const Box &box = level.boxes.at(b);
+		memset(leaf.currents, 0, sizeof(float)*NF2FF_NUM_CURRENTS*leaf.numPoints);
+		memset(leaf.sums, 0, sizeof(double)*NF2FF_NUM_CURRENTS*numDir);
+		unsigned int idx = 0;
+		for (unsigned int i=bi*level.boxSize;i<min((bi+1)*level.boxSize,m_numLines[0]);++i)
+			for (unsigned int j=bj*level.boxSize;j<min((bj+1)*level.boxSize,m_numLines[1]);++j,++idx)
+			{
+				unsigned int pos = i*m_numLines[1]+j;
+				for (int n=0;n<3;++n)
+					leaf.coords[n][idx] = m_data.coords[n][pos] - box.center[n];
+				for (int c=0;c<NF2FF_NUM_CURRENTS;++c)
+					leaf.currents[c*leaf.numPoints+idx] = currents[c*m_data.numPoints+pos];
+			}
+
+		nf2ff_calc_thread(0, numDir-1, leaf)();
+
+		float* pattern = level.patterns + b*NF2FF_NUM_CURRENTS*numDir;
+		for (unsigned int d=0;d<numDir;++d)
+			for (int c=0;c<NF2FF_NUM_CURRENTS;++c)
+				pattern[c*numDir+d] = leaf.sums[d*NF2FF_NUM_CURRENTS+c];
+	}
+
+	for (int n=0;n<3;++n)
+		FreeArrayData(leaf.coords[n]);
+	FreeArrayData(leaf.currents);
+	FreeArrayData(leaf.sums);
+}
+
+void nf2ff_aggregation::AggregateRange(unsigned int level, unsigned int fn, const Interpolation* ip, unsigned int start, unsigned int stop)
+{
+	const Level &child = m_Levels.at(level);
+	const Level &parent = m_Levels.at(level+1);
+	unsigned int numChildDir = child.numTheta*child.numPhi;
+	unsigned int numDir = parent.numTheta*parent.numPhi;
+	float* tmp = new float[NF2FF_NUM_CURRENTS*child.numTheta*2*parent.numPhi];
+	float* interp = new float[NF2FF_NUM_CURRENTS*numDir];
+	float shift[3];
+
+	for (unsigned int b=start;b<stop;++b)
+	{
+		unsigned int bi = b/parent.numBoxes[1];
+		unsigned int bj = b%parent.numBoxes[1];
+		float* pattern = parent.patterns + b*NF2FF_NUM_CURRENTS*numDir;
+		for (unsigned int ci=2*bi;ci<min(2*bi+2,child.numBoxes[0]);++ci)
+			for (unsigned int cj=2*bj;cj<min(2*bj+2,child.numBoxes[1]);++cj)
+			{
+				unsigned int c_b = ci*child.numBoxes[1]+cj;
+				Interpolate(*ip, child.patterns + c_b*NF2FF_NUM_CURRENTS*numChildDir, tmp, interp);
+				for (int n=0;n<3;++n)
+					shift[n] = child.boxes.at(c_b).center[n] - parent.boxes.at(b).center[n];
+				AddShiftedPattern<float>(interp, numDir, parent.dir, shift, m_data.k[fn], pattern);
+			}
+	}
+
+	delete[] tmp;
+	delete[] interp;
+}
+
+void nf2ff_aggregation::DisaggregateRange(unsigned int level, unsigned int fn, const Interpolation* ip, unsigned int start, unsigned int stop, double* sums)
+{
+	const Level &top = m_Levels.at(level);
+	unsigned int numBoxDir = top.numTheta*top.numPhi;
+	unsigned int numDir = ip->numTheta*ip->numPhi;
+	float* tmp = new float[NF2FF_NUM_CURRENTS*top.numTheta*2*ip->numPhi];
+	float* interp = new float[NF2FF_NUM_CURRENTS*numDir];
+
+	for (unsigned int b=start;b<stop;++b)
+	{
+		Interpolate(*ip, top.patterns + b*NF2FF_NUM_CURRENTS*numBoxDir, tmp, interp);
+		AddShiftedPattern<double>(interp, numDir, m_data.dir, top.boxes.at(b).center, m_data.k[fn], sums);
+	}
+
+	delete[] tmp;
+	delete[] interp;
+}
+
+void nf2ff_aggregation::CalcDirect(unsigned int fn, float* const* dir, unsigned int numAngles, double* sums) const
+{
+	nf2ff_data data = m_data;
+	data.numFreq = 1;
+	data.k = m_data.k + fn;
+	data.currents = m_data.currents + fn*NF2FF_NUM_CURRENTS*m_data.numPoints;
+	data.numAngles = numAngles;
+	for (int n=0;n<3;++n)
+		data.dir[n] = dir[n];
+	data.sums = sums;
+
+	vector<unsigned int> jpt = AssignJobs2Threads(numAngles, m_numThreads, true);
+	boost::thread_group threads;
+	unsigned int start=0;
+	for (size_t n=0;n<jpt.size();++n)
+	{
+		threads.add_thread( new boost::thread( nf2ff_calc_thread(start,start+jpt.at(n)-1,data) ) );
+		start += jpt.at(n);
+	}
+	threads.join_all();
+}
+
+vector<double> nf2ff_aggregation::Validate(unsigned int numAngles) const
+{
+	numAngles = min(numAngles, m_data.numAngles);
+	vector<double> deviation(m_data.numFreq,0);
+	if (numAngles==0)
+		return deviation;
+
+	// evenly spread subset of all angles
+	vector<unsigned int> angles(numAngles);
+	float* dir[3];
+	for (int n=0;n<3;++n)
+		dir[n] = new float[numAngles];
+	for (unsigned int a=0;a<numAngles;++a)
+	{
+		angles.at(a) = (unsigned int)(((unsigned long long)a*m_data.numAngles)/numAngles);
+		for (int n=0;n<3;++n)
+			dir[n][a] = m_data.dir[n][angles.at(a)];
+	}
+
+	double* sums = new double[NF2FF_NUM_CURRENTS*numAngles];
+	for (unsigned int fn=0;fn<m_data.numFreq;++fn)
+	{
+		for (unsigned int n=0;n<NF2FF_NUM_CURRENTS*numAngles;++n)
+			sums[n] = 0;
+		CalcDirect(fn, dir, numAngles, sums);
+
+		double max_norm = 0;
+		double max_dev = 0;
+		for (unsigned int a=0;a<numAngles;++a)
+		{
+			const double* fast = m_data.sums + (fn*m_data.numAngles + angles.at(a))*NF2FF_NUM_CURRENTS;
+			double norm = 0;
+			double dev = 0;
+			for (int c=0;c<NF2FF_NUM_CURRENTS;++c)
+			{
+				norm += sums[a*NF2FF_NUM_CURRENTS+c]*sums[a*NF2FF_NUM_CURRENTS+c];
+				dev += pow(fast[c]-sums[a*NF2FF_NUM_CURRENTS+c],2);
+			}
+			max_norm = max(max_norm, sqrt(norm));
+			max_dev = max(max_dev, sqrt(dev));
+		}
+		if (max_norm>0)
+			deviation.at(fn) = max_dev/max_norm;
+	}
+
+	delete[] sums;
+	for (int n=0;n<3;++n)
+		delete[] dir[n];
+	return deviation;
+}
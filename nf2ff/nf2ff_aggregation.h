@@ -0,0 +1,112 @@
+/*
+*	Copyright (C) 2026 openEMS contributors
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef NF2FF_AGGREGATION_H
+#define NF2FF_AGGREGATION_H
+
+#include "nf2ff_calc.h"
+
+//! number of surface points (in each direction) of a leaf box
+#define NF2FF_AGGR_LEAF_SIZE 16
+
+/*!
+  Fast multilevel aggregation of the radiation integral, an alternative to the direct calculation (see nf2ff_calc_thread).
+
+  The structured surface is divided into a quad-tree of boxes. The radiation pattern of every leaf box is calculated on a coarse (theta,phi) grid,
+  which only has to resolve the electrical size of the box. The patterns of four child boxes are interpolated onto the finer grid of their parent box,
+  phase shifted to the parent center and summed up, until the grid size would exceed the number of requested angles.
+  Finally, the patterns of the top level boxes are interpolated onto the requested angles.
+  This reduces the complexity from O(N*numAngles) to about O(N*log(N) + numBoxes*numAngles).
+
+  The band limit, the oversampling of all grids and the interpolation order are chosen for the requested accuracy (relative to the pattern maximum).
+  */
+class nf2ff_aggregation
+{
+public:
+	//! Setup the quad-tree for the structured surface of \a numLines points (the surface index is i*numLines[1]+j, see nf2ff_data)
+	nf2ff_aggregation(const nf2ff_data &data, const unsigned int* numLines, float accuracy, unsigned int numThreads);
+	~nf2ff_aggregation();
+
+	//! Calculate the sums of all frequencies and angles, the angles of the data have to be the (theta,phi) grid given
+	void CalcSums(const float* theta, unsigned int numTheta, const float* phi, unsigned int numPhi);
+
+	//! Compare the sums of a subset of \a numAngles angles with the direct calculation, returns the deviation relative to the pattern maximum for every frequency
+	std::vector<double> Validate(unsigned int numAngles) const;
+
+protected:
+	nf2ff_data m_data;
+	unsigned int m_numLines[2];
+	unsigned int m_numThreads;
+
+	double m_Digits;        // number of accurate digits
+	double m_Oversampling;  // oversampling of all grids relative to the band limit
+	unsigned int m_Order;   // number of interpolation points in theta and phi
+
+	struct Box
+	{
+		float center[3];
+		float radius;
+		float bbox[6];
+	};
+
+	struct Level
+	{
+		unsigned int numBoxes[2];
+		unsigned int boxSize;   // number of surface points per box and direction
+		std::vector<Box> boxes; // box index bi*numBoxes[1]+bj
+		float maxRadius;
+
+		// sampling grid of the current frequency: theta_n = (n+0.5)*pi/numTheta, phi_m = 2*pi*m/numPhi
+		unsigned int numTheta;
+		unsigned int numPhi;
+		float* dir[3];          // direction cosines of the grid, phi is the fast index
+		float* patterns;        // NF2FF_NUM_CURRENTS*numTheta*numPhi floats per box, the direction is the fast index
+	};
+	std::vector<Level> m_Levels;
+
+	//! Interpolation from a sampled grid onto a (theta,phi) grid of target directions
+	struct Interpolation
+	{
+		unsigned int srcTheta, srcPhi;
+		unsigned int numTheta, numPhi;
+		// source column and weight of every target phi and its opposite phi+pi (columns numPhi..2*numPhi-1)
+		std::vector<unsigned int> phiIndex;
+		std::vector<float> phiWeight;
+		// source row, column offset (opposite column) and weight of every target theta, rows beyond the poles continue at phi+pi
+		std::vector<unsigned int> thetaIndex;
+		std::vector<unsigned int> thetaOpposite;
+		std::vector<float> thetaWeight;
+	};
+
+	void BuildTree();
+	//! Setup the sampling grid of a level for the wave number \a k, returns the number of directions
+	unsigned int SetupGrid(Level &level, float k) const;
+	void FreeLevel(Level &level) const;
+
+	void SetupInterpolation(Interpolation &ip, unsigned int srcTheta, unsigned int srcPhi, const float* theta, unsigned int numTheta, const float* phi, unsigned int numPhi) const;
+	//! Interpolate a pattern, \a tmp needs NF2FF_NUM_CURRENTS*srcTheta*2*numPhi floats
+	void Interpolate(const Interpolation &ip, const float* src, float* tmp, float* dst) const;
+
+	void CalcLeafPatterns(unsigned int fn, unsigned int start, unsigned int stop);
+	void AggregateRange(unsigned int level, unsigned int fn, const Interpolation* ip, unsigned int start, unsigned int stop);
+	void DisaggregateRange(unsigned int level, unsigned int fn, const Interpolation* ip, unsigned int start, unsigned int stop, double* sums);
+
+	//! Direct calculation of the sums of frequency \a fn for the given directions
+	void CalcDirect(unsigned int fn, float* const* dir, unsigned int numAngles, double* sums) const;
+};
+
+#endif // NF2FF_AGGREGATION_H
@@ -16,6 +16,7 @@
 */
 
 #include "nf2ff_calc.h"
+#include "nf2ff_aggregation.h"
 #include "../tools/array_ops.h"
 #include "../tools/useful.h"
 
@@ -29,134 +30,147 @@
 
 using namespace std;
 
-nf2ff_calc_thread::nf2ff_calc_thread(nf2ff_calc* nfc, unsigned int start, unsigned int stop, unsigned int threadID, nf2ff_data &data)
+// access a vector of floats inside a float array, the array has to be aligned to the vector size
+#define NF2FF_VEC(TYPE, var) (*(TYPE*)&(var))
+
+// The kernels below are compiled for the target of their calling CalcSums_AVX/.._AVX512 functions only.
+// Instead of forcing them inline (which fails if the targets of caller and callee differ) the callers are flattened,
+// inlining all helpers that are compatible with the calling target.
+// The rounding in nf2ff_sincos relies on strict floating point semantics, re-association (-ffast-math) would optimize it away.
+#ifdef __GNUC__
+#pragma GCC push_options
+#pragma GCC optimize("no-fast-math")
+#endif
+
+/*!
+  Sine and cosine of all elements of \a x, VEC is either a gcc vector of floats or a plain float.
+  The argument is reduced by a multiple n of pi/2 to [-pi/4, pi/4] (Cody-Waite), the quadrant (n mod 4) is applied by pure floating point arithmetic.
+  Rounding is done by adding and subtracting 1.5*2^23, thus the argument has to be well below 2^22*pi/2.
+  */
+template <class VEC> inline void nf2ff_sincos(const VEC &x, VEC &s, VEC &c)
+{
+	const float round = 12582912.0f; // 1.5*2^23
+	VEC n = (x*0.63661977236758134f + round) - round; // round(x*2/pi)
+	VEC r = ((x - n*1.5703125f) - n*4.837512969970703125e-4f) - n*7.54978995489188216e-8f;
+	VEC r2 = r*r;
+	VEC sin_r = r + r*r2*(-1.6666654611e-1f + r2*(8.3321608736e-3f - r2*1.9515295891e-4f));
+	VEC cos_r = 1.0f - 0.5f*r2 + r2*r2*(4.166664568298827e-2f + r2*(-1.388731625493765e-3f + r2*2.443315711809948e-5f));
+
+	// odd quadrant: m=1, quadrant 2 or 3: h=1
+	VEC half = (n*0.5f - 0.25f + round) - round; // floor(n/2)
+	VEC m = n - 2.0f*half;
+	VEC h = half - 2.0f*((half*0.5f - 0.25f + round) - round);
+	s = (1.0f - 2.0f*h)*(sin_r + m*(cos_r - sin_r));
+	c = (1.0f - 2.0f*(m + h - 2.0f*m*h))*(cos_r + m*(sin_r - cos_r));
+}
+
+//! Horizontal sum of all elements of \a v in double precision
+template <class VEC> inline double nf2ff_hsum(const VEC &v)
+{
+	const float* f = (const float*)&v;
+	double sum = 0;
+	for (unsigned int n=0; n<sizeof(VEC)/sizeof(float); ++n)
+		sum += f[n];
+	return sum;
+}
+
+nf2ff_calc_thread::nf2ff_calc_thread(unsigned int start, unsigned int stop, const nf2ff_data &data)
 {
-	m_nf_calc = nfc;
 	m_start = start;
 	m_stop = stop;
-	m_threadID = threadID;
 	m_data = data;
 }
 
 void nf2ff_calc_thread::operator()()
 {
-	m_nf_calc->m_Barrier->wait(); // start
-
-	int ny = m_data.ny;
-	int nP = (ny+1)%3;
-	int nPP = (ny+2)%3;
-
-	unsigned int* numLines = m_data.numLines;
-	float* normDir = m_data.normDir;
-	float **lines = m_data.lines;
-	float* edge_length_P = m_data.edge_length_P;
-	float* edge_length_PP = m_data.edge_length_PP;
-
-	unsigned int pos[3];
-	unsigned int pos_t=0;
-	unsigned int num_t=m_stop-m_start+1;
-
+#ifdef ENABLE_WIDE_VECTORS
+	unsigned int width = GetCPUVectorWidth();
+	if (width==16)
+		CalcSums_AVX512();
+	else if (width==8)
+		CalcSums_AVX();
+	else
+		CalcSums<v4sf>();
+#elif defined(__GNUC__)
+	CalcSums<v4sf>();
+#else
+	CalcSums<float>();
+#endif
+}
 
-	complex<float>**** Js=m_data.Js;
-	complex<float>**** Ms=m_data.Ms;
-	complex<float>**** E_field=m_data.E_field;
-	complex<float>**** H_field=m_data.H_field;
+template <class VEC> void nf2ff_calc_thread::CalcSums()
+{
+	const unsigned int width = sizeof(VEC)/sizeof(float);
+	const unsigned int numPoints = m_data.numPoints;
 
-	int mesh_type = m_data.mesh_type;
+	// projection of the current block of surface points onto all directions of the current angle block, shared by all frequencies
+	float* proj = (float*)AllocArrayData(sizeof(float)*NF2FF_ANGLE_BLOCK*NF2FF_POINT_BLOCK);
+	VEC sum[NF2FF_NUM_CURRENTS];
+	VEC s,c;
 
-	// calc Js and Ms (eq. 8.15a/b)
-	pos[ny]=0;
-	for (pos_t=0; pos_t<num_t; ++pos_t)
+	for (unsigned int a_start=m_start; a_start<=m_stop; a_start+=NF2FF_ANGLE_BLOCK)
 	{
-		pos[nP] = m_start+pos_t;
-		for (pos[nPP]=0; pos[nPP]<numLines[nPP]; ++pos[nPP])
+		unsigned int a_stop = min(a_start+NF2FF_ANGLE_BLOCK-1, m_stop);
+		for (unsigned int p_start=0; p_start<numPoints; p_start+=NF2FF_POINT_BLOCK)
 		{
-			// Js =  n x H
-			Js[0][pos[0]][pos[1]][pos[2]] = normDir[1]*H_field[2][pos[0]][pos[1]][pos[2]] - normDir[2]*H_field[1][pos[0]][pos[1]][pos[2]];
-			Js[1][pos[0]][pos[1]][pos[2]] = normDir[2]*H_field[0][pos[0]][pos[1]][pos[2]] - normDir[0]*H_field[2][pos[0]][pos[1]][pos[2]];
-			Js[2][pos[0]][pos[1]][pos[2]] = normDir[0]*H_field[1][pos[0]][pos[1]][pos[2]] - normDir[1]*H_field[0][pos[0]][pos[1]][pos[2]];
-
-			// Ms = -n x E
-			Ms[0][pos[0]][pos[1]][pos[2]] = normDir[2]*E_field[1][pos[0]][pos[1]][pos[2]] - normDir[1]*E_field[2][pos[0]][pos[1]][pos[2]];
-			Ms[1][pos[0]][pos[1]][pos[2]] = normDir[0]*E_field[2][pos[0]][pos[1]][pos[2]] - normDir[2]*E_field[0][pos[0]][pos[1]][pos[2]];
-			Ms[2][pos[0]][pos[1]][pos[2]] = normDir[1]*E_field[0][pos[0]][pos[1]][pos[2]] - normDir[0]*E_field[1][pos[0]][pos[1]][pos[2]];
-
-			//transform to cartesian coordinates
-			if (mesh_type==1)
+			for (unsigned int a=a_start; a<=a_stop; ++a)
 			{
-				Js[0][pos[0]][pos[1]][pos[2]] = (normDir[1]*H_field[2][pos[0]][pos[1]][pos[2]] - normDir[2]*H_field[1][pos[0]][pos[1]][pos[2]])*cos(lines[1][pos[1]]) \
-						- (normDir[2]*H_field[0][pos[0]][pos[1]][pos[2]] - normDir[0]*H_field[2][pos[0]][pos[1]][pos[2]])*sin(lines[1][pos[1]]);
-				Js[1][pos[0]][pos[1]][pos[2]] = (normDir[1]*H_field[2][pos[0]][pos[1]][pos[2]] - normDir[2]*H_field[1][pos[0]][pos[1]][pos[2]])*sin(lines[1][pos[1]]) \
-						+ (normDir[2]*H_field[0][pos[0]][pos[1]][pos[2]] - normDir[0]*H_field[2][pos[0]][pos[1]][pos[2]])*cos(lines[1][pos[1]]);
-
-				Ms[0][pos[0]][pos[1]][pos[2]] = (normDir[2]*E_field[1][pos[0]][pos[1]][pos[2]] - normDir[1]*E_field[2][pos[0]][pos[1]][pos[2]])*cos(lines[1][pos[1]]) \
-						- (normDir[0]*E_field[2][pos[0]][pos[1]][pos[2]] - normDir[2]*E_field[0][pos[0]][pos[1]][pos[2]])*sin(lines[1][pos[1]]);
-				Ms[1][pos[0]][pos[1]][pos[2]] = (normDir[2]*E_field[1][pos[0]][pos[1]][pos[2]] - normDir[1]*E_field[2][pos[0]][pos[1]][pos[2]])*sin(lines[1][pos[1]]) \
-						+ (normDir[0]*E_field[2][pos[0]][pos[1]][pos[2]] - normDir[2]*E_field[0][pos[0]][pos[1]][pos[2]])*cos(lines[1][pos[1]]);
+				float ux = m_data.dir[0][a];
+				float uy = m_data.dir[1][a];
+				float uz = m_data.dir[2][a];
+				float* a_proj = proj + (a-a_start)*NF2FF_POINT_BLOCK;
+				for (unsigned int p=0; p<NF2FF_POINT_BLOCK; p+=width)
+					NF2FF_VEC(VEC,a_proj[p]) = NF2FF_VEC(const VEC,m_data.coords[0][p_start+p])*ux + NF2FF_VEC(const VEC,m_data.coords[1][p_start+p])*uy + NF2FF_VEC(const VEC,m_data.coords[2][p_start+p])*uz;
 			}
-		}
-	}
 
-	complex<double>** m_Nt=m_data.m_Nt;
-	complex<double>** m_Np=m_data.m_Np;
-	complex<double>** m_Lt=m_data.m_Lt;
-	complex<double>** m_Lp=m_data.m_Lp;
-
-	float center[3] = {m_nf_calc->m_centerCoord[0],m_nf_calc->m_centerCoord[1],m_nf_calc->m_centerCoord[2]};
-	if (mesh_type==1)
-	{
-		center[0] = m_nf_calc->m_centerCoord[0]*cos(m_nf_calc->m_centerCoord[1]);
-		center[1] = m_nf_calc->m_centerCoord[0]*sin(m_nf_calc->m_centerCoord[1]);
-	}
-	// calc local Nt,Np,Lt and Lp
-	float area;
-	float cosT_cosP,cosP_sinT;
-	float cosT_sinP,sinT_sinP;
-	float sinT,sinP;
-	float cosP,cosT;
-	float r_cos_psi;
-	float k = 2*M_PI*m_nf_calc->m_freq/__C0__*sqrt(m_nf_calc->m_permittivity*m_nf_calc->m_permeability);
-	complex<float> exp_jkr;
-	complex<float> _I_(0,1);
-	for (unsigned int tn=0;tn<m_nf_calc->m_numTheta;++tn)
-		for (unsigned int pn=0;pn<m_nf_calc->m_numPhi;++pn)
-		{
-			sinT = sin(m_nf_calc->m_theta[tn]);
-			sinP = sin(m_nf_calc->m_phi[pn]);
-			cosT = cos(m_nf_calc->m_theta[tn]);
-			cosP = cos(m_nf_calc->m_phi[pn]);
-			cosT_cosP = cosT*cosP;
-			cosT_sinP = cosT*sinP;
-			cosP_sinT = cosP*sinT;
-			sinT_sinP = sinP*sinT;
-
-			for (pos_t=0; pos_t<num_t; ++pos_t)
+			// the current block of a single frequency stays in cache for all angles of the block
+			for (unsigned int fn=0; fn<m_data.numFreq; ++fn)
 			{
-				pos[nP] = m_start+pos_t;
-				for (pos[nPP]=0; pos[nPP]<numLines[nPP]; ++pos[nPP])
+				const float* curr = m_data.currents + (size_t)fn*NF2FF_NUM_CURRENTS*numPoints + p_start;
+				float k = m_data.k[fn];
+				for (unsigned int a=a_start; a<=a_stop; ++a)
 				{
-					if (mesh_type==0)
-						r_cos_psi = (lines[0][pos[0]]-center[0])*cosP_sinT + (lines[1][pos[1]]-center[1])*sinT_sinP + (lines[2][pos[2]]-center[2])*cosT;
-					else
-						r_cos_psi = ((lines[0][pos[0]]*cos(lines[1][pos[1]]))-center[0])*cosP_sinT + ((lines[0][pos[0]]*sin(lines[1][pos[1]]))-center[1])*sinT_sinP + (lines[2][pos[2]]-center[2])*cosT;
-					exp_jkr = exp(_I_*k*r_cos_psi);
-					area = edge_length_P[pos[nP]]*edge_length_PP[pos[nPP]];
-					m_Nt[tn][pn] += area*exp_jkr*(Js[0][pos[0]][pos[1]][pos[2]]*cosT_cosP + Js[1][pos[0]][pos[1]][pos[2]]*cosT_sinP \
-												  - Js[2][pos[0]][pos[1]][pos[2]]*sinT);
-					m_Np[tn][pn] += area*exp_jkr*(Js[1][pos[0]][pos[1]][pos[2]]*cosP - Js[0][pos[0]][pos[1]][pos[2]]*sinP);
-
-					m_Lt[tn][pn] += area*exp_jkr*(Ms[0][pos[0]][pos[1]][pos[2]]*cosT_cosP + Ms[1][pos[0]][pos[1]][pos[2]]*cosT_sinP \
-												  - Ms[2][pos[0]][pos[1]][pos[2]]*sinT);
-					m_Lp[tn][pn] += area*exp_jkr*(Ms[1][pos[0]][pos[1]][pos[2]]*cosP - Ms[0][pos[0]][pos[1]][pos[2]]*sinP);
+					const float* a_proj = proj + (a-a_start)*NF2FF_POINT_BLOCK;
+					for (int n=0; n<NF2FF_NUM_CURRENTS; ++n)
+						sum[n] = VEC();
+					for (unsigned int p=0; p<NF2FF_POINT_BLOCK; p+=width)
+					{
+						// exp(j*k*r*cos(psi))
+						nf2ff_sincos<VEC>(NF2FF_VEC(const VEC,a_proj[p])*k, s, c);
+						for (int n=0; n<NF2FF_NUM_CURRENTS; n+=2)
+						{
+							const VEC &re = NF2FF_VEC(const VEC,curr[n*numPoints+p]);
+							const VEC &im = NF2FF_VEC(const VEC,curr[(n+1)*numPoints+p]);
+							sum[n]   += c*re - s*im;
+							sum[n+1] += c*im + s*re;
+						}
+					}
+					double* out = m_data.sums + ((size_t)fn*m_data.numAngles + a)*NF2FF_NUM_CURRENTS;
+					for (int n=0; n<NF2FF_NUM_CURRENTS; ++n)
+						out[n] += nf2ff_hsum<VEC>(sum[n]);
 				}
 			}
 		}
+	}
 
-	m_nf_calc->m_Barrier->wait(); //combine all thread local Nt,Np,Lt and Lp
+	FreeArrayData(proj);
+}
 
-	m_nf_calc->m_Barrier->wait(); //wait for termination
+#ifdef ENABLE_WIDE_VECTORS
+__attribute__((target("avx"), flatten)) void nf2ff_calc_thread::CalcSums_AVX()
+{
+	CalcSums<v8sf>();
 }
 
+__attribute__((target("avx512f"), flatten)) void nf2ff_calc_thread::CalcSums_AVX512()
+{
+	CalcSums<v16sf>();
+}
+#endif
+
+#ifdef __GNUC__
+#pragma GCC pop_options
+#endif
 
 /***********************************************************************/
 
@@ -202,13 +216,15 @@ nf2ff_calc::nf2ff_calc(float freq, vector<float> theta, vector<float> phi, vecto
 	m_maxDir = 0;
 	m_radius = 1;
 
+	m_Accuracy = 0;
+	m_MaxDeviation = 0;
+
 	for (int n=0;n<3;++n)
 	{
 		m_MirrorType[n] = MIRROR_OFF;
 		m_MirrorPos[n]  = 0.0;
 	}
 
-	m_Barrier = NULL;
 	m_numThreads = boost::thread::hardware_concurrency();
 }
 
@@ -230,9 +246,6 @@ nf2ff_calc::~nf2ff_calc()
 	m_H_phi = NULL;
 	Delete2DArray(m_P_rad,numLines);
 	m_P_rad = NULL;
-
-	delete m_Barrier;
-	m_Barrier = NULL;
 }
 
 int nf2ff_calc::GetNormalDir(unsigned int* numLines)
@@ -265,99 +278,125 @@ void nf2ff_calc::SetMirror(int type, int dir, float pos)
 	m_MirrorPos[dir] = pos;
 }
 
-bool nf2ff_calc::AddMirrorPlane(int n, float **lines, unsigned int* numLines, complex<float>**** E_field, complex<float>**** H_field, int MeshType)
+bool nf2ff_calc::AddMirrorPlane(int n, const vector<nf2ff_calc*> &nf_calc, float **lines, unsigned int* numLines, vector<complex<float>****> &E_fields, vector<complex<float>****> &H_fields, int MeshType)
 {
 	float E_factor[3] = {1,1,1};
 	float H_factor[3] = {1,1,1};
 
 	int nP  = (n+1)%3;
 	int nPP = (n+2)%3;
-	
+
+	const float* MirrorPos = nf_calc.at(0)->m_MirrorPos;
+	const int* MirrorType = nf_calc.at(0)->m_MirrorType;
+
 	// mirror in ny direction
 	for (unsigned int i=0;i<numLines[n];++i)
-		lines[n][i] = 2.0*m_MirrorPos[n] - lines[n][i];
-	if (m_MirrorType[n]==MIRROR_PEC)
+		lines[n][i] = 2.0*MirrorPos[n] - lines[n][i];
+	if (MirrorType[n]==MIRROR_PEC)
 	{
 		H_factor[n]  =-1.0;
 		E_factor[nP] =-1.0;
 		E_factor[nPP]=-1.0;
 	}
-	else if (m_MirrorType[n]==MIRROR_PMC)
+	else if (MirrorType[n]==MIRROR_PMC)
 	{
 		E_factor[n]  = -1.0;
 		H_factor[nP] = -1.0;
 		H_factor[nPP]= -1.0;
 	}
 
-	for (int d=0;d<3;++d)
-		for (unsigned int i=0;i<numLines[0];++i)
-			for (unsigned int j=0;j<numLines[1];++j)
-				for (unsigned int k=0;k<numLines[2];++k)
-				{
-					E_field[d][i][j][k] *= E_factor[d];
-					H_field[d][i][j][k] *= H_factor[d];
-				}
-
-	return this->AddSinglePlane(lines, numLines, E_field, H_field, MeshType);
+	for (size_t fn=0;fn<E_fields.size();++fn)
+		for (int d=0;d<3;++d)
+			for (unsigned int i=0;i<numLines[0];++i)
+				for (unsigned int j=0;j<numLines[1];++j)
+					for (unsigned int k=0;k<numLines[2];++k)
+					{
+						E_fields.at(fn)[d][i][j][k] *= E_factor[d];
+						H_fields.at(fn)[d][i][j][k] *= H_factor[d];
+					}
+
+	return AddSinglePlane(nf_calc, lines, numLines, E_fields, H_fields, MeshType);
 }
 
 bool nf2ff_calc::AddPlane(float **lines, unsigned int* numLines, complex<float>**** E_field, complex<float>**** H_field, int MeshType)
 {
-	this->AddSinglePlane(lines, numLines, E_field, H_field, MeshType);
+	return AddPlane(vector<nf2ff_calc*>(1,this), lines, numLines, vector<complex<float>****>(1,E_field), vector<complex<float>****>(1,H_field), MeshType);
+}
 
-	for (int n=0;n<3;++n)
+bool nf2ff_calc::AddPlane(const vector<nf2ff_calc*> &nf_calc, float **lines, unsigned int* numLines, vector<complex<float>****> E_fields, vector<complex<float>****> H_fields, int MeshType)
+{
+	bool ok = (nf_calc.size()>0) && (E_fields.size()==nf_calc.size()) && (H_fields.size()==nf_calc.size());
+	if (!ok)
+		cerr << "nf2ff_calc::AddPlane: Error, number of frequencies and fields don't agree" << endl;
+	for (size_t fn=1;ok && fn<nf_calc.size();++fn)
+		if ((nf_calc.at(fn)->m_numTheta!=nf_calc.at(0)->m_numTheta) || (nf_calc.at(fn)->m_numPhi!=nf_calc.at(0)->m_numPhi))
+		{
+			cerr << "nf2ff_calc::AddPlane: Error, all frequencies need to share the same angles" << endl;
+			ok = false;
+		}
+
+	if (ok)
 	{
-		int nP  = (n+1)%3;
-		int nPP = (n+2)%3;
-		// check if a single mirror plane is on
-		if ((m_MirrorType[n]!=MIRROR_OFF) && (m_MirrorType[nP]==MIRROR_OFF) && (m_MirrorType[nPP]==MIRROR_OFF))
+		const float* MirrorPos = nf_calc.at(0)->m_MirrorPos;
+		const int* MirrorType = nf_calc.at(0)->m_MirrorType;
+
+		AddSinglePlane(nf_calc, lines, numLines, E_fields, H_fields, MeshType);
+
+		for (int n=0;n<3;++n)
 		{
-			this->AddMirrorPlane(n, lines, numLines, E_field, H_field, MeshType);
+			int nP  = (n+1)%3;
+			int nPP = (n+2)%3;
+			// check if a single mirror plane is on
+			if ((MirrorType[n]!=MIRROR_OFF) && (MirrorType[nP]==MIRROR_OFF) && (MirrorType[nPP]==MIRROR_OFF))
+			{
+				AddMirrorPlane(n, nf_calc, lines, numLines, E_fields, H_fields, MeshType);
+
+				for (unsigned int i=0;i<numLines[n];++i)
+					lines[n][i] = 2.0*MirrorPos[n] - lines[n][i];
+
+				break;
+			}
+			//check if two planes are on
+			else if ((MirrorType[n]==MIRROR_OFF) && (MirrorType[nP]!=MIRROR_OFF) && (MirrorType[nPP]!=MIRROR_OFF))
+			{
+				AddMirrorPlane(nP, nf_calc, lines, numLines, E_fields, H_fields, MeshType);
+				AddMirrorPlane(nPP, nf_calc, lines, numLines, E_fields, H_fields, MeshType);
+				AddMirrorPlane(nP, nf_calc, lines, numLines, E_fields, H_fields, MeshType);
 
-			for (unsigned int i=0;i<numLines[n];++i)
-				lines[n][i] = 2.0*m_MirrorPos[n] - lines[n][i];
+				for (unsigned int i=0;i<numLines[nPP];++i)
+					lines[nPP][i] = 2.0*MirrorPos[nPP] - lines[nPP][i];
 
-			break;
+				break;
+			}
 		}
-		//check if two planes are on 
-		else if ((m_MirrorType[n]==MIRROR_OFF) && (m_MirrorType[nP]!=MIRROR_OFF) && (m_MirrorType[nPP]!=MIRROR_OFF))
+		// check if all planes are on
+		if ((MirrorType[0]!=MIRROR_OFF) && (MirrorType[1]!=MIRROR_OFF) && (MirrorType[2]!=MIRROR_OFF))
 		{
-			this->AddMirrorPlane(nP, lines, numLines, E_field, H_field, MeshType);
-			this->AddMirrorPlane(nPP, lines, numLines, E_field, H_field, MeshType);
-			this->AddMirrorPlane(nP, lines, numLines, E_field, H_field, MeshType);
-      
-			for (unsigned int i=0;i<numLines[nPP];++i)
-				lines[nPP][i] = 2.0*m_MirrorPos[nPP] - lines[nPP][i];
-			
-			break;
+			AddMirrorPlane(0, nf_calc, lines, numLines, E_fields, H_fields, MeshType);
+			AddMirrorPlane(1, nf_calc, lines, numLines, E_fields, H_fields, MeshType);
+			AddMirrorPlane(0, nf_calc, lines, numLines, E_fields, H_fields, MeshType);
+			AddMirrorPlane(2, nf_calc, lines, numLines, E_fields, H_fields, MeshType);
+			AddMirrorPlane(0, nf_calc, lines, numLines, E_fields, H_fields, MeshType);
+			AddMirrorPlane(1, nf_calc, lines, numLines, E_fields, H_fields, MeshType);
+			AddMirrorPlane(0, nf_calc, lines, numLines, E_fields, H_fields, MeshType);
+
+			for (unsigned int i=0;i<numLines[2];++i)
+				lines[2][i] = 2.0*MirrorPos[2] - lines[2][i];
 		}
 	}
-	// check if all planes are on
-	if ((m_MirrorType[0]!=MIRROR_OFF) && (m_MirrorType[1]!=MIRROR_OFF) && (m_MirrorType[2]!=MIRROR_OFF))
-	{
-		this->AddMirrorPlane(0, lines, numLines, E_field, H_field, MeshType);
-		this->AddMirrorPlane(1, lines, numLines, E_field, H_field, MeshType);
-		this->AddMirrorPlane(0, lines, numLines, E_field, H_field, MeshType);
-		this->AddMirrorPlane(2, lines, numLines, E_field, H_field, MeshType);
-		this->AddMirrorPlane(0, lines, numLines, E_field, H_field, MeshType);
-		this->AddMirrorPlane(1, lines, numLines, E_field, H_field, MeshType);
-		this->AddMirrorPlane(0, lines, numLines, E_field, H_field, MeshType);
-
-		for (unsigned int i=0;i<numLines[2];++i)
-			lines[2][i] = 2.0*m_MirrorPos[2] - lines[2][i];
-
-	}
 
 	//cleanup E- & H-Fields
-	Delete_N_3DArray(E_field,numLines);
-	Delete_N_3DArray(H_field,numLines);
-	return true;
+	for (size_t fn=0;fn<E_fields.size();++fn)
+		Delete_N_3DArray(E_fields.at(fn),numLines);
+	for (size_t fn=0;fn<H_fields.size();++fn)
+		Delete_N_3DArray(H_fields.at(fn),numLines);
+	return ok;
 }
 
-bool nf2ff_calc::AddSinglePlane(float **lines, unsigned int* numLines, complex<float>**** E_field, complex<float>**** H_field, int MeshType)
+bool nf2ff_calc::AddSinglePlane(const vector<nf2ff_calc*> &nf_calc, float **lines, unsigned int* numLines, vector<complex<float>****> &E_fields, vector<complex<float>****> &H_fields, int MeshType)
 {
 	//find normal direction
-	int ny = this->GetNormalDir(numLines);
+	int ny = GetNormalDir(numLines);
 	if (ny<0)
 	{
 		cerr << "nf2ff_calc::AddPlane: Error can't determine normal direction..." << endl;
@@ -366,11 +405,11 @@ bool nf2ff_calc::AddSinglePlane(float **lines, unsigned int* numLines, complex<f
 	int nP  = (ny+1)%3;
 	int nPP = (ny+2)%3;
 
-	complex<float>**** Js = Create_N_3DArray<complex<float> >(numLines);
-	complex<float>**** Ms = Create_N_3DArray<complex<float> >(numLines);
+	// angles, center, mirror and thread settings are shared by all frequencies
+	const nf2ff_calc* nfc = nf_calc.at(0);
 
 	float normDir[3]= {0,0,0};
-	if (lines[ny][0]>=m_centerCoord[ny])
+	if (lines[ny][0]>=nfc->m_centerCoord[ny])
 		normDir[ny]=1;
 	else
 		normDir[ny]=-1;
@@ -408,89 +447,162 @@ bool nf2ff_calc::AddSinglePlane(float **lines, unsigned int* numLines, complex<f
 
 	complex<double> power = 0;
 	double area;
-	for (pos[0]=0; pos[0]<numLines[0]; ++pos[0])
-		for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
-			for (pos[2]=0; pos[2]<numLines[2]; ++pos[2])
-			{
-				area = edge_length_P[pos[nP]]*edge_length_PP[pos[nPP]];
-				power = (E_field[nP][pos[0]][pos[1]][pos[2]]*conj(H_field[nPP][pos[0]][pos[1]][pos[2]]) \
-						 - E_field[nPP][pos[0]][pos[1]][pos[2]]*conj(H_field[nP][pos[0]][pos[1]][pos[2]]));
-				m_radPower += 0.5*area*real(power)*normDir[ny];
-			}
-	unsigned int numAngles[2] = {m_numTheta, m_numPhi};
-
-	// setup multi-threading jobs
-	vector<unsigned int> jpt = AssignJobs2Threads(numLines[nP], m_numThreads, true);
-	m_numThreads = jpt.size();
-	nf2ff_data* thread_data = new nf2ff_data[m_numThreads];
-	m_Barrier = new boost::barrier(m_numThreads+1); // numThread workers + 1 controller
-	unsigned int start=0;
-	unsigned int stop=jpt.at(0)-1;
-	for (unsigned int n=0; n<m_numThreads; n++)
+	for (size_t fn=0;fn<nf_calc.size();++fn)
 	{
-		thread_data[n].ny=ny;
-		thread_data[n].mesh_type = MeshType;
-		thread_data[n].normDir=normDir;
-		thread_data[n].numLines=numLines;
-		thread_data[n].lines=lines;
-		thread_data[n].edge_length_P=edge_length_P;
-		thread_data[n].edge_length_PP=edge_length_PP;
-		thread_data[n].E_field=E_field;
-		thread_data[n].H_field=H_field;
-		thread_data[n].Js=Js;
-		thread_data[n].Ms=Ms;
-		thread_data[n].m_Nt=Create2DArray<complex<double> >(numAngles);
-		thread_data[n].m_Np=Create2DArray<complex<double> >(numAngles);
-		thread_data[n].m_Lt=Create2DArray<complex<double> >(numAngles);
-		thread_data[n].m_Lp=Create2DArray<complex<double> >(numAngles);
-
-		boost::thread *t = new boost::thread( nf2ff_calc_thread(this,start,stop,n,thread_data[n]) );
-
-		m_thread_group.add_thread( t );
-
-		start = stop+1;
-		if (n<m_numThreads-1)
-			stop = start + jpt.at(n+1)-1;
+		complex<float>**** E_field = E_fields.at(fn);
+		complex<float>**** H_field = H_fields.at(fn);
+		for (pos[0]=0; pos[0]<numLines[0]; ++pos[0])
+			for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
+				for (pos[2]=0; pos[2]<numLines[2]; ++pos[2])
+				{
+					area = edge_length_P[pos[nP]]*edge_length_PP[pos[nPP]];
+					power = (E_field[nP][pos[0]][pos[1]][pos[2]]*conj(H_field[nPP][pos[0]][pos[1]][pos[2]]) \
+							 - E_field[nPP][pos[0]][pos[1]][pos[2]]*conj(H_field[nP][pos[0]][pos[1]][pos[2]]));
+					nf_calc.at(fn)->m_radPower += 0.5*area*real(power)*normDir[ny];
+				}
 	}
-	//all threads a running and waiting for the barrier
 
-	m_Barrier->wait(); //start
+	float center[3] = {nfc->m_centerCoord[0],nfc->m_centerCoord[1],nfc->m_centerCoord[2]};
+	if (MeshType==1)
+	{
+		center[0] = nfc->m_centerCoord[0]*cos(nfc->m_centerCoord[1]);
+		center[1] = nfc->m_centerCoord[0]*sin(nfc->m_centerCoord[1]);
+	}
 
-	// threads: calc Js and Ms (eq. 8.15a/b)
-	// threads calc their local Nt,Np,Lt and Lp
+	// setup the surface points, currents and directions in SoA layout, the padded points have zero currents
+	nf2ff_data data;
+	data.numPoints = (numLines[nP]*numLines[nPP]+NF2FF_POINT_BLOCK-1)/NF2FF_POINT_BLOCK*NF2FF_POINT_BLOCK;
+	data.numFreq = nf_calc.size();
+	data.numAngles = nfc->m_numTheta*nfc->m_numPhi;
+	for (int n=0;n<3;++n)
+	{
+		data.coords[n] = (float*)AllocArrayData(sizeof(float)*data.numPoints);
+		data.dir[n] = new float[data.numAngles];
+	}
+	data.k = new float[data.numFreq];
+	data.currents = (float*)AllocArrayData(sizeof(float)*NF2FF_NUM_CURRENTS*data.numPoints*data.numFreq);
+	data.sums = (double*)AllocArrayData(sizeof(double)*NF2FF_NUM_CURRENTS*data.numAngles*data.numFreq);
 
-	m_Barrier->wait(); //combine all thread local Nt,Np,Lt and Lp
+	for (size_t fn=0;fn<nf_calc.size();++fn)
+		data.k[fn] = 2*M_PI*nf_calc.at(fn)->m_freq/__C0__*sqrt(nf_calc.at(fn)->m_permittivity*nf_calc.at(fn)->m_permeability);
 
-	complex<float>** Nt = Create2DArray<complex<float> >(numAngles);
-	complex<float>** Np = Create2DArray<complex<float> >(numAngles);
-	complex<float>** Lt = Create2DArray<complex<float> >(numAngles);
-	complex<float>** Lp = Create2DArray<complex<float> >(numAngles);
+	for (unsigned int tn=0;tn<nfc->m_numTheta;++tn)
+		for (unsigned int pn=0;pn<nfc->m_numPhi;++pn)
+		{
+			unsigned int a = tn*nfc->m_numPhi+pn;
+			data.dir[0][a] = sin(nfc->m_theta[tn])*cos(nfc->m_phi[pn]);
+			data.dir[1][a] = sin(nfc->m_theta[tn])*sin(nfc->m_phi[pn]);
+			data.dir[2][a] = cos(nfc->m_theta[tn]);
+		}
 
-	for (unsigned int n=0; n<m_numThreads; n++)
-	{
-		for (unsigned int tn=0;tn<m_numTheta;++tn)
-			for (unsigned int pn=0;pn<m_numPhi;++pn)
+	// calc Js and Ms (eq. 8.15a/b)
+	complex<float> Js[3], Ms[3], J_r, M_r;
+	float cos_a=1, sin_a=0;
+	unsigned int idx=0;
+	pos[ny]=0;
+	for (pos[nP]=0; pos[nP]<numLines[nP]; ++pos[nP])
+		for (pos[nPP]=0; pos[nPP]<numLines[nPP]; ++pos[nPP], ++idx)
+		{
+			if (MeshType==1)
 			{
-				Nt[tn][pn] += thread_data[n].m_Nt[tn][pn];
-				Np[tn][pn] += thread_data[n].m_Np[tn][pn];
-				Lt[tn][pn] += thread_data[n].m_Lt[tn][pn];
-				Lp[tn][pn] += thread_data[n].m_Lp[tn][pn];
+				cos_a = cos(lines[1][pos[1]]);
+				sin_a = sin(lines[1][pos[1]]);
+				data.coords[0][idx] = lines[0][pos[0]]*cos_a - center[0];
+				data.coords[1][idx] = lines[0][pos[0]]*sin_a - center[1];
+				data.coords[2][idx] = lines[2][pos[2]] - center[2];
+			}
+			else
+				for (int n=0;n<3;++n)
+					data.coords[n][idx] = lines[n][pos[n]] - center[n];
+
+			area = edge_length_P[pos[nP]]*edge_length_PP[pos[nPP]];
+			for (size_t fn=0;fn<nf_calc.size();++fn)
+			{
+				complex<float>**** E_field = E_fields.at(fn);
+				complex<float>**** H_field = H_fields.at(fn);
+
+				// Js =  n x H
+				Js[0] = normDir[1]*H_field[2][pos[0]][pos[1]][pos[2]] - normDir[2]*H_field[1][pos[0]][pos[1]][pos[2]];
+				Js[1] = normDir[2]*H_field[0][pos[0]][pos[1]][pos[2]] - normDir[0]*H_field[2][pos[0]][pos[1]][pos[2]];
+				Js[2] = normDir[0]*H_field[1][pos[0]][pos[1]][pos[2]] - normDir[1]*H_field[0][pos[0]][pos[1]][pos[2]];
+
+				// Ms = -n x E
+				Ms[0] = normDir[2]*E_field[1][pos[0]][pos[1]][pos[2]] - normDir[1]*E_field[2][pos[0]][pos[1]][pos[2]];
+				Ms[1] = normDir[0]*E_field[2][pos[0]][pos[1]][pos[2]] - normDir[2]*E_field[0][pos[0]][pos[1]][pos[2]];
+				Ms[2] = normDir[1]*E_field[0][pos[0]][pos[1]][pos[2]] - normDir[0]*E_field[1][pos[0]][pos[1]][pos[2]];
+
+				//transform to cartesian coordinates
+				if (MeshType==1)
+				{
+					J_r = Js[0];
+					Js[0] = J_r*cos_a - Js[1]*sin_a;
+					Js[1] = J_r*sin_a + Js[1]*cos_a;
+					M_r = Ms[0];
+					Ms[0] = M_r*cos_a - Ms[1]*sin_a;
+					Ms[1] = M_r*sin_a + Ms[1]*cos_a;
+				}
+
+				float* curr = data.currents + fn*NF2FF_NUM_CURRENTS*data.numPoints + idx;
+				for (int n=0;n<3;++n)
+				{
+					curr[(2*n  )*data.numPoints] = area*real(Js[n]);
+					curr[(2*n+1)*data.numPoints] = area*imag(Js[n]);
+					curr[(2*n+6)*data.numPoints] = area*real(Ms[n]);
+					curr[(2*n+7)*data.numPoints] = area*imag(Ms[n]);
+				}
 			}
-		Delete2DArray(thread_data[n].m_Nt,numAngles);
-		Delete2DArray(thread_data[n].m_Np,numAngles);
-		Delete2DArray(thread_data[n].m_Lt,numAngles);
-		Delete2DArray(thread_data[n].m_Lp,numAngles);
+		}
+
+	if (nfc->m_Accuracy>0)
+	{
+		unsigned int numSurfLines[2] = {numLines[nP], numLines[nPP]};
+		nf2ff_aggregation aggr(data, numSurfLines, nfc->m_Accuracy, nfc->m_numThreads);
+		aggr.CalcSums(nfc->m_theta, nfc->m_numTheta, nfc->m_phi, nfc->m_numPhi);
+
+		// check the fast far-field against the direct calculation
+		vector<double> deviation = aggr.Validate(NF2FF_NUM_VALIDATION_ANGLES);
+		for (size_t fn=0;fn<nf_calc.size();++fn)
+		{
+			nf_calc.at(fn)->m_MaxDeviation = max(nf_calc.at(fn)->m_MaxDeviation, deviation.at(fn));
+			if (deviation.at(fn)>nfc->m_Accuracy)
+				cerr << "nf2ff_calc::AddPlane: Warning, the fast far-field deviation of " << deviation.at(fn) << " at f=" << nf_calc.at(fn)->m_freq << "Hz exceeds the requested accuracy of " << nfc->m_Accuracy << endl;
+		}
+	}
+	else
+	{
+		// setup multi-threading jobs, each thread calculates the sums of a range of angles
+		vector<unsigned int> jpt = AssignJobs2Threads(data.numAngles, nfc->m_numThreads, true);
+		boost::thread_group threads;
+		unsigned int start=0;
+		for (size_t n=0; n<jpt.size(); n++)
+		{
+			threads.add_thread( new boost::thread( nf2ff_calc_thread(start,start+jpt.at(n)-1,data) ) );
+			start += jpt.at(n);
+		}
+		threads.join_all(); // wait for termination
 	}
 
-	m_Barrier->wait(); //wait for termination
-	m_thread_group.join_all(); // wait for termination
-	delete m_Barrier;
-	m_Barrier = NULL;
+	for (size_t fn=0;fn<nf_calc.size();++fn)
+		nf_calc.at(fn)->AddFarField(data.sums + fn*NF2FF_NUM_CURRENTS*data.numAngles);
 
-	//cleanup Js & Ms
-	Delete_N_3DArray(Js,numLines);
-	Delete_N_3DArray(Ms,numLines);
+	//cleanup
+	for (int n=0;n<3;++n)
+	{
+		FreeArrayData(data.coords[n]);
+		delete[] data.dir[n];
+	}
+	delete[] data.k;
+	FreeArrayData(data.currents);
+	FreeArrayData(data.sums);
+	delete[] edge_length_P; edge_length_P=NULL;
+	delete[] edge_length_PP; edge_length_PP=NULL;
 
+	return true;
+}
+
+void nf2ff_calc::AddFarField(const double* sums)
+{
+	// calc Nt,Np,Lt and Lp from the current sums
 	// calc equations 8.23a/b and 8.24a/b
 	float k = 2*M_PI*m_freq/__C0__*sqrt(m_permittivity*m_permeability);
 	complex<float> factor(0,k/4.0/M_PI/m_radius);
@@ -499,30 +611,37 @@ bool nf2ff_calc::AddSinglePlane(float **lines, unsigned int* numLines, complex<f
 	float fZ0 = __Z0__ * sqrt(m_permeability/m_permittivity);
 	complex<float> Z0 = fZ0;
 	float P_max = 0;
+	float sinT,sinP;
+	float cosP,cosT;
+	complex<float> Nt,Np,Lt,Lp;
+	complex<float> S[NF2FF_NUM_CURRENTS/2];
 	for (unsigned int tn=0;tn<m_numTheta;++tn)
 		for (unsigned int pn=0;pn<m_numPhi;++pn)
 		{
-			m_E_theta[tn][pn] -= factor*(Lp[tn][pn] + Z0*Nt[tn][pn]);
-			m_E_phi[tn][pn] += factor*(Lt[tn][pn] - Z0*Np[tn][pn]);
+			const double* sum = sums + (tn*m_numPhi+pn)*NF2FF_NUM_CURRENTS;
+			for (int n=0;n<NF2FF_NUM_CURRENTS/2;++n)
+				S[n] = complex<float>(sum[2*n],sum[2*n+1]);
+
+			sinT = sin(m_theta[tn]);
+			sinP = sin(m_phi[pn]);
+			cosT = cos(m_theta[tn]);
+			cosP = cos(m_phi[pn]);
 
-			m_H_theta[tn][pn] += factor*(Np[tn][pn] - Lt[tn][pn]/Z0);
-			m_H_phi[tn][pn] -= factor*(Nt[tn][pn] + Lp[tn][pn]/Z0);
+			Nt = S[0]*cosT*cosP + S[1]*cosT*sinP - S[2]*sinT;
+			Np = S[1]*cosP - S[0]*sinP;
+			Lt = S[3]*cosT*cosP + S[4]*cosT*sinP - S[5]*sinT;
+			Lp = S[4]*cosP - S[3]*sinP;
+
+			m_E_theta[tn][pn] -= factor*(Lp + Z0*Nt);
+			m_E_phi[tn][pn] += factor*(Lt - Z0*Np);
+
+			m_H_theta[tn][pn] += factor*(Np - Lt/Z0);
+			m_H_phi[tn][pn] -= factor*(Nt + Lp/Z0);
 
 			m_P_rad[tn][pn] = abs((m_E_theta[tn][pn]*conj(m_E_theta[tn][pn])+m_E_phi[tn][pn]*conj(m_E_phi[tn][pn])))/(2*fZ0);
 			if (m_P_rad[tn][pn]>P_max)
 				P_max = m_P_rad[tn][pn];
 		}
 
-	//cleanup Nx and Lx
-	Delete2DArray(Nt,numAngles);
-	Delete2DArray(Np,numAngles);
-	Delete2DArray(Lt,numAngles);
-	Delete2DArray(Lp,numAngles);
-	delete[] edge_length_P; edge_length_P=NULL;
-	delete[] edge_length_PP; edge_length_PP=NULL;
-	delete[] thread_data; thread_data=NULL;
-
 	m_maxDir = 4*M_PI*P_max / m_radPower;
-
-	return true;
 }
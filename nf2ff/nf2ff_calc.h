@@ -26,54 +26,62 @@
 #include <boost/thread.hpp>
 #define _USE_MATH_DEFINES
 
-class nf2ff_calc;
+#include "../tools/array_ops.h"
 
 #define MIRROR_OFF 0
 #define MIRROR_PEC 1
 #define MIRROR_PMC 2
 
+//! number of surface points processed as one cache block, has to be a multiple of the widest vector width (16)
+#define NF2FF_POINT_BLOCK 256
+//! number of angles sharing a cache block of surface points
+#define NF2FF_ANGLE_BLOCK 64
+//! number of currents stored per surface point and frequency: real and imaginary part of Jx,Jy,Jz,Mx,My,Mz
+#define NF2FF_NUM_CURRENTS 12
+//! number of angles used to check the fast far-field against the direct calculation
+#define NF2FF_NUM_VALIDATION_ANGLES 64
+
 // data structure to exchange data between thread-controller and worker-threads
 typedef struct
 {
-	//local working data IN
-	int ny;
-	int mesh_type;
-	float* normDir;
-	unsigned int* numLines;
-	float **lines;
-	float* edge_length_P;
-	float* edge_length_PP;
-
-	std::complex<float>**** E_field;
-	std::complex<float>**** H_field;
-	std::complex<float>**** Js;
-	std::complex<float>**** Ms;
-
-	//local working data OUT
-	std::complex<double>** m_Nt;
-	std::complex<double>** m_Np;
-	std::complex<double>** m_Lt;
-	std::complex<double>** m_Lp;
-
+	//working data IN, all arrays in SoA layout
+	unsigned int numPoints; // number of surface points, padded to a multiple of NF2FF_POINT_BLOCK
+	float* coords[3];       // cartesian coordinates of all surface points relative to the center
+	unsigned int numFreq;
+	float* k;               // wave number of every frequency
+	float* currents;        // area weighted cartesian Js and Ms, NF2FF_NUM_CURRENTS arrays of numPoints for every frequency
+	unsigned int numAngles;
+	float* dir[3];          // direction cosines of all (theta,phi) angles, phi is the fast index
+
+	//working data OUT
+	double* sums;           // phase weighted sum of the currents, NF2FF_NUM_CURRENTS values for every frequency and angle
 } nf2ff_data;
 
+/*!
+  Calculate the radiation integral of a range of angles for all surface points and frequencies.
+  The angles are processed in blocks of NF2FF_ANGLE_BLOCK, each sweeping the surface points in cache blocks of NF2FF_POINT_BLOCK.
+  The currents of a point block are loaded once per frequency and reused for all angles of the block.
+  The phase terms are evaluated using the widest vector width supported by the cpu (see GetCPUVectorWidth()).
+  */
 class nf2ff_calc_thread
 {
 public:
-	nf2ff_calc_thread(nf2ff_calc* nfc, unsigned int start, unsigned int stop, unsigned int threadID, nf2ff_data &data);
+	nf2ff_calc_thread(unsigned int start, unsigned int stop, const nf2ff_data &data);
 	void operator()();
 
 protected:
-	unsigned int m_start, m_stop, m_threadID;
-	nf2ff_calc *m_nf_calc;
-
+	unsigned int m_start, m_stop;
 	nf2ff_data m_data;
+
+	template <class VEC> void CalcSums();
+#ifdef ENABLE_WIDE_VECTORS
+	void CalcSums_AVX();
+	void CalcSums_AVX512();
+#endif
 };
 
 class nf2ff_calc
 {
-	// allow full data access to nf2ff_calc_thread class
-	friend class nf2ff_calc_thread;
 public:
 	nf2ff_calc(float freq, std::vector<float> theta, std::vector<float> phi, std::vector<float> center);
 	~nf2ff_calc();
@@ -92,9 +100,21 @@ public:
 	unsigned int GetNumThreads() const {return m_numThreads;}
 	void SetNumThreads(unsigned int n) {m_numThreads=n;}
 
+	//! Use the fast multilevel aggregation with the given accuracy relative to the pattern maximum, 0 uses the direct calculation (default) \sa nf2ff_aggregation
+	void SetAccuracy(float accuracy) {m_Accuracy=accuracy;}
+	float GetAccuracy() const {return m_Accuracy;}
+	//! Get the maximum deviation of the fast far-field from the direct calculation, checked on a subset of angles of every plane
+	double GetMaxDeviation() const {return m_MaxDeviation;}
+
 	void SetMirror(int type, int dir, float pos);
 
+	//! Add a plane of E- and H-fields, takes ownership of the fields
 	bool AddPlane(float **lines, unsigned int* numLines, std::complex<float>**** E_field, std::complex<float>**** H_field, int MeshType=0);
+	/*!
+	  Add a plane of E- and H-fields for multiple frequencies in a single pass, takes ownership of all fields.
+	  All \a nf_calc (one per field) have to share the same angles, center, mirror and thread settings.
+	  */
+	static bool AddPlane(const std::vector<nf2ff_calc*> &nf_calc, float **lines, unsigned int* numLines, std::vector<std::complex<float>****> E_fields, std::vector<std::complex<float>****> H_fields, int MeshType=0);
 
 protected:
 	float m_freq;
@@ -118,19 +138,23 @@ protected:
 	float* m_theta;
 	float* m_phi;
 
+	float m_Accuracy;
+	double m_MaxDeviation;
+
 	//mirror settings
 	bool m_EnableMirror;
 	int m_MirrorType[3];
 	float m_MirrorPos[3];
 
-	int GetNormalDir(unsigned int* numLines);
-	bool AddSinglePlane(float **lines, unsigned int* numLines, std::complex<float>**** E_field, std::complex<float>**** H_field, int MeshType=0);
-	bool AddMirrorPlane(int n, float **lines, unsigned int* numLines, std::complex<float>**** E_field, std::complex<float>**** H_field, int MeshType=0);
+	static int GetNormalDir(unsigned int* numLines);
+	static bool AddSinglePlane(const std::vector<nf2ff_calc*> &nf_calc, float **lines, unsigned int* numLines, std::vector<std::complex<float>****> &E_fields, std::vector<std::complex<float>****> &H_fields, int MeshType=0);
+	static bool AddMirrorPlane(int n, const std::vector<nf2ff_calc*> &nf_calc, float **lines, unsigned int* numLines, std::vector<std::complex<float>****> &E_fields, std::vector<std::complex<float>****> &H_fields, int MeshType=0);
+
+	//! Add the far-field of the phase weighted current sums (NF2FF_NUM_CURRENTS per angle) of a single plane
+	void AddFarField(const double* sums);
 
 	//boost multi-threading
 	unsigned int m_numThreads;
-	boost::thread_group m_thread_group;
-	boost::barrier *m_Barrier;
 };
 
 
@@ -19,6 +19,8 @@
 #include <iomanip>
 #include <iostream>
 #include <fstream>
+#include <csignal>
+#include <cstring>
 #include "tools/array_ops.h"
 #include "tools/useful.h"
 #include "FDTD/operator_cylinder.h"
@@ -29,6 +31,7 @@
 #include "FDTD/extensions/operator_ext_tfsf.h"
 #include "FDTD/extensions/operator_ext_mur_abc.h"
 #include "FDTD/extensions/operator_ext_upml.h"
+#include "FDTD/extensions/operator_ext_cpml.h"
 #include "FDTD/extensions/operator_ext_lorentzmaterial.h"
 #include "FDTD/extensions/operator_ext_conductingsheet.h"
 #include "FDTD/extensions/operator_ext_steadystate.h"
@@ -42,6 +45,7 @@
 #include "Common/processfields_td.h"
 #include "Common/processfields_fd.h"
 #include "Common/processfields_sar.h"
+#include "Common/processnf2ff.h"
 #include <hdf5.h>            // only for H5get_libversion()
 #include <boost/version.hpp> // only for BOOST_LIB_VERSION
 #include <vtkVersion.h>
@@ -81,6 +85,18 @@ openEMS::openEMS()
 
 	m_engine = EngineType_Multithreaded; //default engine type
 	m_engine_numThreads = 0;
+	m_engine_TB_NumTS = 0;
+	m_engine_NeighbourSync = false;
+	m_engine_FusedUpdates = false;
+	m_engine_FullBarriers = false;
+	m_engine_NUMA = false;
+	m_ProbeBatching = false;
+	m_BinaryProbes = false;
+	m_engine_HalfPrecision = 0;
+	m_engine_HalfValidation = false;
+	m_OpCompressTolerance = 0;
+	m_CheckpointInterval = 0;
+	m_Restart = false;
 
 	m_Abort = false;
 	m_Exc = 0;
@@ -96,6 +112,8 @@ openEMS::openEMS()
 		m_PML_size[n] = 8;
 		m_Mur_v_ph[n] = 0;
 	}
+	m_CPML_KappaMax = 1;
+	m_CPML_AlphaMax = 0;
 }
 
 openEMS::~openEMS()
@@ -116,6 +134,9 @@ void openEMS::Reset()
 	m_CSX=0;
 	delete m_Exc;
 	m_Exc=0;
+	for (size_t n=0; n<m_NF2FF_Settings.size(); ++n)
+		delete m_NF2FF_Settings.at(n);
+	m_NF2FF_Settings.clear();
 }
 
 void openEMS::showUsage()
@@ -135,11 +156,27 @@ void openEMS::showUsage()
 	cout << "\t\t--engine=sse-compressed\t\tengine using compressed operator + sse vector extensions" << endl;
 #ifdef MPI_SUPPORT
 	cout << "\t\t--engine=MPI\t\t\tengine using compressed operator + sse vector extensions + MPI parallel processing" << endl;
-	cout << "\t\t--engine=multithreaded\t\tengine using compressed operator + sse vector extensions + MPI + multithreading" << endl;
+	cout << "\t\t--engine=multithreaded\t\tengine using compressed operator + sse vector extensions + MPI + multithreading (blocking MPI transfers, only --engine=MPI overlaps them with the update)" << endl;
 #else
 	cout << "\t\t--engine=multithreaded\t\tengine using compressed operator + sse vector extensions + multithreading" << endl;
 #endif
 	cout << "\t--numThreads=<n>\tForce use n threads for multithreaded engine (needs: --engine=multithreaded)" << endl;
+	cout << "\t--temporalBlocking=<n>\tAdvance n timesteps per sweep through the mesh for better cache usage (needs: --engine=multithreaded)" << endl;
+	cout << "\t--neighbourSync\t\tSynchronize the threads with their neighbours only, instead of using global barriers (needs: --engine=multithreaded)" << endl;
+	cout << "\t--fusedUpdates\t\tApply boundary conditions and excitations plane by plane within the engine sweep (needs: --engine=multithreaded)" << endl;
+	cout << "\t--fullBarriers\t\tSynchronize the threads before every extension update, without eliding barriers (needs: --engine=multithreaded)" << endl;
+	cout << "\t--hugePages[=thp|hugetlb]\tBack the large field and operator arrays with huge pages (default: thp)" << endl;
+	cout << "\t--halfPrecision=<fp16|bf16>\tStore the fields as 16 bit floats, computing in single precision (multithreaded engine)" << endl;
+	cout << "\t--validateHalfPrecision\tRun a single threaded single precision engine alongside the half precision engine (much slower)" << endl;
+	cout << "\t\t\t\tand report the energy and maximum field deviation every 100 timesteps (a full-field proxy, the probes are not compared)" << endl;
+	cout << "\t--operatorCache=<dir>\tStore the operator in <dir> and reuse it for runs with identical geometry, mesh and settings" << endl;
+	cout << "\t--compressionTolerance=<tol>\tMerge operator coefficients differing by less than the relative tolerance <tol> (compressed engines)" << endl;
+	cout << "\t--checkpoint[=<n>]\tWrite a checkpoint on SIGTERM/SIGINT and every <n> timesteps (default file: " << __OPENEMS_CHECKPOINT_FILE__ << ")" << endl;
+	cout << "\t--checkpointFile=<file>\tWrite the checkpoints to <file>" << endl;
+	cout << "\t--restart\t\tResume the simulation from the last checkpoint" << endl;
+	cout << "\t--numa\t\t\tPin the engine threads to cpus and place their data on the local NUMA node (needs: --engine=multithreaded)" << endl;
+	cout << "\t--batchProbes\t\tEvaluate all voltage, current, field and mode matching probes in a single multithreaded pass" << endl;
+	cout << "\t--binaryProbes\t\tWrite the probe files in a buffered binary format instead of ASCII" << endl;
 	cout << "\t--no-simulation\t\tonly run preprocessing; do not simulate" << endl;
 	cout << "\t--dump-statistics\tdump simulation statistics to '" << __OPENEMS_RUN_STAT_FILE__ << "' and '" << __OPENEMS_STAT_FILE__ << "'" << endl;
 	cout << "\n\t Additional global arguments " << endl;
@@ -221,6 +258,117 @@ bool openEMS::parseCommandLineArgument( const char *argv )
 		cout << "openEMS - fixed number of threads: " << m_engine_numThreads << endl;
 		return true;
 	}
+	else if (strncmp(argv,"--temporalBlocking=",19)==0)
+	{
+		this->SetTemporalBlocking(atoi(argv+19));
+		cout << "openEMS - temporal blocking with " << m_engine_TB_NumTS << " timesteps per block" << endl;
+		return true;
+	}
+	else if (strcmp(argv,"--neighbourSync")==0)
+	{
+		cout << "openEMS - enabled neighbour synchronization" << endl;
+		this->SetNeighbourSync(true);
+		return true;
+	}
+	else if (strcmp(argv,"--fusedUpdates")==0)
+	{
+		cout << "openEMS - enabled fused updates" << endl;
+		this->SetFusedUpdates(true);
+		return true;
+	}
+	else if (strcmp(argv,"--fullBarriers")==0)
+	{
+		cout << "openEMS - enabled full barriers" << endl;
+		this->SetFullBarriers(true);
+		return true;
+	}
+	else if (strcmp(argv,"--hugePages")==0 || strcmp(argv,"--hugePages=thp")==0)
+	{
+		cout << "openEMS - enabled transparent huge pages" << endl;
+		this->SetHugePages(HUGEPAGES_THP);
+		return true;
+	}
+	else if (strcmp(argv,"--hugePages=hugetlb")==0)
+	{
+		cout << "openEMS - enabled hugetlbfs pages" << endl;
+		this->SetHugePages(HUGEPAGES_HUGETLB);
+		return true;
+	}
+	else if (strcmp(argv,"--halfPrecision=fp16")==0)
+	{
+		cout << "openEMS - enabled half float field storage" << endl;
+		this->SetHalfPrecision(Operator_SSE_Compressed::HALF_FP16);
+		return true;
+	}
+	else if (strcmp(argv,"--halfPrecision=bf16")==0)
+	{
+		cout << "openEMS - enabled bfloat16 field storage" << endl;
+		this->SetHalfPrecision(Operator_SSE_Compressed::HALF_BF16);
+		return true;
+	}
+	else if (strcmp(argv,"--validateHalfPrecision")==0)
+	{
+		cout << "openEMS - enabled half precision validation" << endl;
+		this->SetHalfPrecisionValidation(true);
+		return true;
+	}
+	else if (strncmp(argv,"--operatorCache=",16)==0)
+	{
+		this->SetOperatorCache(argv+16);
+		cout << "openEMS - using operator cache directory: " << m_OpCacheDir << endl;
+		return true;
+	}
+	else if (strncmp(argv,"--compressionTolerance=",23)==0)
+	{
+		this->SetCompressionTolerance(atof(argv+23));
+		cout << "openEMS - operator compression tolerance: " << m_OpCompressTolerance << endl;
+		return true;
+	}
+	else if (strcmp(argv,"--checkpoint")==0)
+	{
+		if (m_CheckpointFile.empty())
+			m_CheckpointFile = __OPENEMS_CHECKPOINT_FILE__;
+		cout << "openEMS - enabled checkpoints on termination signals" << endl;
+		return true;
+	}
+	else if (strncmp(argv,"--checkpoint=",13)==0)
+	{
+		if (m_CheckpointFile.empty())
+			m_CheckpointFile = __OPENEMS_CHECKPOINT_FILE__;
+		m_CheckpointInterval = atoi(argv+13);
+		cout << "openEMS - enabled checkpoints every " << m_CheckpointInterval << " timesteps" << endl;
+		return true;
+	}
+	else if (strncmp(argv,"--checkpointFile=",17)==0)
+	{
+		m_CheckpointFile = argv+17;
+		cout << "openEMS - using checkpoint file: " << m_CheckpointFile << endl;
+		return true;
+	}
+	else if (strcmp(argv,"--restart")==0)
+	{
+		cout << "openEMS - resuming from the last checkpoint" << endl;
+		this->SetRestart(true);
+		return true;
+	}
+	else if (strcmp(argv,"--numa")==0)
+	{
+		cout << "openEMS - enabled NUMA placement" << endl;
+		this->SetNUMA(true);
+		return true;
+	}
+	else if (strcmp(argv,"--batchProbes")==0)
+	{
+		cout << "openEMS - enabled batched probes" << endl;
+		this->SetProbeBatching(true);
+		return true;
+	}
+	else if (strcmp(argv,"--binaryProbes")==0)
+	{
+		cout << "openEMS - enabled binary probe files" << endl;
+		this->SetBinaryProbes(true);
+		return true;
+	}
 	else if (strcmp(argv,"--engine=fastest")==0)
 	{
 		cout << "openEMS - enabled multithreading engine" << endl;
@@ -306,13 +454,15 @@ bool openEMS::SetupBoundaryConditions()
 				op_ext_mur->SetPhaseVelocity(m_Mur_v_ph[n]);
 			FDTD_Op->AddExtension(op_ext_mur);
 		}
-		if (m_BC_type[n]==3)
+		if ((m_BC_type[n]==3) || (m_BC_type[n]==4))
 			FDTD_Op->SetBCSize(n, m_PML_size[n]);
 	}
 
 
 	//create the upml
 	Operator_Ext_UPML::Create_UPML(FDTD_Op, m_BC_type, m_PML_size, string());
+	//create the cpml
+	Operator_Ext_CPML::Create_CPML(FDTD_Op, m_BC_type, m_PML_size, string(), m_CPML_KappaMax, m_CPML_AlphaMax);
 
 	return true;
 }
@@ -348,6 +498,26 @@ Engine_Interface_FDTD* openEMS::NewEngineInterface(int multigridlevel)
 	return new Engine_Interface_FDTD(FDTD_Op);
 }
 
+void openEMS::SetHugePages(int mode)
+{
+	if ((mode<HUGEPAGES_OFF) || (mode>HUGEPAGES_HUGETLB))
+	{
+		cerr << "openEMS::SetHugePages: Warning, unknown huge page mode " << mode << ", disabling huge pages..." << endl;
+		mode = HUGEPAGES_OFF;
+	}
+	SetHugePageMode((HugePageMode)mode);
+}
+
+void openEMS::SetHalfPrecision(int type)
+{
+	if ((type<Operator_SSE_Compressed::HALF_NONE) || (type>Operator_SSE_Compressed::HALF_BF16))
+	{
+		cerr << "openEMS::SetHalfPrecision: Warning, unknown half precision type " << type << ", using single precision..." << endl;
+		type = Operator_SSE_Compressed::HALF_NONE;
+	}
+	m_engine_HalfPrecision = type;
+}
+
 void openEMS::SetVerboseLevel(int level)
 {
     g_settings.SetVerboseLevel(level);
@@ -361,6 +531,7 @@ bool openEMS::SetupProcessing()
 
 	unsigned int Nyquist = FDTD_Op->GetExcitationSignal()->GetNyquistNum();
 	PA = new ProcessingArray(Nyquist);
+	PA->SetIntegralBatching(m_ProbeBatching);
 
 	double start[3];
 	double stop[3];
@@ -438,6 +609,7 @@ bool openEMS::SetupProcessing()
 					if (g_settings.showProbeDiscretization())
 						proc->ShowSnappedCoords();
 					proc->SetWeight(pb->GetWeighting());
+					proc->SetBinaryOutput(m_BinaryProbes);
 					PA->AddProcessing(proc);
 					prim->SetPrimitiveUsed(true);
 				}
@@ -447,10 +619,27 @@ bool openEMS::SetupProcessing()
 		}
 	}
 
+	// in-solver nf2ff transformations, their dump boxes are accumulated in memory instead of being written to files
+	vector<ProcessNF2FF*> NF2FF_Procs;
+	for (size_t n=0; n<m_NF2FF_Settings.size(); ++n)
+	{
+		ProcessNF2FF* procNF2FF = new ProcessNF2FF(NewEngineInterface());
+		if (procNF2FF->ReadXML(m_NF2FF_Settings.at(n))==false)
+		{
+			cerr << "openEMS::SetupProcessing: Error, invalid nf2ff settings... skipping!" << endl;
+			delete procNF2FF;
+			continue;
+		}
+		if (CylinderCoords)
+			procNF2FF->SetMeshType(Processing::CYLINDRICAL_MESH);
+		NF2FF_Procs.push_back(procNF2FF);
+	}
+
 	vector<CSProperties*> DumpProps = m_CSX->GetPropertyByType(CSProperties::DUMPBOX);
 	for (size_t i=0; i<DumpProps.size(); ++i)
 	{
 		ProcessFields* ProcField=NULL;
+		ProcessNF2FF* procNF2FF=NULL;
 
 		//check whether one or more probe boxes are defined
 		l_MultiBox =  (DumpProps.at(i)->GetQtyPrimitives()>1);
@@ -472,7 +661,18 @@ bool openEMS::SetupProcessing()
 				CSPropDumpBox* db = DumpProps.at(i)->ToDumpBox();
 				if (db)
 				{
-					if ((db->GetDumpType()>=0) && (db->GetDumpType()<=5))
+					for (size_t n=0; n<NF2FF_Procs.size(); ++n)
+						if (NF2FF_Procs.at(n)->UsesDumpBox(db->GetName()))
+							procNF2FF = NF2FF_Procs.at(n);
+					if (procNF2FF && ((db->GetDumpType()%10)>1 || (db->GetDumpType()>=20)))
+					{
+						cerr << "openEMS::SetupProcessing: Warning, the nf2ff dump box \"" << db->GetName() << "\" is not an E- or H-field dump... skipping!" << endl;
+						procNF2FF = NULL;
+					}
+
+					if (procNF2FF)
+						ProcField = new ProcessFieldsFD(NewEngineInterface(db->GetMultiGridLevel()));
+					else if ((db->GetDumpType()>=0) && (db->GetDumpType()<=5))
 						ProcField = new ProcessFieldsTD(NewEngineInterface(db->GetMultiGridLevel()));
 					else if ((db->GetDumpType()>=10) && (db->GetDumpType()<=15))
 						ProcField = new ProcessFieldsFD(NewEngineInterface(db->GetMultiGridLevel()));
@@ -500,7 +700,13 @@ bool openEMS::SetupProcessing()
 							//make dualMesh the default mesh for h-field dumps, maybe overwritten by interpolation type (node-interpolation)
 							ProcField->SetDualMesh(true);
 						}
-						if (db->GetDumpType()>=10)
+						if (procNF2FF)
+						{
+							vector<double> freq = procNF2FF->GetFrequencies();
+							ProcField->AddFrequency(&freq);
+							ProcField->SetDumpType((ProcessFields::DumpType)(db->GetDumpType()%10));
+						}
+						else if (db->GetDumpType()>=10)
 						{
 							ProcField->AddFrequency(db->GetFDSamples());
 							ProcField->SetDumpType((ProcessFields::DumpType)(db->GetDumpType()-10));
@@ -545,7 +751,14 @@ bool openEMS::SetupProcessing()
 						ProcField->DefineStartStopCoord(start,stop);
 						if (g_settings.showProbeDiscretization())
 							ProcField->ShowSnappedCoords();
-						PA->AddProcessing(ProcField);
+						if (procNF2FF)
+						{
+							ProcField->SetFileType(ProcessFields::NO_FILETYPE);
+							if (procNF2FF->AddPlane(db->GetName(), nb, (ProcessFieldsFD*)ProcField)==false)
+								delete ProcField;
+						}
+						else
+							PA->AddProcessing(ProcField);
 						prim->SetPrimitiveUsed(true);
 					}
 				}
@@ -553,6 +766,12 @@ bool openEMS::SetupProcessing()
 		}
 	}
 
+	for (size_t n=0; n<NF2FF_Procs.size(); ++n)
+	{
+		NF2FF_Procs.at(n)->SetEnable(Enable_Dumps);
+		PA->AddProcessing(NF2FF_Procs.at(n));
+	}
+
 	return true;
 }
 
@@ -587,6 +806,15 @@ void openEMS::SetupCylinderMultiGrid(std::string val)
 
 bool openEMS::SetupOperator()
 {
+	if (m_engine_HalfPrecision!=Operator_SSE_Compressed::HALF_NONE)
+	{
+		if (CylinderCoords || (m_engine!=EngineType_Multithreaded))
+		{
+			cerr << "openEMS::SetupOperator: Warning, half precision field storage requires the multithreaded engine, using single precision..." << endl;
+			m_engine_HalfPrecision = Operator_SSE_Compressed::HALF_NONE;
+		}
+	}
+
 	if (CylinderCoords)
 	{
 		if (m_CC_MultiGrid.size()>0)
@@ -608,7 +836,14 @@ bool openEMS::SetupOperator()
 	}
 	else if (m_engine == EngineType_Multithreaded)
 	{
-		FDTD_Op = Operator_Multithread::New(m_engine_numThreads);
+		Operator_Multithread* op_mt = Operator_Multithread::New(m_engine_numThreads);
+		op_mt->setTemporalBlocking(m_engine_TB_NumTS);
+		op_mt->setNeighbourSync(m_engine_NeighbourSync);
+		op_mt->setFusedUpdates(m_engine_FusedUpdates);
+		op_mt->setFullBarriers(m_engine_FullBarriers);
+		op_mt->setNUMA(m_engine_NUMA);
+		op_mt->SetHalfPrecision((Operator_SSE_Compressed::HalfPrecisionType)m_engine_HalfPrecision, m_engine_HalfValidation);
+		FDTD_Op = op_mt;
 	}
 	else
 	{
@@ -639,11 +874,25 @@ void openEMS::Set_BC_PML(int idx, unsigned int size)
 	m_PML_size[idx] = size;
 }
 
+void openEMS::Set_BC_CPML(int idx, unsigned int size)
+{
+	if ((idx<0) || (idx>5))
+		return;
+	m_BC_type[idx] = 4;
+	m_PML_size[idx] = size;
+}
+
+void openEMS::Set_CPML_Parameters(double kappaMax, double alphaMax)
+{
+	m_CPML_KappaMax = kappaMax;
+	m_CPML_AlphaMax = alphaMax;
+}
+
 int openEMS::Get_PML_Size(int idx)
 {
 	if ((idx<0) || (idx>5))
 		return -1;
-	if (m_BC_type[idx]!=3)
+	if ((m_BC_type[idx]!=3) && (m_BC_type[idx]!=4))
 		return -1; // return -1 if BC was *not* a PML
 	return m_PML_size[idx];
 }
@@ -774,6 +1023,8 @@ bool openEMS::Parse_XML_FDTDSetup(TiXmlElement* FDTD_Opts)
 				this->Set_BC_Type(n, 2);
 			else if (strncmp(s_bc.c_str(),"PML_=",4)==0)
 				this->Set_BC_PML(n, atoi(s_bc.c_str()+4));
+			else if (strncmp(s_bc.c_str(),"CPML_",5)==0)
+				this->Set_BC_CPML(n, atoi(s_bc.c_str()+5));
 			else
 				cerr << "openEMS::SetupBoundaryConditions: Warning,  boundary condition for \"" << bound_names[n] << "\" unknown... set to PEC " << endl;
 		}
@@ -791,6 +1042,13 @@ bool openEMS::Parse_XML_FDTDSetup(TiXmlElement* FDTD_Opts)
 		if (BC->QueryDoubleAttribute(mur_v_ph_names[n].c_str(),&dhelp) == TIXML_SUCCESS)
 			this->Set_Mur_PhaseVel(n, dhelp);
 
+	//read the cpml coordinate stretching and complex frequency shift
+	double kappaMax = m_CPML_KappaMax;
+	double alphaMax = m_CPML_AlphaMax;
+	BC->QueryDoubleAttribute("CPML_KappaMax",&kappaMax);
+	BC->QueryDoubleAttribute("CPML_AlphaMax",&alphaMax);
+	this->Set_CPML_Parameters(kappaMax, alphaMax);
+
 	TiXmlElement* m_Excite_Elem = FDTD_Opts->FirstChildElement("Excitation");
 	if (!m_Excite_Elem)
 	{
@@ -828,6 +1086,13 @@ bool openEMS::Parse_XML_FDTDSetup(TiXmlElement* FDTD_Opts)
 		break;
 	}
 
+	TiXmlElement* ti_nf2ff = FDTD_Opts->FirstChildElement("NF2FF");
+	while (ti_nf2ff!=NULL)
+	{
+		this->AddNF2FF(ti_nf2ff);
+		ti_nf2ff = ti_nf2ff->NextSiblingElement("NF2FF");
+	}
+
 	if (FDTD_Opts->QueryIntAttribute("TimeStepMethod",&ihelp)==TIXML_SUCCESS)
 		this->SetTimeStepMethod(ihelp);
 	if (FDTD_Opts->QueryDoubleAttribute("TimeStep",&dhelp)==TIXML_SUCCESS)
@@ -837,6 +1102,27 @@ bool openEMS::Parse_XML_FDTDSetup(TiXmlElement* FDTD_Opts)
 	return true;
 }
 
+void openEMS::AddNF2FF(TiXmlElement* ti_nf2ff)
+{
+	if (ti_nf2ff==NULL)
+		return;
+	m_NF2FF_Settings.push_back(ti_nf2ff->Clone()->ToElement());
+}
+
+bool openEMS::AddNF2FF(string xml)
+{
+	TiXmlDocument doc;
+	doc.Parse(xml.c_str());
+	TiXmlElement* ti_nf2ff = doc.FirstChildElement("NF2FF");
+	if (doc.Error() || (ti_nf2ff==NULL))
+	{
+		cerr << "openEMS::AddNF2FF: Error, invalid nf2ff settings: " << xml << endl;
+		return false;
+	}
+	AddNF2FF(ti_nf2ff);
+	return true;
+}
+
 void openEMS::SetGaussExcite(double f0, double fc)
 {
 	this->InitExcitation();
@@ -891,6 +1177,14 @@ int openEMS::SetupFDTD()
 	if (SetupOperator()==false)
 		return 2;
 
+	FDTD_Op->SetOperatorCache(m_OpCacheDir);
+
+	Operator_SSE_Compressed* op_ssec = dynamic_cast<Operator_SSE_Compressed*>(FDTD_Op);
+	if (op_ssec)
+		op_ssec->SetCompressionTolerance(m_OpCompressTolerance);
+	else if (m_OpCompressTolerance>0)
+		cerr << "openEMS::SetupFDTD: Warning, the compression tolerance is only used by the compressed engines, ignoring..." << endl;
+
 	// default material averaging is quarter cell averaging
 	FDTD_Op->SetQuarterCellMaterialAvg();
 
@@ -1089,6 +1383,197 @@ bool openEMS::CheckAbortCond()
 	return false;
 }
 
+#define CHECKPOINT_VERSION 2
+
+/*!
+  Header of a checkpoint file, followed by the engine state (see Engine::WriteState) and the state of all processings (see ProcessingArray::WriteState).
+  */
+struct CheckpointHeader
+{
+	char magic[16];
+	unsigned int version;
+	unsigned int floatSize;
+	uint64_t opHash;
+	uint64_t setupHash;
+	unsigned int numLines[3];
+	unsigned int numTS;
+	double maxEnergy;
+};
+
+typedef void (*SignalHandler)(int);
+static volatile sig_atomic_t g_CheckpointSignal = 0;
+static SignalHandler g_PrevSigTerm = SIG_DFL;
+static SignalHandler g_PrevSigInt = SIG_DFL;
+
+static void CheckpointSignalHandler(int sig)
+{
+	g_CheckpointSignal = sig;
+	// a second signal will terminate immediately
+	signal(sig, SIG_DFL);
+}
+
+void openEMS::SetCheckpointSignals(bool enable)
+{
+	if (enable)
+	{
+		g_CheckpointSignal = 0;
+		g_PrevSigTerm = signal(SIGTERM, CheckpointSignalHandler);
+		if (g_PrevSigTerm==SIG_ERR)
+			g_PrevSigTerm = SIG_DFL;
+		g_PrevSigInt = signal(SIGINT, CheckpointSignalHandler);
+		if (g_PrevSigInt==SIG_ERR)
+			g_PrevSigInt = SIG_DFL;
+	}
+	else
+	{
+		signal(SIGTERM, g_PrevSigTerm);
+		signal(SIGINT, g_PrevSigInt);
+	}
+}
+
+bool openEMS::CheckpointRequested()
+{
+	return g_CheckpointSignal!=0;
+}
+
+uint64_t openEMS::CalcCheckpointHash(unsigned int numTS) const
+{
+	// the operator hash excludes excitations, probes and dumps, they have to match for a restart as well
+	uint64_t hash = HashValue(FDTD_Op->GetOperatorHash());
+	for (size_t i=0; i<m_CSX->GetQtyProperties(); ++i)
+	{
+		CSProperties* prop = m_CSX->GetProperty(i);
+		if ((prop->GetType() & (CSProperties::EXCITATION | CSProperties::PROBEBOX | CSProperties::DUMPBOX))==0)
+			continue;
+		TiXmlElement elem(prop->GetTypeXMLString().c_str());
+		prop->Write2XML(elem, false, false);
+		TiXmlPrinter printer;
+		elem.Accept(&printer);
+		hash = HashData(printer.CStr(), printer.Size(), hash);
+	}
+
+	// the excitation signal up to the checkpoint timestep, the remaining signal may depend on the number of timesteps
+	Excitation* exc = FDTD_Op->GetExcitationSignal();
+	hash = HashValue(exc->GetExciteType(), hash);
+	unsigned int length = min(exc->GetLength(), numTS+1);
+	hash = HashData(exc->GetVoltageSignal(), length*sizeof(FDTD_FLOAT), hash);
+	hash = HashData(exc->GetCurrentSignal(), length*sizeof(FDTD_FLOAT), hash);
+	return hash;
+}
+
+string openEMS::GetCheckpointFile() const
+{
+	if (m_CheckpointFile.empty())
+		return __OPENEMS_CHECKPOINT_FILE__;
+	return m_CheckpointFile;
+}
+
+int openEMS::LimitStepToCheckpoint(int step) const
+{
+	if (m_CheckpointFile.empty() || (m_CheckpointInterval==0))
+		return step;
+	int next = m_CheckpointInterval - FDTD_Eng->GetNumberOfTimesteps()%m_CheckpointInterval;
+	if (step>next)
+		return next;
+	return step;
+}
+
+bool openEMS::HandleCheckpoint(double maxEnergy)
+{
+	if (m_CheckpointFile.empty())
+		return false;
+	bool onSignal = CheckpointRequested();
+	unsigned int numTS = FDTD_Eng->GetNumberOfTimesteps();
+	if (!onSignal && ((m_CheckpointInterval==0) || (numTS%m_CheckpointInterval!=0)))
+		return false;
+
+	WriteCheckpoint(maxEnergy);
+	if (onSignal)
+		cerr << "openEMS::HandleCheckpoint: Termination signal received, stopping the simulation at timestep " << numTS << ", resume with --restart" << endl;
+	return onSignal;
+}
+
+bool openEMS::WriteCheckpoint(double maxEnergy)
+{
+	double t_start = GetWallTime();
+	string filename = GetCheckpointFile();
+	// write to a temporary file first, an interrupted write must never destroy the last valid checkpoint
+	string tmpFile = filename + ".tmp";
+	ofstream file(tmpFile.c_str(), ios::out | ios::binary);
+	if (!file.is_open())
+	{
+		cerr << "openEMS::WriteCheckpoint: Error, can't open file: " << tmpFile << endl;
+		return false;
+	}
+
+	CheckpointHeader header;
+	memset(&header, 0, sizeof(header));
+	strncpy(header.magic, "openEMS_Ckpt", sizeof(header.magic)-1);
+	header.version = CHECKPOINT_VERSION;
+	header.floatSize = sizeof(FDTD_FLOAT);
+	header.opHash = FDTD_Op->GetOperatorHash();
+	for (int n=0; n<3; ++n)
+		header.numLines[n] = FDTD_Op->GetNumberOfLines(n,true);
+	header.numTS = FDTD_Eng->GetNumberOfTimesteps();
+	header.setupHash = CalcCheckpointHash(header.numTS);
+	header.maxEnergy = maxEnergy;
+	file.write((char*)&header, sizeof(header));
+
+	bool ok = FDTD_Eng->WriteState(file) && PA->WriteState(file);
+	file.close();
+	if (!ok || file.fail())
+	{
+		cerr << "openEMS::WriteCheckpoint: Error, writing the checkpoint failed: " << tmpFile << endl;
+		remove(tmpFile.c_str());
+		return false;
+	}
+#ifdef WIN32
+	remove(filename.c_str()); // rename will not replace an existing file
+#endif
+	if (rename(tmpFile.c_str(), filename.c_str())!=0)
+	{
+		cerr << "openEMS::WriteCheckpoint: Error, can't rename the checkpoint to: " << filename << endl;
+		remove(tmpFile.c_str());
+		return false;
+	}
+	cout << "openEMS::WriteCheckpoint: Checkpoint at timestep " << header.numTS << " written to " << filename << " (" << GetWallTime()-t_start << "s)" << endl;
+	return true;
+}
+
+bool openEMS::ReadCheckpoint(double &maxEnergy)
+{
+	string filename = GetCheckpointFile();
+	ifstream file(filename.c_str(), ios::in | ios::binary);
+	if (!file.is_open())
+	{
+		cerr << "openEMS::ReadCheckpoint: Error, can't open the checkpoint file: " << filename << endl;
+		return false;
+	}
+
+	CheckpointHeader header;
+	file.read((char*)&header, sizeof(header));
+	bool valid = file.good() && (strncmp(header.magic, "openEMS_Ckpt", sizeof(header.magic))==0);
+	valid &= (header.version==CHECKPOINT_VERSION) && (header.floatSize==sizeof(FDTD_FLOAT));
+	valid &= (header.opHash==FDTD_Op->GetOperatorHash());
+	valid &= (header.setupHash==CalcCheckpointHash(header.numTS));
+	for (int n=0; n<3; ++n)
+		valid &= (header.numLines[n]==FDTD_Op->GetNumberOfLines(n,true));
+	if (!valid)
+	{
+		cerr << "openEMS::ReadCheckpoint: Error, the checkpoint " << filename << " does not match the current simulation setup" << endl;
+		return false;
+	}
+
+	if ((FDTD_Eng->ReadState(file)==false) || (PA->ReadState(file)==false))
+	{
+		cerr << "openEMS::ReadCheckpoint: Error, reading the checkpoint failed: " << filename << endl;
+		return false;
+	}
+	maxEnergy = header.maxEnergy;
+	cout << "openEMS::ReadCheckpoint: Resuming the simulation at timestep " << header.numTS << " from " << filename << endl;
+	return true;
+}
+
 void openEMS::RunFDTD()
 {
 	cout << "Running FDTD engine... this may take a while... grab a cup of coffee?!?" << endl;
@@ -1098,7 +1583,8 @@ void openEMS::RunFDTD()
 	PA->AddProcessing(ProcField);
 	double maxE=0,currE=0;
 
-	//init processings
+	//init processings, resume the existing dump files on restart
+	PA->SetResume(m_Restart);
 	PA->InitAll();
 
 	//add all timesteps to end-crit field processing with max excite amplitude
@@ -1124,8 +1610,23 @@ void openEMS::RunFDTD()
 	//*************** simulate ************//
 
 	PA->PreProcess();
-	int step=PA->Process();
-	if ((step<0) || (step>(int)NrTS)) step=NrTS;
+	int step;
+	if (m_Restart)
+	{
+		if (ReadCheckpoint(maxE)==false)
+			exit(-1);
+		// the current timestep was already processed before the checkpoint was written
+		step=PA->GetNextInterval();
+		prevTS=FDTD_Eng->GetNumberOfTimesteps();
+	}
+	else
+		step=PA->Process();
+	unsigned int startTS=prevTS;
+	if ((step<0) || (step>(int)(NrTS - startTS))) step=NrTS - startTS;
+	step=LimitStepToCheckpoint(step);
+	if (!m_CheckpointFile.empty())
+		SetCheckpointSignals(true);
+	bool stopped=false;
 	while ((FDTD_Eng->GetNumberOfTimesteps()<NrTS) && (change>endCrit) && !CheckAbortCond())
 	{
 		FDTD_Eng->IterateTS(step);
@@ -1141,6 +1642,13 @@ void openEMS::RunFDTD()
 //		cout << " do " << step << " steps; current: " << eng.GetNumberOfTimesteps() << endl;
 		currTS = FDTD_Eng->GetNumberOfTimesteps();
 		if ((step<0) || (step>(int)(NrTS - currTS))) step=NrTS - currTS;
+		step=LimitStepToCheckpoint(step);
+
+		if (HandleCheckpoint(maxE))
+		{
+			stopped=true;
+			break;
+		}
 
 		gettimeofday(&currTime,NULL);
 
@@ -1175,6 +1683,13 @@ void openEMS::RunFDTD()
 				DumpRunStatistics(__OPENEMS_RUN_STAT_FILE__, t_run, currTS, speed, currE);
 		}
 	}
+	if (!m_CheckpointFile.empty())
+		SetCheckpointSignals(false);
+	if (stopped)
+	{
+		// the run is incomplete, skip the post-processing, it is done by the restarted run
+		return;
+	}
 	if ((change>endCrit) && (FDTD_Op->GetExcitationSignal()->GetExciteType()==0))
 		cerr << "RunFDTD: Warning: Max. number of timesteps was reached before the end-criteria of -" << fabs(10.0*log10(endCrit)) << "dB was reached... " << endl << \
 				"\tYou may want to choose a higher number of max. timesteps... " << endl;
@@ -1183,7 +1698,7 @@ void openEMS::RunFDTD()
 	t_diff = CalcDiffTime(currTime,startTime);
 
 	cout << "Time for " << FDTD_Eng->GetNumberOfTimesteps() << " iterations with " << FDTD_Op->GetNumberCells() << " cells : " << t_diff << " sec" << endl;
-	cout << "Speed: " << numCells*(double)FDTD_Eng->GetNumberOfTimesteps()/t_diff*1e-6 << " MCells/s " << endl;
+	cout << "Speed: " << numCells*(double)(FDTD_Eng->GetNumberOfTimesteps()-startTS)/t_diff*1e-6 << " MCells/s " << endl;
 
 	if (m_DumpStats)
 		DumpStatistics(__OPENEMS_STAT_FILE__, t_diff);
@@ -26,11 +26,13 @@
 #endif
 #include <time.h>
 #include <vector>
+#include <stdint.h>
 
 #include "openems_global.h"
 
 #define __OPENEMS_STAT_FILE__ "openEMS_stats.txt"
 #define __OPENEMS_RUN_STAT_FILE__ "openEMS_run_stats.txt"
+#define __OPENEMS_CHECKPOINT_FILE__ "openEMS_checkpoint.bin"
 
 class Operator;
 class Engine;
@@ -77,6 +79,39 @@ public:
 	void SetMaxTime(double val) {m_maxTime=val;}
 
 	void SetNumberOfThreads(unsigned int val) {m_engine_numThreads = val;}
+	//! Set the number of timesteps per temporal block for the multithreaded engine (<2 to disable)
+	void SetTemporalBlocking(unsigned int val) {m_engine_TB_NumTS = val;}
+	//! Synchronize the threads of the multithreaded engine with their neighbours only
+	void SetNeighbourSync(bool val) {m_engine_NeighbourSync = val;}
+	//! Apply the engine extensions within the x-slab sweep of the multithreaded engine
+	void SetFusedUpdates(bool val) {m_engine_FusedUpdates = val;}
+	//! Synchronize the threads of the multithreaded engine before every extension step, without eliding any barrier
+	void SetFullBarriers(bool val) {m_engine_FullBarriers = val;}
+	//! Pin the threads of the multithreaded engine and place their data on the local NUMA node
+	void SetNUMA(bool val) {m_engine_NUMA = val;}
+	//! Back the large field and operator arrays with huge pages (0: off, 1: transparent huge pages, 2: hugetlbfs)
+	void SetHugePages(int mode);
+	//! Store the engine fields as 16 bit floats (0: off, 1: IEEE half float, 2: bfloat16), computation is done in single precision
+	void SetHalfPrecision(int type);
+	//! Run a single precision reference engine alongside the half precision engine and report the deviations
+	void SetHalfPrecisionValidation(bool val) {m_engine_HalfValidation = val;}
+	//! Cache the calculated operator in the given directory and reuse it for identical geometry, mesh and settings (empty to disable)
+	void SetOperatorCache(std::string dir) {m_OpCacheDir = dir;}
+	//! Merge operator coefficients differing by less than the given relative tolerance in the compressed operator (0 for an exact compression)
+	void SetCompressionTolerance(double tol) {m_OpCompressTolerance = tol;}
+	//! Write a checkpoint to \a file on a termination signal (SIGTERM, SIGINT) and every \a interval timesteps (0: on a signal only). An empty file name disables the checkpoints.
+	void SetCheckpoint(std::string file, unsigned int interval=0) {m_CheckpointFile = file; m_CheckpointInterval = interval;}
+	//! Evaluate all voltage, current, field and mode matching probes in a single batched pass per timestep
+	void SetProbeBatching(bool val) {m_ProbeBatching = val;}
+	//! Write the voltage, current, field and mode matching probes in the buffered binary probe format \sa ProcessIntegral
+	void SetBinaryProbes(bool val) {m_BinaryProbes = val;}
+	//! Resume the simulation from the last checkpoint \sa SetCheckpoint
+	void SetRestart(bool val) {m_Restart = val;}
+
+	//! Add an in-solver nf2ff transformation (see ProcessNF2FF), the xml node is copied
+	void AddNF2FF(TiXmlElement* ti_nf2ff);
+	//! Add an in-solver nf2ff transformation from its xml string (see ProcessNF2FF)
+	bool AddNF2FF(std::string xml);
 
 	void DebugMaterial() {DebugMat=true;}
 	void DebugOperator() {DebugOp=true;}
@@ -87,8 +122,11 @@ public:
 	void Set_BC_Type(int idx, int type);
 	int Get_BC_Type(int idx);
 	void Set_BC_PML(int idx, unsigned int size);
+	void Set_BC_CPML(int idx, unsigned int size);
 	int Get_PML_Size(int idx);
 	void Set_Mur_PhaseVel(int idx, double val);
+	//! Set the maximum coordinate stretching and complex frequency shift (S/m) of all cpml boundaries, see Operator_Ext_CPML
+	void Set_CPML_Parameters(double kappaMax, double alphaMax);
 
 	//! Get informations about external libs used by openEMS
 	static std::string GetExtLibsInfo(std::string prefix="\t");
@@ -150,6 +188,40 @@ protected:
 #endif
 	EngineType m_engine;
 	unsigned int m_engine_numThreads;
+	unsigned int m_engine_TB_NumTS;
+	bool m_engine_NeighbourSync;
+	bool m_engine_FusedUpdates;
+	bool m_engine_FullBarriers;
+	bool m_engine_NUMA;
+	int m_engine_HalfPrecision;
+	bool m_engine_HalfValidation;
+	std::string m_OpCacheDir;
+	double m_OpCompressTolerance;
+	bool m_ProbeBatching;
+	bool m_BinaryProbes;
+
+	//! settings of the in-solver nf2ff transformations
+	std::vector<TiXmlElement*> m_NF2FF_Settings;
+
+	std::string m_CheckpointFile;
+	unsigned int m_CheckpointInterval;
+	bool m_Restart;
+	//! Get the checkpoint file used by this process
+	virtual std::string GetCheckpointFile() const;
+	//! Hash of the simulation setup not covered by the operator hash (excitations, probes, dumps and the excitation signal up to timestep \a numTS)
+	uint64_t CalcCheckpointHash(unsigned int numTS) const;
+	//! Install (or remove) the signal handlers requesting a checkpoint
+	void SetCheckpointSignals(bool enable);
+	//! Check if a checkpoint was requested by a termination signal
+	virtual bool CheckpointRequested();
+	//! Limit the number of timesteps to iterate, to stop at the next periodic checkpoint
+	int LimitStepToCheckpoint(int step) const;
+	//! Write a checkpoint if the checkpoint interval is reached or a termination signal was received. Returns true if the simulation has to be stopped.
+	bool HandleCheckpoint(double maxEnergy);
+	//! Write the engine and processing state to the checkpoint file
+	bool WriteCheckpoint(double maxEnergy);
+	//! Restore the engine and processing state from the checkpoint file
+	bool ReadCheckpoint(double &maxEnergy);
 
 	//! Setup an operator matching the requested engine
 	virtual bool SetupOperator();
@@ -159,6 +231,8 @@ protected:
 	int m_BC_type[6];
 	unsigned int m_PML_size[6];
 	double m_Mur_v_ph[6];
+	double m_CPML_KappaMax;
+	double m_CPML_AlphaMax;
 
 	//! Check whether or not the FDTD-Operator has to store material data.
 	bool SetupMaterialStorages();
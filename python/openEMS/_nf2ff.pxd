@@ -33,6 +33,7 @@ cdef extern from "openEMS/nf2ff.h":
         void SetPermeability(vector[float] permeability);
 
         void SetMirror(int _type, int _dir, float pos);
+        void SetAccuracy(float accuracy)
 
         double GetTotalRadPower(size_t f_idx)
         double GetMaxDirectivity(size_t f_idx)
@@ -59,6 +59,9 @@ cdef class _nf2ff:
     def SetRadius(self, radius):
         self.thisptr.SetRadius(radius)
 
+    def SetAccuracy(self, accuracy):
+        self.thisptr.SetAccuracy(accuracy)
+
     def Write2HDF5(self, filename):
         return self.thisptr.Write2HDF5(filename.encode('UTF-8'))
 
@@ -40,12 +40,29 @@ cdef extern from "openEMS/openems.h":
         void SetMaxTime(double val)
 
         void SetNumberOfThreads(int val)
+        void SetTemporalBlocking(unsigned int val)
+        void SetNeighbourSync(bool val)
+        void SetFusedUpdates(bool val)
+        void SetFullBarriers(bool val)
+        void SetNUMA(bool val)
+        void SetHugePages(int mode)
+        void SetHalfPrecision(int _type)
+        void SetHalfPrecisionValidation(bool val)
+        void SetOperatorCache(string dir)
+        void SetCompressionTolerance(double tol)
+        void SetCheckpoint(string file, unsigned int interval)
+        void SetRestart(bool val)
+        void SetProbeBatching(bool val)
+        void SetBinaryProbes(bool val)
+        bool AddNF2FF(string xml)
 
         void Set_BC_Type(int idx, int _type)
         int Get_BC_Type(int idx)
         void Set_BC_PML(int idx, unsigned int size)
+        void Set_BC_CPML(int idx, unsigned int size)
         int Get_PML_Size(int idx)
         void Set_Mur_PhaseVel(int idx, double val)
+        void Set_CPML_Parameters(double kappaMax, double alphaMax)
 
         void SetGaussExcite(double f0, double fc)
 
@@ -233,8 +233,8 @@ cdef class openEMS:
         self.thisptr.SetGaussExcite(f0, fc)
 
 
-    def SetBoundaryCond(self, BC):
-        """ SetBoundaryCond(BC)
+    def SetBoundaryCond(self, BC, **kw):
+        """ SetBoundaryCond(BC, **kw)
 
         Set the boundary conditions for all six FDTD directions.
 
@@ -244,8 +244,11 @@ cdef class openEMS:
         * 1 or 'PMC' : perfect magnetic conductor, useful for symmetries
         * 2 or 'MUR' : simple MUR absorbing boundary conditions
         * 3 or 'PML-8' : PML absorbing boundary conditions
+        * 4 or 'CPML_8' : convolutional PML absorbing boundary conditions, using less memory than the PML
 
         :param BC: (8,) array or list -- see options above
+        :param CPML_KappaMax: float -- maximum coordinate stretching of the cpml (default 1)
+        :param CPML_AlphaMax: float -- complex frequency shift of the cpml in S/m (default 0)
         """
         if not len(BC)==6:
             raise Exception('Invalid boundary condition size!')
@@ -256,11 +259,17 @@ cdef class openEMS:
             if BC[n] in ['PEC', 'PMC', 'MUR']:
                 self.thisptr.Set_BC_Type(n, ['PEC', 'PMC', 'MUR'].index(BC[n]))
                 continue
+            if BC[n].startswith('CPML_'):
+                size = int(BC[n][5:])
+                self.thisptr.Set_BC_CPML(n, size)
+                continue
             if BC[n].startswith('PML_'):
                 size = int(BC[n].strip('PML_'))
                 self.thisptr.Set_BC_PML(n, size)
                 continue
             raise Exception('Unknown boundary condition')
+        if 'CPML_KappaMax' in kw or 'CPML_AlphaMax' in kw:
+            self.thisptr.Set_CPML_Parameters(kw.get('CPML_KappaMax', 1.0), kw.get('CPML_AlphaMax', 0.0))
 
     def AddLumpedPort(self, port_nr, R, start, stop, p_dir, excite=0, **kw):
         """ AddLumpedPort(port_nr, R, start, stop, p_dir, excite=0, **kw)
@@ -354,7 +363,7 @@ cdef class openEMS:
                 mirror[n]    = 2  # PMC mirror
             elif BC_type[n]==2:
                 BC_size[n] = 2
-            elif BC_type[n]==3:
+            elif BC_type[n]==3 or BC_type[n]==4:
                 BC_size[n] = self.thisptr.Get_PML_Size(n)+1
 
         if start is None or stop is None:
@@ -372,6 +381,52 @@ cdef class openEMS:
                 stop[n]  = l[-1*BC_size[2*n+1]-1]
         return nf2ff.nf2ff(self.__CSX, name, start, stop, directions=directions, mirror=mirror, **kw)
 
+    def SetupNF2FF(self, nf2ff_box, freq, theta, phi, radius=1, center=[0,0,0], outfile=None, verbose=0, accuracy=0):
+        """ SetupNF2FF(nf2ff_box, freq, theta, phi, radius=1, center=[0,0,0], outfile=None, verbose=0, accuracy=0)
+
+        Run the near-field to far-field transformation of a nf2ff box inside
+        openEMS at the end of the simulation. The fields of the box are recorded
+        in memory at the given frequencies, only the far-field result is written.
+        Read the result with `nf2ff_box.CalcNF2FF(sim_path, freq, theta, phi, read_cached=True)`
+        using the same arguments.
+
+        :param nf2ff_box: nf2ff -- recording box created by CreateNF2FFBox
+        :param freq: array like -- list of frequency for transformation
+        :param theta/phi: array like -- Theta/Phi angles to calculate the far-field
+        :param radius: float -- Radius to calculate the far-field (default is 1m)
+        :param center: (3,) array -- phase center, must be inside the recording box
+        :param outfile: str -- File to save results in. (defaults to recording name)
+        :param verbose: int -- set verbose level (default 0)
+        :param accuracy: float -- enable the fast far-field aggregation with this relative accuracy (default 0, direct calculation)
+
+        See Also
+        --------
+        openEMS.nf2ff.nf2ff.CalcNF2FF
+        """
+        if np.isscalar(freq):
+            freq = [freq]
+        if np.isscalar(theta):
+            theta = [theta]
+        if np.isscalar(phi):
+            phi = [phi]
+        if outfile is None:
+            outfile = nf2ff_box.name + '.h5'
+        to_str = lambda vals: ','.join([str(float(v)) for v in vals])
+        xml  = '<NF2FF freq="{}" Outfile="{}" Center="{}" Radius="{}" Verbose="{}"'.format(to_str(freq), outfile, to_str(center), float(radius), int(verbose))
+        if accuracy>0:
+            xml += ' Accuracy="{}"'.format(float(accuracy))
+        xml += '><theta>{}</theta><phi>{}</phi>'.format(to_str(np.deg2rad(theta)), to_str(np.deg2rad(phi)))
+        # the planes refer to the names of the E- and H-field dump boxes
+        xml += '<Planes E_Field="{}" H_Field="{}"/>'.format(nf2ff_box.e_file, nf2ff_box.h_file)
+        mirror_types = {1: 'PEC', 2: 'PMC'}
+        for ny in range(3):
+            for n, pos in ((2*ny, nf2ff_box.start[ny]), (2*ny+1, nf2ff_box.stop[ny])):
+                if nf2ff_box.mirror[n] in mirror_types:
+                    xml += '<Mirror Type="{}" Dir="{}" Pos="{}"/>'.format(mirror_types[nf2ff_box.mirror[n]], ny, float(pos))
+        xml += '</NF2FF>'
+        if not self.thisptr.AddNF2FF(xml.encode('UTF-8')):
+            raise Exception('SetupNF2FF: invalid nf2ff settings')
+
     def SetCSX(self, ContinuousStructure CSX):
         """ SetCSX(CSX)
 
@@ -432,7 +487,27 @@ cdef class openEMS:
 
         Additional keyword parameter:
         :param numThreads: int -- set the number of threads (default 0 --> max)
+        :param temporalBlocking: int -- number of timesteps per sweep through the mesh (default 0 --> disabled)
+        :param neighbourSync: bool -- synchronize the engine threads with their neighbours only (default False)
+        :param fusedUpdates: bool -- apply boundary conditions and excitations plane by plane within the engine sweep (default False)
+        :param fullBarriers: bool -- synchronize the engine threads before every extension update, without eliding barriers (default False)
+        :param hugePages: str -- back the large arrays with huge pages: 'thp' or 'hugetlb' (default None --> disabled)
+        :param halfPrecision: str -- store the fields as 16 bit floats: 'fp16' or 'bf16' (multithreaded engine only, default None --> single precision)
+        :param validateHalfPrecision: bool -- compare the half precision engine with a single precision engine (default False)
+        :param numa: bool -- pin the engine threads and place their data on the local NUMA node (default False)
+        :param operatorCache: str -- directory to store the operator in and reuse it for identical geometry, mesh and settings (default None --> disabled)
+        :param compressionTolerance: float -- merge operator coefficients differing by less than this relative tolerance (default 0 --> exact)
+        :param checkpoint: int -- write a checkpoint on SIGTERM/SIGINT and every n timesteps (default None --> disabled, 0 --> on a signal only)
+        :param checkpointFile: str -- file to write the checkpoints to (default 'openEMS_checkpoint.bin' in sim_path)
+        :param restart: bool -- resume the simulation from the last checkpoint, use cleanup=False (default False)
+        :param batchProbes: bool -- evaluate all voltage, current, field and mode matching probes in a single multithreaded pass (default False)
+        :param binaryProbes: bool -- write the probe files in a buffered binary format, read by the port and probe classes (default False)
         """
+        if kw.get('operatorCache', None) is not None:
+            cache_dir = os.path.abspath(kw['operatorCache'])
+            if not os.path.exists(cache_dir):
+                os.makedirs(cache_dir)
+            self.thisptr.SetOperatorCache(cache_dir.encode('UTF-8'))
         if cleanup and os.path.exists(sim_path):
             shutil.rmtree(sim_path)
             os.mkdir(sim_path)
@@ -446,6 +521,39 @@ cdef class openEMS:
                 self.thisptr.DebugPEC()
         if 'numThreads' in kw:
             self.thisptr.SetNumberOfThreads(int(kw['numThreads']))
+        if 'temporalBlocking' in kw:
+            self.thisptr.SetTemporalBlocking(int(kw['temporalBlocking']))
+        if 'neighbourSync' in kw:
+            self.thisptr.SetNeighbourSync(bool(kw['neighbourSync']))
+        if 'fusedUpdates' in kw:
+            self.thisptr.SetFusedUpdates(bool(kw['fusedUpdates']))
+        if 'fullBarriers' in kw:
+            self.thisptr.SetFullBarriers(bool(kw['fullBarriers']))
+        if 'hugePages' in kw:
+            modes = {None: 0, False: 0, True: 1, 'thp': 1, 'hugetlb': 2}
+            if kw['hugePages'] not in modes:
+                raise Exception('Unknown huge page mode: {}'.format(kw['hugePages']))
+            self.thisptr.SetHugePages(modes[kw['hugePages']])
+        if 'halfPrecision' in kw:
+            types = {None: 0, False: 0, 'fp16': 1, 'bf16': 2}
+            if kw['halfPrecision'] not in types:
+                raise Exception('Unknown half precision type: {}'.format(kw['halfPrecision']))
+            self.thisptr.SetHalfPrecision(types[kw['halfPrecision']])
+        if 'validateHalfPrecision' in kw:
+            self.thisptr.SetHalfPrecisionValidation(bool(kw['validateHalfPrecision']))
+        if 'numa' in kw:
+            self.thisptr.SetNUMA(bool(kw['numa']))
+        if 'compressionTolerance' in kw:
+            self.thisptr.SetCompressionTolerance(float(kw['compressionTolerance']))
+        if kw.get('checkpoint', None) is not None or kw.get('checkpointFile', None) is not None:
+            ckpt_file = kw.get('checkpointFile', None) or 'openEMS_checkpoint.bin'
+            self.thisptr.SetCheckpoint(ckpt_file.encode('UTF-8'), int(kw.get('checkpoint', None) or 0))
+        if 'restart' in kw:
+            self.thisptr.SetRestart(bool(kw['restart']))
+        if 'batchProbes' in kw:
+            self.thisptr.SetProbeBatching(bool(kw['batchProbes']))
+        if 'binaryProbes' in kw:
+            self.thisptr.SetBinaryProbes(bool(kw['binaryProbes']))
         assert os.getcwd() == sim_path
         _openEMS.WelcomeScreen()
         cdef int EC
@@ -40,7 +40,7 @@ class UI_data:
         self.ui_f_val = []
 
         for fn in fns:
-            tmp = np.loadtxt(os.path.join(path, fn),comments='%')
+            tmp = utilities.ReadProbeData(os.path.join(path, fn))
             self.ui_time.append(tmp[:,0])
             self.ui_val.append(tmp[:,1])
             self.ui_f_val.append(utilities.DFT_time2freq(tmp[:,0], tmp[:,1], freq, signal_type=signal_type))
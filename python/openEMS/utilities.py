@@ -16,8 +16,32 @@
 # along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #
 
+import struct
 import numpy as np
 
+PROBE_BINARY_MAGIC = b'OEMSPRB\x00'
+
+def ReadProbeData(filename):
+    """
+    Read a probe file (e.g. voltage or current) written by openEMS.
+    The binary probe format is loaded directly, ASCII files are parsed.
+
+    :param filename: str -- probe file name
+    :returns: 2D array -- one row per sample, time or frequency in the first column
+    """
+    with open(filename, 'rb') as f:
+        header = f.read(24)
+        if header[:8] != PROBE_BINARY_MAGIC:
+            return np.loadtxt(filename, comments='%', ndmin=2)
+        version, num_cols, offset = struct.unpack('<IIQ', header[8:24])
+        if version != 1:
+            raise Exception('Unsupported binary probe version {} of file "{}"'.format(version, filename))
+        f.seek(offset)
+        data = np.fromfile(f, dtype='<f8')
+    # ignore an incomplete last sample of a running simulation
+    num_rows = len(data)//num_cols
+    return data[:num_rows*num_cols].reshape(num_rows, num_cols)
+
 def DFT_time2freq( t, val, freq, signal_type='pulse'):
     assert len(t)==len(val)
     assert len(freq)>0
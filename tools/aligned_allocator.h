@@ -24,16 +24,7 @@
 #include <new>       // Required for placement new and std::bad_alloc
 #include <stdexcept> // Required for std::length_error
 
-
-#ifdef WIN32
-#define __MSVCRT_VERSION__ 0x0700
-#include <malloc.h>
-#define MEMALIGN( array, alignment, size ) !(*array = _aligned_malloc( size, alignment ))
-#define FREE( array ) _aligned_free( array )
-#else
-#define MEMALIGN( array, alignment, size ) posix_memalign( array, alignment, size )
-#define FREE( array ) free( array )
-#endif
+#include "array_ops.h"  // AllocAlignedMemory(), optionally backed by huge pages
 
 
 template <typename T> class aligned_allocator
@@ -123,8 +114,9 @@ public:
 		}
 
 		// Allocators should throw std::bad_alloc in the case of memory allocation failure.
-		void * pv;
-		if (MEMALIGN( &pv, 16, n * sizeof(T)))
+		// align to 64 byte, sufficient for AVX-512 access of the stored data
+		void * pv = AllocAlignedMemory(n * sizeof(T));
+		if (pv==NULL)
 			throw std::bad_alloc();
 
 		return static_cast<T *>(pv);
@@ -133,9 +125,9 @@ public:
 	void deallocate(T * const p, const size_t n) const
 	{
 //		std::cout << "Deallocating " << n << (n == 1 ? " object" : "objects") << " of size " << sizeof(T) << "." << std::endl;
-		// aligned_allocator wraps free().
+		// aligned_allocator wraps FreeAlignedMemory().
 		UNUSED(n);
-		FREE(p);
+		FreeAlignedMemory(p);
 	}
 
 	// The following will be the same for all allocators that ignore hints.
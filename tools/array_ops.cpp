@@ -17,6 +17,17 @@
 
 #include "array_ops.h"
 #include <ostream>
+#include <sstream>
+#include <cstring>
+#include <vector>
+#include <stdint.h>
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <map>
+#include <boost/thread/mutex.hpp>
+#endif
 
 using namespace std;
 
@@ -29,29 +40,204 @@ using namespace std;
 #define FREE( array ) free( array )
 #endif
 
-void Delete1DArray_v4sf(f4vector* array)
+static HugePageMode g_HugePageMode = HUGEPAGES_OFF;
+
+void SetHugePageMode(HugePageMode mode)
 {
-	if (array==NULL) return;
-	FREE( array );
+	g_HugePageMode = mode;
+}
+
+HugePageMode GetHugePageMode()
+{
+	return g_HugePageMode;
 }
 
+#ifdef __linux__
+// size of the hugetlbfs mappings of AllocAlignedMemory() (needed by munmap), kept out of band to not increase the block size by a header
+static std::map<void*, size_t> g_MappedBlocks;
+static boost::mutex g_MappedBlocksMutex;
 
-void Delete3DArray_v4sf(f4vector*** array, const unsigned int* numLines)
+#ifndef MAP_HUGE_SHIFT
+#define MAP_HUGE_SHIFT 26
+#endif
+
+// report each kind of obtained page size only once
+static void LogHugePages(unsigned int id, const string &msg)
 {
-	if (array==NULL) return;
-	unsigned int pos[3];
-	for (pos[0]=0; pos[0]<numLines[0]; ++pos[0])
+	static unsigned int logged = 0;
+	if (logged & (1<<id))
+		return;
+	logged |= (1<<id);
+	cout << "Huge pages: " << msg << endl;
+}
+
+static size_t ReadSysValue(const char* filename)
+{
+	FILE* file = fopen(filename, "r");
+	if (file==NULL)
+		return 0;
+	unsigned long val = 0;
+	if (fscanf(file, "%lu", &val)!=1)
+		val = 0;
+	fclose(file);
+	return val;
+}
+
+static bool THPEnabled()
+{
+	FILE* file = fopen("/sys/kernel/mm/transparent_hugepage/enabled", "r");
+	if (file==NULL)
+		return false;
+	char buf[128];
+	bool enabled = (fgets(buf, sizeof(buf), file)!=NULL) && (strstr(buf, "[never]")==NULL);
+	fclose(file);
+	return enabled;
+}
+
+// try to map a block of hugetlbfs pages, 1 GB pages are used for blocks of at least 1 GB
+static void* MapHugeTLB(size_t &length)
+{
+	const unsigned int pageShift[] = {30, 21};
+	for (int n=0; n<2; ++n)
 	{
-		for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
+		size_t pagesize = (size_t)1 << pageShift[n];
+		if (n==0 && length<pagesize)
+			continue;
+		size_t len = ((length+pagesize-1)/pagesize)*pagesize;
+		void* base = mmap(NULL, len, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|MAP_HUGETLB|(pageShift[n]<<MAP_HUGE_SHIFT), -1, 0);
+		if (base!=MAP_FAILED)
+		{
+			LogHugePages(n, n==0 ? "using 1 GB hugetlbfs pages" : "using 2 MB hugetlbfs pages");
+			length = len;
+			return base;
+		}
+	}
+	LogHugePages(2, "no hugetlbfs pages available, falling back to transparent huge pages");
+	return NULL;
+}
+#endif
+
+void* AllocAlignedMemory(size_t size)
+{
+	char* base = NULL;
+#ifdef __linux__
+	if ((g_HugePageMode!=HUGEPAGES_OFF) && (size>=HUGEPAGE_MIN_SIZE))
+	{
+		if (g_HugePageMode==HUGEPAGES_HUGETLB)
+		{
+			size_t length = size;
+			base = (char*)MapHugeTLB(length);
+			if (base!=NULL)
+			{
+				boost::mutex::scoped_lock lock(g_MappedBlocksMutex);
+				g_MappedBlocks[base] = length;
+			}
+		}
+		if ((base==NULL) && THPEnabled())
 		{
-			FREE( array[pos[0]][pos[1]] );
-			//delete[] array[pos[0]][pos[1]];
+			size_t pagesize = ReadSysValue("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size");
+			if (pagesize==0)
+				pagesize = HUGEPAGE_MIN_SIZE;
+			if (posix_memalign((void**)&base, pagesize, size)==0)
+			{
+				if (madvise(base, size, MADV_HUGEPAGE)==0)
+				{
+					stringstream ss;
+					ss << "using transparent huge pages of " << pagesize/1024 << " kB";
+					LogHugePages(3, ss.str());
+				}
+				else
+					LogHugePages(4, "madvise(MADV_HUGEPAGE) failed, using default pages");
+			}
+			else
+				base = NULL;
 		}
-		FREE( array[pos[0]] );
-		//delete[] array[pos[0]];
+		else if (base==NULL)
+			LogHugePages(5, "transparent huge pages are disabled by the system, using default pages");
 	}
+#endif
+	if ((base==NULL) && MEMALIGN( (void**)&base, ARRAY_DATA_ALIGNMENT, size ))
+		return NULL;
+	return base;
+}
+
+void FreeAlignedMemory(void* data)
+{
+	if (data==NULL) return;
+#ifdef __linux__
+	{
+		boost::mutex::scoped_lock lock(g_MappedBlocksMutex);
+		std::map<void*, size_t>::iterator it = g_MappedBlocks.find(data);
+		if (it!=g_MappedBlocks.end())
+		{
+			munmap(data, it->second);
+			g_MappedBlocks.erase(it);
+			return;
+		}
+	}
+#endif
+	FREE( data );
+}
+
+void* AllocArrayData(size_t size, bool zero)
+{
+	// allocate at least one aligned block, thus a valid pointer is returned for empty arrays
+	size = std::max(size, (size_t)ARRAY_DATA_ALIGNMENT);
+	void* data = AllocAlignedMemory(size);
+	if (data==NULL)
+	{
+		cerr << "cannot allocate aligned memory" << endl;
+		exit(3);
+	}
+	if (zero)
+		memset(data, 0, size);
+	return data;
+}
+
+void FreeArrayData(void* data)
+{
+	FreeAlignedMemory(data);
+}
+
+bool RelocateArrayData(void* start, size_t size, int node)
+{
+	if (node<0)
+		return false;
+#if defined(__linux__) && defined(SYS_mbind)
+	// numaif.h constants, used without a dependency on libnuma
+	const int mpol_preferred = 1;
+	const unsigned int mpol_mf_move = 1<<1;
+	uintptr_t pagesize = sysconf(_SC_PAGESIZE);
+	uintptr_t begin = ((uintptr_t)start + pagesize - 1) & ~(pagesize-1);
+	uintptr_t end = ((uintptr_t)start + size) & ~(pagesize-1);
+	if (end<=begin)
+		return true;
+	// prefer the node for all future page faults and let the kernel migrate the already touched pages (content is preserved)
+	const unsigned int bits = 8*sizeof(unsigned long);
+	std::vector<unsigned long> nodemask(node/bits+1, 0);
+	nodemask.at(node/bits) = 1UL << (node%bits);
+	return syscall(SYS_mbind, (void*)begin, (unsigned long)(end-begin), mpol_preferred, &nodemask[0], (unsigned long)(nodemask.size()*bits+1), mpol_mf_move)==0;
+#else
+	(void)start;
+	(void)size;
+	return false;
+#endif
+}
+
+void Delete1DArray_v4sf(f4vector* array)
+{
+	if (array==NULL) return;
 	FREE( array );
-	//delete[] array;
+}
+
+
+void Delete3DArray_v4sf(f4vector*** array, const unsigned int* numLines)
+{
+	if (array==NULL) return;
+	(void)numLines; // not needed for a contiguous array
+	FreeArrayData(array[0][0]);
+	delete[] array[0];
+	delete[] array;
 }
 
 void Delete_N_3DArray_v4sf(f4vector**** array, const unsigned int* numLines)
@@ -83,48 +269,40 @@ f4vector* Create1DArray_v4sf(const unsigned int numLines)
 	return array;
 }
 
-//! \brief this function allocates a 3D array, which is aligned to 16 byte
-f4vector*** Create3DArray_v4sf(const unsigned int* numLines)
+unsigned int Get3DArrayLineStride_v4sf(const unsigned int* numLines)
 {
 	unsigned int numZ = ceil((double)numLines[2]/4.0);
+	// pad each z-line to keep all lines aligned
+	const unsigned int align = V4SF_LINE_ALIGNMENT/F4VECTOR_SIZE;
+	return ((numZ+align-1)/align)*align;
+}
 
-	f4vector*** array=NULL;
-	unsigned int pos[3];
-	if (MEMALIGN( (void**)&array, 16, F4VECTOR_SIZE*numLines[0] ))
-	{
-		cerr << "cannot allocate aligned memory" << endl;
-		exit(3);
-	}
-	//array = new f4vector**[numLines[0]];
+/*!
+  \brief This function allocates a 3D array as a single contiguous data block.
+  Each z-line is padded to a multiple of V4SF_LINE_ALIGNMENT byte, see Get3DArrayLineStride_v4sf()
+  */
+f4vector*** Create3DArray_v4sf(const unsigned int* numLines, bool zero)
+{
+	size_t stride = Get3DArrayLineStride_v4sf(numLines);
+	size_t numYZ = stride*numLines[1];
+	f4vector* data = (f4vector*)AllocArrayData(F4VECTOR_SIZE*numLines[0]*numYZ, zero);
+
+	// allocate at least one entry, the first line of the first table always points to the data block
+	f4vector** lines = new f4vector*[(size_t)numLines[0]*numLines[1]+1];
+	f4vector*** array = new f4vector**[numLines[0]+1];
+	lines[0] = data;
+	array[0] = lines;
+	unsigned int pos[2];
 	for (pos[0]=0; pos[0]<numLines[0]; ++pos[0])
 	{
-		if (MEMALIGN( (void**)&array[pos[0]], 16, F4VECTOR_SIZE*numLines[1] ))
-		{
-			cerr << "cannot allocate aligned memory" << endl;
-			exit(3);
-		}
-		//array[pos[0]] = new f4vector*[numLines[1]];
+		array[pos[0]] = &lines[(size_t)pos[0]*numLines[1]];
 		for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
-		{
-			if (MEMALIGN( (void**)&array[pos[0]][pos[1]], 16, F4VECTOR_SIZE*numZ ))
-			{
-				cerr << "cannot allocate aligned memory" << endl;
-				exit(3);
-			}
-			//array[pos[0]][pos[1]] = new f4vector[numZ];
-			for (pos[2]=0; pos[2]<numZ; ++pos[2])
-			{
-				array[pos[0]][pos[1]][pos[2]].f[0] = 0;
-				array[pos[0]][pos[1]][pos[2]].f[1] = 0;
-				array[pos[0]][pos[1]][pos[2]].f[2] = 0;
-				array[pos[0]][pos[1]][pos[2]].f[3] = 0;
-			}
-		}
+			array[pos[0]][pos[1]] = &data[pos[0]*numYZ + pos[1]*stride];
 	}
 	return array;
 }
 
-f4vector**** Create_N_3DArray_v4sf(const unsigned int* numLines)
+f4vector**** Create_N_3DArray_v4sf(const unsigned int* numLines, bool zero)
 {
 	f4vector**** array=NULL;
 	if (MEMALIGN( (void**)&array, 16, F4VECTOR_SIZE*3 ))
@@ -135,8 +313,55 @@ f4vector**** Create_N_3DArray_v4sf(const unsigned int* numLines)
 	//array = new f4vector***[3];
 	for (int n=0; n<3; ++n)
 	{
-		array[n]=Create3DArray_v4sf(numLines);
+		array[n]=Create3DArray_v4sf(numLines, zero);
 	}
 	return array;
 }
 
+bool Relocate_N_3DArray_v4sf(f4vector**** array, const unsigned int* numLines, unsigned int startX, unsigned int numX, int node)
+{
+	if (array==NULL || startX>=numLines[0]) return true;
+	numX = min(numX, numLines[0]-startX);
+	size_t numYZ = (size_t)Get3DArrayLineStride_v4sf(numLines)*numLines[1];
+	bool ok = true;
+	for (int n=0; n<3; ++n)
+		ok &= RelocateArrayData(Get3DArrayData_v4sf(array[n])+startX*numYZ, F4VECTOR_SIZE*numX*numYZ, node);
+	return ok;
+}
+
+void Zero_N_3DArray_v4sf(f4vector**** array, const unsigned int* numLines, unsigned int startX, unsigned int numX)
+{
+	if (array==NULL || startX>=numLines[0]) return;
+	numX = min(numX, numLines[0]-startX);
+	size_t numYZ = (size_t)Get3DArrayLineStride_v4sf(numLines)*numLines[1];
+	for (int n=0; n<3; ++n)
+		memset(Get3DArrayData_v4sf(array[n])+startX*numYZ, 0, F4VECTOR_SIZE*numX*numYZ);
+}
+
+void Write_N_3DArray_v4sf(ostream &file, f4vector**** array, const unsigned int* numLines)
+{
+	size_t size = (size_t)Get3DArrayLineStride_v4sf(numLines)*numLines[1]*numLines[0];
+	for (int n=0; n<3; ++n)
+		file.write((const char*)Get3DArrayData_v4sf(array[n]), F4VECTOR_SIZE*size);
+}
+
+void Read_N_3DArray_v4sf(istream &file, f4vector**** array, const unsigned int* numLines)
+{
+	size_t size = (size_t)Get3DArrayLineStride_v4sf(numLines)*numLines[1]*numLines[0];
+	for (int n=0; n<3; ++n)
+		file.read((char*)Get3DArrayData_v4sf(array[n]), F4VECTOR_SIZE*size);
+}
+
+unsigned int GetCPUVectorWidth(unsigned int maxWidth)
+{
+#ifdef ENABLE_WIDE_VECTORS
+	if (maxWidth==0)
+		maxWidth = 16;
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f") && (maxWidth>=16))
+		return 16;
+	if (__builtin_cpu_supports("avx") && (maxWidth>=8))
+		return 8;
+#endif
+	return 4;
+}
@@ -26,9 +26,11 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <iostream>
 #include <string>
 #include <math.h>
+#include <algorithm>
 #include "constants.h"
 
 #define F4VECTOR_SIZE 16 // sizeof(typeid(f4vector))
@@ -40,6 +42,19 @@ union f4vector
 	v4sf v;
 	float f[4];
 };
+
+#if defined(__x86_64__) || defined(__i386__)
+// wider vector types for the AVX/AVX-512 engine kernels, selected at runtime (see GetCPUVectorWidth())
+#define ENABLE_WIDE_VECTORS
+#define F8VECTOR_SIZE 32
+#define F16VECTOR_SIZE 64
+// these types are used to access groups of consecutive f4vectors, thus they may alias
+typedef float v8sf __attribute__ ((vector_size (F8VECTOR_SIZE), __may_alias__)); // vector of eight single floats
+typedef float v16sf __attribute__ ((vector_size (F16VECTOR_SIZE), __may_alias__)); // vector of sixteen single floats
+// unaligned variants, e.g. to access a field vector shifted by one f4vector
+typedef float v8sf_u __attribute__ ((vector_size (F8VECTOR_SIZE), __may_alias__, aligned (F4VECTOR_SIZE)));
+typedef float v16sf_u __attribute__ ((vector_size (F16VECTOR_SIZE), __may_alias__, aligned (F4VECTOR_SIZE)));
+#endif
 #else // MSVC
 #include <emmintrin.h>
 union f4vector
@@ -58,12 +73,57 @@ inline __m128 & operator *= (__m128 & a, __m128 b){a = a * b; return a;}
 inline __m128 & operator /= (__m128 & a, __m128 b){a = a / b; return a;}
 #endif
 
+//! alignment of all v4sf arrays along z, large enough for aligned AVX-512 access of a group of f4vectors
+#define V4SF_LINE_ALIGNMENT 64
+//! alignment of the contiguous data block of all 3D arrays
+#define ARRAY_DATA_ALIGNMENT 64
+
+//! Backing of large memory blocks with huge pages
+enum HugePageMode
+{
+	HUGEPAGES_OFF=0,    //!< use the default pages of the system
+	HUGEPAGES_THP=1,    //!< request transparent huge pages (madvise)
+	HUGEPAGES_HUGETLB=2 //!< use hugetlbfs pages (1 GB or 2 MB), fall back to transparent huge pages
+};
+//! Minimum size of a memory block to be backed by huge pages
+#define HUGEPAGE_MIN_SIZE (2*1024*1024)
+
+void SetHugePageMode(HugePageMode mode);
+HugePageMode GetHugePageMode();
+
+//! Allocate an ARRAY_DATA_ALIGNMENT byte aligned memory block, backed by huge pages if enabled. Returns NULL on failure.
+void* AllocAlignedMemory(size_t size);
+//! Free a memory block allocated by AllocAlignedMemory()
+void FreeAlignedMemory(void* data);
+
+//! Allocate an ARRAY_DATA_ALIGNMENT byte aligned memory block, zero-initialized unless zero is false (e.g. for a first touch by the threads using it)
+void* AllocArrayData(size_t size, bool zero=true);
+void FreeArrayData(void* data);
+//! Move all memory pages fully inside the given range to the given NUMA node (mbind), the content is preserved. Returns false if the pages could not be moved.
+bool RelocateArrayData(void* start, size_t size, int node);
+
 void Delete1DArray_v4sf(f4vector* array);
 void Delete3DArray_v4sf(f4vector*** array, const unsigned int* numLines);
 void Delete_N_3DArray_v4sf(f4vector**** array, const unsigned int* numLines);
 f4vector* Create1DArray_v4sf(const unsigned int numLines);
-f4vector*** Create3DArray_v4sf(const unsigned int* numLines);
-f4vector**** Create_N_3DArray_v4sf(const unsigned int* numLines);
+f4vector*** Create3DArray_v4sf(const unsigned int* numLines, bool zero=true);
+f4vector**** Create_N_3DArray_v4sf(const unsigned int* numLines, bool zero=true);
+//! Move the z-lines of the x-range [startX, startX+numX) to the given NUMA node, see RelocateArrayData()
+bool Relocate_N_3DArray_v4sf(f4vector**** array, const unsigned int* numLines, unsigned int startX, unsigned int numX, int node);
+//! Zero the z-lines of the x-range [startX, startX+numX), the pages of an array created without zeroing are placed on the NUMA node of the calling thread
+void Zero_N_3DArray_v4sf(f4vector**** array, const unsigned int* numLines, unsigned int startX, unsigned int numX);
+
+//! Write the raw data blocks of an array created by Create_N_3DArray_v4sf to a binary stream (including the z-line padding)
+void Write_N_3DArray_v4sf(std::ostream &file, f4vector**** array, const unsigned int* numLines);
+//! Read the raw data blocks of an array created by Create_N_3DArray_v4sf from a binary stream \sa Write_N_3DArray_v4sf
+void Read_N_3DArray_v4sf(std::istream &file, f4vector**** array, const unsigned int* numLines);
+//! Get the distance (in f4vectors) of two consecutive z-lines in the contiguous data block of a v4sf 3D array
+unsigned int Get3DArrayLineStride_v4sf(const unsigned int* numLines);
+//! Get the contiguous data block of a 3D array created by Create3DArray_v4sf, see also Get3DArrayLineStride_v4sf()
+inline f4vector* Get3DArrayData_v4sf(f4vector*** array) {return array[0][0];}
+
+//! Get the widest vector width (number of floats: 4, 8 or 16) supported by the running cpu and this build, limited by maxWidth (0: no limit)
+unsigned int GetCPUVectorWidth(unsigned int maxWidth=0);
 
 // *************************************************************************************
 // templates
@@ -109,48 +169,55 @@ inline T& Access_N_3DArray(T**** array, unsigned int n, unsigned int x, unsigned
 	return array[n][x][y][z];
 }
 
+/*!
+  \brief Allocate a 3D array as a single contiguous and aligned data block (x-major, z fastest).
+  The pointer tables are strided views into this block, see Get3DArrayData() for a flat access.
+  */
 template <typename T>
-T*** Create3DArray(const unsigned int* numLines)
+T*** Create3DArray(const unsigned int* numLines, bool zero=true)
 {
-	T*** array=NULL;
-	unsigned int pos[3];
-	array = new T**[numLines[0]];
+	size_t numYZ = (size_t)numLines[1]*numLines[2];
+	T* data = (T*)AllocArrayData(sizeof(T)*numLines[0]*numYZ, zero);
+	// allocate at least one entry, the first line of the first table always points to the data block
+	T** lines = new T*[(size_t)numLines[0]*numLines[1]+1];
+	T*** array = new T**[numLines[0]+1];
+	lines[0] = data;
+	array[0] = lines;
+	unsigned int pos[2];
 	for (pos[0]=0; pos[0]<numLines[0]; ++pos[0])
 	{
-		array[pos[0]] = new T*[numLines[1]];
+		array[pos[0]] = &lines[(size_t)pos[0]*numLines[1]];
 		for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
-		{
-			array[pos[0]][pos[1]] = new T[numLines[2]];
-			for (pos[2]=0; pos[2]<numLines[2]; ++pos[2])
-			{
-				array[pos[0]][pos[1]][pos[2]] = 0;
-			}
-		}
+			array[pos[0]][pos[1]] = &data[pos[0]*numYZ + (size_t)pos[1]*numLines[2]];
 	}
 	return array;
 }
 
+//! Get the contiguous data block of a 3D array created by Create3DArray
+template <typename T>
+inline T* Get3DArrayData(T*** array)
+{
+	return array[0][0];
+}
+
 template <typename T>
 T*** Copy3DArray(T*** array_in, T*** array_out, const unsigned int* numLines)
 {
 	if (array_out==NULL)
 		array_out = Create3DArray<T>(numLines);
-	unsigned int pos[3];
-	for (pos[0]=0; pos[0]<numLines[0]; ++pos[0])
-		for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
-			for (pos[2]=0; pos[2]<numLines[2]; ++pos[2])
-				array_out[pos[0]][pos[1]][pos[2]] = array_in[pos[0]][pos[1]][pos[2]];
+	size_t size = (size_t)numLines[0]*numLines[1]*numLines[2];
+	std::copy(Get3DArrayData(array_in), Get3DArrayData(array_in)+size, Get3DArrayData(array_out));
 	return array_out;
 }
 
 template <typename T>
-T**** Create_N_3DArray(const unsigned int* numLines)
+T**** Create_N_3DArray(const unsigned int* numLines, bool zero=true)
 {
 	T**** array=NULL;
 	array = new T***[3];
 	for (int n=0; n<3; ++n)
 	{
-		array[n]=Create3DArray<T>( numLines );
+		array[n]=Create3DArray<T>( numLines, zero );
 	}
 	return array;
 }
@@ -165,19 +232,33 @@ T**** Copy_N_3DArray(T**** array_in, T**** array_out, const unsigned int* numLin
 	return array_out;
 }
 
+//! Move the x-range [startX, startX+numX) to the given NUMA node, see RelocateArrayData()
+template <typename T>
+bool Relocate3DArray(T*** array, const unsigned int* numLines, unsigned int startX, unsigned int numX, int node)
+{
+	if (!array || startX>=numLines[0]) return true;
+	numX = std::min(numX, numLines[0]-startX);
+	size_t numYZ = (size_t)numLines[1]*numLines[2];
+	return RelocateArrayData(Get3DArrayData(array)+startX*numYZ, sizeof(T)*numX*numYZ, node);
+}
+
+//! Zero the x-range [startX, startX+numX), see Zero_N_3DArray_v4sf()
+template <typename T>
+void Zero3DArray(T*** array, const unsigned int* numLines, unsigned int startX, unsigned int numX)
+{
+	if (!array || startX>=numLines[0]) return;
+	numX = std::min(numX, numLines[0]-startX);
+	size_t numYZ = (size_t)numLines[1]*numLines[2];
+	memset(Get3DArrayData(array)+startX*numYZ, 0, sizeof(T)*numX*numYZ);
+}
+
 template <typename T>
 void Delete3DArray(T*** array, const unsigned int* numLines)
 {
 	if (!array) return;
-	unsigned int pos[3];
-	for (pos[0]=0; pos[0]<numLines[0]; ++pos[0])
-	{
-		for (pos[1]=0; pos[1]<numLines[1]; ++pos[1])
-		{
-			delete[] array[pos[0]][pos[1]];
-		}
-		delete[] array[pos[0]];
-	}
+	(void)numLines; // not needed for a contiguous array
+	FreeArrayData(array[0][0]);
+	delete[] array[0];
 	delete[] array;
 }
 
@@ -192,6 +273,24 @@ void Delete_N_3DArray(T**** array, const unsigned int* numLines)
 	delete[] array;
 }
 
+//! Write the raw data blocks of an array created by Create_N_3DArray to a binary stream
+template <typename T>
+void Write_N_3DArray(std::ostream &file, T**** array, const unsigned int* numLines)
+{
+	size_t size = (size_t)numLines[0]*numLines[1]*numLines[2];
+	for (int n=0; n<3; ++n)
+		file.write((const char*)Get3DArrayData(array[n]), sizeof(T)*size);
+}
+
+//! Read the raw data blocks of an array created by Create_N_3DArray from a binary stream \sa Write_N_3DArray
+template <typename T>
+void Read_N_3DArray(std::istream &file, T**** array, const unsigned int* numLines)
+{
+	size_t size = (size_t)numLines[0]*numLines[1]*numLines[2];
+	for (int n=0; n<3; ++n)
+		file.read((char*)Get3DArrayData(array[n]), sizeof(T)*size);
+}
+
 template <typename T>
 void Dump_N_3DArray2File(std::ostream &file, T**** array, const unsigned int* numLines)
 {
@@ -16,6 +16,7 @@
 */
 
 #include <cstring>
+#include <cstdlib>
 #include <iostream>
 #include "global.h"
 
@@ -28,6 +29,9 @@ Global::Global()
 {
 	m_showProbeDiscretization = false;
 	m_nativeFieldDumps = false;
+	m_FieldDumpQueue = 2;
+	m_FieldDumpQueueMemory = 1024;
+	m_MaxVectorWidth = 0;
 	m_VerboseLevel = 0;
 }
 
@@ -35,6 +39,9 @@ void Global::ShowArguments(ostream& ostr, string front)
 {
 	ostr << front << "--showProbeDiscretization\tShow probe discretization information" << endl;
 	ostr << front << "--nativeFieldDumps\t\tDump all fields using the native field components" << endl;
+	ostr << front << "--fieldDumpQueue=<n>\t\tBuffer <n> time domain field dumps for the background writer (default 2, 0: synchronous)" << endl;
+	ostr << front << "--fieldDumpQueueMemory=<n>\tLimit the buffered field dumps of each dump box to <n> MiB (default 1024)" << endl;
+	ostr << front << "--maxVectorWidth=<4|8|16>\tLimit the vector width of the engine kernels (default: widest supported by the cpu)" << endl;
 	ostr << front << "-v,-vv,-vvv\t\t\tSet debug level: 1 to 3" << endl;
 }
 
@@ -56,6 +63,24 @@ bool Global::parseCommandLineArgument( const char *argv )
 		m_nativeFieldDumps = true;
 		return true;
 	}
+	else if (strncmp(argv,"--fieldDumpQueue=",17)==0)
+	{
+		m_FieldDumpQueue = atoi(argv+17);
+		cout << "openEMS - buffering " << m_FieldDumpQueue << " time domain field dumps" << endl;
+		return true;
+	}
+	else if (strncmp(argv,"--fieldDumpQueueMemory=",23)==0)
+	{
+		m_FieldDumpQueueMemory = atoi(argv+23);
+		cout << "openEMS - limiting the buffered time domain field dumps to " << m_FieldDumpQueueMemory << " MiB" << endl;
+		return true;
+	}
+	else if (strncmp(argv,"--maxVectorWidth=",17)==0)
+	{
+		m_MaxVectorWidth = atoi(argv+17);
+		cout << "openEMS - limiting the vector width to " << m_MaxVectorWidth << " floats" << endl;
+		return true;
+	}
 	else if (strcmp(argv,"-v")==0)
 	{
 		cout << "openEMS - verbose level 1" << endl;
@@ -44,6 +44,18 @@ public:
 	//! Set dumps to use native fields.
 	void SetNativeFieldDumps(bool val) {m_nativeFieldDumps=val;}
 
+	//! Number of time domain field dumps buffered for the background writer, 0 writes all dumps synchronously
+	unsigned int GetFieldDumpQueue() const {return m_FieldDumpQueue;}
+	//! Set the number of buffered time domain field dumps
+	void SetFieldDumpQueue(unsigned int val) {m_FieldDumpQueue=val;}
+	//! Maximum memory (in MiB) of the buffered time domain field dumps of a single dump box
+	unsigned int GetFieldDumpQueueMemory() const {return m_FieldDumpQueueMemory;}
+	//! Set the maximum memory (in MiB) of the buffered time domain field dumps of a single dump box
+	void SetFieldDumpQueueMemory(unsigned int val) {m_FieldDumpQueueMemory=val;}
+
+	//! Maximum vector width (number of floats) of the engine kernels, 0 uses the widest width supported by the cpu
+	unsigned int GetMaxVectorWidth() const {return m_MaxVectorWidth;}
+
 	//! Set the verbose level
 	void SetVerboseLevel(int level) {m_VerboseLevel=level;m_SavedVerboseLevel=level;}
 	//! Get the verbose level
@@ -57,6 +69,9 @@ public:
 protected:
 	bool m_showProbeDiscretization;
 	bool m_nativeFieldDumps;
+	unsigned int m_FieldDumpQueue;
+	unsigned int m_FieldDumpQueueMemory;
+	unsigned int m_MaxVectorWidth;
 	int m_VerboseLevel;
 	int m_SavedVerboseLevel;
 };
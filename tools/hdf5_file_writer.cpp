@@ -25,10 +25,20 @@ using namespace std;
 #include <iostream>
 #include <iomanip>
 
-HDF5_File_Writer::HDF5_File_Writer(string filename)
+HDF5_File_Writer::HDF5_File_Writer(string filename, bool append)
 {
 	m_filename = filename;
 	m_Group = "/";
+	if (append)
+	{
+		hid_t hdf5_file = H5Fopen( m_filename.c_str(), H5F_ACC_RDWR, H5P_DEFAULT );
+		if (hdf5_file>=0)
+		{
+			H5Fclose(hdf5_file);
+			return;
+		}
+		cerr << "HDF5_File_Writer::HDF5_File_Writer: Warning, can't append to the given file " << m_filename << ", creating a new file" << endl;
+	}
 	hid_t hdf5_file = H5Fcreate(m_filename.c_str(), H5F_ACC_TRUNC, H5P_DEFAULT, H5P_DEFAULT);
 	if (hdf5_file<0)
 	{
@@ -108,6 +118,16 @@ void HDF5_File_Writer::SetCurrentGroup(std::string group, bool createGrp)
 	H5Fclose(hdf5_file);
 }
 
+bool HDF5_File_Writer::Exists(std::string locName)
+{
+	hid_t hdf5_file = H5Fopen( m_filename.c_str(), H5F_ACC_RDONLY, H5P_DEFAULT );
+	if (hdf5_file<0)
+		return false;
+	bool exists = H5Lexists(hdf5_file, locName.c_str(), H5P_DEFAULT)>0;
+	H5Fclose(hdf5_file);
+	return exists;
+}
+
 bool HDF5_File_Writer::WriteRectMesh(unsigned int const* numLines, double const* const* discLines, int MeshType, double scaling)
 {
 	float* array[3];
@@ -408,6 +428,9 @@ bool HDF5_File_Writer::WriteData(std::string dataSetName,  hid_t mem_type, void
 	for (size_t n=0;n<dim;++n)
 		dims[n]=datasize[n];
 	hid_t space = H5Screate_simple(dim, dims, NULL);
+	// replace an existing data set, e.g. a time domain dump written again after resuming from a checkpoint
+	if (H5Lexists(group, dataSetName.c_str(), H5P_DEFAULT)>0)
+		H5Ldelete(group, dataSetName.c_str(), H5P_DEFAULT);
 	hid_t dataset = H5Dcreate(group, dataSetName.c_str(), mem_type, space, H5P_DEFAULT, H5P_DEFAULT, H5P_DEFAULT);
 	if (H5Dwrite(dataset, mem_type, space, H5P_DEFAULT, H5P_DEFAULT, field_buf))
 	{
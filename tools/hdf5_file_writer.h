@@ -26,7 +26,8 @@
 class HDF5_File_Writer
 {
 public:
-	HDF5_File_Writer(std::string filename);
+	//! Create the given hdf5 file, or open an existing file if \a append is true
+	HDF5_File_Writer(std::string filename, bool append=false);
 	~HDF5_File_Writer();
 
 	bool WriteRectMesh(unsigned int const* numLines, double const* const* discLines, int MeshType=0, double scaling=1);
@@ -57,6 +58,9 @@ public:
 
 	void SetCurrentGroup(std::string group, bool createGrp=true);
 
+	//! Check if the given group or data set exists
+	bool Exists(std::string locName);
+
 protected:
 	std::string m_filename;
 	std::string m_Group;
@@ -0,0 +1,119 @@
+/*
+*	Copyright (C) 2026 openEMS contributors
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "thread_pool.h"
+#include "useful.h"
+
+using namespace std;
+
+ThreadPool& ThreadPool::GetShared()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+ThreadPool::ThreadPool()
+{
+	m_NumWorkers = 0;
+	m_Terminate = false;
+	m_Job = NULL;
+	m_Generation = 0;
+	m_Pending = 0;
+}
+
+ThreadPool::~ThreadPool()
+{
+	{
+		boost::lock_guard<boost::mutex> lock(m_Mutex);
+		m_Terminate = true;
+	}
+	m_StartCond.notify_all();
+	m_Workers.join_all();
+}
+
+void ThreadPool::RunRangeJob(RangeJob* job, unsigned int size, unsigned int numThreads)
+{
+	if (size==0)
+		return;
+	vector<unsigned int> jpt = AssignJobs2Threads(size, max(numThreads, 1u), true);
+	if (jpt.size()<2)
+		return job->Run(0, size-1, 0);
+
+	boost::lock_guard<boost::mutex> job_lock(m_JobMutex);
+	{
+		boost::lock_guard<boost::mutex> lock(m_Mutex);
+		m_RangeStart.resize(jpt.size());
+		m_RangeStop.resize(jpt.size());
+		unsigned int start = 0;
+		for (size_t n=0; n<jpt.size(); ++n)
+		{
+			m_RangeStart.at(n) = start;
+			m_RangeStop.at(n) = start + jpt.at(n) - 1;
+			start += jpt.at(n);
+		}
+
+		// start missing workers, they wait for the next generation
+		while (m_NumWorkers+1<jpt.size())
+		{
+			++m_NumWorkers;
+			m_Workers.add_thread( new boost::thread( &ThreadPool::WorkerLoop, this, m_NumWorkers, m_Generation ) );
+		}
+
+		m_Job = job;
+		m_Pending = jpt.size()-1;
+		++m_Generation;
+	}
+	m_StartCond.notify_all();
+
+	job->Run(m_RangeStart.at(0), m_RangeStop.at(0), 0);
+
+	boost::unique_lock<boost::mutex> lock(m_Mutex);
+	while (m_Pending>0)
+		m_DoneCond.wait(lock);
+	m_Job = NULL;
+}
+
+void ThreadPool::WorkerLoop(unsigned int threadID, unsigned int generation)
+{
+	while (true)
+	{
+		unsigned int start, stop;
+		RangeJob* job;
+		{
+			boost::unique_lock<boost::mutex> lock(m_Mutex);
+			while ((m_Generation==generation) && (m_Terminate==false))
+				m_StartCond.wait(lock);
+			if (m_Terminate)
+				return;
+			generation = m_Generation;
+			// this worker is not needed for the current job
+			if (threadID>=m_RangeStart.size())
+				continue;
+			job = m_Job;
+			start = m_RangeStart.at(threadID);
+			stop = m_RangeStop.at(threadID);
+		}
+
+		job->Run(start, stop, threadID);
+
+		{
+			boost::lock_guard<boost::mutex> lock(m_Mutex);
+			--m_Pending;
+		}
+		m_DoneCond.notify_one();
+	}
+}
@@ -0,0 +1,88 @@
+/*
+*	Copyright (C) 2026 openEMS contributors
+*
+*	This program is free software: you can redistribute it and/or modify
+*	it under the terms of the GNU General Public License as published by
+*	the Free Software Foundation, either version 3 of the License, or
+*	(at your option) any later version.
+*
+*	This program is distributed in the hope that it will be useful,
+*	but WITHOUT ANY WARRANTY; without even the implied warranty of
+*	MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*	GNU General Public License for more details.
+*
+*	You should have received a copy of the GNU General Public License
+*	along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <boost/thread.hpp>
+
+//! Pool of persistent worker threads for small parallel jobs that are run very often, e.g. every sampled timestep.
+/*!
+  The workers are started on demand and wait for the next job, avoiding the creation of new threads for every job.
+  The calling thread always processes the first part of a job itself.
+  */
+class ThreadPool
+{
+public:
+	//! Job processing a range of work items
+	class RangeJob
+	{
+	public:
+		virtual ~RangeJob() {}
+		//! Process the items \a start to \a stop (inclusive), \a threadID is unique for each part of the job
+		virtual void Run(unsigned int start, unsigned int stop, unsigned int threadID) = 0;
+	};
+
+	//! Range job calling a member function of the given object
+	template <class T> class RangeJobMember : public RangeJob
+	{
+	public:
+		typedef void (T::*RangeFunc)(unsigned int start, unsigned int stop, unsigned int threadID);
+		RangeJobMember(T* obj, RangeFunc func) : m_Obj(obj), m_Func(func) {}
+		virtual void Run(unsigned int start, unsigned int stop, unsigned int threadID) {(m_Obj->*m_Func)(start,stop,threadID);}
+	protected:
+		T* m_Obj;
+		RangeFunc m_Func;
+	};
+
+	//! Get the pool shared by all processings, its workers are kept until the program ends
+	static ThreadPool& GetShared();
+
+	ThreadPool();
+	~ThreadPool();
+
+	//! Get the number of running worker threads (not including the calling thread)
+	unsigned int GetNumberOfWorkers() const {return m_NumWorkers;}
+
+	//! Run the items 0 to \a size-1, split into consecutive ranges for at most \a numThreads threads. Returns after all parts are done.
+	/*!
+	  Jobs of several threads are run one after another. A job must not run another job of the same pool.
+	  */
+	void RunRangeJob(RangeJob* job, unsigned int size, unsigned int numThreads);
+
+protected:
+	void WorkerLoop(unsigned int threadID, unsigned int generation);
+
+	//! serializes all jobs
+	boost::mutex m_JobMutex;
+
+	boost::mutex m_Mutex;
+	boost::condition_variable m_StartCond;
+	boost::condition_variable m_DoneCond;
+	boost::thread_group m_Workers;
+	unsigned int m_NumWorkers;
+	bool m_Terminate;
+
+	//! current job and ranges, a new job increments the generation
+	RangeJob* m_Job;
+	std::vector<unsigned int> m_RangeStart;
+	std::vector<unsigned int> m_RangeStop;
+	unsigned int m_Generation;
+	unsigned int m_Pending;
+};
+
+#endif // THREAD_POOL_H
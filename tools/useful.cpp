@@ -26,6 +26,22 @@
 #include <sstream>
 #include <boost/algorithm/string.hpp>
 #include <iostream>
+#include <cstring>
+#include <cctype>
+#ifdef __GNUC__
+#include <sys/time.h>
+#endif
+#ifdef _MSC_VER
+#include <io.h>
+#include <fcntl.h>
+#else
+#include <unistd.h>
+#endif
+#ifdef __linux__
+#include <sched.h>
+#include <pthread.h>
+#include <dirent.h>
+#endif
 
 unsigned int CalcNyquistNum(double fmax, double dT)
 {
@@ -184,6 +200,88 @@ int LinePlaneIntersection(const double *p0, const double *p1, const double *p2,
 	return 0;
 }
 
+std::vector<int> GetAllowedCPUs()
+{
+	std::vector<int> cpus;
+#ifdef __linux__
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	if (sched_getaffinity(0, sizeof(set), &set)!=0)
+		return cpus;
+	for (int n=0; n<CPU_SETSIZE; ++n)
+		if (CPU_ISSET(n, &set))
+			cpus.push_back(n);
+#endif
+	return cpus;
+}
+
+bool PinThreadToCPU(int cpu)
+{
+#ifdef __linux__
+	if (cpu<0)
+		return false;
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return (pthread_setaffinity_np(pthread_self(), sizeof(set), &set)==0);
+#else
+	(void)cpu;
+	return false;
+#endif
+}
+
+int GetNUMANodeOfCPU(int cpu)
+{
+#ifdef __linux__
+	// the node of a cpu is given by a "node<n>" entry in its sysfs directory
+	std::stringstream path;
+	path << "/sys/devices/system/cpu/cpu" << cpu;
+	DIR* dir = opendir(path.str().c_str());
+	if (dir==NULL)
+		return -1;
+	int node = -1;
+	struct dirent* entry;
+	while ((entry = readdir(dir)) != NULL)
+	{
+		if ((strncmp(entry->d_name, "node", 4)==0) && isdigit(entry->d_name[4]))
+		{
+			node = atoi(entry->d_name+4);
+			break;
+		}
+	}
+	closedir(dir);
+	return node;
+#else
+	(void)cpu;
+	return -1;
+#endif
+}
+
+uint64_t HashData(const void* data, size_t size, uint64_t hash)
+{
+	const unsigned char* bytes = (const unsigned char*)data;
+	for (size_t n=0; n<size; ++n)
+	{
+		hash ^= bytes[n];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+bool TruncateFile(const std::string &filename, uint64_t size)
+{
+#ifdef _MSC_VER
+	int fd = _open(filename.c_str(), _O_RDWR | _O_BINARY);
+	if (fd<0)
+		return false;
+	bool ok = (_chsize_s(fd, size)==0);
+	_close(fd);
+	return ok;
+#else
+	return truncate(filename.c_str(), (off_t)size)==0;
+#endif
+}
+
 #ifndef __GNUC__
 #include <chrono>
 #include <Winsock2.h> // for struct timeval
@@ -198,4 +296,11 @@ int gettimeofday(struct timeval* tp, struct timezone* tzp) {
   return 0;
 }
 
-#endif // _WIN32
\ No newline at end of file
+#endif // _WIN32
+
+double GetWallTime()
+{
+	timeval t;
+	gettimeofday(&t,NULL);
+	return t.tv_sec + t.tv_usec*1e-6;
+}
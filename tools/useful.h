@@ -20,6 +20,7 @@
 
 #include <vector>
 #include <string>
+#include <stdint.h>
 
 //! Calc the nyquist number of timesteps for a given frequency and timestep
 unsigned int CalcNyquistNum(double fmax, double dT);
@@ -41,6 +42,24 @@ double* Invert(const double* in, double* out);
 
 int LinePlaneIntersection(const double *p0, const double* p1, const double* p2, const double* l_start, const double* l_stop, double* is_point, double &dist);
 
+//! Get the list of cpus this process is allowed to run on (empty if unknown)
+std::vector<int> GetAllowedCPUs();
+//! Pin the calling thread to the given cpu, returns false on failure or if not supported
+bool PinThreadToCPU(int cpu);
+//! Get the NUMA node of the given cpu, returns -1 if unknown
+int GetNUMANodeOfCPU(int cpu);
+
+//! Calculate the 64 bit FNV-1a hash of the given data, continuing the given hash
+uint64_t HashData(const void* data, size_t size, uint64_t hash=14695981039346656037ULL);
+//! Calculate the 64 bit FNV-1a hash of a single value, continuing the given hash
+template <class T> inline uint64_t HashValue(const T& value, uint64_t hash=14695981039346656037ULL) {return HashData(&value, sizeof(T), hash);}
+
+//! Get the wall clock time in seconds
+double GetWallTime();
+
+//! Truncate (or extend) the given file to \a size bytes, returns false on failure
+bool TruncateFile(const std::string &filename, uint64_t size);
+
 #ifndef __GNUC__
 int gettimeofday(struct timeval* tp, struct timezone* tzp);
 #endif // _WIN32